@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cjson"
+  "CMakeFiles/cjson-complete"
+  "cjson-prefix/src/cjson-stamp/cjson-build"
+  "cjson-prefix/src/cjson-stamp/cjson-configure"
+  "cjson-prefix/src/cjson-stamp/cjson-download"
+  "cjson-prefix/src/cjson-stamp/cjson-install"
+  "cjson-prefix/src/cjson-stamp/cjson-mkdir"
+  "cjson-prefix/src/cjson-stamp/cjson-patch"
+  "cjson-prefix/src/cjson-stamp/cjson-test"
+  "cjson-prefix/src/cjson-stamp/cjson-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/cjson.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
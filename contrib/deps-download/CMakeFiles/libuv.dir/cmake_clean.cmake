@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libuv"
+  "CMakeFiles/libuv-complete"
+  "libuv-prefix/src/libuv-stamp/libuv-build"
+  "libuv-prefix/src/libuv-stamp/libuv-configure"
+  "libuv-prefix/src/libuv-stamp/libuv-download"
+  "libuv-prefix/src/libuv-stamp/libuv-install"
+  "libuv-prefix/src/libuv-stamp/libuv-mkdir"
+  "libuv-prefix/src/libuv-stamp/libuv-patch"
+  "libuv-prefix/src/libuv-stamp/libuv-test"
+  "libuv-prefix/src/libuv-stamp/libuv-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/libuv.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
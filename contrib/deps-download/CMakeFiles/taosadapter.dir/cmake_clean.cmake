@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/taosadapter"
+  "CMakeFiles/taosadapter-complete"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-build"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-configure"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-download"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-install"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-mkdir"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-patch"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-test"
+  "taosadapter-prefix/src/taosadapter-stamp/taosadapter-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/taosadapter.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/tools/taosadapter"
+  "/root/repo/contrib/deps-download/taosadapter-prefix/src/taosadapter-build"
+  "/root/repo/contrib/deps-download/taosadapter-prefix"
+  "/root/repo/contrib/deps-download/taosadapter-prefix/tmp"
+  "/root/repo/contrib/deps-download/taosadapter-prefix/src/taosadapter-stamp"
+  "/root/repo/contrib/deps-download/taosadapter-prefix/src"
+  "/root/repo/contrib/deps-download/taosadapter-prefix/src/taosadapter-stamp"
+)
+
+set(configSubDirs )
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/contrib/deps-download/taosadapter-prefix/src/taosadapter-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/contrib/deps-download/taosadapter-prefix/src/taosadapter-stamp${cfgdir}") # cfgdir has leading slash
+endif()
@@ -365,6 +365,7 @@ typedef struct SSortExecInfo {
   int32_t loops;       // loop count
   int32_t writeBytes;  // write io bytes
   int32_t readBytes;   // read io bytes
+  int32_t rawWriteBytes;  // write bytes before compression
 } SSortExecInfo;
 
 // stream special block column
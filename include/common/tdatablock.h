@@ -67,6 +67,10 @@ typedef struct SBlockOrderInfo {
 #define IS_JSON_NULL(type, data) \
   ((type) == TSDB_DATA_TYPE_JSON && (*(data) == TSDB_DATA_TYPE_NULL || tTagIsJsonNull(data)))
 
+// version of the serialized block produced by blockEncode/blockCompressEncode
+#define BLOCK_ENCODE_VERSION          1
+#define BLOCK_ENCODE_COMPRESS_VERSION 2
+
 static FORCE_INLINE bool colDataIsNull_s(const SColumnInfoData* pColumnInfoData, uint32_t row) {
   if (!pColumnInfoData->hasNull) {
     return false;
@@ -264,7 +268,10 @@ SColumnInfoData  createColumnInfoData(int16_t type, int32_t bytes, int16_t colId
 SColumnInfoData* bdGetColumnInfoData(const SSDataBlock* pBlock, int32_t index);
 
 int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols);
+int32_t blockCompressEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols);
 const char* blockDecode(SSDataBlock* pBlock, const char* pData);
+int32_t blockGetDecompressSize(const char* pData);
+int32_t blockDecompress(const char* pData, char* pDst);
 
 void blockDebugShowDataBlock(SSDataBlock* pBlock, const char* flag);
 void blockDebugShowDataBlocks(const SArray* dataBlocks, const char* flag);
@@ -280,6 +287,16 @@ static FORCE_INLINE int32_t blockGetEncodeSize(const SSDataBlock* pBlock) {
   return blockDataGetSerialMetaSize(taosArrayGetSize(pBlock->pDataBlock)) + blockDataGetSize(pBlock);
 }
 
+// each column of a compressed block carries an extra header: | compress alg (int8_t) | compressed length (int32_t) |
+static FORCE_INLINE int32_t blockGetCompressEncodeSize(const SSDataBlock* pBlock) {
+  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
+  return blockGetEncodeSize(pBlock) + numOfCols * (sizeof(int8_t) + sizeof(int32_t) + COMP_OVERFLOW_BYTES);
+}
+
+static FORCE_INLINE bool blockIsCompressed(const char* pData) {
+  return *(const int32_t*)pData == BLOCK_ENCODE_COMPRESS_VERSION;
+}
+
 static FORCE_INLINE int32_t blockCompressColData(SColumnInfoData* pColRes, int32_t numOfRows, char* data,
                                                  int8_t compressed) {
   int32_t colSize = colDataGetLength(pColRes, numOfRows);
@@ -114,6 +114,7 @@ extern bool    tsUseAdapter;
 extern int32_t tsMinSlidingTime;
 extern int32_t tsMinIntervalTime;
 extern int32_t tsMaxMemUsedByInsert;
+extern int32_t tsCsvParseThreads;
 
 // build info
 extern char version[];
@@ -143,14 +144,31 @@ extern char    tsSmlChildTableName[];
 extern char    tsSmlTagName[];
 extern bool    tsSmlDataFormat;
 extern int32_t tsSmlBatchSize;
+extern int32_t tsSmlParseThreads;
+
+// stmt
+extern int32_t tsStmtMaxInflight;
 
 // wal
 extern int64_t tsWalFsyncDataSizeLimit;
 
+// tsdb
+extern int32_t tsTsdbPageCacheSize;
+extern int32_t tsTsdbReadAheadBlocks;
+extern int32_t tsTsdbCompactSttTrigger;
+extern int32_t tsTsdbCompactOverlapRatio;
+extern int32_t tsTsdbCompactIoBudget;
+extern int32_t tsTsdbMemChunkRows;
+extern int32_t tsTsdbCommitThreads;
+
+// stream
+extern int32_t tsStreamStateCacheSize;
+
 // internal
 extern int32_t tsTransPullupInterval;
 extern int32_t tsMqRebalanceInterval;
 extern int32_t tsStreamCheckpointTickInterval;
+extern int32_t tsStreamCheckpointInterval;
 extern int32_t tsTtlUnit;
 extern int32_t tsTtlPushInterval;
 extern int32_t tsGrantHBInterval;
@@ -1067,6 +1067,12 @@ typedef struct {
   int64_t numOfInsertSuccessReqs;
   int64_t numOfBatchInsertReqs;
   int64_t numOfBatchInsertSuccessReqs;
+  int64_t pageCacheHit;
+  int64_t pageCacheMiss;
+  int64_t pageCacheUsage;
+  int64_t numOfWalFsync;
+  int64_t numOfWalFsyncEntries;
+  int64_t walFsyncUs;
   int64_t errors;
 } SVnodesStat;
 
@@ -1081,11 +1087,18 @@ typedef struct {
   int64_t totalStorage;
   int64_t compStorage;
   int64_t pointsWritten;
+  int32_t compactProgress;  // percent of the running compaction, -1 if no compaction is running
   int64_t numOfSelectReqs;
   int64_t numOfInsertReqs;
   int64_t numOfInsertSuccessReqs;
   int64_t numOfBatchInsertReqs;
   int64_t numOfBatchInsertSuccessReqs;
+  int64_t pageCacheHit;    // local only, not sent to mnode
+  int64_t pageCacheMiss;   // local only, not sent to mnode
+  int64_t pageCacheUsage;  // local only, not sent to mnode
+  int64_t numOfWalFsync;         // local only, not sent to mnode
+  int64_t numOfWalFsyncEntries;  // local only, not sent to mnode
+  int64_t walFsyncUs;            // local only, not sent to mnode
 } SVnodeLoad;
 
 typedef struct {
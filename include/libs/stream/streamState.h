@@ -25,6 +25,9 @@ extern "C" {
 
 typedef struct SStreamTask SStreamTask;
 
+typedef struct SStreamStateCache SStreamStateCache;
+typedef struct SStreamCheckpointStore SStreamCheckpointStore;
+
 typedef bool (*state_key_cmpr_fn)(void* pKey1, void* pKey2);
 
 typedef struct STdbState {
@@ -36,6 +39,9 @@ typedef struct STdbState {
   TTB*         pSessionStateDb;
   TTB*         pParNameDb;
   TXN*         txn;
+
+  SStreamStateCache*      pCache;       // write-back cache of state.db, NULL if disabled
+  SStreamCheckpointStore* pCheckpoint;  // checkpoints of the state, NULL if not the state of a stream task
 } STdbState;
 
 // incremental state storage
@@ -49,6 +55,8 @@ void          streamStateClose(SStreamState* pState);
 int32_t       streamStateBegin(SStreamState* pState);
 int32_t       streamStateCommit(SStreamState* pState);
 int32_t       streamStateAbort(SStreamState* pState);
+int32_t       streamStateCheckpoint(SStreamState* pState, int64_t checkpointId, int64_t ver);
+int32_t       streamStateCompleteCheckpoint(SStreamState* pState, int64_t checkpointId, int64_t* ver);
 void          streamStateDestroy(SStreamState* pState);
 
 typedef struct {
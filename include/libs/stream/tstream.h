@@ -32,6 +32,7 @@ extern "C" {
 #define _STREAM_H_
 
 typedef struct SStreamTask SStreamTask;
+typedef struct SStreamMeta SStreamMeta;
 
 enum {
   STREAM_STATUS__NORMAL = 0,
@@ -136,8 +137,11 @@ typedef struct {
   SSDataBlock* pBlock;
 } SStreamRefDataBlock;
 
+// checkpoint barrier
 typedef struct {
-  int8_t type;
+  int8_t  type;
+  int64_t checkpointId;
+  int64_t sourceVer;  // wal version of the barrier, all submits before it are in the checkpoint
 } SStreamCheckpoint;
 
 typedef struct {
@@ -333,6 +337,9 @@ typedef struct SStreamTask {
   // state backend
   SStreamState* pState;
 
+  // meta of the vnode or snode the task runs on
+  SStreamMeta* pMeta;
+
   // do not serialize
   int32_t recoverTryingDownstream;
   int32_t recoverWaitingUpstream;
@@ -340,8 +347,18 @@ typedef struct SStreamTask {
   SArray* checkReqIds;  // shuffle
   int32_t refCnt;
 
-  int64_t checkpointingId;
-  int32_t checkpointAlignCnt;
+  // checkpoint
+  SRWLatch checkpointLock;
+  int64_t  checkpointingId;
+  int32_t  checkpointAlignCnt;
+  SArray*  checkpointAligned;      // SStreamCheckpointAlign, upstreams held until the barrier is aligned
+  int32_t  checkpointWaitingRsp;   // downstreams which have not received the forwarded barrier
+  int64_t  checkpointWaitingId;    // checkpoint of the forwarded barrier
+  int64_t  checkpointId;           // checkpoint the state was restored from, 0 if none
+  int64_t  checkpointVer;          // source wal version covered by checkpointId
+  int64_t  checkpointWrittenId;    // checkpoint of the last barrier executed
+  int32_t  checkpointWrittenCode;  // result of writing checkpointWrittenId
+  SArray*  checkpointChecks;       // SStreamCheckpointCheck, checks of mnode held until the barrier is executed
 
 } SStreamTask;
 
@@ -528,6 +545,17 @@ int32_t tDecodeSStreamCheckpointReq(SDecoder* pDecoder, SStreamCheckpointReq* pR
 int32_t tEncodeSStreamCheckpointRsp(SEncoder* pEncoder, const SStreamCheckpointRsp* pRsp);
 int32_t tDecodeSStreamCheckpointRsp(SDecoder* pDecoder, SStreamCheckpointRsp* pRsp);
 
+// sent by mnode to check that a task has written the checkpoint, and to complete it once all tasks of the stream have
+typedef struct {
+  int64_t streamId;
+  int64_t checkpointId;
+  int32_t taskId;
+  int32_t nodeId;
+} SStreamCheckpointReportReq;
+
+int32_t tEncodeSStreamCheckpointReportReq(SEncoder* pEncoder, const SStreamCheckpointReportReq* pReq);
+int32_t tDecodeSStreamCheckpointReportReq(SDecoder* pDecoder, SStreamCheckpointReportReq* pReq);
+
 typedef struct {
   int64_t streamId;
   int32_t downstreamTaskId;
@@ -611,6 +639,8 @@ typedef struct SStreamMeta {
   FTaskExpand* expandFunc;
   int32_t      vgId;
   SRWLatch     lock;
+  int64_t      stateCacheSize;    // bytes of window state cached in memory by all tasks
+  int32_t      numOfStateCaches;  // number of tasks sharing the budget of stateCacheSize
 } SStreamMeta;
 
 SStreamMeta* streamMetaOpen(const char* path, void* ahandle, FTaskExpand expandFunc, int32_t vgId);
@@ -630,9 +660,16 @@ int32_t streamMetaRollBack(SStreamMeta* pMeta);
 int32_t streamLoadTasks(SStreamMeta* pMeta);
 
 // checkpoint
-int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq);
-int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq);
-int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp);
+int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq,
+                                         int64_t ver);
+int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq,
+                                   SRpcMsg* pRsp);
+int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp, int32_t code);
+int32_t streamProcessCheckpointCheckReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReportReq* pReq,
+                                        SRpcMsg* pMsg);
+int32_t streamProcessCheckpointReportReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReportReq* pReq,
+                                         int64_t* ver);
+int32_t streamSendCheckpointRsp(const SStreamCheckpointReq* pReq, const SRpcHandleInfo* pInfo, int32_t code);
 
 #ifdef __cplusplus
 }
@@ -43,6 +43,11 @@ typedef struct SUpdateInfo {
   STimeWindow  scanWindow;
   uint64_t     scanGroupId;
   uint64_t     maxVersion;
+  // statistics, not persisted
+  int64_t      numInOrder;   // rows after the max ts of their table, recorded without probing
+  int64_t      numProbed;    // other rows, checked against the filters
+  int64_t      numBfHit;     // probed rows taken as updated by the filters, false positives included
+  int64_t      numNoFilter;  // rows taken as updated since no filter covers them
 } SUpdateInfo;
 
 SUpdateInfo *updateInfoInitP(SInterval *pInterval, int64_t watermark);
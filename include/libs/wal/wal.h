@@ -97,6 +97,14 @@ typedef struct {
 } SWalCkHead;
 #pragma pack(pop)
 
+typedef struct {
+  int64_t numOfFsync;  // number of fsync done
+  int64_t numOfEntry;  // number of log entries made durable by these fsync
+  int64_t maxBatch;    // max number of log entries made durable by one fsync
+  int64_t totalUs;     // total fsync latency
+  int64_t maxUs;       // max fsync latency
+} SWalFsyncStat;
+
 typedef struct SWal {
   // cfg
   SWalCfg cfg;
@@ -119,6 +127,15 @@ typedef struct SWal {
   SHashObj *pRefHash;  // refId -> SWalRef
   // path
   char path[WAL_PATH_LEN];
+  // group commit
+  int32_t       groupCommit;   // nesting level of walBeginGroupCommit
+  bool          fsyncPending;  // fsync requested inside a group commit
+  int64_t       syncedVer;     // last version covered by fsync
+  SWalFsyncStat fsyncStat;
+  char         *pAppendBuf;    // log entries appended in a group commit and not written yet
+  int64_t       appendBufLen;
+  int64_t       appendBufCap;
+  SArray       *aAppendIdx;    // SArray<SWalIdxEntry>, idx entries of the log entries in pAppendBuf
   // reusable write head
   SWalCkHead writeHead;
 } SWal;
@@ -174,7 +191,15 @@ int32_t walWriteWithSyncInfo(SWal *, int64_t index, tmsg_t msgType, SWalSyncInfo
 // -1 will be returned for failed writes
 int64_t walAppendLog(SWal *, int64_t index, tmsg_t msgType, SWalSyncInfo syncMeta, const void *body, int32_t bodyLen);
 
-void walFsync(SWal *, bool force);
+int32_t walFsync(SWal *, bool force);
+
+// Group commit: the log entries appended between walBeginGroupCommit and walEndGroupCommit are buffered in memory, and
+// the fsync requested by walFsync in between are deferred. walEndGroupCommit writes the buffered entries to the idx and
+// log file in one write each and does one fsync, which makes all of them durable together. If it fails, the entries
+// appended in the group must be taken as not persisted.
+void    walBeginGroupCommit(SWal *);
+int32_t walEndGroupCommit(SWal *);
+void    walGetFsyncStat(SWal *, SWalFsyncStat *pStat);
 
 // apis for lifecycle management
 int32_t walCommit(SWal *, int64_t ver);
@@ -54,6 +54,12 @@ extern "C" {
 
 typedef struct TdFile *TdFilePtr;
 
+#define TD_FILE_MAX_VEC 16
+typedef struct TdFileVec {
+  const void *pBuf;
+  int64_t     size;
+} TdFileVec;
+
 #define TD_FILE_CREATE   0x0001
 #define TD_FILE_WRITE    0x0002
 #define TD_FILE_READ     0x0004
@@ -88,7 +94,9 @@ int32_t taosFsyncFile(TdFilePtr pFile);
 int64_t taosReadFile(TdFilePtr pFile, void *buf, int64_t count);
 int64_t taosPReadFile(TdFilePtr pFile, void *buf, int64_t count, int64_t offset);
 int64_t taosWriteFile(TdFilePtr pFile, const void *buf, int64_t count);
+int64_t taosWriteVFile(TdFilePtr pFile, const TdFileVec *pVec, int32_t nVec);
 int64_t taosPWriteFile(TdFilePtr pFile, const void *buf, int64_t count, int64_t offset);
+int32_t taosPrefetchFile(TdFilePtr pFile, int64_t offset, int64_t count);
 void    taosFprintfFile(TdFilePtr pFile, const char *format, ...);
 
 int64_t taosGetLineFile(TdFilePtr pFile, char **__restrict ptrBuf);
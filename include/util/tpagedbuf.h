@@ -33,7 +33,9 @@ typedef struct SFilePage {
 } SFilePage;
 
 typedef struct SDiskbasedBufStatis {
-  int64_t flushBytes;
+  int64_t flushBytes;     // on disk size of flushed pages
+  int64_t flushRawBytes;  // size of flushed pages before compression
+  int64_t reuseBytes;     // flushed into the space given back by other pages
   int64_t loadBytes;
   int32_t loadPages;
   int32_t getPages;
@@ -146,7 +148,8 @@ bool isAllDataInMemBuf(const SDiskbasedBuf* pBuf);
 void setBufPageDirty(void* pPage, bool dirty);
 
 /**
- * Set the compress/ no-compress flag for paged buffer, when flushing data in disk.
+ * Set the compress/ no-compress flag for paged buffer, when flushing data in disk. Pages are compressed by LZ4 by
+ * default.
  * @param pBuf
  */
 void setBufPageCompressOnDisk(SDiskbasedBuf* pBuf, bool comp);
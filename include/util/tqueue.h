@@ -33,6 +33,8 @@ Notes:
 1: taosOpenQueue/taosCloseQueue, taosOpenQset/taosCloseQset is NOT multi-thread safe
 2: after taosCloseQueue/taosCloseQset is called, read/write operation APIs are not safe.
 3: read/write operation APIs are multi-thread safe
+4: a queue is a lock-free multi-producer single-consumer list, writers never block each other, while
+   readers of a queue are serialized by its mutex
 
 To remove the limitation and make this set of queue APIs multi-thread safe, REF(tref.c)
 shall be used to set up the protection.
@@ -73,14 +75,15 @@ typedef struct STaosQnode {
 } STaosQnode;
 
 typedef struct STaosQueue {
-  STaosQnode   *head;
-  STaosQnode   *tail;
+  STaosQnode   *head;     // taken out by readers
+  STaosQnode   *tail;     // swapped in by writers
+  STaosQnode   *stub;     // kept in the list so that it is never empty
   STaosQueue   *next;     // for queue set
   STaosQset    *qset;     // for queue set
   void         *ahandle;  // for queue set
   FItem         itemFp;
   FItems        itemsFp;
-  TdThreadMutex mutex;
+  TdThreadMutex mutex;    // for readers only
   int64_t       memOfItems;
   int32_t       numOfItems;
   int64_t       threadId;
@@ -93,6 +96,9 @@ typedef struct STaosQset {
   tsem_t        sem;
   int32_t       numOfQueues;
   int32_t       numOfItems;
+  int32_t       numOfWaits;    // readers parked on sem
+  int32_t       numOfResumes;  // readers to exit
+  int32_t       numOfSpins;    // times to spin before parking, adapted to the load
 } STaosQset;
 
 typedef struct STaosQall {
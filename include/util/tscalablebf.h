@@ -30,6 +30,7 @@ typedef struct SScalableBf {
 
 SScalableBf *tScalableBfInit(uint64_t expectedEntries, double errorRate);
 int32_t      tScalableBfPut(SScalableBf *pSBf, const void *keyBuf, uint32_t len);
+int32_t      tScalableBfPutNoCheck(SScalableBf *pSBf, const void *keyBuf, uint32_t len);
 int32_t      tScalableBfNoContain(const SScalableBf *pSBf, const void *keyBuf, uint32_t len);
 void         tScalableBfDestroy(SScalableBf *pSBf);
 int32_t      tScalableBfEncode(const SScalableBf *pSBf, SEncoder *pEncoder);
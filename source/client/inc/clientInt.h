@@ -150,6 +150,7 @@ typedef struct STscObj {
   SAppInstInfo* pAppInfo;
   SHashObj*     pRequests;
   int8_t        schemalessType;  // todo remove it, this attribute should be move to request
+  tsem_t        stmtSem;         // limits the batches of async stmt exec in flight on this connection
 } STscObj;
 
 typedef struct SResultColumn {
@@ -180,6 +181,8 @@ typedef struct SReqResultInfo {
   bool           convertUcs4;
   int32_t        payloadLen;
   char*          convertJson;
+  char*          decompBuf;
+  int32_t        decompBufSize;
 } SReqResultInfo;
 
 typedef struct SRequestSendRecvBody {
@@ -247,6 +250,7 @@ typedef struct SRequestObj {
   bool                 validateOnly;  // todo refactor
   bool                 killed;
   bool                 inRetry;
+  bool                 isStmtBind;  // bound by stmt, can't be retried by parsing sqlstr again
   uint32_t             prevCode;  // previous error code: todo refactor, add update flag for catalog
   uint32_t             retry;
   int64_t              allocatorRefId;
@@ -258,6 +262,7 @@ typedef struct SSyncQueryParam {
   SRequestObj* pRequest;
 } SSyncQueryParam;
 
+void  freeQueryParam(SSyncQueryParam* param);
 void* doAsyncFetchRows(SRequestObj* pRequest, bool setupOneRowPtr, bool convertUcs4);
 void* doFetchRows(SRequestObj* pRequest, bool setupOneRowPtr, bool convertUcs4);
 
@@ -394,6 +399,7 @@ SRequestObj* launchQueryImpl(SRequestObj* pRequest, SQuery* pQuery, bool keepQue
 int32_t      scheduleQuery(SRequestObj* pRequest, SQueryPlan* pDag, SArray* pNodeList);
 void    launchAsyncQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaData* pResultMeta, SSqlCallbackWrapper* pWrapper);
 int32_t refreshMeta(STscObj* pTscObj, SRequestObj* pRequest);
+int32_t refreshMetaOfList(STscObj* pTscObj, uint64_t requestId, int64_t refId, SArray* dbList, SArray* tableList);
 int32_t updateQnodeList(SAppInstInfo* pInfo, SArray* pNodeList);
 void    doAsyncQuery(SRequestObj* pRequest, bool forceUpdateMeta);
 int32_t removeMeta(STscObj* pTscObj, SArray* tbList);
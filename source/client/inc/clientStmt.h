@@ -91,6 +91,15 @@ typedef struct SStmtSQLInfo {
   SHashObj         *pVgHash;
 } SStmtSQLInfo;
 
+typedef struct SStmtAsyncInfo {
+  TdThreadMutex mutex;
+  TdThreadCond  cond;
+  int32_t       numOfInflight;  // batches of stmtExecAsync not responded yet
+  SSubmitRsp   *pRsp;           // submit rsp of the last auto create table batch
+  SArray       *pStaleDbs;      // dbs and tables of the batches failed for stale meta, refreshed by the app thread
+  SArray       *pStaleTbs;
+} SStmtAsyncInfo;
+
 typedef struct STscStmt {
   STscObj  *taos;
   SCatalog *pCatalog;
@@ -102,9 +111,18 @@ typedef struct STscStmt {
   SStmtExecInfo exec;
   SStmtBindInfo bInfo;
 
+  SStmtAsyncInfo async;
+
   int64_t reqid;
 } STscStmt;
 
+typedef struct SStmtAsyncParam {
+  STscStmt         *pStmt;
+  __taos_async_fn_t fp;
+  void             *param;
+  bool              autoCreateTbl;
+} SStmtAsyncParam;
+
 extern char *gStmtStatusStr[];
 
 #define STMT_LOG_SEQ(n)                                                                 \
@@ -151,6 +169,7 @@ extern char *gStmtStatusStr[];
 TAOS_STMT  *stmtInit(STscObj *taos, int64_t reqid);
 int         stmtClose(TAOS_STMT *stmt);
 int         stmtExec(TAOS_STMT *stmt);
+int         stmtExecAsync(TAOS_STMT *stmt, __taos_async_fn_t fp, void *param);
 const char *stmtErrstr(TAOS_STMT *stmt);
 int         stmtAffectedRows(TAOS_STMT *stmt);
 int         stmtAffectedRowsOnce(TAOS_STMT *stmt);
@@ -237,6 +237,7 @@ void destroyTscObj(void *pObj) {
   /*int64_t connNum = */ atomic_sub_fetch_64(&pTscObj->pAppInfo->numOfConns, 1);
 
   taosThreadMutexDestroy(&pTscObj->mutex);
+  tsem_destroy(&pTscObj->stmtSem);
   taosMemoryFree(pTscObj);
 
   tscTrace("end to destroy tscObj %" PRIx64 " p:%p", tscId, pTscObj);
@@ -266,6 +267,7 @@ void *createTscObj(const char *user, const char *auth, const char *db, int32_t c
   }
 
   taosThreadMutexInit(&pObj->mutex, NULL);
+  tsem_init(&pObj->stmtSem, 0, tsStmtMaxInflight);
   pObj->id = taosAddRef(clientConnRefPool, pObj);
   pObj->schemalessType = 1;
 
@@ -324,6 +326,7 @@ void doFreeReqResultInfo(SReqResultInfo *pResInfo) {
   taosMemoryFreeClear(pResInfo->fields);
   taosMemoryFreeClear(pResInfo->userFields);
   taosMemoryFreeClear(pResInfo->convertJson);
+  taosMemoryFreeClear(pResInfo->decompBuf);
 
   if (pResInfo->convertBuf != NULL) {
     for (int32_t i = 0; i < pResInfo->numOfCols; ++i) {
@@ -923,7 +923,8 @@ void schedulerExecCb(SExecResult* pResult, void* param, int32_t code) {
   tscDebug("0x%" PRIx64 " enter scheduler exec cb, code:%s, reqId:0x%" PRIx64, pRequest->self, tstrerror(code),
            pRequest->requestId);
 
-  if (code != TSDB_CODE_SUCCESS && NEED_CLIENT_HANDLE_ERROR(code) && pRequest->sqlstr != NULL) {
+  if (code != TSDB_CODE_SUCCESS && NEED_CLIENT_HANDLE_ERROR(code) && pRequest->sqlstr != NULL &&
+      !pRequest->isStmtBind) {
     tscDebug("0x%" PRIx64 " client retry to handle the error, code:%s, tryCount:%d, reqId:0x%" PRIx64, pRequest->self,
              tstrerror(code), pRequest->retry, pRequest->requestId);
     pRequest->prevCode = code;
@@ -1145,10 +1146,14 @@ void launchAsyncQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaData* pResultM
 }
 
 int32_t refreshMeta(STscObj* pTscObj, SRequestObj* pRequest) {
+  return refreshMetaOfList(pTscObj, pRequest->requestId, pRequest->self, pRequest->dbList, pRequest->tableList);
+}
+
+int32_t refreshMetaOfList(STscObj* pTscObj, uint64_t requestId, int64_t refId, SArray* dbList, SArray* tableList) {
   SCatalog* pCatalog = NULL;
   int32_t   code = 0;
-  int32_t   dbNum = taosArrayGetSize(pRequest->dbList);
-  int32_t   tblNum = taosArrayGetSize(pRequest->tableList);
+  int32_t   dbNum = taosArrayGetSize(dbList);
+  int32_t   tblNum = taosArrayGetSize(tableList);
 
   if (dbNum <= 0 && tblNum <= 0) {
     return TSDB_CODE_APP_ERROR;
@@ -1160,12 +1165,12 @@ int32_t refreshMeta(STscObj* pTscObj, SRequestObj* pRequest) {
   }
 
   SRequestConnInfo conn = {.pTrans = pTscObj->pAppInfo->pTransporter,
-                           .requestId = pRequest->requestId,
-                           .requestObjRefId = pRequest->self,
+                           .requestId = requestId,
+                           .requestObjRefId = refId,
                            .mgmtEps = getEpSet_s(&pTscObj->pAppInfo->mgmtEp)};
 
   for (int32_t i = 0; i < dbNum; ++i) {
-    char* dbFName = taosArrayGet(pRequest->dbList, i);
+    char* dbFName = taosArrayGet(dbList, i);
 
     code = catalogRefreshDBVgInfo(pCatalog, &conn, dbFName);
     if (code != TSDB_CODE_SUCCESS) {
@@ -1174,7 +1179,7 @@ int32_t refreshMeta(STscObj* pTscObj, SRequestObj* pRequest) {
   }
 
   for (int32_t i = 0; i < tblNum; ++i) {
-    SName* tableName = taosArrayGet(pRequest->tableList, i);
+    SName* tableName = taosArrayGet(tableList, i);
 
     code = catalogRefreshTableMeta(pCatalog, &conn, tableName, -1);
     if (code != TSDB_CODE_SUCCESS) {
@@ -1964,6 +1969,30 @@ void resetConnectDB(STscObj* pTscObj) {
   taosThreadMutexUnlock(&pTscObj->mutex);
 }
 
+// restore the compressed block to the plain format, so the result can be accessed in place.
+static int32_t doDecompressResult(SReqResultInfo* pResultInfo) {
+  int32_t len = blockGetDecompressSize(pResultInfo->pData);
+  if (pResultInfo->decompBufSize < len) {
+    char* p = taosMemoryRealloc(pResultInfo->decompBuf, len);
+    if (p == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    pResultInfo->decompBuf = p;
+    pResultInfo->decompBufSize = len;
+  }
+
+  len = blockDecompress(pResultInfo->pData, pResultInfo->decompBuf);
+  if (len < 0) {
+    tscError("failed to decompress result block, code:%s", tstrerror(terrno));
+    return terrno;
+  }
+
+  pResultInfo->pData = pResultInfo->decompBuf;
+  pResultInfo->payloadLen = len;
+  return TSDB_CODE_SUCCESS;
+}
+
 int32_t setQueryResultFromRsp(SReqResultInfo* pResultInfo, const SRetrieveTableRsp* pRsp, bool convertUcs4,
                               bool freeAfterUse) {
   assert(pResultInfo != NULL && pRsp != NULL);
@@ -1978,7 +2007,13 @@ int32_t setQueryResultFromRsp(SReqResultInfo* pResultInfo, const SRetrieveTableR
   pResultInfo->payloadLen = htonl(pRsp->compLen);
   pResultInfo->precision = pRsp->precision;
 
-  // TODO handle the compressed case
+  if (pRsp->compressed && pResultInfo->numOfRows > 0 && blockIsCompressed(pResultInfo->pData)) {
+    int32_t code = doDecompressResult(pResultInfo);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
   pResultInfo->totalRows += pResultInfo->numOfRows;
   return setResultDataPtr(pResultInfo, pResultInfo->fields, pResultInfo->numOfCols, pResultInfo->numOfRows,
                           convertUcs4);
@@ -1472,6 +1472,16 @@ int taos_stmt_execute(TAOS_STMT *stmt) {
   return stmtExec(stmt);
 }
 
+int taos_stmt_execute_a(TAOS_STMT *stmt, __taos_async_fn_t fp, void *param) {
+  if (stmt == NULL || fp == NULL) {
+    tscError("NULL parameter for %s", __FUNCTION__);
+    terrno = TSDB_CODE_INVALID_PARA;
+    return terrno;
+  }
+
+  return stmtExecAsync(stmt, fp, param);
+}
+
 int taos_stmt_is_insert(TAOS_STMT *stmt, int *insert) {
   if (stmt == NULL || insert == NULL) {
     tscError("NULL parameter for %s", __FUNCTION__);
@@ -611,11 +611,85 @@ end:
   return code;
 }
 
+#define SML_MAX_FAST_DIGITS   19
+#define SML_MAX_EXACT_INTEGER (1ULL << 53)
+
+static const double smlPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/*
+ * Parse the leading plain decimal of pVal, like 12, -3.25 or 0.5, without strtod. The value is exact if it is an
+ * integer, or its digits fit in 53 bits and it has no more than 22 fraction digits, in which case one division by an
+ * exact power of 10 is correctly rounded. Return false for anything else, e.g. exponent, hex, inf or too many
+ * digits, and the caller falls back to taosStr2Double.
+ */
+static bool smlFastStr2Number(const char *pVal, int32_t len, char **endptr, double *pDouble, int64_t *pInt,
+                              bool *isInt) {
+  const char *p = pVal;
+  const char *pEnd = pVal + len;
+  bool        neg = false;
+  uint64_t    mantissa = 0;
+  int32_t     digits = 0;
+  int32_t     fraction = 0;
+
+  if (p < pEnd && (*p == '-' || *p == '+')) {
+    neg = (*p == '-');
+    p++;
+  }
+
+  const char *start = p;
+  while (p < pEnd && isdigit(*p)) {
+    if (digits >= SML_MAX_FAST_DIGITS) return false;
+    mantissa = mantissa * 10 + (*p - '0');
+    if (mantissa > 0) digits++;
+    p++;
+  }
+  int32_t intLen = p - start;
+
+  if (p < pEnd && *p == '.') {
+    p++;
+    while (p < pEnd && isdigit(*p)) {
+      if (digits >= SML_MAX_FAST_DIGITS) return false;
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa > 0) digits++;
+      fraction++;
+      p++;
+    }
+    if (intLen == 0 && fraction == 0) return false;
+    *isInt = false;
+  } else {
+    if (intLen == 0) return false;
+    *isInt = (mantissa <= (uint64_t)INT64_MAX);
+  }
+
+  if (p < pEnd && (*p == 'e' || *p == 'E' || *p == 'x' || *p == 'X')) return false;
+
+  if (*isInt) {
+    *pInt = neg ? -(int64_t)mantissa : (int64_t)mantissa;
+    *pDouble = (double)(*pInt);
+  } else if (fraction == 0) {
+    *pDouble = neg ? -(double)mantissa : (double)mantissa;
+  } else {
+    if (mantissa > SML_MAX_EXACT_INTEGER || fraction >= tListLen(smlPow10)) return false;
+    *pDouble = (double)mantissa / smlPow10[fraction];
+    if (neg) *pDouble = -*pDouble;
+  }
+
+  *endptr = (char *)p;
+  return true;
+}
+
 static bool smlParseNumber(SSmlKv *kvVal, SSmlMsgBuf *msg) {
   const char *pVal = kvVal->value;
   int32_t     len = kvVal->length;
   char       *endptr = NULL;
-  double      result = taosStr2Double(pVal, &endptr);
+  double      result = 0;
+  int64_t     iResult = 0;
+  bool        isInt = false;
+  if (!smlFastStr2Number(pVal, len, &endptr, &result, &iResult, &isInt)) {
+    isInt = false;
+    result = taosStr2Double(pVal, &endptr);
+  }
   if (pVal == endptr) {
     smlBuildInvalidDataMsg(msg, "invalid data", pVal);
     return false;
@@ -633,6 +707,11 @@ static bool smlParseNumber(SSmlKv *kvVal, SSmlMsgBuf *msg) {
     kvVal->type = TSDB_DATA_TYPE_FLOAT;
     kvVal->f = (float)result;
   } else if ((left == 1 && *endptr == 'i') || (left == 3 && strncasecmp(endptr, "i64", left) == 0)) {
+    if (isInt) {
+      kvVal->type = TSDB_DATA_TYPE_BIGINT;
+      kvVal->i = iResult;
+      return true;
+    }
     if (smlDoubleToInt64OverFlow(result)) {
       errno = 0;
       int64_t tmp = taosStr2Int64(pVal, &endptr, 10);
@@ -647,6 +726,11 @@ static bool smlParseNumber(SSmlKv *kvVal, SSmlMsgBuf *msg) {
     kvVal->type = TSDB_DATA_TYPE_BIGINT;
     kvVal->i = (int64_t)result;
   } else if ((left == 1 && *endptr == 'u') || (left == 3 && strncasecmp(endptr, "u64", left) == 0)) {
+    if (isInt && iResult >= 0) {
+      kvVal->type = TSDB_DATA_TYPE_UBIGINT;
+      kvVal->u = iResult;
+      return true;
+    }
     if (result >= (double)UINT64_MAX || result < 0) {
       errno = 0;
       uint64_t tmp = taosStr2UInt64(pVal, &endptr, 10);
@@ -1404,14 +1488,19 @@ static int32_t smlKvTimeHashCompare(const void *key1, const void *key2) {
   }
 }
 
+// insert the row after the rows with the same or smaller timestamp, rows are SArray if dataFormat, otherwise SHashObj
+static void smlInsertRow(SSmlTableInfo *oneTable, bool dataFormat, void *row) {
+  void *p = taosArraySearch(oneTable->cols, &row, dataFormat ? smlKvTimeArrayCompare : smlKvTimeHashCompare, TD_GT);
+  if (p == NULL) {
+    taosArrayPush(oneTable->cols, &row);
+  } else {
+    taosArrayInsert(oneTable->cols, TARRAY_ELEM_IDX(oneTable->cols, p), &row);
+  }
+}
+
 static int32_t smlDealCols(SSmlTableInfo *oneTable, bool dataFormat, SArray *cols) {
   if (dataFormat) {
-    void *p = taosArraySearch(oneTable->cols, &cols, smlKvTimeArrayCompare, TD_GT);
-    if (p == NULL) {
-      taosArrayPush(oneTable->cols, &cols);
-    } else {
-      taosArrayInsert(oneTable->cols, TARRAY_ELEM_IDX(oneTable->cols, p), &cols);
-    }
+    smlInsertRow(oneTable, dataFormat, cols);
     return TSDB_CODE_SUCCESS;
   }
 
@@ -1425,12 +1514,7 @@ static int32_t smlDealCols(SSmlTableInfo *oneTable, bool dataFormat, SArray *col
     taosHashPut(kvHash, kv->key, kv->keyLen, &kv, POINTER_BYTES);
   }
 
-  void *p = taosArraySearch(oneTable->cols, &kvHash, smlKvTimeHashCompare, TD_GT);
-  if (p == NULL) {
-    taosArrayPush(oneTable->cols, &kvHash);
-  } else {
-    taosArrayInsert(oneTable->cols, TARRAY_ELEM_IDX(oneTable->cols, p), &kvHash);
-  }
+  smlInsertRow(oneTable, dataFormat, kvHash);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -2379,6 +2463,263 @@ static void smlPrintStatisticInfo(SSmlHandle *info) {
          info->cost.endTime - info->cost.insertRpcTime, info->cost.endTime - info->cost.parseTime);
 }
 
+/*
+ * The lines of a batch are split into chunks, which are parsed concurrently into their own child tables and super
+ * tables, and then merged into the handle in the order of the chunks, so the rows of a child table keep the same order
+ * as they are parsed line by line. The caller parses chunks as well, so the parsing goes on even if the task queue is
+ * busy.
+ */
+#define SML_MIN_LINES_PER_CHUNK 1000
+
+typedef struct {
+  SSmlHandle *info;  // parsed into
+  int32_t     start;
+  int32_t     num;
+  int32_t     code;
+} SSmlParseChunk;
+
+typedef struct {
+  char          **lines;
+  int32_t        *lens;  // NULL if lines are null terminated
+  SSmlParseChunk *chunks;
+  int32_t         numOfChunks;
+  int32_t         nextChunk;
+  int32_t         numOfDone;
+  int32_t         ref;
+  tsem_t          sem;
+} SSmlParseJob;
+
+static SSmlHandle *smlBuildParseInfo(SSmlHandle *info) {
+  SSmlHandle *pInfo = (SSmlHandle *)taosMemoryCalloc(1, sizeof(SSmlHandle));
+  if (NULL == pInfo) {
+    return NULL;
+  }
+
+  pInfo->id = info->id;
+  pInfo->protocol = info->protocol;
+  pInfo->precision = info->precision;
+  pInfo->dataFormat = info->dataFormat;
+  pInfo->isRawLine = info->isRawLine;
+  pInfo->msgBuf.len = ERROR_MSG_BUF_DEFAULT_SIZE;
+  pInfo->msgBuf.buf = (char *)taosMemoryCalloc(1, ERROR_MSG_BUF_DEFAULT_SIZE);
+  pInfo->childTables = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  pInfo->superTables = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  pInfo->dumplicateKey = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  if (!pInfo->dataFormat) {
+    pInfo->colsContainer = taosArrayInit(32, POINTER_BYTES);
+  }
+  if (NULL == pInfo->msgBuf.buf || NULL == pInfo->childTables || NULL == pInfo->superTables ||
+      NULL == pInfo->dumplicateKey || (!pInfo->dataFormat && NULL == pInfo->colsContainer)) {
+    uError("SML:0x%" PRIx64 " create parse info failed", info->id);
+    taosMemoryFree(pInfo->msgBuf.buf);
+    smlDestroyInfo(pInfo);
+    return NULL;
+  }
+
+  return pInfo;
+}
+
+static void smlDestroyParseInfo(SSmlHandle *pInfo) {
+  if (!pInfo) return;
+  taosMemoryFree(pInfo->msgBuf.buf);
+  smlDestroyInfo(pInfo);
+}
+
+/*
+ * Move the child tables and super tables parsed into pInfo to info. Tags of a super table are rebuilt from the child
+ * tables that are new to info, since the child tables that info already has are dropped with their tags.
+ */
+static int32_t smlMergeParseInfo(SSmlHandle *info, SSmlHandle *pInfo) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  SArray *newTables = taosArrayInit(taosHashGetSize(pInfo->childTables), POINTER_BYTES);
+  if (newTables == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SSmlTableInfo **ppTable = (SSmlTableInfo **)taosHashIterate(pInfo->childTables, NULL);
+  while (ppTable) {
+    size_t          keyLen = 0;
+    void           *key = taosHashGetKey(ppTable, &keyLen);
+    SSmlTableInfo  *tinfo = *ppTable;
+    SSmlTableInfo **oneTable = (SSmlTableInfo **)taosHashGet(info->childTables, key, keyLen);
+    if (oneTable) {
+      for (int32_t i = 0; i < taosArrayGetSize(tinfo->cols); ++i) {
+        void *row = taosArrayGetP(tinfo->cols, i);
+        if (info->protocol == TSDB_SML_LINE_PROTOCOL) {
+          smlInsertRow(*oneTable, info->dataFormat, row);
+        } else {
+          taosArrayPush((*oneTable)->cols, &row);
+        }
+      }
+      taosArrayClear(tinfo->cols);
+      smlDestroyTableInfo(pInfo, tinfo);
+    } else {
+      tinfo->uid = info->uid++;
+      taosHashPut(info->childTables, key, keyLen, &tinfo, POINTER_BYTES);
+      taosArrayPush(newTables, &tinfo);
+    }
+    ppTable = (SSmlTableInfo **)taosHashIterate(pInfo->childTables, ppTable);
+  }
+  taosHashClear(pInfo->childTables);
+
+  SSmlSTableMeta **ppMeta = (SSmlSTableMeta **)taosHashIterate(pInfo->superTables, NULL);
+  while (ppMeta) {
+    size_t           keyLen = 0;
+    void            *key = taosHashGetKey(ppMeta, &keyLen);
+    SSmlSTableMeta  *meta = *ppMeta;
+    SSmlSTableMeta **tableMeta = (SSmlSTableMeta **)taosHashGet(info->superTables, key, keyLen);
+    if (tableMeta) {
+      if (code == TSDB_CODE_SUCCESS) {
+        code = smlUpdateMeta((*tableMeta)->colHash, (*tableMeta)->cols, meta->cols, &info->msgBuf);
+      }
+      smlDestroySTableMeta(meta);
+    } else {
+      taosArrayClear(meta->tags);
+      taosHashClear(meta->tagHash);
+      taosHashPut(info->superTables, key, keyLen, &meta, POINTER_BYTES);
+    }
+    ppMeta = (SSmlSTableMeta **)taosHashIterate(pInfo->superTables, ppMeta);
+  }
+  taosHashClear(pInfo->superTables);
+
+  for (int32_t i = 0; i < taosArrayGetSize(newTables) && code == TSDB_CODE_SUCCESS; ++i) {
+    SSmlTableInfo   *tinfo = (SSmlTableInfo *)taosArrayGetP(newTables, i);
+    SSmlSTableMeta **tableMeta =
+        (SSmlSTableMeta **)taosHashGet(info->superTables, tinfo->sTableName, tinfo->sTableNameLen);
+    ASSERT(NULL != tableMeta);
+    code = smlUpdateMeta((*tableMeta)->tagHash, (*tableMeta)->tags, tinfo->tags, &info->msgBuf);
+  }
+
+  taosArrayDestroy(newTables);
+  return code;
+}
+
+static void smlParseChunk(SSmlParseJob *pJob, SSmlParseChunk *pChunk) {
+  SSmlHandle *info = pChunk->info;
+
+  for (int32_t i = pChunk->start; i < pChunk->start + pChunk->num; ++i) {
+    char *tmp = pJob->lines[i];
+    int   len = 0;
+    if (pJob->lens == NULL) {
+      len = strlen(tmp);
+    } else {
+      len = pJob->lens[i];
+      if (info->protocol == TSDB_SML_LINE_PROTOCOL && tmp[0] == '#') {  // this line is comment
+        continue;
+      }
+    }
+
+    if (info->protocol == TSDB_SML_LINE_PROTOCOL) {
+      pChunk->code = smlParseInfluxLine(info, tmp, len);
+    } else if (info->protocol == TSDB_SML_TELNET_PROTOCOL) {
+      pChunk->code = smlParseTelnetLine(info, tmp, len);
+    } else {
+      ASSERT(0);
+    }
+    if (pChunk->code != TSDB_CODE_SUCCESS) {
+      uError("SML:0x%" PRIx64 " smlParseLine failed. line %d : %s", info->id, i, tmp);
+      return;
+    }
+  }
+}
+
+static void smlReleaseParseJob(SSmlParseJob *pJob) {
+  if (atomic_sub_fetch_32(&pJob->ref, 1) == 0) {
+    tsem_destroy(&pJob->sem);
+    taosMemoryFree(pJob);
+  }
+}
+
+// claim and parse the chunks until there is none left, chunks are only touched when claimed
+static int32_t smlParseJobFp(void *param) {
+  SSmlParseJob *pJob = (SSmlParseJob *)param;
+
+  while (1) {
+    int32_t index = atomic_fetch_add_32(&pJob->nextChunk, 1);
+    if (index >= pJob->numOfChunks) break;
+
+    smlParseChunk(pJob, &pJob->chunks[index]);
+    if (atomic_add_fetch_32(&pJob->numOfDone, 1) == pJob->numOfChunks) {
+      tsem_post(&pJob->sem);
+    }
+  }
+
+  smlReleaseParseJob(pJob);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t smlParseLinesParallel(SSmlHandle *info, char *lines[], int32_t *lens, int numLines, int32_t numOfChunks) {
+  int32_t         code = TSDB_CODE_SUCCESS;
+  SSmlParseJob   *pJob = (SSmlParseJob *)taosMemoryCalloc(1, sizeof(SSmlParseJob));
+  SSmlParseChunk *chunks = (SSmlParseChunk *)taosMemoryCalloc(numOfChunks, sizeof(SSmlParseChunk));
+  if (pJob == NULL || chunks == NULL) {
+    taosMemoryFree(pJob);
+    taosMemoryFree(chunks);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  // the first chunk is parsed into info directly
+  int32_t start = 0;
+  for (int32_t i = 0; i < numOfChunks; ++i) {
+    chunks[i].start = start;
+    chunks[i].num = numLines / numOfChunks + ((i < numLines % numOfChunks) ? 1 : 0);
+    chunks[i].info = (i == 0) ? info : smlBuildParseInfo(info);
+    if (chunks[i].info == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      numOfChunks = i;
+      goto _end;
+    }
+    start += chunks[i].num;
+  }
+
+  pJob->lines = lines;
+  pJob->lens = lens;
+  pJob->chunks = chunks;
+  pJob->numOfChunks = numOfChunks;
+  pJob->ref = 1;
+  tsem_init(&pJob->sem, 0, 0);
+
+  for (int32_t i = 1; i < numOfChunks; ++i) {
+    atomic_add_fetch_32(&pJob->ref, 1);
+    if (taosAsyncExec(smlParseJobFp, pJob, NULL) != 0) {
+      atomic_sub_fetch_32(&pJob->ref, 1);
+      break;
+    }
+  }
+
+  atomic_add_fetch_32(&pJob->ref, 1);
+  smlParseJobFp(pJob);
+  tsem_wait(&pJob->sem);
+  smlReleaseParseJob(pJob);
+  pJob = NULL;
+
+  for (int32_t i = 0; i < numOfChunks; ++i) {
+    if (chunks[i].code != TSDB_CODE_SUCCESS) {
+      code = chunks[i].code;
+      if (i > 0 && info->msgBuf.buf) {
+        tstrncpy(info->msgBuf.buf, chunks[i].info->msgBuf.buf, info->msgBuf.len);
+      }
+      goto _end;
+    }
+  }
+
+  for (int32_t i = 1; i < numOfChunks; ++i) {
+    code = smlMergeParseInfo(info, chunks[i].info);
+    if (code != TSDB_CODE_SUCCESS) {
+      uError("SML:0x%" PRIx64 " merge parsed lines failed", info->id);
+      goto _end;
+    }
+  }
+
+_end:
+  for (int32_t i = 1; i < numOfChunks; ++i) {
+    smlDestroyParseInfo(chunks[i].info);
+  }
+  taosMemoryFree(chunks);
+  taosMemoryFree(pJob);  // not started
+  return code;
+}
+
 static int32_t smlParseLine(SSmlHandle *info, char *lines[], char *rawLine, char *rawLineEnd, int numLines) {
   int32_t code = TSDB_CODE_SUCCESS;
   if (info->protocol == TSDB_SML_JSON_PROTOCOL) {
@@ -2394,36 +2735,41 @@ static int32_t smlParseLine(SSmlHandle *info, char *lines[], char *rawLine, char
     return code;
   }
 
-  for (int32_t i = 0; i < numLines; ++i) {
-    char *tmp = NULL;
-    int   len = 0;
-    if (lines) {
-      tmp = lines[i];
-      len = strlen(tmp);
-    } else if (rawLine) {
-      tmp = rawLine;
+  int32_t *lens = NULL;
+  if (rawLine) {
+    lines = (char **)taosMemoryMalloc(numLines * POINTER_BYTES);
+    lens = (int32_t *)taosMemoryMalloc(numLines * sizeof(int32_t));
+    if (lines == NULL || lens == NULL) {
+      taosMemoryFree(lines);
+      taosMemoryFree(lens);
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    for (int32_t i = 0; i < numLines; ++i) {
+      lines[i] = rawLine;
+      lens[i] = 0;
       while (rawLine < rawLineEnd) {
         if (*(rawLine++) == '\n') {
           break;
         }
-        len++;
-      }
-      if (info->protocol == TSDB_SML_LINE_PROTOCOL && tmp[0] == '#') {  // this line is comment
-        continue;
+        lens[i]++;
       }
     }
+  }
 
-    if (info->protocol == TSDB_SML_LINE_PROTOCOL) {
-      code = smlParseInfluxLine(info, tmp, len);
-    } else if (info->protocol == TSDB_SML_TELNET_PROTOCOL) {
-      code = smlParseTelnetLine(info, tmp, len);
-    } else {
-      ASSERT(0);
-    }
-    if (code != TSDB_CODE_SUCCESS) {
-      uError("SML:0x%" PRIx64 " smlParseLine failed. line %d : %s", info->id, i, tmp);
-      return code;
-    }
+  int32_t numOfChunks = TMIN(tsSmlParseThreads, numLines / SML_MIN_LINES_PER_CHUNK);
+  if (numOfChunks > 1) {
+    code = smlParseLinesParallel(info, lines, lens, numLines, numOfChunks);
+  } else {
+    SSmlParseJob   job = {.lines = lines, .lens = lens};
+    SSmlParseChunk chunk = {.info = info, .start = 0, .num = numLines};
+    smlParseChunk(&job, &chunk);
+    code = chunk.code;
+  }
+
+  if (lens) {
+    taosMemoryFree(lines);
+    taosMemoryFree(lens);
   }
   return code;
 }
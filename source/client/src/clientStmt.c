@@ -8,6 +8,9 @@
 char* gStmtStatusStr[] = {"unknown",     "init", "prepare", "settbname", "settags",
                           "fetchFields", "bind", "bindCol", "addBatch",  "exec"};
 
+// set while the thread runs the callback of an async exec
+static threadlocal int8_t tscStmtInExecCb = 0;
+
 static int32_t stmtCreateRequest(STscStmt* pStmt) {
   int32_t code = 0;
 
@@ -504,6 +507,57 @@ int32_t stmtGetFromCache(STscStmt* pStmt) {
   return TSDB_CODE_SUCCESS;
 }
 
+static void stmtWaitAsyncExec(STscStmt* pStmt) {
+  taosThreadMutexLock(&pStmt->async.mutex);
+  while (pStmt->async.numOfInflight > 0) {
+    taosThreadCondWait(&pStmt->async.cond, &pStmt->async.mutex);
+  }
+  taosThreadMutexUnlock(&pStmt->async.mutex);
+}
+
+static void stmtAddStaleList(SArray** ppList, SArray* pList, int32_t size) {
+  if (NULL == *ppList) {
+    *ppList = taosArrayInit(4, size);
+    if (NULL == *ppList) return;
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pList); ++i) {
+    void* pItem = taosArrayGet(pList, i);
+    bool  exist = false;
+    for (int32_t j = 0; j < taosArrayGetSize(*ppList) && !exist; ++j) {
+      exist = (0 == memcmp(taosArrayGet(*ppList, j), pItem, size));
+    }
+    if (!exist) {
+      taosArrayPush(*ppList, pItem);
+    }
+  }
+}
+
+// called with async.mutex locked
+static void stmtAddStaleMeta(STscStmt* pStmt, SRequestObj* pRequest) {
+  stmtAddStaleList(&pStmt->async.pStaleDbs, pRequest->dbList, TSDB_DB_FNAME_LEN);
+  stmtAddStaleList(&pStmt->async.pStaleTbs, pRequest->tableList, sizeof(SName));
+}
+
+// refresh the meta of the batches failed in stmtExecAsync on the app thread
+static int32_t stmtRefreshStaleMeta(STscStmt* pStmt) {
+  taosThreadMutexLock(&pStmt->async.mutex);
+  SArray* pDbs = pStmt->async.pStaleDbs;
+  SArray* pTbs = pStmt->async.pStaleTbs;
+  pStmt->async.pStaleDbs = NULL;
+  pStmt->async.pStaleTbs = NULL;
+  taosThreadMutexUnlock(&pStmt->async.mutex);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (taosArrayGetSize(pDbs) > 0 || taosArrayGetSize(pTbs) > 0) {
+    code = refreshMetaOfList(pStmt->taos, generateRequestId(), 0, pDbs, pTbs);
+  }
+
+  taosArrayDestroy(pDbs);
+  taosArrayDestroy(pTbs);
+  return code;
+}
+
 int32_t stmtResetStmt(STscStmt* pStmt) {
   STMT_ERR_RET(stmtCleanSQLInfo(pStmt));
 
@@ -535,6 +589,9 @@ TAOS_STMT* stmtInit(STscObj* taos, int64_t reqid) {
     return NULL;
   }
 
+  taosThreadMutexInit(&pStmt->async.mutex, NULL);
+  taosThreadCondInit(&pStmt->async.cond, NULL);
+
   pStmt->taos = pObj;
   pStmt->bInfo.needParse = true;
   pStmt->sql.status = STMT_INIT;
@@ -552,6 +609,9 @@ int stmtPrepare(TAOS_STMT* stmt, const char* sql, unsigned long length) {
 
   STMT_DLOG_E("start to prepare");
 
+  stmtWaitAsyncExec(pStmt);
+  STMT_ERR_RET(stmtRefreshStaleMeta(pStmt));
+
   if (pStmt->sql.status >= STMT_PREPARE) {
     STMT_ERR_RET(stmtResetStmt(pStmt));
   }
@@ -862,6 +922,8 @@ int stmtExec(TAOS_STMT* stmt) {
 
   STMT_DLOG_E("start to exec");
 
+  stmtWaitAsyncExec(pStmt);
+
   STMT_ERR_RET(stmtSwitchStatus(pStmt, STMT_EXECUTE));
 
   if (STMT_TYPE_QUERY == pStmt->sql.type) {
@@ -907,10 +969,161 @@ _return:
   STMT_RET(code);
 }
 
+static void stmtExecAsyncCb(void* param, TAOS_RES* res, int32_t code) {
+  SStmtAsyncParam* pParam = (SStmtAsyncParam*)param;
+  STscStmt*        pStmt = pParam->pStmt;
+  SRequestObj*     pRequest = (SRequestObj*)res;
+  SSubmitRsp*      pRsp = NULL;
+  bool             staleMeta = false;
+
+  // the meta can not be refreshed on this thread since it waits for rsps handled by the same threads, so it is left
+  // to the next prepare of the app
+  if (code && NEED_CLIENT_HANDLE_ERROR(code) &&
+      (taosArrayGetSize(pRequest->dbList) > 0 || taosArrayGetSize(pRequest->tableList) > 0)) {
+    staleMeta = true;
+    code = TSDB_CODE_NEED_RETRY;
+  }
+
+  if (TSDB_CODE_SUCCESS == code) {
+    atomic_add_fetch_32(&pStmt->affectedRows, taos_affected_rows(pRequest));
+    if (pParam->autoCreateTbl) {
+      pRsp = pRequest->body.resInfo.execRes.res;
+      pRequest->body.resInfo.execRes.res = NULL;
+    }
+  }
+
+  // the stmt is released before the app is called back, which may exec the next batch or close the stmt
+  tsem_post(&pRequest->pTscObj->stmtSem);
+
+  taosThreadMutexLock(&pStmt->async.mutex);
+  if (pRsp) {
+    tFreeSSubmitRsp(pStmt->async.pRsp);
+    pStmt->async.pRsp = pRsp;
+  }
+  if (staleMeta) {
+    stmtAddStaleMeta(pStmt, pRequest);
+  }
+  --pStmt->async.numOfInflight;
+  taosThreadCondBroadcast(&pStmt->async.cond);
+  taosThreadMutexUnlock(&pStmt->async.mutex);
+
+  pRequest->code = code;
+  int8_t inExecCb = tscStmtInExecCb;
+  tscStmtInExecCb = 1;
+  pParam->fp(pParam->param, pRequest, code);
+  tscStmtInExecCb = inExecCb;
+
+  taos_free_result(pRequest);
+  taosMemoryFree(pParam);
+}
+
+int stmtExecAsync(TAOS_STMT* stmt, __taos_async_fn_t fp, void* param) {
+  STscStmt*            pStmt = (STscStmt*)stmt;
+  int32_t              code = 0;
+  bool                 autoCreateTbl = pStmt->exec.autoCreateTbl;
+  SStmtAsyncParam*     pParam = NULL;
+  SSqlCallbackWrapper* pWrapper = NULL;
+  SRequestObj*         pRequest = NULL;
+
+  STMT_DLOG_E("start to exec async");
+
+  if (STMT_TYPE_QUERY == pStmt->sql.type) {
+    tscError("async exec not available for query statement");
+    STMT_ERR_RET(TSDB_CODE_TSC_STMT_API_ERROR);
+  }
+
+  // wait for a free slot of the in-flight window of the connection. The callbacks run on the threads handling the
+  // responses, so a callback blocked on the window could wait for itself. It fails instead, the bound batch is kept.
+  if (tscStmtInExecCb) {
+    if (tsem_timewait(&pStmt->taos->stmtSem, 0) != 0) {
+      tscDebug("stmt:%p, in-flight window full in the exec callback", pStmt);
+      STMT_ERR_RET(TSDB_CODE_TSC_STMT_BUSY);
+    }
+  } else {
+    tsem_wait(&pStmt->taos->stmtSem);
+  }
+
+  code = stmtSwitchStatus(pStmt, STMT_EXECUTE);
+  if (code) {
+    tsem_post(&pStmt->taos->stmtSem);
+    STMT_ERR_RET(code);
+  }
+
+  pParam = taosMemoryCalloc(1, sizeof(SStmtAsyncParam));
+  pWrapper = taosMemoryCalloc(1, sizeof(SSqlCallbackWrapper));
+  if (NULL == pParam || NULL == pWrapper) {
+    STMT_ERR_JRET(TSDB_CODE_OUT_OF_MEMORY);
+  }
+
+  STMT_ERR_JRET(qBuildStmtOutput(pStmt->sql.pQuery, pStmt->sql.pVgHash, pStmt->exec.pBlockHash));
+
+  // the request is taken over by the async exec, the next bind creates a new one
+  pRequest = pStmt->exec.pRequest;
+  pStmt->exec.pRequest = NULL;
+  if (pRequest->syncQuery) {
+    freeQueryParam(pRequest->body.param);
+    pRequest->syncQuery = false;
+  }
+
+  pParam->pStmt = pStmt;
+  pParam->fp = fp;
+  pParam->param = param;
+  pParam->autoCreateTbl = autoCreateTbl;
+  pRequest->body.param = pParam;
+  pRequest->body.queryFp = stmtExecAsyncCb;
+  pRequest->isStmtBind = true;
+  pRequest->stmtType = nodeType(pStmt->sql.pQuery->pRoot);
+  pWrapper->pRequest = pRequest;
+
+  atomic_add_fetch_64((int64_t*)&pStmt->taos->pAppInfo->summary.numOfInsertsReq, 1);
+
+  taosThreadMutexLock(&pStmt->async.mutex);
+  ++pStmt->async.numOfInflight;
+  taosThreadMutexUnlock(&pStmt->async.mutex);
+
+  // the data blocks are moved into the plan, so the query can be bound again once the launch returns
+  launchAsyncQuery(pRequest, pStmt->sql.pQuery, NULL, pWrapper);
+  pParam = NULL;
+  pWrapper = NULL;
+
+_return:
+
+  if (code) {
+    tsem_post(&pStmt->taos->stmtSem);
+  }
+  taosMemoryFree(pParam);
+  taosMemoryFree(pWrapper);
+
+  stmtCleanExecInfo(pStmt, (code ? false : true), false);
+
+  if (TSDB_CODE_SUCCESS == code && autoCreateTbl) {
+    // the uid of the created table is needed by the next bind, so this batch has to be responded first
+    stmtWaitAsyncExec(pStmt);
+
+    SSubmitRsp* pRsp = pStmt->async.pRsp;
+    pStmt->async.pRsp = NULL;
+    if (pRsp) {
+      code = stmtUpdateTableUid(pStmt, pRsp);
+      tFreeSSubmitRsp(pRsp);
+    }
+  }
+
+  ++pStmt->sql.runTimes;
+
+  STMT_RET(code);
+}
+
 int stmtClose(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
 
+  stmtWaitAsyncExec(pStmt);
+
   stmtCleanSQLInfo(pStmt);
+  tFreeSSubmitRsp(pStmt->async.pRsp);
+  taosArrayDestroy(pStmt->async.pStaleDbs);
+  taosArrayDestroy(pStmt->async.pStaleTbs);
+  taosThreadCondDestroy(&pStmt->async.cond);
+  taosThreadMutexDestroy(&pStmt->async.mutex);
   taosMemoryFree(stmt);
 
   return TSDB_CODE_SUCCESS;
@@ -14,6 +14,8 @@
  */
 
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
 
 #include <taoserror.h>
 #include <tglobal.h>
@@ -514,6 +516,51 @@ TEST(testCase, smlParseNumber_Test) {
   printf("res:%d,v:%f, %f\n", res, kv.d, HUGE_VAL);
 }
 
+TEST(testCase, smlParseNumber_fast_Test) {
+  SSmlKv     kv = {0};
+  char       buf[64] = {0};
+  SSmlMsgBuf msg = {0};
+  msg.buf = buf;
+  msg.len = 64;
+
+  const char *data[] = {"12", "-3.25", "0.1", "00012.50", ".5", "+7", "123456789012345678", "0.30000000000000004",
+                        "1e5", "0x10", "12345678901234567.89", "1.7976931348623157e308"};
+  for (int i = 0; i < sizeof(data) / sizeof(data[0]); i++) {
+    kv.value = data[i];
+    kv.length = strlen(data[i]);
+    ASSERT_TRUE(smlParseNumber(&kv, &msg));
+    ASSERT_EQ(kv.type, TSDB_DATA_TYPE_DOUBLE);
+    ASSERT_EQ(kv.d, taosStr2Double(data[i], NULL));
+  }
+
+  kv.value = "9223372036854775807i64";
+  kv.length = strlen(kv.value);
+  ASSERT_TRUE(smlParseNumber(&kv, &msg));
+  ASSERT_EQ(kv.type, TSDB_DATA_TYPE_BIGINT);
+  ASSERT_EQ(kv.i, INT64_MAX);
+
+  kv.value = "-9223372036854775808i";
+  kv.length = strlen(kv.value);
+  ASSERT_TRUE(smlParseNumber(&kv, &msg));
+  ASSERT_EQ(kv.i, INT64_MIN);
+
+  kv.value = "18446744073709551615u64";
+  kv.length = strlen(kv.value);
+  ASSERT_TRUE(smlParseNumber(&kv, &msg));
+  ASSERT_EQ(kv.type, TSDB_DATA_TYPE_UBIGINT);
+  ASSERT_EQ(kv.u, UINT64_MAX);
+
+  kv.value = "-1u";
+  kv.length = strlen(kv.value);
+  ASSERT_FALSE(smlParseNumber(&kv, &msg));
+
+  kv.value = "3.25i8";
+  kv.length = strlen(kv.value);
+  ASSERT_TRUE(smlParseNumber(&kv, &msg));
+  ASSERT_EQ(kv.type, TSDB_DATA_TYPE_TINYINT);
+  ASSERT_EQ(kv.i, 3);
+}
+
 TEST(testCase, smlParseTelnetLine_error_Test) {
   SSmlHandle *info = smlBuildSmlInfo(NULL, NULL, TSDB_SML_TELNET_PROTOCOL, TSDB_SML_TIMESTAMP_NANO_SECONDS);
   ASSERT_NE(info, nullptr);
@@ -1008,3 +1055,143 @@ TEST(testCase, sml_col_4096_Test) {
   ASSERT_NE(ret, 0);
   smlDestroyInfo(info);
 }
+
+namespace {
+
+const int32_t numOfParseLines = 4000;
+const int32_t numOfParseTables = 5;
+const int32_t lateTable = 9;  // only appears in the last chunk, with a tag of its own
+
+int32_t lineTable(int32_t line) {
+  return (line >= numOfParseLines - 500 && line % 50 == 0) ? lateTable : line % numOfParseTables;
+}
+
+// each child table gets the rows of every numOfParseTables-th line, and pairs of its rows share a timestamp, so rows
+// with the same timestamp have to keep the order of lines as well
+std::vector<std::string> buildParseLines(SMLProtocolType protocol) {
+  std::vector<std::string> lines;
+  char                     buf[256] = {0};
+  for (int32_t i = 0; i < numOfParseLines; ++i) {
+    int32_t t = lineTable(i);
+    int64_t ts = 1626006833639 + i / (2 * numOfParseTables);
+    if (protocol == TSDB_SML_LINE_PROTOCOL) {
+      snprintf(buf, sizeof(buf), "st,t0=%d%s c0=%di%s %" PRId64 "000000", t, t == lateTable ? ",t1=late" : "", i,
+               i >= numOfParseLines - 1000 ? ",c1=1i" : "", ts);
+    } else {
+      snprintf(buf, sizeof(buf), "st %" PRId64 " %d host=h%d%s", ts, i, t, t == lateTable ? " t1=late" : "");
+    }
+    lines.push_back(buf);
+  }
+  return lines;
+}
+
+SSmlHandle *parseLines(SMLProtocolType protocol, std::vector<std::string> &lines, int32_t numOfThreads) {
+  SSmlHandle *info = smlBuildSmlInfo(NULL, NULL, protocol, TSDB_SML_TIMESTAMP_NANO_SECONDS);
+  if (info == NULL) return NULL;
+
+  std::vector<char *> pLines;
+  for (auto &line : lines) pLines.push_back(&line[0]);
+
+  int32_t parseThreads = tsSmlParseThreads;
+  tsSmlParseThreads = numOfThreads;
+  int32_t code = smlParseLine(info, pLines.data(), NULL, NULL, pLines.size());
+  tsSmlParseThreads = parseThreads;
+  if (code != TSDB_CODE_SUCCESS) {
+    smlDestroyInfo(info);
+    return NULL;
+  }
+  return info;
+}
+
+void getRow(SSmlHandle *info, void *row, int64_t *ts, int64_t *line) {
+  if (info->dataFormat) {
+    *ts = ((SSmlKv *)taosArrayGetP((SArray *)row, 0))->i;
+    SSmlKv *kv = (SSmlKv *)taosArrayGetP((SArray *)row, 1);
+    *line = (info->protocol == TSDB_SML_LINE_PROTOCOL) ? kv->i : (int64_t)kv->d;
+  } else {
+    *ts = (*(SSmlKv **)taosHashGet((SHashObj *)row, TS, TS_LEN))->i;
+    *line = (*(SSmlKv **)taosHashGet((SHashObj *)row, "c0", 2))->i;
+  }
+}
+
+// the rows of each child table come out in the order of lines, whichever chunk they are parsed in
+void checkParsedLines(SSmlHandle *info) {
+  ASSERT_EQ(taosHashGetSize(info->childTables), numOfParseTables + 1);
+  ASSERT_EQ(taosHashGetSize(info->superTables), 1);
+
+  int32_t         numOfRows = 0;
+  SSmlTableInfo **ppTable = (SSmlTableInfo **)taosHashIterate(info->childTables, NULL);
+  while (ppTable) {
+    SSmlTableInfo *tinfo = *ppTable;
+    int64_t        ts = 0, line = 0, lastTs = INT64_MIN;
+    getRow(info, taosArrayGetP(tinfo->cols, 0), &ts, &line);
+
+    int32_t t = lineTable(line);
+    int32_t numOfTableRows = 0;
+    for (int32_t i = 0; i < numOfParseLines; ++i) {
+      if (lineTable(i) != t) continue;
+      ASSERT_LT(numOfTableRows, taosArrayGetSize(tinfo->cols));
+      getRow(info, taosArrayGetP(tinfo->cols, numOfTableRows), &ts, &line);
+      ASSERT_EQ(line, i);
+      ASSERT_GE(ts, lastTs);
+      lastTs = ts;
+      numOfTableRows++;
+    }
+    ASSERT_EQ(taosArrayGetSize(tinfo->cols), numOfTableRows);
+    ASSERT_EQ(taosArrayGetSize(tinfo->tags), t == lateTable ? 2 : 1);
+
+    numOfRows += numOfTableRows;
+    ppTable = (SSmlTableInfo **)taosHashIterate(info->childTables, ppTable);
+  }
+  ASSERT_EQ(numOfRows, numOfParseLines);
+
+  // the columns and tags only seen in the last chunk are merged into the super table
+  SSmlSTableMeta **ppMeta = (SSmlSTableMeta **)taosHashIterate(info->superTables, NULL);
+  ASSERT_NE(ppMeta, nullptr);
+  ASSERT_EQ(taosArrayGetSize((*ppMeta)->tags), 2);
+  if (info->protocol == TSDB_SML_LINE_PROTOCOL) {
+    ASSERT_EQ(taosArrayGetSize((*ppMeta)->cols), 3);
+    ASSERT_NE(taosHashGet((*ppMeta)->colHash, "c1", 2), nullptr);
+  } else {
+    ASSERT_EQ(taosArrayGetSize((*ppMeta)->cols), 2);
+  }
+  ASSERT_NE(taosHashGet((*ppMeta)->tagHash, "t1", 2), nullptr);
+  taosHashCancelIterate(info->superTables, ppMeta);
+}
+
+}  // namespace
+
+TEST(testCase, smlParseLinesParallel_Test) {
+  ASSERT_EQ(initTaskQueue(), 0);
+
+  SMLProtocolType protocols[] = {TSDB_SML_LINE_PROTOCOL, TSDB_SML_TELNET_PROTOCOL};
+  for (int32_t p = 0; p < sizeof(protocols) / sizeof(protocols[0]); ++p) {
+    std::vector<std::string> lines = buildParseLines(protocols[p]);
+
+    SSmlHandle *info = parseLines(protocols[p], lines, 1);
+    ASSERT_NE(info, nullptr);
+    checkParsedLines(info);
+    smlDestroyInfo(info);
+
+    // chunks are parsed by the task queue and the caller, and merged in order
+    for (int32_t numOfThreads = 2; numOfThreads <= 4; ++numOfThreads) {
+      info = parseLines(protocols[p], lines, numOfThreads);
+      ASSERT_NE(info, nullptr);
+      checkParsedLines(info);
+      smlDestroyInfo(info);
+    }
+  }
+
+  // an error in any chunk fails the batch
+  std::vector<std::string> lines = buildParseLines(TSDB_SML_LINE_PROTOCOL);
+  lines[numOfParseLines - 10] = "st,t0=1 c0=erer 1626006833639000000";
+  ASSERT_EQ(parseLines(TSDB_SML_LINE_PROTOCOL, lines, 4), nullptr);
+
+  // the caller parses all chunks itself if the task queue does not take them
+  cleanupTaskQueue();
+  lines = buildParseLines(TSDB_SML_LINE_PROTOCOL);
+  SSmlHandle *info = parseLines(TSDB_SML_LINE_PROTOCOL, lines, 4);
+  ASSERT_NE(info, nullptr);
+  checkParsedLines(info);
+  smlDestroyInfo(info);
+}
@@ -2243,15 +2243,13 @@ char* buildCtbNameByGroupId(const char* stbFullName, uint64_t groupId) {
   return rname.ctbShortName;
 }
 
-int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
-  int32_t dataLen = 0;
-
-  // todo extract method
-  int32_t* version = (int32_t*)data;
-  *version = 1;
+// write the block header shared by the plain and the compressed format, and return the position of the column
+// length segment.
+static char* blockEncodeHeader(const SSDataBlock* pBlock, char* data, int32_t numOfCols, int32_t version) {
+  *(int32_t*)data = version;
   data += sizeof(int32_t);
 
-  int32_t* actualLen = (int32_t*)data;
+  // actual length, filled by caller
   data += sizeof(int32_t);
 
   int32_t* rows = (int32_t*)data;
@@ -2259,18 +2257,15 @@ int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
   data += sizeof(int32_t);
   ASSERT(*rows > 0);
 
-  int32_t* cols = (int32_t*)data;
-  *cols = numOfCols;
+  *(int32_t*)data = numOfCols;
   data += sizeof(int32_t);
 
   // flag segment.
   // the inital bit is for column info
-  int32_t* flagSegment = (int32_t*)data;
-  *flagSegment = (1 << 31);
-
+  *(int32_t*)data = (1 << 31);
   data += sizeof(int32_t);
 
-  uint64_t* groupId = (uint64_t*)data;
+  *(uint64_t*)data = pBlock->info.id.groupId;
   data += sizeof(uint64_t);
 
   for (int32_t i = 0; i < numOfCols; ++i) {
@@ -2283,25 +2278,34 @@ int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
     data += sizeof(int32_t);
   }
 
-  int32_t* colSizes = (int32_t*)data;
-  data += numOfCols * sizeof(int32_t);
+  return data;
+}
+
+static size_t blockEncodeColMeta(const SColumnInfoData* pColRes, int32_t numOfRows, char* data) {
+  size_t metaSize = 0;
+  if (IS_VAR_DATA_TYPE(pColRes->info.type)) {
+    metaSize = numOfRows * sizeof(int32_t);
+    memcpy(data, pColRes->varmeta.offset, metaSize);
+  } else {
+    metaSize = BitmapLen(numOfRows);
+    memcpy(data, pColRes->nullbitmap, metaSize);
+  }
+
+  return metaSize;
+}
 
-  dataLen = blockDataGetSerialMetaSize(numOfCols);
+int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
+  char*    pStart = data;
+  int32_t* colSizes = (int32_t*)blockEncodeHeader(pBlock, data, numOfCols, BLOCK_ENCODE_VERSION);
+  int32_t  dataLen = blockDataGetSerialMetaSize(numOfCols);
+  data = pStart + dataLen;
 
   int32_t numOfRows = pBlock->info.rows;
   for (int32_t col = 0; col < numOfCols; ++col) {
     SColumnInfoData* pColRes = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, col);
 
     // copy the null bitmap
-    size_t metaSize = 0;
-    if (IS_VAR_DATA_TYPE(pColRes->info.type)) {
-      metaSize = numOfRows * sizeof(int32_t);
-      memcpy(data, pColRes->varmeta.offset, metaSize);
-    } else {
-      metaSize = BitmapLen(numOfRows);
-      memcpy(data, pColRes->nullbitmap, metaSize);
-    }
-
+    size_t metaSize = blockEncodeColMeta(pColRes, numOfRows, data);
     data += metaSize;
     dataLen += metaSize;
 
@@ -2315,21 +2319,106 @@ int32_t blockEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
     colSizes[col] = htonl(colSizes[col]);
   }
 
-  *actualLen = dataLen;
-  *groupId = pBlock->info.id.groupId;
+  *(int32_t*)(pStart + sizeof(int32_t)) = dataLen;
+  ASSERT(dataLen > 0);
+
+  uDebug("build data block, actualLen:%d, rows:%d, cols:%d", dataLen, numOfRows, numOfCols);
+
+  return dataLen;
+}
+
+// The compressed format shares the header of the plain one, and the column length segment still records the
+// uncompressed length of each column. The data of each column is prefixed by the compression algorithm and the
+// compressed length, and falls back to the raw bytes if the codec does not pay off. Bitmaps and offsets are kept
+// uncompressed, so the null info can be consumed without decompression.
+int32_t blockCompressEncode(const SSDataBlock* pBlock, char* data, int32_t numOfCols) {
+  char*    pStart = data;
+  int32_t* colSizes = (int32_t*)blockEncodeHeader(pBlock, data, numOfCols, BLOCK_ENCODE_COMPRESS_VERSION);
+  int32_t  dataLen = blockDataGetSerialMetaSize(numOfCols);
+  int32_t  rawLen = dataLen;
+  data = pStart + dataLen;
+
+  int32_t numOfRows = pBlock->info.rows;
+  for (int32_t col = 0; col < numOfCols; ++col) {
+    SColumnInfoData* pColRes = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, col);
+
+    size_t metaSize = blockEncodeColMeta(pColRes, numOfRows, data);
+    data += metaSize;
+    dataLen += metaSize;
+
+    int32_t colSize = colDataGetLength(pColRes, numOfRows);
+    rawLen += metaSize + colSize;
+    colSizes[col] = htonl(colSize);
+
+    int8_t* cmprAlg = (int8_t*)data;
+    data += sizeof(int8_t);
+    int32_t* cmprLen = (int32_t*)data;
+    data += sizeof(int32_t);
+
+    int32_t len = -1;
+    if (colSize > 0 && pColRes->pData != NULL && tDataTypes[pColRes->info.type].compFunc != NULL) {
+      len = blockCompressColData(pColRes, numOfRows, data, ONE_STAGE_COMP);
+    }
+
+    if (len > 0 && len < colSize) {
+      *cmprAlg = ONE_STAGE_COMP;
+    } else {
+      *cmprAlg = NO_COMPRESSION;
+      if (colSize > 0) {
+        memcpy(data, pColRes->pData, colSize);
+      }
+      len = colSize;
+    }
+
+    *cmprLen = len;
+    data += len;
+    dataLen += sizeof(int8_t) + sizeof(int32_t) + len;
+  }
+
+  *(int32_t*)(pStart + sizeof(int32_t)) = dataLen;
   ASSERT(dataLen > 0);
 
-  uDebug("build data block, actualLen:%d, rows:%d, cols:%d", dataLen, *rows, *cols);
+  uDebug("build compressed data block, actualLen:%d, rawLen:%d, rows:%d, cols:%d", dataLen, rawLen, numOfRows,
+         numOfCols);
 
   return dataLen;
 }
 
+// decompress one column of a compressed block into pOut, which can hold colLen bytes
+static int32_t blockDecompressColData(int8_t type, int32_t numOfRows, const char** ppStart, char* pOut,
+                                      int32_t colLen) {
+  const char* pStart = *ppStart;
+
+  int8_t cmprAlg = *(int8_t*)pStart;
+  pStart += sizeof(int8_t);
+
+  int32_t cmprLen = *(int32_t*)pStart;
+  pStart += sizeof(int32_t);
+
+  if (cmprAlg == NO_COMPRESSION) {
+    ASSERT(cmprLen == colLen);
+    if (colLen > 0) {
+      memcpy(pOut, pStart, colLen);
+    }
+  } else {
+    int32_t len = tDataTypes[type].decompFunc((void*)pStart, cmprLen, numOfRows, pOut, colLen, cmprAlg, NULL, 0);
+    if (len != colLen) {
+      uError("failed to decompress column data, type:%d, expect len:%d, actual len:%d", type, colLen, len);
+      return TSDB_CODE_COMPRESS_ERROR;
+    }
+  }
+
+  *ppStart = pStart + cmprLen;
+  return TSDB_CODE_SUCCESS;
+}
+
 const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
   const char* pStart = pData;
 
   int32_t version = *(int32_t*)pStart;
   pStart += sizeof(int32_t);
-  ASSERT(version == 1);
+  ASSERT(version == BLOCK_ENCODE_VERSION || version == BLOCK_ENCODE_COMPRESS_VERSION);
+  bool compressed = (version == BLOCK_ENCODE_COMPRESS_VERSION);
 
   // total length sizeof(int32_t)
   int32_t dataLen = *(int32_t*)pStart;
@@ -2387,6 +2476,7 @@ const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
       if (colLen[i] > 0 && pColInfoData->varmeta.allocLen < colLen[i]) {
         char* tmp = taosMemoryRealloc(pColInfoData->pData, colLen[i]);
         if (tmp == NULL) {
+          terrno = TSDB_CODE_OUT_OF_MEMORY;
           return NULL;
         }
 
@@ -2400,15 +2490,22 @@ const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
       pStart += BitmapLen(numOfRows);
     }
 
-    if (colLen[i] > 0) {
-      memcpy(pColInfoData->pData, pStart, colLen[i]);
+    if (compressed) {
+      terrno = blockDecompressColData(pColInfoData->info.type, numOfRows, &pStart, pColInfoData->pData, colLen[i]);
+      if (terrno != TSDB_CODE_SUCCESS) {
+        return NULL;
+      }
+    } else {
+      if (colLen[i] > 0) {
+        memcpy(pColInfoData->pData, pStart, colLen[i]);
+      }
+      pStart += colLen[i];
     }
 
     // TODO
     // setting this flag to true temporarily so aggregate function on stable will
     // examine NULL value for non-primary key column
     pColInfoData->hasNull = true;
-    pStart += colLen[i];
   }
 
   pBlock->info.dataLoad = 1;
@@ -2416,3 +2513,65 @@ const char* blockDecode(SSDataBlock* pBlock, const char* pData) {
   ASSERT(pStart - pData == dataLen);
   return pStart;
 }
+
+// the length of the plain encoded block that a compressed block is restored to
+int32_t blockGetDecompressSize(const char* pData) {
+  if (!blockIsCompressed(pData)) {
+    return *(int32_t*)(pData + sizeof(int32_t));
+  }
+
+  int32_t numOfRows = *(int32_t*)(pData + sizeof(int32_t) * 2);
+  int32_t numOfCols = *(int32_t*)(pData + sizeof(int32_t) * 3);
+
+  const char*    pSchema = pData + sizeof(int32_t) * 5 + sizeof(uint64_t);
+  const int32_t* colLen = (const int32_t*)(pSchema + numOfCols * (sizeof(int8_t) + sizeof(int32_t)));
+
+  int32_t len = blockDataGetSerialMetaSize(numOfCols);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int8_t type = *(int8_t*)(pSchema + i * (sizeof(int8_t) + sizeof(int32_t)));
+    len += IS_VAR_DATA_TYPE(type) ? sizeof(int32_t) * numOfRows : BitmapLen(numOfRows);
+    len += htonl(colLen[i]);
+  }
+
+  return len;
+}
+
+// restore a compressed block to the plain encoded format in pDst, which must hold blockGetDecompressSize bytes.
+// Return the length of the plain block, or -1 with terrno set if failed.
+int32_t blockDecompress(const char* pData, char* pDst) {
+  ASSERT(blockIsCompressed(pData));
+
+  int32_t numOfRows = *(int32_t*)(pData + sizeof(int32_t) * 2);
+  int32_t numOfCols = *(int32_t*)(pData + sizeof(int32_t) * 3);
+  int32_t metaLen = blockDataGetSerialMetaSize(numOfCols);
+
+  memcpy(pDst, pData, metaLen);
+  *(int32_t*)pDst = BLOCK_ENCODE_VERSION;
+
+  const char*    pSchema = pData + sizeof(int32_t) * 5 + sizeof(uint64_t);
+  const int32_t* colLen = (const int32_t*)(pSchema + numOfCols * (sizeof(int8_t) + sizeof(int32_t)));
+
+  const char* pStart = pData + metaLen;
+  char*       pOut = pDst + metaLen;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int8_t  type = *(int8_t*)(pSchema + i * (sizeof(int8_t) + sizeof(int32_t)));
+    int32_t len = htonl(colLen[i]);
+
+    size_t metaSize = IS_VAR_DATA_TYPE(type) ? sizeof(int32_t) * numOfRows : BitmapLen(numOfRows);
+    memcpy(pOut, pStart, metaSize);
+    pStart += metaSize;
+    pOut += metaSize;
+
+    terrno = blockDecompressColData(type, numOfRows, &pStart, pOut, len);
+    if (terrno != TSDB_CODE_SUCCESS) {
+      return -1;
+    }
+    pOut += len;
+  }
+
+  ASSERT(pStart - pData == *(int32_t*)(pData + sizeof(int32_t)));
+
+  int32_t dataLen = pOut - pDst;
+  *(int32_t*)(pDst + sizeof(int32_t)) = dataLen;
+  return dataLen;
+}
@@ -89,6 +89,12 @@ char tsSmlChildTableName[TSDB_TABLE_NAME_LEN] = "";  // user defined child table
 // true means that the name and order of cols in each line are the same(only for influx protocol)
 bool    tsSmlDataFormat = false;
 int32_t tsSmlBatchSize = 10000;
+// max number of chunks the lines of a batch are split into and parsed concurrently, 1 means parsing in the caller
+int32_t tsSmlParseThreads = 4;
+
+// stmt
+// max number of batches of taos_stmt_execute_a in flight on a connection
+int32_t tsStmtMaxInflight = 2;
 
 // query
 int32_t tsQueryPolicy = 1;
@@ -137,6 +143,8 @@ int32_t tsMinIntervalTime = 1;
 
 // maximum memory allowed to be allocated for a single csv load (in MB)
 int32_t tsMaxMemUsedByInsert = 1024;
+// max number of chunks the lines of a csv batch are split into and converted concurrently
+int32_t tsCsvParseThreads = 4;
 
 float   tsSelectivityRatio = 1.0;
 int32_t tsTagFilterResCacheSize = 1024 * 10;
@@ -153,6 +161,7 @@ SDiskCfg tsDiskCfg[TFS_MAX_DISKS] = {0};
 
 // stream scheduler
 bool tsDeployOnSnode = true;
+int32_t tsStreamStateCacheSize = 64;  // MB, window state cached in memory by stream tasks of a vnode or snode, 0 means disabled
 
 /*
  * minimum scale for whole system, millisecond by default
@@ -178,10 +187,20 @@ bool tsStartUdfd = true;
 // wal
 int64_t tsWalFsyncDataSizeLimit = (100 * 1024 * 1024L);
 
+// tsdb
+int32_t tsTsdbPageCacheSize = 32;  // MB, page cache of data files for each vnode, 0 means disabled
+int32_t tsTsdbReadAheadBlocks = 4;  // number of data blocks read ahead by the tsdb reader, 0 means disabled
+int32_t tsTsdbCompactSttTrigger = 8;    // number of stt files of a fileset to trigger compaction, 0 means disabled
+int32_t tsTsdbCompactOverlapRatio = 0;  // percent of fileset size in stt files to trigger compaction, 0 means disabled
+int32_t tsTsdbCompactIoBudget = 0;      // MB written by compaction per second, 0 means unlimited
+int32_t tsTsdbMemChunkRows = 0;         // rows of a columnar memtable chunk, 0 means all rows go to the skiplist
+int32_t tsTsdbCommitThreads = 1;        // threads committing filesets of a memtable in parallel
+
 // internal
 int32_t tsTransPullupInterval = 2;
 int32_t tsMqRebalanceInterval = 2;
 int32_t tsStreamCheckpointTickInterval = 1;
+int32_t tsStreamCheckpointInterval = 60;  // seconds
 int32_t tsTtlUnit = 86400;
 int32_t tsTtlPushInterval = 86400;
 int32_t tsGrantHBInterval = 60;
@@ -321,7 +340,10 @@ static int32_t taosAddClientCfg(SConfig *pCfg) {
   if (cfgAddString(pCfg, "smlTagName", tsSmlTagName, 1) != 0) return -1;
   if (cfgAddBool(pCfg, "smlDataFormat", tsSmlDataFormat, 1) != 0) return -1;
   if (cfgAddInt32(pCfg, "smlBatchSize", tsSmlBatchSize, 1, INT32_MAX, true) != 0) return -1;
+  if (cfgAddInt32(pCfg, "smlParseThreads", tsSmlParseThreads, 1, 64, true) != 0) return -1;
+  if (cfgAddInt32(pCfg, "stmtMaxInflight", tsStmtMaxInflight, 1, 1024, true) != 0) return -1;
   if (cfgAddInt32(pCfg, "maxMemUsedByInsert", tsMaxMemUsedByInsert, 1, INT32_MAX, true) != 0) return -1;
+  if (cfgAddInt32(pCfg, "csvParseThreads", tsCsvParseThreads, 1, 64, true) != 0) return -1;
   if (cfgAddInt32(pCfg, "maxRetryWaitTime", tsMaxRetryWaitTime, 0, 86400000, 0) != 0) return -1;
   if (cfgAddBool(pCfg, "useAdapter", tsUseAdapter, true) != 0) return -1;
   if (cfgAddBool(pCfg, "crashReporting", tsEnableCrashReport, true) != 0) return -1;
@@ -463,6 +485,15 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   if (cfgAddInt64(pCfg, "walFsyncDataSizeLimit", tsWalFsyncDataSizeLimit, 100 * 1024 * 1024, INT64_MAX, 0) != 0)
     return -1;
 
+  if (cfgAddInt32(pCfg, "tsdbPageCacheSize", tsTsdbPageCacheSize, 0, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbReadAheadBlocks", tsTsdbReadAheadBlocks, 0, 1024, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbCompactSttTrigger", tsTsdbCompactSttTrigger, 0, TSDB_MAX_STT_TRIGGER, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbCompactOverlapRatio", tsTsdbCompactOverlapRatio, 0, 100, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbCompactIoBudget", tsTsdbCompactIoBudget, 0, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbMemChunkRows", tsTsdbMemChunkRows, 0, TSDB_MAX_MAXROWS_FBLOCK, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "tsdbCommitThreads", tsTsdbCommitThreads, 1, 16, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "streamStateCacheSize", tsStreamStateCacheSize, 0, 65536, 0) != 0) return -1;
+
   if (cfgAddBool(pCfg, "udf", tsStartUdfd, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdResFuncs", tsUdfdResFuncs, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdLdLibPath", tsUdfdLdLibPath, 0) != 0) return -1;
@@ -665,7 +696,10 @@ static int32_t taosSetClientCfg(SConfig *pCfg) {
   tsSmlDataFormat = cfgGetItem(pCfg, "smlDataFormat")->bval;
 
   tsSmlBatchSize = cfgGetItem(pCfg, "smlBatchSize")->i32;
+  tsSmlParseThreads = cfgGetItem(pCfg, "smlParseThreads")->i32;
+  tsStmtMaxInflight = cfgGetItem(pCfg, "stmtMaxInflight")->i32;
   tsMaxMemUsedByInsert = cfgGetItem(pCfg, "maxMemUsedByInsert")->i32;
+  tsCsvParseThreads = cfgGetItem(pCfg, "csvParseThreads")->i32;
 
   tsShellActivityTimer = cfgGetItem(pCfg, "shellActivityTimer")->i32;
   tsCompressMsgSize = cfgGetItem(pCfg, "compressMsgSize")->i32;
@@ -755,6 +789,15 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
 
   tsWalFsyncDataSizeLimit = cfgGetItem(pCfg, "walFsyncDataSizeLimit")->i64;
 
+  tsTsdbPageCacheSize = cfgGetItem(pCfg, "tsdbPageCacheSize")->i32;
+  tsTsdbReadAheadBlocks = cfgGetItem(pCfg, "tsdbReadAheadBlocks")->i32;
+  tsTsdbCompactSttTrigger = cfgGetItem(pCfg, "tsdbCompactSttTrigger")->i32;
+  tsTsdbCompactOverlapRatio = cfgGetItem(pCfg, "tsdbCompactOverlapRatio")->i32;
+  tsTsdbCompactIoBudget = cfgGetItem(pCfg, "tsdbCompactIoBudget")->i32;
+  tsTsdbMemChunkRows = cfgGetItem(pCfg, "tsdbMemChunkRows")->i32;
+  tsTsdbCommitThreads = cfgGetItem(pCfg, "tsdbCommitThreads")->i32;
+  tsStreamStateCacheSize = cfgGetItem(pCfg, "streamStateCacheSize")->i32;
+
   tsElectInterval = cfgGetItem(pCfg, "syncElectInterval")->i32;
   tsHeartbeatInterval = cfgGetItem(pCfg, "syncHeartbeatInterval")->i32;
   tsHeartbeatTimeout = cfgGetItem(pCfg, "syncHeartbeatTimeout")->i32;
@@ -815,6 +858,8 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
         cDebugFlag = cfgGetItem(pCfg, "cDebugFlag")->i32;
       } else if (strcasecmp("crashReporting", name) == 0) {
         tsEnableCrashReport = cfgGetItem(pCfg, "crashReporting")->bval;
+      } else if (strcasecmp("csvParseThreads", name) == 0) {
+        tsCsvParseThreads = cfgGetItem(pCfg, "csvParseThreads")->i32;
       }
       break;
     }
@@ -1052,6 +1097,10 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
         tsSmlDataFormat = cfgGetItem(pCfg, "smlDataFormat")->bval;
       } else if (strcasecmp("smlBatchSize", name) == 0) {
         tsSmlBatchSize = cfgGetItem(pCfg, "smlBatchSize")->i32;
+      } else if (strcasecmp("smlParseThreads", name) == 0) {
+        tsSmlParseThreads = cfgGetItem(pCfg, "smlParseThreads")->i32;
+      } else if (strcasecmp("stmtMaxInflight", name) == 0) {
+        tsStmtMaxInflight = cfgGetItem(pCfg, "stmtMaxInflight")->i32;
       } else if (strcasecmp("shellActivityTimer", name) == 0) {
         tsShellActivityTimer = cfgGetItem(pCfg, "shellActivityTimer")->i32;
       } else if (strcasecmp("supportVnodes", name) == 0) {
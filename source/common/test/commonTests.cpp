@@ -260,4 +260,71 @@ TEST(testCase, var_dataBlock_split_test) {
   }
 }
 
+TEST(testCase, compressed_dataBlock_encode_test) {
+  int32_t numOfRows = 1000;
+
+  SSDataBlock* b = createDataBlock();
+
+  SColumnInfoData infoData = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+  blockDataAppendColInfo(b, &infoData);
+
+  SColumnInfoData infoData1 = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 40, 2);
+  blockDataAppendColInfo(b, &infoData1);
+  blockDataEnsureCapacity(b, numOfRows);
+
+  SColumnInfoData* p0 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 0);
+  SColumnInfoData* p1 = (SColumnInfoData*)taosArrayGet(b->pDataBlock, 1);
+
+  char buf[41] = {0};
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int64_t ts = 1648791213000 + i * 1000;
+    colDataAppend(p0, i, (const char*)&ts, false);
+
+    if (i % 10 == 0) {
+      colDataAppendNULL(p1, i);
+    } else {
+      sprintf(varDataVal(buf), "the number of row:%d", i % 7);
+      varDataSetLen(buf, strlen(varDataVal(buf)));
+      colDataAppend(p1, i, buf, false);
+    }
+    b->info.rows++;
+  }
+
+  int32_t numOfCols = blockDataGetNumOfCols(b);
+  char*   pPlain = (char*)taosMemoryCalloc(1, blockGetEncodeSize(b));
+  char*   pData = (char*)taosMemoryCalloc(1, blockGetCompressEncodeSize(b));
+
+  int32_t plainLen = blockEncode(b, pPlain, numOfCols);
+  int32_t len = blockCompressEncode(b, pData, numOfCols);
+  ASSERT_TRUE(blockIsCompressed(pData));
+  ASSERT_LT(len, plainLen);
+  ASSERT_EQ(blockGetDecompressSize(pData), plainLen);
+
+  char* pDst = (char*)taosMemoryCalloc(1, plainLen);
+  ASSERT_EQ(blockDecompress(pData, pDst), plainLen);
+  ASSERT_EQ(memcmp(pDst, pPlain, plainLen), 0);
+
+  SSDataBlock* pRes = createDataBlock();
+  const char*  pEnd = blockDecode(pRes, pData);
+  ASSERT_EQ(pEnd - pData, len);
+  ASSERT_EQ(pRes->info.rows, numOfRows);
+
+  SColumnInfoData* pCol0 = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+  SColumnInfoData* pCol1 = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ASSERT_EQ(*(int64_t*)colDataGetData(pCol0, i), *(int64_t*)colDataGetData(p0, i));
+    ASSERT_EQ(colDataIsNull_s(pCol1, i), colDataIsNull_s(p1, i));
+    if (!colDataIsNull_s(p1, i)) {
+      ASSERT_EQ(varDataLen(colDataGetData(pCol1, i)), varDataLen(colDataGetData(p1, i)));
+      ASSERT_EQ(memcmp(colDataGetData(pCol1, i), colDataGetData(p1, i), varDataTLen(colDataGetData(p1, i))), 0);
+    }
+  }
+
+  taosMemoryFree(pPlain);
+  taosMemoryFree(pData);
+  taosMemoryFree(pDst);
+  blockDataDestroy(pRes);
+  blockDataDestroy(b);
+}
+
 #pragma GCC diagnostic pop
\ No newline at end of file
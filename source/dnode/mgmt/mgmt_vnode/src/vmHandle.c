@@ -52,6 +52,12 @@ void vmGetMonitorInfo(SVnodeMgmt *pMgmt, SMonVmInfo *pInfo) {
   int64_t numOfInsertSuccessReqs = 0;
   int64_t numOfBatchInsertReqs = 0;
   int64_t numOfBatchInsertSuccessReqs = 0;
+  int64_t pageCacheHit = 0;
+  int64_t pageCacheMiss = 0;
+  int64_t pageCacheUsage = 0;
+  int64_t numOfWalFsync = 0;
+  int64_t numOfWalFsyncEntries = 0;
+  int64_t walFsyncUs = 0;
 
   for (int32_t i = 0; i < taosArrayGetSize(pVloads); ++i) {
     SVnodeLoad *pLoad = taosArrayGet(pVloads, i);
@@ -60,6 +66,12 @@ void vmGetMonitorInfo(SVnodeMgmt *pMgmt, SMonVmInfo *pInfo) {
     numOfInsertSuccessReqs += pLoad->numOfInsertSuccessReqs;
     numOfBatchInsertReqs += pLoad->numOfBatchInsertReqs;
     numOfBatchInsertSuccessReqs += pLoad->numOfBatchInsertSuccessReqs;
+    pageCacheHit += pLoad->pageCacheHit;
+    pageCacheMiss += pLoad->pageCacheMiss;
+    pageCacheUsage += pLoad->pageCacheUsage;
+    numOfWalFsync += pLoad->numOfWalFsync;
+    numOfWalFsyncEntries += pLoad->numOfWalFsyncEntries;
+    walFsyncUs += pLoad->walFsyncUs;
     if (pLoad->syncState == TAOS_SYNC_STATE_LEADER) masterNum++;
     totalVnodes++;
   }
@@ -71,6 +83,12 @@ void vmGetMonitorInfo(SVnodeMgmt *pMgmt, SMonVmInfo *pInfo) {
   pInfo->vstat.numOfInsertSuccessReqs = numOfInsertSuccessReqs;            // delta
   pInfo->vstat.numOfBatchInsertReqs = numOfBatchInsertReqs;                // delta
   pInfo->vstat.numOfBatchInsertSuccessReqs = numOfBatchInsertSuccessReqs;  // delta
+  pInfo->vstat.pageCacheHit = pageCacheHit;
+  pInfo->vstat.pageCacheMiss = pageCacheMiss;
+  pInfo->vstat.pageCacheUsage = pageCacheUsage;
+  pInfo->vstat.numOfWalFsync = numOfWalFsync;
+  pInfo->vstat.numOfWalFsyncEntries = numOfWalFsyncEntries;
+  pInfo->vstat.walFsyncUs = walFsyncUs;
   pMgmt->state.totalVnodes = totalVnodes;
   pMgmt->state.masterNum = masterNum;
   pMgmt->state.numOfSelectReqs = numOfSelectReqs;
@@ -78,6 +96,12 @@ void vmGetMonitorInfo(SVnodeMgmt *pMgmt, SMonVmInfo *pInfo) {
   pMgmt->state.numOfInsertSuccessReqs = numOfInsertSuccessReqs;
   pMgmt->state.numOfBatchInsertReqs = numOfBatchInsertReqs;
   pMgmt->state.numOfBatchInsertSuccessReqs = numOfBatchInsertSuccessReqs;
+  pMgmt->state.pageCacheHit = pageCacheHit;
+  pMgmt->state.pageCacheMiss = pageCacheMiss;
+  pMgmt->state.pageCacheUsage = pageCacheUsage;
+  pMgmt->state.numOfWalFsync = numOfWalFsync;
+  pMgmt->state.numOfWalFsyncEntries = numOfWalFsyncEntries;
+  pMgmt->state.walFsyncUs = walFsyncUs;
 
   tfsGetMonitorInfo(pMgmt->pTfs, &pInfo->tfs);
   taosArrayDestroy(pVloads);
@@ -443,6 +467,11 @@ SArray *vmGetMsgHandles() {
   if (dmSetMgmtHandle(pArray, TDMT_STREAM_TASK_CHECK, vmPutMsgToStreamQueue, 0) == NULL) goto _OVER;
   if (dmSetMgmtHandle(pArray, TDMT_STREAM_TASK_CHECK_RSP, vmPutMsgToWriteQueue, 0) == NULL) goto _OVER;
   if (dmSetMgmtHandle(pArray, TDMT_VND_STREAM_TRIGGER, vmPutMsgToStreamQueue, 0) == NULL) goto _OVER;
+  if (dmSetMgmtHandle(pArray, TDMT_VND_STREAM_CHECK_POINT_SOURCE, vmPutMsgToWriteQueue, 0) == NULL) goto _OVER;
+  if (dmSetMgmtHandle(pArray, TDMT_STREAM_TASK_CHECKPOINT, vmPutMsgToStreamQueue, 0) == NULL) goto _OVER;
+  if (dmSetMgmtHandle(pArray, TDMT_STREAM_TASK_CHECKPOINT_RSP, vmPutMsgToStreamQueue, 0) == NULL) goto _OVER;
+  if (dmSetMgmtHandle(pArray, TDMT_STREAM_TASK_CHECK_CHECKPOINT, vmPutMsgToStreamQueue, 0) == NULL) goto _OVER;
+  if (dmSetMgmtHandle(pArray, TDMT_STREAM_TASK_REPORT_CHECKPOINT, vmPutMsgToStreamQueue, 0) == NULL) goto _OVER;
 
   if (dmSetMgmtHandle(pArray, TDMT_VND_ALTER_REPLICA, vmPutMsgToMgmtQueue, 0) == NULL) goto _OVER;
   if (dmSetMgmtHandle(pArray, TDMT_VND_ALTER_CONFIG, vmPutMsgToWriteQueue, 0) == NULL) goto _OVER;
@@ -352,7 +352,7 @@ typedef struct {
   int64_t   totalStorage;
   int64_t   compStorage;
   int64_t   pointsWritten;
-  int8_t    compact;
+  int8_t    compact;  // progress of the running compaction reported by the leader, -1 if not compacting
   int8_t    isTsma;
   int8_t    replica;
   SVnodeGid vnodeGid[TSDB_MAX_REPLICA];
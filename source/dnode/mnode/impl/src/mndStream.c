@@ -66,7 +66,9 @@ int32_t mndInitStream(SMnode *pMnode) {
 
   mndSetMsgHandle(pMnode, TDMT_MND_STREAM_CHECKPOINT_TIMER, mndProcessStreamCheckpointTmr);
   mndSetMsgHandle(pMnode, TDMT_MND_STREAM_BEGIN_CHECKPOINT, mndProcessStreamDoCheckpoint);
-  mndSetMsgHandle(pMnode, TDMT_STREAM_TASK_REPORT_CHECKPOINT, mndTransProcessRsp);
+  mndSetMsgHandle(pMnode, TDMT_VND_STREAM_CHECK_POINT_SOURCE_RSP, mndTransProcessRsp);
+  mndSetMsgHandle(pMnode, TDMT_STREAM_TASK_CHECK_CHECKPOINT_RSP, mndTransProcessRsp);
+  mndSetMsgHandle(pMnode, TDMT_STREAM_TASK_REPORT_CHECKPOINT_RSP, mndTransProcessRsp);
 
   mndAddShowRetrieveHandle(pMnode, TSDB_MGMT_TABLE_STREAMS, mndRetrieveStream);
   mndAddShowFreeIterHandle(pMnode, TSDB_MGMT_TABLE_STREAMS, mndCancelGetNextStream);
@@ -295,6 +297,7 @@ static int32_t mndBuildStreamObjFromCreateReq(SMnode *pMnode, SStreamObj *pObj,
   pObj->triggerParam = pCreate->maxDelay;
   pObj->watermark = pCreate->watermark;
   pObj->fillHistory = pCreate->fillHistory;
+  pObj->checkpointFreq = (int64_t)tsStreamCheckpointInterval * 1000;
 
   memcpy(pObj->sourceDb, pCreate->sourceDB, TSDB_DB_FNAME_LEN);
   SDbObj *pSourceDb = mndAcquireDb(pMnode, pCreate->sourceDB);
@@ -710,8 +713,10 @@ static int32_t mndProcessStreamCheckpointTmr(SRpcMsg *pReq) {
     if (pIter == NULL) break;
     // incr tick
     int64_t currentTick = atomic_add_fetch_64(&pStream->currentTick, 1);
+    // streams created before checkpointFreq was set take the default
+    int64_t checkpointFreq = pStream->checkpointFreq > 0 ? pStream->checkpointFreq : tsStreamCheckpointInterval * 1000;
     // if >= checkpointFreq, build msg TDMT_MND_STREAM_BEGIN_CHECKPOINT, put into write q
-    if (currentTick >= pStream->checkpointFreq) {
+    if (currentTick * tsStreamCheckpointTickInterval * 1000 >= checkpointFreq) {
       atomic_store_64(&pStream->currentTick, 0);
       SMStreamDoCheckpointMsg *pMsg = rpcMallocCont(sizeof(SMStreamDoCheckpointMsg));
 
@@ -727,6 +732,7 @@ static int32_t mndProcessStreamCheckpointTmr(SRpcMsg *pReq) {
 
       tmsgPutToQueue(&pMnode->msgCb, WRITE_QUEUE, &rpcMsg);
     }
+    sdbRelease(pSdb, pStream);
   }
 
   return 0;
@@ -775,6 +781,67 @@ static int32_t mndBuildStreamCheckpointSourceReq(void **pBuf, int32_t *pLen, con
   return 0;
 }
 
+static int32_t mndAppendStreamCheckpointAction(STrans *pTrans, const SStreamTask *pTask, tmsg_t msgType,
+                                               int64_t checkpointId) {
+  SStreamCheckpointReportReq req = {
+      .streamId = pTask->streamId,
+      .checkpointId = checkpointId,
+      .taskId = pTask->taskId,
+      .nodeId = pTask->nodeId,
+  };
+
+  int32_t code;
+  int32_t blen;
+  tEncodeSize(tEncodeSStreamCheckpointReportReq, &req, blen, code);
+  if (code < 0) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  int32_t tlen = sizeof(SMsgHead) + blen;
+  void   *buf = taosMemoryMalloc(tlen);
+  if (buf == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  SEncoder encoder;
+  tEncoderInit(&encoder, POINTER_SHIFT(buf, sizeof(SMsgHead)), blen);
+  tEncodeSStreamCheckpointReportReq(&encoder, &req);
+  tEncoderClear(&encoder);
+
+  SMsgHead *pMsgHead = (SMsgHead *)buf;
+  pMsgHead->contLen = htonl(tlen);
+  pMsgHead->vgId = htonl(pTask->nodeId);
+
+  STransAction action = {0};
+  memcpy(&action.epSet, &pTask->epSet, sizeof(SEpSet));
+  action.pCont = buf;
+  action.contLen = tlen;
+  action.msgType = msgType;
+  if (mndTransAppendRedoAction(pTrans, &action) != 0) {
+    taosMemoryFree(buf);
+    return -1;
+  }
+  return 0;
+}
+
+static int32_t mndAppendStreamCheckpointActions(STrans *pTrans, SStreamObj *pStream, tmsg_t msgType,
+                                                int64_t checkpointId) {
+  int32_t totLevel = taosArrayGetSize(pStream->tasks);
+  for (int32_t i = 0; i < totLevel; i++) {
+    SArray *pLevel = taosArrayGetP(pStream->tasks, i);
+    int32_t sz = taosArrayGetSize(pLevel);
+    for (int32_t j = 0; j < sz; j++) {
+      SStreamTask *pTask = taosArrayGetP(pLevel, j);
+      if (mndAppendStreamCheckpointAction(pTrans, pTask, msgType, checkpointId) < 0) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
 static int32_t mndProcessStreamDoCheckpoint(SRpcMsg *pReq) {
   SMnode *pMnode = pReq->info.node;
   SSdb   *pSdb = pMnode->pSdb;
@@ -789,8 +856,15 @@ static int32_t mndProcessStreamDoCheckpoint(SRpcMsg *pReq) {
   }
 
   // build new transaction:
-  STrans *pTrans = mndTransCreate(pMnode, TRN_POLICY_RETRY, TRN_CONFLICT_DB_INSIDE, pReq, "stream-checkpoint");
-  if (pTrans == NULL) return -1;
+  // The actions run one by one, the barrier is put into the source tasks, then every task is checked to have written
+  // the checkpoint, and only then is it completed on the tasks. A task failing the check gives up the checkpoint, the
+  // tasks keep the one completed before. A task missing the completion completes it with the next one.
+  STrans *pTrans = mndTransCreate(pMnode, TRN_POLICY_ROLLBACK, TRN_CONFLICT_DB_INSIDE, pReq, "stream-checkpoint");
+  if (pTrans == NULL) {
+    mndReleaseStream(pMnode, pStream);
+    return -1;
+  }
+  mndTransSetSerial(pTrans);
   mndTransSetDbName(pTrans, pStream->sourceDb, pStream->targetDb);
   if (mndTrancCheckConflict(pMnode, pTrans) != 0) {
     mndReleaseStream(pMnode, pStream);
@@ -845,9 +919,16 @@ static int32_t mndProcessStreamDoCheckpoint(SRpcMsg *pReq) {
       }
     }
   }
-  // 2. reset tick
+  // 2. redo action: check that all tasks have written the checkpoint, then complete it on them
+  if (mndAppendStreamCheckpointActions(pTrans, pStream, TDMT_STREAM_TASK_CHECK_CHECKPOINT, pMsg->checkpointId) < 0 ||
+      mndAppendStreamCheckpointActions(pTrans, pStream, TDMT_STREAM_TASK_REPORT_CHECKPOINT, pMsg->checkpointId) < 0) {
+    taosRUnLockLatch(&pStream->lock);
+    mndReleaseStream(pMnode, pStream);
+    mndTransDrop(pTrans);
+    return -1;
+  }
+  // 3. reset tick
   atomic_store_64(&pStream->currentTick, 0);
-  // 3. commit log: stream checkpoint info
   taosRUnLockLatch(&pStream->lock);
 
   if (mndTransPrepare(pMnode, pTrans) != 0) {
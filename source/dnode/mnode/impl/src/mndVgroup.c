@@ -149,6 +149,7 @@ SSdbRow *mndVgroupActionDecode(SSdbRaw *pRaw) {
     }
   }
   SDB_GET_RESERVE(pRaw, dataPos, VGROUP_RESERVE_SIZE, _OVER)
+  pVgroup->compact = -1;
 
   terrno = 0;
 
@@ -746,6 +747,14 @@ static int32_t mndRetrieveVgroups(SRpcMsg *pReq, SShowObj *pShow, SSDataBlock *p
     pColInfo = taosArrayGet(pBlock->pDataBlock, cols++);
     colDataAppend(pColInfo, numOfRows, (const char *)&pVgroup->isTsma, false);
 
+    pColInfo = taosArrayGet(pBlock->pDataBlock, cols++);
+    if (pVgroup->compact < 0) {
+      colDataAppendNULL(pColInfo, numOfRows);
+    } else {
+      int32_t compact = pVgroup->compact;
+      colDataAppend(pColInfo, numOfRows, (const char *)&compact, false);
+    }
+
     numOfRows++;
     sdbRelease(pSdb, pVgroup);
   }
@@ -1009,3 +1009,319 @@ TEST_F(MndTestSdb, 01_Read_Str) {
   ASSERT_EQ(mnode.insertTimes, 9);
   ASSERT_EQ(mnode.deleteTimes, 9);
 }
+
+TEST_F(MndTestSdb, 02_Write_Delta) {
+  SMnode   mnode = {0};
+  SSdb    *pSdb = NULL;
+  SSdbOpt  opt = {0};
+  SStrObj  strObj = {0};
+  SI32Obj  i32Obj = {0};
+  SStrObj *pObj = NULL;
+  SI32Obj *pI32Obj = NULL;
+  SSdbRaw *pRaw = NULL;
+  int64_t  dataSize = 0;
+  int64_t  deltaSize = 0;
+  int32_t  key = 0;
+
+  opt.pMnode = &mnode;
+  opt.path = TD_TMP_DIR_PATH "mnode_test_sdb_delta";
+  taosRemoveDir(opt.path);
+
+  const char *dataFile = TD_TMP_DIR_PATH "mnode_test_sdb_delta" TD_DIRSEP "data" TD_DIRSEP "sdb.data";
+  const char *deltaFile = TD_TMP_DIR_PATH "mnode_test_sdb_delta" TD_DIRSEP "data" TD_DIRSEP "sdb.delta";
+
+  SSdbTable strTable1;
+  memset(&strTable1, 0, sizeof(SSdbTable));
+  strTable1.sdbType = SDB_USER;
+  strTable1.keyType = SDB_KEY_BINARY;
+  strTable1.deployFp = (SdbDeployFp)strDefault;
+  strTable1.encodeFp = (SdbEncodeFp)strEncode;
+  strTable1.decodeFp = (SdbDecodeFp)strDecode;
+  strTable1.insertFp = (SdbInsertFp)strInsert;
+  strTable1.updateFp = (SdbUpdateFp)strUpdate;
+  strTable1.deleteFp = (SdbDeleteFp)strDelete;
+
+  SSdbTable strTable2;
+  memset(&strTable2, 0, sizeof(SSdbTable));
+  strTable2.sdbType = SDB_VGROUP;
+  strTable2.keyType = SDB_KEY_INT32;
+  strTable2.encodeFp = (SdbEncodeFp)i32Encode;
+  strTable2.decodeFp = (SdbDecodeFp)i32Decode;
+  strTable2.insertFp = (SdbInsertFp)i32Insert;
+  strTable2.updateFp = (SdbUpdateFp)i32Update;
+  strTable2.deleteFp = (SdbDeleteFp)i32Delete;
+
+  pSdb = sdbInit(&opt);
+  mnode.pSdb = pSdb;
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable1), 0);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable2), 0);
+  ASSERT_EQ(sdbDeploy(pSdb), 0);
+
+  // the first write is a full one
+  sdbSetApplyInfo(pSdb, 1, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  ASSERT_EQ(taosStatFile(dataFile, &dataSize, NULL), 0);
+  ASSERT_FALSE(taosCheckExistFile(deltaFile));
+
+  // update k1000, drop k2000, create k3000 and two vgroups of which one is not ready
+  strSetDefault(&strObj, 1);
+  strObj.v8 = 11;
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  strSetDefault(&strObj, 2);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_DROPPED);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  strSetDefault(&strObj, 3);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  i32SetDefault(&i32Obj, 5);
+  pRaw = i32Encode(&i32Obj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  i32SetDefault(&i32Obj, 6);
+  pRaw = i32Encode(&i32Obj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_CREATING);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  // only the changed rows are appended to the delta file
+  sdbSetApplyInfo(pSdb, 2, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  int64_t size = 0;
+  ASSERT_EQ(taosStatFile(dataFile, &size, NULL), 0);
+  ASSERT_EQ(size, dataSize);
+  ASSERT_EQ(taosStatFile(deltaFile, &deltaSize, NULL), 0);
+  ASSERT_GT(deltaSize, 0);
+
+  strSetDefault(&strObj, 3);
+  strObj.v8 = 33;
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+
+  sdbSetApplyInfo(pSdb, 3, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  ASSERT_EQ(taosStatFile(deltaFile, &size, NULL), 0);
+  ASSERT_GT(size, deltaSize);
+  deltaSize = size;
+
+  int64_t userVer = sdbGetTableVer(pSdb, SDB_USER);
+  int64_t vgroupVer = sdbGetTableVer(pSdb, SDB_VGROUP);
+  sdbCleanup(pSdb);
+
+  // a segment partly written is dropped
+  TdFilePtr pFile = taosOpenFile(deltaFile, TD_FILE_WRITE | TD_FILE_APPEND);
+  ASSERT_NE(pFile, nullptr);
+  ASSERT_EQ(taosWriteFile(pFile, "torn", 4), 4);
+  taosCloseFile(&pFile);
+
+  for (int32_t i = 0; i < 2; ++i) {
+    pSdb = sdbInit(&opt);
+    mnode.pSdb = pSdb;
+    ASSERT_NE(pSdb, nullptr);
+    ASSERT_EQ(sdbSetTable(pSdb, strTable1), 0);
+    ASSERT_EQ(sdbSetTable(pSdb, strTable2), 0);
+    ASSERT_EQ(sdbReadFile(pSdb), 0);
+
+    int64_t index, term, config;
+    sdbGetCommitInfo(pSdb, &index, &term, &config);
+    ASSERT_EQ(index, 3);
+    ASSERT_EQ(sdbGetSize(pSdb, SDB_USER), 2);
+    ASSERT_EQ(sdbGetSize(pSdb, SDB_VGROUP), 1);
+    ASSERT_EQ(sdbGetTableVer(pSdb, SDB_USER), userVer);
+    ASSERT_EQ(sdbGetTableVer(pSdb, SDB_VGROUP), vgroupVer);
+    ASSERT_EQ(sdbGetMaxId(pSdb, SDB_VGROUP), 7);
+
+    pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k1000");
+    ASSERT_NE(pObj, nullptr);
+    ASSERT_EQ(pObj->v8, 11);
+    sdbRelease(pSdb, pObj);
+
+    pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k2000");
+    ASSERT_EQ(pObj, nullptr);
+
+    pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k3000");
+    ASSERT_NE(pObj, nullptr);
+    ASSERT_EQ(pObj->v8, 33);
+    ASSERT_EQ(pObj->v32, 3000);
+    sdbRelease(pSdb, pObj);
+
+    key = 5;
+    pI32Obj = (SI32Obj *)sdbAcquire(pSdb, SDB_VGROUP, &key);
+    ASSERT_NE(pI32Obj, nullptr);
+    sdbRelease(pSdb, pI32Obj);
+
+    key = 6;
+    pI32Obj = (SI32Obj *)sdbAcquireNotReadyObj(pSdb, SDB_VGROUP, &key);
+    ASSERT_EQ(pI32Obj, nullptr);
+
+    if (i == 0) {
+      ASSERT_EQ(taosStatFile(deltaFile, &size, NULL), 0);
+      ASSERT_EQ(size, deltaSize);
+
+      // the snapshot is read from the data file, which the delta file is merged into
+      SSdbIter *pReader = NULL;
+      ASSERT_EQ(sdbStartRead(pSdb, &pReader, NULL, NULL, NULL), 0);
+      sdbStopRead(pSdb, pReader);
+      ASSERT_FALSE(taosCheckExistFile(deltaFile));
+    }
+
+    sdbCleanup(pSdb);
+  }
+}
+
+TEST_F(MndTestSdb, 03_Snapshot_Over_Delta) {
+  SMnode    mnode = {0};
+  SMnode    snapMnode = {0};
+  SSdbOpt   opt = {0};
+  SSdbOpt   snapOpt = {0};
+  SSdb     *pSdb = NULL;
+  SSdb     *pSnapSdb = NULL;
+  SStrObj   strObj = {0};
+  SStrObj  *pObj = NULL;
+  SSdbRaw  *pRaw = NULL;
+  SSdbIter *pReader = NULL;
+  SSdbIter *pWritter = NULL;
+  void     *pBuf = NULL;
+  int32_t   len = 0;
+  int64_t   size = 0;
+  int64_t   index, term, config;
+
+  opt.pMnode = &mnode;
+  opt.path = TD_TMP_DIR_PATH "mnode_test_sdb_snap";
+  taosRemoveDir(opt.path);
+  snapOpt.pMnode = &snapMnode;
+  snapOpt.path = TD_TMP_DIR_PATH "mnode_test_sdb_snap_leader";
+  taosRemoveDir(snapOpt.path);
+
+  const char *dataFile = TD_TMP_DIR_PATH "mnode_test_sdb_snap" TD_DIRSEP "data" TD_DIRSEP "sdb.data";
+  const char *deltaFile = TD_TMP_DIR_PATH "mnode_test_sdb_snap" TD_DIRSEP "data" TD_DIRSEP "sdb.delta";
+  const char *snapFile = TD_TMP_DIR_PATH "mnode_test_sdb_snap_leader" TD_DIRSEP "data" TD_DIRSEP "sdb.data";
+
+  SSdbTable strTable;
+  memset(&strTable, 0, sizeof(SSdbTable));
+  strTable.sdbType = SDB_USER;
+  strTable.keyType = SDB_KEY_BINARY;
+  strTable.deployFp = (SdbDeployFp)strDefault;
+  strTable.encodeFp = (SdbEncodeFp)strEncode;
+  strTable.decodeFp = (SdbDecodeFp)strDecode;
+  strTable.insertFp = (SdbInsertFp)strInsert;
+  strTable.updateFp = (SdbUpdateFp)strUpdate;
+  strTable.deleteFp = (SdbDeleteFp)strDelete;
+
+  // the local data file of index 1 and the delta segments of index 2 and 3
+  pSdb = sdbInit(&opt);
+  mnode.pSdb = pSdb;
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable), 0);
+  ASSERT_EQ(sdbDeploy(pSdb), 0);
+  sdbSetApplyInfo(pSdb, 1, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+
+  strSetDefault(&strObj, 1);
+  strObj.v8 = 11;
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+  sdbSetApplyInfo(pSdb, 2, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+
+  strSetDefault(&strObj, 3);
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+  sdbSetApplyInfo(pSdb, 3, 1, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  ASSERT_EQ(taosStatFile(deltaFile, &size, NULL), 0);
+  ASSERT_GT(size, 0);
+  sdbCleanup(pSdb);
+
+  // the snapshot of index 2 from another mnode
+  pSnapSdb = sdbInit(&snapOpt);
+  snapMnode.pSdb = pSnapSdb;
+  ASSERT_NE(pSnapSdb, nullptr);
+  ASSERT_EQ(sdbSetTable(pSnapSdb, strTable), 0);
+  ASSERT_EQ(sdbDeploy(pSnapSdb), 0);
+  strSetDefault(&strObj, 1);
+  strObj.v8 = 22;
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSnapSdb, pRaw), 0);
+  sdbSetApplyInfo(pSnapSdb, 2, 2, 1);
+  ASSERT_EQ(sdbWriteFile(pSnapSdb, 0), 0);
+
+  // the snapshot replaces the data file but the mnode stops before the delta file is removed, the segments left are
+  // based on the replaced data file and must not be applied to the snapshot
+  const char *tmpFile = TD_TMP_DIR_PATH "mnode_test_sdb_snap" TD_DIRSEP "sdb.snap";
+  ASSERT_GT(taosCopyFile(snapFile, tmpFile), 0);
+  ASSERT_EQ(taosRenameFile(tmpFile, dataFile), 0);
+
+  pSdb = sdbInit(&opt);
+  mnode.pSdb = pSdb;
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable), 0);
+  ASSERT_EQ(sdbReadFile(pSdb), 0);
+  sdbGetCommitInfo(pSdb, &index, &term, &config);
+  ASSERT_EQ(index, 2);
+  ASSERT_EQ(term, 2);
+  pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k1000");
+  ASSERT_NE(pObj, nullptr);
+  ASSERT_EQ(pObj->v8, 22);
+  sdbRelease(pSdb, pObj);
+  ASSERT_EQ(sdbAcquire(pSdb, SDB_USER, "k3000"), nullptr);
+  ASSERT_EQ(taosStatFile(deltaFile, &size, NULL), 0);
+  ASSERT_EQ(size, 0);
+
+  // the delta segments written after it are based on the snapshot
+  strSetDefault(&strObj, 3);
+  strObj.v8 = 33;
+  pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, SDB_STATUS_READY);
+  ASSERT_EQ(sdbWrite(pSdb, pRaw), 0);
+  sdbSetApplyInfo(pSdb, 3, 2, 1);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  ASSERT_EQ(taosStatFile(deltaFile, &size, NULL), 0);
+  ASSERT_GT(size, 0);
+  sdbCleanup(pSdb);
+
+  pSdb = sdbInit(&opt);
+  mnode.pSdb = pSdb;
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbSetTable(pSdb, strTable), 0);
+  ASSERT_EQ(sdbReadFile(pSdb), 0);
+  sdbGetCommitInfo(pSdb, &index, &term, &config);
+  ASSERT_EQ(index, 3);
+  pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k3000");
+  ASSERT_NE(pObj, nullptr);
+  ASSERT_EQ(pObj->v8, 33);
+  sdbRelease(pSdb, pObj);
+
+  // a snapshot applied by the writer replaces the data file and removes the delta file
+  ASSERT_EQ(sdbStartRead(pSnapSdb, &pReader, NULL, NULL, NULL), 0);
+  ASSERT_EQ(sdbStartWrite(pSdb, &pWritter), 0);
+  while (sdbDoRead(pSnapSdb, pReader, &pBuf, &len) == 0 && pBuf != NULL && len != 0) {
+    ASSERT_EQ(sdbDoWrite(pSdb, pWritter, pBuf, len), 0);
+    taosMemoryFree(pBuf);
+  }
+  sdbStopRead(pSnapSdb, pReader);
+  ASSERT_EQ(sdbStopWrite(pSdb, pWritter, true, -1, -1, -1), 0);
+  ASSERT_FALSE(taosCheckExistFile(deltaFile));
+
+  sdbGetCommitInfo(pSdb, &index, &term, &config);
+  ASSERT_EQ(index, 2);
+  pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, "k1000");
+  ASSERT_NE(pObj, nullptr);
+  ASSERT_EQ(pObj->v8, 22);
+  sdbRelease(pSdb, pObj);
+  ASSERT_EQ(sdbAcquire(pSdb, SDB_USER, "k3000"), nullptr);
+
+  sdbCleanup(pSdb);
+  sdbCleanup(pSnapSdb);
+}
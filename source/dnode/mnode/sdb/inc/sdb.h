@@ -182,6 +182,7 @@ typedef struct SSdb {
   int64_t        maxId[SDB_MAX];
   EKeyType       keyTypes[SDB_MAX];
   SHashObj      *hashObjs[SDB_MAX];
+  SHashObj      *dirtyObjs[SDB_MAX];  // keys of the rows changed since last write, with the raw of dropped rows
   TdThreadRwlock locks[SDB_MAX];
   SdbInsertFp    insertFps[SDB_MAX];
   SdbUpdateFp    updateFps[SDB_MAX];
@@ -190,6 +191,10 @@ typedef struct SSdb {
   SdbEncodeFp    encodeFps[SDB_MAX];
   SdbDecodeFp    decodeFps[SDB_MAX];
   TdThreadMutex  filelock;
+  int64_t        dataIndex;  // apply index of sdb.data, which the segments of sdb.delta are based on
+  int64_t        dataSize;
+  int64_t        deltaSize;
+  bool           needFullWrite;
 } SSdb;
 
 typedef struct SSdbIter {
@@ -257,7 +262,8 @@ int32_t sdbDeploy(SSdb *pSdb);
 int32_t sdbReadFile(SSdb *pSdb);
 
 /**
- * @brief Write sdb file.
+ * @brief Write sdb file, the rows changed since last write are appended to the delta file, all rows are written
+ * to the data file when the delta file grows too large.
  *
  * @param pSdb The sdb object.
  * @return int32_t 0 for success, -1 for failure.
@@ -282,6 +288,15 @@ int32_t sdbWrite(SSdb *pSdb, SSdbRaw *pRaw);
  */
 int32_t sdbWriteWithoutFree(SSdb *pSdb, SSdbRaw *pRaw);
 
+/**
+ * @brief Parse raw data and replace the row of the same key in sdb, the raw data is not freed.
+ *
+ * @param pSdb The sdb object.
+ * @param pRaw The raw data, a dropped raw removes the row if it exists.
+ * @return int32_t 0 for success, -1 for failure.
+ */
+int32_t sdbReplaceWithoutFree(SSdb *pSdb, SSdbRaw *pRaw);
+
 /**
  * @brief Acquire a row from sdb
  *
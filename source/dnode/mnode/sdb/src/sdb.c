@@ -61,6 +61,7 @@ SSdb *sdbInit(SSdbOpt *pOption) {
   pSdb->commitTerm = -1;
   pSdb->commitConfig = -1;
   pSdb->pMnode = pOption->pMnode;
+  pSdb->needFullWrite = true;
   taosThreadMutexInit(&pSdb->filelock, NULL);
   mInfo("sdb init success");
   return pSdb;
@@ -100,8 +101,10 @@ void sdbCleanup(SSdb *pSdb) {
 
     taosHashClear(hash);
     taosHashCleanup(hash);
+    taosHashCleanup(pSdb->dirtyObjs[i]);
     taosThreadRwlockDestroy(&pSdb->locks[i]);
     pSdb->hashObjs[i] = NULL;
+    pSdb->dirtyObjs[i] = NULL;
     memset(&pSdb->locks[i], 0, sizeof(pSdb->locks[i]));
 
     mInfo("sdb table:%s is cleaned up", sdbTableName(i));
@@ -112,6 +115,8 @@ void sdbCleanup(SSdb *pSdb) {
   mInfo("sdb is cleaned up");
 }
 
+static void sdbFreeDirtyRaw(void *p) { taosMemoryFree(*(SSdbRaw **)p); }
+
 int32_t sdbSetTable(SSdb *pSdb, SSdbTable table) {
   ESdbType sdbType = table.sdbType;
   EKeyType keyType = table.keyType;
@@ -138,8 +143,17 @@ int32_t sdbSetTable(SSdb *pSdb, SSdbTable table) {
     return -1;
   }
 
+  SHashObj *dirty = taosHashInit(64, taosGetDefaultHashFunction(hashType), true, HASH_NO_LOCK);
+  if (dirty == NULL) {
+    taosHashCleanup(hash);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+  taosHashSetFreeFp(dirty, sdbFreeDirtyRaw);
+
   pSdb->maxId[sdbType] = 0;
   pSdb->hashObjs[sdbType] = hash;
+  pSdb->dirtyObjs[sdbType] = dirty;
   mInfo("sdb table:%s is initialized", sdbTableName(sdbType));
 
   return 0;
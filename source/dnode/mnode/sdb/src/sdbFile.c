@@ -23,6 +23,28 @@
 #define SDB_RESERVE_SIZE 512
 #define SDB_FILE_VER     1
 
+#define SDB_DELTA_VER      2
+#define SDB_DELTA_MIN_SIZE (16 * 1024 * 1024)
+
+/*
+ * The rows changed between two writes are appended to sdb.delta as a segment, which starts with the head below.
+ * The head is written after the rows, so a segment with a valid head is complete. The delta file is removed once
+ * all rows are written to sdb.data, which happens when the delta file is larger than the data file. A delta file left
+ * behind by another data file, e.g. one replaced by a snapshot, is dropped by the data index in the head.
+ */
+typedef struct {
+  int64_t sver;
+  int64_t dataIndex;
+  int64_t applyIndex;
+  int64_t applyTerm;
+  int64_t applyConfig;
+  int64_t maxId[SDB_TABLE_SIZE];
+  int64_t tableVer[SDB_TABLE_SIZE];
+  int64_t bodyLen;
+  int32_t numOfRaws;
+  int32_t cksum;
+} SSdbDeltaHead;
+
 static int32_t sdbDeployData(SSdb *pSdb) {
   mInfo("start to deploy sdb");
 
@@ -63,6 +85,7 @@ static void sdbResetData(SSdb *pSdb) {
     if (hash == NULL) continue;
 
     taosHashClear(pSdb->hashObjs[i]);
+    taosHashClear(pSdb->dirtyObjs[i]);
     pSdb->tableVer[i] = 0;
     pSdb->maxId[i] = 0;
     mInfo("sdb:%s is reset", sdbTableName(i));
@@ -74,6 +97,10 @@ static void sdbResetData(SSdb *pSdb) {
   pSdb->commitIndex = -1;
   pSdb->commitTerm = -1;
   pSdb->commitConfig = -1;
+  pSdb->dataIndex = -1;
+  pSdb->dataSize = 0;
+  pSdb->deltaSize = 0;
+  pSdb->needFullWrite = true;
   mInfo("sdb reset success");
 }
 
@@ -222,11 +249,171 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   return 0;
 }
 
-static int32_t sdbReadFileImp(SSdb *pSdb) {
+// read a raw and check its checksum, pRaw is enlarged if needed and pEof is set at the end of file
+static int32_t sdbReadRaw(TdFilePtr pFile, const char *file, SSdbRaw **ppRaw, int32_t *pBufLen, bool *pEof) {
+  SSdbRaw *pRaw = *ppRaw;
+  int32_t  readLen = sizeof(SSdbRaw);
+  int64_t  ret = taosReadFile(pFile, pRaw, readLen);
+  int32_t  code = 0;
+
+  *pEof = (ret == 0);
+  if (ret == 0) return 0;
+
+  if (ret < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to read sdb file:%s since %s", file, tstrerror(code));
+    return code;
+  }
+
+  if (ret != readLen) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    mError("failed to read sdb file:%s since %s, ret:%" PRId64 " != readLen:%d", file, tstrerror(code), ret, readLen);
+    return code;
+  }
+
+  readLen = pRaw->dataLen + sizeof(int32_t);
+  if (readLen >= *pBufLen) {
+    *pBufLen = pRaw->dataLen * 2;
+    SSdbRaw *pNewRaw = taosMemoryMalloc(*pBufLen + 100);
+    if (pNewRaw == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      mError("failed read sdb file since malloc new sdbRaw size:%d failed", *pBufLen);
+      return code;
+    }
+    mInfo("malloc new sdb raw size:%d, type:%d", *pBufLen, pRaw->type);
+    memcpy(pNewRaw, pRaw, sizeof(SSdbRaw));
+    sdbFreeRaw(pRaw);
+    pRaw = pNewRaw;
+    *ppRaw = pRaw;
+  }
+
+  ret = taosReadFile(pFile, pRaw->pData, readLen);
+  if (ret < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to read sdb file:%s since %s, ret:%" PRId64 " readLen:%d", file, tstrerror(code), ret, readLen);
+    return code;
+  }
+
+  if (ret != readLen) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    mError("failed to read sdb file:%s since %s, ret:%" PRId64 " != readLen:%d", file, tstrerror(code), ret, readLen);
+    return code;
+  }
+
+  int32_t totalLen = sizeof(SSdbRaw) + pRaw->dataLen + sizeof(int32_t);
+  if ((!taosCheckChecksumWhole((const uint8_t *)pRaw, totalLen)) != 0) {
+    code = TSDB_CODE_CHECKSUM_ERROR;
+    mError("failed to read sdb file:%s since %s, readLen:%d", file, tstrerror(code), readLen);
+    return code;
+  }
+
+  return 0;
+}
+
+static int32_t sdbReadDeltaFile(SSdb *pSdb, SSdbRaw **ppRaw, int32_t *pBufLen) {
+  int32_t code = 0;
   int64_t offset = 0;
+  int64_t fileSize = 0;
+  int32_t numOfSegments = 0;
+  char    file[PATH_MAX] = {0};
+
+  snprintf(file, sizeof(file), "%s%ssdb.delta", pSdb->currDir, TD_DIRSEP);
+  mInfo("start to read sdb delta file:%s", file);
+
+  TdFilePtr pFile = taosOpenFile(file, TD_FILE_READ | TD_FILE_WRITE);
+  if (pFile == NULL) {
+    mInfo("read sdb delta file:%s finished since %s", file, tstrerror(TAOS_SYSTEM_ERROR(errno)));
+    pSdb->deltaSize = 0;
+    return 0;
+  }
+
+  if (taosFStatFile(pFile, &fileSize, NULL) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to stat sdb delta file:%s since %s", file, tstrerror(code));
+    goto _OVER;
+  }
+
+  while (offset < fileSize) {
+    // the last segment is dropped if it is not completely written, since it is not committed
+    SSdbDeltaHead head = {0};
+    if (offset + (int64_t)sizeof(head) > fileSize || taosReadFile(pFile, &head, sizeof(head)) != sizeof(head) ||
+        !taosCheckChecksumWhole((const uint8_t *)&head, sizeof(head)) ||
+        offset + (int64_t)sizeof(head) + head.bodyLen > fileSize) {
+      mWarn("sdb delta file:%s is truncated from %" PRId64 " to %" PRId64, file, fileSize, offset);
+      if (taosFtruncateFile(pFile, offset) != 0) {
+        code = TAOS_SYSTEM_ERROR(errno);
+        mError("failed to truncate sdb delta file:%s since %s", file, tstrerror(code));
+        goto _OVER;
+      }
+      break;
+    }
+
+    if (head.sver != SDB_DELTA_VER) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      mError("failed to read sdb delta file:%s since %s, sver:%" PRId64, file, tstrerror(code), head.sver);
+      goto _OVER;
+    }
+
+    if (head.dataIndex != pSdb->dataIndex) {
+      mWarn("sdb delta file:%s is based on data index:%" PRId64 " other than %" PRId64 ", truncated from %" PRId64
+            " to %" PRId64,
+            file, head.dataIndex, pSdb->dataIndex, fileSize, offset);
+      if (taosFtruncateFile(pFile, offset) != 0) {
+        code = TAOS_SYSTEM_ERROR(errno);
+        mError("failed to truncate sdb delta file:%s since %s", file, tstrerror(code));
+        goto _OVER;
+      }
+      break;
+    }
+
+    // the segments written before the data file are already in it
+    bool skip = (head.applyIndex <= pSdb->applyIndex);
+    for (int32_t i = 0; i < head.numOfRaws; ++i) {
+      bool eof = false;
+      code = sdbReadRaw(pFile, file, ppRaw, pBufLen, &eof);
+      if (code == 0 && eof) {
+        code = TSDB_CODE_FILE_CORRUPTED;
+      }
+      if (code != 0) goto _OVER;
+      if (skip) continue;
+
+      code = sdbReplaceWithoutFree(pSdb, *ppRaw);
+      if (code != 0) {
+        mError("failed to read sdb delta file:%s since %s", file, terrstr());
+        goto _OVER;
+      }
+    }
+
+    offset += sizeof(head) + head.bodyLen;
+    if (taosLSeekFile(pFile, 0, SEEK_CUR) != offset) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      mError("failed to read sdb delta file:%s since %s, offset:%" PRId64, file, tstrerror(code), offset);
+      goto _OVER;
+    }
+
+    if (!skip) {
+      pSdb->applyIndex = head.applyIndex;
+      pSdb->applyTerm = head.applyTerm;
+      pSdb->applyConfig = head.applyConfig;
+      for (int32_t i = 0; i < SDB_MAX; ++i) {
+        pSdb->maxId[i] = head.maxId[i];
+        pSdb->tableVer[i] = head.tableVer[i];
+      }
+      numOfSegments++;
+    }
+  }
+
+  pSdb->deltaSize = offset;
+  mInfo("read sdb delta file:%s success, segments:%d size:%" PRId64 " apply index:%" PRId64, file, numOfSegments,
+        offset, pSdb->applyIndex);
+
+_OVER:
+  taosCloseFile(&pFile);
+  return code;
+}
+
+static int32_t sdbReadFileImp(SSdb *pSdb) {
   int32_t code = 0;
-  int32_t readLen = 0;
-  int64_t ret = 0;
   char    file[PATH_MAX] = {0};
   int32_t bufLen = TSDB_MAX_MSG_SIZE;
 
@@ -259,69 +446,40 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
   memcpy(tableVer, pSdb->tableVer, sizeof(tableVer));
 
   while (1) {
-    readLen = sizeof(SSdbRaw);
-    ret = taosReadFile(pFile, pRaw, readLen);
-    if (ret == 0) break;
-
-    if (ret < 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      mError("failed to read sdb file:%s since %s", file, tstrerror(code));
-      goto _OVER;
-    }
-
-    if (ret != readLen) {
-      code = TSDB_CODE_FILE_CORRUPTED;
-      mError("failed to read sdb file:%s since %s, ret:%" PRId64 " != readLen:%d", file, tstrerror(code), ret, readLen);
-      goto _OVER;
-    }
-
-    readLen = pRaw->dataLen + sizeof(int32_t);
-    if (readLen >= bufLen) {
-      bufLen = pRaw->dataLen * 2;
-      SSdbRaw *pNewRaw = taosMemoryMalloc(bufLen + 100);
-      if (pNewRaw == NULL) {
-        terrno = TSDB_CODE_OUT_OF_MEMORY;
-        mError("failed read sdb file since malloc new sdbRaw size:%d failed", bufLen);
-        goto _OVER;
-      }
-      mInfo("malloc new sdb raw size:%d, type:%d", bufLen, pRaw->type);
-      memcpy(pNewRaw, pRaw, sizeof(SSdbRaw));
-      sdbFreeRaw(pRaw);
-      pRaw = pNewRaw;
-    }
+    bool eof = false;
+    code = sdbReadRaw(pFile, file, &pRaw, &bufLen, &eof);
+    if (code != 0) goto _OVER;
+    if (eof) break;
 
-    ret = taosReadFile(pFile, pRaw->pData, readLen);
-    if (ret < 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      mError("failed to read sdb file:%s since %s, ret:%" PRId64 " readLen:%d", file, tstrerror(code), ret, readLen);
+    code = sdbWriteWithoutFree(pSdb, pRaw);
+    if (code != 0) {
+      mError("failed to read sdb file:%s since %s", file, terrstr());
       goto _OVER;
     }
+  }
 
-    if (ret != readLen) {
-      code = TSDB_CODE_FILE_CORRUPTED;
-      mError("failed to read sdb file:%s since %s, ret:%" PRId64 " != readLen:%d", file, tstrerror(code), ret, readLen);
-      goto _OVER;
-    }
+  memcpy(pSdb->tableVer, tableVer, sizeof(tableVer));
+  pSdb->dataIndex = pSdb->applyIndex;
+  if (taosFStatFile(pFile, &pSdb->dataSize, NULL) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to stat sdb file:%s since %s", file, tstrerror(code));
+    goto _OVER;
+  }
 
-    int32_t totalLen = sizeof(SSdbRaw) + pRaw->dataLen + sizeof(int32_t);
-    if ((!taosCheckChecksumWhole((const uint8_t *)pRaw, totalLen)) != 0) {
-      code = TSDB_CODE_CHECKSUM_ERROR;
-      mError("failed to read sdb file:%s since %s, readLen:%d", file, tstrerror(code), readLen);
-      goto _OVER;
-    }
+  code = sdbReadDeltaFile(pSdb, &pRaw, &bufLen);
+  if (code != 0) goto _OVER;
 
-    code = sdbWriteWithoutFree(pSdb, pRaw);
-    if (code != 0) {
-      mError("failed to read sdb file:%s since %s", file, terrstr());
-      goto _OVER;
+  // rows loaded from file need not be written again
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    if (pSdb->dirtyObjs[i] != NULL) {
+      taosHashClear(pSdb->dirtyObjs[i]);
     }
   }
+  pSdb->needFullWrite = false;
 
-  code = 0;
   pSdb->commitIndex = pSdb->applyIndex;
   pSdb->commitTerm = pSdb->applyTerm;
   pSdb->commitConfig = pSdb->applyConfig;
-  memcpy(pSdb->tableVer, tableVer, sizeof(tableVer));
   mInfo("read sdb file:%s success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64, file, pSdb->commitIndex,
         pSdb->commitTerm, pSdb->commitConfig);
 
@@ -347,8 +505,24 @@ int32_t sdbReadFile(SSdb *pSdb) {
   return code;
 }
 
-static int32_t sdbWriteFileImp(SSdb *pSdb) {
+static int32_t sdbWriteRaw(TdFilePtr pFile, SSdbRaw *pRaw, int64_t *pLen) {
+  int32_t writeLen = sizeof(SSdbRaw) + pRaw->dataLen;
+  if (taosWriteFile(pFile, pRaw, writeLen) != writeLen) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  int32_t cksum = taosCalcChecksum(0, (const uint8_t *)pRaw, writeLen);
+  if (taosWriteFile(pFile, &cksum, sizeof(int32_t)) != sizeof(int32_t)) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  *pLen += writeLen + sizeof(int32_t);
+  return 0;
+}
+
+static int32_t sdbWriteDataFile(SSdb *pSdb) {
   int32_t code = 0;
+  int64_t size = 0;
 
   char tmpfile[PATH_MAX] = {0};
   snprintf(tmpfile, sizeof(tmpfile), "%s%ssdb.data", pSdb->tmpDir, TD_DIRSEP);
@@ -373,6 +547,9 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
     return -1;
   }
 
+  // the changed rows are all written below, the flag is cleared only if the write succeeds
+  pSdb->needFullWrite = true;
+
   for (int32_t i = SDB_MAX - 1; i >= 0; --i) {
     SdbEncodeFp encodeFp = pSdb->encodeFps[i];
     if (encodeFp == NULL) continue;
@@ -381,6 +558,7 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
 
     SHashObj *hash = pSdb->hashObjs[i];
     sdbWriteLock(pSdb, i);
+    taosHashClear(pSdb->dirtyObjs[i]);
 
     SSdbRow **ppRow = taosHashIterate(hash, NULL);
     while (ppRow != NULL) {
@@ -401,17 +579,8 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
       SSdbRaw *pRaw = (*encodeFp)(pRow->pObj);
       if (pRaw != NULL) {
         pRaw->status = pRow->status;
-        int32_t writeLen = sizeof(SSdbRaw) + pRaw->dataLen;
-        if (taosWriteFile(pFile, pRaw, writeLen) != writeLen) {
-          code = TAOS_SYSTEM_ERROR(errno);
-          taosHashCancelIterate(hash, ppRow);
-          sdbFreeRaw(pRaw);
-          break;
-        }
-
-        int32_t cksum = taosCalcChecksum(0, (const uint8_t *)pRaw, sizeof(SSdbRaw) + pRaw->dataLen);
-        if (taosWriteFile(pFile, &cksum, sizeof(int32_t)) != sizeof(int32_t)) {
-          code = TAOS_SYSTEM_ERROR(errno);
+        code = sdbWriteRaw(pFile, pRaw, &size);
+        if (code != 0) {
           taosHashCancelIterate(hash, ppRow);
           sdbFreeRaw(pRaw);
           break;
@@ -449,6 +618,15 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
   if (code != 0) {
     mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
   } else {
+    // the segments left in the delta file are dropped by the data index if it fails to be removed
+    char deltafile[PATH_MAX] = {0};
+    snprintf(deltafile, sizeof(deltafile), "%s%ssdb.delta", pSdb->currDir, TD_DIRSEP);
+    (void)taosRemoveFile(deltafile);
+
+    pSdb->dataIndex = pSdb->applyIndex;
+    pSdb->dataSize = size;
+    pSdb->deltaSize = 0;
+    pSdb->needFullWrite = false;
     pSdb->commitIndex = pSdb->applyIndex;
     pSdb->commitTerm = pSdb->applyTerm;
     pSdb->commitConfig = pSdb->applyConfig;
@@ -460,6 +638,134 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
   return code;
 }
 
+static int32_t sdbWriteDeltaFile(SSdb *pSdb) {
+  int32_t code = 0;
+  char    file[PATH_MAX] = {0};
+  snprintf(file, sizeof(file), "%s%ssdb.delta", pSdb->currDir, TD_DIRSEP);
+
+  SSdbDeltaHead head = {.sver = SDB_DELTA_VER,
+                        .dataIndex = pSdb->dataIndex,
+                        .applyIndex = pSdb->applyIndex,
+                        .applyTerm = pSdb->applyTerm,
+                        .applyConfig = pSdb->applyConfig};
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    head.maxId[i] = pSdb->maxId[i];
+    head.tableVer[i] = pSdb->tableVer[i];
+  }
+
+  mInfo("start to write sdb delta file, apply index:%" PRId64 " term:%" PRId64 " config:%" PRId64
+        ", commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 ", file:%s offset:%" PRId64,
+        pSdb->applyIndex, pSdb->applyTerm, pSdb->applyConfig, pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig,
+        file, pSdb->deltaSize);
+
+  TdFilePtr pFile = taosOpenFile(file, TD_FILE_CREATE | TD_FILE_WRITE);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to open sdb delta file:%s for write since %s", file, terrstr());
+    return -1;
+  }
+
+  // drop what a failed write left, the rows start after the head
+  if (taosFtruncateFile(pFile, pSdb->deltaSize) != 0 ||
+      taosLSeekFile(pFile, pSdb->deltaSize + sizeof(head), SEEK_SET) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _OVER;
+  }
+
+  for (int32_t i = SDB_MAX - 1; i >= 0 && code == 0; --i) {
+    SdbEncodeFp encodeFp = pSdb->encodeFps[i];
+    if (encodeFp == NULL) continue;
+
+    SHashObj *hash = pSdb->hashObjs[i];
+    SHashObj *dirty = pSdb->dirtyObjs[i];
+    sdbWriteLock(pSdb, i);
+    mInfo("write %s to sdb delta file, total %d rows", sdbTableName(i), (int32_t)taosHashGetSize(dirty));
+
+    SSdbRaw **ppDropRaw = taosHashIterate(dirty, NULL);
+    while (ppDropRaw != NULL) {
+      size_t    keyLen = 0;
+      void     *pKey = taosHashGetKey(ppDropRaw, &keyLen);
+      SSdbRow **ppRow = taosHashGet(hash, pKey, keyLen);
+
+      if (ppRow != NULL && *ppRow != NULL) {
+        SSdbRow *pRow = *ppRow;
+        SSdbRaw *pRaw = (*encodeFp)(pRow->pObj);
+        if (pRaw == NULL) {
+          code = TSDB_CODE_APP_ERROR;
+          taosHashCancelIterate(dirty, ppDropRaw);
+          break;
+        }
+
+        // the rows not written to data file are dropped, in case an older version is written before
+        if (pRow->status == SDB_STATUS_READY || pRow->status == SDB_STATUS_DROPPING) {
+          pRaw->status = pRow->status;
+        } else {
+          pRaw->status = SDB_STATUS_DROPPED;
+        }
+        sdbPrintOper(pSdb, pRow, "write-delta");
+        code = sdbWriteRaw(pFile, pRaw, &head.bodyLen);
+        sdbFreeRaw(pRaw);
+        head.numOfRaws++;
+      } else if (*ppDropRaw != NULL) {
+        code = sdbWriteRaw(pFile, *ppDropRaw, &head.bodyLen);
+        head.numOfRaws++;
+      }
+
+      if (code != 0) {
+        taosHashCancelIterate(dirty, ppDropRaw);
+        break;
+      }
+      ppDropRaw = taosHashIterate(dirty, ppDropRaw);
+    }
+
+    // rows changed after this are kept for the next write, since the lock is held
+    if (code == 0) {
+      taosHashClear(dirty);
+    }
+    sdbUnLock(pSdb, i);
+  }
+
+  // the head is written after the rows are synced, so a segment with a valid head is complete
+  if (code == 0) {
+    taosCalcChecksumAppend(0, (uint8_t *)&head, sizeof(head));
+    if (taosFsyncFile(pFile) != 0 || taosPWriteFile(pFile, &head, sizeof(head), pSdb->deltaSize) != sizeof(head) ||
+        taosFsyncFile(pFile) != 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+    }
+  }
+
+_OVER:
+  taosCloseFile(&pFile);
+
+  if (code != 0) {
+    // the rows cleared from the dirty hash may not be written
+    pSdb->needFullWrite = true;
+    mError("failed to write sdb delta file:%s since %s", file, tstrerror(code));
+  } else {
+    pSdb->deltaSize += sizeof(head) + head.bodyLen;
+    pSdb->commitIndex = head.applyIndex;
+    pSdb->commitTerm = head.applyTerm;
+    pSdb->commitConfig = head.applyConfig;
+    mInfo("write sdb delta file success, rows:%d size:%" PRId64 ", commit index:%" PRId64 " term:%" PRId64
+          " config:%" PRId64 " file:%s",
+          head.numOfRaws, head.bodyLen, pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, file);
+  }
+
+  terrno = code;
+  return code;
+}
+
+static int32_t sdbWriteFileImp(SSdb *pSdb) {
+  if (!pSdb->needFullWrite && pSdb->deltaSize < TMAX(pSdb->dataSize, SDB_DELTA_MIN_SIZE)) {
+    if (sdbWriteDeltaFile(pSdb) == 0) {
+      return 0;
+    }
+    mWarn("failed to write sdb delta file since %s, write all rows to sdb file", terrstr());
+  }
+
+  return sdbWriteDataFile(pSdb);
+}
+
 int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
   int32_t code = 0;
   if (pSdb->applyIndex == pSdb->commitIndex) {
@@ -557,6 +863,14 @@ int32_t sdbStartRead(SSdb *pSdb, SSdbIter **ppIter, int64_t *index, int64_t *ter
   snprintf(datafile, sizeof(datafile), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
 
   taosThreadMutexLock(&pSdb->filelock);
+  // the snapshot is the data file only, so the delta file is merged into it first
+  if (pSdb->deltaSize > 0 && sdbWriteDataFile(pSdb) != 0) {
+    taosThreadMutexUnlock(&pSdb->filelock);
+    mError("failed to merge sdb delta file since %s", terrstr());
+    sdbCloseIter(pIter);
+    return -1;
+  }
+
   int64_t commitIndex = pSdb->commitIndex;
   int64_t commitTerm = pSdb->commitTerm;
   int64_t commitConfig = pSdb->commitConfig;
@@ -663,6 +977,13 @@ int32_t sdbStopWrite(SSdb *pSdb, SSdbIter *pIter, bool isApply, int64_t index, i
     goto _OVER;
   }
 
+  // the delta file belongs to the replaced data file, it is dropped by the data index if it fails to be removed
+  char deltafile[PATH_MAX] = {0};
+  snprintf(deltafile, sizeof(deltafile), "%s%ssdb.delta", pSdb->currDir, TD_DIRSEP);
+  if (taosRemoveFile(deltafile) != 0 && errno != ENOENT) {
+    mWarn("sdbiter:%p, failed to remove file %s since %s", pIter, deltafile, tstrerror(TAOS_SYSTEM_ERROR(errno)));
+  }
+
   if (sdbReadFile(pSdb) != 0) {
     mError("sdbiter:%p, failed to read from %s since %s", pIter, datafile, terrstr());
     goto _OVER;
@@ -130,6 +130,31 @@ static int32_t sdbGetkeySize(SSdb *pSdb, ESdbType type, const void *pKey) {
   return keySize;
 }
 
+// mark the row to be written to the delta file, the raw of a dropped row is kept since the row is removed
+static void sdbSetRowDirty(SSdb *pSdb, int32_t type, const void *pKey, int32_t keySize, SSdbRaw *pRaw) {
+  SHashObj *dirty = pSdb->dirtyObjs[type];
+  if (dirty == NULL) return;
+
+  SSdbRaw *pDropRaw = NULL;
+  if (pRaw == NULL) {
+    if (taosHashGet(dirty, pKey, keySize) != NULL) return;
+  } else {
+    int32_t size = sizeof(SSdbRaw) + pRaw->dataLen;
+    pDropRaw = taosMemoryMalloc(size);
+    if (pDropRaw == NULL) {
+      pSdb->needFullWrite = true;
+      return;
+    }
+    memcpy(pDropRaw, pRaw, size);
+    pDropRaw->status = SDB_STATUS_DROPPED;
+  }
+
+  if (taosHashPut(dirty, pKey, keySize, &pDropRaw, sizeof(void *)) != 0) {
+    taosMemoryFree(pDropRaw);
+    pSdb->needFullWrite = true;
+  }
+}
+
 static int32_t sdbInsertRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *pRow, int32_t keySize) {
   int32_t type = pRow->type;
   sdbWriteLock(pSdb, type);
@@ -167,6 +192,7 @@ static int32_t sdbInsertRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
     }
   }
 
+  sdbSetRowDirty(pSdb, type, pRow->pObj, keySize, NULL);
   sdbUnLock(pSdb, type);
 
   if (pSdb->keyTypes[pRow->type] == SDB_KEY_INT32) {
@@ -193,6 +219,7 @@ static int32_t sdbUpdateRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
   SSdbRow *pOldRow = *ppOldRow;
   pOldRow->status = pRaw->status;
   sdbPrintOper(pSdb, pOldRow, "update");
+  sdbSetRowDirty(pSdb, type, pOldRow->pObj, keySize, NULL);
   sdbUnLock(pSdb, type);
 
   int32_t     code = 0;
@@ -208,33 +235,37 @@ static int32_t sdbUpdateRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
   return code;
 }
 
-static int32_t sdbDeleteRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *pRow, int32_t keySize) {
+static int32_t sdbDeleteRowImp(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *pRow, int32_t keySize) {
   int32_t type = pRow->type;
   sdbWriteLock(pSdb, type);
 
   SSdbRow **ppOldRow = taosHashGet(hash, pRow->pObj, keySize);
   if (ppOldRow == NULL || *ppOldRow == NULL) {
     sdbUnLock(pSdb, type);
-    sdbFreeRow(pSdb, pRow, false);
     terrno = TSDB_CODE_SDB_OBJ_NOT_THERE;
     return terrno;
   }
   SSdbRow *pOldRow = *ppOldRow;
-  pOldRow->status = pRaw->status;
+  pOldRow->status = SDB_STATUS_DROPPED;
 
   atomic_add_fetch_32(&pOldRow->refCount, 1);
   sdbPrintOper(pSdb, pOldRow, "delete");
 
   taosHashRemove(hash, pOldRow->pObj, keySize);
   pSdb->tableVer[pOldRow->type]++;
+  sdbSetRowDirty(pSdb, type, pRow->pObj, keySize, pRaw);
   sdbUnLock(pSdb, type);
 
-  sdbFreeRow(pSdb, pRow, false);
-
   sdbCheckRow(pSdb, pOldRow);
   return 0;
 }
 
+static int32_t sdbDeleteRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *pRow, int32_t keySize) {
+  int32_t code = sdbDeleteRowImp(pSdb, hash, pRaw, pRow, keySize);
+  sdbFreeRow(pSdb, pRow, false);
+  return code;
+}
+
 int32_t sdbWriteWithoutFree(SSdb *pSdb, SSdbRaw *pRaw) {
   SHashObj *hash = sdbGetHash(pSdb, pRaw->type);
   if (hash == NULL) return terrno;
@@ -264,6 +295,32 @@ int32_t sdbWriteWithoutFree(SSdb *pSdb, SSdbRaw *pRaw) {
   return code;
 }
 
+int32_t sdbReplaceWithoutFree(SSdb *pSdb, SSdbRaw *pRaw) {
+  SHashObj *hash = sdbGetHash(pSdb, pRaw->type);
+  if (hash == NULL) return terrno;
+
+  SdbDecodeFp decodeFp = pSdb->decodeFps[pRaw->type];
+  SSdbRow    *pRow = (*decodeFp)(pRaw);
+  if (pRow == NULL) return terrno;
+
+  pRow->type = pRaw->type;
+
+  // the old row is dropped rather than updated, since the update callback may only take part of the new row
+  int32_t keySize = sdbGetkeySize(pSdb, pRow->type, pRow->pObj);
+  int32_t code = sdbDeleteRowImp(pSdb, hash, pRaw, pRow, keySize);
+  if (code == TSDB_CODE_SDB_OBJ_NOT_THERE) {
+    code = 0;
+  }
+
+  if (code != 0 || pRaw->status == SDB_STATUS_DROPPED) {
+    sdbFreeRow(pSdb, pRow, false);
+    terrno = code;
+    return code;
+  }
+
+  return sdbInsertRow(pSdb, hash, pRaw, pRow, keySize);
+}
+
 int32_t sdbWrite(SSdb *pSdb, SSdbRaw *pRaw) {
   int32_t code = sdbWriteWithoutFree(pSdb, pRaw);
   sdbFreeRaw(pRaw);
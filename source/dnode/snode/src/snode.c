@@ -303,6 +303,114 @@ int32_t sndProcessTaskRecoverFinishRsp(SSnode *pSnode, SRpcMsg *pMsg) {
   return 0;
 }
 
+int32_t sndProcessTaskCheckpointReq(SSnode *pSnode, SRpcMsg *pMsg) {
+  char   *msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointReq req;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask *pTask = streamMetaAcquireTask(pSnode->pMeta, req.downstreamTaskId);
+  if (pTask == NULL) {
+    streamSendCheckpointRsp(&req, &pMsg->info, TSDB_CODE_STREAM_TASK_NOT_EXIST);
+    return 0;
+  }
+
+  // the rsp is sent once the barrier is aligned
+  streamProcessCheckpointReq(pSnode->pMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pSnode->pMeta, pTask);
+  return 0;
+}
+
+int32_t sndProcessTaskCheckpointRsp(SSnode *pSnode, SRpcMsg *pMsg) {
+  char   *msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointRsp rsp;
+
+  // the upstream task is unknown without the body, it goes on dispatching once the rsps time out
+  SDecoder decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (msgLen <= 0 || tDecodeSStreamCheckpointRsp(&decoder, &rsp) < 0) {
+    tDecoderClear(&decoder);
+    return 0;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask *pTask = streamMetaAcquireTask(pSnode->pMeta, rsp.upstreamTaskId);
+  if (pTask == NULL) {
+    return 0;
+  }
+
+  int32_t code = streamProcessCheckpointRsp(pSnode->pMeta, pTask, &rsp, pMsg->code);
+  streamMetaReleaseTask(pSnode->pMeta, pTask);
+  return code;
+}
+
+int32_t sndProcessTaskCheckpointCheckReq(SSnode *pSnode, SRpcMsg *pMsg) {
+  char   *msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+
+  SStreamCheckpointReportReq req;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointReportReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_MSG_DECODE_ERROR;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask *pTask = streamMetaAcquireTask(pSnode->pMeta, req.taskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  streamProcessCheckpointCheckReq(pSnode->pMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pSnode->pMeta, pTask);
+  return 0;
+}
+
+int32_t sndProcessTaskCheckpointReportReq(SSnode *pSnode, SRpcMsg *pMsg) {
+  char   *msg = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t msgLen = pMsg->contLen - sizeof(SMsgHead);
+  int64_t ver = -1;
+
+  SStreamCheckpointReportReq req;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, msg, msgLen);
+  if (tDecodeSStreamCheckpointReportReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_MSG_DECODE_ERROR;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask *pTask = streamMetaAcquireTask(pSnode->pMeta, req.taskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  int32_t code = streamProcessCheckpointReportReq(pSnode->pMeta, pTask, &req, &ver);
+  streamMetaReleaseTask(pSnode->pMeta, pTask);
+  if (code < 0) return -1;
+
+  SRpcMsg rsp = {.code = 0, .info = pMsg->info};
+  tmsgSendRsp(&rsp);
+  return 0;
+}
+
 int32_t sndProcessStreamMsg(SSnode *pSnode, SRpcMsg *pMsg) {
   switch (pMsg->msgType) {
     case TDMT_STREAM_TASK_RUN:
@@ -319,6 +427,14 @@ int32_t sndProcessStreamMsg(SSnode *pSnode, SRpcMsg *pMsg) {
       return sndProcessTaskRecoverFinishReq(pSnode, pMsg);
     case TDMT_STREAM_RECOVER_FINISH_RSP:
       return sndProcessTaskRecoverFinishRsp(pSnode, pMsg);
+    case TDMT_STREAM_TASK_CHECKPOINT:
+      return sndProcessTaskCheckpointReq(pSnode, pMsg);
+    case TDMT_STREAM_TASK_CHECKPOINT_RSP:
+      return sndProcessTaskCheckpointRsp(pSnode, pMsg);
+    case TDMT_STREAM_TASK_CHECK_CHECKPOINT:
+      return sndProcessTaskCheckpointCheckReq(pSnode, pMsg);
+    case TDMT_STREAM_TASK_REPORT_CHECKPOINT:
+      return sndProcessTaskCheckpointReportReq(pSnode, pMsg);
     default:
       ASSERT(0);
   }
@@ -67,6 +67,11 @@ void    metaCacheClose(SMeta* pMeta);
 int32_t metaCacheUpsert(SMeta* pMeta, SMetaInfo* pInfo);
 int32_t metaCacheDrop(SMeta* pMeta, int64_t uid);
 
+int32_t metaSchemaCacheGet(SMeta* pMeta, int64_t uid, int32_t sver, STSchema** ppTSchema);
+int32_t metaSchemaCachePut(SMeta* pMeta, int64_t uid, const STSchema* pTSchema, STSchema** ppTSchema);
+void    metaSchemaCacheRelease(STSchema* pTSchema);
+void    metaSchemaCacheDrop(SMeta* pMeta, int64_t uid);
+
 int32_t metaStatsCacheUpsert(SMeta* pMeta, SMetaStbStats* pInfo);
 int32_t metaStatsCacheDrop(SMeta* pMeta, int64_t uid);
 int32_t metaStatsCacheGet(SMeta* pMeta, int64_t uid, SMetaStbStats* pInfo);
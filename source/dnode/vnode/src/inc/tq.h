@@ -136,6 +136,7 @@ struct STQ {
   TTB* pCheckStore;
 
   SStreamMeta* pStreamMeta;
+  SHashObj*    pStreamRef;  // taskId -> SWalRef*, the wal kept for the last completed checkpoint of a source task
 };
 
 typedef struct {
@@ -145,6 +146,8 @@ typedef struct {
 
 static STqMgmt tqMgmt = {0};
 
+void tqPinStreamWal(STQ* pTq, int32_t taskId, int64_t ver);
+
 int32_t tEncodeSTqHandle(SEncoder* pEncoder, const STqHandle* pHandle);
 int32_t tDecodeSTqHandle(SDecoder* pDecoder, STqHandle* pHandle);
 
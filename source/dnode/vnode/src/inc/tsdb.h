@@ -69,6 +69,9 @@ typedef struct SDiskCol         SDiskCol;
 typedef struct SDiskData        SDiskData;
 typedef struct SDiskDataBuilder SDiskDataBuilder;
 typedef struct SBlkInfo         SBlkInfo;
+typedef struct STsdbDataIter2   STsdbDataIter2;
+typedef struct STsdbFilterInfo  STsdbFilterInfo;
+typedef struct STsdbFD          STsdbFD;
 
 #define TSDB_FILE_DLMT     ((uint32_t)0xF00AFA0F)
 #define TSDB_MAX_SUBBLOCKS 8
@@ -104,7 +107,7 @@ static FORCE_INLINE int64_t tsdbLogicToFileSize(int64_t lSize, int32_t szPage) {
 // TSDBROW
 #define TSDBROW_TS(ROW)                       (((ROW)->type == 0) ? (ROW)->pTSRow->ts : (ROW)->pBlockData->aTSKEY[(ROW)->iRow])
 #define TSDBROW_VERSION(ROW)                  (((ROW)->type == 0) ? (ROW)->version : (ROW)->pBlockData->aVersion[(ROW)->iRow])
-#define TSDBROW_SVERSION(ROW)                 TD_ROW_SVER((ROW)->pTSRow)
+#define TSDBROW_SVERSION(ROW)                 (((ROW)->type == 0) ? TD_ROW_SVER((ROW)->pTSRow) : (ROW)->sver)
 #define TSDBROW_KEY(ROW)                      ((TSDBKEY){.version = TSDBROW_VERSION(ROW), .ts = TSDBROW_TS(ROW)})
 #define tsdbRowFromTSRow(VERSION, TSROW)      ((TSDBROW){.type = 0, .version = (VERSION), .pTSRow = (TSROW)})
 #define tsdbRowFromBlockData(BLOCKDATA, IROW) ((TSDBROW){.type = 1, .pBlockData = (BLOCKDATA), .iRow = (IROW)})
@@ -211,10 +214,12 @@ STbData *tsdbGetTbDataFromMemTable(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t
 void     tsdbRefMemTable(SMemTable *pMemTable);
 void     tsdbUnrefMemTable(SMemTable *pMemTable);
 SArray  *tsdbMemTableGetTbDataArray(SMemTable *pMemTable);
+void     tsdbMemTableSeal(SMemTable *pMemTable);
 // STbDataIter
 int32_t tsdbTbDataIterCreate(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDataIter **ppIter);
 void   *tsdbTbDataIterDestroy(STbDataIter *pIter);
-void    tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDataIter *pIter);
+int32_t tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDataIter *pIter);
+void    tsdbTbDataIterClose(STbDataIter *pIter);
 bool    tsdbTbDataIterNext(STbDataIter *pIter);
 // STbData
 int32_t tsdbGetNRowsInTbData(STbData *pTbData);
@@ -253,6 +258,12 @@ void    tsdbFSUnref(STsdb *pTsdb, STsdbFS *pFS);
 int32_t tsdbFSUpsertFSet(STsdbFS *pFS, SDFileSet *pSet);
 int32_t tsdbFSUpsertDelFile(STsdbFS *pFS, SDelFile *pDelFile);
 // tsdbReaderWriter.c ==============================================================================================
+// STsdbFD
+int32_t tsdbOpenFile(STsdb *pTsdb, const char *path, int32_t szPage, int32_t flag, STsdbFD **ppFD);
+void    tsdbCloseFile(STsdbFD **ppFD);
+int32_t tsdbWriteFile(STsdbFD *pFD, int64_t offset, const uint8_t *pBuf, int64_t size);
+int32_t tsdbReadFile(STsdbFD *pFD, int64_t offset, uint8_t *pBuf, int64_t size);
+int32_t tsdbFsyncFile(STsdbFD *pFD);
 // SDataFWriter
 int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pSet);
 int32_t tsdbDataFWriterClose(SDataFWriter **ppWriter, int8_t sync);
@@ -273,6 +284,7 @@ int32_t tsdbReadDataBlk(SDataFReader *pReader, SBlockIdx *pBlockIdx, SMapData *m
 int32_t tsdbReadSttBlk(SDataFReader *pReader, int32_t iStt, SArray *aSttBlk);
 int32_t tsdbReadBlockSma(SDataFReader *pReader, SDataBlk *pBlock, SArray *aColumnDataAgg);
 int32_t tsdbReadDataBlock(SDataFReader *pReader, SDataBlk *pBlock, SBlockData *pBlockData);
+int32_t tsdbPrefetchDataBlk(SDataFReader *pReader, SDataBlk *pDataBlk);
 int32_t tsdbReadSttBlock(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData);
 int32_t tsdbReadSttBlockEx(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData);
 // SDelFWriter
@@ -291,6 +303,13 @@ int32_t tsdbTakeReadSnap(STsdb *pTsdb, STsdbReadSnap **ppSnap, const char *id);
 void    tsdbUntakeReadSnap(STsdb *pTsdb, STsdbReadSnap *pSnap, const char *id);
 // tsdbMerge.c ==============================================================================================
 int32_t tsdbMerge(STsdb *pTsdb);
+// tsdbDataIter.c ==============================================================================================
+int32_t tsdbOpenDataFileDataIter(SDataFReader *pReader, STsdbDataIter2 **ppIter);
+int32_t tsdbOpenSttFileDataIter(SDataFReader *pReader, int32_t iStt, STsdbDataIter2 **ppIter);
+int32_t tsdbOpenTombFileDataIter(SDelFReader *pReader, STsdbDataIter2 **ppIter);
+void    tsdbCloseDataIter2(STsdbDataIter2 *pIter);
+int32_t tsdbDataIterCmprFn(const SRBTreeNode *pNode1, const SRBTreeNode *pNode2);
+int32_t tsdbDataIterNext2(STsdbDataIter2 *pIter, STsdbFilterInfo *pFilterInfo);
 
 #define TSDB_CACHE_NO(c)       ((c).cacheLast == 0)
 #define TSDB_CACHE_LAST_ROW(c) (((c).cacheLast & 1) > 0)
@@ -321,6 +340,11 @@ struct STsdb {
   STsdbFS        fs;
   SLRUCache     *lruCache;
   TdThreadMutex  lruMutex;
+  SLRUCache     *pgCache;
+  int64_t        pgCacheHit;
+  int64_t        pgCacheMiss;
+  int32_t        nCompactFSet;  // number of file sets of the running compaction, 0 if no compaction is running
+  int32_t        iCompactFSet;  // number of file sets compacted
 };
 
 struct TSDBKEY {
@@ -333,6 +357,7 @@ struct SVersionRange {
   uint64_t maxVer;
 };
 
+typedef struct SMemChunk        SMemChunk;
 typedef struct SMemSkipListNode SMemSkipListNode;
 struct SMemSkipListNode {
   int8_t            level;
@@ -358,6 +383,12 @@ struct STbData {
   SDelData    *pTail;
   SMemSkipList sl;
   STbData     *next;
+  // in-order rows are appended to columnar chunks instead of the skiplist
+  SRWLatch   latch;  // guards the unsealed tail chunk, which readers copy under it
+  int64_t    nChunkRow;
+  TSKEY      lastKey;  // max timestamp of all rows in the table data
+  SMemChunk *pChunkHead;
+  SMemChunk *pChunkTail;
 };
 
 struct SMemTable {
@@ -386,6 +417,7 @@ struct TSDBROW {
     struct {
       SBlockData *pBlockData;
       int32_t     iRow;
+      int32_t     sver;  // schema version, only valid for rows from memtable chunks
     };
   };
 };
@@ -477,6 +509,16 @@ struct SBlockData {
   SArray  *aColData;  // SArray<SColData>
 };
 
+struct SMemChunk {
+  int32_t    sver;
+  int8_t     sealed;  // a sealed chunk is immutable and read in place
+  int64_t    size;    // bytes of the rows appended
+  STSchema  *pTSchema;
+  SBlockData bData;
+  SMemChunk *prev;
+  SMemChunk *next;
+};
+
 struct TABLEID {
   tb_uid_t suid;
   tb_uid_t uid;
@@ -486,6 +528,12 @@ struct STbDataIter {
   STbData          *pTbData;
   int8_t            backward;
   SMemSkipListNode *pNode;
+  SMemChunk        *pChunkHead;  // chunks visible to the iterator
+  SMemChunk        *pChunkTail;
+  SMemChunk        *pChunk;  // chunk of the next chunk row, NULL if chunk rows are exhausted
+  SMemChunk        *pTailCopy;  // copy of the unsealed tail taken at open, owned by the iterator
+  int32_t           iChunkRow;
+  int8_t            fromChunk;  // if current row is from chunk
   TSDBROW          *pRow;
   TSDBROW           row;
 };
@@ -577,7 +625,7 @@ struct SRowMerger {
   SArray   *pArray;  // SArray<SColVal>
 };
 
-typedef struct {
+struct STsdbFD {
   char     *path;
   int32_t   szPage;
   int32_t   flag;
@@ -585,7 +633,12 @@ typedef struct {
   int64_t   pgno;
   uint8_t  *pBuf;
   int64_t   szFile;
-} STsdbFD;
+  STsdb    *pTsdb;
+  uint8_t  *pKey;   // page cache key, pgno followed by path
+  int32_t   szKey;
+  uint8_t  *pRBuf;  // buffer of multi-page read
+  int64_t   szRBuf;
+};
 
 struct SDelFWriter {
   STsdb   *pTsdb;
@@ -653,6 +706,71 @@ typedef struct SSttBlockLoadInfo {
   } prevEndPos;
 } SSttBlockLoadInfo;
 
+// STsdbDataIter2 ========================================
+#define TSDB_MEM_TABLE_DATA_ITER 0
+#define TSDB_DATA_FILE_DATA_ITER 1
+#define TSDB_STT_FILE_DATA_ITER  2
+#define TSDB_TOMB_FILE_DATA_ITER 3
+
+typedef struct {
+  int64_t  suid;
+  int64_t  uid;
+  SDelData delData;
+} SDelInfo;
+
+struct STsdbDataIter2 {
+  STsdbDataIter2 *next;
+  SRBTreeNode     rbtn;
+
+  int32_t  type;
+  SRowInfo rowInfo;
+  SDelInfo delInfo;
+  union {
+    // TSDB_MEM_TABLE_DATA_ITER
+    struct {
+      SMemTable *pMemTable;
+    } mIter;
+
+    // TSDB_DATA_FILE_DATA_ITER
+    struct {
+      SDataFReader *pReader;
+      SArray       *aBlockIdx;  // SArray<SBlockIdx>
+      SMapData      mDataBlk;
+      SBlockData    bData;
+      int32_t       iBlockIdx;
+      int32_t       iDataBlk;
+      int32_t       iRow;
+    } dIter;
+
+    // TSDB_STT_FILE_DATA_ITER
+    struct {
+      SDataFReader *pReader;
+      int32_t       iStt;
+      SArray       *aSttBlk;
+      SBlockData    bData;
+      int32_t       iSttBlk;
+      int32_t       iRow;
+    } sIter;
+    // TSDB_TOMB_FILE_DATA_ITER
+    struct {
+      SDelFReader *pReader;
+      SArray      *aDelIdx;
+      SArray      *aDelData;
+      int32_t      iDelIdx;
+      int32_t      iDelData;
+    } tIter;
+  };
+};
+
+#define TSDB_FILTER_FLAG_BY_VERSION 0x1
+struct STsdbFilterInfo {
+  int32_t flag;
+  int64_t sver;
+  int64_t ever;
+};
+
+#define TSDB_RBTN_TO_DATA_ITER(pNode) ((STsdbDataIter2 *)(((char *)pNode) - offsetof(STsdbDataIter2, rbtn)))
+
 typedef struct SMergeTree {
   int8_t             backward;
   SRBTree            rbt;
@@ -740,6 +858,8 @@ typedef struct {
 
 int32_t tsdbOpenCache(STsdb *pTsdb);
 void    tsdbCloseCache(STsdb *pTsdb);
+int32_t tsdbOpenPgCache(STsdb *pTsdb);
+void    tsdbClosePgCache(STsdb *pTsdb);
 int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, STSRow *row, STsdb *pTsdb);
 int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, STSRow *row, bool dup);
 int32_t tsdbCacheGetLastH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr, LRUHandle **h);
@@ -783,19 +903,37 @@ static FORCE_INLINE TSDBROW *tsdbTbDataIterGet(STbDataIter *pIter) {
     return pIter->pRow;
   }
 
+  bool hasNode;
   if (pIter->backward) {
-    if (pIter->pNode == pIter->pTbData->sl.pHead) {
-      return NULL;
-    }
+    hasNode = (pIter->pNode != pIter->pTbData->sl.pHead);
   } else {
-    if (pIter->pNode == pIter->pTbData->sl.pTail) {
-      return NULL;
-    }
+    hasNode = (pIter->pNode != pIter->pTbData->sl.pTail);
+  }
+
+  if (!hasNode && pIter->pChunk == NULL) {
+    return NULL;
+  }
+
+  if (hasNode && pIter->pChunk) {
+    // merge skiplist rows and chunk rows by key
+    SMemChunk *pChunk = pIter->pChunk;
+    TSDBKEY    nKey = {.version = pIter->pNode->version, .ts = pIter->pNode->pTSRow->ts};
+    TSDBKEY    cKey = {.version = pChunk->bData.aVersion[pIter->iChunkRow],
+                       .ts = pChunk->bData.aTSKEY[pIter->iChunkRow]};
+    int32_t    c = tsdbKeyCmprFn(&nKey, &cKey);
+
+    pIter->fromChunk = pIter->backward ? (c < 0) : (c > 0);
+  } else {
+    pIter->fromChunk = (pIter->pChunk != NULL);
   }
 
   pIter->pRow = &pIter->row;
-  pIter->pRow->version = pIter->pNode->version;
-  pIter->pRow->pTSRow = pIter->pNode->pTSRow;
+  if (pIter->fromChunk) {
+    pIter->row = tsdbRowFromBlockData(&pIter->pChunk->bData, pIter->iChunkRow);
+    pIter->row.sver = pIter->pChunk->sver;
+  } else {
+    pIter->row = tsdbRowFromTSRow(pIter->pNode->version, pIter->pNode->pTSRow);
+  }
 
   return pIter->pRow;
 }
@@ -66,6 +66,7 @@ struct SVBufPool {
   TdThreadSpinlock* lock;
   volatile int32_t  nRef;
   int64_t           size;
+  int64_t           extSize;  // memory held by the memtable outside of the pool
   uint8_t*          ptr;
   SVBufPoolNode*    pTail;
   SVBufPoolNode     node;
@@ -93,6 +94,8 @@ int32_t vnodeCommitInfo(const char* dir, const SVnodeInfo* pInfo);
 int32_t vnodeLoadInfo(const char* dir, SVnodeInfo* pInfo);
 int32_t vnodeSyncCommit(SVnode* pVnode);
 int32_t vnodeAsyncCommit(SVnode* pVnode);
+int32_t vnodeAsyncCompact(SVnode* pVnode);
+void    vnodeStopCompact(SVnode* pVnode);
 bool    vnodeShouldRollback(SVnode* pVnode);
 
 // vnodeSync.c
@@ -93,9 +93,12 @@ typedef struct SCommitInfo        SCommitInfo;
 void* vnodeBufPoolMalloc(SVBufPool* pPool, int size);
 void* vnodeBufPoolMallocAligned(SVBufPool* pPool, int size);
 void  vnodeBufPoolFree(SVBufPool* pPool, void* p);
+void  vnodeBufPoolAddExtSize(SVBufPool* pPool, int64_t size);
 void  vnodeBufPoolRef(SVBufPool* pPool);
 void  vnodeBufPoolUnRef(SVBufPool* pPool);
 int   vnodeDecodeInfo(uint8_t* pData, SVnodeInfo* pInfo);
+int   vnodeScheduleFSetTask(int (*execute)(void*), void* arg);
+int   vnodeScheduleCompactTask(int (*execute)(void*), void* arg);
 
 // meta
 typedef struct SMCtbCursor SMCtbCursor;
@@ -124,6 +127,8 @@ int             metaAlterTable(SMeta* pMeta, int64_t version, SVAlterTbReq* pReq
 SSchemaWrapper* metaGetTableSchema(SMeta* pMeta, tb_uid_t uid, int32_t sver, int lock);
 STSchema*       metaGetTbTSchema(SMeta* pMeta, tb_uid_t uid, int32_t sver, int lock);
 int32_t         metaGetTbTSchemaEx(SMeta* pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema** ppTSchema);
+int32_t         metaAcquireTbTSchema(SMeta* pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema** ppTSchema);
+void            metaReleaseTbTSchema(SMeta* pMeta, STSchema* pTSchema);
 int             metaGetTableEntryByName(SMetaReader* pReader, const char* name);
 int             metaAlterCache(SMeta* pMeta, int32_t nPage);
 
@@ -162,6 +167,10 @@ int32_t tsdbCommit(STsdb* pTsdb, SCommitInfo* pInfo);
 int32_t tsdbFinishCommit(STsdb* pTsdb);
 int32_t tsdbRollbackCommit(STsdb* pTsdb);
 int32_t tsdbDoRetention(STsdb* pTsdb, int64_t now);
+int32_t tsdbCompact(STsdb* pTsdb, int64_t commitID, int8_t force);
+bool    tsdbShouldCompact(STsdb* pTsdb);
+int32_t tsdbGetCompactProgress(STsdb* pTsdb);
+void    tsdbGetPgCacheStat(STsdb* pTsdb, int64_t* hit, int64_t* miss, size_t* usage);
 int     tsdbScanAndConvertSubmitMsg(STsdb* pTsdb, SSubmitReq* pMsg);
 int     tsdbInsertData(STsdb* pTsdb, int64_t version, SSubmitReq* pMsg, SSubmitRsp* pRsp);
 int32_t tsdbInsertTableData(STsdb* pTsdb, int64_t version, SSubmitMsgIter* pMsgIter, SSubmitBlk* pBlock,
@@ -190,6 +199,11 @@ int32_t tqProcessTaskDeployReq(STQ* pTq, int64_t version, char* msg, int32_t msg
 int32_t tqProcessTaskDropReq(STQ* pTq, int64_t version, char* msg, int32_t msgLen);
 int32_t tqProcessStreamTaskCheckReq(STQ* pTq, SRpcMsg* pMsg);
 int32_t tqProcessStreamTaskCheckRsp(STQ* pTq, int64_t version, char* msg, int32_t msgLen);
+int32_t tqProcessStreamCheckpointSourceReq(STQ* pTq, int64_t version, char* msg, int32_t msgLen);
+int32_t tqProcessStreamCheckpointReq(STQ* pTq, SRpcMsg* pMsg);
+int32_t tqProcessStreamCheckpointRsp(STQ* pTq, SRpcMsg* pMsg);
+int32_t tqProcessStreamCheckpointCheckReq(STQ* pTq, SRpcMsg* pMsg);
+int32_t tqProcessStreamCheckpointReportReq(STQ* pTq, SRpcMsg* pMsg);
 int32_t tqProcessSubmitReq(STQ* pTq, SSubmitReq* data, int64_t ver);
 int32_t tqProcessDelReq(STQ* pTq, void* pReq, int32_t len, int64_t ver);
 int32_t tqProcessTaskRunReq(STQ* pTq, SRpcMsg* pMsg);
@@ -356,6 +370,9 @@ struct SVnode {
   SSink*        pSink;
   tsem_t        canCommit;
   SVCommitSched commitSched;
+  int8_t        compacting;    // a compaction job is scheduled or running
+  int8_t        compactForce;  // a forced compaction is requested
+  int8_t        compactStop;   // the vnode is closing, no more compaction
   int64_t       sync;
   TdThreadMutex lock;
   bool          blocked;
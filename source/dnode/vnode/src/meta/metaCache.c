@@ -14,8 +14,10 @@
  */
 #include "meta.h"
 
-#define META_CACHE_BASE_BUCKET  1024
-#define META_CACHE_STATS_BUCKET 16
+#define META_CACHE_BASE_BUCKET   1024
+#define META_CACHE_STATS_BUCKET  16
+#define META_CACHE_SCHEMA_BUCKET 64
+#define META_CACHE_SCHEMA_MAX    4096
 
 // (uid , suid) : child table
 // (uid,     0) : normal table
@@ -31,6 +33,16 @@ typedef struct SMetaStbStatsEntry {
   SMetaStbStats              info;
 } SMetaStbStatsEntry;
 
+// (uid, sver) : row schema of a super or normal table, immutable and shared by reference
+typedef struct SMetaSchemaEntry SMetaSchemaEntry;
+struct SMetaSchemaEntry {
+  SMetaSchemaEntry* next;
+  TD_DLIST_NODE(SMetaSchemaEntry) lruNode;
+  int64_t           uid;
+  int32_t           nRef;  // one held by the cache while linked, one per acquirer
+  STSchema*         pTSchema;
+};
+
 typedef struct STagFilterResEntry {
   uint64_t suid;    // uid for super table
   SList    list;    // the linked list of md5 digest, extracted from the serialized tag query condition
@@ -52,6 +64,15 @@ struct SMetaCache {
     SMetaStbStatsEntry** aBucket;
   } sStbStatsCache;
 
+  // row schema cache
+  struct SSchemaCache {
+    TdThreadMutex      lock;
+    int32_t            nEntry;
+    int32_t            nBucket;
+    SMetaSchemaEntry** aBucket;
+    TD_DLIST(SMetaSchemaEntry) lruList;  // most recently used first, evicted from the tail
+  } sSchemaCache;
+
   // query cache
   struct STagFilterResCache {
     TdThreadMutex lock;
@@ -90,6 +111,27 @@ static void statsCacheClose(SMeta* pMeta) {
   }
 }
 
+static void schemaCacheUnref(SMetaSchemaEntry* pEntry) {
+  if (atomic_sub_fetch_32(&pEntry->nRef, 1) == 0) {
+    taosMemoryFree(pEntry);
+  }
+}
+
+static void schemaCacheClose(SMeta* pMeta) {
+  if (pMeta->pCache) {
+    for (int32_t iBucket = 0; iBucket < pMeta->pCache->sSchemaCache.nBucket; iBucket++) {
+      SMetaSchemaEntry* pEntry = pMeta->pCache->sSchemaCache.aBucket[iBucket];
+      while (pEntry) {
+        SMetaSchemaEntry* tEntry = pEntry->next;
+        schemaCacheUnref(pEntry);
+        pEntry = tEntry;
+      }
+    }
+    taosMemoryFree(pMeta->pCache->sSchemaCache.aBucket);
+    taosThreadMutexDestroy(&pMeta->pCache->sSchemaCache.lock);
+  }
+}
+
 static void freeCacheEntryFp(void* param) {
   STagFilterResEntry** p = param;
   tdListEmpty(&(*p)->list);
@@ -126,6 +168,18 @@ int32_t metaCacheOpen(SMeta* pMeta) {
     goto _err2;
   }
 
+  // open schema cache
+  pCache->sSchemaCache.nEntry = 0;
+  TD_DLIST_INIT(&pCache->sSchemaCache.lruList);
+  pCache->sSchemaCache.nBucket = META_CACHE_SCHEMA_BUCKET;
+  pCache->sSchemaCache.aBucket =
+      (SMetaSchemaEntry**)taosMemoryCalloc(pCache->sSchemaCache.nBucket, sizeof(SMetaSchemaEntry*));
+  if (pCache->sSchemaCache.aBucket == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err2;
+  }
+  taosThreadMutexInit(&pCache->sSchemaCache.lock, NULL);
+
   pCache->sTagFilterResCache.pUidResCache = taosLRUCacheInit(5 * 1024 * 1024, -1, 0.5);
   if (pCache->sTagFilterResCache.pUidResCache == NULL) {
     code = TSDB_CODE_OUT_OF_MEMORY;
@@ -158,6 +212,7 @@ void metaCacheClose(SMeta* pMeta) {
   if (pMeta->pCache) {
     entryCacheClose(pMeta);
     statsCacheClose(pMeta);
+    schemaCacheClose(pMeta);
 
     taosHashCleanup(pMeta->pCache->sTagFilterResCache.pTableEntry);
     taosLRUCacheCleanup(pMeta->pCache->sTagFilterResCache.pUidResCache);
@@ -424,6 +479,157 @@ int32_t metaStatsCacheGet(SMeta* pMeta, int64_t uid, SMetaStbStats* pInfo) {
   return code;
 }
 
+static FORCE_INLINE int32_t schemaCacheBucket(int64_t uid, int32_t sver, int32_t nBucket) {
+  return (int32_t)((((uint64_t)uid) * 31 + (uint32_t)sver) % nBucket);
+}
+
+static int32_t metaRehashSchemaCache(SMetaCache* pCache) {
+  int32_t nBucket = pCache->sSchemaCache.nBucket * 2;
+
+  SMetaSchemaEntry** aBucket = (SMetaSchemaEntry**)taosMemoryCalloc(nBucket, sizeof(SMetaSchemaEntry*));
+  if (aBucket == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t iBucket = 0; iBucket < pCache->sSchemaCache.nBucket; iBucket++) {
+    SMetaSchemaEntry* pEntry = pCache->sSchemaCache.aBucket[iBucket];
+
+    while (pEntry) {
+      SMetaSchemaEntry* pTEntry = pEntry->next;
+      int32_t           i = schemaCacheBucket(pEntry->uid, pEntry->pTSchema->version, nBucket);
+
+      pEntry->next = aBucket[i];
+      aBucket[i] = pEntry;
+
+      pEntry = pTEntry;
+    }
+  }
+
+  taosMemoryFree(pCache->sSchemaCache.aBucket);
+  pCache->sSchemaCache.nBucket = nBucket;
+  pCache->sSchemaCache.aBucket = aBucket;
+  return 0;
+}
+
+// unlink an entry from the cache, the readers holding it keep it until released
+static void schemaCacheRemove(SMetaCache* pCache, SMetaSchemaEntry** ppEntry) {
+  SMetaSchemaEntry* pEntry = *ppEntry;
+
+  *ppEntry = pEntry->next;
+  TD_DLIST_POP_WITH_FIELD(&pCache->sSchemaCache.lruList, pEntry, lruNode);
+  pCache->sSchemaCache.nEntry--;
+  schemaCacheUnref(pEntry);
+}
+
+static void schemaCacheEvict(SMetaCache* pCache) {
+  while (pCache->sSchemaCache.nEntry > META_CACHE_SCHEMA_MAX) {
+    SMetaSchemaEntry*  pEntry = TD_DLIST_TAIL(&pCache->sSchemaCache.lruList);
+    int32_t            sver = pEntry->pTSchema->version;
+    int32_t            iBucket = schemaCacheBucket(pEntry->uid, sver, pCache->sSchemaCache.nBucket);
+    SMetaSchemaEntry** ppEntry = &pCache->sSchemaCache.aBucket[iBucket];
+    while (*ppEntry != pEntry) {
+      ppEntry = &(*ppEntry)->next;
+    }
+    schemaCacheRemove(pCache, ppEntry);
+  }
+}
+
+// the schema got must be released by metaSchemaCacheRelease
+int32_t metaSchemaCacheGet(SMeta* pMeta, int64_t uid, int32_t sver, STSchema** ppTSchema) {
+  int32_t     code = TSDB_CODE_NOT_FOUND;
+  SMetaCache* pCache = pMeta->pCache;
+
+  taosThreadMutexLock(&pCache->sSchemaCache.lock);
+  int32_t           iBucket = schemaCacheBucket(uid, sver, pCache->sSchemaCache.nBucket);
+  SMetaSchemaEntry* pEntry = pCache->sSchemaCache.aBucket[iBucket];
+  while (pEntry && (pEntry->uid != uid || pEntry->pTSchema->version != sver)) {
+    pEntry = pEntry->next;
+  }
+
+  if (pEntry) {
+    atomic_add_fetch_32(&pEntry->nRef, 1);
+    *ppTSchema = pEntry->pTSchema;
+    TD_DLIST_POP_WITH_FIELD(&pCache->sSchemaCache.lruList, pEntry, lruNode);
+    TD_DLIST_PREPEND_WITH_FIELD(&pCache->sSchemaCache.lruList, pEntry, lruNode);
+    code = 0;
+  }
+  taosThreadMutexUnlock(&pCache->sSchemaCache.lock);
+
+  return code;
+}
+
+// put a copy of pTSchema into the cache and get the cached one, which must be released by metaSchemaCacheRelease
+int32_t metaSchemaCachePut(SMeta* pMeta, int64_t uid, const STSchema* pTSchema, STSchema** ppTSchema) {
+  int32_t     code = 0;
+  SMetaCache* pCache = pMeta->pCache;
+  int32_t     sver = pTSchema->version;
+  int32_t     size = sizeof(STSchema) + sizeof(STColumn) * pTSchema->numOfCols;
+
+  SMetaSchemaEntry* pEntryNew = (SMetaSchemaEntry*)taosMemoryMalloc(sizeof(SMetaSchemaEntry) + size);
+  if (pEntryNew == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pEntryNew->uid = uid;
+  pEntryNew->nRef = 2;
+  pEntryNew->pTSchema = (STSchema*)POINTER_SHIFT(pEntryNew, sizeof(SMetaSchemaEntry));
+  memcpy(pEntryNew->pTSchema, pTSchema, size);
+
+  taosThreadMutexLock(&pCache->sSchemaCache.lock);
+
+  // another reader may have put it already
+  int32_t           iBucket = schemaCacheBucket(uid, sver, pCache->sSchemaCache.nBucket);
+  SMetaSchemaEntry* pEntry = pCache->sSchemaCache.aBucket[iBucket];
+  while (pEntry && (pEntry->uid != uid || pEntry->pTSchema->version != sver)) {
+    pEntry = pEntry->next;
+  }
+  if (pEntry) {
+    atomic_add_fetch_32(&pEntry->nRef, 1);
+    *ppTSchema = pEntry->pTSchema;
+    taosThreadMutexUnlock(&pCache->sSchemaCache.lock);
+    taosMemoryFree(pEntryNew);
+    return code;
+  }
+
+  if (pCache->sSchemaCache.nEntry >= pCache->sSchemaCache.nBucket) {
+    if (metaRehashSchemaCache(pCache) == 0) {
+      iBucket = schemaCacheBucket(uid, sver, pCache->sSchemaCache.nBucket);
+    }
+  }
+  pEntryNew->next = pCache->sSchemaCache.aBucket[iBucket];
+  pCache->sSchemaCache.aBucket[iBucket] = pEntryNew;
+  pCache->sSchemaCache.nEntry++;
+  TD_DLIST_PREPEND_WITH_FIELD(&pCache->sSchemaCache.lruList, pEntryNew, lruNode);
+  *ppTSchema = pEntryNew->pTSchema;
+  schemaCacheEvict(pCache);
+
+  taosThreadMutexUnlock(&pCache->sSchemaCache.lock);
+  return code;
+}
+
+void metaSchemaCacheRelease(STSchema* pTSchema) {
+  if (pTSchema) {
+    schemaCacheUnref((SMetaSchemaEntry*)POINTER_SHIFT(pTSchema, -(int32_t)sizeof(SMetaSchemaEntry)));
+  }
+}
+
+// drop all the cached schema versions of a table, readers holding them keep them until released
+void metaSchemaCacheDrop(SMeta* pMeta, int64_t uid) {
+  SMetaCache* pCache = pMeta->pCache;
+
+  taosThreadMutexLock(&pCache->sSchemaCache.lock);
+  for (int32_t iBucket = 0; iBucket < pCache->sSchemaCache.nBucket && pCache->sSchemaCache.nEntry > 0; iBucket++) {
+    SMetaSchemaEntry** ppEntry = &pCache->sSchemaCache.aBucket[iBucket];
+    while (*ppEntry) {
+      if ((*ppEntry)->uid == uid) {
+        schemaCacheRemove(pCache, ppEntry);
+      } else {
+        ppEntry = &(*ppEntry)->next;
+      }
+    }
+  }
+  taosThreadMutexUnlock(&pCache->sSchemaCache.lock);
+}
+
 int32_t metaGetCachedTableUidList(SMeta* pMeta, tb_uid_t suid, const uint8_t* pKey, int32_t keyLen, SArray* pList1,
                                   bool* acquireRes) {
   // generate the composed key for LRU cache
@@ -636,12 +636,33 @@ tb_uid_t metaStbCursorNext(SMStbCursor *pStbCur) {
   return *(tb_uid_t *)pStbCur->pKey;
 }
 
+static STSchema *metaCloneTSchema(const STSchema *pTSchema) {
+  int32_t   size = sizeof(STSchema) + sizeof(STColumn) * pTSchema->numOfCols;
+  STSchema *pNew = taosMemoryMalloc(size);
+  if (pNew) {
+    memcpy(pNew, pTSchema, size);
+  }
+  return pNew;
+}
+
 STSchema *metaGetTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, int lock) {
   // SMetaReader     mr = {0};
   STSchema       *pTSchema = NULL;
   SSchemaWrapper *pSW = NULL;
   STSchemaBuilder sb = {0};
   SSchema        *pSchema;
+  SMetaInfo       info;
+
+  // serve from the schema cache, the lock is taken by metaGetInfo
+  if (lock && metaGetInfo(pMeta, uid, &info, NULL) == 0) {
+    STSchema *pShared = NULL;
+    tb_uid_t  suid = (info.suid == uid) ? 0 : info.suid;
+    if (metaAcquireTbTSchema(pMeta, suid, uid, sver, &pShared) == 0) {
+      pTSchema = metaCloneTSchema(pShared);
+      metaReleaseTbTSchema(pMeta, pShared);
+      return pTSchema;
+    }
+  }
 
   pSW = metaGetTableSchema(pMeta, uid, sver, lock);
   if (!pSW) return NULL;
@@ -661,6 +682,21 @@ STSchema *metaGetTbTSchema(SMeta *pMeta, tb_uid_t uid, int32_t sver, int lock) {
 }
 
 int32_t metaGetTbTSchemaEx(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema **ppTSchema) {
+  STSchema *pShared = NULL;
+
+  int32_t code = metaAcquireTbTSchema(pMeta, suid, uid, sver, &pShared);
+  if (code == 0) {
+    *ppTSchema = metaCloneTSchema(pShared);
+    if (*ppTSchema == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+    metaReleaseTbTSchema(pMeta, pShared);
+  }
+  return code;
+}
+
+// the schema acquired is shared and immutable, it must be released by metaReleaseTbTSchema
+int32_t metaAcquireTbTSchema(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sver, STSchema **ppTSchema) {
   int32_t code = 0;
 
   void     *pData = NULL;
@@ -713,6 +749,10 @@ int32_t metaGetTbTSchemaEx(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sv
 
   ASSERT(sver > 0);
 
+  if (metaSchemaCacheGet(pMeta, suid ? suid : uid, sver, ppTSchema) == 0) {
+    goto _exit;
+  }
+
   skmDbKey.uid = suid ? suid : uid;
   skmDbKey.sver = sver;
   metaRLock(pMeta);
@@ -745,17 +785,20 @@ int32_t metaGetTbTSchemaEx(SMeta *pMeta, tb_uid_t suid, tb_uid_t uid, int32_t sv
   STSchema *pTSchema = tdGetSchemaFromBuilder(&sb);
   if (pTSchema == NULL) {
     code = TSDB_CODE_OUT_OF_MEMORY;
+  } else {
+    code = metaSchemaCachePut(pMeta, skmDbKey.uid, pTSchema, ppTSchema);
+    tDestroyTSchema(pTSchema);
   }
 
   tdDestroyTSchemaBuilder(&sb);
-
-  *ppTSchema = pTSchema;
   taosMemoryFree(pSchemaWrapper->pSchema);
 
 _exit:
   return code;
 }
 
+void metaReleaseTbTSchema(SMeta *pMeta, STSchema *pTSchema) { metaSchemaCacheRelease(pTSchema); }
+
 // N.B. Called by statusReq per second
 int64_t metaGetTbNum(SMeta *pMeta) {
   // num of child tables (excluding normal tables , stables and others)
@@ -300,6 +300,8 @@ _drop_super_table:
   tdbTbDelete(pMeta->pUidIdx, &pReq->suid, sizeof(tb_uid_t), pMeta->txn);
   tdbTbDelete(pMeta->pSuidIdx, &pReq->suid, sizeof(tb_uid_t), pMeta->txn);
 
+  metaSchemaCacheDrop(pMeta, pReq->suid);
+
   metaULock(pMeta);
 
 _exit:
@@ -372,6 +374,7 @@ int metaAlterSTable(SMeta *pMeta, int64_t version, SVCreateStbReq *pReq) {
   metaUpdateUidIdx(pMeta, &nStbEntry);
 
   // metaStatsCacheDrop(pMeta, nStbEntry.uid);
+  metaSchemaCacheDrop(pMeta, nStbEntry.uid);
 
   metaULock(pMeta);
 
@@ -698,6 +701,7 @@ static int metaDropTableByUid(SMeta *pMeta, tb_uid_t uid, int *type) {
   }
 
   metaCacheDrop(pMeta, uid);
+  if (e.type != TSDB_CHILD_TABLE) metaSchemaCacheDrop(pMeta, uid);
 
   tDecoderClear(&dc);
   tdbFree(pData);
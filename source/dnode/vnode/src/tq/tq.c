@@ -72,6 +72,11 @@ static void tqPushEntryFree(void* data) {
   taosMemoryFree(p);
 }
 
+static void tqStreamRefFree(void* data) {
+  SWalRef* pRef = *(SWalRef**)data;
+  walCloseRef(pRef->pWal, pRef->refId);
+}
+
 STQ* tqOpen(const char* path, SVnode* pVnode) {
   STQ* pTq = taosMemoryCalloc(1, sizeof(STQ));
   if (pTq == NULL) {
@@ -92,6 +97,9 @@ STQ* tqOpen(const char* path, SVnode* pVnode) {
   pTq->pCheckInfo = taosHashInit(64, MurmurHash3_32, true, HASH_ENTRY_LOCK);
   taosHashSetFreeFp(pTq->pCheckInfo, (FDelete)tDeleteSTqCheckInfo);
 
+  pTq->pStreamRef = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_ENTRY_LOCK);
+  taosHashSetFreeFp(pTq->pStreamRef, tqStreamRefFree);
+
   if (tqMetaOpen(pTq) < 0) {
     return NULL;
   }
@@ -122,6 +130,7 @@ void tqClose(STQ* pTq) {
     taosMemoryFree(pTq->path);
     tqMetaClose(pTq);
     streamMetaClose(pTq->pStreamMeta);
+    taosHashCleanup(pTq->pStreamRef);
     taosMemoryFree(pTq);
   }
 }
@@ -895,6 +904,26 @@ int32_t tqProcessSubscribeReq(STQ* pTq, int64_t version, char* msg, int32_t msgL
   return 0;
 }
 
+// Keep the wal from the version of the last completed checkpoint of a source task, released once the next one completes
+void tqPinStreamWal(STQ* pTq, int32_t taskId, int64_t ver) {
+  SWalRef** ppRef = taosHashGet(pTq->pStreamRef, &taskId, sizeof(int32_t));
+  SWalRef*  pRef = ppRef ? *ppRef : NULL;
+
+  if (pRef == NULL) {
+    pRef = walOpenRef(pTq->pVnode->pWal);
+    if (pRef == NULL || taosHashPut(pTq->pStreamRef, &taskId, sizeof(int32_t), &pRef, POINTER_BYTES) < 0) {
+      if (pRef) walCloseRef(pTq->pVnode->pWal, pRef->refId);
+      tqError("vgId:%d, failed to keep wal from ver:%" PRId64 " for task %d", TD_VID(pTq->pVnode), ver, taskId);
+      return;
+    }
+  }
+
+  if (walRefVer(pRef, ver) < 0) {
+    tqError("vgId:%d, failed to keep wal from ver:%" PRId64 " for task %d since %s", TD_VID(pTq->pVnode), ver, taskId,
+            terrstr());
+  }
+}
+
 int32_t tqExpandTask(STQ* pTq, SStreamTask* pTask, int64_t ver) {
   if (pTask->taskLevel == TASK_LEVEL__AGG) {
     ASSERT(taosArrayGetSize(pTask->childEpInfo) != 0);
@@ -927,6 +956,9 @@ int32_t tqExpandTask(STQ* pTq, SStreamTask* pTask, int64_t ver) {
     if (pTask->pState == NULL) {
       return -1;
     }
+    if (pTask->checkpointId > 0) {
+      tqPinStreamWal(pTq, pTask->taskId, pTask->checkpointVer);
+    }
 
     SReadHandle handle = {
         .meta = pTq->pVnode->pMeta,
@@ -1060,6 +1092,145 @@ int32_t tqProcessStreamTaskCheckRsp(STQ* pTq, int64_t version, char* msg, int32_
   return code;
 }
 
+int32_t tqProcessStreamCheckpointSourceReq(STQ* pTq, int64_t version, char* msg, int32_t msgLen) {
+  SStreamCheckpointSourceReq req;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, (uint8_t*)msg, msgLen);
+  if (tDecodeSStreamCheckpointSourceReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_MSG_DECODE_ERROR;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, req.taskId);
+  if (pTask == NULL) {
+    tqWarn("vgId:%d, checkpoint %" PRId64 " skipped since task %d not found", TD_VID(pTq->pVnode), req.checkpointId,
+           req.taskId);
+    return 0;
+  }
+
+  int32_t code = streamProcessCheckpointSourceReq(pTq->pStreamMeta, pTask, &req, version);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return code;
+}
+
+int32_t tqProcessStreamCheckpointReq(STQ* pTq, SRpcMsg* pMsg) {
+  char*                msgBody = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t              msgLen = pMsg->contLen - sizeof(SMsgHead);
+  SStreamCheckpointReq req;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, (uint8_t*)msgBody, msgLen);
+  if (tDecodeSStreamCheckpointReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_MSG_DECODE_ERROR;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, req.downstreamTaskId);
+  if (pTask == NULL) {
+    streamSendCheckpointRsp(&req, &pMsg->info, TSDB_CODE_STREAM_TASK_NOT_EXIST);
+    return 0;
+  }
+
+  // the rsp is sent once the barrier is aligned
+  streamProcessCheckpointReq(pTq->pStreamMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return 0;
+}
+
+int32_t tqProcessStreamCheckpointRsp(STQ* pTq, SRpcMsg* pMsg) {
+  char*                msgBody = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t              msgLen = pMsg->contLen - sizeof(SMsgHead);
+  SStreamCheckpointRsp rsp;
+
+  tqDebug("recv checkpoint rsp, code: %x", pMsg->code);
+
+  // the upstream task is unknown without the body, it goes on dispatching once the rsps time out
+  SDecoder decoder;
+  tDecoderInit(&decoder, (uint8_t*)msgBody, msgLen);
+  if (msgLen <= 0 || tDecodeSStreamCheckpointRsp(&decoder, &rsp) < 0) {
+    tDecoderClear(&decoder);
+    tqError("vgId:%d, failed to decode checkpoint rsp, code:%s", TD_VID(pTq->pVnode), tstrerror(pMsg->code));
+    return 0;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, rsp.upstreamTaskId);
+  if (pTask == NULL) {
+    tqDebug("vgId:%d, checkpoint %" PRId64 " rsp skipped since task %d not found", TD_VID(pTq->pVnode),
+            rsp.checkpointId, rsp.upstreamTaskId);
+    return 0;
+  }
+
+  int32_t code = streamProcessCheckpointRsp(pTq->pStreamMeta, pTask, &rsp, pMsg->code);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return code;
+}
+
+int32_t tqProcessStreamCheckpointCheckReq(STQ* pTq, SRpcMsg* pMsg) {
+  char*                      msgBody = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t                    msgLen = pMsg->contLen - sizeof(SMsgHead);
+  SStreamCheckpointReportReq req;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, (uint8_t*)msgBody, msgLen);
+  if (tDecodeSStreamCheckpointReportReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_MSG_DECODE_ERROR;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, req.taskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  // the rsp is sent once the task has executed the barrier
+  streamProcessCheckpointCheckReq(pTq->pStreamMeta, pTask, &req, pMsg);
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  return 0;
+}
+
+int32_t tqProcessStreamCheckpointReportReq(STQ* pTq, SRpcMsg* pMsg) {
+  char*                      msgBody = POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  int32_t                    msgLen = pMsg->contLen - sizeof(SMsgHead);
+  SStreamCheckpointReportReq req;
+  int64_t                    ver = -1;
+
+  SDecoder decoder;
+  tDecoderInit(&decoder, (uint8_t*)msgBody, msgLen);
+  if (tDecodeSStreamCheckpointReportReq(&decoder, &req) < 0) {
+    tDecoderClear(&decoder);
+    terrno = TSDB_CODE_MSG_DECODE_ERROR;
+    return -1;
+  }
+  tDecoderClear(&decoder);
+
+  SStreamTask* pTask = streamMetaAcquireTask(pTq->pStreamMeta, req.taskId);
+  if (pTask == NULL) {
+    terrno = TSDB_CODE_STREAM_TASK_NOT_EXIST;
+    return -1;
+  }
+
+  int32_t code = streamProcessCheckpointReportReq(pTq->pStreamMeta, pTask, &req, &ver);
+  if (code == 0 && pTask->taskLevel == TASK_LEVEL__SOURCE && ver >= 0) {
+    // the task is restored from the checkpoint and rescans the wal from ver, keep the wal from there
+    tqPinStreamWal(pTq, pTask->taskId, ver);
+  }
+  streamMetaReleaseTask(pTq->pStreamMeta, pTask);
+  if (code < 0) return -1;
+
+  SRpcMsg rsp = {.code = 0, .info = pMsg->info};
+  tmsgSendRsp(&rsp);
+  return 0;
+}
+
 int32_t tqProcessTaskDeployReq(STQ* pTq, int64_t version, char* msg, int32_t msgLen) {
   int32_t code;
 #if 0
@@ -1116,8 +1287,10 @@ int32_t tqProcessTaskRecover1Req(STQ* pTq, SRpcMsg* pMsg) {
     return -1;
   }
 
-  // do recovery step 1
-  streamSourceRecoverScanStep1(pTask);
+  // do recovery step 1, not needed if the state is restored from a checkpoint
+  if (pTask->checkpointId <= 0) {
+    streamSourceRecoverScanStep1(pTask);
+  }
 
   if (atomic_load_8(&pTask->taskStatus) == TASK_STATUS__DROPPING) {
     streamMetaReleaseTask(pTq->pStreamMeta, pTask);
@@ -1456,6 +1629,7 @@ int32_t tqProcessTaskDispatchRsp(STQ* pTq, SRpcMsg* pMsg) {
 int32_t tqProcessTaskDropReq(STQ* pTq, int64_t version, char* msg, int32_t msgLen) {
   SVDropStreamTaskReq* pReq = (SVDropStreamTaskReq*)msg;
   streamMetaRemoveTask(pTq->pStreamMeta, pReq->taskId);
+  taosHashRemove(pTq->pStreamRef, &pReq->taskId, sizeof(int32_t));
   return 0;
 }
 
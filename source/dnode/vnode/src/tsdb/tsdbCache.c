@@ -46,6 +46,45 @@ void tsdbCloseCache(STsdb *pTsdb) {
   }
 }
 
+int32_t tsdbOpenPgCache(STsdb *pTsdb) {
+  int32_t    code = 0;
+  SLRUCache *pCache = NULL;
+  size_t     cfgCapacity = (size_t)tsTsdbPageCacheSize * 1024 * 1024;
+
+  if (cfgCapacity > 0) {
+    pCache = taosLRUCacheInit(cfgCapacity, -1, .5);
+    if (pCache == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _err;
+    }
+
+    taosLRUCacheSetStrictCapacity(pCache, false);
+  }
+
+_err:
+  pTsdb->pgCache = pCache;
+  return code;
+}
+
+void tsdbClosePgCache(STsdb *pTsdb) {
+  SLRUCache *pCache = pTsdb->pgCache;
+  if (pCache) {
+    tsdbDebug("vgId:%d, tsdb page cache closed, hit:%" PRId64 " miss:%" PRId64 " usage:%" PRIzu,
+              TD_VID(pTsdb->pVnode), pTsdb->pgCacheHit, pTsdb->pgCacheMiss, taosLRUCacheGetUsage(pCache));
+
+    taosLRUCacheEraseUnrefEntries(pCache);
+
+    taosLRUCacheCleanup(pCache);
+    pTsdb->pgCache = NULL;
+  }
+}
+
+void tsdbGetPgCacheStat(STsdb *pTsdb, int64_t *hit, int64_t *miss, size_t *usage) {
+  *hit = atomic_load_64(&pTsdb->pgCacheHit);
+  *miss = atomic_load_64(&pTsdb->pgCacheMiss);
+  *usage = pTsdb->pgCache ? taosLRUCacheGetUsage(pTsdb->pgCache) : 0;
+}
+
 static void getTableCacheKey(tb_uid_t uid, int cacheType, char *key, int *len) {
   if (cacheType == 0) {  // last_row
     *(uint64_t *)key = (uint64_t)uid;
@@ -796,7 +835,8 @@ static int32_t getNextRowFromMem(void *iter, TSDBROW **ppRow) {
   switch (state->state) {
     case SMEMNEXTROW_ENTER: {
       if (state->pMem != NULL) {
-        tsdbTbDataIterOpen(state->pMem, NULL, 1, &state->iter);
+        code = tsdbTbDataIterOpen(state->pMem, NULL, 1, &state->iter);
+        if (code) goto _err;
 
         TSDBROW *pMemRow = tsdbTbDataIterGet(&state->iter);
         if (pMemRow) {
@@ -831,6 +871,13 @@ _err:
   return code;
 }
 
+static int32_t clearNextRowFromMem(void *iter) {
+  SMemNextRowIter *state = (SMemNextRowIter *)iter;
+
+  tsdbTbDataIterClose(&state->iter);
+  return 0;
+}
+
 /* static int32_t tsRowFromTsdbRow(STSchema *pTSchema, TSDBROW *pRow, STSRow **ppRow) { */
 /*   int32_t code = 0; */
 
@@ -997,8 +1044,10 @@ static int32_t nextRowIterOpen(CacheNextRowIter *pIter, tb_uid_t uid, STsdb *pTs
   pIter->fsState.pLoadInfo = pLoadInfo;
   pIter->fsState.pDataFReader = pDataFReader;
 
-  pIter->input[0] = (TsdbNextRowState){&pIter->memRow, true, false, &pIter->memState, getNextRowFromMem, NULL};
-  pIter->input[1] = (TsdbNextRowState){&pIter->imemRow, true, false, &pIter->imemState, getNextRowFromMem, NULL};
+  pIter->input[0] =
+      (TsdbNextRowState){&pIter->memRow, true, false, &pIter->memState, getNextRowFromMem, clearNextRowFromMem};
+  pIter->input[1] =
+      (TsdbNextRowState){&pIter->imemRow, true, false, &pIter->imemState, getNextRowFromMem, clearNextRowFromMem};
   pIter->input[2] = (TsdbNextRowState){&pIter->fsLastRow,     false, true, &pIter->fsLastState, getNextRowFromFSLast,
                                        clearNextRowFromFSLast};
   pIter->input[3] =
@@ -38,6 +38,15 @@ typedef struct {
   };
 } SDataIter;
 
+typedef struct {
+  int32_t   fid;
+  SDFileSet wSet;
+  SHeadFile fHead;
+  SDataFile fData;
+  SSmaFile  fSma;
+  SSttFile  aSttF[TSDB_MAX_STT_TRIGGER];
+} SCommitFSet;
+
 typedef struct {
   STsdb *pTsdb;
   /* commit data */
@@ -48,8 +57,9 @@ typedef struct {
   int32_t maxRow;
   int8_t  cmprAlg;
   int8_t  sttTrigger;
-  SArray *aTbDataP;  // memory
-  STsdbFS fs;        // disk
+  SArray      *aTbDataP;  // memory
+  STsdbFS      fs;        // disk
+  SCommitFSet *pFSet;     // output of a fileset committed in parallel, NULL to upsert fs directly
   // --------------
   TSKEY   nextKey;  // reset by each table commit
   int32_t commitFid;
@@ -94,6 +104,19 @@ typedef struct {
   SArray      *aDelData;  // SArray<SDelData>
 } SCommitter;
 
+typedef struct {
+  SCommitter   *pCommitter;
+  SCommitFSet  *aFSet;
+  int32_t       nFSet;
+  int32_t       iFSet;    // next fileset to commit
+  int32_t       code;     // first error of all workers
+  int32_t       nRef;     // the commit task and each fileset task scheduled
+  TdThreadMutex mutex;
+  TdThreadCond  cond;
+  int32_t       nWorker;  // fileset tasks working on the job
+  int8_t        closed;   // the commit task is done, fileset tasks run after it do not join
+} SCommitJob;
+
 static int32_t tsdbStartCommit(STsdb *pTsdb, SCommitter *pCommitter, SCommitInfo *pInfo);
 static int32_t tsdbCommitData(SCommitter *pCommitter);
 static int32_t tsdbCommitDel(SCommitter *pCommitter);
@@ -158,6 +181,9 @@ int32_t tsdbPrepareCommit(STsdb *pTsdb) {
   pTsdb->mem = NULL;
   taosThreadRwlockUnlock(&pTsdb->rwLock);
 
+  // no row is appended to the memtable any more, so readers of it need not copy the chunk tails
+  if (pTsdb->imem) tsdbMemTableSeal(pTsdb->imem);
+
   return 0;
 }
 
@@ -376,8 +402,9 @@ static int32_t tsdbCommitterUpdateRowSchema(SCommitter *pCommitter, int64_t suid
 
   pCommitter->skmRow.suid = suid;
   pCommitter->skmRow.uid = uid;
-  tDestroyTSchema(pCommitter->skmRow.pTSchema);
-  code = metaGetTbTSchemaEx(pCommitter->pTsdb->pVnode->pMeta, suid, uid, sver, &pCommitter->skmRow.pTSchema);
+  metaReleaseTbTSchema(pCommitter->pTsdb->pVnode->pMeta, pCommitter->skmRow.pTSchema);
+  pCommitter->skmRow.pTSchema = NULL;
+  code = metaAcquireTbTSchema(pCommitter->pTsdb->pVnode->pMeta, suid, uid, sver, &pCommitter->skmRow.pTSchema);
   TSDB_CHECK_CODE(code, lino, _exit);
 
 _exit:
@@ -428,7 +455,8 @@ static int32_t tsdbOpenCommitIter(SCommitter *pCommitter) {
   pIter->iTbDataP = 0;
   for (; pIter->iTbDataP < taosArrayGetSize(pCommitter->aTbDataP); pIter->iTbDataP++) {
     STbData *pTbData = (STbData *)taosArrayGetP(pCommitter->aTbDataP, pIter->iTbDataP);
-    tsdbTbDataIterOpen(pTbData, &tKey, 0, &pIter->iter);
+    code = tsdbTbDataIterOpen(pTbData, &tKey, 0, &pIter->iter);
+    TSDB_CHECK_CODE(code, lino, _exit);
     TSDBROW *pRow = tsdbTbDataIterGet(&pIter->iter);
     if (pRow && TSDBROW_TS(pRow) > pCommitter->maxKey) {
       pCommitter->nextKey = TMIN(pCommitter->nextKey, TSDBROW_TS(pRow));
@@ -729,6 +757,22 @@ _exit:
   return code;
 }
 
+static void tsdbCommitFSetSave(SCommitFSet *pFSet, SDFileSet *pSet) {
+  pFSet->fHead = *pSet->pHeadF;
+  pFSet->fData = *pSet->pDataF;
+  pFSet->fSma = *pSet->pSmaF;
+  pFSet->wSet = (SDFileSet){.diskId = pSet->diskId,
+                            .fid = pSet->fid,
+                            .pHeadF = &pFSet->fHead,
+                            .pDataF = &pFSet->fData,
+                            .pSmaF = &pFSet->fSma,
+                            .nSttF = pSet->nSttF};
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    pFSet->aSttF[iStt] = *pSet->aSttF[iStt];
+    pFSet->wSet.aSttF[iStt] = &pFSet->aSttF[iStt];
+  }
+}
+
 static int32_t tsdbCommitFileDataEnd(SCommitter *pCommitter) {
   int32_t code = 0;
   int32_t lino = 0;
@@ -746,8 +790,12 @@ static int32_t tsdbCommitFileDataEnd(SCommitter *pCommitter) {
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // upsert SDFileSet
-  code = tsdbFSUpsertFSet(&pCommitter->fs, &pCommitter->dWriter.pWriter->wSet);
-  TSDB_CHECK_CODE(code, lino, _exit);
+  if (pCommitter->pFSet) {
+    tsdbCommitFSetSave(pCommitter->pFSet, &pCommitter->dWriter.pWriter->wSet);
+  } else {
+    code = tsdbFSUpsertFSet(&pCommitter->fs, &pCommitter->dWriter.pWriter->wSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
 
   // close and sync
   code = tsdbDataFWriterClose(&pCommitter->dWriter.pWriter, 1);
@@ -933,7 +981,191 @@ static void tsdbCommitDataEnd(SCommitter *pCommitter) {
   tBlockDataDestroy(&pCommitter->dWriter.bDatal, 1);
 #endif
   tDestroyTSchema(pCommitter->skmTable.pTSchema);
-  tDestroyTSchema(pCommitter->skmRow.pTSchema);
+  metaReleaseTbTSchema(pCommitter->pTsdb->pVnode->pMeta, pCommitter->skmRow.pTSchema);
+}
+
+static void tsdbCommitJobUnref(SCommitJob *pJob) {
+  if (atomic_sub_fetch_32(&pJob->nRef, 1) > 0) return;
+
+  taosThreadCondDestroy(&pJob->cond);
+  taosThreadMutexDestroy(&pJob->mutex);
+  taosMemoryFree(pJob->aFSet);
+  taosMemoryFree(pJob);
+}
+
+static void tsdbCommitFSetWork(SCommitJob *pJob) {
+  int32_t     code = 0;
+  int32_t     lino = 0;
+  SCommitter *pParent = pJob->pCommitter;
+  SCommitter *pCommitter = NULL;
+
+  pCommitter = (SCommitter *)taosMemoryCalloc(1, sizeof(*pCommitter));
+  if (pCommitter == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  pCommitter->pTsdb = pParent->pTsdb;
+  pCommitter->commitID = pParent->commitID;
+  pCommitter->minutes = pParent->minutes;
+  pCommitter->precision = pParent->precision;
+  pCommitter->minRow = pParent->minRow;
+  pCommitter->maxRow = pParent->maxRow;
+  pCommitter->cmprAlg = pParent->cmprAlg;
+  pCommitter->sttTrigger = pParent->sttTrigger;
+  pCommitter->aTbDataP = pParent->aTbDataP;
+  pCommitter->fs = pParent->fs;  // read only until all workers are done
+
+  code = tsdbCommitDataStart(pCommitter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  while (atomic_load_32(&pJob->code) == 0) {
+    int32_t iFSet = atomic_fetch_add_32(&pJob->iFSet, 1);
+    if (iFSet >= pJob->nFSet) break;
+
+    TSKEY minKey, maxKey;
+    tsdbFidKeyRange(pJob->aFSet[iFSet].fid, pCommitter->minutes, pCommitter->precision, &minKey, &maxKey);
+    pCommitter->nextKey = minKey;
+    pCommitter->pFSet = &pJob->aFSet[iFSet];
+
+    code = tsdbCommitFileData(pCommitter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (pCommitter) {
+    tsdbCommitDataEnd(pCommitter);
+    taosMemoryFree(pCommitter);
+  }
+  if (code) {
+    atomic_val_compare_exchange_32(&pJob->code, 0, code);
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pParent->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+}
+
+// run by the fileset pool, a task dequeued after the commit task is done only drops its reference
+static int32_t tsdbCommitFSetTask(void *arg) {
+  SCommitJob *pJob = (SCommitJob *)arg;
+  bool        join;
+
+  taosThreadMutexLock(&pJob->mutex);
+  join = !pJob->closed;
+  if (join) pJob->nWorker++;
+  taosThreadMutexUnlock(&pJob->mutex);
+
+  if (join) {
+    tsdbCommitFSetWork(pJob);
+
+    taosThreadMutexLock(&pJob->mutex);
+    if (--pJob->nWorker == 0) taosThreadCondSignal(&pJob->cond);
+    taosThreadMutexUnlock(&pJob->mutex);
+  }
+
+  tsdbCommitJobUnref(pJob);
+  return 0;
+}
+
+static int32_t tsdbCommitDataParallel(SCommitter *pCommitter) {
+  int32_t     code = 0;
+  int32_t     lino = 0;
+  STsdb      *pTsdb = pCommitter->pTsdb;
+  SMemTable  *pMemTable = pTsdb->imem;
+  SArray     *aFid = NULL;
+  SCommitJob *pJob = NULL;
+  int32_t     nTask = 0;
+
+  // filesets with data in memory, each committed as a whole by one worker
+  aFid = taosArrayInit(0, sizeof(int32_t));
+  if (aFid == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  TSKEY nextKey = pMemTable->minKey;
+  while (nextKey < TSKEY_MAX) {
+    TSKEY   minKey, maxKey;
+    int32_t fid = tsdbKeyFid(nextKey, pCommitter->minutes, pCommitter->precision);
+    if (taosArrayPush(aFid, &fid) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    tsdbFidKeyRange(fid, pCommitter->minutes, pCommitter->precision, &minKey, &maxKey);
+    if (maxKey >= TSKEY_MAX) break;
+
+    TSDBKEY keyFrom = {.ts = maxKey + 1, .version = VERSION_MIN};
+    nextKey = TSKEY_MAX;
+    for (int32_t iTbData = 0; iTbData < taosArrayGetSize(pCommitter->aTbDataP); iTbData++) {
+      STbData    *pTbData = (STbData *)taosArrayGetP(pCommitter->aTbDataP, iTbData);
+      STbDataIter iter;
+      code = tsdbTbDataIterOpen(pTbData, &keyFrom, 0, &iter);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      TSDBROW *pRow = tsdbTbDataIterGet(&iter);
+      if (pRow) nextKey = TMIN(nextKey, TSDBROW_TS(pRow));
+      tsdbTbDataIterClose(&iter);
+    }
+  }
+
+  // the job outlives this commit if a fileset task is still queued when the commit is done
+  pJob = (SCommitJob *)taosMemoryCalloc(1, sizeof(*pJob));
+  if (pJob == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  pJob->pCommitter = pCommitter;
+  pJob->nRef = 1;
+  taosThreadMutexInit(&pJob->mutex, NULL);
+  taosThreadCondInit(&pJob->cond, NULL);
+
+  pJob->nFSet = taosArrayGetSize(aFid);
+  pJob->aFSet = (SCommitFSet *)taosMemoryCalloc(pJob->nFSet, sizeof(SCommitFSet));
+  if (pJob->aFSet == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  for (int32_t iFSet = 0; iFSet < pJob->nFSet; iFSet++) {
+    pJob->aFSet[iFSet].fid = *(int32_t *)taosArrayGet(aFid, iFSet);
+  }
+
+  // commit, the commit task is one of the workers and the others come from the bounded fileset pool
+  for (int32_t iTask = 0; iTask < TMIN(tsTsdbCommitThreads, pJob->nFSet) - 1; iTask++) {
+    atomic_add_fetch_32(&pJob->nRef, 1);
+    if (vnodeScheduleFSetTask(tsdbCommitFSetTask, pJob) < 0) {
+      atomic_sub_fetch_32(&pJob->nRef, 1);
+      break;
+    }
+    nTask++;
+  }
+
+  tsdbCommitFSetWork(pJob);
+
+  // wait for the fileset tasks working on the job, those still queued do not join any more
+  taosThreadMutexLock(&pJob->mutex);
+  pJob->closed = 1;
+  while (pJob->nWorker > 0) {
+    taosThreadCondWait(&pJob->cond, &pJob->mutex);
+  }
+  taosThreadMutexUnlock(&pJob->mutex);
+
+  code = pJob->code;
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // merge the filesets into fs, which is made visible by tsdbFinishCommit
+  for (int32_t iFSet = 0; iFSet < pJob->nFSet; iFSet++) {
+    code = tsdbFSUpsertFSet(&pCommitter->fs, &pJob->aFSet[iFSet].wSet);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  } else {
+    tsdbDebug("vgId:%d, %s done, nFSet:%d nTask:%d", TD_VID(pTsdb->pVnode), __func__, pJob->nFSet, nTask);
+  }
+  if (pJob) tsdbCommitJobUnref(pJob);
+  taosArrayDestroy(aFid);
+  return code;
 }
 
 static int32_t tsdbCommitData(SCommitter *pCommitter) {
@@ -946,6 +1178,12 @@ static int32_t tsdbCommitData(SCommitter *pCommitter) {
   // check
   if (pMemTable->nRow == 0) goto _exit;
 
+  if (tsTsdbCommitThreads > 1) {
+    code = tsdbCommitDataParallel(pCommitter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    goto _exit;
+  }
+
   // start ====================
   code = tsdbCommitDataStart(pCommitter);
   TSDB_CHECK_CODE(code, lino, _exit);
@@ -1112,7 +1350,8 @@ static int32_t tsdbNextCommitRow(SCommitter *pCommitter) {
         if (pIter->iTbDataP < taosArrayGetSize(pCommitter->aTbDataP)) {
           STbData *pTbData = (STbData *)taosArrayGetP(pCommitter->aTbDataP, pIter->iTbDataP);
           TSDBKEY  keyFrom = {.ts = pCommitter->minKey, .version = VERSION_MIN};
-          tsdbTbDataIterOpen(pTbData, &keyFrom, 0, &pIter->iter);
+          code = tsdbTbDataIterOpen(pTbData, &keyFrom, 0, &pIter->iter);
+          TSDB_CHECK_CODE(code, lino, _exit);
           pRow = tsdbTbDataIterGet(&pIter->iter);
           continue;
         } else {
@@ -15,13 +15,764 @@
 
 #include "tsdb.h"
 
+extern int32_t tsdbUpdateTableSchema(SMeta *pMeta, int64_t suid, int64_t uid, SSkmInfo *pSkmInfo);
+extern int32_t tsdbWriteDataBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SMapData *mDataBlk, int8_t cmprAlg);
+extern bool    hasBeenDropped(const SArray *pDelList, int32_t *index, TSDBKEY *pKey, int32_t order,
+                              SVersionRange *pVerRange);
+
+#define TSDB_COMPACT_YIELD_MS 10
+
+/*
+ * Compaction rewrites a file set into one .data file with non-overlapping data blocks of up to maxRows rows and an
+ * empty .stt file. All rows of the .data and .stt files are merged in (suid, uid, ts, version) order, rows of the
+ * same key are merged into one, and rows covered by the tombstones in the .del file or of dropped tables are dropped.
+ *
+ * Compaction runs beside the commits. A file set is merged from a referenced view of the file system, and the result
+ * is applied while no commit runs. Stt files a commit added to the set meanwhile are kept after the compacted ones. If
+ * the commit wrote to the data file instead, the output is dropped and the set is left as the commit wrote it.
+ */
 typedef struct {
   STsdb  *pTsdb;
-  STsdbFS fs;
+  int64_t commitID;
+  int8_t  force;
+  int32_t maxRow;
+  int8_t  cmprAlg;
+  STsdbFS fs;  // referenced view of the file sets while one of them is compacted
+
+  // tombstone
+  SDelFReader *pDelFReader;
+  SArray      *aDelIdx;   // SArray<SDelIdx>
+  SArray      *aDelData;  // SArray<SDelData>
+  SArray      *aSkyline;  // SArray<TSDBKEY>
+  int32_t      iSkyline;
+
+  // reader
+  SDataFReader   *pReader;
+  SDataFile       fDataR;  // data and sma files read, a commit appending to them updates those of the view in place
+  SSmaFile        fSmaR;
+  STsdbDataIter2 *iterList;
+  STsdbDataIter2 *pIter;
+  SRBTree         rbt;
+
+  // writer
+  SDataFWriter *pWriter;
+  SHeadFile     fHead;  // files written for the set, kept until they are applied
+  SDataFile     fData;
+  SSmaFile      fSma;
+  SSttFile      fStt;
+  SArray       *aBlockIdx;  // SArray<SBlockIdx>
+  SArray       *aSttBlk;    // SArray<SSttBlk>
+  SMapData      mDataBlk;   // SMapData<SDataBlk>
+  SBlockData    bData;
+  SBlockData    bDataM;  // merged block data of bData
+  int8_t        hasDup;
+  TABLEID       tbid;
+  int8_t        tbDropped;
+  SSkmInfo      skmTable;
+
+  // throttle
+  int64_t startMs;
+  int64_t nWrite;
+
+  // statis
+  int64_t nRowRead;
+  int64_t nRowDrop;
 } STsdbCompactor;
 
-int32_t tsdbCompact(STsdb *pTsdb) {
+static bool tsdbShouldCompactFSet(SDFileSet *pSet) {
+  if (tsTsdbCompactSttTrigger > 0 && pSet->nSttF >= tsTsdbCompactSttTrigger) return true;
+
+  if (tsTsdbCompactOverlapRatio > 0) {
+    int64_t szStt = 0;
+    for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+      szStt += pSet->aSttF[iStt]->size;
+    }
+    if (szStt * 100 >= (szStt + pSet->pDataF->size) * tsTsdbCompactOverlapRatio) return true;
+  }
+
+  return false;
+}
+
+bool tsdbShouldCompact(STsdb *pTsdb) {
+  bool should = false;
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet); iSet++) {
+    if (tsdbShouldCompactFSet((SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet))) {
+      should = true;
+      break;
+    }
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+
+  return should;
+}
+
+int32_t tsdbGetCompactProgress(STsdb *pTsdb) {
+  int32_t nFSet = atomic_load_32(&pTsdb->nCompactFSet);
+  if (nFSet == 0) return -1;
+
+  return atomic_load_32(&pTsdb->iCompactFSet) * 100 / nFSet;
+}
+
+static bool tsdbCompactStopped(STsdb *pTsdb) { return atomic_load_8(&pTsdb->pVnode->compactStop) != 0; }
+
+static void tsdbCompactThrottle(STsdbCompactor *pCompactor, int64_t nWrite) {
+  STsdb *pTsdb = pCompactor->pTsdb;
+
+  // a running commit goes first
+  while (atomic_load_ptr(&pTsdb->imem) != NULL && !tsdbCompactStopped(pTsdb)) {
+    taosMsleep(TSDB_COMPACT_YIELD_MS);
+  }
+
+  if (tsTsdbCompactIoBudget <= 0) return;
+
+  pCompactor->nWrite += nWrite;
+
+  int64_t expectMs = pCompactor->nWrite * 1000 / ((int64_t)tsTsdbCompactIoBudget * 1024 * 1024);
+  int64_t elapseMs = taosGetTimestampMs() - pCompactor->startMs;
+  if (expectMs > elapseMs) {
+    taosMsleep((int32_t)(expectMs - elapseMs));
+  }
+}
+
+static int32_t tsdbCompactLoadTomb(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  taosArrayClear(pCompactor->aSkyline);
+  pCompactor->iSkyline = 0;
+
+  if (pCompactor->pDelFReader == NULL) goto _exit;
+
+  SDelIdx *pDelIdx = (SDelIdx *)taosArraySearch(pCompactor->aDelIdx, &pCompactor->tbid, tCmprDelIdx, TD_EQ);
+  if (pDelIdx == NULL) goto _exit;
+
+  code = tsdbReadDelData(pCompactor->pDelFReader, pDelIdx, pCompactor->aDelData);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  int32_t nDelData = taosArrayGetSize(pCompactor->aDelData);
+  if (nDelData > 0) {
+    code = tsdbBuildDeleteSkyline(pCompactor->aDelData, 0, nDelData - 1, pCompactor->aSkyline);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static bool tsdbCompactRowIsDropped(STsdbCompactor *pCompactor, TSDBROW *pRow) {
+  if (taosArrayGetSize(pCompactor->aSkyline) == 0) return false;
+
+  TSDBKEY key = TSDBROW_KEY(pRow);
+  return hasBeenDropped(pCompactor->aSkyline, &pCompactor->iSkyline, &key, TSDB_ORDER_ASC,
+                        &(SVersionRange){.minVer = VERSION_MIN, .maxVer = VERSION_MAX});
+}
+
+// merge the rows of the same timestamp in bData into bDataM, and swap bDataM with bData
+static int32_t tsdbCompactMergeDupRows(STsdbCompactor *pCompactor) {
+  int32_t     code = 0;
+  int32_t     lino = 0;
+  SBlockData *pBData = &pCompactor->bData;
+  STSchema   *pTSchema = pCompactor->skmTable.pTSchema;
+  SRowMerger  merger = {0};
+  STSRow     *pTSRow = NULL;
+
+  code = tBlockDataInit(&pCompactor->bDataM, &pCompactor->tbid, pTSchema, NULL, 0);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  for (int32_t iRow = 0; iRow < pBData->nRow;) {
+    TSDBROW row = tsdbRowFromBlockData(pBData, iRow);
+
+    int32_t jRow = iRow + 1;
+    while (jRow < pBData->nRow && pBData->aTSKEY[jRow] == pBData->aTSKEY[iRow]) jRow++;
+
+    if (jRow - iRow == 1) {
+      code = tBlockDataAppendRow(&pCompactor->bDataM, &row, NULL, pCompactor->tbid.uid);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    } else {
+      code = tRowMergerInit(&merger, &row, pTSchema);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      for (int32_t kRow = iRow + 1; kRow < jRow; kRow++) {
+        row = tsdbRowFromBlockData(pBData, kRow);
+        code = tRowMergerAdd(&merger, &row, pTSchema);
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+
+      code = tRowMergerGetRow(&merger, &pTSRow);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      row = tsdbRowFromTSRow(merger.version, pTSRow);
+      code = tBlockDataAppendRow(&pCompactor->bDataM, &row, pTSchema, pCompactor->tbid.uid);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      tRowMergerClear(&merger);
+      merger.pArray = NULL;
+      taosMemoryFreeClear(pTSRow);
+    }
+
+    iRow = jRow;
+  }
+
+  SBlockData bData = *pBData;
+  *pBData = pCompactor->bDataM;
+  pCompactor->bDataM = bData;
+  tBlockDataClear(&pCompactor->bDataM);
+  pCompactor->hasDup = 0;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+    if (merger.pArray) tRowMergerClear(&merger);
+    taosMemoryFree(pTSRow);
+  }
+  return code;
+}
+
+static int32_t tsdbCompactWriteBlock(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pCompactor->bData.nRow == 0) goto _exit;
+
+  if (pCompactor->hasDup) {
+    code = tsdbCompactMergeDupRows(pCompactor);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  int64_t size = pCompactor->pWriter->fData.size + pCompactor->pWriter->fSma.size;
+
+  code = tsdbWriteDataBlock(pCompactor->pWriter, &pCompactor->bData, &pCompactor->mDataBlk, pCompactor->cmprAlg);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tsdbCompactThrottle(pCompactor, pCompactor->pWriter->fData.size + pCompactor->pWriter->fSma.size - size);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactTableEnd(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pCompactor->tbid.uid == 0) goto _exit;
+
+  code = tsdbCompactWriteBlock(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pCompactor->mDataBlk.nItem > 0) {
+    SBlockIdx blockIdx = {.suid = pCompactor->tbid.suid, .uid = pCompactor->tbid.uid};
+
+    code = tsdbWriteDataBlk(pCompactor->pWriter, &pCompactor->mDataBlk, &blockIdx);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (taosArrayPush(pCompactor->aBlockIdx, &blockIdx) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+  }
+
+  pCompactor->tbid = (TABLEID){0};
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactTableStart(STsdbCompactor *pCompactor, SRowInfo *pRowInfo) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  pCompactor->tbid = (TABLEID){.suid = pRowInfo->suid, .uid = pRowInfo->uid};
+  pCompactor->hasDup = 0;
+  tMapDataReset(&pCompactor->mDataBlk);
+
+  SMetaInfo info;
+  if (metaGetInfo(pCompactor->pTsdb->pVnode->pMeta, pRowInfo->uid, &info, NULL) || info.suid != pRowInfo->suid) {
+    // the table is dropped, so none of its rows is written
+    pCompactor->tbDropped = 1;
+    tBlockDataReset(&pCompactor->bData);
+    goto _exit;
+  }
+  pCompactor->tbDropped = 0;
+
+  code = tsdbUpdateTableSchema(pCompactor->pTsdb->pVnode->pMeta, pRowInfo->suid, pRowInfo->uid,
+                               &pCompactor->skmTable);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tBlockDataInit(&pCompactor->bData, &pCompactor->tbid, pCompactor->skmTable.pTSchema, NULL, 0);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactLoadTomb(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactNextRow(STsdbCompactor *pCompactor, SRowInfo **ppRowInfo) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pCompactor->pIter) {
+    code = tsdbDataIterNext2(pCompactor->pIter, NULL);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    if (pCompactor->pIter->rowInfo.suid == 0 && pCompactor->pIter->rowInfo.uid == 0) {
+      pCompactor->pIter = NULL;
+    } else {
+      SRBTreeNode *pNode = tRBTreeMin(&pCompactor->rbt);
+      if (pNode && tsdbDataIterCmprFn(&pCompactor->pIter->rbtn, pNode) > 0) {
+        tRBTreePut(&pCompactor->rbt, &pCompactor->pIter->rbtn);
+        pCompactor->pIter = NULL;
+      }
+    }
+  }
+
+  if (pCompactor->pIter == NULL) {
+    SRBTreeNode *pNode = tRBTreeMin(&pCompactor->rbt);
+    if (pNode) {
+      tRBTreeDrop(&pCompactor->rbt, pNode);
+      pCompactor->pIter = TSDB_RBTN_TO_DATA_ITER(pNode);
+    }
+  }
+
+  *ppRowInfo = pCompactor->pIter ? &pCompactor->pIter->rowInfo : NULL;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbCompactAddIter(STsdbCompactor *pCompactor, STsdbDataIter2 *pIter) {
+  int32_t code = 0;
+
+  if (pIter == NULL) return code;
+
+  pIter->next = pCompactor->iterList;
+  pCompactor->iterList = pIter;
+
+  code = tsdbDataIterNext2(pIter, NULL);
+  if (code) return code;
+
+  if (pIter->rowInfo.suid || pIter->rowInfo.uid) {
+    tRBTreePut(&pCompactor->rbt, &pIter->rbtn);
+  }
+
+  return code;
+}
+
+static int32_t tsdbCompactFileSetStart(STsdbCompactor *pCompactor, SDFileSet *pSet) {
+  int32_t         code = 0;
+  int32_t         lino = 0;
+  STsdb          *pTsdb = pCompactor->pTsdb;
+  STsdbDataIter2 *pIter = NULL;
+
+  // tombstone
+  taosArrayClear(pCompactor->aDelIdx);
+  if (pCompactor->fs.pDelFile) {
+    code = tsdbDelFReaderOpen(&pCompactor->pDelFReader, pCompactor->fs.pDelFile, pTsdb);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbReadDelIdx(pCompactor->pDelFReader, pCompactor->aDelIdx);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // reader
+  code = tsdbDataFReaderOpen(&pCompactor->pReader, pTsdb, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pCompactor->iterList = NULL;
+  pCompactor->pIter = NULL;
+  tRBTreeCreate(&pCompactor->rbt, tsdbDataIterCmprFn);
+
+  code = tsdbOpenDataFileDataIter(pCompactor->pReader, &pIter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactAddIter(pCompactor, pIter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    code = tsdbOpenSttFileDataIter(pCompactor->pReader, iStt, &pIter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbCompactAddIter(pCompactor, pIter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // writer
+  SHeadFile fHead = {.commitID = pCompactor->commitID};
+  SDataFile fData = {.commitID = pCompactor->commitID};
+  SSmaFile  fSma = {.commitID = pCompactor->commitID};
+  SSttFile  fStt = {.commitID = pCompactor->commitID};
+  SDFileSet wSet = {.diskId = pSet->diskId,
+                    .fid = pSet->fid,
+                    .pHeadF = &fHead,
+                    .pDataF = &fData,
+                    .pSmaF = &fSma,
+                    .nSttF = 1,
+                    .aSttF = {&fStt}};
+
+  code = tsdbDataFWriterOpen(&pCompactor->pWriter, pTsdb, &wSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  taosArrayClear(pCompactor->aBlockIdx);
+  taosArrayClear(pCompactor->aSttBlk);
+  tMapDataReset(&pCompactor->mDataBlk);
+  tBlockDataReset(&pCompactor->bData);
+  pCompactor->tbid = (TABLEID){0};
+  pCompactor->nRowRead = 0;
+  pCompactor->nRowDrop = 0;
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+static void tsdbCompactFileSetClose(STsdbCompactor *pCompactor) {
+  while (pCompactor->iterList) {
+    STsdbDataIter2 *pIter = pCompactor->iterList;
+    pCompactor->iterList = pIter->next;
+    tsdbCloseDataIter2(pIter);
+  }
+  pCompactor->pIter = NULL;
+
+  tsdbDataFReaderClose(&pCompactor->pReader);
+  tsdbDataFWriterClose(&pCompactor->pWriter, 0);
+  tsdbDelFReaderClose(&pCompactor->pDelFReader);
+}
+
+static int32_t tsdbCompactFileSetEnd(STsdbCompactor *pCompactor) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  code = tsdbWriteBlockIdx(pCompactor->pWriter, pCompactor->aBlockIdx);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbWriteSttBlk(pCompactor->pWriter, pCompactor->aSttBlk);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbUpdateDFileSetHeader(pCompactor->pWriter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pCompactor->fHead = pCompactor->pWriter->fHead;
+  pCompactor->fData = pCompactor->pWriter->fData;
+  pCompactor->fSma = pCompactor->pWriter->fSma;
+  pCompactor->fStt = pCompactor->pWriter->fStt[0];
+
+  code = tsdbDataFWriterClose(&pCompactor->pWriter, 1);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pCompactor->pTsdb->pVnode), __func__, lino,
+              tstrerror(code));
+  }
+  tsdbCompactFileSetClose(pCompactor);
+  return code;
+}
+
+static bool tsdbCompactFileSetUnchanged(STsdbCompactor *pCompactor, SDFileSet *pSet, SDFileSet *pSetNow) {
+  if (pSetNow == NULL || pSetNow->diskId.level != pSet->diskId.level || pSetNow->diskId.id != pSet->diskId.id) {
+    return false;
+  }
+
+  if (pSetNow->pDataF->commitID != pCompactor->fDataR.commitID || pSetNow->pDataF->size != pCompactor->fDataR.size ||
+      pSetNow->pSmaF->commitID != pCompactor->fSmaR.commitID || pSetNow->pSmaF->size != pCompactor->fSmaR.size) {
+    return false;
+  }
+
+  if (pSetNow->nSttF < pSet->nSttF) return false;
+  for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+    if (pSetNow->aSttF[iStt]->commitID != pSet->aSttF[iStt]->commitID) return false;
+  }
+
+  return true;
+}
+
+static void tsdbCompactRemoveFiles(STsdbCompactor *pCompactor, SDFileSet *pSet) {
+  STsdb *pTsdb = pCompactor->pTsdb;
+  char   fname[TSDB_FILENAME_LEN] = {0};
+
+  tsdbHeadFileName(pTsdb, pSet->diskId, pSet->fid, &pCompactor->fHead, fname);
+  (void)taosRemoveFile(fname);
+  tsdbDataFileName(pTsdb, pSet->diskId, pSet->fid, &pCompactor->fData, fname);
+  (void)taosRemoveFile(fname);
+  tsdbSmaFileName(pTsdb, pSet->diskId, pSet->fid, &pCompactor->fSma, fname);
+  (void)taosRemoveFile(fname);
+  tsdbSttFileName(pTsdb, pSet->diskId, pSet->fid, &pCompactor->fStt, fname);
+  (void)taosRemoveFile(fname);
+}
+
+// apply the files written for a set, commits are held off meanwhile
+static int32_t tsdbCompactApplyFileSet(STsdbCompactor *pCompactor, SDFileSet *pSet) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  STsdb  *pTsdb = pCompactor->pTsdb;
+  STsdbFS fs = {0};
+  bool    applied = false;
+
+  tsem_wait(&pTsdb->pVnode->canCommit);
+
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSCopy(pTsdb, &fs);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  SDFileSet *pSetNow = (SDFileSet *)taosArraySearch(fs.aDFileSet, pSet, tDFileSetCmprFn, TD_EQ);
+  if (!tsdbCompactFileSetUnchanged(pCompactor, pSet, pSetNow)) {
+    tsdbInfo("vgId:%d, fid:%d is written by a commit during compaction, compacted files dropped",
+             TD_VID(pTsdb->pVnode), pSet->fid);
+    goto _exit;
+  }
+
+  SDFileSet wSet = {.diskId = pSet->diskId,
+                    .fid = pSet->fid,
+                    .pHeadF = &pCompactor->fHead,
+                    .pDataF = &pCompactor->fData,
+                    .pSmaF = &pCompactor->fSma,
+                    .nSttF = 1,
+                    .aSttF = {&pCompactor->fStt}};
+  for (int32_t iStt = pSet->nSttF; iStt < pSetNow->nSttF; iStt++) {
+    wSet.aSttF[wSet.nSttF++] = pSetNow->aSttF[iStt];
+  }
+
+  code = tsdbFSUpsertFSet(&fs, &wSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbFSPrepareCommit(pTsdb, &fs);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  applied = true;
+
+  taosThreadRwlockWrlock(&pTsdb->rwLock);
+  code = tsdbFSCommit(pTsdb);
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  tsdbInfo("vgId:%d, fid:%d compacted, rows read:%" PRId64 " dropped:%" PRId64, TD_VID(pTsdb->pVnode), pSet->fid,
+           pCompactor->nRowRead, pCompactor->nRowDrop);
+
+_exit:
+  tsem_post(&pTsdb->pVnode->canCommit);
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino,
+              tstrerror(code), pSet->fid);
+  }
+  if (!applied) {
+    tsdbCompactRemoveFiles(pCompactor, pSet);
+  }
+  tsdbFSDestroy(&fs);
+  return code;
+}
+
+static int32_t tsdbCompactFileSet(STsdbCompactor *pCompactor, int32_t fid) {
+  int32_t    code = 0;
+  int32_t    lino = 0;
+  STsdb     *pTsdb = pCompactor->pTsdb;
+  SDFileSet *pSet = NULL;
+  SRowInfo  *pRowInfo = NULL;
+
+  // the view keeps the files being merged from being removed by a commit
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  code = tsdbFSRef(pTsdb, &pCompactor->fs);
+  if (code == 0) {
+    pSet = (SDFileSet *)taosArraySearch(pCompactor->fs.aDFileSet, &(SDFileSet){.fid = fid}, tDFileSetCmprFn, TD_EQ);
+    if (pSet) {
+      pCompactor->fDataR = *pSet->pDataF;
+      pCompactor->fSmaR = *pSet->pSmaF;
+    }
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // the set may be removed by retention, or merged by a commit since it was picked
+  if (pSet == NULL || (!pCompactor->force && !tsdbShouldCompactFSet(pSet))) goto _exit;
+
+  code = tsdbCompactFileSetStart(pCompactor, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactNextRow(pCompactor, &pRowInfo);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  while (pRowInfo) {
+    pCompactor->nRowRead++;
+
+    if (pRowInfo->uid != pCompactor->tbid.uid) {
+      code = tsdbCompactTableEnd(pCompactor);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      code = tsdbCompactTableStart(pCompactor, pRowInfo);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    if (pCompactor->tbDropped || tsdbCompactRowIsDropped(pCompactor, &pRowInfo->row)) {
+      pCompactor->nRowDrop++;
+    } else {
+      SBlockData *pBData = &pCompactor->bData;
+      TSKEY       ts = TSDBROW_TS(&pRowInfo->row);
+      bool        dup = (pBData->nRow > 0 && pBData->aTSKEY[pBData->nRow - 1] == ts);
+
+      // rows of the same timestamp are kept in one block so they can be merged
+      if (pBData->nRow >= pCompactor->maxRow && !dup) {
+        code = tsdbCompactWriteBlock(pCompactor);
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+
+      code = tBlockDataAppendRow(pBData, &pRowInfo->row, NULL, pRowInfo->uid);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      if (dup) pCompactor->hasDup = 1;
+    }
+
+    code = tsdbCompactNextRow(pCompactor, &pRowInfo);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tsdbCompactTableEnd(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactFileSetEnd(pCompactor);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompactApplyFileSet(pCompactor, pSet);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d", TD_VID(pTsdb->pVnode), __func__, lino,
+              tstrerror(code), fid);
+    tsdbCompactFileSetClose(pCompactor);
+  }
+  if (pCompactor->fs.aDFileSet) {
+    tsdbFSUnref(pTsdb, &pCompactor->fs);
+    pCompactor->fs = (STsdbFS){0};
+  }
+  return code;
+}
+
+static int32_t tsdbCompactStart(STsdbCompactor *pCompactor, STsdb *pTsdb, int64_t commitID, int8_t force) {
   int32_t code = 0;
-  // TODO
+  int32_t lino = 0;
+
+  pCompactor->pTsdb = pTsdb;
+  pCompactor->commitID = commitID;
+  pCompactor->force = force;
+  pCompactor->maxRow = pTsdb->pVnode->config.tsdbCfg.maxRows;
+  pCompactor->cmprAlg = pTsdb->pVnode->config.tsdbCfg.compression;
+  pCompactor->startMs = taosGetTimestampMs();
+
+  if ((pCompactor->aDelIdx = taosArrayInit(0, sizeof(SDelIdx))) == NULL ||
+      (pCompactor->aDelData = taosArrayInit(0, sizeof(SDelData))) == NULL ||
+      (pCompactor->aSkyline = taosArrayInit(0, sizeof(TSDBKEY))) == NULL ||
+      (pCompactor->aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx))) == NULL ||
+      (pCompactor->aSttBlk = taosArrayInit(0, sizeof(SSttBlk))) == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  code = tBlockDataCreate(&pCompactor->bData);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tBlockDataCreate(&pCompactor->bDataM);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+static void tsdbCompactEnd(STsdbCompactor *pCompactor) {
+  taosArrayDestroy(pCompactor->aDelIdx);
+  taosArrayDestroy(pCompactor->aDelData);
+  taosArrayDestroy(pCompactor->aSkyline);
+  taosArrayDestroy(pCompactor->aBlockIdx);
+  taosArrayDestroy(pCompactor->aSttBlk);
+  tMapDataClear(&pCompactor->mDataBlk);
+  tBlockDataDestroy(&pCompactor->bData, 1);
+  tBlockDataDestroy(&pCompactor->bDataM, 1);
+  tDestroyTSchema(pCompactor->skmTable.pTSchema);
+}
+
+int32_t tsdbCompact(STsdb *pTsdb, int64_t commitID, int8_t force) {
+  int32_t        code = 0;
+  int32_t        lino = 0;
+  STsdbCompactor compactor = {0};
+  SArray        *aFid = NULL;
+
+  code = tsdbCompactStart(&compactor, pTsdb, commitID, force);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  // pick the file sets to compact
+  aFid = taosArrayInit(0, sizeof(int32_t));
+  if (aFid == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  int64_t now = taosGetTimestampSec();
+  taosThreadRwlockRdlock(&pTsdb->rwLock);
+  for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet); iSet++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet);
+
+    if (tsdbFidLevel(pSet->fid, &pTsdb->keepCfg, now) < 0) continue;
+    if (!force && !tsdbShouldCompactFSet(pSet)) continue;
+
+    if (taosArrayPush(aFid, &pSet->fid) == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      break;
+    }
+  }
+  taosThreadRwlockUnlock(&pTsdb->rwLock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (taosArrayGetSize(aFid) == 0) goto _exit;
+
+  tsdbInfo("vgId:%d, tsdb start compact, commit id:%" PRId64 " force:%d file sets:%d", TD_VID(pTsdb->pVnode),
+           commitID, force, (int32_t)taosArrayGetSize(aFid));
+
+  atomic_store_32(&pTsdb->iCompactFSet, 0);
+  atomic_store_32(&pTsdb->nCompactFSet, (int32_t)taosArrayGetSize(aFid));
+
+  // each set is applied on its own, so a stopped compaction keeps the sets done so far
+  for (int32_t iFid = 0; iFid < taosArrayGetSize(aFid) && !tsdbCompactStopped(pTsdb); iFid++) {
+    code = tsdbCompactFileSet(&compactor, *(int32_t *)taosArrayGet(aFid, iFid));
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    atomic_add_fetch_32(&pTsdb->iCompactFSet, 1);
+  }
+
+_exit:
+  atomic_store_32(&pTsdb->nCompactFSet, 0);
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  } else if (taosArrayGetSize(aFid) > 0) {
+    tsdbInfo("vgId:%d, tsdb compact done, elapsed:%" PRId64 "ms", TD_VID(pTsdb->pVnode),
+             taosGetTimestampMs() - compactor.startMs);
+  }
+  taosArrayDestroy(aFid);
+  tsdbCompactEnd(&compactor);
   return code;
 }
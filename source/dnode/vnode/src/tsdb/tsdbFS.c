@@ -506,61 +506,46 @@ static int32_t tsdbMergeFileSet(STsdb *pTsdb, SDFileSet *pSetOld, SDFileSet *pSe
 
   // stt
   if (sameDisk) {
-    if (pSetNew->nSttF > pSetOld->nSttF) {
-      ASSERT(pSetNew->nSttF == pSetOld->nSttF + 1);
-      pSetOld->aSttF[pSetOld->nSttF] = (SSttFile *)taosMemoryMalloc(sizeof(SSttFile));
-      if (pSetOld->aSttF[pSetOld->nSttF] == NULL) {
+    // the stt files are matched by commit ID: a commit appends one or merges them all into one, and a compaction
+    // replaces those it merged while keeping the ones committed meanwhile
+    SSttFile *aSttF[TSDB_MAX_STT_TRIGGER] = {0};
+    for (int32_t iNew = 0; iNew < pSetNew->nSttF; iNew++) {
+      int32_t iOld = 0;
+      while (iOld < pSetOld->nSttF && pSetOld->aSttF[iOld]->commitID != pSetNew->aSttF[iNew]->commitID) iOld++;
+      if (iOld < pSetOld->nSttF) continue;
+
+      aSttF[iNew] = (SSttFile *)taosMemoryMalloc(sizeof(SSttFile));
+      if (aSttF[iNew] == NULL) {
+        for (int32_t i = 0; i < iNew; i++) taosMemoryFree(aSttF[i]);
         code = TSDB_CODE_OUT_OF_MEMORY;
         TSDB_CHECK_CODE(code, lino, _exit);
       }
-      *pSetOld->aSttF[pSetOld->nSttF] = *pSetNew->aSttF[pSetOld->nSttF];
-      pSetOld->aSttF[pSetOld->nSttF]->nRef = 1;
-      pSetOld->nSttF++;
-    } else if (pSetNew->nSttF < pSetOld->nSttF) {
-      ASSERT(pSetNew->nSttF == 1);
-      for (int32_t iStt = 0; iStt < pSetOld->nSttF; iStt++) {
-        SSttFile *pSttFile = pSetOld->aSttF[iStt];
-        nRef = atomic_sub_fetch_32(&pSttFile->nRef, 1);
-        if (nRef == 0) {
-          tsdbSttFileName(pTsdb, pSetOld->diskId, pSetOld->fid, pSttFile, fname);
-          (void)taosRemoveFile(fname);
-          taosMemoryFree(pSttFile);
-        }
-        pSetOld->aSttF[iStt] = NULL;
-      }
+      *aSttF[iNew] = *pSetNew->aSttF[iNew];
+      aSttF[iNew]->nRef = 1;
+    }
 
-      pSetOld->nSttF = 1;
-      pSetOld->aSttF[0] = (SSttFile *)taosMemoryMalloc(sizeof(SSttFile));
-      if (pSetOld->aSttF[0] == NULL) {
-        code = TSDB_CODE_OUT_OF_MEMORY;
-        TSDB_CHECK_CODE(code, lino, _exit);
+    for (int32_t iOld = 0; iOld < pSetOld->nSttF; iOld++) {
+      SSttFile *pSttFile = pSetOld->aSttF[iOld];
+
+      int32_t iNew = 0;
+      while (iNew < pSetNew->nSttF && pSetNew->aSttF[iNew]->commitID != pSttFile->commitID) iNew++;
+      if (iNew < pSetNew->nSttF) {
+        aSttF[iNew] = pSttFile;
+        continue;
       }
-      *pSetOld->aSttF[0] = *pSetNew->aSttF[0];
-      pSetOld->aSttF[0]->nRef = 1;
-    } else {
-      for (int32_t iStt = 0; iStt < pSetOld->nSttF; iStt++) {
-        if (pSetOld->aSttF[iStt]->commitID != pSetNew->aSttF[iStt]->commitID) {
-          SSttFile *pSttFile = pSetOld->aSttF[iStt];
-          nRef = atomic_sub_fetch_32(&pSttFile->nRef, 1);
-          if (nRef == 0) {
-            tsdbSttFileName(pTsdb, pSetOld->diskId, pSetOld->fid, pSttFile, fname);
-            (void)taosRemoveFile(fname);
-            taosMemoryFree(pSttFile);
-          }
-
-          pSetOld->aSttF[iStt] = (SSttFile *)taosMemoryMalloc(sizeof(SSttFile));
-          if (pSetOld->aSttF[iStt] == NULL) {
-            code = TSDB_CODE_OUT_OF_MEMORY;
-            TSDB_CHECK_CODE(code, lino, _exit);
-          }
-          *pSetOld->aSttF[iStt] = *pSetNew->aSttF[iStt];
-          pSetOld->aSttF[iStt]->nRef = 1;
-        } else {
-          ASSERT(pSetOld->aSttF[iStt]->size == pSetOld->aSttF[iStt]->size);
-          ASSERT(pSetOld->aSttF[iStt]->offset == pSetOld->aSttF[iStt]->offset);
-        }
+
+      nRef = atomic_sub_fetch_32(&pSttFile->nRef, 1);
+      if (nRef == 0) {
+        tsdbSttFileName(pTsdb, pSetOld->diskId, pSetOld->fid, pSttFile, fname);
+        (void)taosRemoveFile(fname);
+        taosMemoryFree(pSttFile);
       }
     }
+
+    for (int32_t iStt = 0; iStt < TSDB_MAX_STT_TRIGGER; iStt++) {
+      pSetOld->aSttF[iStt] = aSttF[iStt];
+    }
+    pSetOld->nSttF = pSetNew->nSttF;
   } else {
     for (int32_t iStt = 0; iStt < pSetOld->nSttF; iStt++) {
       SSttFile *pSttFile = pSetOld->aSttF[iStt];
@@ -932,29 +917,21 @@ int32_t tsdbFSUpsertFSet(STsdbFS *pFS, SDFileSet *pSet) {
       *pDFileSet->pHeadF = *pSet->pHeadF;
       *pDFileSet->pDataF = *pSet->pDataF;
       *pDFileSet->pSmaF = *pSet->pSmaF;
-      // stt
-      if (pSet->nSttF > pDFileSet->nSttF) {
-        ASSERT(pSet->nSttF == pDFileSet->nSttF + 1);
-
+      // stt, a commit appends one or merges them all into one, a compaction replaces those it merged
+      while (pDFileSet->nSttF > pSet->nSttF) {
+        pDFileSet->nSttF--;
+        taosMemoryFreeClear(pDFileSet->aSttF[pDFileSet->nSttF]);
+      }
+      while (pDFileSet->nSttF < pSet->nSttF) {
         pDFileSet->aSttF[pDFileSet->nSttF] = (SSttFile *)taosMemoryMalloc(sizeof(SSttFile));
         if (pDFileSet->aSttF[pDFileSet->nSttF] == NULL) {
           code = TSDB_CODE_OUT_OF_MEMORY;
           goto _exit;
         }
-        *pDFileSet->aSttF[pDFileSet->nSttF] = *pSet->aSttF[pSet->nSttF - 1];
         pDFileSet->nSttF++;
-      } else if (pSet->nSttF < pDFileSet->nSttF) {
-        ASSERT(pSet->nSttF == 1);
-        for (int32_t iStt = 1; iStt < pDFileSet->nSttF; iStt++) {
-          taosMemoryFree(pDFileSet->aSttF[iStt]);
-        }
-
-        *pDFileSet->aSttF[0] = *pSet->aSttF[0];
-        pDFileSet->nSttF = 1;
-      } else {
-        for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
-          *pDFileSet->aSttF[iStt] = *pSet->aSttF[iStt];
-        }
+      }
+      for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+        *pDFileSet->aSttF[iStt] = *pSet->aSttF[iStt];
       }
 
       pDFileSet->diskId = pSet->diskId;
@@ -30,7 +30,11 @@
 #define SL_MOVE_BACKWARD 0x1
 #define SL_MOVE_FROM_POS 0x2
 
+#define MEM_CHUNK_MAX_SIZE (1024 * 1024)  // bytes of rows a chunk holds at most, bounds the copy of the tail by readers
+
 static void    tbDataMovePosTo(STbData *pTbData, SMemSkipListNode **pos, TSDBKEY *pKey, int32_t flags);
+static void    tbDataDestroyChunks(STbData *pTbData);
+static void    tbDataIterSeekChunk(STbDataIter *pIter, TSDBKEY *pFrom);
 static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t uid, STbData **ppTbData);
 static int32_t tsdbInsertTableDataImpl(SMemTable *pMemTable, STbData *pTbData, int64_t version,
                                        SSubmitMsgIter *pMsgIter, SSubmitBlk *pBlock, SSubmitBlkRsp *pRsp);
@@ -72,6 +76,11 @@ _err:
 
 void tsdbMemTableDestroy(SMemTable *pMemTable) {
   if (pMemTable) {
+    for (int32_t iBucket = 0; iBucket < pMemTable->nBucket; iBucket++) {
+      for (STbData *pTbData = pMemTable->aBucket[iBucket]; pTbData; pTbData = pTbData->next) {
+        tbDataDestroyChunks(pTbData);
+      }
+    }
     vnodeBufPoolUnRef(pMemTable->pPool);
     taosMemoryFree(pMemTable->aBucket);
     taosMemoryFree(pMemTable);
@@ -222,7 +231,11 @@ int32_t tsdbTbDataIterCreate(STbData *pTbData, TSDBKEY *pFrom, int8_t backward,
     goto _exit;
   }
 
-  tsdbTbDataIterOpen(pTbData, pFrom, backward, *ppIter);
+  code = tsdbTbDataIterOpen(pTbData, pFrom, backward, *ppIter);
+  if (code) {
+    taosMemoryFree(*ppIter);
+    *ppIter = NULL;
+  }
 
 _exit:
   return code;
@@ -230,13 +243,53 @@ _exit:
 
 void *tsdbTbDataIterDestroy(STbDataIter *pIter) {
   if (pIter) {
+    tsdbTbDataIterClose(pIter);
     taosMemoryFree(pIter);
   }
 
   return NULL;
 }
 
-void tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDataIter *pIter) {
+void tsdbTbDataIterClose(STbDataIter *pIter) {
+  if (pIter->pTailCopy) {
+    tBlockDataDestroy(&pIter->pTailCopy->bData, 1);
+    taosMemoryFree(pIter->pTailCopy);
+    pIter->pTailCopy = NULL;
+  }
+  pIter->pChunkHead = pIter->pChunkTail = pIter->pChunk = NULL;
+}
+
+// copy the rows appended to the unsealed tail so far, the writer may append to (and reallocate) it at any time
+static SMemChunk *tbDataCopyChunk(STbData *pTbData, SMemChunk *pChunk) {
+  SMemChunk *pCopy = (SMemChunk *)taosMemoryCalloc(1, sizeof(*pCopy));
+  if (pCopy == NULL) return NULL;
+
+  pCopy->sver = pChunk->sver;
+  pCopy->sealed = 1;
+  pCopy->pTSchema = pChunk->pTSchema;  // not owned by the copy
+  pCopy->prev = pChunk->prev;
+
+  if (tBlockDataCreate(&pCopy->bData)) goto _err;
+  if (tBlockDataInit(&pCopy->bData, &(TABLEID){.suid = pTbData->suid, .uid = pTbData->uid}, pChunk->pTSchema, NULL,
+                     0)) {
+    goto _err;
+  }
+  for (int32_t iRow = 0; iRow < pChunk->bData.nRow; iRow++) {
+    TSDBROW row = tsdbRowFromBlockData(&pChunk->bData, iRow);
+    if (tBlockDataAppendRow(&pCopy->bData, &row, NULL, pTbData->uid)) goto _err;
+  }
+  pCopy->size = pChunk->size;
+
+  return pCopy;
+
+_err:
+  tBlockDataDestroy(&pCopy->bData, 1);
+  taosMemoryFree(pCopy);
+  return NULL;
+}
+
+int32_t tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDataIter *pIter) {
+  int32_t           code = 0;
   SMemSkipListNode *pos[SL_MAX_LEVEL];
   SMemSkipListNode *pHead;
   SMemSkipListNode *pTail;
@@ -247,6 +300,7 @@ void tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDa
   pIter->backward = backward;
   pIter->pRow = NULL;
   pIter->row.type = 0;
+  pIter->fromChunk = 0;
   if (pFrom == NULL) {
     // create from head or tail
     if (backward) {
@@ -264,35 +318,235 @@ void tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDa
       pIter->pNode = SL_GET_NODE_FORWARD(pos[0], 0);
     }
   }
+
+  // sealed chunks are immutable and read in place, the rows of the unsealed tail are copied under the latch
+  pIter->pTailCopy = NULL;
+  taosRLockLatch(&pTbData->latch);
+  pIter->pChunkHead = pTbData->pChunkHead;
+  pIter->pChunkTail = pTbData->pChunkTail;
+  if (pIter->pChunkTail && !pIter->pChunkTail->sealed) {
+    if (pIter->pChunkTail->bData.nRow > 0) {
+      pIter->pTailCopy = tbDataCopyChunk(pTbData, pIter->pChunkTail);
+      if (pIter->pTailCopy == NULL) code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+    if (pIter->pChunkHead == pIter->pChunkTail) pIter->pChunkHead = pIter->pTailCopy;
+    pIter->pChunkTail = pIter->pTailCopy ? pIter->pTailCopy : pIter->pChunkTail->prev;
+  }
+  taosRUnLockLatch(&pTbData->latch);
+
+  tbDataIterSeekChunk(pIter, pFrom);
+  return code;
 }
 
-bool tsdbTbDataIterNext(STbDataIter *pIter) {
-  pIter->pRow = NULL;
+// the iterator sees the copy of the unsealed tail in place of the tail itself
+static FORCE_INLINE SMemChunk *tbDataIterChunkNext(STbDataIter *pIter, SMemChunk *pChunk) {
+  if (pChunk == pIter->pChunkTail) return NULL;
+  return (pIter->pTailCopy && pIter->pTailCopy->prev == pChunk) ? pIter->pTailCopy : pChunk->next;
+}
+
+static FORCE_INLINE SMemChunk *tbDataIterChunkPrev(STbDataIter *pIter, SMemChunk *pChunk) {
+  return (pChunk == pIter->pChunkHead) ? NULL : pChunk->prev;
+}
+
+static void tbDataIterNextChunkRow(STbDataIter *pIter) {
+  SMemChunk *pChunk = pIter->pChunk;
+
   if (pIter->backward) {
-    ASSERT(pIter->pNode != pIter->pTbData->sl.pTail);
+    if (--pIter->iChunkRow >= 0) return;
 
-    if (pIter->pNode == pIter->pTbData->sl.pHead) {
-      return false;
-    }
+    do {
+      pChunk = tbDataIterChunkPrev(pIter, pChunk);
+      if (pChunk == NULL) {
+        pIter->pChunk = NULL;
+        return;
+      }
+    } while (pChunk->bData.nRow == 0);
 
-    pIter->pNode = SL_GET_NODE_BACKWARD(pIter->pNode, 0);
-    if (pIter->pNode == pIter->pTbData->sl.pHead) {
-      return false;
-    }
+    pIter->pChunk = pChunk;
+    pIter->iChunkRow = pChunk->bData.nRow - 1;
   } else {
-    ASSERT(pIter->pNode != pIter->pTbData->sl.pHead);
+    if (++pIter->iChunkRow < pChunk->bData.nRow) return;
 
-    if (pIter->pNode == pIter->pTbData->sl.pTail) {
-      return false;
-    }
+    do {
+      pChunk = tbDataIterChunkNext(pIter, pChunk);
+      if (pChunk == NULL) {
+        pIter->pChunk = NULL;
+        return;
+      }
+    } while (pChunk->bData.nRow == 0);
+
+    pIter->pChunk = pChunk;
+    pIter->iChunkRow = 0;
+  }
+}
+
+bool tsdbTbDataIterNext(STbDataIter *pIter) {
+  if (tsdbTbDataIterGet(pIter) == NULL) {
+    return false;
+  }
 
+  if (pIter->fromChunk) {
+    tbDataIterNextChunkRow(pIter);
+  } else if (pIter->backward) {
+    pIter->pNode = SL_GET_NODE_BACKWARD(pIter->pNode, 0);
+  } else {
     pIter->pNode = SL_GET_NODE_FORWARD(pIter->pNode, 0);
-    if (pIter->pNode == pIter->pTbData->sl.pTail) {
-      return false;
+  }
+  pIter->pRow = NULL;
+
+  return tsdbTbDataIterGet(pIter) != NULL;
+}
+
+// SMemChunk ======================================================
+static FORCE_INLINE int32_t tbDataChunkKeyCmpr(SMemChunk *pChunk, int32_t iRow, TSDBKEY *pKey) {
+  TSDBKEY key = {.version = pChunk->bData.aVersion[iRow], .ts = pChunk->bData.aTSKEY[iRow]};
+  return tsdbKeyCmprFn(&key, pKey);
+}
+
+static void tbDataIterSeekChunk(STbDataIter *pIter, TSDBKEY *pFrom) {
+  pIter->pChunk = NULL;
+  pIter->iChunkRow = -1;
+
+  if (pIter->backward) {
+    // the last row with key <= pFrom
+    for (SMemChunk *pChunk = pIter->pChunkTail; pChunk; pChunk = tbDataIterChunkPrev(pIter, pChunk)) {
+      int32_t nRow = pChunk->bData.nRow;
+
+      if (nRow > 0 && (pFrom == NULL || tbDataChunkKeyCmpr(pChunk, 0, pFrom) <= 0)) {
+        int32_t lidx = 0, ridx = nRow - 1;
+        if (pFrom) {
+          while (lidx < ridx) {
+            int32_t midx = (lidx + ridx + 1) >> 1;
+            if (tbDataChunkKeyCmpr(pChunk, midx, pFrom) <= 0) {
+              lidx = midx;
+            } else {
+              ridx = midx - 1;
+            }
+          }
+        }
+        pIter->pChunk = pChunk;
+        pIter->iChunkRow = pFrom ? lidx : nRow - 1;
+        break;
+      }
+    }
+  } else {
+    // the first row with key >= pFrom
+    for (SMemChunk *pChunk = pIter->pChunkHead; pChunk; pChunk = tbDataIterChunkNext(pIter, pChunk)) {
+      int32_t nRow = pChunk->bData.nRow;
+
+      if (nRow > 0 && (pFrom == NULL || tbDataChunkKeyCmpr(pChunk, nRow - 1, pFrom) >= 0)) {
+        int32_t lidx = 0, ridx = nRow - 1;
+        if (pFrom) {
+          while (lidx < ridx) {
+            int32_t midx = (lidx + ridx) >> 1;
+            if (tbDataChunkKeyCmpr(pChunk, midx, pFrom) >= 0) {
+              ridx = midx;
+            } else {
+              lidx = midx + 1;
+            }
+          }
+        }
+        pIter->pChunk = pChunk;
+        pIter->iChunkRow = lidx;
+        break;
+      }
     }
   }
+}
+
+static int32_t tbDataNewChunk(SMemTable *pMemTable, STbData *pTbData, int32_t sver, SMemChunk **ppChunk) {
+  int32_t    code = 0;
+  SMemChunk *pChunk = NULL;
+
+  pChunk = (SMemChunk *)taosMemoryCalloc(1, sizeof(*pChunk));
+  if (pChunk == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  code = tBlockDataCreate(&pChunk->bData);
+  if (code) {
+    taosMemoryFree(pChunk);
+    goto _err;
+  }
+
+  code = metaGetTbTSchemaEx(pMemTable->pTsdb->pVnode->pMeta, pTbData->suid, pTbData->uid, sver, &pChunk->pTSchema);
+  if (code) goto _err;
+
+  code = tBlockDataInit(&pChunk->bData, &(TABLEID){.suid = pTbData->suid, .uid = pTbData->uid}, pChunk->pTSchema,
+                        NULL, 0);
+  if (code) goto _err;
+
+  pChunk->sver = sver;
+
+  // the chunk being replaced is never appended again
+  if (pTbData->pChunkTail) {
+    pTbData->pChunkTail->sealed = 1;
+    pTbData->pChunkTail->next = pChunk;
+    pChunk->prev = pTbData->pChunkTail;
+  } else {
+    pTbData->pChunkHead = pChunk;
+  }
+  pTbData->pChunkTail = pChunk;
+
+  *ppChunk = pChunk;
+  return code;
+
+_err:
+  if (pChunk) {
+    tDestroyTSchema(pChunk->pTSchema);
+    tBlockDataDestroy(&pChunk->bData, 1);
+    taosMemoryFree(pChunk);
+  }
+  *ppChunk = NULL;
+  return code;
+}
+
+static int32_t tbDataAppendChunkRow(SMemTable *pMemTable, STbData *pTbData, int64_t version, STSRow *pRow) {
+  int32_t    code = 0;
+  SMemChunk *pChunk = pTbData->pChunkTail;
+
+  if (pChunk == NULL || pChunk->sealed || pChunk->sver != TD_ROW_SVER(pRow) ||
+      pChunk->bData.nRow >= tsTsdbMemChunkRows || pChunk->size >= MEM_CHUNK_MAX_SIZE) {
+    code = tbDataNewChunk(pMemTable, pTbData, TD_ROW_SVER(pRow), &pChunk);
+    if (code) goto _exit;
+  }
+
+  TSDBROW row = tsdbRowFromTSRow(version, pRow);
+  code = tBlockDataAppendRow(&pChunk->bData, &row, pChunk->pTSchema, pTbData->uid);
+  if (code) goto _exit;
+
+  pChunk->size += pRow->len;
+  pTbData->nChunkRow++;
+
+_exit:
+  return code;
+}
+
+static void tbDataDestroyChunks(STbData *pTbData) {
+  SMemChunk *pChunk = pTbData->pChunkHead;
+
+  while (pChunk) {
+    SMemChunk *pNext = pChunk->next;
+
+    tDestroyTSchema(pChunk->pTSchema);
+    tBlockDataDestroy(&pChunk->bData, 1);
+    taosMemoryFree(pChunk);
+
+    pChunk = pNext;
+  }
+
+  pTbData->pChunkHead = pTbData->pChunkTail = NULL;
+}
 
-  return true;
+void tsdbMemTableSeal(SMemTable *pMemTable) {
+  for (int32_t iBucket = 0; iBucket < pMemTable->nBucket; iBucket++) {
+    for (STbData *pTbData = pMemTable->aBucket[iBucket]; pTbData; pTbData = pTbData->next) {
+      taosWLockLatch(&pTbData->latch);
+      if (pTbData->pChunkTail) pTbData->pChunkTail->sealed = 1;
+      taosWUnLockLatch(&pTbData->latch);
+    }
+  }
 }
 
 static int32_t tsdbMemTableRehash(SMemTable *pMemTable) {
@@ -350,6 +604,11 @@ static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid
   pTbData->maxKey = TSKEY_MIN;
   pTbData->pHead = NULL;
   pTbData->pTail = NULL;
+  taosInitRWLatch(&pTbData->latch);
+  pTbData->nChunkRow = 0;
+  pTbData->lastKey = TSKEY_MIN;
+  pTbData->pChunkHead = NULL;
+  pTbData->pChunkTail = NULL;
   pTbData->sl.seed = taosRand();
   pTbData->sl.size = 0;
   pTbData->sl.maxLevel = maxLevel;
@@ -542,50 +801,63 @@ static int32_t tsdbInsertTableDataImpl(SMemTable *pMemTable, STbData *pTbData, i
   SSubmitBlkIter    blkIter = {0};
   TSDBKEY           key = {.version = version};
   SMemSkipListNode *pos[SL_MAX_LEVEL];
-  TSDBROW           row = tsdbRowFromTSRow(version, NULL);
+  int8_t            posValid = 0;
+  STSRow           *pRow = NULL;
   int32_t           nRow = 0;
+  int64_t           nChunkSize = 0;
   STSRow           *pLastRow = NULL;
+  int8_t            useChunk = (tsTsdbMemChunkRows > 0);
 
   tInitSubmitBlkIter(pMsgIter, pBlock, &blkIter);
 
-  // backward put first data
-  row.pTSRow = tGetSubmitBlkNext(&blkIter);
-  if (row.pTSRow == NULL) return code;
-
-  key.ts = row.pTSRow->ts;
-  nRow++;
-  tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_BACKWARD);
-  code = tbDataDoPut(pMemTable, pTbData, pos, version, row.pTSRow, 0);
-  if (code) {
-    goto _err;
-  }
-
-  pTbData->minKey = TMIN(pTbData->minKey, key.ts);
-
-  pLastRow = row.pTSRow;
-
-  // forward put rest data
-  row.pTSRow = tGetSubmitBlkNext(&blkIter);
-  if (row.pTSRow) {
-    for (int8_t iLevel = pos[0]->level; iLevel < pTbData->sl.maxLevel; iLevel++) {
-      pos[iLevel] = SL_NODE_BACKWARD(pos[iLevel], iLevel);
-    }
-    do {
-      key.ts = row.pTSRow->ts;
-      nRow++;
+  if (useChunk) taosWLockLatch(&pTbData->latch);
+  while ((pRow = tGetSubmitBlkNext(&blkIter)) != NULL) {
+    key.ts = pRow->ts;
+    nRow++;
+
+    if (useChunk && key.ts > pTbData->lastKey) {
+      // in-order row, append to the chunk
+      code = tbDataAppendChunkRow(pMemTable, pTbData, version, pRow);
+      if (code) break;
+      nChunkSize += pRow->len;
+    } else if (posValid) {
+      // forward put rest data
       if (SL_NODE_FORWARD(pos[0], 0) != pTbData->sl.pTail) {
         tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_FROM_POS);
       }
-      code = tbDataDoPut(pMemTable, pTbData, pos, version, row.pTSRow, 1);
-      if (code) {
-        goto _err;
+      code = tbDataDoPut(pMemTable, pTbData, pos, version, pRow, 1);
+      if (code) break;
+    } else {
+      // backward put first data
+      tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_BACKWARD);
+      code = tbDataDoPut(pMemTable, pTbData, pos, version, pRow, 0);
+      if (code) break;
+
+      for (int8_t iLevel = pos[0]->level; iLevel < pTbData->sl.maxLevel; iLevel++) {
+        pos[iLevel] = SL_NODE_BACKWARD(pos[iLevel], iLevel);
       }
+      posValid = 1;
+    }
 
-      pLastRow = row.pTSRow;
+    if (nRow == 1) {
+      pTbData->minKey = TMIN(pTbData->minKey, key.ts);
+    }
+    if (key.ts > pTbData->lastKey) {
+      pTbData->lastKey = key.ts;
+    }
+
+    pLastRow = pRow;
+  }
+  if (useChunk) taosWUnLockLatch(&pTbData->latch);
 
-      row.pTSRow = tGetSubmitBlkNext(&blkIter);
-    } while (row.pTSRow);
+  if (nChunkSize > 0) {
+    vnodeBufPoolAddExtSize(pMemTable->pPool, nChunkSize);
+  }
+
+  if (code) {
+    goto _err;
   }
+  if (pLastRow == NULL) return code;
 
   if (key.ts >= pTbData->maxKey) {
     if (key.ts > pTbData->maxKey) {
@@ -615,7 +887,7 @@ _err:
   return code;
 }
 
-int32_t tsdbGetNRowsInTbData(STbData *pTbData) { return pTbData->sl.size; }
+int32_t tsdbGetNRowsInTbData(STbData *pTbData) { return pTbData->sl.size + pTbData->nChunkRow; }
 
 void tsdbRefMemTable(SMemTable *pMemTable) {
   int32_t nRef = atomic_fetch_add_32(&pMemTable->nRef, 1);
@@ -74,6 +74,10 @@ int tsdbOpen(SVnode *pVnode, STsdb **ppTsdb, const char *dir, STsdbKeepCfg *pKee
     goto _err;
   }
 
+  if (tsdbOpenPgCache(pTsdb) < 0) {
+    goto _err;
+  }
+
   tsdbDebug("vgId:%d, tsdb is opened at %s, days:%d, keep:%d,%d,%d", TD_VID(pVnode), pTsdb->path, pTsdb->keepCfg.days,
             pTsdb->keepCfg.keep0, pTsdb->keepCfg.keep1, pTsdb->keepCfg.keep2);
 
@@ -81,6 +85,9 @@ int tsdbOpen(SVnode *pVnode, STsdb **ppTsdb, const char *dir, STsdbKeepCfg *pKee
   return 0;
 
 _err:
+  tsdbCloseCache(pTsdb);
+  tsdbFSClose(pTsdb);
+  taosThreadRwlockDestroy(&pTsdb->rwLock);
   taosMemoryFree(pTsdb);
   return -1;
 }
@@ -96,6 +103,7 @@ int tsdbClose(STsdb **pTsdb) {
 
     tsdbFSClose(*pTsdb);
     tsdbCloseCache(*pTsdb);
+    tsdbClosePgCache(*pTsdb);
     taosMemoryFreeClear(*pTsdb);
   }
   return 0;
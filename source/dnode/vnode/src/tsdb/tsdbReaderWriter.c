@@ -16,20 +16,24 @@
 #include "tsdb.h"
 
 // =============== PAGE-WISE FILE ===============
-static int32_t tsdbOpenFile(const char *path, int32_t szPage, int32_t flag, STsdbFD **ppFD) {
+int32_t tsdbOpenFile(STsdb *pTsdb, const char *path, int32_t szPage, int32_t flag, STsdbFD **ppFD) {
   int32_t  code = 0;
   STsdbFD *pFD = NULL;
+  int32_t  szPath = strlen(path);
 
   *ppFD = NULL;
 
-  pFD = (STsdbFD *)taosMemoryCalloc(1, sizeof(*pFD) + strlen(path) + 1);
+  pFD = (STsdbFD *)taosMemoryCalloc(1, sizeof(*pFD) + sizeof(int64_t) + szPath + 1);
   if (pFD == NULL) {
     code = TSDB_CODE_OUT_OF_MEMORY;
     goto _exit;
   }
 
-  pFD->path = (char *)&pFD[1];
+  pFD->pKey = (uint8_t *)&pFD[1];
+  pFD->szKey = sizeof(int64_t) + szPath;
+  pFD->path = (char *)(pFD->pKey + sizeof(int64_t));
   strcpy(pFD->path, path);
+  pFD->pTsdb = pTsdb;
   pFD->szPage = szPage;
   pFD->flag = flag;
   pFD->pFD = taosOpenFile(path, flag);
@@ -62,16 +66,59 @@ _exit:
   return code;
 }
 
-static void tsdbCloseFile(STsdbFD **ppFD) {
+void tsdbCloseFile(STsdbFD **ppFD) {
   STsdbFD *pFD = *ppFD;
   if (pFD) {
     taosMemoryFree(pFD->pBuf);
+    taosMemoryFree(pFD->pRBuf);
     taosCloseFile(&pFD->pFD);
     taosMemoryFree(pFD);
     *ppFD = NULL;
   }
 }
 
+// Pages of a data file are immutable once the file grows past them, except the first page which holds the file
+// header and the last page which may be appended by the next commit. Only the immutable pages are cached, and the
+// cache is shared by all readers of the vnode.
+static FORCE_INLINE bool tsdbPgCacheable(STsdbFD *pFD, int64_t pgno) {
+  return pFD->pTsdb != NULL && pFD->pTsdb->pgCache != NULL && pFD->flag == TD_FILE_READ && pgno > 1 &&
+         pgno < pFD->szFile;
+}
+
+static FORCE_INLINE void tsdbPgCacheKey(STsdbFD *pFD, int64_t pgno) { memcpy(pFD->pKey, &pgno, sizeof(pgno)); }
+
+static void tsdbPgCacheDeleter(const void *key, size_t keyLen, void *value) { taosMemoryFree(value); }
+
+// Only the access of a page counts in the hit/miss stats, a probe looking ahead for the pages to read in one run
+// does not.
+static LRUHandle *tsdbPgCacheLookup(STsdbFD *pFD, int64_t pgno, bool stat) {
+  if (!tsdbPgCacheable(pFD, pgno)) return NULL;
+
+  tsdbPgCacheKey(pFD, pgno);
+  LRUHandle *h = taosLRUCacheLookup(pFD->pTsdb->pgCache, pFD->pKey, pFD->szKey);
+  if (stat) {
+    atomic_add_fetch_64(h ? &pFD->pTsdb->pgCacheHit : &pFD->pTsdb->pgCacheMiss, 1);
+  }
+
+  return h;
+}
+
+static void tsdbPgCacheInsert(STsdbFD *pFD, int64_t pgno, const uint8_t *pPage) {
+  if (!tsdbPgCacheable(pFD, pgno)) return;
+
+  uint8_t *pValue = taosMemoryMalloc(pFD->szPage);
+  if (pValue == NULL) return;  // cache is best effort
+  memcpy(pValue, pPage, pFD->szPage);
+
+  tsdbPgCacheKey(pFD, pgno);
+  LRUStatus status = taosLRUCacheInsert(pFD->pTsdb->pgCache, pFD->pKey, pFD->szKey, pValue, pFD->szPage,
+                                        tsdbPgCacheDeleter, NULL, TAOS_LRU_PRIORITY_LOW);
+  if (status != TAOS_LRU_STATUS_OK && status != TAOS_LRU_STATUS_OK_OVERWRITTEN) {
+    tsdbDebug("vgId:%d, failed to insert page %" PRId64 " of %s into page cache, status:%d",
+              TD_VID(pFD->pTsdb->pVnode), pgno, pFD->path, status);
+  }
+}
+
 static int32_t tsdbWriteFilePage(STsdbFD *pFD) {
   int32_t code = 0;
 
@@ -93,6 +140,12 @@ static int32_t tsdbWriteFilePage(STsdbFD *pFD) {
     if (pFD->szFile < pFD->pgno) {
       pFD->szFile = pFD->pgno;
     }
+
+    // in case the page is cached by a reader opened before
+    if (pFD->pTsdb && pFD->pTsdb->pgCache) {
+      tsdbPgCacheKey(pFD, pFD->pgno);
+      taosLRUCacheErase(pFD->pTsdb->pgCache, pFD->pKey, pFD->szKey);
+    }
   }
   pFD->pgno = 0;
 
@@ -105,16 +158,9 @@ static int32_t tsdbReadFilePage(STsdbFD *pFD, int64_t pgno) {
 
   ASSERT(pgno <= pFD->szFile);
 
-  // seek
-  int64_t offset = PAGE_OFFSET(pgno, pFD->szPage);
-  int64_t n = taosLSeekFile(pFD->pFD, offset, SEEK_SET);
-  if (n < 0) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    goto _exit;
-  }
-
   // read
-  n = taosReadFile(pFD->pFD, pFD->pBuf, pFD->szPage);
+  int64_t offset = PAGE_OFFSET(pgno, pFD->szPage);
+  int64_t n = taosPReadFile(pFD->pFD, pFD->pBuf, pFD->szPage, offset);
   if (n < 0) {
     code = TAOS_SYSTEM_ERROR(errno);
     goto _exit;
@@ -135,7 +181,50 @@ _exit:
   return code;
 }
 
-static int32_t tsdbWriteFile(STsdbFD *pFD, int64_t offset, const uint8_t *pBuf, int64_t size) {
+// Read nPage continuous pages starting from pgno with one pread, verify and cache each of them. The last page is
+// kept in pFD->pBuf as the current page.
+static int32_t tsdbReadFilePages(STsdbFD *pFD, int64_t pgno, int64_t nPage) {
+  int32_t code = 0;
+  int64_t size = nPage * pFD->szPage;
+
+  ASSERT(pgno + nPage - 1 <= pFD->szFile);
+
+  if (pFD->szRBuf < size) {
+    uint8_t *pRBuf = taosMemoryRealloc(pFD->pRBuf, size);
+    if (pRBuf == NULL) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      goto _exit;
+    }
+    pFD->pRBuf = pRBuf;
+    pFD->szRBuf = size;
+  }
+
+  int64_t n = taosPReadFile(pFD->pFD, pFD->pRBuf, size, PAGE_OFFSET(pgno, pFD->szPage));
+  if (n < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _exit;
+  } else if (n < size) {
+    code = TSDB_CODE_FILE_CORRUPTED;
+    goto _exit;
+  }
+
+  for (int64_t iPage = 0; iPage < nPage; iPage++) {
+    uint8_t *pPage = pFD->pRBuf + iPage * pFD->szPage;
+    if (pgno + iPage > 1 && !taosCheckChecksumWhole(pPage, pFD->szPage)) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      goto _exit;
+    }
+    tsdbPgCacheInsert(pFD, pgno + iPage, pPage);
+  }
+
+  memcpy(pFD->pBuf, pFD->pRBuf + (nPage - 1) * pFD->szPage, pFD->szPage);
+  pFD->pgno = pgno + nPage - 1;
+
+_exit:
+  return code;
+}
+
+int32_t tsdbWriteFile(STsdbFD *pFD, int64_t offset, const uint8_t *pBuf, int64_t size) {
   int32_t code = 0;
   int64_t fOffset = LOGIC_TO_FILE_OFFSET(offset, pFD->szPage);
   int64_t pgno = OFFSET_PGNO(fOffset, pFD->szPage);
@@ -167,25 +256,66 @@ _exit:
   return code;
 }
 
-static int32_t tsdbReadFile(STsdbFD *pFD, int64_t offset, uint8_t *pBuf, int64_t size) {
+int32_t tsdbReadFile(STsdbFD *pFD, int64_t offset, uint8_t *pBuf, int64_t size) {
   int32_t code = 0;
   int64_t n = 0;
   int64_t fOffset = LOGIC_TO_FILE_OFFSET(offset, pFD->szPage);
   int64_t pgno = OFFSET_PGNO(fOffset, pFD->szPage);
   int32_t szPgCont = PAGE_CONTENT_SIZE(pFD->szPage);
   int64_t bOffset = fOffset % pFD->szPage;
+  int64_t pgnoEnd = pgno + (bOffset + size - 1) / szPgCont;
 
   ASSERT(pgno && pgno <= pFD->szFile);
   ASSERT(bOffset < szPgCont);
 
   while (n < size) {
-    if (pFD->pgno != pgno) {
-      code = tsdbReadFilePage(pFD, pgno);
-      if (code) goto _exit;
+    const uint8_t *pPage = NULL;
+    LRUHandle     *h = NULL;
+
+    if (pFD->pgno == pgno) {
+      pPage = pFD->pBuf;
+    } else if ((h = tsdbPgCacheLookup(pFD, pgno, true)) != NULL) {
+      pPage = taosLRUCacheValue(pFD->pTsdb->pgCache, h);
+    } else {
+      // fetch all the following pages not cached in one read
+      int64_t nPage = 1;
+      while (pgno + nPage <= pgnoEnd) {
+        LRUHandle *hNext = tsdbPgCacheLookup(pFD, pgno + nPage, false);
+        if (hNext) {
+          taosLRUCacheRelease(pFD->pTsdb->pgCache, hNext, false);
+          break;
+        }
+        nPage++;
+      }
+
+      if (nPage == 1) {
+        code = tsdbReadFilePage(pFD, pgno);
+        if (code) goto _exit;
+        tsdbPgCacheInsert(pFD, pgno, pFD->pBuf);
+      } else {
+        code = tsdbReadFilePages(pFD, pgno, nPage);
+        if (code) goto _exit;
+
+        // the first page of the run is counted by its lookup above, the following ones are accessed here
+        for (int64_t iPage = 1; iPage < nPage; iPage++) {
+          if (tsdbPgCacheable(pFD, pgno + iPage)) atomic_add_fetch_64(&pFD->pTsdb->pgCacheMiss, 1);
+        }
+
+        for (int64_t iPage = 0; iPage < nPage - 1; iPage++) {
+          int64_t nRead = TMIN(szPgCont - bOffset, size - n);
+          memcpy(pBuf + n, pFD->pRBuf + iPage * pFD->szPage + bOffset, nRead);
+
+          n += nRead;
+          pgno++;
+          bOffset = 0;
+        }
+      }
+      pPage = pFD->pBuf;
     }
 
     int64_t nRead = TMIN(szPgCont - bOffset, size - n);
-    memcpy(pBuf + n, pFD->pBuf + bOffset, nRead);
+    memcpy(pBuf + n, pPage + bOffset, nRead);
+    if (h) taosLRUCacheRelease(pFD->pTsdb->pgCache, h, false);
 
     n += nRead;
     pgno++;
@@ -196,7 +326,7 @@ _exit:
   return code;
 }
 
-static int32_t tsdbFsyncFile(STsdbFD *pFD) {
+int32_t tsdbFsyncFile(STsdbFD *pFD) {
   int32_t code = 0;
 
   code = tsdbWriteFilePage(pFD);
@@ -245,7 +375,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
   // head
   flag = TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC;
   tsdbHeadFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fHead, fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pHeadFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, flag, &pWriter->pHeadFD);
   if (code) goto _err;
 
   code = tsdbWriteFile(pWriter->pHeadFD, 0, hdr, TSDB_FHDR_SIZE);
@@ -259,7 +389,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
     flag = TD_FILE_READ | TD_FILE_WRITE;
   }
   tsdbDataFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fData, fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pDataFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, flag, &pWriter->pDataFD);
   if (code) goto _err;
   if (pWriter->fData.size == 0) {
     code = tsdbWriteFile(pWriter->pDataFD, 0, hdr, TSDB_FHDR_SIZE);
@@ -274,7 +404,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
     flag = TD_FILE_READ | TD_FILE_WRITE;
   }
   tsdbSmaFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fSma, fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pSmaFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, flag, &pWriter->pSmaFD);
   if (code) goto _err;
   if (pWriter->fSma.size == 0) {
     code = tsdbWriteFile(pWriter->pSmaFD, 0, hdr, TSDB_FHDR_SIZE);
@@ -287,7 +417,7 @@ int32_t tsdbDataFWriterOpen(SDataFWriter **ppWriter, STsdb *pTsdb, SDFileSet *pS
   ASSERT(pWriter->fStt[pSet->nSttF - 1].size == 0);
   flag = TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC;
   tsdbSttFileName(pTsdb, pWriter->wSet.diskId, pWriter->wSet.fid, &pWriter->fStt[pSet->nSttF - 1], fname);
-  code = tsdbOpenFile(fname, szPage, flag, &pWriter->pSttFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, flag, &pWriter->pSttFD);
   if (code) goto _err;
   code = tsdbWriteFile(pWriter->pSttFD, 0, hdr, TSDB_FHDR_SIZE);
   if (code) goto _err;
@@ -859,23 +989,23 @@ int32_t tsdbDataFReaderOpen(SDataFReader **ppReader, STsdb *pTsdb, SDFileSet *pS
 
   // head
   tsdbHeadFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pHeadF, fname);
-  code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->pHeadFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, TD_FILE_READ, &pReader->pHeadFD);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // data
   tsdbDataFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pDataF, fname);
-  code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->pDataFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, TD_FILE_READ, &pReader->pDataFD);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // sma
   tsdbSmaFileName(pTsdb, pSet->diskId, pSet->fid, pSet->pSmaF, fname);
-  code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->pSmaFD);
+  code = tsdbOpenFile(pTsdb, fname, szPage, TD_FILE_READ, &pReader->pSmaFD);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // stt
   for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
     tsdbSttFileName(pTsdb, pSet->diskId, pSet->fid, pSet->aSttF[iStt], fname);
-    code = tsdbOpenFile(fname, szPage, TD_FILE_READ, &pReader->aSttFD[iStt]);
+    code = tsdbOpenFile(pTsdb, fname, szPage, TD_FILE_READ, &pReader->aSttFD[iStt]);
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
@@ -1219,6 +1349,23 @@ _err:
   return code;
 }
 
+int32_t tsdbPrefetchDataBlk(SDataFReader *pReader, SDataBlk *pDataBlk) {
+  int32_t     code = 0;
+  STsdbFD    *pFD = pReader->pDataFD;
+  SBlockInfo *pBlkInfo = &pDataBlk->aSubBlock[0];
+
+  int64_t pgno = OFFSET_PGNO(LOGIC_TO_FILE_OFFSET(pBlkInfo->offset, pFD->szPage), pFD->szPage);
+  int64_t pgnoEnd =
+      OFFSET_PGNO(LOGIC_TO_FILE_OFFSET(pBlkInfo->offset + pBlkInfo->szBlock - 1, pFD->szPage), pFD->szPage);
+
+  if (taosPrefetchFile(pFD->pFD, PAGE_OFFSET(pgno, pFD->szPage), (pgnoEnd - pgno + 1) * pFD->szPage) < 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    tsdbDebug("vgId:%d, tsdb prefetch data block failed since %s", TD_VID(pReader->pTsdb->pVnode), tstrerror(code));
+  }
+
+  return code;
+}
+
 int32_t tsdbReadSttBlock(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData) {
   int32_t code = 0;
   int32_t lino = 0;
@@ -1275,8 +1422,8 @@ int32_t tsdbDelFWriterOpen(SDelFWriter **ppWriter, SDelFile *pFile, STsdb *pTsdb
   pDelFWriter->fDel = *pFile;
 
   tsdbDelFileName(pTsdb, pFile, fname);
-  code = tsdbOpenFile(fname, pTsdb->pVnode->config.tsdbPageSize, TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE,
-                      &pDelFWriter->pWriteH);
+  code = tsdbOpenFile(pTsdb, fname, pTsdb->pVnode->config.tsdbPageSize,
+                      TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE, &pDelFWriter->pWriteH);
   TSDB_CHECK_CODE(code, lino, _exit);
 
   // update header
@@ -1450,7 +1597,7 @@ int32_t tsdbDelFReaderOpen(SDelFReader **ppReader, SDelFile *pFile, STsdb *pTsdb
   pDelFReader->fDel = *pFile;
 
   tsdbDelFileName(pTsdb, pFile, fname);
-  code = tsdbOpenFile(fname, pTsdb->pVnode->config.tsdbPageSize, TD_FILE_READ, &pDelFReader->pReadH);
+  code = tsdbOpenFile(pTsdb, fname, pTsdb->pVnode->config.tsdbPageSize, TD_FILE_READ, &pDelFReader->pReadH);
   if (code) {
     taosMemoryFree(pDelFReader);
     goto _exit;
@@ -48,6 +48,7 @@ static int vnodeBufPoolCreate(SVnode *pVnode, int64_t size, SVBufPool **ppPool)
   pPool->pVnode = pVnode;
   pPool->nRef = 0;
   pPool->size = 0;
+  pPool->extSize = 0;
   pPool->ptr = pPool->node.data;
   pPool->pTail = &pPool->node;
   pPool->node.prev = NULL;
@@ -120,6 +121,7 @@ void vnodeBufPoolReset(SVBufPool *pPool) {
   ASSERT(pPool->size == pPool->ptr - pPool->node.data);
 
   pPool->size = 0;
+  pPool->extSize = 0;
   pPool->ptr = pPool->node.data;
 }
 
@@ -196,6 +198,8 @@ void *vnodeBufPoolMalloc(SVBufPool *pPool, int size) {
   return p;
 }
 
+void vnodeBufPoolAddExtSize(SVBufPool *pPool, int64_t size) { atomic_add_fetch_64(&pPool->extSize, size); }
+
 void vnodeBufPoolFree(SVBufPool *pPool, void *p) {
   // uint8_t       *ptr = (uint8_t *)p;
   // SVBufPoolNode *pNode;
@@ -20,6 +20,8 @@
 
 static int vnodeEncodeInfo(const SVnodeInfo *pInfo, char **ppData);
 static int vnodeCommitImpl(SCommitInfo *pInfo);
+static int vnodeCompactImpl(SVnode *pVnode, int8_t force);
+static void vnodeScheduleCompact(SVnode *pVnode, int8_t force);
 
 int vnodeBegin(SVnode *pVnode) {
   // alloc buffer pool
@@ -36,7 +38,6 @@ int vnodeBegin(SVnode *pVnode) {
 
   taosThreadMutexUnlock(&pVnode->mutex);
 
-  pVnode->state.commitID++;
   // begin meta
   if (metaBegin(pVnode->pMeta, META_BEGIN_HEAP_BUFFERPOOL) < 0) {
     vError("vgId:%d, failed to begin meta since %s", TD_VID(pVnode), tstrerror(terrno));
@@ -72,7 +73,9 @@ int vnodeShouldCommit(SVnode *pVnode) {
   SVCommitSched *pSched = &pVnode->commitSched;
   int64_t nowMs = taosGetMonoTimestampMs();
 
-  return (((pVnode->inUse->size > pVnode->inUse->node.size) && (pSched->commitMs + SYNC_VND_COMMIT_MIN_MS < nowMs)) ||
+  int64_t size = pVnode->inUse->size + atomic_load_64(&pVnode->inUse->extSize);
+
+  return (((size > pVnode->inUse->node.size) && (pSched->commitMs + SYNC_VND_COMMIT_MIN_MS < nowMs)) ||
           (pVnode->inUse->size > 0 && pSched->commitMs + pSched->maxWaitMs < nowMs));
 }
 
@@ -214,7 +217,8 @@ static int32_t vnodePrepareCommit(SVnode *pVnode, SCommitInfo *pInfo) {
   pInfo->info.config = pVnode->config;
   pInfo->info.state.committed = pVnode->state.applied;
   pInfo->info.state.commitTerm = pVnode->state.applyTerm;
-  pInfo->info.state.commitID = pVnode->state.commitID;
+  // the ID is taken here, under canCommit, so a compaction taking one of its own never collides with it
+  pInfo->info.state.commitID = atomic_add_fetch_64(&pVnode->state.commitID, 1);
   pInfo->pVnode = pVnode;
   pInfo->txn = metaGetTxn(pVnode->pMeta);
 
@@ -258,6 +262,11 @@ static int32_t vnodeCommitTask(void *arg) {
   code = vnodeCommitImpl(pInfo);
   if (code) goto _exit;
 
+  // compact the file sets the commit left with too many stt files, in the background
+  if (tsdbShouldCompact(pInfo->pVnode->pTsdb)) {
+    vnodeScheduleCompact(pInfo->pVnode, 0);
+  }
+
   // end commit
   tsem_post(&pInfo->pVnode->canCommit);
 
@@ -305,6 +314,114 @@ int vnodeSyncCommit(SVnode *pVnode) {
   return 0;
 }
 
+static int32_t vnodeCompactTask(void *arg) {
+  SVnode *pVnode = (SVnode *)arg;
+  int8_t  force;
+
+  // a forced compaction requested while the job runs is done by the same job
+  taosThreadMutexLock(&pVnode->mutex);
+  for (;;) {
+    force = pVnode->compactForce;
+    pVnode->compactForce = 0;
+    taosThreadMutexUnlock(&pVnode->mutex);
+
+    vnodeCompactImpl(pVnode, force);
+
+    taosThreadMutexLock(&pVnode->mutex);
+    if (!pVnode->compactForce || pVnode->compactStop) break;
+  }
+  pVnode->compacting = 0;
+  taosThreadMutexUnlock(&pVnode->mutex);
+
+  return 0;
+}
+
+static void vnodeScheduleCompact(SVnode *pVnode, int8_t force) {
+  int8_t schedule = 0;
+
+  taosThreadMutexLock(&pVnode->mutex);
+  if (!pVnode->compactStop) {
+    if (force) pVnode->compactForce = 1;
+    if (!pVnode->compacting) {
+      pVnode->compacting = 1;
+      schedule = 1;
+    }
+  }
+  taosThreadMutexUnlock(&pVnode->mutex);
+
+  if (schedule && vnodeScheduleCompactTask(vnodeCompactTask, pVnode) < 0) {
+    vError("vgId:%d, failed to schedule compact since %s", TD_VID(pVnode), tstrerror(terrno));
+    taosThreadMutexLock(&pVnode->mutex);
+    pVnode->compacting = 0;
+    taosThreadMutexUnlock(&pVnode->mutex);
+  }
+}
+
+int32_t vnodeAsyncCompact(SVnode *pVnode) {
+  // the compaction runs as a job of its own beside the commits, the apply thread never waits for it
+  vnodeScheduleCompact(pVnode, 1);
+
+  vInfo("vgId:%d, vnode async compact scheduled", TD_VID(pVnode));
+  return 0;
+}
+
+void vnodeStopCompact(SVnode *pVnode) {
+  // a running compaction gives up at its next file set, a scheduled one does nothing
+  taosThreadMutexLock(&pVnode->mutex);
+  atomic_store_8(&pVnode->compactStop, 1);
+  while (pVnode->compacting) {
+    taosThreadMutexUnlock(&pVnode->mutex);
+    taosMsleep(10);
+    taosThreadMutexLock(&pVnode->mutex);
+  }
+  taosThreadMutexUnlock(&pVnode->mutex);
+}
+
+static int vnodeCompactImpl(SVnode *pVnode, int8_t force) {
+  int32_t    code = 0;
+  int32_t    lino = 0;
+  int64_t    commitID = 0;
+  char       dir[TSDB_FILENAME_LEN] = {0};
+  SVnodeInfo info = {0};
+
+  if (atomic_load_8(&pVnode->compactStop) || (!force && !tsdbShouldCompact(pVnode->pTsdb))) {
+    return 0;
+  }
+
+  if (pVnode->pTfs) {
+    snprintf(dir, TSDB_FILENAME_LEN, "%s%s%s", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP, pVnode->path);
+  } else {
+    snprintf(dir, TSDB_FILENAME_LEN, "%s", pVnode->path);
+  }
+
+  // the files written by compaction take an ID of their own. It is taken while no commit runs and persisted before
+  // any file is written, so it is never reused, not even after a restart.
+  tsem_wait(&pVnode->canCommit);
+  commitID = atomic_add_fetch_64(&pVnode->state.commitID, 1);
+  if (vnodeLoadInfo(dir, &info) < 0) {
+    code = terrno;
+  } else {
+    info.state.commitID = commitID;
+    if (vnodeSaveInfo(dir, &info) < 0 || vnodeCommitInfo(dir, &info) < 0) {
+      code = terrno;
+    }
+  }
+  tsem_post(&pVnode->canCommit);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbCompact(pVnode->pTsdb, commitID, force);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    vError("vgId:%d, %s failed at line %d since %s, commit id:%" PRId64, TD_VID(pVnode), __func__, lino,
+           tstrerror(code), commitID);
+  } else {
+    vInfo("vgId:%d, vnode compact done, commit id:%" PRId64, TD_VID(pVnode), commitID);
+  }
+  return code;
+}
+
 static int vnodeCommitImpl(SCommitInfo *pInfo) {
   int32_t code = 0;
   int32_t lino = 0;
@@ -23,18 +23,28 @@ struct SVnodeTask {
   void* arg;
 };
 
-struct SVnodeGlobal {
-  int8_t        init;
+typedef struct {
+  const char*   name;
   int8_t        stop;
   int           nthreads;
   TdThread*     threads;
   TdThreadMutex mutex;
   TdThreadCond  hasTask;
   SVnodeTask    queue;
+} SVnodeThreadPool;
+
+struct SVnodeGlobal {
+  int8_t           init;
+  SVnodeThreadPool commitPool;   // commit tasks
+  SVnodeThreadPool fsetPool;     // filesets of a tsdb commit, committed in parallel with the commit task
+  SVnodeThreadPool compactPool;  // compaction jobs, run beside the commits
 };
 
 struct SVnodeGlobal vnodeGlobal;
 
+static int   vnodeOpenThreadPool(SVnodeThreadPool* pPool, int nthreads, const char* name);
+static void  vnodeCloseThreadPool(SVnodeThreadPool* pPool);
+static int   vnodeScheduleTaskImpl(SVnodeThreadPool* pPool, int (*execute)(void*), void* arg);
 static void* loop(void* arg);
 
 static tsem_t canCommit = {0};
@@ -52,27 +62,17 @@ int vnodeInit(int nthreads) {
     return 0;
   }
 
-  taosThreadMutexInit(&vnodeGlobal.mutex, NULL);
-  taosThreadCondInit(&vnodeGlobal.hasTask, NULL);
-
-  taosThreadMutexLock(&vnodeGlobal.mutex);
-
-  vnodeGlobal.stop = 0;
-  vnodeGlobal.queue.next = &vnodeGlobal.queue;
-  vnodeGlobal.queue.prev = &vnodeGlobal.queue;
-
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+  if (vnodeOpenThreadPool(&vnodeGlobal.commitPool, nthreads, "vnode-commit") < 0) {
+    return -1;
+  }
 
-  vnodeGlobal.nthreads = nthreads;
-  vnodeGlobal.threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
-  if (vnodeGlobal.threads == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
-    vError("failed to init vnode module since:%s", tstrerror(terrno));
+  // the commit task itself is one of the threads committing filesets
+  if (vnodeOpenThreadPool(&vnodeGlobal.fsetPool, tsTsdbCommitThreads - 1, "tsdb-commit") < 0) {
     return -1;
   }
 
-  for (int i = 0; i < nthreads; i++) {
-    taosThreadCreate(&(vnodeGlobal.threads[i]), NULL, loop, NULL);
+  if (vnodeOpenThreadPool(&vnodeGlobal.compactPool, 1, "vnode-compact") < 0) {
+    return -1;
   }
 
   if (walInit() < 0) {
@@ -91,31 +91,89 @@ void vnodeCleanup() {
   init = atomic_val_compare_exchange_8(&(vnodeGlobal.init), 1, 0);
   if (init == 0) return;
 
+  // commit tasks wait for the fileset tasks they scheduled, so the fileset pool stops last
+  vnodeCloseThreadPool(&vnodeGlobal.compactPool);
+  vnodeCloseThreadPool(&vnodeGlobal.commitPool);
+  vnodeCloseThreadPool(&vnodeGlobal.fsetPool);
+
+  walCleanUp();
+  tqCleanUp();
+  smaCleanUp();
+}
+
+int vnodeScheduleTask(int (*execute)(void*), void* arg) {
+  return vnodeScheduleTaskImpl(&vnodeGlobal.commitPool, execute, arg);
+}
+
+int vnodeScheduleCompactTask(int (*execute)(void*), void* arg) {
+  return vnodeScheduleTaskImpl(&vnodeGlobal.compactPool, execute, arg);
+}
+
+int vnodeScheduleFSetTask(int (*execute)(void*), void* arg) {
+  if (vnodeGlobal.fsetPool.nthreads <= 0) {
+    terrno = TSDB_CODE_INVALID_PARA;
+    return -1;
+  }
+
+  return vnodeScheduleTaskImpl(&vnodeGlobal.fsetPool, execute, arg);
+}
+
+/* ------------------------ STATIC METHODS ------------------------ */
+static int vnodeOpenThreadPool(SVnodeThreadPool* pPool, int nthreads, const char* name) {
+  taosThreadMutexInit(&pPool->mutex, NULL);
+  taosThreadCondInit(&pPool->hasTask, NULL);
+
+  taosThreadMutexLock(&pPool->mutex);
+
+  pPool->name = name;
+  pPool->stop = 0;
+  pPool->queue.next = &pPool->queue;
+  pPool->queue.prev = &pPool->queue;
+
+  taosThreadMutexUnlock(&(pPool->mutex));
+
+  if (nthreads <= 0) {
+    pPool->nthreads = 0;
+    return 0;
+  }
+
+  pPool->nthreads = nthreads;
+  pPool->threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
+  if (pPool->threads == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    vError("failed to init vnode module since:%s", tstrerror(terrno));
+    return -1;
+  }
+
+  for (int i = 0; i < nthreads; i++) {
+    taosThreadCreate(&(pPool->threads[i]), NULL, loop, pPool);
+  }
+
+  return 0;
+}
+
+static void vnodeCloseThreadPool(SVnodeThreadPool* pPool) {
   // set stop
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
-  vnodeGlobal.stop = 1;
-  taosThreadCondBroadcast(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+  taosThreadMutexLock(&(pPool->mutex));
+  pPool->stop = 1;
+  taosThreadCondBroadcast(&(pPool->hasTask));
+  taosThreadMutexUnlock(&(pPool->mutex));
 
   // wait for threads
-  for (int i = 0; i < vnodeGlobal.nthreads; i++) {
-    taosThreadJoin(vnodeGlobal.threads[i], NULL);
+  for (int i = 0; i < pPool->nthreads; i++) {
+    taosThreadJoin(pPool->threads[i], NULL);
   }
 
   // clear source
-  taosMemoryFreeClear(vnodeGlobal.threads);
-  taosThreadCondDestroy(&(vnodeGlobal.hasTask));
-  taosThreadMutexDestroy(&(vnodeGlobal.mutex));
-
-  walCleanUp();
-  tqCleanUp();
-  smaCleanUp();
+  taosMemoryFreeClear(pPool->threads);
+  taosThreadCondDestroy(&(pPool->hasTask));
+  taosThreadMutexDestroy(&(pPool->mutex));
 }
 
-int vnodeScheduleTask(int (*execute)(void*), void* arg) {
+static int vnodeScheduleTaskImpl(SVnodeThreadPool* pPool, int (*execute)(void*), void* arg) {
   SVnodeTask* pTask;
 
-  ASSERT(!vnodeGlobal.stop);
+  ASSERT(!pPool->stop);
 
   pTask = taosMemoryMalloc(sizeof(*pTask));
   if (pTask == NULL) {
@@ -126,35 +184,35 @@ int vnodeScheduleTask(int (*execute)(void*), void* arg) {
   pTask->execute = execute;
   pTask->arg = arg;
 
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
-  pTask->next = &vnodeGlobal.queue;
-  pTask->prev = vnodeGlobal.queue.prev;
-  vnodeGlobal.queue.prev->next = pTask;
-  vnodeGlobal.queue.prev = pTask;
-  taosThreadCondSignal(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+  taosThreadMutexLock(&(pPool->mutex));
+  pTask->next = &pPool->queue;
+  pTask->prev = pPool->queue.prev;
+  pPool->queue.prev->next = pTask;
+  pPool->queue.prev = pTask;
+  taosThreadCondSignal(&(pPool->hasTask));
+  taosThreadMutexUnlock(&(pPool->mutex));
 
   return 0;
 }
 
-/* ------------------------ STATIC METHODS ------------------------ */
 static void* loop(void* arg) {
-  SVnodeTask* pTask;
-  int         ret;
+  SVnodeThreadPool* pPool = (SVnodeThreadPool*)arg;
+  SVnodeTask*       pTask;
+  int               ret;
 
-  setThreadName("vnode-commit");
+  setThreadName(pPool->name);
 
   for (;;) {
-    taosThreadMutexLock(&(vnodeGlobal.mutex));
+    taosThreadMutexLock(&(pPool->mutex));
     for (;;) {
-      pTask = vnodeGlobal.queue.next;
-      if (pTask == &vnodeGlobal.queue) {
+      pTask = pPool->queue.next;
+      if (pTask == &pPool->queue) {
         // no task
-        if (vnodeGlobal.stop) {
-          taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+        if (pPool->stop) {
+          taosThreadMutexUnlock(&(pPool->mutex));
           return NULL;
         } else {
-          taosThreadCondWait(&(vnodeGlobal.hasTask), &(vnodeGlobal.mutex));
+          taosThreadCondWait(&(pPool->hasTask), &(pPool->mutex));
         }
       } else {
         // has task
@@ -164,7 +222,7 @@ static void* loop(void* arg) {
       }
     }
 
-    taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+    taosThreadMutexUnlock(&(pPool->mutex));
 
     pTask->execute(pTask->arg);
     taosMemoryFree(pTask);
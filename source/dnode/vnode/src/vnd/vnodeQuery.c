@@ -387,11 +387,22 @@ int32_t vnodeGetLoad(SVnode *pVnode, SVnodeLoad *pLoad) {
   pLoad->totalStorage = (int64_t)3 * 1073741824;
   pLoad->compStorage = (int64_t)2 * 1073741824;
   pLoad->pointsWritten = 100;
+  pLoad->compactProgress = tsdbGetCompactProgress(pVnode->pTsdb);
   pLoad->numOfSelectReqs = 1;
   pLoad->numOfInsertReqs = atomic_load_64(&pVnode->statis.nInsert);
   pLoad->numOfInsertSuccessReqs = atomic_load_64(&pVnode->statis.nInsertSuccess);
   pLoad->numOfBatchInsertReqs = atomic_load_64(&pVnode->statis.nBatchInsert);
   pLoad->numOfBatchInsertSuccessReqs = atomic_load_64(&pVnode->statis.nBatchInsertSuccess);
+
+  size_t pgCacheUsage = 0;
+  tsdbGetPgCacheStat(pVnode->pTsdb, &pLoad->pageCacheHit, &pLoad->pageCacheMiss, &pgCacheUsage);
+  pLoad->pageCacheUsage = (int64_t)pgCacheUsage;
+
+  SWalFsyncStat fsyncStat = {0};
+  walGetFsyncStat(pVnode->pWal, &fsyncStat);
+  pLoad->numOfWalFsync = fsyncStat.numOfFsync;
+  pLoad->numOfWalFsyncEntries = fsyncStat.numOfEntry;
+  pLoad->walFsyncUs = fsyncStat.totalUs;
   return 0;
 }
 
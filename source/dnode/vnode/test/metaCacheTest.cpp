@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <taoserror.h>
+#include <tglobal.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+#include "meta.h"
+#include "vnd.h"
+
+namespace {
+
+const char    *testDir = TD_TMP_DIR_PATH "metaCacheTest";
+const tb_uid_t stbUid = 20001;
+const int32_t  numOfCachedSchemas = 4096;  // META_CACHE_SCHEMA_MAX
+
+class MetaCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    taosRemoveDir(testDir);
+    taosMkDir(testDir);
+
+    pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(SVnode));
+    pVnode->path = (char *)testDir;
+    pVnode->config.vgId = 1;
+    pVnode->config.szPage = 4096;
+    pVnode->config.szCache = 256;
+    ASSERT_EQ(metaOpen(pVnode, &pVnode->pMeta, 0), 0);
+    ASSERT_EQ(metaBegin(pVnode->pMeta, META_BEGIN_HEAP_OS), 0);
+    pMeta = pVnode->pMeta;
+  }
+
+  void TearDown() override {
+    metaClose(pVnode->pMeta);
+    taosMemoryFree(pVnode);
+    taosRemoveDir(testDir);
+  }
+
+  // create or alter the super table st (ts timestamp, c1 int[, c2 bigint]) tags (t1 int)
+  int32_t putSTable(int32_t sver, bool alter) {
+    SSchema aSchema[3] = {{.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8, .name = "ts"},
+                          {.type = TSDB_DATA_TYPE_INT, .colId = 2, .bytes = 4, .name = "c1"},
+                          {.type = TSDB_DATA_TYPE_BIGINT, .colId = 3, .bytes = 8, .name = "c2"}};
+    SSchema aTag[1] = {{.type = TSDB_DATA_TYPE_INT, .colId = 4, .bytes = 4, .name = "t1"}};
+
+    SVCreateStbReq req = {0};
+    req.name = "st";
+    req.suid = stbUid;
+    req.schemaRow = (SSchemaWrapper){.nCols = 1 + sver, .version = sver, .pSchema = aSchema};
+    req.schemaTag = (SSchemaWrapper){.nCols = 1, .version = 1, .pSchema = aTag};
+    return alter ? metaAlterSTable(pMeta, ++version, &req) : metaCreateSTable(pMeta, ++version, &req);
+  }
+
+  // put a schema of the given version of a table into the cache directly
+  STSchema *putSchema(tb_uid_t uid, int32_t sver) {
+    STSchemaBuilder sb = {0};
+    tdInitTSchemaBuilder(&sb, sver);
+    tdAddColToSchema(&sb, TSDB_DATA_TYPE_TIMESTAMP, 0, 1, 8);
+    tdAddColToSchema(&sb, TSDB_DATA_TYPE_INT, 0, 2, 4);
+    STSchema *pTSchema = tdGetSchemaFromBuilder(&sb);
+    tdDestroyTSchemaBuilder(&sb);
+
+    STSchema *pCached = NULL;
+    EXPECT_EQ(metaSchemaCachePut(pMeta, uid, pTSchema, &pCached), 0);
+    tDestroyTSchema(pTSchema);
+    return pCached;
+  }
+
+  bool isCached(tb_uid_t uid, int32_t sver) {
+    STSchema *pTSchema = NULL;
+    if (metaSchemaCacheGet(pMeta, uid, sver, &pTSchema) != 0) return false;
+    metaSchemaCacheRelease(pTSchema);
+    return true;
+  }
+
+  SVnode *pVnode = NULL;
+  SMeta  *pMeta = NULL;
+  int64_t version = 0;
+};
+
+}  // namespace
+
+TEST_F(MetaCacheTest, acquireAlterDrop) {
+  ASSERT_EQ(putSTable(1, false), 0);
+
+  // readers of the same version share one cached schema
+  STSchema *pTSchema1 = NULL;
+  STSchema *pTSchema2 = NULL;
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, stbUid, stbUid, -1, &pTSchema1), 0);
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, stbUid, stbUid, 1, &pTSchema2), 0);
+  ASSERT_EQ(pTSchema1, pTSchema2);
+  ASSERT_EQ(pTSchema1->version, 1);
+  ASSERT_EQ(pTSchema1->numOfCols, 2);
+  metaReleaseTbTSchema(pMeta, pTSchema2);
+
+  // an alter drops the cached versions, the reader still holding version 1 keeps it
+  ASSERT_EQ(putSTable(2, true), 0);
+  ASSERT_FALSE(isCached(stbUid, 1));
+  ASSERT_EQ(metaAcquireTbTSchema(pMeta, stbUid, stbUid, -1, &pTSchema2), 0);
+  ASSERT_EQ(pTSchema2->version, 2);
+  ASSERT_EQ(pTSchema2->numOfCols, 3);
+  ASSERT_EQ(pTSchema1->version, 1);
+  ASSERT_EQ(pTSchema1->numOfCols, 2);
+  ASSERT_EQ(pTSchema1->columns[1].colId, 2);
+
+  // so does a drop of the super table
+  SArray      *tbUidList = taosArrayInit(0, sizeof(tb_uid_t));
+  SVDropStbReq dropReq = {.name = "st", .suid = stbUid};
+  ASSERT_EQ(metaDropSTable(pMeta, ++version, &dropReq, tbUidList), 0);
+  taosArrayDestroy(tbUidList);
+  ASSERT_FALSE(isCached(stbUid, 2));
+  ASSERT_EQ(pTSchema2->version, 2);
+  ASSERT_EQ(pTSchema2->columns[2].colId, 3);
+
+  metaReleaseTbTSchema(pMeta, pTSchema1);
+  metaReleaseTbTSchema(pMeta, pTSchema2);
+}
+
+TEST_F(MetaCacheTest, evictLeastRecentlyUsed) {
+  // a schema evicted while held stays valid until released
+  STSchema *pHeld = putSchema(1, 1);
+  ASSERT_NE(pHeld, nullptr);
+  metaSchemaCacheRelease(putSchema(2, 1));
+
+  for (tb_uid_t uid = 3; uid <= numOfCachedSchemas; uid++) {
+    metaSchemaCacheRelease(putSchema(uid, 1));
+  }
+
+  // using uid 1 again leaves uid 2 the least recently used
+  ASSERT_TRUE(isCached(1, 1));
+  metaSchemaCacheRelease(putSchema(numOfCachedSchemas + 1, 1));
+  ASSERT_FALSE(isCached(2, 1));
+  ASSERT_TRUE(isCached(1, 1));
+  ASSERT_TRUE(isCached(3, 1));
+
+  std::vector<STSchema *> aHeld;
+  for (tb_uid_t uid = numOfCachedSchemas + 2; uid < 2 * numOfCachedSchemas + 2; uid++) {
+    aHeld.push_back(putSchema(uid, 1));
+  }
+  ASSERT_FALSE(isCached(1, 1));
+  ASSERT_TRUE(isCached(numOfCachedSchemas + 2, 1));
+  ASSERT_EQ(pHeld->version, 1);
+  ASSERT_EQ(pHeld->numOfCols, 2);
+  metaSchemaCacheRelease(pHeld);
+
+  for (STSchema *pTSchema : aHeld) {
+    metaSchemaCacheRelease(pTSchema);
+  }
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <map>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <taoserror.h>
+#include <tglobal.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+#include "tsdb.h"
+#include "vnd.h"
+
+namespace {
+
+const char   *testDir = TD_TMP_DIR_PATH "tsdbCommitTest";
+const int32_t nTable = 3;
+const int32_t nFSet = 8;
+const int64_t msPerDay = 24 * 3600 * 1000LL;
+
+// (uid, ts) -> (version, c1)
+typedef std::map<std::pair<tb_uid_t, TSKEY>, std::pair<int64_t, int32_t>> RowMap;
+
+// the layout of a committed fileset: fid, head, data and stt file sizes
+typedef std::tuple<int32_t, int64_t, int64_t, std::vector<int64_t>> FSetLayout;
+
+class TsdbCommitTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    commitThreads = tsTsdbCommitThreads;
+    tsTsdbCommitThreads = 4;
+    ASSERT_EQ(vnodeInit(1), 0);
+  }
+
+  static void TearDownTestSuite() {
+    vnodeCleanup();
+    tsTsdbCommitThreads = commitThreads;
+  }
+
+  void SetUp() override {
+    taosRemoveDir(testDir);
+    taosMkDir(testDir);
+
+    SDiskCfg diskCfg = {.level = 0, .primary = 1};
+    tstrncpy(diskCfg.dir, testDir, TSDB_FILENAME_LEN);
+    pTfs = tfsOpen(&diskCfg, 1);
+    ASSERT_NE(pTfs, nullptr);
+
+    now = taosGetTimestampMs() / msPerDay * msPerDay;
+  }
+
+  void TearDown() override {
+    closeVnode();
+    tfsClose(pTfs);
+    taosRemoveDir(testDir);
+  }
+
+  void openVnode(const char *path, int8_t sttTrigger) {
+    char dir[TSDB_FILENAME_LEN] = {0};
+    snprintf(dir, TSDB_FILENAME_LEN, "%s%s%s", testDir, TD_DIRSEP, path);
+    taosMkDir(dir);
+
+    pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(SVnode));
+    pVnode->path = (char *)path;
+    pVnode->pTfs = pTfs;
+    pVnode->config.vgId = 1;
+    pVnode->config.szPage = 4096;
+    pVnode->config.szCache = 256;
+    pVnode->config.szBuf = 64 * 1024 * 1024;
+    pVnode->config.sttTrigger = sttTrigger;
+    pVnode->config.tsdbPageSize = 4096;
+    pVnode->config.tsdbCfg.precision = TSDB_TIME_PRECISION_MILLI;
+    pVnode->config.tsdbCfg.days = 24 * 60;
+    pVnode->config.tsdbCfg.keep0 = 3650 * 24 * 60;
+    pVnode->config.tsdbCfg.keep1 = 3650 * 24 * 60;
+    pVnode->config.tsdbCfg.keep2 = 3650 * 24 * 60;
+    pVnode->config.tsdbCfg.minRows = 10;
+    pVnode->config.tsdbCfg.maxRows = 200;
+    pVnode->config.tsdbCfg.compression = 2;
+    pVnode->config.tsdbCfg.slLevel = 5;
+    taosThreadMutexInit(&pVnode->mutex, NULL);
+    taosThreadCondInit(&pVnode->poolNotEmpty, NULL);
+    tsem_init(&pVnode->canCommit, 0, 1);
+    ASSERT_EQ(metaOpen(pVnode, &pVnode->pMeta, 0), 0);
+    ASSERT_EQ(vnodeOpenBufPool(pVnode), 0);
+    pVnode->inUse = pVnode->pPool;
+    pVnode->inUse->nRef = 1;
+    pVnode->pPool = pVnode->inUse->next;
+    pVnode->inUse->next = NULL;
+    ASSERT_EQ(metaBegin(pVnode->pMeta, META_BEGIN_HEAP_OS), 0);
+
+    // create table t<i> (ts timestamp, c1 int)
+    SSchema aSchema[2] = {{.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8, .name = "ts"},
+                          {.type = TSDB_DATA_TYPE_INT, .colId = 2, .bytes = 4, .name = "c1"}};
+    for (int32_t iTable = 0; iTable < nTable; iTable++) {
+      char          name[TSDB_TABLE_NAME_LEN] = {0};
+      SVCreateTbReq req = {0};
+      snprintf(name, sizeof(name), "t%d", iTable);
+      req.name = name;
+      req.uid = uidOf(iTable);
+      req.type = TSDB_NORMAL_TABLE;
+      req.ntb.schemaRow = (SSchemaWrapper){.nCols = 2, .version = 1, .pSchema = aSchema};
+      ASSERT_EQ(metaCreateTable(pVnode->pMeta, ++version, &req, NULL), 0);
+    }
+    ASSERT_EQ(metaGetTbTSchemaEx(pVnode->pMeta, 0, uidOf(0), 1, &pTSchema), 0);
+
+    ASSERT_EQ(tsdbOpen(pVnode, &pVnode->pTsdb, VNODE_TSDB_DIR, NULL, 0), 0);
+    ASSERT_EQ(tsdbBegin(pVnode->pTsdb), 0);
+  }
+
+  void closeVnode() {
+    if (pVnode == NULL) return;
+
+    tsdbClose(&pVnode->pTsdb);
+    tDestroyTSchema(pTSchema);
+    pTSchema = NULL;
+    metaClose(pVnode->pMeta);
+    vnodeCloseBufPool(pVnode);
+    tsem_destroy(&pVnode->canCommit);
+    taosThreadCondDestroy(&pVnode->poolNotEmpty);
+    taosThreadMutexDestroy(&pVnode->mutex);
+    taosMemoryFreeClear(pVnode);
+    expect.clear();
+    version = 0;
+  }
+
+  static tb_uid_t uidOf(int32_t iTable) { return 10001 + iTable; }
+  static int32_t  valueOf(TSKEY ts, int64_t version) { return (int32_t)(ts % 100000 * 7 + version); }
+
+  // insert rows of the given timestamps to a table as one submit block
+  void insert(tb_uid_t uid, const std::vector<TSKEY> &aTs) {
+    std::vector<STSRow *> aRow;
+    int32_t               dataLen = 0;
+
+    version++;
+    for (TSKEY ts : aTs) {
+      SArray *aColVal = taosArrayInit(2, sizeof(SColVal));
+      SColVal cv = COL_VAL_VALUE(1, TSDB_DATA_TYPE_TIMESTAMP, (SValue){.val = ts});
+      taosArrayPush(aColVal, &cv);
+      cv = COL_VAL_VALUE(2, TSDB_DATA_TYPE_INT, (SValue){.val = valueOf(ts, version)});
+      taosArrayPush(aColVal, &cv);
+
+      STSRow *pRow = NULL;
+      ASSERT_EQ(tdSTSRowNew(aColVal, pTSchema, &pRow), 0);
+      taosArrayDestroy(aColVal);
+      aRow.push_back(pRow);
+      dataLen += TD_ROW_LEN(pRow);
+    }
+
+    SSubmitBlk *pBlock = (SSubmitBlk *)taosMemoryCalloc(1, sizeof(SSubmitBlk) + dataLen);
+    char       *p = pBlock->data;
+    for (STSRow *pRow : aRow) {
+      memcpy(p, pRow, TD_ROW_LEN(pRow));
+      p += TD_ROW_LEN(pRow);
+      taosMemoryFree(pRow);
+    }
+
+    SSubmitMsgIter msgIter = {0};
+    msgIter.uid = uid;
+    msgIter.sversion = 1;
+    msgIter.dataLen = dataLen;
+    msgIter.numOfRows = (int32_t)aTs.size();
+
+    SSubmitBlkRsp rsp = {0};
+    ASSERT_EQ(tsdbInsertTableData(pVnode->pTsdb, version, &msgIter, pBlock, &rsp), 0);
+    for (TSKEY ts : aTs) {
+      expect[{uid, ts}] = {version, valueOf(ts, version)};
+    }
+    taosMemoryFree(pBlock);
+  }
+
+  // rows of every table in nFSet filesets, the first row of each day is rewritten by the later rounds
+  void insertRound(int32_t round) {
+    for (int32_t iTable = 0; iTable < nTable; iTable++) {
+      for (int32_t iFSet = 0; iFSet < nFSet; iFSet++) {
+        TSKEY              skey = now - (nFSet - iFSet) * msPerDay;
+        std::vector<TSKEY> aTs = {skey};
+        for (int32_t i = 1; i < 150; i++) aTs.push_back(skey + round * 1000 + i);
+        insert(uidOf(iTable), aTs);
+      }
+    }
+  }
+
+  // commit as the vnode does, holding canCommit
+  void commit() {
+    STsdb      *pTsdb = pVnode->pTsdb;
+    SCommitInfo info = {0};
+    info.pVnode = pVnode;
+    info.info.config = pVnode->config;
+
+    tsem_wait(&pVnode->canCommit);
+    info.info.state.commitID = ++commitID;
+    ASSERT_EQ(tsdbPrepareCommit(pTsdb), 0);
+    ASSERT_EQ(tsdbCommit(pTsdb, &info), 0);
+    ASSERT_EQ(tsdbFinishCommit(pTsdb), 0);
+    tsem_post(&pVnode->canCommit);
+    ASSERT_EQ(tsdbBegin(pTsdb), 0);
+  }
+
+  void checkSttCount(int32_t maxSttF) {
+    for (int32_t iSet = 0; iSet < taosArrayGetSize(pVnode->pTsdb->fs.aDFileSet); iSet++) {
+      SDFileSet *pSet = (SDFileSet *)taosArrayGet(pVnode->pTsdb->fs.aDFileSet, iSet);
+      ASSERT_LE(pSet->nSttF, maxSttF) << "fid:" << pSet->fid;
+    }
+  }
+
+  void checkScan() {
+    std::vector<std::tuple<tb_uid_t, TSKEY, int32_t>> rows;
+    pVnode->state.applied = version;
+    scanData(TSDB_ORDER_ASC, rows);
+    ASSERT_EQ(rows.size(), expect.size());
+    for (auto &row : rows) {
+      auto it = expect.find({std::get<0>(row), std::get<1>(row)});
+      ASSERT_NE(it, expect.end());
+      ASSERT_EQ(std::get<2>(row), it->second.second);
+    }
+  }
+
+  static void readBlockData(SBlockData *pBlockData, RowMap &rows) {
+    SColData *pColData = NULL;
+    tBlockDataGetColData(pBlockData, 2, &pColData);
+    ASSERT_NE(pColData, nullptr);
+
+    for (int32_t iRow = 0; iRow < pBlockData->nRow; iRow++) {
+      tb_uid_t uid = pBlockData->uid ? pBlockData->uid : pBlockData->aUid[iRow];
+      SColVal  cv;
+      tColDataGetValue(pColData, iRow, &cv);
+
+      // rows of a key in more than one file are merged by version
+      auto &row = rows[{uid, pBlockData->aTSKEY[iRow]}];
+      if (pBlockData->aVersion[iRow] > row.first) {
+        row = {pBlockData->aVersion[iRow], (int32_t)cv.value.val};
+      }
+    }
+  }
+
+  // read every row in the data and stt files of the committed filesets
+  void checkData(std::vector<FSetLayout> *pLayout) {
+    STsdb     *pTsdb = pVnode->pTsdb;
+    RowMap     rows;
+    SArray    *aBlockIdx = taosArrayInit(0, sizeof(SBlockIdx));
+    SArray    *aSttBlk = taosArrayInit(0, sizeof(SSttBlk));
+    SMapData   mDataBlk = tMapDataInit();
+    SBlockData bData;
+    ASSERT_EQ(tBlockDataCreate(&bData), 0);
+
+    ASSERT_EQ(taosArrayGetSize(pTsdb->fs.aDFileSet), nFSet);
+    for (int32_t iSet = 0; iSet < taosArrayGetSize(pTsdb->fs.aDFileSet); iSet++) {
+      SDFileSet    *pSet = (SDFileSet *)taosArrayGet(pTsdb->fs.aDFileSet, iSet);
+      SDataFReader *pReader = NULL;
+      ASSERT_EQ(tsdbDataFReaderOpen(&pReader, pTsdb, pSet), 0);
+
+      ASSERT_EQ(tsdbReadBlockIdx(pReader, aBlockIdx), 0);
+      for (int32_t iBlockIdx = 0; iBlockIdx < taosArrayGetSize(aBlockIdx); iBlockIdx++) {
+        SBlockIdx *pBlockIdx = (SBlockIdx *)taosArrayGet(aBlockIdx, iBlockIdx);
+        TABLEID    id = {.suid = pBlockIdx->suid, .uid = pBlockIdx->uid};
+        ASSERT_EQ(tsdbReadDataBlk(pReader, pBlockIdx, &mDataBlk), 0);
+        for (int32_t iDataBlk = 0; iDataBlk < mDataBlk.nItem; iDataBlk++) {
+          SDataBlk dataBlk;
+          tMapDataGetItemByIdx(&mDataBlk, iDataBlk, &dataBlk, tGetDataBlk);
+          ASSERT_EQ(tBlockDataInit(&bData, &id, pTSchema, NULL, 0), 0);
+          ASSERT_EQ(tsdbReadDataBlock(pReader, &dataBlk, &bData), 0);
+          readBlockData(&bData, rows);
+        }
+      }
+
+      std::vector<int64_t> aSttSize;
+      for (int32_t iStt = 0; iStt < pSet->nSttF; iStt++) {
+        ASSERT_EQ(tsdbReadSttBlk(pReader, iStt, aSttBlk), 0);
+        for (int32_t iSttBlk = 0; iSttBlk < taosArrayGetSize(aSttBlk); iSttBlk++) {
+          SSttBlk *pSttBlk = (SSttBlk *)taosArrayGet(aSttBlk, iSttBlk);
+          TABLEID  id = {.suid = pSttBlk->suid, .uid = pSttBlk->suid ? 0 : pSttBlk->minUid};
+          ASSERT_EQ(tBlockDataInit(&bData, &id, pTSchema, NULL, 0), 0);
+          ASSERT_EQ(tsdbReadSttBlock(pReader, iStt, pSttBlk, &bData), 0);
+          readBlockData(&bData, rows);
+        }
+        aSttSize.push_back(pSet->aSttF[iStt]->size);
+      }
+      tsdbDataFReaderClose(&pReader);
+
+      if (pLayout) pLayout->push_back({pSet->fid, pSet->pHeadF->size, pSet->pDataF->size, aSttSize});
+    }
+
+    tBlockDataDestroy(&bData, 1);
+    tMapDataClear(&mDataBlk);
+    taosArrayDestroy(aSttBlk);
+    taosArrayDestroy(aBlockIdx);
+
+    ASSERT_EQ(rows.size(), expect.size());
+    for (auto &kv : expect) {
+      auto it = rows.find(kv.first);
+      ASSERT_NE(it, rows.end()) << "uid:" << kv.first.first << " ts:" << kv.first.second;
+      ASSERT_EQ(it->second, kv.second) << "uid:" << kv.first.first << " ts:" << kv.first.second;
+    }
+  }
+
+  // commit three rounds of rows into a new vnode, the later ones merged with the files of the earlier ones
+  void commitRounds(const char *path, int8_t sttTrigger, int32_t commitThreads, std::vector<FSetLayout> *pLayout) {
+    tsTsdbCommitThreads = commitThreads;
+    openVnode(path, sttTrigger);
+    for (int32_t round = 0; round < 3; round++) {
+      insertRound(round);
+      commit();
+      checkData(round == 2 ? pLayout : NULL);
+    }
+    closeVnode();
+    tsTsdbCommitThreads = 4;
+  }
+
+  // scan all the tables with a tsdb reader, the rows are returned in the order they are read
+  void scanData(int32_t order, std::vector<std::tuple<tb_uid_t, TSKEY, int32_t>> &rows) {
+    SColumnInfo aCol[2] = {{.colId = 1, .bytes = 8, .type = TSDB_DATA_TYPE_TIMESTAMP},
+                           {.colId = 2, .bytes = 4, .type = TSDB_DATA_TYPE_INT}};
+    int32_t     aSlot[2] = {0, 1};
+
+    SQueryTableDataCond cond = {0};
+    cond.order = order;
+    cond.numOfCols = 2;
+    cond.colList = aCol;
+    cond.pSlotList = aSlot;
+    cond.type = TIMEWINDOW_RANGE_CONTAINED;
+    cond.twindows = (STimeWindow){.skey = INT64_MIN, .ekey = INT64_MAX};
+    cond.startVersion = -1;
+    cond.endVersion = -1;
+
+    std::vector<STableKeyInfo> aTable;
+    for (int32_t iTable = 0; iTable < nTable; iTable++) {
+      aTable.push_back({.uid = uidOf(iTable), .groupId = 0});
+    }
+
+    STsdbReader *pReader = NULL;
+    ASSERT_EQ(tsdbReaderOpen(pVnode, &cond, aTable.data(), nTable, NULL, &pReader, "tsdbCommitTest"), 0);
+    while (tsdbNextDataBlock(pReader)) {
+      int32_t     nRow = 0;
+      uint64_t    uid = 0;
+      STimeWindow w = {0};
+      tsdbRetrieveDataBlockInfo(pReader, &nRow, &uid, &w);
+
+      SSDataBlock     *pBlock = tsdbRetrieveDataBlock(pReader, NULL);
+      SColumnInfoData *pTsCol = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+      SColumnInfoData *pValCol = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+      for (int32_t iRow = 0; iRow < nRow; iRow++) {
+        rows.push_back({(tb_uid_t)uid, *(TSKEY *)colDataGetData(pTsCol, iRow), *(int32_t *)colDataGetData(pValCol, iRow)});
+      }
+    }
+    tsdbReaderClose(pReader);
+  }
+
+  static int32_t commitThreads;
+
+  STfs     *pTfs = NULL;
+  SVnode   *pVnode = NULL;
+  STSchema *pTSchema = NULL;
+  int64_t   version = 0;
+  int64_t   commitID = 0;
+  TSKEY     now = 0;
+  RowMap    expect;
+};
+
+int32_t TsdbCommitTest::commitThreads = 0;
+
+}  // namespace
+
+TEST_F(TsdbCommitTest, parallelCommitToData) {
+  std::vector<FSetLayout> serial, parallel;
+
+  // each fileset is committed as a whole by one worker, so the files are the same as those of a serial commit
+  commitRounds("vnode1", 1, 1, &serial);
+  commitRounds("vnode2", 1, 4, &parallel);
+  ASSERT_EQ(serial.size(), nFSet);
+  ASSERT_EQ(serial, parallel);
+}
+
+TEST_F(TsdbCommitTest, parallelCommitToStt) {
+  std::vector<FSetLayout> serial, parallel;
+
+  commitRounds("vnode1", 4, 1, &serial);
+  commitRounds("vnode2", 4, 4, &parallel);
+  ASSERT_EQ(serial.size(), nFSet);
+  ASSERT_EQ(serial, parallel);
+  ASSERT_EQ(std::get<3>(parallel[0]).size(), 3);
+}
+
+TEST_F(TsdbCommitTest, moreThreadsThanFSets) {
+  tsTsdbCommitThreads = 16;
+  openVnode("vnode1", 2);
+  insertRound(0);
+  commit();
+  checkData(NULL);
+  tsTsdbCommitThreads = 4;
+}
+
+TEST_F(TsdbCommitTest, readAheadAcrossBlocksAndFiles) {
+  int32_t readAheadBlocks = tsTsdbReadAheadBlocks;
+
+  // each table has a few data blocks in each of the filesets
+  openVnode("vnode1", 1);
+  for (int32_t round = 0; round < 3; round++) {
+    insertRound(round);
+    commit();
+  }
+  pVnode->state.applied = version;
+
+  for (int32_t order : {TSDB_ORDER_ASC, TSDB_ORDER_DESC}) {
+    std::vector<std::tuple<tb_uid_t, TSKEY, int32_t>> base;
+    tsTsdbReadAheadBlocks = 0;
+    scanData(order, base);
+
+    ASSERT_EQ(base.size(), expect.size());
+    for (auto &row : base) {
+      auto it = expect.find({std::get<0>(row), std::get<1>(row)});
+      ASSERT_NE(it, expect.end());
+      ASSERT_EQ(std::get<2>(row), it->second.second);
+    }
+
+    // the read-ahead window ends within a block, at the last block of a table and past the last block of a file
+    for (int32_t nBlock : {1, 2, 5, 1024}) {
+      std::vector<std::tuple<tb_uid_t, TSKEY, int32_t>> rows;
+      tsTsdbReadAheadBlocks = nBlock;
+      scanData(order, rows);
+      ASSERT_EQ(rows, base) << "order:" << order << " readAheadBlocks:" << nBlock;
+    }
+  }
+
+  tsTsdbReadAheadBlocks = readAheadBlocks;
+}
+
+TEST_F(TsdbCommitTest, compactMergesStt) {
+  openVnode("vnode1", 8);
+  for (int32_t round = 0; round < 3; round++) {
+    insertRound(round);
+    commit();
+  }
+  checkSttCount(3);
+
+  // the stt files of each set are merged into the data file
+  ASSERT_EQ(tsdbCompact(pVnode->pTsdb, ++commitID, 1), 0);
+  checkSttCount(1);
+  checkData(NULL);
+  checkScan();
+
+  // and the next commit goes on with stt files after the compacted ones
+  insertRound(3);
+  commit();
+  checkSttCount(2);
+  checkData(NULL);
+  checkScan();
+}
+
+TEST_F(TsdbCommitTest, compactBesideCommit) {
+  openVnode("vnode1", 8);
+  for (int32_t round = 0; round < 3; round++) {
+    insertRound(round);
+    commit();
+  }
+
+  // the compaction holds canCommit only to apply a set, a commit goes on meanwhile and loses no row
+  int64_t     compactID = ++commitID;
+  int32_t     compactCode = -1;
+  std::thread compactor([&]() { compactCode = tsdbCompact(pVnode->pTsdb, compactID, 1); });
+  insertRound(3);
+  commit();
+  compactor.join();
+  ASSERT_EQ(compactCode, 0);
+  checkData(NULL);
+  checkScan();
+
+  // a set whose data file the commit wrote to is left as the commit wrote it, the next compaction takes it
+  ASSERT_EQ(tsdbCompact(pVnode->pTsdb, ++commitID, 1), 0);
+  checkSttCount(1);
+  checkData(NULL);
+  checkScan();
+}
+
+#if defined(LINUX)
+TEST_F(TsdbCommitTest, commitThreadKeepsName) {
+  char name[32] = {0};
+
+  // the workers besides the commit task come from the fileset pool, the commit task is not renamed
+  prctl(PR_SET_NAME, "commit-test");
+  openVnode("vnode1", 4);
+  insertRound(0);
+  commit();
+  checkData(NULL);
+
+  prctl(PR_GET_NAME, name);
+  ASSERT_STREQ(name, "commit-test");
+}
+#endif
+
+#pragma GCC diagnostic pop
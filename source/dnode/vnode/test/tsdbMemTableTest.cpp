@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <taoserror.h>
+#include <tglobal.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+#include "tsdb.h"
+#include "vnd.h"
+
+namespace {
+
+const char    *testDir = TD_TMP_DIR_PATH "tsdbMemTableTest";
+const tb_uid_t tbUid = 10001;
+const int32_t  szStr = 1100;
+
+struct Row {
+  TSKEY   ts;
+  int64_t version;
+  int32_t c1;
+};
+
+class TsdbMemTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memChunkRows = tsTsdbMemChunkRows;
+    tsTsdbMemChunkRows = 100;
+
+    taosRemoveDir(testDir);
+    taosMkDir(testDir);
+
+    pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(SVnode));
+    pVnode->path = (char *)testDir;
+    pVnode->config.vgId = 1;
+    pVnode->config.szPage = 4096;
+    pVnode->config.szCache = 256;
+    pVnode->config.szBuf = 64 * 1024 * 1024;
+    pVnode->config.tsdbCfg.slLevel = 5;
+    taosThreadMutexInit(&pVnode->mutex, NULL);
+    taosThreadCondInit(&pVnode->poolNotEmpty, NULL);
+    ASSERT_EQ(metaOpen(pVnode, &pVnode->pMeta, 0), 0);
+    ASSERT_EQ(vnodeOpenBufPool(pVnode), 0);
+    pVnode->inUse = pVnode->pPool;
+    pVnode->inUse->nRef = 1;
+    pVnode->pPool = pVnode->inUse->next;
+    pVnode->inUse->next = NULL;
+    ASSERT_EQ(metaBegin(pVnode->pMeta, META_BEGIN_HEAP_OS), 0);
+
+    // create table t (ts timestamp, c1 int, c2 varchar(szStr))
+    SSchema aSchema[3] = {{.type = TSDB_DATA_TYPE_TIMESTAMP, .colId = 1, .bytes = 8, .name = "ts"},
+                          {.type = TSDB_DATA_TYPE_INT, .colId = 2, .bytes = 4, .name = "c1"},
+                          {.type = TSDB_DATA_TYPE_VARCHAR, .colId = 3, .bytes = szStr + VARSTR_HEADER_SIZE, .name = "c2"}};
+    SVCreateTbReq req = {0};
+    req.name = "t";
+    req.uid = tbUid;
+    req.type = TSDB_NORMAL_TABLE;
+    req.ntb.schemaRow = (SSchemaWrapper){.nCols = 3, .version = 1, .pSchema = aSchema};
+    ASSERT_EQ(metaCreateTable(pVnode->pMeta, ++version, &req, NULL), 0);
+    ASSERT_EQ(metaGetTbTSchemaEx(pVnode->pMeta, 0, tbUid, 1, &pTSchema), 0);
+
+    pTsdb = (STsdb *)taosMemoryCalloc(1, sizeof(STsdb));
+    pTsdb->pVnode = pVnode;
+    ASSERT_EQ(tsdbMemTableCreate(pTsdb, &pTsdb->mem), 0);
+  }
+
+  void TearDown() override {
+    tsdbMemTableDestroy(pTsdb->mem);
+    taosMemoryFree(pTsdb);
+    tDestroyTSchema(pTSchema);
+    metaClose(pVnode->pMeta);
+    vnodeCloseBufPool(pVnode);
+    taosThreadCondDestroy(&pVnode->poolNotEmpty);
+    taosThreadMutexDestroy(&pVnode->mutex);
+    taosMemoryFree(pVnode);
+    taosRemoveDir(testDir);
+
+    tsTsdbMemChunkRows = memChunkRows;
+  }
+
+  static int32_t valueOf(TSKEY ts, int64_t version) { return (int32_t)(ts * 7 + version); }
+
+  // insert rows of the given timestamps as one submit block
+  void insert(const std::vector<TSKEY> &aTs, int32_t szVal = 8) {
+    std::vector<STSRow *> aRow;
+    int32_t               dataLen = 0;
+    char                  str[szStr] = {0};
+
+    version++;
+    memset(str, 'a', szVal);
+    for (TSKEY ts : aTs) {
+      SArray *aColVal = taosArrayInit(3, sizeof(SColVal));
+      SColVal cv = COL_VAL_VALUE(1, TSDB_DATA_TYPE_TIMESTAMP, (SValue){.val = ts});
+      taosArrayPush(aColVal, &cv);
+      cv = COL_VAL_VALUE(2, TSDB_DATA_TYPE_INT, (SValue){.val = valueOf(ts, version)});
+      taosArrayPush(aColVal, &cv);
+      SValue sv = {0};
+      sv.nData = szVal;
+      sv.pData = (uint8_t *)str;
+      cv = COL_VAL_VALUE(3, TSDB_DATA_TYPE_VARCHAR, sv);
+      taosArrayPush(aColVal, &cv);
+
+      STSRow *pRow = NULL;
+      ASSERT_EQ(tdSTSRowNew(aColVal, pTSchema, &pRow), 0);
+      taosArrayDestroy(aColVal);
+      aRow.push_back(pRow);
+      dataLen += TD_ROW_LEN(pRow);
+    }
+
+    SSubmitBlk *pBlock = (SSubmitBlk *)taosMemoryCalloc(1, sizeof(SSubmitBlk) + dataLen);
+    char       *p = pBlock->data;
+    for (STSRow *pRow : aRow) {
+      memcpy(p, pRow, TD_ROW_LEN(pRow));
+      p += TD_ROW_LEN(pRow);
+      taosMemoryFree(pRow);
+    }
+
+    SSubmitMsgIter msgIter = {0};
+    msgIter.uid = tbUid;
+    msgIter.sversion = 1;
+    msgIter.dataLen = dataLen;
+    msgIter.numOfRows = (int32_t)aTs.size();
+
+    SSubmitBlkRsp rsp = {0};
+    ASSERT_EQ(tsdbInsertTableData(pTsdb, version, &msgIter, pBlock, &rsp), 0);
+    for (TSKEY ts : aTs) {
+      expect[{ts, version}] = {ts, version, valueOf(ts, version)};
+    }
+    taosMemoryFree(pBlock);
+  }
+
+  void insertRange(TSKEY from, TSKEY to, int32_t step = 10, int32_t szVal = 8) {
+    for (TSKEY ts = from; ts < to; ts += step) {
+      std::vector<TSKEY> aTs;
+      for (TSKEY t = ts; t < TMIN(ts + step, to); t++) aTs.push_back(t);
+      insert(aTs, szVal);
+    }
+  }
+
+  STbData *tbData() { return tsdbGetTbDataFromMemTable(pTsdb->mem, 0, tbUid); }
+
+  static std::vector<Row> scan(STbDataIter *pIter, STSchema *pTSchema) {
+    std::vector<Row> rows;
+    for (TSDBROW *pRow = tsdbTbDataIterGet(pIter); pRow; pRow = tsdbTbDataIterNext(pIter) ? tsdbTbDataIterGet(pIter) : NULL) {
+      SColVal cv;
+      tsdbRowGetColVal(pRow, pTSchema, 1, &cv);
+      rows.push_back({TSDBROW_TS(pRow), TSDBROW_VERSION(pRow), (int32_t)cv.value.val});
+    }
+    return rows;
+  }
+
+  std::vector<Row> scan(TSKEY *pFrom, int8_t backward) {
+    STbDataIter *pIter = NULL;
+    TSDBKEY      from = {.version = backward ? VERSION_MAX : VERSION_MIN, .ts = pFrom ? *pFrom : 0};
+    EXPECT_EQ(tsdbTbDataIterCreate(tbData(), pFrom ? &from : NULL, backward, &pIter), 0);
+    std::vector<Row> rows = scan(pIter, pTSchema);
+    tsdbTbDataIterDestroy(pIter);
+    return rows;
+  }
+
+  // the iterator returns every version of every row inserted, in key order
+  void checkScan(TSKEY *pFrom, int8_t backward) {
+    std::vector<Row> rows = scan(pFrom, backward);
+    std::vector<Row> expectRows;
+
+    for (auto &kv : expect) {
+      if (pFrom && (backward ? kv.second.ts > *pFrom : kv.second.ts < *pFrom)) continue;
+      expectRows.push_back(kv.second);
+    }
+    if (backward) std::reverse(expectRows.begin(), expectRows.end());
+
+    ASSERT_EQ(rows.size(), expectRows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+      ASSERT_EQ(rows[i].ts, expectRows[i].ts) << "row:" << i;
+      ASSERT_EQ(rows[i].version, expectRows[i].version) << "row:" << i;
+      ASSERT_EQ(rows[i].c1, expectRows[i].c1) << "row:" << i;
+    }
+  }
+
+  static int32_t nChunk(STbData *pTbData) {
+    int32_t n = 0;
+    for (SMemChunk *pChunk = pTbData->pChunkHead; pChunk; pChunk = pChunk->next) n++;
+    return n;
+  }
+
+  int32_t   memChunkRows = 0;
+  int64_t   version = 0;
+  SVnode   *pVnode = NULL;
+  STsdb    *pTsdb = NULL;
+  STSchema *pTSchema = NULL;
+
+  std::map<std::pair<TSKEY, int64_t>, Row> expect;
+};
+
+}  // namespace
+
+TEST_F(TsdbMemTableTest, inOrderRowsGoToChunks) {
+  insertRange(1000, 1250);
+
+  STbData *pTbData = tbData();
+  ASSERT_EQ(pTbData->sl.size, 0);
+  ASSERT_EQ(pTbData->nChunkRow, 250);
+  ASSERT_EQ(tsdbGetNRowsInTbData(pTbData), 250);
+
+  // chunks are sealed when they reach tsdbMemChunkRows rows, the tail is not
+  ASSERT_EQ(nChunk(pTbData), 3);
+  ASSERT_EQ(pTbData->pChunkHead->bData.nRow, 100);
+  ASSERT_TRUE(pTbData->pChunkHead->sealed);
+  ASSERT_TRUE(pTbData->pChunkHead->next->sealed);
+  ASSERT_FALSE(pTbData->pChunkTail->sealed);
+  ASSERT_EQ(pTbData->pChunkTail->bData.nRow, 50);
+
+  checkScan(NULL, 0);
+  checkScan(NULL, 1);
+  for (TSKEY from : {0, 1000, 1099, 1100, 1175, 1249, 1250, 2000}) {
+    checkScan(&from, 0);
+    checkScan(&from, 1);
+  }
+}
+
+TEST_F(TsdbMemTableTest, readerDoesNotSealTail) {
+  insertRange(1000, 1050);
+
+  STbData     *pTbData = tbData();
+  STbDataIter *pIter = NULL;
+  ASSERT_EQ(tsdbTbDataIterCreate(pTbData, NULL, 0, &pIter), 0);
+  ASSERT_FALSE(pTbData->pChunkTail->sealed);
+  ASSERT_NE(pIter->pTailCopy, nullptr);
+
+  // rows appended after the iterator opens go to the same chunk and are not seen by the iterator
+  insertRange(1050, 1080);
+  ASSERT_EQ(nChunk(pTbData), 1);
+  ASSERT_EQ(pTbData->pChunkTail->bData.nRow, 80);
+
+  std::vector<Row> rows = scan(pIter, pTSchema);
+  ASSERT_EQ(rows.size(), 50);
+  for (size_t i = 0; i < rows.size(); i++) {
+    ASSERT_EQ(rows[i].ts, 1000 + (TSKEY)i);
+    ASSERT_EQ(rows[i].c1, valueOf(rows[i].ts, rows[i].version));
+  }
+  tsdbTbDataIterDestroy(pIter);
+
+  checkScan(NULL, 0);
+  checkScan(NULL, 1);
+}
+
+TEST_F(TsdbMemTableTest, sealOnSize) {
+  tsTsdbMemChunkRows = TSDB_MAX_MAXROWS_FBLOCK;
+
+  // rows of about 1KB, so a chunk is sealed by size long before it reaches the row limit
+  insertRange(1000, 3500, 10, 1000);
+
+  STbData *pTbData = tbData();
+  ASSERT_EQ(pTbData->nChunkRow, 2500);
+  ASSERT_GE(nChunk(pTbData), 2);
+  for (SMemChunk *pChunk = pTbData->pChunkHead; pChunk != pTbData->pChunkTail; pChunk = pChunk->next) {
+    ASSERT_TRUE(pChunk->sealed);
+    ASSERT_LT(pChunk->bData.nRow, TSDB_MAX_MAXROWS_FBLOCK);
+  }
+
+  checkScan(NULL, 0);
+  checkScan(NULL, 1);
+}
+
+TEST_F(TsdbMemTableTest, mergeWithSkiplist) {
+  insertRange(1000, 1200);
+
+  // rows not newer than the last one go to the skiplist, 1100, 1101, 1050 and 1199 are updates of rows in chunks
+  insert({1050, 1100, 1101, 1500});
+  insert({900, 1199, 1300});
+
+  STbData *pTbData = tbData();
+  ASSERT_EQ(pTbData->nChunkRow, 201);
+  ASSERT_EQ(pTbData->sl.size, 6);
+
+  checkScan(NULL, 0);
+  checkScan(NULL, 1);
+  for (TSKEY from : {0, 900, 1050, 1101, 1199, 1300, 1400, 1500, 1600}) {
+    checkScan(&from, 0);
+    checkScan(&from, 1);
+  }
+}
+
+TEST_F(TsdbMemTableTest, sealMemTable) {
+  insertRange(1000, 1050);
+
+  STbData *pTbData = tbData();
+  ASSERT_FALSE(pTbData->pChunkTail->sealed);
+
+  // readers of a memtable being committed read the tail in place
+  tsdbMemTableSeal(pTsdb->mem);
+  ASSERT_TRUE(pTbData->pChunkTail->sealed);
+
+  STbDataIter iter;
+  ASSERT_EQ(tsdbTbDataIterOpen(pTbData, NULL, 0, &iter), 0);
+  ASSERT_EQ(iter.pTailCopy, nullptr);
+  ASSERT_EQ(scan(&iter, pTSchema).size(), 50);
+  tsdbTbDataIterClose(&iter);
+}
+
+TEST_F(TsdbMemTableTest, concurrentReadWrite) {
+  const TSKEY       nRow = 5000;
+  std::atomic<bool> done(false);
+
+  insertRange(0, 10);
+
+  STbData                 *pTbData = tbData();
+  std::vector<std::thread> readers;
+  std::atomic<int64_t>     nScan(0);
+  for (int32_t i = 0; i < 4; i++) {
+    readers.emplace_back([&, i]() {
+      while (!done.load()) {
+        STbDataIter *pIter = NULL;
+        ASSERT_EQ(tsdbTbDataIterCreate(pTbData, NULL, i % 2, &pIter), 0);
+        std::vector<Row> rows = scan(pIter, pTSchema);
+        tsdbTbDataIterDestroy(pIter);
+
+        // each reader sees a prefix of the rows, in order and intact
+        ASSERT_GE(rows.size(), 10);
+        for (size_t j = 0; j < rows.size(); j++) {
+          TSKEY ts = (i % 2) ? (TSKEY)(rows.size() - 1 - j) : (TSKEY)j;
+          ASSERT_EQ(rows[j].ts, ts);
+          ASSERT_EQ(rows[j].c1, valueOf(rows[j].ts, rows[j].version));
+        }
+        nScan++;
+      }
+    });
+  }
+
+  insertRange(10, nRow, 5);
+  done = true;
+  for (auto &t : readers) t.join();
+
+  ASSERT_GT(nScan.load(), 0);
+  checkScan(NULL, 0);
+}
+
+#pragma GCC diagnostic pop
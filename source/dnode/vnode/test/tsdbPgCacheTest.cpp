@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <taoserror.h>
+#include <tglobal.h>
+#include <iostream>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+
+#include "tsdb.h"
+
+namespace {
+
+const int32_t szPage = 4096;
+const int64_t nPage = 64;
+const int64_t szData = nPage * PAGE_CONTENT_SIZE(szPage) - 100;
+
+const char *testFile = TD_TMP_DIR_PATH "tsdbPgCacheTest.data";
+
+uint8_t dataByte(int64_t offset, uint8_t seed) { return (uint8_t)(offset * 31 + seed); }
+
+class TsdbPgCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(SVnode));
+    pTsdb = (STsdb *)taosMemoryCalloc(1, sizeof(STsdb));
+    pTsdb->pVnode = pVnode;
+    ASSERT_EQ(tsdbOpenPgCache(pTsdb), 0);
+
+    // write the whole file through a writer which does not use the cache
+    writeData(0, szData, 7);
+  }
+
+  void TearDown() override {
+    tsdbClosePgCache(pTsdb);
+    taosMemoryFree(pTsdb);
+    taosMemoryFree(pVnode);
+    taosRemoveFile(testFile);
+  }
+
+  void writeData(int64_t offset, int64_t size, uint8_t seed) {
+    STsdbFD *pFD = NULL;
+    int32_t  flag = TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE;
+    if (offset == 0) flag |= TD_FILE_TRUNC;
+    ASSERT_EQ(tsdbOpenFile(pTsdb, testFile, szPage, flag, &pFD), 0);
+
+    uint8_t *pBuf = (uint8_t *)taosMemoryMalloc(size);
+    for (int64_t i = 0; i < size; i++) pBuf[i] = dataByte(offset + i, seed);
+    ASSERT_EQ(tsdbWriteFile(pFD, offset, pBuf, size), 0);
+    ASSERT_EQ(tsdbFsyncFile(pFD), 0);
+
+    taosMemoryFree(pBuf);
+    tsdbCloseFile(&pFD);
+  }
+
+  // read [offset, offset + size) with a new reader and check it against the seed of each range
+  void checkData(int64_t offset, int64_t size, int64_t sOverwrite, int64_t eOverwrite) {
+    STsdbFD *pFD = NULL;
+    ASSERT_EQ(tsdbOpenFile(pTsdb, testFile, szPage, TD_FILE_READ, &pFD), 0);
+
+    uint8_t *pBuf = (uint8_t *)taosMemoryMalloc(size);
+    ASSERT_EQ(tsdbReadFile(pFD, offset, pBuf, size), 0);
+    for (int64_t i = 0; i < size; i++) {
+      int64_t o = offset + i;
+      uint8_t seed = (o >= sOverwrite && o < eOverwrite) ? 13 : 7;
+      ASSERT_EQ(pBuf[i], dataByte(o, seed)) << "offset:" << o;
+    }
+
+    taosMemoryFree(pBuf);
+    tsdbCloseFile(&pFD);
+  }
+
+  SVnode *pVnode = NULL;
+  STsdb  *pTsdb = NULL;
+};
+
+}  // namespace
+
+TEST_F(TsdbPgCacheTest, readThroughCache) {
+  int64_t hit = 0, miss = 0;
+  size_t  usage = 0;
+
+  // the first scan misses on every cacheable page, i.e. all but the first and the last one
+  checkData(0, szData, 0, 0);
+  tsdbGetPgCacheStat(pTsdb, &hit, &miss, &usage);
+  ASSERT_EQ(hit, 0);
+  ASSERT_EQ(miss, nPage - 2);
+  ASSERT_EQ(usage, (nPage - 2) * szPage);
+
+  // the second scan is served from the cache
+  checkData(0, szData, 0, 0);
+  tsdbGetPgCacheStat(pTsdb, &hit, &miss, &usage);
+  ASSERT_EQ(hit, nPage - 2);
+  ASSERT_EQ(miss, nPage - 2);
+
+  // reads across page boundaries
+  for (int64_t offset = 1; offset < szData; offset += 5 * PAGE_CONTENT_SIZE(szPage) + 333) {
+    checkData(offset, TMIN(3 * szPage, szData - offset), 0, 0);
+  }
+}
+
+TEST_F(TsdbPgCacheTest, lookaheadNotCounted) {
+  int64_t hit = 0, miss = 0;
+  size_t  usage = 0;
+
+  // cache page 20 only
+  int64_t pgno = 20;
+  checkData((pgno - 1) * PAGE_CONTENT_SIZE(szPage) + 1, 10, 0, 0);
+  tsdbGetPgCacheStat(pTsdb, &hit, &miss, &usage);
+  ASSERT_EQ(hit, 0);
+  ASSERT_EQ(miss, 1);
+
+  // a scan reads the pages before and after it in two runs, the probes ending the first run and looking ahead in
+  // the second one are not counted, each cacheable page is counted once
+  checkData(0, szData, 0, 0);
+  tsdbGetPgCacheStat(pTsdb, &hit, &miss, &usage);
+  ASSERT_EQ(hit, 1);
+  ASSERT_EQ(miss, 1 + nPage - 3);
+  ASSERT_EQ(usage, (nPage - 2) * szPage);
+}
+
+TEST_F(TsdbPgCacheTest, rewriteErasesCachedPage) {
+  checkData(0, szData, 0, 0);
+
+  // rewrite a range in the middle of the file after its pages are cached
+  int64_t sOverwrite = 10 * PAGE_CONTENT_SIZE(szPage) + 17;
+  int64_t eOverwrite = sOverwrite + 2 * PAGE_CONTENT_SIZE(szPage);
+  writeData(sOverwrite, eOverwrite - sOverwrite, 13);
+
+  checkData(0, szData, sOverwrite, eOverwrite);
+}
+
+TEST_F(TsdbPgCacheTest, cacheDisabled) {
+  int32_t pgCacheSize = tsTsdbPageCacheSize;
+
+  tsdbClosePgCache(pTsdb);
+  tsTsdbPageCacheSize = 0;
+  ASSERT_EQ(tsdbOpenPgCache(pTsdb), 0);
+  tsTsdbPageCacheSize = pgCacheSize;
+  ASSERT_EQ(pTsdb->pgCache, nullptr);
+
+  checkData(0, szData, 0, 0);
+  checkData(szData / 2, szData / 3, 0, 0);
+
+  int64_t hit = 0, miss = 0;
+  size_t  usage = 0;
+  tsdbGetPgCacheStat(pTsdb, &hit, &miss, &usage);
+  ASSERT_EQ(hit, 0);
+  ASSERT_EQ(miss, 0);
+  ASSERT_EQ(usage, 0);
+}
+
+#pragma GCC diagnostic pop
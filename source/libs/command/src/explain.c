@@ -881,6 +881,10 @@ int32_t qExplainResNodeToRowsImpl(SExplainResNode *pResNode, SExplainCtx *ctx, i
         }
 
         EXPLAIN_ROW_APPEND("  loops:%d", pExecInfo->loops);
+        if (pExecInfo->writeBytes > 0) {
+          EXPLAIN_ROW_APPEND("  spill:%.2f Kb (raw %.2f Kb)  load:%.2f Kb", pExecInfo->writeBytes / 1024.0,
+                             pExecInfo->rawWriteBytes / 1024.0, pExecInfo->readBytes / 1024.0);
+        }
         EXPLAIN_ROW_END();
         QRY_ERR_RET(qExplainResAppendRow(ctx, tbuf, tlen, level));
       }
@@ -1235,6 +1239,10 @@ int32_t qExplainResNodeToRowsImpl(SExplainResNode *pResNode, SExplainCtx *ctx, i
         }
 
         EXPLAIN_ROW_APPEND("  loops:%d", pExecInfo->loops);
+        if (pExecInfo->writeBytes > 0) {
+          EXPLAIN_ROW_APPEND("  spill:%.2f Kb (raw %.2f Kb)  load:%.2f Kb", pExecInfo->writeBytes / 1024.0,
+                             pExecInfo->rawWriteBytes / 1024.0, pExecInfo->readBytes / 1024.0);
+        }
         EXPLAIN_ROW_END();
         QRY_ERR_RET(qExplainResAppendRow(ctx, tbuf, tlen, level));
       }
@@ -1449,6 +1457,10 @@ int32_t qExplainResNodeToRowsImpl(SExplainResNode *pResNode, SExplainCtx *ctx, i
         }
 
         EXPLAIN_ROW_APPEND("  loops:%d", pExecInfo->loops);
+        if (pExecInfo->writeBytes > 0) {
+          EXPLAIN_ROW_APPEND("  spill:%.2f Kb (raw %.2f Kb)  load:%.2f Kb", pExecInfo->writeBytes / 1024.0,
+                             pExecInfo->rawWriteBytes / 1024.0, pExecInfo->readBytes / 1024.0);
+        }
         EXPLAIN_ROW_END();
         QRY_ERR_RET(qExplainResAppendRow(ctx, tbuf, tlen, level));
       }
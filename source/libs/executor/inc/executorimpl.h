@@ -408,6 +408,21 @@ typedef struct SPartitionBySupporter {
   bool    needCalc;       // partition by column
 } SPartitionBySupporter;
 
+// Per block scratch space of the vectorized group by, reused across blocks.
+typedef struct SGroupKeyBatch {
+  int32_t      capacity;     // max rows the buffers can hold
+  int32_t      numOfSlots;   // size of the open addressing table, power of 2
+  char*        pKeys;        // group keys of each row, strided by groupKeyLen
+  int32_t*     pKeyLen;      // actual length of each group key
+  uint32_t*    pHash;        // hash value of each group key
+  int32_t*     pGroupOfRow;  // group index of each row
+  int32_t*     pGroupFirst;  // first row of each group, also used as the group representative
+  int32_t*     pGroupOffset; // number of rows of each group, then start position in pSelect
+  int32_t*     pSelect;      // selection vector, row index ordered by group
+  int32_t*     pSlots;       // open addressing hash table, group index or -1 for empty slot
+  SSDataBlock* pGather;      // rows of current block gathered by group
+} SGroupKeyBatch;
+
 typedef struct SPartitionDataInfo {
   uint64_t groupId;
   char*    tbname;
@@ -843,6 +858,12 @@ int32_t finalizeResultRows(SDiskbasedBuf* pBuf, SResultRowPosition* resultRowPos
                            SSDataBlock* pBlock, SExecTaskInfo* pTaskInfo);
 
 bool    groupbyTbname(SNodeList* pGroupList);
+
+void    destroyGroupKeyBatch(SGroupKeyBatch* pBatch);
+int32_t ensureGroupKeyBatchCapacity(SGroupKeyBatch* pBatch, int32_t rows, int32_t keyLen);
+bool    buildGroupKeyBatch(SArray* pGroupCols, SSDataBlock* pBlock, SGroupKeyBatch* pBatch, int32_t keyLen);
+int32_t assignGroupOfRows(SGroupKeyBatch* pBatch, int32_t rows, int32_t keyLen, int32_t* numOfGroups);
+void    buildGroupSelectVector(SGroupKeyBatch* pBatch, int32_t rows, int32_t numOfGroups);
 int32_t buildDataBlockFromGroupRes(SOperatorInfo* pOperator, SStreamState* pState, SSDataBlock* pBlock, SExprSupp* pSup,
                                    SGroupResInfo* pGroupResInfo);
 int32_t saveSessionDiscBuf(SStreamState* pState, SSessionKey* key, void* buf, int32_t size);
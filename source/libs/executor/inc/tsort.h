@@ -108,6 +108,14 @@ int32_t tsortSetComparFp(SSortHandle* pHandle, _sort_merge_compar_fn_t fp);
  */
 int32_t tsortSetCompareGroupId(SSortHandle* pHandle, bool compareGroupId);
 
+/**
+ * keep only the first maxRows rows of the sorted result, which are selected by a bounded heap without spilling to disk
+ * @param pHandle
+ * @param maxRows
+ * @return
+ */
+int32_t tsortSetMaxRows(SSortHandle* pHandle, int64_t maxRows);
+
 /**
  *
  * @param pHandle
@@ -60,6 +60,23 @@ typedef struct SDataDispatchHandle {
 // The length of bitmap is decided by number of rows of this data block, and the length of each column data is
 // recorded in the first segment, next to the struct header
 // clang-format on
+// If any column of the block is larger than compressColData, the column data is compressed with the codec of its type,
+// see blockCompressEncode.
+static bool needCompress(const SSDataBlock* pData, int32_t numOfCols) {
+  if (tsCompressColData < 0) {
+    return false;
+  }
+
+  for (int32_t col = 0; col < numOfCols; ++col) {
+    SColumnInfoData* pColRes = taosArrayGet(pData->pDataBlock, col);
+    if (colDataGetLength(pColRes, pData->info.rows) >= tsCompressColData) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 static void toDataCacheEntry(SDataDispatchHandle* pHandle, const SInputData* pInput, SDataDispatchBuf* pBuf) {
   int32_t numOfCols = 0;
   SNode*  pNode;
@@ -70,13 +87,19 @@ static void toDataCacheEntry(SDataDispatchHandle* pHandle, const SInputData* pIn
     }
   }
   SDataCacheEntry* pEntry = (SDataCacheEntry*)pBuf->pData;
-  pEntry->compressed = 0;
+  // compressColData may be altered after the buffer was allocated
+  pEntry->compressed = needCompress(pInput->pData, numOfCols) &&
+                       pBuf->allocSize >= sizeof(SDataCacheEntry) + blockGetCompressEncodeSize(pInput->pData);
   pEntry->numOfRows = pInput->pData->info.rows;
   pEntry->numOfCols = numOfCols;
   pEntry->dataLen = 0;
 
   pBuf->useSize = sizeof(SDataCacheEntry);
-  pEntry->dataLen = blockEncode(pInput->pData, pEntry->data, numOfCols);
+  if (pEntry->compressed) {
+    pEntry->dataLen = blockCompressEncode(pInput->pData, pEntry->data, numOfCols);
+  } else {
+    pEntry->dataLen = blockEncode(pInput->pData, pEntry->data, numOfCols);
+  }
 //  ASSERT(pEntry->numOfRows == *(int32_t*)(pEntry->data + 8));
 //  ASSERT(pEntry->numOfCols == *(int32_t*)(pEntry->data + 8 + 4));
 
@@ -96,7 +119,11 @@ static bool allocBuf(SDataDispatchHandle* pDispatcher, const SInputData* pInput,
     }
   */
 
-  pBuf->allocSize = sizeof(SDataCacheEntry) + blockGetEncodeSize(pInput->pData);
+  if (tsCompressColData < 0) {
+    pBuf->allocSize = sizeof(SDataCacheEntry) + blockGetEncodeSize(pInput->pData);
+  } else {
+    pBuf->allocSize = sizeof(SDataCacheEntry) + blockGetCompressEncodeSize(pInput->pData);
+  }
 
   pBuf->pData = taosMemoryMalloc(pBuf->allocSize);
   if (pBuf->pData == NULL) {
@@ -480,6 +480,9 @@ int32_t extractDataBlockFromFetchRsp(SSDataBlock* pRes, char* pData, SArray* pCo
   if (pColList == NULL) {  // data from other sources
     blockDataCleanup(pRes);
     *pNextStart = (char*)blockDecode(pRes, pData);
+    if (*pNextStart == NULL) {
+      return terrno;
+    }
   } else {  // extract data according to pColList
     char* pStart = pData;
 
@@ -27,6 +27,14 @@
 #include "thash.h"
 #include "ttypes.h"
 
+#define GROUPBY_PREFETCH_DISTANCE 8
+
+#if defined(WINDOWS)
+#define GROUPBY_PREFETCH(_p) _mm_prefetch((const char*)(_p), _MM_HINT_T0)
+#else
+#define GROUPBY_PREFETCH(_p) __builtin_prefetch((_p), 0, 3)
+#endif
+
 typedef struct SGroupbyOperatorInfo {
   SOptrBasicInfo binfo;
   SAggSupporter  aggSup;
@@ -37,6 +45,7 @@ typedef struct SGroupbyOperatorInfo {
   int32_t        groupKeyLen;    // total group by column width
   SGroupResInfo  groupResInfo;
   SExprSupp      scalarSup;
+  SGroupKeyBatch keyBatch;
 } SGroupbyOperatorInfo;
 
 // The sort in partition may be needed later.
@@ -63,6 +72,20 @@ static int32_t  setGroupResultOutputBuf(SOperatorInfo* pOperator, SOptrBasicInfo
                                         int16_t bytes, uint64_t groupId, SDiskbasedBuf* pBuf, SAggSupporter* pAggSup);
 static SArray*  extractColumnInfo(SNodeList* pNodeList);
 
+void destroyGroupKeyBatch(SGroupKeyBatch* pBatch) {
+  taosMemoryFreeClear(pBatch->pKeys);
+  taosMemoryFreeClear(pBatch->pKeyLen);
+  taosMemoryFreeClear(pBatch->pHash);
+  taosMemoryFreeClear(pBatch->pGroupOfRow);
+  taosMemoryFreeClear(pBatch->pGroupFirst);
+  taosMemoryFreeClear(pBatch->pGroupOffset);
+  taosMemoryFreeClear(pBatch->pSelect);
+  taosMemoryFreeClear(pBatch->pSlots);
+  pBatch->pGather = blockDataDestroy(pBatch->pGather);
+  pBatch->capacity = 0;
+  pBatch->numOfSlots = 0;
+}
+
 static void freeGroupKey(void* param) {
   SGroupKeys* pKey = (SGroupKeys*)param;
   taosMemoryFree(pKey->pData);
@@ -79,6 +102,7 @@ static void destroyGroupOperatorInfo(void* param) {
   taosArrayDestroy(pInfo->pGroupCols);
   taosArrayDestroyEx(pInfo->pGroupColVals, freeGroupKey);
   cleanupExprSupp(&pInfo->scalarSup);
+  destroyGroupKeyBatch(&pInfo->keyBatch);
 
   cleanupGroupResInfo(&pInfo->groupResInfo);
   cleanupAggSup(&pInfo->aggSup);
@@ -338,6 +362,291 @@ static void doHashGroupbyAgg(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
   }
 }
 
+int32_t ensureGroupKeyBatchCapacity(SGroupKeyBatch* pBatch, int32_t rows, int32_t keyLen) {
+  if (rows <= pBatch->capacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  destroyGroupKeyBatch(pBatch);
+
+  int32_t numOfSlots = 16;
+  while (numOfSlots < rows * 2) {
+    numOfSlots <<= 1;
+  }
+
+  pBatch->pKeys = taosMemoryMalloc((int64_t)rows * keyLen);
+  pBatch->pKeyLen = taosMemoryMalloc(rows * sizeof(int32_t));
+  pBatch->pHash = taosMemoryMalloc(rows * sizeof(uint32_t));
+  pBatch->pGroupOfRow = taosMemoryMalloc(rows * sizeof(int32_t));
+  pBatch->pGroupFirst = taosMemoryMalloc(rows * sizeof(int32_t));
+  pBatch->pGroupOffset = taosMemoryMalloc(rows * sizeof(int32_t));
+  pBatch->pSelect = taosMemoryMalloc(rows * sizeof(int32_t));
+  pBatch->pSlots = taosMemoryMalloc(numOfSlots * sizeof(int32_t));
+  if (pBatch->pKeys == NULL || pBatch->pKeyLen == NULL || pBatch->pHash == NULL || pBatch->pGroupOfRow == NULL ||
+      pBatch->pGroupFirst == NULL || pBatch->pGroupOffset == NULL || pBatch->pSelect == NULL ||
+      pBatch->pSlots == NULL) {
+    destroyGroupKeyBatch(pBatch);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pBatch->capacity = rows;
+  pBatch->numOfSlots = numOfSlots;
+  return TSDB_CODE_SUCCESS;
+}
+
+// Build the group keys of all rows column by column, in the same layout as buildGroupKeys, so that the result rows
+// found by the batch path and by the row-by-row path are identical.
+bool buildGroupKeyBatch(SArray* pGroupCols, SSDataBlock* pBlock, SGroupKeyBatch* pBatch, int32_t keyLen) {
+  int32_t numOfGroupCols = taosArrayGetSize(pGroupCols);
+  int32_t rows = pBlock->info.rows;
+
+  for (int32_t j = 0; j < rows; ++j) {
+    pBatch->pKeyLen[j] = sizeof(int8_t) * numOfGroupCols;
+  }
+
+  for (int32_t i = 0; i < numOfGroupCols; ++i) {
+    SColumn*         pCol = taosArrayGet(pGroupCols, i);
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pCol->slotId);
+    if (pColInfoData->info.type == TSDB_DATA_TYPE_JSON) {
+      return false;
+    }
+
+    char* pKey = pBatch->pKeys;
+    if (IS_VAR_DATA_TYPE(pColInfoData->info.type)) {
+      for (int32_t j = 0; j < rows; ++j, pKey += keyLen) {
+        if (colDataIsNull_var(pColInfoData, j)) {
+          pKey[i] = 1;
+          continue;
+        }
+
+        char* val = colDataGetVarData(pColInfoData, j);
+        pKey[i] = 0;
+        varDataCopy(pKey + pBatch->pKeyLen[j], val);
+        pBatch->pKeyLen[j] += varDataTLen(val);
+      }
+    } else {
+      int32_t bytes = pColInfoData->info.bytes;
+      for (int32_t j = 0; j < rows; ++j, pKey += keyLen) {
+        if (colDataIsNull_s(pColInfoData, j)) {
+          pKey[i] = 1;
+          continue;
+        }
+
+        pKey[i] = 0;
+        memcpy(pKey + pBatch->pKeyLen[j], pColInfoData->pData + j * bytes, bytes);
+        pBatch->pKeyLen[j] += bytes;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Assign a group index to each row by probing a per-block open addressing table. Hash values are computed for the
+// whole block first, so the slot of a row a few positions ahead can be prefetched while the current row is probed.
+// Return the number of runs, i.e., contiguous rows that belong to the same group.
+int32_t assignGroupOfRows(SGroupKeyBatch* pBatch, int32_t rows, int32_t keyLen, int32_t* numOfGroups) {
+  for (int32_t j = 0; j < rows; ++j) {
+    pBatch->pHash[j] = MurmurHash3_32(pBatch->pKeys + (int64_t)j * keyLen, pBatch->pKeyLen[j]);
+  }
+
+  uint32_t mask = pBatch->numOfSlots - 1;
+  memset(pBatch->pSlots, 0xFF, pBatch->numOfSlots * sizeof(int32_t));
+
+  int32_t groups = 0;
+  int32_t runs = 0;
+  for (int32_t j = 0; j < rows; ++j) {
+    if (j + GROUPBY_PREFETCH_DISTANCE < rows) {
+      GROUPBY_PREFETCH(&pBatch->pSlots[pBatch->pHash[j + GROUPBY_PREFETCH_DISTANCE] & mask]);
+    }
+
+    uint32_t hash = pBatch->pHash[j];
+    char*    pKey = pBatch->pKeys + (int64_t)j * keyLen;
+    uint32_t slot = hash & mask;
+    while (1) {
+      int32_t g = pBatch->pSlots[slot];
+      if (g == -1) {
+        g = groups++;
+        pBatch->pSlots[slot] = g;
+        pBatch->pGroupFirst[g] = j;
+        pBatch->pGroupOffset[g] = 0;
+        pBatch->pGroupOfRow[j] = g;
+        break;
+      }
+
+      int32_t first = pBatch->pGroupFirst[g];
+      if (pBatch->pHash[first] == hash && pBatch->pKeyLen[first] == pBatch->pKeyLen[j] &&
+          memcmp(pBatch->pKeys + (int64_t)first * keyLen, pKey, pBatch->pKeyLen[j]) == 0) {
+        pBatch->pGroupOfRow[j] = g;
+        break;
+      }
+
+      slot = (slot + 1) & mask;
+    }
+
+    pBatch->pGroupOffset[pBatch->pGroupOfRow[j]] += 1;
+    if (j == 0 || pBatch->pGroupOfRow[j] != pBatch->pGroupOfRow[j - 1]) {
+      runs += 1;
+    }
+  }
+
+  *numOfGroups = groups;
+  return runs;
+}
+
+// Stable counting sort of the rows by group. Afterwards pSelect holds the row indexes ordered by group, and
+// pGroupOffset[g] points to the end of group g in pSelect.
+void buildGroupSelectVector(SGroupKeyBatch* pBatch, int32_t rows, int32_t numOfGroups) {
+  int32_t offset = 0;
+  for (int32_t g = 0; g < numOfGroups; ++g) {
+    int32_t num = pBatch->pGroupOffset[g];
+    pBatch->pGroupOffset[g] = offset;
+    offset += num;
+  }
+
+  for (int32_t j = 0; j < rows; ++j) {
+    pBatch->pSelect[pBatch->pGroupOffset[pBatch->pGroupOfRow[j]]++] = j;
+  }
+}
+
+static int32_t gatherGroupRows(SGroupKeyBatch* pBatch, SSDataBlock* pBlock) {
+  if (pBatch->pGather == NULL) {
+    pBatch->pGather = createOneDataBlock(pBlock, false);
+    if (pBatch->pGather == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    // the tags belong to the source block
+    pBatch->pGather->info.pTag = NULL;
+  }
+
+  SSDataBlock* pDst = pBatch->pGather;
+  blockDataCleanup(pDst);
+  int32_t code = blockDataEnsureCapacity(pDst, pBlock->info.rows);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  int32_t rows = pBlock->info.rows;
+  size_t  numOfCols = taosArrayGetSize(pBlock->pDataBlock);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pSrc = taosArrayGet(pBlock->pDataBlock, i);
+    SColumnInfoData* pDstCol = taosArrayGet(pDst->pDataBlock, i);
+
+    if (IS_VAR_DATA_TYPE(pSrc->info.type)) {
+      for (int32_t j = 0; j < rows; ++j) {
+        int32_t index = pBatch->pSelect[j];
+        if (colDataIsNull_var(pSrc, index)) {
+          colDataAppendNULL(pDstCol, j);
+          continue;
+        }
+
+        code = colDataAppend(pDstCol, j, colDataGetVarData(pSrc, index), false);
+        if (code != TSDB_CODE_SUCCESS) {
+          return code;
+        }
+      }
+    } else {
+      int32_t bytes = pSrc->info.bytes;
+      for (int32_t j = 0; j < rows; ++j) {
+        int32_t index = pBatch->pSelect[j];
+        if (colDataIsNull_s(pSrc, index)) {
+          colDataAppendNULL(pDstCol, j);
+          continue;
+        }
+
+        memcpy(pDstCol->pData + j * bytes, pSrc->pData + index * bytes, bytes);
+      }
+    }
+  }
+
+  pDst->info.rows = rows;
+  pDst->info.id = pBlock->info.id;
+  pDst->info.window = pBlock->info.window;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void doAggregateOneGroup(SOperatorInfo* pOperator, SSDataBlock* pBlock, char* pKey, int32_t keyLen,
+                                int32_t rowIndex, int32_t num) {
+  SExecTaskInfo*        pTaskInfo = pOperator->pTaskInfo;
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+  SqlFunctionCtx*       pCtx = pOperator->exprSupp.pCtx;
+
+  int32_t ret = setGroupResultOutputBuf(pOperator, &(pInfo->binfo), pOperator->exprSupp.numOfExprs, pKey, keyLen,
+                                        pBlock->info.id.groupId, pInfo->aggSup.pResultBuf, &pInfo->aggSup);
+  if (ret != TSDB_CODE_SUCCESS) {
+    T_LONG_JMP(pTaskInfo->env, TSDB_CODE_APP_ERROR);
+  }
+
+  applyAggFunctionOnPartialTuples(pTaskInfo, pCtx, NULL, rowIndex, num, pBlock->info.rows,
+                                  pOperator->exprSupp.numOfExprs);
+  doAssignGroupKeys(pCtx, pOperator->exprSupp.numOfExprs, pBlock->info.rows, rowIndex);
+}
+
+// Vectorized version of doHashGroupbyAgg. The group keys of the whole block are built and hashed in batch, and rows
+// are assigned to groups via an open addressing table. The aggregate functions only accept a contiguous range of
+// rows, so when the rows of a group are scattered across the block, they are gathered by a stable counting sort
+// (the selection vector) into a scratch block first. Each group is then aggregated exactly once per block.
+// Return false if the block can not be handled by the batch path, e.g., group by json tags.
+static bool doHashGroupbyAggBatch(SOperatorInfo* pOperator, SSDataBlock* pBlock, int32_t order, int32_t scanFlag) {
+  SExecTaskInfo*        pTaskInfo = pOperator->pTaskInfo;
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+  SGroupKeyBatch*       pBatch = &pInfo->keyBatch;
+
+  int32_t rows = pBlock->info.rows;
+  if (rows == 0 || pBlock->pBlockAgg != NULL) {
+    return false;
+  }
+
+  int32_t keyLen = pInfo->groupKeyLen;
+  if (ensureGroupKeyBatchCapacity(pBatch, rows, keyLen) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  if (!buildGroupKeyBatch(pInfo->pGroupCols, pBlock, pBatch, keyLen)) {
+    return false;
+  }
+
+  int32_t numOfGroups = 0;
+  int32_t runs = assignGroupOfRows(pBatch, rows, keyLen, &numOfGroups);
+
+  // the rows of each group are already contiguous, aggregate them in place
+  if (runs == numOfGroups) {
+    int32_t start = 0;
+    for (int32_t j = 1; j <= rows; ++j) {
+      if (j == rows || pBatch->pGroupOfRow[j] != pBatch->pGroupOfRow[start]) {
+        char* pKey = pBatch->pKeys + (int64_t)start * keyLen;
+        doAggregateOneGroup(pOperator, pBlock, pKey, pBatch->pKeyLen[start], start, j - start);
+        start = j;
+      }
+    }
+
+    pInfo->isInit = false;
+    return true;
+  }
+
+  buildGroupSelectVector(pBatch, rows, numOfGroups);
+
+  int32_t code = gatherGroupRows(pBatch, pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    T_LONG_JMP(pTaskInfo->env, code);
+  }
+
+  SSDataBlock* pGather = pBatch->pGather;
+  setInputDataBlock(&pOperator->exprSupp, pGather, order, scanFlag, true);
+
+  // pGroupOffset[g] now points to the end of group g in the selection vector
+  int32_t start = 0;
+  for (int32_t g = 0; g < numOfGroups; ++g) {
+    char* pKey = pBatch->pKeys + (int64_t)pBatch->pGroupFirst[g] * keyLen;
+    doAggregateOneGroup(pOperator, pGather, pKey, pBatch->pKeyLen[pBatch->pGroupFirst[g]], start,
+                        pBatch->pGroupOffset[g] - start);
+    start = pBatch->pGroupOffset[g];
+  }
+
+  pInfo->isInit = false;
+  return true;
+}
+
 static SSDataBlock* buildGroupResultDataBlock(SOperatorInfo* pOperator) {
   SGroupbyOperatorInfo* pInfo = pOperator->info;
 
@@ -401,7 +710,9 @@ static SSDataBlock* hashGroupbyAggregate(SOperatorInfo* pOperator) {
       }
     }
 
-    doHashGroupbyAgg(pOperator, pBlock);
+    if (!doHashGroupbyAggBatch(pOperator, pBlock, order, scanFlag)) {
+      doHashGroupbyAgg(pOperator, pBlock);
+    }
   }
 
   pOperator->status = OP_RES_TO_RETURN;
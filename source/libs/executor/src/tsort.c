@@ -56,6 +56,9 @@ struct SSortHandle {
   _sort_fetch_block_fn_t  fetchfp;
   _sort_merge_compar_fn_t comparFn;
   SMultiwayMergeTreeInfo* pMergeTree;
+
+  int64_t maxRows;  // only the first maxRows rows are kept if greater than 0
+  SArray* pHeap;    // SArray<int32_t>, max heap of the row index of pDataBlock, the last kept row on top
 };
 
 static int32_t msortComparFn(const void* pLeft, const void* pRight, void* param);
@@ -149,6 +152,7 @@ void tsortDestroySortHandle(SSortHandle* pSortHandle) {
 
   tsortClearOrderdSource(pSortHandle->pOrderedSource);
   taosArrayDestroy(pSortHandle->pOrderedSource);
+  taosArrayDestroy(pSortHandle->pHeap);
   taosMemoryFreeClear(pSortHandle);
 }
 
@@ -418,35 +422,8 @@ static SSDataBlock* getSortedBlockDataInner(SSortHandle* pHandle, SMsortComparPa
   return (pHandle->pDataBlock->info.rows > 0) ? pHandle->pDataBlock : NULL;
 }
 
-int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
-  int32_t pLeftIdx = *(int32_t*)pLeft;
-  int32_t pRightIdx = *(int32_t*)pRight;
-
-  SMsortComparParam* pParam = (SMsortComparParam*)param;
-
-  SArray* pInfo = pParam->orderInfo;
-
-  SSortSource* pLeftSource = pParam->pSources[pLeftIdx];
-  SSortSource* pRightSource = pParam->pSources[pRightIdx];
-
-  // this input is exhausted, set the special value to denote this
-  if (pLeftSource->src.rowIndex == -1) {
-    return 1;
-  }
-
-  if (pRightSource->src.rowIndex == -1) {
-    return -1;
-  }
-
-  SSDataBlock* pLeftBlock = pLeftSource->src.pBlock;
-  SSDataBlock* pRightBlock = pRightSource->src.pBlock;
-
-  if (pParam->cmpGroupId) {
-    if (pLeftBlock->info.id.groupId != pRightBlock->info.id.groupId) {
-      return pLeftBlock->info.id.groupId < pRightBlock->info.id.groupId ? -1 : 1;
-    }
-  }
-
+static int32_t tsortComparRow(SArray* pInfo, const SSDataBlock* pLeftBlock, int32_t leftIndex,
+                              const SSDataBlock* pRightBlock, int32_t rightIndex) {
   for (int32_t i = 0; i < pInfo->size; ++i) {
     SBlockOrderInfo* pOrder = TARRAY_GET_ELEM(pInfo, i);
     SColumnInfoData* pLeftColInfoData = TARRAY_GET_ELEM(pLeftBlock->pDataBlock, pOrder->slotId);
@@ -454,10 +431,9 @@ int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
     bool leftNull = false;
     if (pLeftColInfoData->hasNull) {
       if (pLeftBlock->pBlockAgg == NULL) {
-        leftNull = colDataIsNull_s(pLeftColInfoData, pLeftSource->src.rowIndex);
+        leftNull = colDataIsNull_s(pLeftColInfoData, leftIndex);
       } else {
-        leftNull =
-            colDataIsNull(pLeftColInfoData, pLeftBlock->info.rows, pLeftSource->src.rowIndex, pLeftBlock->pBlockAgg[i]);
+        leftNull = colDataIsNull(pLeftColInfoData, pLeftBlock->info.rows, leftIndex, pLeftBlock->pBlockAgg[i]);
       }
     }
 
@@ -465,10 +441,9 @@ int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
     bool             rightNull = false;
     if (pRightColInfoData->hasNull) {
       if (pRightBlock->pBlockAgg == NULL) {
-        rightNull = colDataIsNull_s(pRightColInfoData, pRightSource->src.rowIndex);
+        rightNull = colDataIsNull_s(pRightColInfoData, rightIndex);
       } else {
-        rightNull = colDataIsNull(pRightColInfoData, pRightBlock->info.rows, pRightSource->src.rowIndex,
-                                  pRightBlock->pBlockAgg[i]);
+        rightNull = colDataIsNull(pRightColInfoData, pRightBlock->info.rows, rightIndex, pRightBlock->pBlockAgg[i]);
       }
     }
 
@@ -484,8 +459,8 @@ int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
       return pOrder->nullFirst ? -1 : 1;
     }
 
-    void* left1 = colDataGetData(pLeftColInfoData, pLeftSource->src.rowIndex);
-    void* right1 = colDataGetData(pRightColInfoData, pRightSource->src.rowIndex);
+    void* left1 = colDataGetData(pLeftColInfoData, leftIndex);
+    void* right1 = colDataGetData(pRightColInfoData, rightIndex);
 
     __compar_fn_t fn = getKeyComparFunc(pLeftColInfoData->info.type, pOrder->order);
 
@@ -499,6 +474,38 @@ int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
   return 0;
 }
 
+int32_t msortComparFn(const void* pLeft, const void* pRight, void* param) {
+  int32_t pLeftIdx = *(int32_t*)pLeft;
+  int32_t pRightIdx = *(int32_t*)pRight;
+
+  SMsortComparParam* pParam = (SMsortComparParam*)param;
+
+  SArray* pInfo = pParam->orderInfo;
+
+  SSortSource* pLeftSource = pParam->pSources[pLeftIdx];
+  SSortSource* pRightSource = pParam->pSources[pRightIdx];
+
+  // this input is exhausted, set the special value to denote this
+  if (pLeftSource->src.rowIndex == -1) {
+    return 1;
+  }
+
+  if (pRightSource->src.rowIndex == -1) {
+    return -1;
+  }
+
+  SSDataBlock* pLeftBlock = pLeftSource->src.pBlock;
+  SSDataBlock* pRightBlock = pRightSource->src.pBlock;
+
+  if (pParam->cmpGroupId) {
+    if (pLeftBlock->info.id.groupId != pRightBlock->info.id.groupId) {
+      return pLeftBlock->info.id.groupId < pRightBlock->info.id.groupId ? -1 : 1;
+    }
+  }
+
+  return tsortComparRow(pInfo, pLeftBlock, pLeftSource->src.rowIndex, pRightBlock, pRightSource->src.rowIndex);
+}
+
 static int32_t doInternalMergeSort(SSortHandle* pHandle) {
   size_t numOfSources = taosArrayGetSize(pHandle->pOrderedSource);
   if (numOfSources == 0) {
@@ -633,6 +640,115 @@ int32_t getProperSortPageSize(size_t rowSize, uint32_t numOfCols) {
   return pgSize;
 }
 
+static void tsortHeapSiftUp(SSortHandle* pHandle, int32_t* heap, int32_t pos) {
+  SSDataBlock* pBlock = pHandle->pDataBlock;
+  while (pos > 0) {
+    int32_t parent = (pos - 1) >> 1;
+    if (tsortComparRow(pHandle->pSortInfo, pBlock, heap[pos], pBlock, heap[parent]) <= 0) break;
+    TSWAP(heap[pos], heap[parent]);
+    pos = parent;
+  }
+}
+
+static void tsortHeapSiftDown(SSortHandle* pHandle, int32_t* heap, int32_t size, int32_t pos) {
+  SSDataBlock* pBlock = pHandle->pDataBlock;
+  while (1) {
+    int32_t largest = pos;
+    int32_t left = 2 * pos + 1;
+    int32_t right = left + 1;
+    if (left < size && tsortComparRow(pHandle->pSortInfo, pBlock, heap[left], pBlock, heap[largest]) > 0) {
+      largest = left;
+    }
+    if (right < size && tsortComparRow(pHandle->pSortInfo, pBlock, heap[right], pBlock, heap[largest]) > 0) {
+      largest = right;
+    }
+    if (largest == pos) break;
+    TSWAP(heap[pos], heap[largest]);
+    pos = largest;
+  }
+}
+
+/*
+ * Rows replaced in the heap are left in pDataBlock, they are never ahead of the kept rows. Sort the block, keep the
+ * first maxRows rows and rebuild the heap from them, which are in descending order from the heap's view.
+ */
+static int32_t tsortCompactTopN(SSortHandle* pHandle) {
+  SSDataBlock* pBlock = pHandle->pDataBlock;
+
+  int32_t code = blockDataSort(pBlock, pHandle->pSortInfo);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  int32_t      numOfRows = TMIN(pBlock->info.rows, pHandle->maxRows);
+  SSDataBlock* p = blockDataExtractBlock(pBlock, 0, numOfRows);
+  if (p == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  code = blockDataEnsureCapacity(p, pHandle->maxRows * 2);
+  if (code != TSDB_CODE_SUCCESS) {
+    blockDataDestroy(p);
+    return code;
+  }
+
+  blockDataDestroy(pBlock);
+  pHandle->pDataBlock = p;
+
+  taosArrayClear(pHandle->pHeap);
+  for (int32_t i = numOfRows - 1; i >= 0; --i) {
+    taosArrayPush(pHandle->pHeap, &i);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t doAddToTopN(SSortHandle* pHandle, SSDataBlock* pBlock) {
+  if (pHandle->pHeap == NULL) {
+    pHandle->pHeap = taosArrayInit(pHandle->maxRows, sizeof(int32_t));
+    if (pHandle->pHeap == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
+    int32_t code = blockDataEnsureCapacity(pHandle->pDataBlock, pHandle->maxRows * 2);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    int32_t size = taosArrayGetSize(pHandle->pHeap);
+    if (size == pHandle->maxRows) {
+      int32_t top = *(int32_t*)taosArrayGet(pHandle->pHeap, 0);
+      if (tsortComparRow(pHandle->pSortInfo, pBlock, i, pHandle->pDataBlock, top) >= 0) {
+        continue;
+      }
+    }
+
+    if (pHandle->pDataBlock->info.rows >= pHandle->maxRows * 2) {
+      int32_t code = tsortCompactTopN(pHandle);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+
+    int32_t rowIndex = i;
+    appendOneRowToDataBlock(pHandle->pDataBlock, pBlock, &rowIndex);
+
+    int32_t pos = pHandle->pDataBlock->info.rows - 1;
+    if (size < pHandle->maxRows) {
+      taosArrayPush(pHandle->pHeap, &pos);
+      tsortHeapSiftUp(pHandle, (int32_t*)pHandle->pHeap->pData, size);
+    } else {
+      int32_t* heap = (int32_t*)pHandle->pHeap->pData;
+      heap[0] = pos;
+      tsortHeapSiftDown(pHandle, heap, size, 0);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t createInitialSources(SSortHandle* pHandle) {
   size_t sortBufSize = pHandle->numOfPages * pHandle->pageSize;
 
@@ -657,12 +773,32 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         pHandle->numOfPages = 1024;
         sortBufSize = pHandle->numOfPages * pHandle->pageSize;
         pHandle->pDataBlock = createOneDataBlock(pBlock, false);
+
+        // the kept rows, and the replaced ones, must fit in the sort buffer, otherwise sort all rows
+        if (pHandle->maxRows > 0 && pHandle->maxRows * 2 * blockDataGetRowSize(pBlock) > sortBufSize) {
+          qDebug("%s too many rows to keep:%" PRId64 ", top-N sort is not used", pHandle->idStr, pHandle->maxRows);
+          pHandle->maxRows = 0;
+        }
       }
 
       if (pHandle->beforeFp != NULL) {
         pHandle->beforeFp(pBlock, pHandle->param);
       }
 
+      if (pHandle->maxRows > 0) {
+        int64_t p = taosGetTimestampUs();
+        int32_t code = doAddToTopN(pHandle, pBlock);
+        pHandle->sortElapsed += (taosGetTimestampUs() - p);
+        if (code != 0) {
+          if (source->param && !source->onlyRef) {
+            taosMemoryFree(source->param);
+          }
+          taosMemoryFree(source);
+          return code;
+        }
+        continue;
+      }
+
       int32_t code = blockDataMerge(pHandle->pDataBlock, pBlock);
       if (code != 0) {
         if (source->param && !source->onlyRef) {
@@ -711,7 +847,8 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
       // Perform the in-memory sort and then flush data in the buffer into disk.
       int64_t p = taosGetTimestampUs();
 
-      int32_t code = blockDataSort(pHandle->pDataBlock, pHandle->pSortInfo);
+      int32_t code = (pHandle->maxRows > 0) ? tsortCompactTopN(pHandle)
+                                            : blockDataSort(pHandle->pDataBlock, pHandle->pSortInfo);
       if (code != 0) {
         return code;
       }
@@ -794,6 +931,11 @@ int32_t tsortSetComparFp(SSortHandle* pHandle, _sort_merge_compar_fn_t fp) {
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t tsortSetMaxRows(SSortHandle* pHandle, int64_t maxRows) {
+  pHandle->maxRows = maxRows;
+  return TSDB_CODE_SUCCESS;
+}
+
 int32_t tsortSetCompareGroupId(SSortHandle* pHandle, bool compareGroupId) {
   pHandle->cmpParam.cmpGroupId = compareGroupId;
   return TSDB_CODE_SUCCESS;
@@ -877,6 +1019,7 @@ SSortExecInfo tsortGetSortExecInfo(SSortHandle* pHandle) {
       SDiskbasedBufStatis st = getDBufStatis(pHandle->pBuf);
       info.writeBytes = st.flushBytes;
       info.readBytes = st.loadBytes;
+      info.rawWriteBytes = st.flushRawBytes;
     }
   }
 
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <iostream>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "tdatablock.h"
+#include "tdef.h"
+
+namespace {
+
+// column 0: int, column 1: binary(8). Group key of row i is (i % numOfInt, "k" + i % numOfStr), and every 7th row has
+// null in the binary column.
+SSDataBlock* createGroupKeyBlock(int32_t rows, int32_t numOfInt, int32_t numOfStr, bool contiguous) {
+  SSDataBlock* pBlock = createDataBlock();
+
+  SColumnInfoData c0 = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  SColumnInfoData c1 = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 8 + VARSTR_HEADER_SIZE, 2);
+  blockDataAppendColInfo(pBlock, &c0);
+  blockDataAppendColInfo(pBlock, &c1);
+  blockDataEnsureCapacity(pBlock, rows);
+
+  SColumnInfoData* pCol0 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pCol1 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t k = contiguous ? (i * numOfInt / rows) : i;
+    int32_t v = k % numOfInt;
+    colDataAppend(pCol0, i, (const char*)&v, false);
+
+    if (!contiguous && i % 7 == 0) {
+      colDataAppendNULL(pCol1, i);
+    } else {
+      char buf[16] = {0};
+      int32_t len = sprintf(varDataVal(buf), "k%d", contiguous ? 0 : k % numOfStr);
+      varDataSetLen(buf, len);
+      colDataAppend(pCol1, i, buf, false);
+    }
+  }
+
+  pBlock->info.rows = rows;
+  return pBlock;
+}
+
+SArray* createGroupCols() {
+  SArray* pGroupCols = taosArrayInit(2, sizeof(SColumn));
+  for (int16_t i = 0; i < 2; ++i) {
+    SColumn c = {0};
+    c.slotId = i;
+    c.colId = i + 1;
+    taosArrayPush(pGroupCols, &c);
+  }
+  return pGroupCols;
+}
+
+const int32_t keyLen = 2 * sizeof(int8_t) + sizeof(int32_t) + 8 + VARSTR_HEADER_SIZE;
+
+bool sameGroupKey(SSDataBlock* pBlock, int32_t r1, int32_t r2) {
+  SColumnInfoData* pCol0 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pCol1 = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  if (*(int32_t*)colDataGetData(pCol0, r1) != *(int32_t*)colDataGetData(pCol0, r2)) {
+    return false;
+  }
+
+  bool null1 = colDataIsNull_var(pCol1, r1);
+  bool null2 = colDataIsNull_var(pCol1, r2);
+  if (null1 || null2) {
+    return null1 == null2;
+  }
+
+  char* p1 = colDataGetVarData(pCol1, r1);
+  char* p2 = colDataGetVarData(pCol1, r2);
+  return varDataLen(p1) == varDataLen(p2) && memcmp(varDataVal(p1), varDataVal(p2), varDataLen(p1)) == 0;
+}
+
+}  // namespace
+
+TEST(groupbyTest, keyBatchScattered) {
+  const int32_t rows = 4096;
+  SSDataBlock*  pBlock = createGroupKeyBlock(rows, 13, 5, false);
+  SArray*       pGroupCols = createGroupCols();
+
+  SGroupKeyBatch batch = {0};
+  ASSERT_EQ(ensureGroupKeyBatchCapacity(&batch, rows, keyLen), TSDB_CODE_SUCCESS);
+  ASSERT_TRUE(buildGroupKeyBatch(pGroupCols, pBlock, &batch, keyLen));
+
+  int32_t numOfGroups = 0;
+  int32_t runs = assignGroupOfRows(&batch, rows, keyLen, &numOfGroups);
+
+  // 13 * 5 combinations of (int, binary), plus 13 combinations of (int, null)
+  ASSERT_EQ(numOfGroups, 13 * 5 + 13);
+  ASSERT_GT(runs, numOfGroups);
+
+  // rows are in the same group if and only if they have the same group key
+  for (int32_t j = 0; j < rows; ++j) {
+    int32_t g = batch.pGroupOfRow[j];
+    ASSERT_TRUE(g >= 0 && g < numOfGroups);
+    ASSERT_TRUE(sameGroupKey(pBlock, j, batch.pGroupFirst[g]));
+    ASSERT_LE(batch.pGroupFirst[g], j);
+  }
+  for (int32_t g = 1; g < numOfGroups; ++g) {
+    ASSERT_FALSE(sameGroupKey(pBlock, batch.pGroupFirst[g - 1], batch.pGroupFirst[g]));
+  }
+
+  // the selection vector orders rows by group, and keeps the row order inside each group
+  buildGroupSelectVector(&batch, rows, numOfGroups);
+  int32_t start = 0;
+  for (int32_t g = 0; g < numOfGroups; ++g) {
+    int32_t end = batch.pGroupOffset[g];
+    ASSERT_GT(end, start);
+    ASSERT_EQ(batch.pSelect[start], batch.pGroupFirst[g]);
+    for (int32_t j = start; j < end; ++j) {
+      ASSERT_EQ(batch.pGroupOfRow[batch.pSelect[j]], g);
+      if (j > start) {
+        ASSERT_LT(batch.pSelect[j - 1], batch.pSelect[j]);
+      }
+    }
+    start = end;
+  }
+  ASSERT_EQ(start, rows);
+
+  destroyGroupKeyBatch(&batch);
+  taosArrayDestroy(pGroupCols);
+  blockDataDestroy(pBlock);
+}
+
+TEST(groupbyTest, keyBatchContiguous) {
+  const int32_t rows = 1000;
+  SSDataBlock*  pBlock = createGroupKeyBlock(rows, 10, 1, true);
+  SArray*       pGroupCols = createGroupCols();
+
+  SGroupKeyBatch batch = {0};
+  ASSERT_EQ(ensureGroupKeyBatchCapacity(&batch, rows, keyLen), TSDB_CODE_SUCCESS);
+  ASSERT_TRUE(buildGroupKeyBatch(pGroupCols, pBlock, &batch, keyLen));
+
+  // every group occupies a single run, so the block can be aggregated in place
+  int32_t numOfGroups = 0;
+  int32_t runs = assignGroupOfRows(&batch, rows, keyLen, &numOfGroups);
+  ASSERT_EQ(numOfGroups, 10);
+  ASSERT_EQ(runs, numOfGroups);
+
+  for (int32_t j = 1; j < rows; ++j) {
+    ASSERT_EQ(batch.pGroupOfRow[j] == batch.pGroupOfRow[j - 1], sameGroupKey(pBlock, j, j - 1));
+  }
+
+  // the buffers are reused for a smaller block
+  ASSERT_EQ(ensureGroupKeyBatchCapacity(&batch, rows / 2, keyLen), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(batch.capacity, rows);
+
+  destroyGroupKeyBatch(&batch);
+  taosArrayDestroy(pGroupCols);
+  blockDataDestroy(pBlock);
+}
+
+#pragma GCC diagnostic pop
@@ -393,4 +393,47 @@ TEST(testCase, ordered_merge_sort_Test) {
 
 #endif
 
+TEST(testCase, topN_sort_Test) {
+  SBlockOrderInfo oi = {0};
+  oi.order = TSDB_ORDER_DESC;
+  oi.slotId = 0;
+  SArray* orderInfo = taosArrayInit(1, sizeof(SBlockOrderInfo));
+  taosArrayPush(orderInfo, &oi);
+
+  SSortHandle* phandle = tsortCreateSortHandle(orderInfo, SORT_SINGLESOURCE_SORT, -1, -1, NULL, "test_abc");
+  tsortSetFetchRawDataFp(phandle, getSingleColDummyBlock, NULL, NULL);
+  tsortSetMaxRows(phandle, 10);
+
+  _info* pInfo = (_info*)taosMemoryCalloc(1, sizeof(_info));
+  pInfo->startVal = 0;
+  pInfo->pageRows = 100;
+  pInfo->count = 6;
+  pInfo->type = TSDB_DATA_TYPE_INT;
+
+  SSortSource* ps = static_cast<SSortSource*>(taosMemoryCalloc(1, sizeof(SSortSource)));
+  ps->param = pInfo;
+  ps->onlyRef = true;
+  tsortAddSource(phandle, ps);
+
+  int32_t code = tsortOpen(phandle);
+  ASSERT_EQ(code, 0);
+
+  int32_t row = 0;
+  while (1) {
+    STupleHandle* pTupleHandle = tsortNextTuple(phandle);
+    if (pTupleHandle == NULL) {
+      break;
+    }
+
+    void* v = tsortGetValue(pTupleHandle, 0);
+    ASSERT_EQ(600 - row, *(int32_t*)v);
+    row++;
+  }
+  ASSERT_EQ(row, 10);
+
+  taosArrayDestroy(orderInfo);
+  tsortDestroySortHandle(phandle);
+  taosMemoryFree(pInfo);
+}
+
 #pragma GCC diagnostic pop
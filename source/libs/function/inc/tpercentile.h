@@ -31,8 +31,8 @@ typedef struct MinMaxEntry {
   };
   union {
     double  dMaxVal;
-    int64_t i64MaxVal;
-    int64_t u64MaxVal;
+    int64_t  i64MaxVal;
+    uint64_t u64MaxVal;
   };
 } MinMaxEntry;
 
@@ -58,7 +58,7 @@ typedef struct tMemBucket {
   int32_t            elemPerPage;  // number of elements for each object
   int32_t            maxCapacity;  // maximum allowed number of elements that can be sort directly to get the result
   int32_t            bufPageSize;  // disk page size
-  MinMaxEntry        range;        // value range
+  MinMaxEntry        range;        // value range, widened on demand when data out of range arrives
   int32_t            times;        // count that has been checked for deciding the correct data value buckets.
   __compar_fn_t      comparFn;
   tMemBucketSlot    *pSlots;
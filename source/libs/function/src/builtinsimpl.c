@@ -93,10 +93,6 @@ typedef struct SLeastSQRInfo {
 typedef struct SPercentileInfo {
   double      result;
   tMemBucket* pMemBucket;
-  int32_t     stage;
-  double      minval;
-  double      maxval;
-  int64_t     numOfElems;
 } SPercentileInfo;
 
 typedef struct SAPercentileInfo {
@@ -1558,11 +1554,9 @@ bool percentileFunctionSetup(SqlFunctionCtx* pCtx, SResultRowEntryInfo* pResultI
     return false;
   }
 
-  // in the first round, get the min-max value of all involved data
+  // the bucket is created on the arrival of the first data block
   SPercentileInfo* pInfo = GET_ROWCELL_INTERBUF(pResultInfo);
-  SET_DOUBLE_VAL(&pInfo->minval, DBL_MAX);
-  SET_DOUBLE_VAL(&pInfo->maxval, -DBL_MAX);
-  pInfo->numOfElems = 0;
+  pInfo->pMemBucket = NULL;
 
   return true;
 }
@@ -1576,87 +1570,66 @@ int32_t percentileFunction(SqlFunctionCtx* pCtx) {
 
   SColumnInfoData* pCol = pInput->pData[0];
   int32_t          type = pCol->info.type;
+  int32_t          start = pInput->startRowIndex;
 
   SPercentileInfo* pInfo = GET_ROWCELL_INTERBUF(pResInfo);
-  if (pCtx->scanFlag == REPEAT_SCAN && pInfo->stage == 0) {
-    pInfo->stage += 1;
-
-    // all data are null, set it completed
-    if (pInfo->numOfElems == 0) {
-      pResInfo->complete = true;
-      return TSDB_CODE_SUCCESS;
-    } else {
-      pInfo->pMemBucket = tMemBucketCreate(pCol->info.bytes, type, pInfo->minval, pInfo->maxval);
-    }
-  }
-
-  // the first stage, only acquire the min/max value
-  if (pInfo->stage == 0) {
+  if (pInfo->pMemBucket == NULL) {
+    // pre-size the bucket with the min/max value of the first block, the value range of bucket is widened when the
+    // data out of range arrives, so all data is only scanned once.
+    double minval = DBL_MAX, maxval = -DBL_MAX;
     if (pCtx->input.colDataSMAIsSet) {
-      double tmin = 0.0, tmax = 0.0;
-      if (IS_SIGNED_NUMERIC_TYPE(type)) {
-        tmin = (double)GET_INT64_VAL(&pAgg->min);
-        tmax = (double)GET_INT64_VAL(&pAgg->max);
-      } else if (IS_FLOAT_TYPE(type)) {
-        tmin = GET_DOUBLE_VAL(&pAgg->min);
-        tmax = GET_DOUBLE_VAL(&pAgg->max);
-      } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
-        tmin = (double)GET_UINT64_VAL(&pAgg->min);
-        tmax = (double)GET_UINT64_VAL(&pAgg->max);
-      }
-
-      if (GET_DOUBLE_VAL(&pInfo->minval) > tmin) {
-        SET_DOUBLE_VAL(&pInfo->minval, tmin);
-      }
-
-      if (GET_DOUBLE_VAL(&pInfo->maxval) < tmax) {
-        SET_DOUBLE_VAL(&pInfo->maxval, tmax);
+      if (pInput->numOfRows > pAgg->numOfNull) {
+        if (IS_SIGNED_NUMERIC_TYPE(type)) {
+          minval = (double)GET_INT64_VAL(&pAgg->min);
+          maxval = (double)GET_INT64_VAL(&pAgg->max);
+        } else if (IS_FLOAT_TYPE(type)) {
+          minval = GET_DOUBLE_VAL(&pAgg->min);
+          maxval = GET_DOUBLE_VAL(&pAgg->max);
+        } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
+          minval = (double)GET_UINT64_VAL(&pAgg->min);
+          maxval = (double)GET_UINT64_VAL(&pAgg->max);
+        }
       }
-
-      pInfo->numOfElems += (pInput->numOfRows - pAgg->numOfNull);
     } else {
-      // check the valid data one by one
-      int32_t start = pInput->startRowIndex;
       for (int32_t i = start; i < pInput->numOfRows + start; ++i) {
         if (colDataIsNull_f(pCol->nullbitmap, i)) {
           continue;
         }
 
-        char* data = colDataGetData(pCol, i);
-
         double v = 0;
-        GET_TYPED_DATA(v, double, type, data);
-        if (v < GET_DOUBLE_VAL(&pInfo->minval)) {
-          SET_DOUBLE_VAL(&pInfo->minval, v);
-        }
+        GET_TYPED_DATA(v, double, type, colDataGetData(pCol, i));
+        minval = TMIN(minval, v);
+        maxval = TMAX(maxval, v);
+      }
+    }
 
-        if (v > GET_DOUBLE_VAL(&pInfo->maxval)) {
-          SET_DOUBLE_VAL(&pInfo->maxval, v);
-        }
+    // all data are null, wait for the next block
+    if (minval > maxval) {
+      return TSDB_CODE_SUCCESS;
+    }
 
-        pInfo->numOfElems += 1;
-      }
+    pInfo->pMemBucket = tMemBucketCreate(pCol->info.bytes, type, minval, maxval);
+    if (pInfo->pMemBucket == NULL) {
+      return (terrno != TSDB_CODE_SUCCESS) ? terrno : TSDB_CODE_OUT_OF_MEMORY;
     }
-  } else {
-    // the second stage, calculate the true percentile value
-    int32_t start = pInput->startRowIndex;
-    for (int32_t i = start; i < pInput->numOfRows + start; ++i) {
-      if (colDataIsNull_f(pCol->nullbitmap, i)) {
-        continue;
-      }
+  }
 
-      char* data = colDataGetData(pCol, i);
-      numOfElems += 1;
-      int32_t code = tMemBucketPut(pInfo->pMemBucket, data, 1);
-      if (code != TSDB_CODE_SUCCESS) {
-        tMemBucketDestroy(pInfo->pMemBucket);
-        return code;
-      }
+  for (int32_t i = start; i < pInput->numOfRows + start; ++i) {
+    if (colDataIsNull_f(pCol->nullbitmap, i)) {
+      continue;
     }
 
-    SET_VAL(pResInfo, numOfElems, 1);
+    char* data = colDataGetData(pCol, i);
+    numOfElems += 1;
+    int32_t code = tMemBucketPut(pInfo->pMemBucket, data, 1);
+    if (code != TSDB_CODE_SUCCESS) {
+      tMemBucketDestroy(pInfo->pMemBucket);
+      pInfo->pMemBucket = NULL;
+      return code;
+    }
   }
 
+  SET_VAL(pResInfo, numOfElems, 1);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -1676,6 +1649,7 @@ int32_t percentileFinalize(SqlFunctionCtx* pCtx, SSDataBlock* pBlock) {
   }
 
   tMemBucketDestroy(pMemBucket);
+  ppInfo->pMemBucket = NULL;
   if (code != TSDB_CODE_SUCCESS) {
     return code;
   }
@@ -65,17 +65,33 @@ static void resetBoundingBox(MinMaxEntry *range, int32_t type) {
   }
 }
 
+// the limits of 64-bit integers are not exact in double, (double)INT64_MAX is 2^63 that does not fit in int64_t.
+// Converting such a value back is undefined, so clamp it to the limits of the integer type first.
+static int64_t boundToInt64(double v) {
+  if (!(v > (double)INT64_MIN)) {
+    return INT64_MIN;
+  }
+  return (v >= (double)INT64_MAX) ? INT64_MAX : (int64_t)v;
+}
+
+static uint64_t boundToUint64(double v) {
+  if (!(v > 0)) {
+    return 0;
+  }
+  return (v >= (double)UINT64_MAX) ? UINT64_MAX : (uint64_t)v;
+}
+
 static int32_t setBoundingBox(MinMaxEntry *range, int16_t type, double minval, double maxval) {
   if (minval > maxval) {
     return -1;
   }
 
   if (IS_SIGNED_NUMERIC_TYPE(type)) {
-    range->i64MinVal = (int64_t)minval;
-    range->i64MaxVal = (int64_t)maxval;
+    range->i64MinVal = boundToInt64(minval);
+    range->i64MaxVal = boundToInt64(maxval);
   } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
-    range->u64MinVal = (uint64_t)minval;
-    range->u64MaxVal = (uint64_t)maxval;
+    range->u64MinVal = boundToUint64(minval);
+    range->u64MaxVal = boundToUint64(maxval);
   } else {
     range->dMinVal = minval;
     range->dMaxVal = maxval;
@@ -133,13 +149,13 @@ int32_t tBucketIntHash(tMemBucket *pBucket, const void *value) {
   }
 
   // divide the value range into 1024 buckets
-  uint64_t span = pBucket->range.i64MaxVal - pBucket->range.i64MinVal;
+  uint64_t span = (uint64_t)pBucket->range.i64MaxVal - (uint64_t)pBucket->range.i64MinVal;
   if (span < pBucket->numOfSlots) {
-    int64_t delta = v - pBucket->range.i64MinVal;
-    index = (delta % pBucket->numOfSlots);
+    uint64_t delta = (uint64_t)v - (uint64_t)pBucket->range.i64MinVal;
+    index = (int32_t)(delta % pBucket->numOfSlots);
   } else {
     double   slotSpan = ((double)span) / pBucket->numOfSlots;
-    uint64_t delta = v - pBucket->range.i64MinVal;
+    uint64_t delta = (uint64_t)v - (uint64_t)pBucket->range.i64MinVal;
 
     index = (int32_t)(delta / slotSpan);
     if (v == pBucket->range.i64MaxVal || index == pBucket->numOfSlots) {
@@ -153,7 +169,7 @@ int32_t tBucketIntHash(tMemBucket *pBucket, const void *value) {
 }
 
 int32_t tBucketUintHash(tMemBucket *pBucket, const void *value) {
-  int64_t v = 0;
+  uint64_t v = 0;
   GET_TYPED_DATA(v, uint64_t, pBucket->type, value);
 
   int32_t index = -1;
@@ -165,12 +181,12 @@ int32_t tBucketUintHash(tMemBucket *pBucket, const void *value) {
   // divide the value range into 1024 buckets
   uint64_t span = pBucket->range.u64MaxVal - pBucket->range.u64MinVal;
   if (span < pBucket->numOfSlots) {
-    int64_t delta = v - pBucket->range.u64MinVal;
+    uint64_t delta = v - pBucket->range.u64MinVal;
     index = (int32_t)(delta % pBucket->numOfSlots);
   } else {
     double slotSpan = (double)span / pBucket->numOfSlots;
     index = (int32_t)((v - pBucket->range.u64MinVal) / slotSpan);
-    if (v == pBucket->range.u64MaxVal) {
+    if (v == pBucket->range.u64MaxVal || index == pBucket->numOfSlots) {
       index -= 1;
     }
   }
@@ -195,14 +211,13 @@ int32_t tBucketDoubleHash(tMemBucket *pBucket, const void *value) {
 
   // divide a range of [dMinVal, dMaxVal] into 1024 buckets
   double span = pBucket->range.dMaxVal - pBucket->range.dMinVal;
-  if (span < pBucket->numOfSlots) {
-    int32_t delta = (int32_t)(v - pBucket->range.dMinVal);
-    index = (delta % pBucket->numOfSlots);
+  if (span <= 0) {
+    index = 0;
   } else {
     double slotSpan = span / pBucket->numOfSlots;
     index = (int32_t)((v - pBucket->range.dMinVal) / slotSpan);
-    if (v == pBucket->range.dMaxVal) {
-      index -= 1;
+    if (index >= pBucket->numOfSlots) {
+      index = pBucket->numOfSlots - 1;
     }
   }
 
@@ -320,12 +335,12 @@ void tMemBucketUpdateBoundingBox(MinMaxEntry *r, const char *data, int32_t dataT
     uint64_t v = 0;
     GET_TYPED_DATA(v, uint64_t, dataType, data);
 
-    if (r->i64MinVal > v) {
-      r->i64MinVal = v;
+    if (r->u64MinVal > v) {
+      r->u64MinVal = v;
     }
 
-    if (r->i64MaxVal < v) {
-      r->i64MaxVal = v;
+    if (r->u64MaxVal < v) {
+      r->u64MaxVal = v;
     }
   } else if (IS_FLOAT_TYPE(dataType)) {
     double v = 0;
@@ -343,22 +358,127 @@ void tMemBucketUpdateBoundingBox(MinMaxEntry *r, const char *data, int32_t dataT
   }
 }
 
+/*
+ * bucket all the data again with the new value range, the pages of the previous slots are given back to the buffer
+ * once they have been consumed.
+ */
+static int32_t tMemBucketResize(tMemBucket *pBucket, const MinMaxEntry *pRange) {
+  SArray **pPageIdLists = taosMemoryCalloc(pBucket->numOfSlots, POINTER_BYTES);
+  if (pPageIdLists == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < pBucket->numOfSlots; ++i) {
+    tMemBucketSlot *pSlot = &pBucket->pSlots[i];
+    if (pSlot->info.data != NULL) {
+      setBufPageDirty(pSlot->info.data, true);
+      releaseBufPage(pBucket->pBuffer, pSlot->info.data);
+    }
+
+    int32_t groupId = getGroupId(pBucket->numOfSlots, i, pBucket->times);
+    void   *p = taosHashGet(pBucket->groupPagesMap, &groupId, sizeof(groupId));
+    if (p != NULL) {
+      pPageIdLists[i] = *(SArray **)p;
+      taosHashRemove(pBucket->groupPagesMap, &groupId, sizeof(groupId));
+    }
+  }
+
+  resetSlotInfo(pBucket);
+  pBucket->range = *pRange;
+  pBucket->total = 0;
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < pBucket->numOfSlots; ++i) {
+    SArray *pList = pPageIdLists[i];
+    for (int32_t f = 0; f < taosArrayGetSize(pList) && code == TSDB_CODE_SUCCESS; ++f) {
+      int32_t   *pageId = taosArrayGet(pList, f);
+      SFilePage *pg = getBufPage(pBucket->pBuffer, *pageId);
+      if (pg == NULL) {
+        code = terrno;
+        break;
+      }
+
+      code = tMemBucketPut(pBucket, pg->data, (int32_t)pg->num);
+      dBufSetBufPageRecycled(pBucket->pBuffer, pg);
+    }
+
+    taosArrayDestroy(pList);
+  }
+
+  taosMemoryFree(pPageIdLists);
+  return code;
+}
+
+/*
+ * widen the value range to cover the given value. The range grows by at least the current span on the side that is
+ * exceeded, so that the data has to be bucketed again only a logarithmic number of times even for the monotonic input.
+ */
+static int32_t tMemBucketGrowRange(tMemBucket *pBucket, const char *data) {
+  MinMaxEntry range = pBucket->range;
+
+  if (IS_SIGNED_NUMERIC_TYPE(pBucket->type)) {
+    int64_t v = 0;
+    GET_TYPED_DATA(v, int64_t, pBucket->type, data);
+
+    uint64_t span = (uint64_t)range.i64MaxVal - (uint64_t)range.i64MinVal;
+    if (v < range.i64MinVal) {
+      uint64_t room = (uint64_t)range.i64MinVal - (uint64_t)INT64_MIN;
+      range.i64MinVal = TMIN(v, (room > span) ? (int64_t)((uint64_t)range.i64MinVal - span) : INT64_MIN);
+    } else if (v > range.i64MaxVal) {
+      uint64_t room = (uint64_t)INT64_MAX - (uint64_t)range.i64MaxVal;
+      range.i64MaxVal = TMAX(v, (room > span) ? (int64_t)((uint64_t)range.i64MaxVal + span) : INT64_MAX);
+    }
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(pBucket->type)) {
+    uint64_t v = 0;
+    GET_TYPED_DATA(v, uint64_t, pBucket->type, data);
+
+    uint64_t span = range.u64MaxVal - range.u64MinVal;
+    if (v < range.u64MinVal) {
+      range.u64MinVal = TMIN(v, (range.u64MinVal > span) ? range.u64MinVal - span : 0);
+    } else if (v > range.u64MaxVal) {
+      range.u64MaxVal = TMAX(v, (UINT64_MAX - range.u64MaxVal > span) ? range.u64MaxVal + span : UINT64_MAX);
+    }
+  } else {
+    double v = 0;
+    GET_TYPED_DATA(v, double, pBucket->type, data);
+    if (isnan(v) || isinf(v)) {
+      return TSDB_CODE_SUCCESS;
+    }
+
+    double span = range.dMaxVal - range.dMinVal;
+    if (v < range.dMinVal) {
+      range.dMinVal = TMIN(v, range.dMinVal - span);
+    } else if (v > range.dMaxVal) {
+      range.dMaxVal = TMAX(v, range.dMaxVal + span);
+    }
+  }
+
+  return tMemBucketResize(pBucket, &range);
+}
+
 /*
  * in memory bucket, we only accept data array list
  */
 int32_t tMemBucketPut(tMemBucket *pBucket, const void *data, size_t size) {
   ASSERT(pBucket != NULL && data != NULL && size > 0);
 
-  int32_t count = 0;
   int32_t bytes = pBucket->bytes;
   for (int32_t i = 0; i < size; ++i) {
     char   *d = (char *)data + i * bytes;
     int32_t index = (pBucket->hashFunc)(pBucket, d);
     if (index < 0) {
-      continue;
+      int32_t code = tMemBucketGrowRange(pBucket, d);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
+      index = (pBucket->hashFunc)(pBucket, d);
+      if (index < 0) {
+        continue;
+      }
     }
 
-    count += 1;
+    pBucket->total += 1;
 
     tMemBucketSlot *pSlot = &pBucket->pSlots[index];
     tMemBucketUpdateBoundingBox(&pSlot->range, d, pBucket->type);
@@ -400,7 +520,6 @@ int32_t tMemBucketPut(tMemBucket *pBucket, const void *data, size_t size) {
     pSlot->info.size += 1;
   }
 
-  pBucket->total += count;
   return TSDB_CODE_SUCCESS;
 }
 
@@ -556,16 +675,22 @@ int32_t getPercentile(tMemBucket *pMemBucket, double percent, double *result) {
 
   percent = fabs(percent);
 
-  // find the min/max value, no need to scan all data in bucket
+  // find the min/max value, no need to scan all data in bucket. The value range of bucket may be wider than the data,
+  // so the bounding box of the first or last slot with data is used.
   if (fabs(percent - 100.0) < DBL_EPSILON || (percent < DBL_EPSILON)) {
-    MinMaxEntry *pRange = &pMemBucket->range;
+    bool    isMax = fabs(percent - 100) < DBL_EPSILON;
+    int32_t slotIdx = isMax ? pMemBucket->numOfSlots - 1 : 0;
+    while (pMemBucket->pSlots[slotIdx].info.size == 0) {
+      slotIdx += isMax ? -1 : 1;
+    }
 
+    MinMaxEntry *pRange = &pMemBucket->pSlots[slotIdx].range;
     if (IS_SIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-      *result = (double)(fabs(percent - 100) < DBL_EPSILON ? pRange->i64MaxVal : pRange->i64MinVal);
+      *result = (double)(isMax ? pRange->i64MaxVal : pRange->i64MinVal);
     } else if (IS_UNSIGNED_NUMERIC_TYPE(pMemBucket->type)) {
-      *result = (double)(fabs(percent - 100) < DBL_EPSILON ? pRange->u64MaxVal : pRange->u64MinVal);
+      *result = (double)(isMax ? pRange->u64MaxVal : pRange->u64MinVal);
     } else {
-      *result = fabs(percent - 100) < DBL_EPSILON ? pRange->dMaxVal : pRange->dMinVal;
+      *result = isMax ? pRange->dMaxVal : pRange->dMinVal;
     }
 
     return TSDB_CODE_SUCCESS;
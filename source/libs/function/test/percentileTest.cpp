@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tglobal.h"
+#include "ttypes.h"
+#include "tpercentile.h"
+
+namespace {
+
+// the percentile of the given data, interpolated between the closest ranks
+double expectedPercentile(std::vector<double> data, double percent) {
+  std::sort(data.begin(), data.end());
+  double idx = (data.size() - 1) * percent / 100.0;
+  size_t lo = (size_t)floor(idx);
+  size_t hi = (size_t)ceil(idx);
+  return data[lo] + (data[hi] - data[lo]) * (idx - lo);
+}
+
+template <typename T>
+class BucketChecker {
+ public:
+  // the bucket is pre-sized with the value range of the first block, like the percentile function does
+  BucketChecker(int16_t type, const std::vector<T> &first) {
+    tsTempSpace.size.avail = 1LL << 30;
+    strcpy(tsTempDir, TD_TMP_DIR_PATH);
+
+    T minval = *std::min_element(first.begin(), first.end());
+    T maxval = *std::max_element(first.begin(), first.end());
+    pBucket = tMemBucketCreate(sizeof(T), type, (double)minval, (double)maxval);
+    put(first);
+  }
+
+  ~BucketChecker() { tMemBucketDestroy(pBucket); }
+
+  void put(const std::vector<T> &block) {
+    ASSERT_NE(pBucket, nullptr);
+    ASSERT_EQ(tMemBucketPut(pBucket, block.data(), block.size()), 0);
+    for (T v : block) {
+      data.push_back((double)v);
+    }
+    ASSERT_EQ(pBucket->total, (int32_t)data.size());
+  }
+
+  void check() {
+    for (double percent : {0.0, 1.0, 25.0, 50.0, 75.0, 99.0, 100.0}) {
+      double result = 0;
+      ASSERT_EQ(getPercentile(pBucket, percent, &result), 0);
+      double expected = expectedPercentile(data, percent);
+      ASSERT_LE(fabs(result - expected), fabs(expected) * 1e-9) << "percent:" << percent;
+    }
+  }
+
+  tMemBucket         *pBucket = NULL;
+  std::vector<double> data;
+};
+
+}  // namespace
+
+TEST(percentileTest, monotonicGrowth) {
+  std::vector<int64_t> block;
+  for (int64_t i = 0; i < 100; i++) {
+    block.push_back(i);
+  }
+
+  // every block exceeds the range, it grows by at least its span each time instead of by the exceeded amount
+  BucketChecker<int64_t> checker(TSDB_DATA_TYPE_BIGINT, block);
+  for (int32_t n = 1; n < 1000; n++) {
+    for (int64_t &v : block) {
+      v += 100;
+    }
+    checker.put(block);
+    ASSERT_GE(checker.pBucket->range.i64MaxVal, block.back());
+    ASSERT_LT(checker.pBucket->range.i64MaxVal, 2 * block.back() + 100);
+  }
+
+  ASSERT_EQ(checker.pBucket->range.i64MinVal, 0);
+  checker.check();
+}
+
+TEST(percentileTest, growBothDirections) {
+  std::vector<double> block;
+  for (int32_t i = 0; i < 100; i++) {
+    block.push_back(i + 0.5);
+  }
+
+  BucketChecker<double> checker(TSDB_DATA_TYPE_DOUBLE, block);
+  for (double v : {150.5, -29.5, 1e6, -1e6, 42.0}) {
+    checker.put({v});
+    ASSERT_LE(checker.pBucket->range.dMinVal, *std::min_element(checker.data.begin(), checker.data.end()));
+    ASSERT_GE(checker.pBucket->range.dMaxVal, *std::max_element(checker.data.begin(), checker.data.end()));
+  }
+
+  checker.check();
+}
+
+TEST(percentileTest, unsignedPastInt64) {
+  std::vector<uint64_t> block;
+  for (uint64_t i = 0; i < 100; i++) {
+    block.push_back(i * 1000);
+  }
+
+  BucketChecker<uint64_t> checker(TSDB_DATA_TYPE_UBIGINT, block);
+  checker.put({(uint64_t)INT64_MAX + 1, UINT64_MAX / 4 * 3});
+  checker.put({UINT64_MAX});
+  ASSERT_EQ(checker.pBucket->range.u64MinVal, 0);
+  ASSERT_EQ(checker.pBucket->range.u64MaxVal, UINT64_MAX);
+  checker.check();
+}
+
+TEST(percentileTest, rangeAtTypeLimits) {
+  // (double)INT64_MAX and (double)UINT64_MAX are past the limits, the bounds are clamped to them
+  tMemBucket *pBucket = tMemBucketCreate(sizeof(int64_t), TSDB_DATA_TYPE_BIGINT, (double)INT64_MIN, (double)INT64_MAX);
+  ASSERT_NE(pBucket, nullptr);
+  ASSERT_EQ(pBucket->range.i64MinVal, INT64_MIN);
+  ASSERT_EQ(pBucket->range.i64MaxVal, INT64_MAX);
+  tMemBucketDestroy(pBucket);
+
+  pBucket = tMemBucketCreate(sizeof(uint64_t), TSDB_DATA_TYPE_UBIGINT, (double)(UINT64_MAX - 1), (double)UINT64_MAX);
+  ASSERT_NE(pBucket, nullptr);
+  ASSERT_EQ(pBucket->range.u64MinVal, UINT64_MAX);
+  ASSERT_EQ(pBucket->range.u64MaxVal, UINT64_MAX);
+  tMemBucketDestroy(pBucket);
+
+  BucketChecker<int64_t> signedChecker(TSDB_DATA_TYPE_BIGINT, {INT64_MIN, INT64_MAX});
+  signedChecker.put({0, -1, 1});
+  signedChecker.check();
+
+  BucketChecker<uint64_t> unsignedChecker(TSDB_DATA_TYPE_UBIGINT, {UINT64_MAX - 1, UINT64_MAX});
+  unsignedChecker.put({0, 1});
+  ASSERT_EQ(unsignedChecker.pBucket->range.u64MinVal, 0);
+  unsignedChecker.check();
+}
+
+TEST(percentileTest, rangeWiderThanData) {
+  std::vector<int32_t> block;
+  for (int32_t i = 0; i < 100; i++) {
+    block.push_back(i);
+  }
+
+  // each value widens the range past the data, p=0 and p=100 are still the exact min and max
+  BucketChecker<int32_t> checker(TSDB_DATA_TYPE_INT, block);
+  checker.put({150});
+  checker.put({-30});
+  ASSERT_LT(checker.pBucket->range.i64MinVal, -30);
+  ASSERT_GT(checker.pBucket->range.i64MaxVal, 150);
+
+  double result = 0;
+  ASSERT_EQ(getPercentile(checker.pBucket, 0, &result), 0);
+  ASSERT_EQ(result, -30);
+  ASSERT_EQ(getPercentile(checker.pBucket, 100, &result), 0);
+  ASSERT_EQ(result, 150);
+  checker.check();
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __INDEX_BITMAP_H__
+#define __INDEX_BITMAP_H__
+
+#include "indexInt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * roaring bitmap of uid
+ *
+ * uid is split into the high 48 bits, which select a container, and the low 16 bits, which are kept in the
+ * container. A container with no more than IDX_BM_ARRAY_MAX values keeps them in a sorted uint16_t array,
+ * otherwise in a bitset of 65536 bits.
+ */
+#define IDX_BM_ARRAY_MAX  4096
+#define IDX_BM_BITSET_LEN 1024  // uint64_t words of a bitset container
+
+typedef struct SIdxBmContainer {
+  uint64_t key;
+  int32_t  card;
+  int32_t  cap;  // capacity of array container, 0 for bitset container
+  void*    data;
+} SIdxBmContainer;
+
+typedef struct SIdxBitmap {
+  SArray* containers;  // SIdxBmContainer, sorted by key
+} SIdxBitmap;
+
+SIdxBitmap* idxBitmapCreate();
+
+void idxBitmapDestroy(SIdxBitmap* bm);
+
+void idxBitmapClear(SIdxBitmap* bm);
+
+int32_t idxBitmapAdd(SIdxBitmap* bm, uint64_t uid);
+
+/*
+ * add uids, which is faster if the uids are sorted
+ */
+int32_t idxBitmapAddArray(SIdxBitmap* bm, SArray* uids);
+
+void idxBitmapRemove(SIdxBitmap* bm, uint64_t uid);
+
+bool idxBitmapContains(SIdxBitmap* bm, uint64_t uid);
+
+int64_t idxBitmapCardinality(SIdxBitmap* bm);
+
+/*
+ * dst = dst | src
+ */
+int32_t idxBitmapOr(SIdxBitmap* dst, SIdxBitmap* src);
+
+/*
+ * dst = dst & src
+ */
+int32_t idxBitmapAnd(SIdxBitmap* dst, SIdxBitmap* src);
+
+/*
+ * dst = dst & ~src
+ */
+int32_t idxBitmapAndNot(SIdxBitmap* dst, SIdxBitmap* src);
+
+/*
+ * append all uids to out in ascending order
+ */
+void idxBitmapToArray(SIdxBitmap* bm, SArray* out);
+
+/*
+ * serialized format
+ * |<--nContainer-->|<--key-->|<--card-->|<--values or bitset-->|...
+ * |<---int32_t---->|<uint64_t>|<int32_t>|<card * uint16_t or IDX_BM_BITSET_LEN * uint64_t>|
+ */
+int32_t idxBitmapSerialSize(SIdxBitmap* bm);
+
+int32_t idxBitmapSerialize(SIdxBitmap* bm, char* buf);
+
+SIdxBitmap* idxBitmapDeserialize(const char* buf, int32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
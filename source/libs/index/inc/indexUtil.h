@@ -15,6 +15,7 @@
 #ifndef __INDEX_UTIL_H__
 #define __INDEX_UTIL_H__
 
+#include "indexBitmap.h"
 #include "indexInt.h"
 
 #ifdef __cplusplus
@@ -46,17 +47,11 @@ extern "C" {
     buf += len;                                 \
   } while (0)
 
-#define INDEX_MERGE_ADD_DEL(src, dst, tgt)            \
-  {                                                   \
-    bool f = false;                                   \
-    for (int i = 0; i < taosArrayGetSize(src); i++) { \
-      if (*(uint64_t *)taosArrayGet(src, i) == tgt) { \
-        f = true;                                     \
-      }                                               \
-    }                                                 \
-    if (f == false) {                                 \
-      taosArrayPush(dst, &tgt);                       \
-    }                                                 \
+#define INDEX_MERGE_ADD_DEL(src, dst, tgt)   \
+  {                                          \
+    if (!idxBitmapContains(src, tgt)) {      \
+      idxBitmapAdd(dst, tgt);                \
+    }                                        \
   }
 
 /* multi sorted result intersection
@@ -96,9 +91,9 @@ typedef struct {
  *
  */
 typedef struct {
-  SArray *total;
-  SArray *add;
-  SArray *del;
+  SIdxBitmap *total;
+  SIdxBitmap *add;
+  SIdxBitmap *del;
 } SIdxTRslt;
 
 SIdxTRslt *idxTRsltCreate();
@@ -109,6 +104,11 @@ void idxTRsltDestroy(SIdxTRslt *tr);
 
 void idxTRsltMergeTo(SIdxTRslt *tr, SArray *out);
 
+/*
+ * out = out | ((total | add) & ~del), total is modified
+ */
+int32_t idxTRsltMergeToBitmap(SIdxTRslt *tr, SIdxBitmap *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,7 +81,7 @@ typedef struct SIdxColInfo {
 
 static TdThreadOnce isInit = PTHREAD_ONCE_INIT;
 // static void           indexInit();
-static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* term, SArray** result);
+static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* term, SIdxBitmap** result);
 
 static void idxInterRsltDestroy(SArray* results);
 static int  idxMergeFinalResults(SArray* in, EIndexOperatorType oType, SArray* out);
@@ -243,7 +243,7 @@ int indexSearch(SIndex* index, SIndexMultiTermQuery* multiQuerys, SArray* result
   int     nQuery = taosArrayGetSize(multiQuerys->query);
   for (size_t i = 0; i < nQuery; i++) {
     SIndexTermQuery* qterm = taosArrayGet(multiQuerys->query, i);
-    SArray*          trslt = NULL;
+    SIdxBitmap*      trslt = NULL;
     idxTermSearch(index, qterm, &trslt);
     taosArrayPush(iRslts, (void*)&trslt);
   }
@@ -389,7 +389,7 @@ bool indexJsonIsRebuild(SIndexJson* idx) {
   return ((SIdxStatus)atomic_load_8(&idx->status)) == kRebuild ? true : false;
 }
 
-static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* query, SArray** result) {
+static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* query, SIdxBitmap** result) {
   SIndexTerm* term = query->term;
   const char* colName = term->colName;
   int32_t     nColName = term->nColName;
@@ -408,7 +408,7 @@ static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* query, SArray** result)
   cache = (pCache == NULL) ? NULL : *pCache;
   taosThreadMutexUnlock(&sIdx->mtx);
 
-  *result = taosArrayInit(4, sizeof(uint64_t));
+  *result = idxBitmapCreate();
   // TODO: iterator mem and tidex
   STermValueType s = kTypeValue;
 
@@ -419,6 +419,7 @@ static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* query, SArray** result)
     if (s == kTypeDeletion) {
       indexInfo("col: %s already drop by", term->colName);
       // coloum already drop by other oper, no need to query tindex
+      idxTRsltDestroy(tr);
       return 0;
     } else {
       st = taosGetTimestampUs();
@@ -436,7 +437,10 @@ static int idxTermSearch(SIndex* sIdx, SIndexTermQuery* query, SArray** result)
   int64_t cost = taosGetTimestampUs() - st;
   indexInfo("search cost: %" PRIu64 "us", cost);
 
-  idxTRsltMergeTo(tr, *result);
+  if (idxTRsltMergeToBitmap(tr, *result) != 0) {
+    indexError("failed to merge result, col:%s val: %s", term->colName, term->colVal);
+    goto END;
+  }
 
   idxTRsltDestroy(tr);
   return 0;
@@ -451,24 +455,30 @@ static void idxInterRsltDestroy(SArray* results) {
 
   size_t sz = taosArrayGetSize(results);
   for (size_t i = 0; i < sz; i++) {
-    SArray* p = taosArrayGetP(results, i);
-    taosArrayDestroy(p);
+    SIdxBitmap* p = taosArrayGetP(results, i);
+    idxBitmapDestroy(p);
   }
   taosArrayDestroy(results);
 }
 
 static int idxMergeFinalResults(SArray* in, EIndexOperatorType oType, SArray* out) {
-  // refactor, merge interResults into fResults by oType
-  for (int i = 0; i < taosArrayGetSize(in); i--) {
-    SArray* t = taosArrayGetP(in, i);
-    taosArraySort(t, uidCompare);
-    taosArrayRemoveDuplicate(t, uidCompare, NULL);
+  // merge interResults into fResults by oType, each of interResults is a bitmap
+  int32_t sz = taosArrayGetSize(in);
+  if (sz <= 0) {
+    return 0;
   }
 
+  SIdxBitmap* base = taosArrayGetP(in, 0);
   if (oType == MUST) {
-    iIntersection(in, out);
+    for (int32_t i = 1; i < sz; i++) {
+      if (idxBitmapAnd(base, taosArrayGetP(in, i)) != 0) return -1;
+    }
+    idxBitmapToArray(base, out);
   } else if (oType == SHOULD) {
-    iUnion(in, out);
+    for (int32_t i = 1; i < sz; i++) {
+      if (idxBitmapOr(base, taosArrayGetP(in, i)) != 0) return -1;
+    }
+    idxBitmapToArray(base, out);
   } else if (oType == NOT) {
     // just one column index, enhance later
     // taosArrayAddAll(fResults, interResults);
@@ -512,7 +522,7 @@ static void idxMergeCacheAndTFile(SArray* result, IterateValue* cv, IterateValue
     }
   }
   if (tv != NULL) {
-    taosArrayAddAll(tr->total, tv->val);
+    idxBitmapAddArray(tr->total, tv->val);
   }
 }
 static void idxDestroyFinalRslt(SArray* result) {
@@ -0,0 +1,609 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "indexBitmap.h"
+#include "indexUtil.h"
+
+#define IDX_BM_KEY(uid)      ((uid) >> 16)
+#define IDX_BM_LOW(uid)      ((uint16_t)((uid)&0xFFFF))
+#define IDX_BM_IS_BITSET(c)  ((c)->cap == 0)
+#define IDX_BM_BITSET_SIZE   (IDX_BM_BITSET_LEN * sizeof(uint64_t))
+#define IDX_BM_CONTAINER_HDR (sizeof(uint64_t) + sizeof(int32_t))
+
+static FORCE_INLINE int32_t bmPopcount(uint64_t v) {
+  v = v - ((v >> 1) & 0x5555555555555555ull);
+  v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+  v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+  return (int32_t)((v * 0x0101010101010101ull) >> 56);
+}
+
+// lower bound of v in arr
+static FORCE_INLINE int32_t bmArraySearch(const uint16_t* arr, int32_t n, uint16_t v) {
+  int32_t s = 0, e = n;
+  while (s < e) {
+    int32_t m = s + (e - s) / 2;
+    if (arr[m] < v) {
+      s = m + 1;
+    } else {
+      e = m;
+    }
+  }
+  return s;
+}
+
+static FORCE_INLINE bool bmcContains(const SIdxBmContainer* c, uint16_t v) {
+  if (IDX_BM_IS_BITSET(c)) {
+    return (((uint64_t*)c->data)[v >> 6] >> (v & 63)) & 1;
+  }
+  const uint16_t* arr = c->data;
+  int32_t         pos = bmArraySearch(arr, c->card, v);
+  return pos < c->card && arr[pos] == v;
+}
+
+static int32_t bmcCount(const uint64_t* words) {
+  int32_t card = 0;
+  for (int32_t i = 0; i < IDX_BM_BITSET_LEN; i++) {
+    card += bmPopcount(words[i]);
+  }
+  return card;
+}
+
+static int32_t bmcToBitset(SIdxBmContainer* c) {
+  uint64_t* words = taosMemoryCalloc(IDX_BM_BITSET_LEN, sizeof(uint64_t));
+  if (words == NULL) {
+    return -1;
+  }
+  uint16_t* arr = c->data;
+  for (int32_t i = 0; i < c->card; i++) {
+    words[arr[i] >> 6] |= (1ull << (arr[i] & 63));
+  }
+  taosMemoryFree(c->data);
+  c->data = words;
+  c->cap = 0;
+  return 0;
+}
+
+static int32_t bmcToArray(SIdxBmContainer* c) {
+  int32_t   cap = TMAX(c->card, 1);
+  uint16_t* arr = taosMemoryMalloc(cap * sizeof(uint16_t));
+  if (arr == NULL) {
+    return -1;
+  }
+  uint64_t* words = c->data;
+  int32_t   n = 0;
+  for (int32_t i = 0; i < IDX_BM_BITSET_LEN; i++) {
+    uint64_t w = words[i];
+    while (w != 0) {
+      arr[n++] = (uint16_t)(i * 64 + BUILDIN_CTZL(w));
+      w &= (w - 1);
+    }
+  }
+  taosMemoryFree(c->data);
+  c->data = arr;
+  c->cap = cap;
+  return 0;
+}
+
+// keep array container for small cardinality and bitset container for large one
+static int32_t bmcNormalize(SIdxBmContainer* c) {
+  if (IDX_BM_IS_BITSET(c)) {
+    c->card = bmcCount(c->data);
+    if (c->card <= IDX_BM_ARRAY_MAX) {
+      return bmcToArray(c);
+    }
+  } else if (c->card > IDX_BM_ARRAY_MAX) {
+    return bmcToBitset(c);
+  }
+  return 0;
+}
+
+static int32_t bmcInit(SIdxBmContainer* c, uint64_t key) {
+  c->key = key;
+  c->card = 0;
+  c->cap = 4;
+  c->data = taosMemoryMalloc(c->cap * sizeof(uint16_t));
+  return c->data == NULL ? -1 : 0;
+}
+
+static void bmcDestroy(SIdxBmContainer* c) { taosMemoryFreeClear(c->data); }
+
+static int32_t bmcClone(SIdxBmContainer* dst, const SIdxBmContainer* src) {
+  int32_t size = IDX_BM_IS_BITSET(src) ? IDX_BM_BITSET_SIZE : src->cap * sizeof(uint16_t);
+  *dst = *src;
+  dst->data = taosMemoryMalloc(size);
+  if (dst->data == NULL) {
+    return -1;
+  }
+  memcpy(dst->data, src->data, size);
+  return 0;
+}
+
+static int32_t bmcAdd(SIdxBmContainer* c, uint16_t v) {
+  if (IDX_BM_IS_BITSET(c)) {
+    uint64_t* w = &((uint64_t*)c->data)[v >> 6];
+    if ((*w & (1ull << (v & 63))) == 0) {
+      *w |= (1ull << (v & 63));
+      c->card++;
+    }
+    return 0;
+  }
+
+  uint16_t* arr = c->data;
+  // fast path for sorted input
+  int32_t pos = (c->card > 0 && arr[c->card - 1] < v) ? c->card : bmArraySearch(arr, c->card, v);
+  if (pos < c->card && arr[pos] == v) {
+    return 0;
+  }
+
+  if (c->card >= IDX_BM_ARRAY_MAX) {
+    if (bmcToBitset(c) != 0) return -1;
+    return bmcAdd(c, v);
+  }
+
+  if (c->card >= c->cap) {
+    int32_t cap = TMIN(c->cap * 2, IDX_BM_ARRAY_MAX);
+    arr = taosMemoryRealloc(c->data, cap * sizeof(uint16_t));
+    if (arr == NULL) {
+      return -1;
+    }
+    c->data = arr;
+    c->cap = cap;
+  }
+
+  memmove(arr + pos + 1, arr + pos, (c->card - pos) * sizeof(uint16_t));
+  arr[pos] = v;
+  c->card++;
+  return 0;
+}
+
+static void bmcRemove(SIdxBmContainer* c, uint16_t v) {
+  if (IDX_BM_IS_BITSET(c)) {
+    uint64_t* w = &((uint64_t*)c->data)[v >> 6];
+    if ((*w & (1ull << (v & 63))) != 0) {
+      *w &= ~(1ull << (v & 63));
+      c->card--;
+      if (c->card <= IDX_BM_ARRAY_MAX) {
+        bmcToArray(c);
+      }
+    }
+    return;
+  }
+
+  uint16_t* arr = c->data;
+  int32_t   pos = bmArraySearch(arr, c->card, v);
+  if (pos < c->card && arr[pos] == v) {
+    memmove(arr + pos, arr + pos + 1, (c->card - pos - 1) * sizeof(uint16_t));
+    c->card--;
+  }
+}
+
+static int32_t bmcOr(SIdxBmContainer* dst, const SIdxBmContainer* src) {
+  if (!IDX_BM_IS_BITSET(dst) && !IDX_BM_IS_BITSET(src) && dst->card + src->card <= IDX_BM_ARRAY_MAX) {
+    int32_t   cap = TMAX(dst->card + src->card, 1);
+    uint16_t* arr = taosMemoryMalloc(cap * sizeof(uint16_t));
+    if (arr == NULL) {
+      return -1;
+    }
+
+    const uint16_t* a = dst->data;
+    const uint16_t* b = src->data;
+    int32_t         i = 0, j = 0, n = 0;
+    while (i < dst->card && j < src->card) {
+      if (a[i] < b[j]) {
+        arr[n++] = a[i++];
+      } else if (a[i] > b[j]) {
+        arr[n++] = b[j++];
+      } else {
+        arr[n++] = a[i++];
+        j++;
+      }
+    }
+    while (i < dst->card) arr[n++] = a[i++];
+    while (j < src->card) arr[n++] = b[j++];
+
+    taosMemoryFree(dst->data);
+    dst->data = arr;
+    dst->card = n;
+    dst->cap = cap;
+    return 0;
+  }
+
+  if (!IDX_BM_IS_BITSET(dst) && bmcToBitset(dst) != 0) {
+    return -1;
+  }
+
+  uint64_t* words = dst->data;
+  if (IDX_BM_IS_BITSET(src)) {
+    const uint64_t* sw = src->data;
+    for (int32_t i = 0; i < IDX_BM_BITSET_LEN; i++) {
+      words[i] |= sw[i];
+    }
+  } else {
+    const uint16_t* arr = src->data;
+    for (int32_t i = 0; i < src->card; i++) {
+      words[arr[i] >> 6] |= (1ull << (arr[i] & 63));
+    }
+  }
+  return bmcNormalize(dst);
+}
+
+static int32_t bmcAnd(SIdxBmContainer* dst, const SIdxBmContainer* src) {
+  if (!IDX_BM_IS_BITSET(dst)) {
+    uint16_t* arr = dst->data;
+    int32_t   n = 0;
+    for (int32_t i = 0; i < dst->card; i++) {
+      if (bmcContains(src, arr[i])) {
+        arr[n++] = arr[i];
+      }
+    }
+    dst->card = n;
+    return 0;
+  }
+
+  if (!IDX_BM_IS_BITSET(src)) {
+    // the result can not be larger than the array one
+    SIdxBmContainer c = {0};
+    if (bmcClone(&c, src) != 0) {
+      return -1;
+    }
+    bmcAnd(&c, dst);
+    bmcDestroy(dst);
+    *dst = c;
+    return 0;
+  }
+
+  uint64_t*       words = dst->data;
+  const uint64_t* sw = src->data;
+  for (int32_t i = 0; i < IDX_BM_BITSET_LEN; i++) {
+    words[i] &= sw[i];
+  }
+  return bmcNormalize(dst);
+}
+
+static int32_t bmcAndNot(SIdxBmContainer* dst, const SIdxBmContainer* src) {
+  if (!IDX_BM_IS_BITSET(dst)) {
+    uint16_t* arr = dst->data;
+    int32_t   n = 0;
+    for (int32_t i = 0; i < dst->card; i++) {
+      if (!bmcContains(src, arr[i])) {
+        arr[n++] = arr[i];
+      }
+    }
+    dst->card = n;
+    return 0;
+  }
+
+  uint64_t* words = dst->data;
+  if (IDX_BM_IS_BITSET(src)) {
+    const uint64_t* sw = src->data;
+    for (int32_t i = 0; i < IDX_BM_BITSET_LEN; i++) {
+      words[i] &= ~sw[i];
+    }
+  } else {
+    const uint16_t* arr = src->data;
+    for (int32_t i = 0; i < src->card; i++) {
+      words[arr[i] >> 6] &= ~(1ull << (arr[i] & 63));
+    }
+  }
+  return bmcNormalize(dst);
+}
+
+// lower bound of key in containers
+static int32_t bmSearchContainer(SArray* cs, uint64_t key) {
+  int32_t s = 0, e = (int32_t)taosArrayGetSize(cs);
+  while (s < e) {
+    int32_t          m = s + (e - s) / 2;
+    SIdxBmContainer* c = taosArrayGet(cs, m);
+    if (c->key < key) {
+      s = m + 1;
+    } else {
+      e = m;
+    }
+  }
+  return s;
+}
+
+static SIdxBmContainer* bmGetContainer(SIdxBitmap* bm, uint64_t key) {
+  SArray* cs = bm->containers;
+  int32_t sz = (int32_t)taosArrayGetSize(cs);
+
+  // fast path for sorted input
+  int32_t pos = sz;
+  if (sz > 0) {
+    SIdxBmContainer* last = taosArrayGetLast(cs);
+    if (last->key == key) return last;
+    if (last->key > key) pos = bmSearchContainer(cs, key);
+  }
+  if (pos < sz) {
+    SIdxBmContainer* c = taosArrayGet(cs, pos);
+    if (c->key == key) return c;
+  }
+  return NULL;
+}
+
+SIdxBitmap* idxBitmapCreate() {
+  SIdxBitmap* bm = taosMemoryCalloc(1, sizeof(SIdxBitmap));
+  if (bm == NULL) {
+    return NULL;
+  }
+  bm->containers = taosArrayInit(4, sizeof(SIdxBmContainer));
+  if (bm->containers == NULL) {
+    taosMemoryFree(bm);
+    return NULL;
+  }
+  return bm;
+}
+
+void idxBitmapDestroy(SIdxBitmap* bm) {
+  if (bm == NULL) {
+    return;
+  }
+  idxBitmapClear(bm);
+  taosArrayDestroy(bm->containers);
+  taosMemoryFree(bm);
+}
+
+void idxBitmapClear(SIdxBitmap* bm) {
+  if (bm == NULL) {
+    return;
+  }
+  for (int32_t i = 0; i < taosArrayGetSize(bm->containers); i++) {
+    bmcDestroy(taosArrayGet(bm->containers, i));
+  }
+  taosArrayClear(bm->containers);
+}
+
+int32_t idxBitmapAdd(SIdxBitmap* bm, uint64_t uid) {
+  uint64_t         key = IDX_BM_KEY(uid);
+  SIdxBmContainer* c = bmGetContainer(bm, key);
+  if (c == NULL) {
+    SIdxBmContainer nc = {0};
+    if (bmcInit(&nc, key) != 0) {
+      return -1;
+    }
+    int32_t pos = bmSearchContainer(bm->containers, key);
+    c = taosArrayInsert(bm->containers, pos, &nc);
+    if (c == NULL) {
+      bmcDestroy(&nc);
+      return -1;
+    }
+  }
+  return bmcAdd(c, IDX_BM_LOW(uid));
+}
+
+int32_t idxBitmapAddArray(SIdxBitmap* bm, SArray* uids) {
+  for (int32_t i = 0; i < taosArrayGetSize(uids); i++) {
+    if (idxBitmapAdd(bm, *(uint64_t*)taosArrayGet(uids, i)) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void idxBitmapRemove(SIdxBitmap* bm, uint64_t uid) {
+  SIdxBmContainer* c = bmGetContainer(bm, IDX_BM_KEY(uid));
+  if (c == NULL) {
+    return;
+  }
+  bmcRemove(c, IDX_BM_LOW(uid));
+  if (c->card == 0) {
+    int32_t pos = TARRAY_ELEM_IDX(bm->containers, c);
+    bmcDestroy(c);
+    taosArrayRemove(bm->containers, pos);
+  }
+}
+
+bool idxBitmapContains(SIdxBitmap* bm, uint64_t uid) {
+  SIdxBmContainer* c = bmGetContainer(bm, IDX_BM_KEY(uid));
+  return c != NULL && bmcContains(c, IDX_BM_LOW(uid));
+}
+
+int64_t idxBitmapCardinality(SIdxBitmap* bm) {
+  int64_t card = 0;
+  for (int32_t i = 0; i < taosArrayGetSize(bm->containers); i++) {
+    SIdxBmContainer* c = taosArrayGet(bm->containers, i);
+    card += c->card;
+  }
+  return card;
+}
+
+int32_t idxBitmapOr(SIdxBitmap* dst, SIdxBitmap* src) {
+  int32_t dsz = (int32_t)taosArrayGetSize(dst->containers);
+  int32_t ssz = (int32_t)taosArrayGetSize(src->containers);
+  if (ssz == 0) {
+    return 0;
+  }
+
+  SArray* cs = taosArrayInit(dsz + ssz, sizeof(SIdxBmContainer));
+  if (cs == NULL) {
+    return -1;
+  }
+
+  int32_t i = 0, j = 0, code = 0;
+  while (i < dsz || j < ssz) {
+    SIdxBmContainer* dc = i < dsz ? taosArrayGet(dst->containers, i) : NULL;
+    SIdxBmContainer* sc = j < ssz ? taosArrayGet(src->containers, j) : NULL;
+    if (sc == NULL || (dc != NULL && dc->key < sc->key)) {
+      taosArrayPush(cs, dc);
+      i++;
+    } else if (dc == NULL || dc->key > sc->key) {
+      SIdxBmContainer nc = {0};
+      if (code == 0 && bmcClone(&nc, sc) == 0) {
+        taosArrayPush(cs, &nc);
+      } else {
+        code = -1;
+      }
+      j++;
+    } else {
+      if (code == 0 && bmcOr(dc, sc) != 0) {
+        code = -1;
+      }
+      taosArrayPush(cs, dc);
+      i++;
+      j++;
+    }
+  }
+
+  // containers of dst are moved into the new array
+  taosArrayDestroy(dst->containers);
+  dst->containers = cs;
+  return code;
+}
+
+int32_t idxBitmapAnd(SIdxBitmap* dst, SIdxBitmap* src) {
+  int32_t dsz = (int32_t)taosArrayGetSize(dst->containers);
+  int32_t ssz = (int32_t)taosArrayGetSize(src->containers);
+
+  int32_t j = 0, n = 0, code = 0;
+  for (int32_t i = 0; i < dsz; i++) {
+    SIdxBmContainer* dc = taosArrayGet(dst->containers, i);
+    while (j < ssz && ((SIdxBmContainer*)taosArrayGet(src->containers, j))->key < dc->key) {
+      j++;
+    }
+
+    SIdxBmContainer* sc = j < ssz ? taosArrayGet(src->containers, j) : NULL;
+    if (sc == NULL || sc->key != dc->key) {
+      bmcDestroy(dc);
+      continue;
+    }
+    if (bmcAnd(dc, sc) != 0) code = -1;
+    if (dc->card == 0) {
+      bmcDestroy(dc);
+      continue;
+    }
+    if (n != i) taosArraySet(dst->containers, n, dc);
+    n++;
+  }
+  taosArrayPopTailBatch(dst->containers, dsz - n);
+  return code;
+}
+
+int32_t idxBitmapAndNot(SIdxBitmap* dst, SIdxBitmap* src) {
+  int32_t dsz = (int32_t)taosArrayGetSize(dst->containers);
+  int32_t ssz = (int32_t)taosArrayGetSize(src->containers);
+
+  int32_t j = 0, n = 0, code = 0;
+  for (int32_t i = 0; i < dsz; i++) {
+    SIdxBmContainer* dc = taosArrayGet(dst->containers, i);
+    while (j < ssz && ((SIdxBmContainer*)taosArrayGet(src->containers, j))->key < dc->key) {
+      j++;
+    }
+
+    SIdxBmContainer* sc = j < ssz ? taosArrayGet(src->containers, j) : NULL;
+    if (sc != NULL && sc->key == dc->key) {
+      if (bmcAndNot(dc, sc) != 0) code = -1;
+      if (dc->card == 0) {
+        bmcDestroy(dc);
+        continue;
+      }
+    }
+    if (n != i) taosArraySet(dst->containers, n, dc);
+    n++;
+  }
+  taosArrayPopTailBatch(dst->containers, dsz - n);
+  return code;
+}
+
+void idxBitmapToArray(SIdxBitmap* bm, SArray* out) {
+  taosArrayEnsureCap(out, taosArrayGetSize(out) + idxBitmapCardinality(bm));
+  for (int32_t i = 0; i < taosArrayGetSize(bm->containers); i++) {
+    SIdxBmContainer* c = taosArrayGet(bm->containers, i);
+    uint64_t         high = c->key << 16;
+    if (IDX_BM_IS_BITSET(c)) {
+      uint64_t* words = c->data;
+      for (int32_t k = 0; k < IDX_BM_BITSET_LEN; k++) {
+        uint64_t w = words[k];
+        while (w != 0) {
+          uint64_t uid = high | (uint64_t)(k * 64 + BUILDIN_CTZL(w));
+          taosArrayPush(out, &uid);
+          w &= (w - 1);
+        }
+      }
+    } else {
+      uint16_t* arr = c->data;
+      for (int32_t k = 0; k < c->card; k++) {
+        uint64_t uid = high | arr[k];
+        taosArrayPush(out, &uid);
+      }
+    }
+  }
+}
+
+int32_t idxBitmapSerialSize(SIdxBitmap* bm) {
+  int32_t len = sizeof(int32_t);
+  for (int32_t i = 0; i < taosArrayGetSize(bm->containers); i++) {
+    SIdxBmContainer* c = taosArrayGet(bm->containers, i);
+    len += IDX_BM_CONTAINER_HDR + (IDX_BM_IS_BITSET(c) ? IDX_BM_BITSET_SIZE : c->card * sizeof(uint16_t));
+  }
+  return len;
+}
+
+int32_t idxBitmapSerialize(SIdxBitmap* bm, char* buf) {
+  char*   p = buf;
+  int32_t sz = (int32_t)taosArrayGetSize(bm->containers);
+  SERIALIZE_VAR_TO_BUF(p, sz, int32_t);
+  for (int32_t i = 0; i < sz; i++) {
+    SIdxBmContainer* pc = taosArrayGet(bm->containers, i);
+    SERIALIZE_VAR_TO_BUF(p, pc->key, uint64_t);
+    SERIALIZE_VAR_TO_BUF(p, pc->card, int32_t);
+
+    int32_t len = IDX_BM_IS_BITSET(pc) ? IDX_BM_BITSET_SIZE : pc->card * sizeof(uint16_t);
+    SERIALIZE_STR_VAR_TO_BUF(p, pc->data, len);
+  }
+  return (int32_t)(p - buf);
+}
+
+SIdxBitmap* idxBitmapDeserialize(const char* buf, int32_t len) {
+  if (len < sizeof(int32_t)) {
+    return NULL;
+  }
+
+  SIdxBitmap* bm = idxBitmapCreate();
+  if (bm == NULL) {
+    return NULL;
+  }
+
+  const char* p = buf;
+  const char* end = buf + len;
+  int32_t     sz = *(int32_t*)p;
+  p += sizeof(int32_t);
+
+  for (int32_t i = 0; i < sz; i++) {
+    if (end - p < IDX_BM_CONTAINER_HDR) goto _err;
+
+    SIdxBmContainer c = {0};
+    memcpy(&c.key, p, sizeof(uint64_t));
+    p += sizeof(uint64_t);
+    memcpy(&c.card, p, sizeof(int32_t));
+    p += sizeof(int32_t);
+    if (c.card <= 0 || c.card > (1 << 16)) goto _err;
+
+    int32_t size = c.card <= IDX_BM_ARRAY_MAX ? c.card * sizeof(uint16_t) : IDX_BM_BITSET_SIZE;
+    if (end - p < size) goto _err;
+
+    c.cap = c.card <= IDX_BM_ARRAY_MAX ? c.card : 0;
+    c.data = taosMemoryMalloc(size);
+    if (c.data == NULL) goto _err;
+    memcpy(c.data, p, size);
+    p += size;
+
+    taosArrayPush(bm->containers, &c);
+  }
+  return bm;
+
+_err:
+  indexError("failed to deserialize bitmap, len:%d", len);
+  idxBitmapDestroy(bm);
+  return NULL;
+}
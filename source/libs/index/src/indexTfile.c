@@ -34,9 +34,16 @@ typedef struct TFileFstIter {
 
 #define TF_TABLE_TATOAL_SIZE(sz) (sizeof(sz) + sz * sizeof(uint64_t))
 
+// the posting list of a term is stored either as uid array
+//   |<--nid(int32_t)-->|<--uid(uint64_t) * nid-->|
+// or as bitmap, whichever is smaller
+//   |<--(-len)(int32_t)-->|<--bitmap of len bytes-->|
+#define TF_TABLE_BITMAP_SIZE(len) (sizeof(int32_t) + (len))
+
 static int  tfileStrCompare(const void* a, const void* b);
 static int  tfileValueCompare(const void* a, const void* b, const void* param);
-static void tfileSerialTableIdsToBuf(char* buf, SArray* tableIds);
+static int32_t tfileValueSerialSize(TFileValue* v, SIdxBitmap** ppBm);
+static void    tfileSerialTableIdsToBuf(char* buf, SArray* tableIds);
 
 static int tfileWriteHeader(TFileWriter* writer);
 static int tfileWriteFstOffset(TFileWriter* tw, int32_t offset);
@@ -47,7 +54,7 @@ static int tfileWriteFooter(TFileWriter* write);
 static int tfileReaderLoadHeader(TFileReader* reader);
 static int tfileReaderLoadFst(TFileReader* reader);
 static int tfileReaderVerify(TFileReader* reader);
-static int tfileReaderLoadTableIds(TFileReader* reader, int32_t offset, SArray* result);
+static int tfileReaderLoadTableIds(TFileReader* reader, int32_t offset, SIdxBitmap* result);
 
 static SArray* tfileGetFileList(const char* path);
 static int     tfileRmExpireFile(SArray* result);
@@ -378,7 +385,7 @@ static int32_t tfSearchTerm_JSON(void* reader, SIndexTerm* tem, SIdxTRslt* tr) {
     cost = taosGetTimestampUs() - et;
     indexInfo("index: %" PRIu64 ", col: %s, colVal: %s, load all table info, offset: %" PRIu64
               ", size: %d, time cost: %" PRIu64 "us",
-              tem->suid, tem->colName, tem->colVal, offset, (int)taosArrayGetSize(tr->total), cost);
+              tem->suid, tem->colName, tem->colVal, offset, (int)idxBitmapCardinality(tr->total), cost);
   }
   taosMemoryFree(p);
   fstSliceDestroy(&key);
@@ -556,14 +563,24 @@ int tfileWriterPut(TFileWriter* tw, void* data, bool order) {
   int32_t sz = taosArrayGetSize((SArray*)data);
   int32_t fstOffset = tw->offset;
 
+  // posting list in bitmap format, NULL if stored as uid array
+  SArray* bms = taosArrayInit(sz, POINTER_BYTES);
+  if (bms == NULL) {
+    return -1;
+  }
+
   // ugly code, refactor later
   for (size_t i = 0; i < sz; i++) {
     TFileValue* v = taosArrayGetP((SArray*)data, i);
     taosArraySort(v->tableId, idxUidCompare);
     taosArrayRemoveDuplicate(v->tableId, idxUidCompare, NULL);
-    int32_t tbsz = taosArrayGetSize(v->tableId);
-    if (tbsz == 0) continue;
-    fstOffset += TF_TABLE_TATOAL_SIZE(tbsz);
+
+    SIdxBitmap* bm = NULL;
+    int32_t     tbsz = taosArrayGetSize(v->tableId);
+    if (tbsz != 0) {
+      fstOffset += tfileValueSerialSize(v, &bm);
+    }
+    taosArrayPush(bms, &bm);
   }
   tfileWriteFstOffset(tw, fstOffset);
 
@@ -572,30 +589,38 @@ int tfileWriterPut(TFileWriter* tw, void* data, bool order) {
 
   for (size_t i = 0; i < sz; i++) {
     TFileValue* v = taosArrayGetP((SArray*)data, i);
+    SIdxBitmap* bm = taosArrayGetP(bms, i);
 
     int32_t tbsz = taosArrayGetSize(v->tableId);
     if (tbsz == 0) continue;
     // check buf has enough space or not
-    int32_t ttsz = TF_TABLE_TATOAL_SIZE(tbsz);
+    int32_t ttsz = bm != NULL ? TF_TABLE_BITMAP_SIZE(idxBitmapSerialSize(bm)) : TF_TABLE_TATOAL_SIZE(tbsz);
 
     if (cap < ttsz) {
       cap = ttsz;
       char* t = (char*)taosMemoryRealloc(buf, cap);
       if (t == NULL) {
         taosMemoryFree(buf);
+        taosArrayDestroyP(bms, (FDelete)idxBitmapDestroy);
         return -1;
       }
       buf = t;
     }
 
     char* p = buf;
-    tfileSerialTableIdsToBuf(p, v->tableId);
+    if (bm != NULL) {
+      SERIALIZE_VAR_TO_BUF(p, -(ttsz - (int32_t)sizeof(int32_t)), int32_t);
+      idxBitmapSerialize(bm, p);
+    } else {
+      tfileSerialTableIdsToBuf(p, v->tableId);
+    }
     tw->ctx->write(tw->ctx, buf, ttsz);
     v->offset = tw->offset;
     tw->offset += ttsz;
     memset(buf, 0, cap);
   }
   taosMemoryFree(buf);
+  taosArrayDestroyP(bms, (FDelete)idxBitmapDestroy);
 
   tw->fb = fstBuilderCreate(tw->ctx, 0);
   if (tw->fb == NULL) {
@@ -710,9 +735,14 @@ static bool tfileIteratorNext(Iterate* iiter) {
   offset = (uint64_t)(rt->out.out);
   swsResultDestroy(rt);
   // set up iterate value
-  if (tfileReaderLoadTableIds(tIter->rdr, offset, iv->val) != 0) {
+  SIdxBitmap* bm = idxBitmapCreate();
+  if (bm == NULL || tfileReaderLoadTableIds(tIter->rdr, offset, bm) != 0) {
+    idxBitmapDestroy(bm);
+    taosMemoryFree(colVal);
     return false;
   }
+  idxBitmapToArray(bm, iv->val);
+  idxBitmapDestroy(bm);
 
   iv->ver = 0;
   iv->type = ADD_VALUE;  // value in tfile always ADD_VALUE
@@ -820,6 +850,26 @@ void tfileValueDestroy(TFileValue* tf) {
   taosMemoryFree(tf->colVal);
   taosMemoryFree(tf);
 }
+// size of the posting list in tfile, the bitmap is returned if it is smaller than the uid array
+static int32_t tfileValueSerialSize(TFileValue* v, SIdxBitmap** ppBm) {
+  int32_t tbsz = taosArrayGetSize(v->tableId);
+  int32_t size = TF_TABLE_TATOAL_SIZE(tbsz);
+
+  SIdxBitmap* bm = idxBitmapCreate();
+  if (bm == NULL || idxBitmapAddArray(bm, v->tableId) != 0) {
+    idxBitmapDestroy(bm);
+    return size;
+  }
+
+  int32_t bmSize = TF_TABLE_BITMAP_SIZE(idxBitmapSerialSize(bm));
+  if (bmSize >= size) {
+    idxBitmapDestroy(bm);
+    return size;
+  }
+
+  *ppBm = bm;
+  return bmSize;
+}
 static void tfileSerialTableIdsToBuf(char* buf, SArray* ids) {
   int sz = taosArrayGetSize(ids);
   SERIALIZE_VAR_TO_BUF(buf, sz, int32_t);
@@ -923,7 +973,31 @@ static int tfileReaderLoadFst(TFileReader* reader) {
 
   return reader->fst != NULL ? 0 : -1;
 }
-static int tfileReaderLoadTableIds(TFileReader* reader, int32_t offset, SArray* result) {
+static int tfileReaderLoadBitmap(TFileReader* reader, int32_t offset, char* block, int32_t nread, int32_t len,
+                                 SIdxBitmap* result) {
+  char* buf = block + sizeof(int32_t);
+  if (len > nread - (int32_t)sizeof(int32_t)) {
+    buf = taosMemoryMalloc(len);
+    if (buf == NULL) {
+      return -1;
+    }
+    if (reader->ctx->readFrom(reader->ctx, buf, len, offset + sizeof(int32_t)) != len) {
+      indexError("failed to read bitmap, offset: %d, len: %d", offset, len);
+      taosMemoryFree(buf);
+      return -1;
+    }
+  }
+
+  SIdxBitmap* bm = idxBitmapDeserialize(buf, len);
+  int32_t     code = (bm == NULL) ? -1 : idxBitmapOr(result, bm);
+
+  idxBitmapDestroy(bm);
+  if (buf != block + sizeof(int32_t)) {
+    taosMemoryFree(buf);
+  }
+  return code;
+}
+static int tfileReaderLoadTableIds(TFileReader* reader, int32_t offset, SIdxBitmap* result) {
   // TODO(yihao): opt later
   IFileCtx* ctx = reader->ctx;
   // add block cache
@@ -935,10 +1009,14 @@ static int tfileReaderLoadTableIds(TFileReader* reader, int32_t offset, SArray*
   int32_t nid = *(int32_t*)p;
   p += sizeof(nid);
 
+  if (nid < 0) {
+    return tfileReaderLoadBitmap(reader, offset, block, nread, -nid, result);
+  }
+
   while (nid > 0) {
     int32_t left = block + sizeof(block) - p;
     if (left >= sizeof(uint64_t)) {
-      taosArrayPush(result, (uint64_t*)p);
+      idxBitmapAdd(result, *(uint64_t*)p);
       p += sizeof(uint64_t);
     } else {
       char buf[sizeof(uint64_t)] = {0};
@@ -949,7 +1027,7 @@ static int tfileReaderLoadTableIds(TFileReader* reader, int32_t offset, SArray*
       nread = ctx->readFrom(ctx, block, sizeof(block), offset);
       memcpy(buf + left, block, sizeof(uint64_t) - left);
 
-      taosArrayPush(result, (uint64_t*)buf);
+      idxBitmapAdd(result, *(uint64_t*)buf);
       p = block + sizeof(uint64_t) - left;
     }
     nid -= 1;
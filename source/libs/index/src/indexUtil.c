@@ -161,42 +161,36 @@ int verdataCompare(const void *a, const void *b) {
 SIdxTRslt *idxTRsltCreate() {
   SIdxTRslt *tr = taosMemoryCalloc(1, sizeof(SIdxTRslt));
 
-  tr->total = taosArrayInit(4, sizeof(uint64_t));
-  tr->add = taosArrayInit(4, sizeof(uint64_t));
-  tr->del = taosArrayInit(4, sizeof(uint64_t));
+  tr->total = idxBitmapCreate();
+  tr->add = idxBitmapCreate();
+  tr->del = idxBitmapCreate();
   return tr;
 }
 void idxTRsltClear(SIdxTRslt *tr) {
   if (tr == NULL) {
     return;
   }
-  taosArrayClear(tr->total);
-  taosArrayClear(tr->add);
-  taosArrayClear(tr->del);
+  idxBitmapClear(tr->total);
+  idxBitmapClear(tr->add);
+  idxBitmapClear(tr->del);
 }
 void idxTRsltDestroy(SIdxTRslt *tr) {
   if (tr == NULL) {
     return;
   }
-  taosArrayDestroy(tr->total);
-  taosArrayDestroy(tr->add);
-  taosArrayDestroy(tr->del);
+  idxBitmapDestroy(tr->total);
+  idxBitmapDestroy(tr->add);
+  idxBitmapDestroy(tr->del);
   taosMemoryFree(tr);
 }
 void idxTRsltMergeTo(SIdxTRslt *tr, SArray *result) {
-  taosArraySort(tr->total, uidCompare);
-  taosArraySort(tr->add, uidCompare);
-  taosArraySort(tr->del, uidCompare);
-
-  if (taosArrayGetSize(tr->total) == 0 || taosArrayGetSize(tr->add) == 0) {
-    SArray *t = taosArrayGetSize(tr->total) == 0 ? tr->add : tr->total;
-    taosArrayAddAll(result, t);
-  } else {
-    SArray *arrs = taosArrayInit(2, sizeof(void *));
-    taosArrayPush(arrs, &tr->total);
-    taosArrayPush(arrs, &tr->add);
-    iUnion(arrs, result);
-    taosArrayDestroy(arrs);
+  idxBitmapOr(tr->total, tr->add);
+  idxBitmapAndNot(tr->total, tr->del);
+  idxBitmapToArray(tr->total, result);
+}
+int32_t idxTRsltMergeToBitmap(SIdxTRslt *tr, SIdxBitmap *out) {
+  if (idxBitmapOr(tr->total, tr->add) != 0 || idxBitmapAndNot(tr->total, tr->del) != 0) {
+    return -1;
   }
-  iExcept(result, tr->del);
+  return idxBitmapOr(out, tr->total);
 }
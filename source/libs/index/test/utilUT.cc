@@ -5,6 +5,7 @@
 #include <thread>
 #include <vector>
 #include "index.h"
+#include "indexBitmap.h"
 #include "indexCache.h"
 #include "indexComm.h"
 #include "indexFst.h"
@@ -343,7 +344,7 @@ TEST_F(UtilEnv, TempResult) {
   SArray *f = taosArrayInit(0, sizeof(uint64_t));
 
   uint64_t val = UINT64_MAX - 1;
-  taosArrayPush(relt->add, &val);
+  idxBitmapAdd(relt->add, val);
   idxTRsltMergeTo(relt, f);
   EXPECT_EQ(taosArrayGetSize(f), 1);
 }
@@ -353,11 +354,82 @@ TEST_F(UtilEnv, TempResultExcept) {
   SArray *f = taosArrayInit(0, sizeof(uint64_t));
 
   uint64_t val = UINT64_MAX;
-  taosArrayPush(relt->add, &val);
+  idxBitmapAdd(relt->add, val);
   idxTRsltMergeTo(relt, f);
   EXPECT_EQ(taosArrayGetSize(f), 1);
 }
 
+TEST_F(UtilEnv, TempResultDel) {
+  SIdxTRslt *relt = idxTRsltCreate();
+
+  for (uint64_t i = 0; i < 100; i++) {
+    idxBitmapAdd(relt->total, i);
+  }
+  idxBitmapAdd(relt->add, 1000);
+  idxBitmapAdd(relt->del, 10);
+  idxBitmapAdd(relt->del, 1000);
+
+  SArray *f = taosArrayInit(0, sizeof(uint64_t));
+  idxTRsltMergeTo(relt, f);
+  EXPECT_EQ(taosArrayGetSize(f), 99);
+  EXPECT_EQ(*(uint64_t *)taosArrayGet(f, 10), 11);
+  taosArrayDestroy(f);
+  idxTRsltDestroy(relt);
+}
+TEST_F(UtilEnv, bitmapOper) {
+  // dense container (bitset) and sparse containers (array) in both bitmaps
+  SIdxBitmap *a = idxBitmapCreate();
+  SIdxBitmap *b = idxBitmapCreate();
+  for (uint64_t i = 0; i < 20000; i++) {
+    idxBitmapAdd(a, i);
+    if (i % 2 == 0) idxBitmapAdd(b, i);
+  }
+  for (uint64_t i = 0; i < 100; i++) {
+    idxBitmapAdd(a, ((i + 1) << 32) | 7);
+    idxBitmapAdd(b, ((i + 1) << 32) | 7);
+    idxBitmapAdd(b, UINT64_MAX - i);
+  }
+  EXPECT_EQ(idxBitmapCardinality(a), 20100);
+  EXPECT_EQ(idxBitmapCardinality(b), 10200);
+  EXPECT_TRUE(idxBitmapContains(a, 19999));
+  EXPECT_FALSE(idxBitmapContains(b, 19999));
+
+  int32_t len = idxBitmapSerialSize(a);
+  char   *buf = (char *)taosMemoryCalloc(1, len);
+  EXPECT_EQ(idxBitmapSerialize(a, buf), len);
+  SIdxBitmap *c = idxBitmapDeserialize(buf, len);
+  ASSERT_TRUE(c != NULL);
+  EXPECT_EQ(idxBitmapCardinality(c), 20100);
+  taosMemoryFree(buf);
+
+  idxBitmapAnd(c, b);
+  EXPECT_EQ(idxBitmapCardinality(c), 10100);
+  EXPECT_FALSE(idxBitmapContains(c, 1));
+
+  idxBitmapOr(c, b);
+  EXPECT_EQ(idxBitmapCardinality(c), 10200);
+
+  idxBitmapAndNot(a, b);
+  EXPECT_EQ(idxBitmapCardinality(a), 10000);
+
+  SArray *f = taosArrayInit(0, sizeof(uint64_t));
+  idxBitmapToArray(a, f);
+  EXPECT_EQ(taosArrayGetSize(f), 10000);
+  for (int32_t i = 0; i < taosArrayGetSize(f); i++) {
+    EXPECT_EQ(*(uint64_t *)taosArrayGet(f, i), (uint64_t)(2 * i + 1));
+  }
+
+  for (uint64_t i = 0; i < 20000; i++) {
+    idxBitmapRemove(a, i);
+  }
+  EXPECT_EQ(idxBitmapCardinality(a), 0);
+
+  taosArrayDestroy(f);
+  idxBitmapDestroy(a);
+  idxBitmapDestroy(b);
+  idxBitmapDestroy(c);
+}
+
 TEST_F(UtilEnv, testDictComm) {
   int32_t count = COMMON_INPUTS_LEN;
   for (int i = 0; i < 256; i++) {
@@ -371,6 +371,7 @@ static void monGenDnodeJson(SMonInfo *pMonitor) {
   double io_write_rate = io_write / interval;
   double io_read_disk_rate = io_read_disk / interval;
   double io_write_disk_rate = io_write_disk / interval;
+  double wal_fsync_avg_latency = pStat->numOfWalFsync > 0 ? (double)pStat->walFsyncUs / pStat->numOfWalFsync : 0;
 
   tjsonAddDoubleToObject(pJson, "uptime", pInfo->uptime);
   tjsonAddDoubleToObject(pJson, "cpu_engine", cpu_engine);
@@ -396,6 +397,12 @@ static void monGenDnodeJson(SMonInfo *pMonitor) {
   tjsonAddDoubleToObject(pJson, "req_insert_batch", pStat->numOfBatchInsertReqs);
   tjsonAddDoubleToObject(pJson, "req_insert_batch_success", pStat->numOfBatchInsertSuccessReqs);
   tjsonAddDoubleToObject(pJson, "req_insert_batch_rate", req_insert_batch_rate);
+  tjsonAddDoubleToObject(pJson, "tsdb_page_cache_hit", pStat->pageCacheHit);
+  tjsonAddDoubleToObject(pJson, "tsdb_page_cache_miss", pStat->pageCacheMiss);
+  tjsonAddDoubleToObject(pJson, "tsdb_page_cache_usage", pStat->pageCacheUsage);
+  tjsonAddDoubleToObject(pJson, "wal_fsync", pStat->numOfWalFsync);
+  tjsonAddDoubleToObject(pJson, "wal_fsync_entries", pStat->numOfWalFsyncEntries);
+  tjsonAddDoubleToObject(pJson, "wal_fsync_avg_latency", wal_fsync_avg_latency);
   tjsonAddDoubleToObject(pJson, "errors", pStat->errors);
   tjsonAddDoubleToObject(pJson, "vnodes_num", pStat->totalVnodes);
   tjsonAddDoubleToObject(pJson, "masters", pStat->masterNum);
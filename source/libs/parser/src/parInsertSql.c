@@ -1394,16 +1394,84 @@ static int32_t parseValuesClause(SInsertParseContext* pCxt, SVnodeModifOpStmt* p
   return code;
 }
 
-static int32_t parseCsvFile(SInsertParseContext* pCxt, SVnodeModifOpStmt* pStmt, STableDataBlocks* pDataBuf,
-                            int maxRows, int32_t* pNumOfRows) {
-  int32_t code = insInitRowBuilder(&pDataBuf->rowBuilder, pDataBuf->pTableMeta->sversion, &pDataBuf->boundColumnInfo);
+#define CSV_MIN_LINES_PER_CHUNK 1000
 
-  int32_t extendedRowSize = insGetExtendedRowSize(pDataBuf);
-  (*pNumOfRows) = 0;
+/*
+ * The lines of a csv batch are read into one buffer first, then split into chunks which are converted to rows
+ * concurrently. The rows of a line are written to its own slot of the data block, the slots of a chunk are compacted
+ * after the chunk is done.
+ */
+typedef struct SCsvParseChunk {
+  SInsertParseContext* pCxt;
+  STableDataBlocks     dataBuf;  // shallow copy of the data block, whose size is the first slot of the chunk
+  int32_t              start;
+  int32_t              num;
+  int32_t              numOfRows;
+  TSKEY                firstTs;
+  int32_t              code;
+} SCsvParseChunk;
+
+typedef struct SCsvParseJob {
+  char*           pLines;
+  int64_t*        pOffsets;
+  int32_t         extendedRowSize;
+  SCsvParseChunk* chunks;
+  int32_t         numOfChunks;
+  int32_t         nextChunk;
+  int32_t         numOfDone;
+  int32_t         ref;
+  tsem_t          sem;
+} SCsvParseJob;
+
+typedef struct SCsvLines {
+  char*    pBuf;
+  int64_t  len;
+  int64_t  cap;
+  int64_t* pOffsets;  // start of each line in pBuf, the lines are null terminated
+  int32_t  num;
+  int32_t  capOfLines;
+} SCsvLines;
+
+static int32_t appendCsvLine(SCsvLines* pLines, const char* pLine, int64_t len) {
+  if (pLines->len + len + 1 > pLines->cap) {
+    int64_t cap = TMAX(pLines->cap * 2, pLines->len + len + 1);
+    char*   tmp = taosMemoryRealloc(pLines->pBuf, cap);
+    if (NULL == tmp) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    pLines->pBuf = tmp;
+    pLines->cap = cap;
+  }
+  if (pLines->num >= pLines->capOfLines) {
+    int32_t  cap = TMAX(pLines->capOfLines * 2, 1024);
+    int64_t* tmp = taosMemoryRealloc(pLines->pOffsets, cap * sizeof(int64_t));
+    if (NULL == tmp) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    pLines->pOffsets = tmp;
+    pLines->capOfLines = cap;
+  }
+
+  memcpy(pLines->pBuf + pLines->len, pLine, len);
+  pLines->pBuf[pLines->len + len] = '\0';
+  pLines->pOffsets[pLines->num++] = pLines->len;
+  pLines->len += len + 1;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void destroyCsvLines(SCsvLines* pLines) {
+  taosMemoryFree(pLines->pBuf);
+  taosMemoryFree(pLines->pOffsets);
+}
+
+// read the lines of one batch, which is limited by maxMemUsedByInsert, empty lines are skipped
+static int32_t readCsvLines(SVnodeModifOpStmt* pStmt, int32_t maxLines, SCsvLines* pLines, bool* pFirstLine) {
+  int32_t code = TSDB_CODE_SUCCESS;
   char*   pLine = NULL;
   int64_t readLen = 0;
   bool    firstLine = (pStmt->fileProcessing == false);
   pStmt->fileProcessing = false;
+  *pFirstLine = false;
   while (TSDB_CODE_SUCCESS == code && (readLen = taosGetLineFile(pStmt->fp, &pLine)) != -1) {
     if (('\r' == pLine[readLen - 1]) || ('\n' == pLine[readLen - 1])) {
       pLine[--readLen] = '\0';
@@ -1414,36 +1482,241 @@ static int32_t parseCsvFile(SInsertParseContext* pCxt, SVnodeModifOpStmt* pStmt,
       continue;
     }
 
-    if ((*pNumOfRows) >= maxRows || pDataBuf->size + extendedRowSize >= pDataBuf->nAllocSize) {
-      code = allocateMemIfNeed(pDataBuf, extendedRowSize, &maxRows);
+    // only the first line of the file can be a header, which is skipped if it can't be parsed
+    if (firstLine) {
+      *pFirstLine = true;
+      firstLine = false;
     }
 
-    bool gotRow = false;
-    if (TSDB_CODE_SUCCESS == code) {
-      SToken token;
-      strtolower(pLine, pLine);
-      const char* pRow = pLine;
-      code = parseOneRow(pCxt, (const char**)&pRow, pDataBuf, &gotRow, &token);
-      if (code && firstLine) {
-        firstLine = false;
-        code = 0;
-        continue;
+    code = appendCsvLine(pLines, pLine, readLen);
+    if (TSDB_CODE_SUCCESS == code && pLines->num >= maxLines) {
+      pStmt->fileProcessing = true;
+      break;
+    }
+  }
+  taosMemoryFree(pLine);
+  return code;
+}
+
+static void parseCsvChunk(SCsvParseJob* pJob, SCsvParseChunk* pChunk) {
+  STableDataBlocks* pDataBuf = &pChunk->dataBuf;
+  for (int32_t i = pChunk->start; i < pChunk->start + pChunk->num && TSDB_CODE_SUCCESS == pChunk->code; ++i) {
+    char* pLine = pJob->pLines + pJob->pOffsets[i];
+    strtolower(pLine, pLine);
+
+    SToken      token;
+    bool        gotRow = false;
+    const char* pRow = pLine;
+    pChunk->code = parseOneRow(pChunk->pCxt, &pRow, pDataBuf, &gotRow, &token);
+    if (TSDB_CODE_SUCCESS == pChunk->code && gotRow) {
+      if (0 == pChunk->numOfRows) {
+        pChunk->firstTs = TD_ROW_KEY((STSRow*)(pDataBuf->pData + pDataBuf->size));
       }
+      pDataBuf->size += pJob->extendedRowSize;
+      ++pChunk->numOfRows;
     }
+  }
+}
 
-    if (TSDB_CODE_SUCCESS == code && gotRow) {
-      pDataBuf->size += extendedRowSize;
-      (*pNumOfRows)++;
+static void releaseCsvParseJob(SCsvParseJob* pJob) {
+  if (atomic_sub_fetch_32(&pJob->ref, 1) == 0) {
+    tsem_destroy(&pJob->sem);
+    taosMemoryFree(pJob);
+  }
+}
+
+// claim and parse the chunks until there is none left, chunks are only touched when claimed
+static int32_t csvParseJobFp(void* param) {
+  SCsvParseJob* pJob = (SCsvParseJob*)param;
+
+  while (1) {
+    int32_t index = atomic_fetch_add_32(&pJob->nextChunk, 1);
+    if (index >= pJob->numOfChunks) break;
+
+    parseCsvChunk(pJob, &pJob->chunks[index]);
+    if (atomic_add_fetch_32(&pJob->numOfDone, 1) == pJob->numOfChunks) {
+      tsem_post(&pJob->sem);
     }
+  }
 
-    if (TSDB_CODE_SUCCESS == code && pDataBuf->nAllocSize > tsMaxMemUsedByInsert * 1024 * 1024) {
-      pStmt->fileProcessing = true;
+  releaseCsvParseJob(pJob);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t runCsvParseJob(SCsvParseJob* pJob) {
+  pJob->ref = 1;
+  if (tsem_init(&pJob->sem, 0, 0) != 0) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 1; i < pJob->numOfChunks; ++i) {
+    atomic_add_fetch_32(&pJob->ref, 1);
+    if (taosAsyncExec(csvParseJobFp, pJob, NULL) != 0) {
+      atomic_sub_fetch_32(&pJob->ref, 1);
+      if (1 == i) {
+        parserDebug("task queue not available, parse %d csv chunks serially", pJob->numOfChunks);
+      }
       break;
     }
+  }
+
+  // the caller takes chunks too, so the job is done even if the task queue is busy or not running
+  atomic_add_fetch_32(&pJob->ref, 1);
+  csvParseJobFp(pJob);
+  tsem_wait(&pJob->sem);
+  releaseCsvParseJob(pJob);
+  return TSDB_CODE_SUCCESS;
+}
 
-    firstLine = false;
+static int32_t parseCsvLines(SInsertParseContext* pCxt, STableDataBlocks* pDataBuf, SCsvLines* pLines,
+                             int32_t startLine, int32_t* pNumOfRows) {
+  int32_t extendedRowSize = insGetExtendedRowSize(pDataBuf);
+  int32_t numOfLines = pLines->num - startLine;
+  int32_t numOfChunks = TMIN(tsCsvParseThreads, numOfLines / CSV_MIN_LINES_PER_CHUNK);
+  numOfChunks = TMAX(numOfChunks, 1);
+
+  int32_t         code = TSDB_CODE_SUCCESS;
+  SCsvParseJob*   pJob = taosMemoryCalloc(1, sizeof(SCsvParseJob));
+  SCsvParseChunk* chunks = taosMemoryCalloc(numOfChunks, sizeof(SCsvParseChunk));
+  if (NULL == pJob || NULL == chunks) {
+    taosMemoryFree(pJob);
+    taosMemoryFree(chunks);
+    return TSDB_CODE_OUT_OF_MEMORY;
   }
-  taosMemoryFree(pLine);
+
+  // the first chunk uses the context of the caller
+  int32_t start = startLine;
+  for (int32_t i = 0; i < numOfChunks; ++i) {
+    SCsvParseChunk* pChunk = &chunks[i];
+    pChunk->start = start;
+    pChunk->num = numOfLines / numOfChunks + ((i < numOfLines % numOfChunks) ? 1 : 0);
+    pChunk->dataBuf = *pDataBuf;
+    pChunk->dataBuf.size = pDataBuf->size + (start - startLine) * extendedRowSize;
+    pChunk->dataBuf.ordered = true;
+    pChunk->dataBuf.prevTS = INT64_MIN;
+    if (0 == i) {
+      pChunk->pCxt = pCxt;
+    } else {
+      pChunk->pCxt = taosMemoryMalloc(sizeof(SInsertParseContext));
+      char* pMsg = taosMemoryCalloc(1, pCxt->msg.len);
+      if (NULL == pChunk->pCxt || NULL == pMsg) {
+        taosMemoryFree(pChunk->pCxt);
+        taosMemoryFree(pMsg);
+        pChunk->pCxt = NULL;
+        numOfChunks = i;
+        code = TSDB_CODE_OUT_OF_MEMORY;
+        goto _end;
+      }
+      memcpy(pChunk->pCxt, pCxt, sizeof(SInsertParseContext));
+      pChunk->pCxt->msg.buf = pMsg;
+    }
+    start += pChunk->num;
+  }
+
+  pJob->pLines = pLines->pBuf;
+  pJob->pOffsets = pLines->pOffsets;
+  pJob->extendedRowSize = extendedRowSize;
+  pJob->chunks = chunks;
+  pJob->numOfChunks = numOfChunks;
+  if (numOfChunks > 1) {
+    code = runCsvParseJob(pJob);
+    if (TSDB_CODE_SUCCESS == code) {
+      pJob = NULL;
+    }
+  } else {
+    parseCsvChunk(pJob, &chunks[0]);
+  }
+
+  // the error of the first line in order is reported
+  for (int32_t i = 0; TSDB_CODE_SUCCESS == code && i < numOfChunks; ++i) {
+    if (TSDB_CODE_SUCCESS != chunks[i].code) {
+      code = chunks[i].code;
+      if (i > 0) {
+        tstrncpy(pCxt->msg.buf, chunks[i].pCxt->msg.buf, pCxt->msg.len);
+      }
+    }
+  }
+
+  // compact the rows of the chunks and merge the timestamp order
+  for (int32_t i = 0; TSDB_CODE_SUCCESS == code && i < numOfChunks; ++i) {
+    SCsvParseChunk* pChunk = &chunks[i];
+    int32_t         size = pChunk->numOfRows * extendedRowSize;
+    char*           pSrc = pChunk->dataBuf.pData + pChunk->dataBuf.size - size;
+    if (pSrc != pDataBuf->pData + pDataBuf->size) {
+      memmove(pDataBuf->pData + pDataBuf->size, pSrc, size);
+    }
+    pDataBuf->size += size;
+    *pNumOfRows += pChunk->numOfRows;
+
+    if (pChunk->numOfRows > 0 && pDataBuf->ordered) {
+      pDataBuf->ordered = pChunk->dataBuf.ordered && pChunk->firstTs > pDataBuf->prevTS;
+      pDataBuf->prevTS = pChunk->dataBuf.prevTS;
+    }
+  }
+
+_end:
+  for (int32_t i = 1; i < numOfChunks; ++i) {
+    taosMemoryFree(chunks[i].pCxt->msg.buf);
+    taosMemoryFree(chunks[i].pCxt);
+  }
+  taosMemoryFree(chunks);
+  taosMemoryFree(pJob);  // not started
+  return code;
+}
+
+static int32_t allocateMemForRows(STableDataBlocks* pDataBlock, int32_t rowSize, int32_t numOfRows) {
+  uint32_t nAllocSize = pDataBlock->size + (uint32_t)(numOfRows + 1) * rowSize;
+  if (nAllocSize <= pDataBlock->nAllocSize) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  char* tmp = taosMemoryRealloc(pDataBlock->pData, (size_t)nAllocSize);
+  if (NULL == tmp) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pDataBlock->pData = tmp;
+  memset(pDataBlock->pData + pDataBlock->nAllocSize, 0, nAllocSize - pDataBlock->nAllocSize);
+  pDataBlock->nAllocSize = nAllocSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t parseCsvFile(SInsertParseContext* pCxt, SVnodeModifOpStmt* pStmt, STableDataBlocks* pDataBuf,
+                            int32_t* pNumOfRows) {
+  int32_t code = insInitRowBuilder(&pDataBuf->rowBuilder, pDataBuf->pTableMeta->sversion, &pDataBuf->boundColumnInfo);
+
+  int32_t   extendedRowSize = insGetExtendedRowSize(pDataBuf);
+  int64_t   maxMem = (int64_t)tsMaxMemUsedByInsert * 1024 * 1024;
+  int32_t   maxLines = (int32_t)TMAX((maxMem - pDataBuf->size) / extendedRowSize, 1);
+  SCsvLines lines = {0};
+  bool      firstLine = false;
+  (*pNumOfRows) = 0;
+
+  if (TSDB_CODE_SUCCESS == code) {
+    code = readCsvLines(pStmt, maxLines, &lines, &firstLine);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = allocateMemForRows(pDataBuf, extendedRowSize, lines.num);
+  }
+
+  int32_t startLine = 0;
+  if (TSDB_CODE_SUCCESS == code && firstLine) {
+    char* pLine = lines.pBuf;
+    strtolower(pLine, pLine);
+
+    SToken      token;
+    bool        gotRow = false;
+    const char* pRow = pLine;
+    if (TSDB_CODE_SUCCESS == parseOneRow(pCxt, &pRow, pDataBuf, &gotRow, &token) && gotRow) {
+      pDataBuf->size += extendedRowSize;
+      (*pNumOfRows)++;
+    }
+    startLine = 1;
+  }
+
+  if (TSDB_CODE_SUCCESS == code && startLine < lines.num) {
+    code = parseCsvLines(pCxt, pDataBuf, &lines, startLine, pNumOfRows);
+  }
+  destroyCsvLines(&lines);
 
   if (TSDB_CODE_SUCCESS == code && 0 == (*pNumOfRows) &&
       (!TSDB_QUERY_HAS_TYPE(pStmt->insertType, TSDB_QUERY_TYPE_STMT_INSERT)) && !pStmt->fileProcessing) {
@@ -1453,12 +1726,8 @@ static int32_t parseCsvFile(SInsertParseContext* pCxt, SVnodeModifOpStmt* pStmt,
 }
 
 static int32_t parseDataFromFileImpl(SInsertParseContext* pCxt, SVnodeModifOpStmt* pStmt, STableDataBlocks* pDataBuf) {
-  int32_t maxNumOfRows = 0;
   int32_t numOfRows = 0;
-  int32_t code = allocateMemIfNeed(pDataBuf, insGetExtendedRowSize(pDataBuf), &maxNumOfRows);
-  if (TSDB_CODE_SUCCESS == code) {
-    code = parseCsvFile(pCxt, pStmt, pDataBuf, maxNumOfRows, &numOfRows);
-  }
+  int32_t code = parseCsvFile(pCxt, pStmt, pDataBuf, &numOfRows);
   if (TSDB_CODE_SUCCESS == code) {
     code = insSetBlockInfo((SSubmitBlk*)(pDataBuf->pData), pDataBuf, numOfRows, &pCxt->msg);
   }
@@ -16,6 +16,7 @@
 #include <gtest/gtest.h>
 
 #include "parTestUtil.h"
+#include "query.h"
 
 using namespace std;
 
@@ -84,4 +85,91 @@ TEST_F(ParserInsertTest, autoCreateTableTest) {
       "st1s2 (ts, c1, c2) USING st1 TAGS(2, 'abc', now) VALUES (now+1s, 2, 'shanghai')");
 }
 
+// INSERT INTO tb_name FILE csv_file_path
+namespace {
+
+const int32_t numOfFileRows = 10000;
+const int64_t fileStartTs = 1664000000000;
+
+}  // namespace
+
+class ParserInsertFileTest : public ParserInsertTest {
+ public:
+  // enough lines to be split into several chunks which are parsed concurrently
+  void writeFile(const char* pFile) {
+    TdFilePtr fp = taosOpenFile(pFile, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC | TD_FILE_STREAM);
+    ASSERT_NE(fp, nullptr);
+    taosFprintfFile(fp, "ts,c1,c2,c3,c4,c5\n");
+    for (int32_t i = 0; i < numOfFileRows; ++i) {
+      taosFprintfFile(fp, "%" PRId64 ",%d,'beijing',%d,%d.5,%d\n", fileStartTs + i, i, i, i, i);
+    }
+    taosCloseFile(&fp);
+  }
+
+  // the rows of all chunks are in the submit block of t1 in the order of the file, without the header line
+  virtual void checkDdl(const SQuery* pQuery, ParserStage stage) {
+    ASSERT_EQ(nodeType(pQuery->pRoot), QUERY_NODE_VNODE_MODIF_STMT);
+    SVnodeModifOpStmt* pStmt = (SVnodeModifOpStmt*)pQuery->pRoot;
+    ASSERT_EQ(taosArrayGetSize(pStmt->pDataBlocks), 1);
+    SVgDataBlocks* pVgData = (SVgDataBlocks*)taosArrayGetP(pStmt->pDataBlocks, 0);
+    ASSERT_EQ(pVgData->numOfTables, 1);
+
+    SSchema schema[] = {{TSDB_DATA_TYPE_TIMESTAMP, 0, 1, 8}, {TSDB_DATA_TYPE_INT, 0, 2, 4},
+                        {TSDB_DATA_TYPE_BINARY, 0, 3, 20},   {TSDB_DATA_TYPE_BIGINT, 0, 4, 8},
+                        {TSDB_DATA_TYPE_DOUBLE, 0, 5, 8},    {TSDB_DATA_TYPE_DOUBLE, 0, 6, 8}};
+    STSchema* pTSchema = tBuildTSchema(schema, tListLen(schema), 1);
+    ASSERT_NE(pTSchema, nullptr);
+
+    SSubmitMsgIter msgIter = {0};
+    SSubmitBlk*    pBlock = NULL;
+    ASSERT_EQ(tInitSubmitMsgIter((SSubmitReq*)pVgData->pData, &msgIter), 0);
+    ASSERT_EQ(tGetSubmitMsgNext(&msgIter, &pBlock), 0);
+    ASSERT_NE(pBlock, nullptr);
+    ASSERT_EQ(msgIter.numOfRows, numOfFileRows);
+
+    SSubmitBlkIter blkIter = {0};
+    ASSERT_EQ(tInitSubmitBlkIter(&msgIter, pBlock, &blkIter), 0);
+    int32_t numOfRead = 0;
+    STSRow* pRow = NULL;
+    while (NULL != (pRow = tGetSubmitBlkNext(&blkIter))) {
+      ASSERT_EQ(TD_ROW_KEY(pRow), fileStartTs + numOfRead);
+      SColVal colVal = {0};
+      tTSRowGetVal(pRow, pTSchema, 1, &colVal);
+      ASSERT_EQ(*(int32_t*)&colVal.value.val, numOfRead);
+      tTSRowGetVal(pRow, pTSchema, 2, &colVal);
+      ASSERT_EQ(string((const char*)colVal.value.pData, colVal.value.nData), "beijing");
+      tTSRowGetVal(pRow, pTSchema, 4, &colVal);
+      ASSERT_EQ(*(double*)&colVal.value.val, numOfRead + 0.5);
+      ++numOfRead;
+    }
+    ASSERT_EQ(numOfRead, numOfFileRows);
+
+    ASSERT_EQ(tGetSubmitMsgNext(&msgIter, &pBlock), 0);
+    ASSERT_EQ(pBlock, nullptr);
+    taosMemoryFree(pTSchema);
+  }
+};
+
+TEST_F(ParserInsertFileTest, fileTest) {
+  useDb("root", "test");
+
+  const char* pFile = TD_TMP_DIR_PATH "parInsertFileTest.csv";
+  writeFile(pFile);
+  string sql = string("INSERT INTO t1 FILE '") + pFile + "'";
+
+  // the chunks are parsed by the caller one by one if the task queue is not running
+  run(sql);
+
+  int32_t csvParseThreads = tsCsvParseThreads;
+  tsCsvParseThreads = 1;
+  run(sql);
+  tsCsvParseThreads = csvParseThreads;
+
+  ASSERT_EQ(initTaskQueue(), 0);
+  run(sql);
+  ASSERT_EQ(cleanupTaskQueue(), 0);
+
+  taosRemoveFile(pFile);
+}
+
 }  // namespace ParserTest
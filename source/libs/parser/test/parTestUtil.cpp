@@ -283,6 +283,9 @@ class ParserTestBaseImpl {
     DO_WITH_THROW(parseInsertSql, pCxt, pQuery, pCatalogReq, pMetaData);
     ASSERT_NE(*pQuery, nullptr);
     res_.parsedAst_ = toString((*pQuery)->pRoot);
+    if (QUERY_EXEC_STAGE_SCHEDULE == (*pQuery)->execStage) {
+      checkQuery(*pQuery, PARSER_STAGE_TRANSLATE);
+    }
   }
 
   void doContinueParseSql(SParseContext* pCxt, SCatalogReq* pCatalogReq, const SMetaData* pMetaData, SQuery* pQuery) {
@@ -2481,6 +2481,36 @@ static int32_t pushDownLimitOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLog
   return TSDB_CODE_SUCCESS;
 }
 
+static bool pushDownLimitToSortOptShouldBeOptimized(SLogicNode* pNode) {
+  if (QUERY_NODE_LOGIC_PLAN_PROJECT != nodeType(pNode) || NULL == pNode->pLimit || NULL != pNode->pSlimit ||
+      NULL != pNode->pConditions || 1 != LIST_LENGTH(pNode->pChildren)) {
+    return false;
+  }
+
+  SLogicNode* pChild = (SLogicNode*)nodesListGetNode(pNode->pChildren, 0);
+  return QUERY_NODE_LOGIC_PLAN_SORT == nodeType(pChild) && !((SSortLogicNode*)pChild)->groupSort &&
+         NULL == pChild->pLimit && NULL == pChild->pSlimit && NULL == pChild->pConditions;
+}
+
+// the sort only outputs the first offset + limit rows, which is a top-N sort, and the project still applies the offset
+static int32_t pushDownLimitToSortOptimize(SOptimizeContext* pCxt, SLogicSubplan* pLogicSubplan) {
+  SLogicNode* pNode = optFindPossibleNode(pLogicSubplan->pNode, pushDownLimitToSortOptShouldBeOptimized);
+  if (NULL == pNode) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SLogicNode* pChild = (SLogicNode*)nodesListGetNode(pNode->pChildren, 0);
+  pChild->pLimit = nodesCloneNode(pNode->pLimit);
+  if (NULL == pChild->pLimit) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  ((SLimitNode*)pChild->pLimit)->limit += ((SLimitNode*)pChild->pLimit)->offset;
+  ((SLimitNode*)pChild->pLimit)->offset = 0;
+  pCxt->optimized = true;
+
+  return TSDB_CODE_SUCCESS;
+}
+
 typedef struct STbCntScanOptInfo {
   SAggLogicNode*  pAgg;
   SScanLogicNode* pScan;
@@ -2733,6 +2763,7 @@ static const SOptimizeRule optimizeRuleSet[] = {
   {.pName = "LastRowScan",                .optimizeFunc = lastRowScanOptimize},
   {.pName = "TagScan",                    .optimizeFunc = tagScanOptimize},
   {.pName = "PushDownLimit",              .optimizeFunc = pushDownLimitOptimize},
+  {.pName = "PushDownLimitToSort",        .optimizeFunc = pushDownLimitToSortOptimize},
   {.pName = "TableCountScan",             .optimizeFunc = tableCountScanOptimize},
 };
 // clang-format on
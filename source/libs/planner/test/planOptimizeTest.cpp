@@ -151,3 +151,11 @@ TEST_F(PlanOptimizeTest, pushDownLimit) {
 
   run("SELECT c1 FROM st1 LIMIT 20 OFFSET 10");
 }
+
+TEST_F(PlanOptimizeTest, pushDownLimitToSort) {
+  useDb("root", "test");
+
+  run("SELECT c1 FROM t1 ORDER BY c2 DESC LIMIT 10");
+
+  run("SELECT c1 FROM st1 ORDER BY c2 DESC LIMIT 20 OFFSET 10");
+}
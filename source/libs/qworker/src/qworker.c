@@ -323,7 +323,8 @@ int32_t qwGetQueryResFromSink(QW_FPARAMS_DEF, SQWTaskCtx *ctx, int32_t *dataLen,
     pOutput->precision = output.precision;
     pOutput->bufStatus = output.bufStatus;
     pOutput->useconds = output.useconds;
-    pOutput->compressed = output.compressed;
+    // blocks are self-described, the rsp is marked as compressed if any of them is compressed
+    pOutput->compressed = pOutput->compressed || output.compressed;
     pOutput->numOfCols = output.numOfCols;
     pOutput->numOfRows += output.numOfRows;
     pOutput->numOfBlocks++;
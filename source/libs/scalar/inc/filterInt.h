@@ -488,6 +488,10 @@ struct SFilterInfo {
 extern bool          filterDoCompare(__compar_fn_t func, uint8_t optr, void *left, void *right);
 extern __compar_fn_t filterGetCompFunc(int32_t type, int32_t optr);
 extern __compar_fn_t filterGetCompFuncEx(int32_t lType, int32_t rType, int32_t optr);
+extern bool filterExecuteImpl(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes, SColumnDataAgg *statis,
+                              int16_t numOfCols, int32_t *numOfQualified);
+extern bool filterExecuteImplBitmap(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes, SColumnDataAgg *statis,
+                                    int16_t numOfCols, int32_t *numOfQualified);
 
 #ifdef __cplusplus
 }
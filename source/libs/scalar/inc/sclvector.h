@@ -103,6 +103,20 @@ static FORCE_INLINE _getDoubleValue_fn_t getVectorDoubleValueFn(int32_t srcType)
   return p;
 }
 
+// Compare kernels that write a packed selection bitmap, with the same bit layout as the null bitmap of
+// SColumnInfoData. Null values are not taken into account. They return false if the types or the operator are not
+// supported, and the comparator of filterGetCompFunc should be used instead.
+bool vectorCompareValBitmap(int32_t colType, const void *pCol, int32_t valType, const void *pVal, int32_t optr,
+                            int32_t numOfRows, uint8_t *pBitmap);
+bool vectorCompareColBitmap(int32_t type, const void *pLeft, const void *pRight, int32_t optr, int32_t numOfRows,
+                            uint8_t *pBitmap);
+
+void    vectorBitmapAnd(uint8_t *pDst, const uint8_t *pSrc, int32_t numOfRows);
+void    vectorBitmapOr(uint8_t *pDst, const uint8_t *pSrc, int32_t numOfRows);
+void    vectorBitmapAndNot(uint8_t *pDst, const uint8_t *pSrc, int32_t numOfRows);
+void    vectorBitmapNot(uint8_t *pDst, int32_t numOfRows);
+int32_t vectorBitmapToBool(const uint8_t *pBitmap, int32_t numOfRows, int8_t *pRes);
+
 typedef void (*_bufConverteFunc)(char *buf, SScalarParam *pOut, int32_t outType, int32_t *overflow);
 typedef void (*_bin_scalar_fn_t)(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *output, int32_t order);
 _bin_scalar_fn_t getBinScalarOperatorFn(int32_t binOperator);
@@ -20,6 +20,7 @@
 #include "filterInt.h"
 #include "functionMgt.h"
 #include "sclInt.h"
+#include "sclvector.h"
 #include "tcompare.h"
 #include "tdatablock.h"
 #include "ttime.h"
@@ -3326,6 +3327,137 @@ bool filterExecuteImpl(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes, SC
   return all;
 }
 
+static bool filterUnitSupportBitmap(SFilterComUnit *cunit) {
+  if (!IS_MATHABLE_TYPE(cunit->dataType)) {
+    return false;
+  }
+
+  if (cunit->optr == OP_TYPE_IS_NULL || cunit->optr == OP_TYPE_IS_NOT_NULL) {
+    return true;
+  }
+
+  if (cunit->rfunc >= 0) {
+    return true;
+  }
+
+  return cunit->valData != NULL && cunit->optr >= OP_TYPE_GREATER_THAN && cunit->optr <= OP_TYPE_NOT_EQUAL;
+}
+
+static bool filterSupportBitmap(SFilterInfo *info) {
+  for (uint32_t i = 0; i < info->unitNum; ++i) {
+    if (!filterUnitSupportBitmap(&info->cunits[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void filterCompareUnitBitmap(SFilterComUnit *cunit, int32_t optr, void *valData, int32_t numOfRows,
+                                    uint8_t *pBitmap) {
+  SColumnInfoData *pCol = (SColumnInfoData *)cunit->colData;
+  bool res = vectorCompareValBitmap(cunit->dataType, pCol->pData, cunit->dataType, valData, optr, numOfRows, pBitmap);
+  ASSERT(res);
+}
+
+// Evaluate one unit into a selection bitmap, pTmp is used for the upper bound of a range.
+static void filterExecuteUnitBitmap(SFilterComUnit *cunit, int32_t numOfRows, uint8_t *pBitmap, uint8_t *pTmp) {
+  SColumnInfoData *pCol = (SColumnInfoData *)cunit->colData;
+  const uint8_t   *pNull = (pCol->hasNull && pCol->nullbitmap != NULL) ? (const uint8_t *)pCol->nullbitmap : NULL;
+  int32_t          len = BitmapLen(numOfRows);
+
+  if (cunit->optr == OP_TYPE_IS_NULL || cunit->optr == OP_TYPE_IS_NOT_NULL) {
+    if (pNull != NULL) {
+      memcpy(pBitmap, pNull, len);
+    } else {
+      memset(pBitmap, 0, len);
+    }
+
+    if (cunit->optr == OP_TYPE_IS_NOT_NULL) {
+      vectorBitmapNot(pBitmap, numOfRows);
+    }
+    return;
+  }
+
+  switch (cunit->rfunc) {
+    case -1:
+      filterCompareUnitBitmap(cunit, cunit->optr, cunit->valData, numOfRows, pBitmap);
+      break;
+    case 0:  // (valData, valData2)
+    case 1:  // (valData, valData2]
+    case 2:  // [valData, valData2)
+    case 3:  // [valData, valData2]
+      filterCompareUnitBitmap(cunit, (cunit->rfunc <= 1) ? OP_TYPE_GREATER_THAN : OP_TYPE_GREATER_EQUAL,
+                              cunit->valData, numOfRows, pBitmap);
+      filterCompareUnitBitmap(cunit, (cunit->rfunc & 0x1) ? OP_TYPE_LOWER_EQUAL : OP_TYPE_LOWER_THAN,
+                              cunit->valData2, numOfRows, pTmp);
+      vectorBitmapAnd(pBitmap, pTmp, numOfRows);
+      break;
+    case 4:
+      filterCompareUnitBitmap(cunit, OP_TYPE_GREATER_THAN, cunit->valData, numOfRows, pBitmap);
+      break;
+    case 5:
+      filterCompareUnitBitmap(cunit, OP_TYPE_GREATER_EQUAL, cunit->valData, numOfRows, pBitmap);
+      break;
+    case 6:
+      filterCompareUnitBitmap(cunit, OP_TYPE_LOWER_THAN, cunit->valData2, numOfRows, pBitmap);
+      break;
+    default:
+      filterCompareUnitBitmap(cunit, OP_TYPE_LOWER_EQUAL, cunit->valData2, numOfRows, pBitmap);
+      break;
+  }
+
+  if (pNull != NULL) {
+    vectorBitmapAndNot(pBitmap, pNull, numOfRows);
+  }
+}
+
+// All units are numeric comparisons with constants, each unit is evaluated into a bitmap by the typed compare
+// kernels, the units of a group are combined by AND and the groups by OR.
+bool filterExecuteImplBitmap(void *pinfo, int32_t numOfRows, SColumnInfoData *pRes, SColumnDataAgg *statis,
+                             int16_t numOfCols, int32_t *numOfQualified) {
+  SFilterInfo *info = (SFilterInfo *)pinfo;
+  bool         all = true;
+
+  if (filterExecuteBasedOnStatis(info, numOfRows, pRes, statis, numOfCols, &all) == 0) {
+    return all;
+  }
+
+  if (numOfRows <= 0) {
+    return all;
+  }
+
+  int32_t  len = BitmapLen(numOfRows);
+  uint8_t *pBuf = taosMemoryCalloc(4, len);
+  if (pBuf == NULL) {
+    return filterExecuteImpl(info, numOfRows, pRes, statis, numOfCols, numOfQualified);
+  }
+
+  uint8_t *pResult = pBuf;
+  uint8_t *pGroup = pBuf + len;
+  uint8_t *pUnit = pBuf + len * 2;
+  uint8_t *pTmp = pBuf + len * 3;
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup *group = &info->groups[g];
+    for (uint32_t u = 0; u < group->unitNum; ++u) {
+      SFilterComUnit *cunit = &info->cunits[group->unitIdxs[u]];
+      filterExecuteUnitBitmap(cunit, numOfRows, (u == 0) ? pGroup : pUnit, pTmp);
+      if (u > 0) {
+        vectorBitmapAnd(pGroup, pUnit, numOfRows);
+      }
+    }
+
+    vectorBitmapOr(pResult, pGroup, numOfRows);
+  }
+
+  int32_t num = vectorBitmapToBool(pResult, numOfRows, (int8_t *)pRes->pData);
+  taosMemoryFree(pBuf);
+
+  *numOfQualified += num;
+  return num == numOfRows;
+}
+
 int32_t filterSetExecFunc(SFilterInfo *info) {
   if (FILTER_ALL_RES(info)) {
     info->func = filterExecuteImplAll;
@@ -3337,6 +3469,11 @@ int32_t filterSetExecFunc(SFilterInfo *info) {
     return TSDB_CODE_SUCCESS;
   }
 
+  if (filterSupportBitmap(info)) {
+    info->func = filterExecuteImplBitmap;
+    return TSDB_CODE_SUCCESS;
+  }
+
   if (info->unitNum > 1) {
     info->func = filterExecuteImpl;
     return TSDB_CODE_SUCCESS;
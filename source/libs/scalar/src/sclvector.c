@@ -1069,6 +1069,270 @@ static void doReleaseVec(SColumnInfoData *pCol, int32_t type) {
   }
 }
 
+// Type-specialized kernels for +, - and * over fixed-width numeric columns. The loops contain neither function calls
+// nor null checks, so the compiler is able to vectorize them; the null bitmaps of the operands are merged separately
+// a word at a time.
+enum {
+  SCL_MATH_ADD = 0,
+  SCL_MATH_SUB,
+  SCL_MATH_MULTI,
+  SCL_MATH_MAX,
+};
+
+#define SCL_MATH_TYPE_NUM (TSDB_DATA_TYPE_UBIGINT + 1)
+
+typedef void (*_math_vv_fn_t)(const void *pLeft, const void *pRight, double *pOut, int32_t numOfRows);
+typedef void (*_math_vs_fn_t)(const void *pCol, double v, double *pOut, int32_t numOfRows);
+
+#define SCL_MATH_VV_KERNEL(_name, _op, _lt, _rt)                                             \
+  static void _name(const void *pLeft, const void *pRight, double *pOut, int32_t numOfRows) { \
+    const _lt *l = (const _lt *)pLeft;                                                      \
+    const _rt *r = (const _rt *)pRight;                                                     \
+    for (int32_t i = 0; i < numOfRows; ++i) {                                               \
+      pOut[i] = (double)l[i] _op(double) r[i];                                              \
+    }                                                                                       \
+  }
+
+// column op scalar
+#define SCL_MATH_VS_KERNEL(_name, _op, _t)                                         \
+  static void _name(const void *pCol, double v, double *pOut, int32_t numOfRows) { \
+    const _t *p = (const _t *)pCol;                                                \
+    for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+      pOut[i] = (double)p[i] _op v;                                                \
+    }                                                                              \
+  }
+
+// scalar op column
+#define SCL_MATH_SV_KERNEL(_name, _op, _t)                                         \
+  static void _name(const void *pCol, double v, double *pOut, int32_t numOfRows) { \
+    const _t *p = (const _t *)pCol;                                                \
+    for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+      pOut[i] = v _op(double) p[i];                                                \
+    }                                                                              \
+  }
+
+#define SCL_MATH_KERNEL_OPS(_def, _suffix, ...) \
+  _def(sclMathAdd##_suffix, +, __VA_ARGS__)     \
+  _def(sclMathSub##_suffix, -, __VA_ARGS__)     \
+  _def(sclMathMulti##_suffix, *, __VA_ARGS__)
+
+#define SCL_MATH_KERNEL_ALL_TYPES(_def, _shape, ...)                     \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_TINYINT, __VA_ARGS__ int8_t)       \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_SMALLINT, __VA_ARGS__ int16_t)     \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_INT, __VA_ARGS__ int32_t)          \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_BIGINT, __VA_ARGS__ int64_t)       \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_UTINYINT, __VA_ARGS__ uint8_t)     \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_USMALLINT, __VA_ARGS__ uint16_t)   \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_UINT, __VA_ARGS__ uint32_t)        \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_UBIGINT, __VA_ARGS__ uint64_t)     \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_FLOAT, __VA_ARGS__ float)          \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_DOUBLE, __VA_ARGS__ double)        \
+  SCL_MATH_KERNEL_OPS(_def, _shape##_BOOL, __VA_ARGS__ bool)
+
+SCL_MATH_KERNEL_ALL_TYPES(SCL_MATH_VS_KERNEL, VS)
+SCL_MATH_KERNEL_ALL_TYPES(SCL_MATH_SV_KERNEL, SV)
+
+// double op any type, used directly and as the fallback of the type pairs that have no dedicated kernel
+SCL_MATH_KERNEL_ALL_TYPES(SCL_MATH_VV_KERNEL, VV_DOUBLE, double, )
+
+// the most common type pairs
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_INT_INT, int32_t, int32_t)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_INT_BIGINT, int32_t, int64_t)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_INT_FLOAT, int32_t, float)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_INT_DOUBLE, int32_t, double)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_BIGINT_INT, int64_t, int32_t)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_BIGINT_BIGINT, int64_t, int64_t)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_BIGINT_FLOAT, int64_t, float)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_BIGINT_DOUBLE, int64_t, double)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_FLOAT_INT, float, int32_t)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_FLOAT_BIGINT, float, int64_t)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_FLOAT_FLOAT, float, float)
+SCL_MATH_KERNEL_OPS(SCL_MATH_VV_KERNEL, VV_FLOAT_DOUBLE, float, double)
+
+#define SCL_MATH_KERNEL_ROW(_op, _shape)                                                     \
+  {                                                                                          \
+    [TSDB_DATA_TYPE_BOOL] = sclMath##_op##_shape##_BOOL,                                     \
+    [TSDB_DATA_TYPE_TINYINT] = sclMath##_op##_shape##_TINYINT,                               \
+    [TSDB_DATA_TYPE_SMALLINT] = sclMath##_op##_shape##_SMALLINT,                             \
+    [TSDB_DATA_TYPE_INT] = sclMath##_op##_shape##_INT,                                       \
+    [TSDB_DATA_TYPE_BIGINT] = sclMath##_op##_shape##_BIGINT,                                 \
+    [TSDB_DATA_TYPE_FLOAT] = sclMath##_op##_shape##_FLOAT,                                   \
+    [TSDB_DATA_TYPE_DOUBLE] = sclMath##_op##_shape##_DOUBLE,                                 \
+    [TSDB_DATA_TYPE_TIMESTAMP] = sclMath##_op##_shape##_BIGINT,                              \
+    [TSDB_DATA_TYPE_UTINYINT] = sclMath##_op##_shape##_UTINYINT,                             \
+    [TSDB_DATA_TYPE_USMALLINT] = sclMath##_op##_shape##_USMALLINT,                           \
+    [TSDB_DATA_TYPE_UINT] = sclMath##_op##_shape##_UINT,                                     \
+    [TSDB_DATA_TYPE_UBIGINT] = sclMath##_op##_shape##_UBIGINT,                               \
+  }
+
+#define SCL_MATH_KERNEL_PAIRS(_op)                                                                     \
+  {                                                                                                    \
+    [TSDB_DATA_TYPE_INT][TSDB_DATA_TYPE_INT] = sclMath##_op##VV_INT_INT,                               \
+    [TSDB_DATA_TYPE_INT][TSDB_DATA_TYPE_BIGINT] = sclMath##_op##VV_INT_BIGINT,                         \
+    [TSDB_DATA_TYPE_INT][TSDB_DATA_TYPE_FLOAT] = sclMath##_op##VV_INT_FLOAT,                           \
+    [TSDB_DATA_TYPE_INT][TSDB_DATA_TYPE_DOUBLE] = sclMath##_op##VV_INT_DOUBLE,                         \
+    [TSDB_DATA_TYPE_BIGINT][TSDB_DATA_TYPE_INT] = sclMath##_op##VV_BIGINT_INT,                         \
+    [TSDB_DATA_TYPE_BIGINT][TSDB_DATA_TYPE_BIGINT] = sclMath##_op##VV_BIGINT_BIGINT,                   \
+    [TSDB_DATA_TYPE_BIGINT][TSDB_DATA_TYPE_FLOAT] = sclMath##_op##VV_BIGINT_FLOAT,                     \
+    [TSDB_DATA_TYPE_BIGINT][TSDB_DATA_TYPE_DOUBLE] = sclMath##_op##VV_BIGINT_DOUBLE,                   \
+    [TSDB_DATA_TYPE_FLOAT][TSDB_DATA_TYPE_INT] = sclMath##_op##VV_FLOAT_INT,                           \
+    [TSDB_DATA_TYPE_FLOAT][TSDB_DATA_TYPE_BIGINT] = sclMath##_op##VV_FLOAT_BIGINT,                     \
+    [TSDB_DATA_TYPE_FLOAT][TSDB_DATA_TYPE_FLOAT] = sclMath##_op##VV_FLOAT_FLOAT,                       \
+    [TSDB_DATA_TYPE_FLOAT][TSDB_DATA_TYPE_DOUBLE] = sclMath##_op##VV_FLOAT_DOUBLE,                     \
+    [TSDB_DATA_TYPE_DOUBLE] = SCL_MATH_KERNEL_ROW(_op, VV_DOUBLE),                                     \
+  }
+
+static const _math_vs_fn_t gMathVSKernel[SCL_MATH_MAX][SCL_MATH_TYPE_NUM] = {
+    SCL_MATH_KERNEL_ROW(Add, VS), SCL_MATH_KERNEL_ROW(Sub, VS), SCL_MATH_KERNEL_ROW(Multi, VS)};
+
+static const _math_vs_fn_t gMathSVKernel[SCL_MATH_MAX][SCL_MATH_TYPE_NUM] = {
+    SCL_MATH_KERNEL_ROW(Add, SV), SCL_MATH_KERNEL_ROW(Sub, SV), SCL_MATH_KERNEL_ROW(Multi, SV)};
+
+static const _math_vv_fn_t gMathVVKernel[SCL_MATH_MAX][SCL_MATH_TYPE_NUM][SCL_MATH_TYPE_NUM] = {
+    SCL_MATH_KERNEL_PAIRS(Add), SCL_MATH_KERNEL_PAIRS(Sub), SCL_MATH_KERNEL_PAIRS(Multi)};
+
+static void doubleVectorMathAVX2(int32_t op, const double *pLeft, const double *pRight, double *pOut,
+                                 int32_t numOfRows) {
+  const int32_t bitWidth = 256;
+
+#if __AVX2__
+  int32_t width = (bitWidth >> 3u) / sizeof(double);
+
+  int32_t remainder = numOfRows % width;
+  int32_t rounds = numOfRows / width;
+
+  for (int32_t i = 0; i < rounds; ++i) {
+    __m256d l = _mm256_loadu_pd(pLeft + i * width);
+    __m256d r = _mm256_loadu_pd(pRight + i * width);
+    __m256d v;
+    if (op == SCL_MATH_ADD) {
+      v = _mm256_add_pd(l, r);
+    } else if (op == SCL_MATH_SUB) {
+      v = _mm256_sub_pd(l, r);
+    } else {
+      v = _mm256_mul_pd(l, r);
+    }
+    _mm256_storeu_pd(pOut + i * width, v);
+  }
+
+  if (remainder > 0) {
+    int32_t start = rounds * width;
+    gMathVVKernel[op][TSDB_DATA_TYPE_DOUBLE][TSDB_DATA_TYPE_DOUBLE](pLeft + start, pRight + start, pOut + start,
+                                                                    remainder);
+  }
+#else
+  gMathVVKernel[op][TSDB_DATA_TYPE_DOUBLE][TSDB_DATA_TYPE_DOUBLE](pLeft, pRight, pOut, numOfRows);
+#endif
+}
+
+static FORCE_INLINE bool isMathKernelType(int32_t type) {
+  return type < SCL_MATH_TYPE_NUM && gMathVSKernel[SCL_MATH_ADD][type] != NULL;
+}
+
+static FORCE_INLINE char *getMathKernelNullBitmap(SColumnInfoData *pCol) {
+  return (pCol != NULL && pCol->hasNull) ? pCol->nullbitmap : NULL;
+}
+
+// The null bitmap of the result is the OR of the bitmaps of both operands, computed eight bytes at a time. The values
+// of the null rows are reset to 0 afterwards, which is what colDataAppendNULL does as well.
+static void vectorMathMergeNull(SColumnInfoData *pLeftCol, SColumnInfoData *pRightCol, SColumnInfoData *pOutputCol,
+                                int32_t numOfRows) {
+  char *pLeftBitmap = getMathKernelNullBitmap(pLeftCol);
+  char *pRightBitmap = getMathKernelNullBitmap(pRightCol);
+  char *pOutBitmap = pOutputCol->nullbitmap;
+
+  int32_t len = BitmapLen(numOfRows);
+  if (pLeftBitmap == NULL && pRightBitmap == NULL) {
+    memset(pOutBitmap, 0, len);
+    return;
+  }
+
+  if (pLeftBitmap == NULL || pRightBitmap == NULL) {
+    memcpy(pOutBitmap, (pLeftBitmap != NULL) ? pLeftBitmap : pRightBitmap, len);
+  } else {
+    int32_t words = len / sizeof(uint64_t);
+    for (int32_t i = 0; i < words; ++i) {
+      uint64_t l, r;
+      memcpy(&l, pLeftBitmap + i * sizeof(uint64_t), sizeof(uint64_t));
+      memcpy(&r, pRightBitmap + i * sizeof(uint64_t), sizeof(uint64_t));
+      l |= r;
+      memcpy(pOutBitmap + i * sizeof(uint64_t), &l, sizeof(uint64_t));
+    }
+
+    for (int32_t i = words * sizeof(uint64_t); i < len; ++i) {
+      pOutBitmap[i] = pLeftBitmap[i] | pRightBitmap[i];
+    }
+  }
+
+  // the bits beyond numOfRows are not defined in the input bitmaps
+  if (BitPos(numOfRows) != 0) {
+    pOutBitmap[len - 1] &= (char)(0xFFu << (8u - BitPos(numOfRows)));
+  }
+
+  double *output = (double *)pOutputCol->pData;
+  for (int32_t i = 0; i < len; ++i) {
+    if (pOutBitmap[i] == 0) {
+      continue;
+    }
+
+    pOutputCol->hasNull = true;
+    for (int32_t j = i << NBIT; j < ((i + 1) << NBIT) && j < numOfRows; ++j) {
+      if (colDataIsNull_f(pOutBitmap, j)) {
+        output[j] = 0;
+      }
+    }
+  }
+}
+
+// Returns false if the operands are not handled by the kernels, and the generic path should be used instead.
+static bool vectorMathKernel(int32_t op, SColumnInfoData *pLeftCol, SColumnInfoData *pRightCol,
+                             SColumnInfoData *pOutputCol, int32_t leftRows, int32_t rightRows, int32_t _ord) {
+  int32_t leftType = pLeftCol->info.type;
+  int32_t rightType = pRightCol->info.type;
+
+  // the generic path does not handle the descending order correctly either, keep it unchanged
+  if (_ord != TSDB_ORDER_ASC || pOutputCol->info.type != TSDB_DATA_TYPE_DOUBLE || !isMathKernelType(leftType) ||
+      !isMathKernelType(rightType)) {
+    return false;
+  }
+
+  double *output = (double *)pOutputCol->pData;
+
+  if (leftRows == rightRows) {
+    if (leftType == TSDB_DATA_TYPE_DOUBLE && rightType == TSDB_DATA_TYPE_DOUBLE && tsAVX2Enable && tsSIMDBuiltins) {
+      doubleVectorMathAVX2(op, (const double *)pLeftCol->pData, (const double *)pRightCol->pData, output, leftRows);
+    } else if (gMathVVKernel[op][leftType][rightType] != NULL) {
+      gMathVVKernel[op][leftType][rightType](pLeftCol->pData, pRightCol->pData, output, leftRows);
+    } else {
+      // widen the left operand into the output buffer first, and then apply the double op right type kernel in-place
+      gMathVSKernel[SCL_MATH_MULTI][leftType](pLeftCol->pData, 1.0, output, leftRows);
+      gMathVVKernel[op][TSDB_DATA_TYPE_DOUBLE][rightType](output, pRightCol->pData, output, leftRows);
+    }
+
+    vectorMathMergeNull(pLeftCol, pRightCol, pOutputCol, leftRows);
+  } else if (leftRows == 1) {
+    if (colDataIsNull_s(pLeftCol, 0)) {
+      colDataAppendNNULL(pOutputCol, 0, rightRows);
+    } else {
+      double v = getVectorDoubleValueFn(leftType)(pLeftCol->pData, 0);
+      gMathSVKernel[op][rightType](pRightCol->pData, v, output, rightRows);
+      vectorMathMergeNull(NULL, pRightCol, pOutputCol, rightRows);
+    }
+  } else if (rightRows == 1) {
+    if (colDataIsNull_s(pRightCol, 0)) {
+      colDataAppendNNULL(pOutputCol, 0, leftRows);
+    } else {
+      double v = getVectorDoubleValueFn(rightType)(pRightCol->pData, 0);
+      gMathVSKernel[op][leftType](pLeftCol->pData, v, output, leftRows);
+      vectorMathMergeNull(pLeftCol, NULL, pOutputCol, leftRows);
+    }
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
 void vectorMathAdd(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t _ord) {
   SColumnInfoData *pOutputCol = pOut->columnData;
 
@@ -1109,7 +1373,8 @@ void vectorMathAdd(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut
         *output = getVectorBigintValueFnLeft(pLeftCol->pData, i) + getVectorBigintValueFnRight(pRightCol->pData, i);
       }
     }
-  } else {
+  } else if (!vectorMathKernel(SCL_MATH_ADD, pLeftCol, pRightCol, pOutputCol, pLeft->numOfRows, pRight->numOfRows,
+                               _ord)) {
     double              *output = (double *)pOutputCol->pData;
     _getDoubleValue_fn_t getVectorDoubleValueFnLeft = getVectorDoubleValueFn(pLeftCol->info.type);
     _getDoubleValue_fn_t getVectorDoubleValueFnRight = getVectorDoubleValueFn(pRightCol->info.type);
@@ -1210,7 +1475,8 @@ void vectorMathSub(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut
         *output = getVectorBigintValueFnLeft(pLeftCol->pData, i) - getVectorBigintValueFnRight(pRightCol->pData, i);
       }
     }
-  } else {
+  } else if (!vectorMathKernel(SCL_MATH_SUB, pLeftCol, pRightCol, pOutputCol, pLeft->numOfRows, pRight->numOfRows,
+                               _ord)) {
     double              *output = (double *)pOutputCol->pData;
     _getDoubleValue_fn_t getVectorDoubleValueFnLeft = getVectorDoubleValueFn(pLeftCol->info.type);
     _getDoubleValue_fn_t getVectorDoubleValueFnRight = getVectorDoubleValueFn(pRightCol->info.type);
@@ -1266,6 +1532,12 @@ void vectorMathMultiply(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam
   SColumnInfoData *pLeftCol = vectorConvertVarToDouble(pLeft, &leftConvert);
   SColumnInfoData *pRightCol = vectorConvertVarToDouble(pRight, &rightConvert);
 
+  if (vectorMathKernel(SCL_MATH_MULTI, pLeftCol, pRightCol, pOutputCol, pLeft->numOfRows, pRight->numOfRows, _ord)) {
+    doReleaseVec(pLeftCol, leftConvert);
+    doReleaseVec(pRightCol, rightConvert);
+    return;
+  }
+
   _getDoubleValue_fn_t getVectorDoubleValueFnLeft = getVectorDoubleValueFn(pLeftCol->info.type);
   _getDoubleValue_fn_t getVectorDoubleValueFnRight = getVectorDoubleValueFn(pRightCol->info.type);
 
@@ -1570,12 +1842,519 @@ void vectorBitOr(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut,
   doReleaseVec(pRightCol, rightConvert);
 }
 
+// Typed compare kernels. Instead of calling a comparator through __compar_fn_t for each row, the rows are compared
+// in a loop specialized for the type of the operands, and the results are packed into a selection bitmap that has
+// the same layout as the null bitmap of SColumnInfoData, eight rows per byte starting from the highest bit.
+enum {
+  SCL_CMP_DOMAIN_NONE = 0,
+  SCL_CMP_DOMAIN_I64,      // both are signed integers
+  SCL_CMP_DOMAIN_U64,      // both are unsigned integers
+  SCL_CMP_DOMAIN_FLT,      // float against an integer, compared as float
+  SCL_CMP_DOMAIN_DBL,      // double against another numeric type, compared as double
+  SCL_CMP_DOMAIN_FLT_EPS,  // float against float, equality with tolerance as compareFloatVal
+  SCL_CMP_DOMAIN_DBL_EPS,  // double against double, equality with tolerance as compareDoubleVal
+  SCL_CMP_DOMAIN_MAX,
+};
+
+typedef void (*_cmp_val_fn_t)(const void *pCol, const void *pVal, int32_t optr, int32_t numOfRows, uint8_t *pBitmap);
+typedef void (*_cmp_col_fn_t)(const void *pLeft, const void *pRight, int32_t optr, int32_t numOfRows,
+                              uint8_t *pBitmap);
+
+static FORCE_INLINE int32_t vectorCompareFloatEps(float l, float r) {
+  if (isnan(l) || isnan(r)) {
+    return isnan(l) ? (isnan(r) ? 0 : -1) : 1;
+  }
+
+  return FLT_EQUAL(l, r) ? 0 : ((l > r) ? 1 : -1);
+}
+
+static FORCE_INLINE int32_t vectorCompareDoubleEps(double l, double r) {
+  if (isnan(l) || isnan(r)) {
+    return isnan(l) ? (isnan(r) ? 0 : -1) : 1;
+  }
+
+  return FLT_EQUAL(l, r) ? 0 : ((l > r) ? 1 : -1);
+}
+
+#define SCL_CMP_PLAIN(_l, _r)      (((_l) > (_r)) - ((_l) < (_r)))
+#define SCL_CMP_FLT_EPS(_l, _r)    vectorCompareFloatEps(_l, _r)
+#define SCL_CMP_DBL_EPS(_l, _r)    vectorCompareDoubleEps(_l, _r)
+#define SCL_CMP_COL_ROW(_j)        p[_j]
+#define SCL_CMP_VAL_ROW(_j)        v
+#define SCL_CMP_LEFT_ROW(_j)       l[_j]
+#define SCL_CMP_RIGHT_ROW(_j)      r[_j]
+
+#define SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, _op)                       \
+  do {                                                                      \
+    int32_t j = 0;                                                          \
+    for (; j + 8 <= numOfRows; j += 8) {                                    \
+      uint8_t b = 0;                                                        \
+      for (int32_t k = 0; k < 8; ++k) {                                     \
+        b |= (uint8_t)((_cmp(_left(j + k), _right(j + k))) _op 0) << (7 - k); \
+      }                                                                     \
+      pBitmap[j >> NBIT] = b;                                               \
+    }                                                                       \
+    if (j < numOfRows) {                                                    \
+      uint8_t b = 0;                                                        \
+      for (int32_t k = 0; j + k < numOfRows; ++k) {                         \
+        b |= (uint8_t)((_cmp(_left(j + k), _right(j + k))) _op 0) << (7 - k); \
+      }                                                                     \
+      pBitmap[j >> NBIT] = b;                                               \
+    }                                                                       \
+  } while (0)
+
+#define SCL_CMP_BITMAP_SWITCH(_left, _right, _cmp)             \
+  switch (optr) {                                              \
+    case OP_TYPE_GREATER_THAN:                                 \
+      SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, >);             \
+      break;                                                   \
+    case OP_TYPE_GREATER_EQUAL:                                \
+      SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, >=);            \
+      break;                                                   \
+    case OP_TYPE_LOWER_THAN:                                   \
+      SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, <);             \
+      break;                                                   \
+    case OP_TYPE_LOWER_EQUAL:                                  \
+      SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, <=);            \
+      break;                                                   \
+    case OP_TYPE_EQUAL:                                        \
+      SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, ==);            \
+      break;                                                   \
+    case OP_TYPE_NOT_EQUAL:                                    \
+      SCL_CMP_BITMAP_LOOP(_left, _right, _cmp, !=);            \
+      break;                                                   \
+    default:                                                   \
+      ASSERT(0);                                               \
+      break;                                                   \
+  }
+
+// column compared with a constant, the constant has been converted to the type of the compare domain
+#define SCL_CMP_VAL_KERNEL(_name, _t, _dt, _cmp)                                                                 \
+  static void _name(const void *pCol, const void *pVal, int32_t optr, int32_t numOfRows, uint8_t *pBitmap) {    \
+    const _t *p = (const _t *)pCol;                                                                              \
+    _dt       v = *(const _dt *)pVal;                                                                            \
+    SCL_CMP_BITMAP_SWITCH(SCL_CMP_COL_ROW, SCL_CMP_VAL_ROW, _cmp)                                                \
+  }
+
+// two columns of the same type
+#define SCL_CMP_COL_KERNEL(_name, _t, _cmp)                                                                         \
+  static void _name(const void *pLeft, const void *pRight, int32_t optr, int32_t numOfRows, uint8_t *pBitmap) {    \
+    const _t *l = (const _t *)pLeft;                                                                                \
+    const _t *r = (const _t *)pRight;                                                                               \
+    SCL_CMP_BITMAP_SWITCH(SCL_CMP_LEFT_ROW, SCL_CMP_RIGHT_ROW, _cmp)                                                 \
+  }
+
+SCL_CMP_VAL_KERNEL(vectorCmpValI64_BOOL, bool, int64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValI64_TINYINT, int8_t, int64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValI64_SMALLINT, int16_t, int64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValI64_INT, int32_t, int64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValI64_BIGINT, int64_t, int64_t, SCL_CMP_PLAIN)
+
+SCL_CMP_VAL_KERNEL(vectorCmpValU64_UTINYINT, uint8_t, uint64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValU64_USMALLINT, uint16_t, uint64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValU64_UINT, uint32_t, uint64_t, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValU64_UBIGINT, uint64_t, uint64_t, SCL_CMP_PLAIN)
+
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_TINYINT, int8_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_SMALLINT, int16_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_INT, int32_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_BIGINT, int64_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_UTINYINT, uint8_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_USMALLINT, uint16_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_UINT, uint32_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_UBIGINT, uint64_t, float, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValFlt_FLOAT, float, float, SCL_CMP_PLAIN)
+
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_TINYINT, int8_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_SMALLINT, int16_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_INT, int32_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_BIGINT, int64_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_UTINYINT, uint8_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_USMALLINT, uint16_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_UINT, uint32_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_UBIGINT, uint64_t, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_FLOAT, float, double, SCL_CMP_PLAIN)
+SCL_CMP_VAL_KERNEL(vectorCmpValDbl_DOUBLE, double, double, SCL_CMP_PLAIN)
+
+SCL_CMP_VAL_KERNEL(vectorCmpValFltEps_FLOAT, float, float, SCL_CMP_FLT_EPS)
+SCL_CMP_VAL_KERNEL(vectorCmpValDblEps_DOUBLE, double, double, SCL_CMP_DBL_EPS)
+
+SCL_CMP_COL_KERNEL(vectorCmpCol_BOOL, bool, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_TINYINT, int8_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_SMALLINT, int16_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_INT, int32_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_BIGINT, int64_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_UTINYINT, uint8_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_USMALLINT, uint16_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_UINT, uint32_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_UBIGINT, uint64_t, SCL_CMP_PLAIN)
+SCL_CMP_COL_KERNEL(vectorCmpCol_FLOAT, float, SCL_CMP_FLT_EPS)
+SCL_CMP_COL_KERNEL(vectorCmpCol_DOUBLE, double, SCL_CMP_DBL_EPS)
+
+static const _cmp_val_fn_t gCmpValKernel[SCL_CMP_DOMAIN_MAX][SCL_MATH_TYPE_NUM] = {
+    [SCL_CMP_DOMAIN_I64] =
+        {
+            [TSDB_DATA_TYPE_BOOL] = vectorCmpValI64_BOOL,
+            [TSDB_DATA_TYPE_TINYINT] = vectorCmpValI64_TINYINT,
+            [TSDB_DATA_TYPE_SMALLINT] = vectorCmpValI64_SMALLINT,
+            [TSDB_DATA_TYPE_INT] = vectorCmpValI64_INT,
+            [TSDB_DATA_TYPE_BIGINT] = vectorCmpValI64_BIGINT,
+            [TSDB_DATA_TYPE_TIMESTAMP] = vectorCmpValI64_BIGINT,
+        },
+    [SCL_CMP_DOMAIN_U64] =
+        {
+            [TSDB_DATA_TYPE_UTINYINT] = vectorCmpValU64_UTINYINT,
+            [TSDB_DATA_TYPE_USMALLINT] = vectorCmpValU64_USMALLINT,
+            [TSDB_DATA_TYPE_UINT] = vectorCmpValU64_UINT,
+            [TSDB_DATA_TYPE_UBIGINT] = vectorCmpValU64_UBIGINT,
+        },
+    [SCL_CMP_DOMAIN_FLT] =
+        {
+            [TSDB_DATA_TYPE_TINYINT] = vectorCmpValFlt_TINYINT,
+            [TSDB_DATA_TYPE_SMALLINT] = vectorCmpValFlt_SMALLINT,
+            [TSDB_DATA_TYPE_INT] = vectorCmpValFlt_INT,
+            [TSDB_DATA_TYPE_BIGINT] = vectorCmpValFlt_BIGINT,
+            [TSDB_DATA_TYPE_UTINYINT] = vectorCmpValFlt_UTINYINT,
+            [TSDB_DATA_TYPE_USMALLINT] = vectorCmpValFlt_USMALLINT,
+            [TSDB_DATA_TYPE_UINT] = vectorCmpValFlt_UINT,
+            [TSDB_DATA_TYPE_UBIGINT] = vectorCmpValFlt_UBIGINT,
+            [TSDB_DATA_TYPE_FLOAT] = vectorCmpValFlt_FLOAT,
+        },
+    [SCL_CMP_DOMAIN_DBL] =
+        {
+            [TSDB_DATA_TYPE_TINYINT] = vectorCmpValDbl_TINYINT,
+            [TSDB_DATA_TYPE_SMALLINT] = vectorCmpValDbl_SMALLINT,
+            [TSDB_DATA_TYPE_INT] = vectorCmpValDbl_INT,
+            [TSDB_DATA_TYPE_BIGINT] = vectorCmpValDbl_BIGINT,
+            [TSDB_DATA_TYPE_UTINYINT] = vectorCmpValDbl_UTINYINT,
+            [TSDB_DATA_TYPE_USMALLINT] = vectorCmpValDbl_USMALLINT,
+            [TSDB_DATA_TYPE_UINT] = vectorCmpValDbl_UINT,
+            [TSDB_DATA_TYPE_UBIGINT] = vectorCmpValDbl_UBIGINT,
+            [TSDB_DATA_TYPE_FLOAT] = vectorCmpValDbl_FLOAT,
+            [TSDB_DATA_TYPE_DOUBLE] = vectorCmpValDbl_DOUBLE,
+        },
+    [SCL_CMP_DOMAIN_FLT_EPS] = {[TSDB_DATA_TYPE_FLOAT] = vectorCmpValFltEps_FLOAT},
+    [SCL_CMP_DOMAIN_DBL_EPS] = {[TSDB_DATA_TYPE_DOUBLE] = vectorCmpValDblEps_DOUBLE},
+};
+
+static const _cmp_col_fn_t gCmpColKernel[SCL_MATH_TYPE_NUM] = {
+    [TSDB_DATA_TYPE_BOOL] = vectorCmpCol_BOOL,
+    [TSDB_DATA_TYPE_TINYINT] = vectorCmpCol_TINYINT,
+    [TSDB_DATA_TYPE_SMALLINT] = vectorCmpCol_SMALLINT,
+    [TSDB_DATA_TYPE_INT] = vectorCmpCol_INT,
+    [TSDB_DATA_TYPE_BIGINT] = vectorCmpCol_BIGINT,
+    [TSDB_DATA_TYPE_TIMESTAMP] = vectorCmpCol_BIGINT,
+    [TSDB_DATA_TYPE_UTINYINT] = vectorCmpCol_UTINYINT,
+    [TSDB_DATA_TYPE_USMALLINT] = vectorCmpCol_USMALLINT,
+    [TSDB_DATA_TYPE_UINT] = vectorCmpCol_UINT,
+    [TSDB_DATA_TYPE_UBIGINT] = vectorCmpCol_UBIGINT,
+    [TSDB_DATA_TYPE_FLOAT] = vectorCmpCol_FLOAT,
+    [TSDB_DATA_TYPE_DOUBLE] = vectorCmpCol_DOUBLE,
+};
+
+#define SCL_CMP_IS_SIGNED(_t) (IS_SIGNED_NUMERIC_TYPE(_t) || (_t) == TSDB_DATA_TYPE_TIMESTAMP)
+
+// The compare domain follows the usual arithmetic conversion of C, which is what the comparators in tcompare.c do for
+// the pairs they are defined for. Pairs of signed and unsigned integers are left to the comparators.
+static int32_t vectorGetCompareDomain(int32_t lType, int32_t rType) {
+  if (lType == rType) {
+    if (lType == TSDB_DATA_TYPE_FLOAT) {
+      return SCL_CMP_DOMAIN_FLT_EPS;
+    } else if (lType == TSDB_DATA_TYPE_DOUBLE) {
+      return SCL_CMP_DOMAIN_DBL_EPS;
+    } else if (SCL_CMP_IS_SIGNED(lType) || lType == TSDB_DATA_TYPE_BOOL) {
+      return SCL_CMP_DOMAIN_I64;
+    } else if (IS_UNSIGNED_NUMERIC_TYPE(lType)) {
+      return SCL_CMP_DOMAIN_U64;
+    }
+
+    return SCL_CMP_DOMAIN_NONE;
+  }
+
+  if (!IS_NUMERIC_TYPE(lType) || !IS_NUMERIC_TYPE(rType)) {
+    return SCL_CMP_DOMAIN_NONE;
+  }
+
+  if (lType == TSDB_DATA_TYPE_DOUBLE || rType == TSDB_DATA_TYPE_DOUBLE) {
+    return SCL_CMP_DOMAIN_DBL;
+  } else if (lType == TSDB_DATA_TYPE_FLOAT || rType == TSDB_DATA_TYPE_FLOAT) {
+    return SCL_CMP_DOMAIN_FLT;
+  } else if (SCL_CMP_IS_SIGNED(lType) && SCL_CMP_IS_SIGNED(rType)) {
+    return SCL_CMP_DOMAIN_I64;
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(lType) && IS_UNSIGNED_NUMERIC_TYPE(rType)) {
+    return SCL_CMP_DOMAIN_U64;
+  }
+
+  return SCL_CMP_DOMAIN_NONE;
+}
+
+static int32_t i32CompareValBitmapAVX2(const int32_t *p, int32_t v, int32_t optr, int32_t numOfRows,
+                                       uint8_t *pBitmap) {
+  const int32_t bitWidth = 256;
+  int32_t       rounds = 0;
+
+#if __AVX2__
+  int32_t width = (bitWidth >> 3u) / sizeof(int32_t);
+  rounds = numOfRows / width;
+
+  // reverse the lanes, so that the first row ends up in the highest bit of the movemask result
+  __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  __m256i val = _mm256_set1_epi32(v);
+  bool    inverse = (optr == OP_TYPE_GREATER_EQUAL || optr == OP_TYPE_LOWER_EQUAL || optr == OP_TYPE_NOT_EQUAL);
+
+  for (int32_t i = 0; i < rounds; ++i) {
+    __m256i data = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(p + i * width)), rev);
+    __m256i mask;
+    if (optr == OP_TYPE_GREATER_THAN || optr == OP_TYPE_LOWER_EQUAL) {
+      mask = _mm256_cmpgt_epi32(data, val);
+    } else if (optr == OP_TYPE_LOWER_THAN || optr == OP_TYPE_GREATER_EQUAL) {
+      mask = _mm256_cmpgt_epi32(val, data);
+    } else {
+      mask = _mm256_cmpeq_epi32(data, val);
+    }
+
+    uint8_t b = (uint8_t)_mm256_movemask_ps(_mm256_castsi256_ps(mask));
+    pBitmap[i] = inverse ? (uint8_t)~b : b;
+  }
+#endif
+
+  return rounds << NBIT;
+}
+
+static int32_t i64CompareValBitmapAVX2(const int64_t *p, int64_t v, int32_t optr, int32_t numOfRows,
+                                       uint8_t *pBitmap) {
+  const int32_t bitWidth = 256;
+  int32_t       rounds = 0;
+
+#if __AVX2__
+  int32_t width = (bitWidth >> 3u) / sizeof(int64_t);
+  rounds = numOfRows / (width << 1);
+
+  __m256i val = _mm256_set1_epi64x(v);
+  bool    inverse = (optr == OP_TYPE_GREATER_EQUAL || optr == OP_TYPE_LOWER_EQUAL || optr == OP_TYPE_NOT_EQUAL);
+
+  for (int32_t i = 0; i < rounds; ++i) {
+    uint8_t b = 0;
+    for (int32_t h = 0; h < 2; ++h) {
+      // reverse the lanes, so that the first row ends up in the highest bit of the movemask result
+      __m256i data = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i *)(p + (i * 2 + h) * width)), 0x1B);
+      __m256i mask;
+      if (optr == OP_TYPE_GREATER_THAN || optr == OP_TYPE_LOWER_EQUAL) {
+        mask = _mm256_cmpgt_epi64(data, val);
+      } else if (optr == OP_TYPE_LOWER_THAN || optr == OP_TYPE_GREATER_EQUAL) {
+        mask = _mm256_cmpgt_epi64(val, data);
+      } else {
+        mask = _mm256_cmpeq_epi64(data, val);
+      }
+
+      b |= (uint8_t)(_mm256_movemask_pd(_mm256_castsi256_pd(mask)) << ((1 - h) * width));
+    }
+
+    pBitmap[i] = inverse ? (uint8_t)~b : b;
+  }
+#endif
+
+  return rounds << NBIT;
+}
+
+static FORCE_INLINE int32_t vectorCompareFlipOptr(int32_t optr) {
+  switch (optr) {
+    case OP_TYPE_GREATER_THAN:
+      return OP_TYPE_LOWER_THAN;
+    case OP_TYPE_GREATER_EQUAL:
+      return OP_TYPE_LOWER_EQUAL;
+    case OP_TYPE_LOWER_THAN:
+      return OP_TYPE_GREATER_THAN;
+    case OP_TYPE_LOWER_EQUAL:
+      return OP_TYPE_GREATER_EQUAL;
+    default:
+      return optr;
+  }
+}
+
+static FORCE_INLINE bool isCompareKernelOptr(int32_t optr) {
+  return optr >= OP_TYPE_GREATER_THAN && optr <= OP_TYPE_NOT_EQUAL;
+}
+
+bool vectorCompareValBitmap(int32_t colType, const void *pCol, int32_t valType, const void *pVal, int32_t optr,
+                            int32_t numOfRows, uint8_t *pBitmap) {
+  if (!isCompareKernelOptr(optr) || colType >= SCL_MATH_TYPE_NUM || valType >= SCL_MATH_TYPE_NUM) {
+    return false;
+  }
+
+  int32_t domain = vectorGetCompareDomain(colType, valType);
+  if (domain == SCL_CMP_DOMAIN_NONE || gCmpValKernel[domain][colType] == NULL) {
+    return false;
+  }
+
+  int32_t start = 0;
+  switch (domain) {
+    case SCL_CMP_DOMAIN_I64: {
+      int64_t v = 0;
+      GET_TYPED_DATA(v, int64_t, valType, pVal);
+      if (tsAVX2Enable && tsSIMDBuiltins) {
+        if (colType == TSDB_DATA_TYPE_BIGINT || colType == TSDB_DATA_TYPE_TIMESTAMP) {
+          start = i64CompareValBitmapAVX2((const int64_t *)pCol, v, optr, numOfRows, pBitmap);
+        } else if (colType == TSDB_DATA_TYPE_INT && v >= INT32_MIN && v <= INT32_MAX) {
+          start = i32CompareValBitmapAVX2((const int32_t *)pCol, (int32_t)v, optr, numOfRows, pBitmap);
+        }
+      }
+
+      gCmpValKernel[domain][colType]((const char *)pCol + start * tDataTypes[colType].bytes, &v, optr,
+                                     numOfRows - start, pBitmap + (start >> NBIT));
+      break;
+    }
+    case SCL_CMP_DOMAIN_U64: {
+      uint64_t v = 0;
+      GET_TYPED_DATA(v, uint64_t, valType, pVal);
+      gCmpValKernel[domain][colType](pCol, &v, optr, numOfRows, pBitmap);
+      break;
+    }
+    case SCL_CMP_DOMAIN_FLT:
+    case SCL_CMP_DOMAIN_FLT_EPS: {
+      float v = 0;
+      GET_TYPED_DATA(v, float, valType, pVal);
+      gCmpValKernel[domain][colType](pCol, &v, optr, numOfRows, pBitmap);
+      break;
+    }
+    default: {
+      double v = 0;
+      GET_TYPED_DATA(v, double, valType, pVal);
+      gCmpValKernel[domain][colType](pCol, &v, optr, numOfRows, pBitmap);
+      break;
+    }
+  }
+
+  return true;
+}
+
+bool vectorCompareColBitmap(int32_t type, const void *pLeft, const void *pRight, int32_t optr, int32_t numOfRows,
+                            uint8_t *pBitmap) {
+  if (!isCompareKernelOptr(optr) || type >= SCL_MATH_TYPE_NUM || gCmpColKernel[type] == NULL) {
+    return false;
+  }
+
+  gCmpColKernel[type](pLeft, pRight, optr, numOfRows, pBitmap);
+  return true;
+}
+
+#define SCL_BITMAP_WORD_OP(_name, _expr)                                    \
+  void _name(uint8_t *pDst, const uint8_t *pSrc, int32_t numOfRows) {       \
+    int32_t len = BitmapLen(numOfRows);                                     \
+    int32_t words = len / sizeof(uint64_t);                                 \
+    for (int32_t i = 0; i < words; ++i) {                                   \
+      uint64_t d, s;                                                        \
+      memcpy(&d, pDst + i * sizeof(uint64_t), sizeof(uint64_t));            \
+      memcpy(&s, pSrc + i * sizeof(uint64_t), sizeof(uint64_t));            \
+      d = (_expr);                                                          \
+      memcpy(pDst + i * sizeof(uint64_t), &d, sizeof(uint64_t));            \
+    }                                                                       \
+    for (int32_t i = words * sizeof(uint64_t); i < len; ++i) {              \
+      uint8_t d = pDst[i], s = pSrc[i];                                     \
+      pDst[i] = (uint8_t)(_expr);                                           \
+    }                                                                       \
+  }
+
+SCL_BITMAP_WORD_OP(vectorBitmapAnd, d & s)
+SCL_BITMAP_WORD_OP(vectorBitmapOr, d | s)
+SCL_BITMAP_WORD_OP(vectorBitmapAndNot, d & ~s)
+
+void vectorBitmapNot(uint8_t *pDst, int32_t numOfRows) {
+  int32_t len = BitmapLen(numOfRows);
+  for (int32_t i = 0; i < len; ++i) {
+    pDst[i] = ~pDst[i];
+  }
+}
+
+int32_t vectorBitmapToBool(const uint8_t *pBitmap, int32_t numOfRows, int8_t *pRes) {
+  int32_t num = 0;
+  for (int32_t i = 0; i < numOfRows; i += 8) {
+    uint8_t b = pBitmap[i >> NBIT];
+    int32_t n = TMIN(8, numOfRows - i);
+    if (b == 0) {
+      memset(pRes + i, 0, n);
+      continue;
+    }
+
+    for (int32_t k = 0; k < n; ++k) {
+      pRes[i + k] = (b >> (7 - k)) & 0x1;
+      num += pRes[i + k];
+    }
+  }
+
+  return num;
+}
+
+// Returns the number of qualified rows, or -1 if the operands are not supported by the compare kernels.
+static int32_t doVectorCompareBitmap(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut,
+                                     int32_t startIndex, int32_t numOfRows, int32_t step, int32_t optr) {
+  SColumnInfoData *pLeftCol = pLeft->columnData;
+  SColumnInfoData *pRightCol = pRight->columnData;
+  int32_t          lType = GET_PARAM_TYPE(pLeft);
+  int32_t          rType = GET_PARAM_TYPE(pRight);
+  int32_t          rows = numOfRows - startIndex;
+
+  if (step != 1 || BitPos(startIndex) != 0 || rows <= 0 || !isCompareKernelOptr(optr)) {
+    return -1;
+  }
+
+  bool leftVal = (pLeft->numOfRows == 1 && numOfRows > 1);
+  bool rightVal = (pRight->numOfRows == 1 && numOfRows > 1);
+  if (leftVal && rightVal) {
+    return -1;
+  }
+
+  uint8_t *pBitmap = taosMemoryMalloc(BitmapLen(rows));
+  if (pBitmap == NULL) {
+    return -1;
+  }
+
+  bool    supported = false;
+  int8_t *pRes = (int8_t *)pOut->columnData->pData + startIndex;
+
+  if (leftVal || rightVal) {
+    SColumnInfoData *pCol = leftVal ? pRightCol : pLeftCol;
+    SColumnInfoData *pVal = leftVal ? pLeftCol : pRightCol;
+
+    if (colDataIsNull_s(pVal, 0)) {
+      taosMemoryFree(pBitmap);
+      memset(pRes, 0, rows);
+      return 0;
+    }
+
+    supported = vectorCompareValBitmap(pCol->info.type, colDataGetNumData(pCol, startIndex), pVal->info.type,
+                                       pVal->pData, leftVal ? vectorCompareFlipOptr(optr) : optr, rows, pBitmap);
+    if (supported && pCol->hasNull && pCol->nullbitmap != NULL) {
+      vectorBitmapAndNot(pBitmap, (const uint8_t *)pCol->nullbitmap + (startIndex >> NBIT), rows);
+    }
+  } else if (lType == rType) {
+    supported = vectorCompareColBitmap(lType, colDataGetNumData(pLeftCol, startIndex),
+                                       colDataGetNumData(pRightCol, startIndex), optr, rows, pBitmap);
+    if (supported && pLeftCol->hasNull && pLeftCol->nullbitmap != NULL) {
+      vectorBitmapAndNot(pBitmap, (const uint8_t *)pLeftCol->nullbitmap + (startIndex >> NBIT), rows);
+    }
+    if (supported && pRightCol->hasNull && pRightCol->nullbitmap != NULL) {
+      vectorBitmapAndNot(pBitmap, (const uint8_t *)pRightCol->nullbitmap + (startIndex >> NBIT), rows);
+    }
+  }
+
+  int32_t num = supported ? vectorBitmapToBool(pBitmap, rows, pRes) : -1;
+  taosMemoryFree(pBitmap);
+  return num;
+}
+
 int32_t doVectorCompareImpl(SScalarParam *pLeft, SScalarParam *pRight, SScalarParam *pOut, int32_t startIndex,
                             int32_t numOfRows, int32_t step, __compar_fn_t fp, int32_t optr) {
   int32_t num = 0;
   bool   *pRes = (bool *)pOut->columnData->pData;
 
   if (IS_MATHABLE_TYPE(GET_PARAM_TYPE(pLeft)) && IS_MATHABLE_TYPE(GET_PARAM_TYPE(pRight))) {
+    num = doVectorCompareBitmap(pLeft, pRight, pOut, startIndex, numOfRows, step, optr);
+    if (num >= 0) {
+      return num;
+    }
+
+    num = 0;
     if (!(pLeft->columnData->hasNull || pRight->columnData->hasNull)) {
       for (int32_t i = startIndex; i < numOfRows && i >= 0; i += step) {
         int32_t leftIndex = (i >= pLeft->numOfRows) ? 0 : i;
@@ -32,6 +32,7 @@
 #endif
 #include "os.h"
 
+#include "filter.h"
 #include "filterInt.h"
 #include "nodes.h"
 #include "parUtil.h"
@@ -263,6 +264,57 @@ void scltMakeTargetNode(SNode **pNode, int16_t dataBlockId, int16_t slotId, SNod
 
   *pNode = (SNode *)onode;
 }
+
+// a column node of a column already in the block
+void scltMakeColumnRef(SNode **pNode, SSDataBlock *block, int16_t slotId) {
+  SColumnInfoData *pColumn = (SColumnInfoData *)taosArrayGet(block->pDataBlock, slotId);
+  scltMakeColumnNode(pNode, NULL, pColumn->info.type, pColumn->info.bytes, 0, NULL);
+  ((SColumnNode *)*pNode)->slotId = slotId;
+  ((SColumnNode *)*pNode)->colId = pColumn->info.colId;
+  snprintf(((SColumnNode *)*pNode)->colName, TSDB_COL_NAME_LEN, "c%d", slotId);  // nodes of a slot are equal
+}
+
+void scltMakeCompareNode(SNode **pNode, EOperatorType opType, SSDataBlock *block, int16_t slotId, int32_t valType,
+                         void *value) {
+  SNode *pLeft = NULL, *pRight = NULL;
+  scltMakeColumnRef(&pLeft, block, slotId);
+  if (value != NULL) {
+    scltMakeValueNode(&pRight, valType, value);
+  }
+  scltMakeOpNode(pNode, opType, TSDB_DATA_TYPE_BOOL, pLeft, pRight);
+}
+
+// run the filter by the bitmap and the row by row implementation, which must give the same result
+void scltCheckFilterBitmap(SNode *pNode, SSDataBlock *src, int32_t expectQualified) {
+  SFilterInfo *filter = NULL;
+  ASSERT_EQ(filterInitFromNode(pNode, &filter, 0), 0);
+  ASSERT_EQ(filter->func, filterExecuteImplBitmap);
+
+  SFilterColumnParam param = {(int32_t)taosArrayGetSize(src->pDataBlock), src->pDataBlock};
+  ASSERT_EQ(filterSetDataFromSlotId(filter, &param), 0);
+
+  int32_t         rowNum = src->info.rows;
+  int16_t         numOfCols = taosArrayGetSize(src->pDataBlock);
+  SColumnInfoData bitmapRes = createColumnInfoData(TSDB_DATA_TYPE_BOOL, sizeof(bool), 1);
+  SColumnInfoData rowRes = createColumnInfoData(TSDB_DATA_TYPE_BOOL, sizeof(bool), 1);
+  colInfoDataEnsureCapacity(&bitmapRes, rowNum, true);
+  colInfoDataEnsureCapacity(&rowRes, rowNum, true);
+
+  int32_t bitmapQualified = 0, rowQualified = 0;
+  bool    bitmapAll = filterExecuteImplBitmap(filter, rowNum, &bitmapRes, NULL, numOfCols, &bitmapQualified);
+  bool    rowAll = filterExecuteImpl(filter, rowNum, &rowRes, NULL, numOfCols, &rowQualified);
+  ASSERT_EQ(bitmapAll, rowAll);
+  ASSERT_EQ(bitmapQualified, rowQualified);
+  ASSERT_EQ(bitmapQualified, expectQualified);
+  ASSERT_EQ(bitmapAll, expectQualified == rowNum);
+  for (int32_t i = 0; i < rowNum; ++i) {
+    ASSERT_EQ(((int8_t *)bitmapRes.pData)[i], ((int8_t *)rowRes.pData)[i]);
+  }
+
+  colDataDestroy(&bitmapRes);
+  colDataDestroy(&rowRes);
+  filterFreeInfo(filter);
+}
 }  // namespace
 
 TEST(constantTest, bigint_add_bigint) {
@@ -1542,6 +1594,50 @@ TEST(columnTest, bigint_column_multi_binary_column) {
   nodesDestroyNode(opNode);
 }
 
+TEST(columnTest, int_column_sub_double_column_with_null) {
+  SNode       *pLeft = NULL, *pRight = NULL, *opNode = NULL;
+  int32_t      leftv[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  double       rightv[10] = {0.5, 1, 1.5, 2, 2.5, 3, 3.5, 4, 4.5, 5};
+  double       eRes[10] = {0.5, 1, 1.5, 2, 2.5, 3, 3.5, 4, 4.5, 5};
+  bool         eNull[10] = {true, false, false, true, false, false, false, false, false, true};
+  SSDataBlock *src = NULL;
+  int32_t      rowNum = sizeof(leftv) / sizeof(leftv[0]);
+  scltMakeColumnNode(&pLeft, &src, TSDB_DATA_TYPE_INT, sizeof(int32_t), rowNum, leftv);
+  scltMakeColumnNode(&pRight, &src, TSDB_DATA_TYPE_DOUBLE, sizeof(double), rowNum, rightv);
+  scltMakeOpNode(&opNode, OP_TYPE_SUB, TSDB_DATA_TYPE_DOUBLE, pLeft, pRight);
+
+  SColumnInfoData *pLeftCol = (SColumnInfoData *)taosArrayGet(src->pDataBlock, ((SColumnNode *)pLeft)->slotId);
+  SColumnInfoData *pRightCol = (SColumnInfoData *)taosArrayGet(src->pDataBlock, ((SColumnNode *)pRight)->slotId);
+  colDataAppendNULL(pLeftCol, 0);
+  colDataAppendNULL(pRightCol, 3);
+  colDataAppendNULL(pLeftCol, 9);
+  colDataAppendNULL(pRightCol, 9);
+
+  SArray *blockList = taosArrayInit(1, POINTER_BYTES);
+  taosArrayPush(blockList, &src);
+
+  SColumnInfo colInfo = createColumnInfo(1, TSDB_DATA_TYPE_DOUBLE, sizeof(double));
+  int16_t     dataBlockId = 0, slotId = 0;
+  scltAppendReservedSlot(blockList, &dataBlockId, &slotId, false, rowNum, &colInfo);
+  scltMakeTargetNode(&opNode, dataBlockId, slotId, opNode);
+
+  int32_t code = scalarCalculate(opNode, blockList, NULL);
+  ASSERT_EQ(code, 0);
+
+  SSDataBlock *res = *(SSDataBlock **)taosArrayGetLast(blockList);
+  ASSERT_EQ(res->info.rows, rowNum);
+  SColumnInfoData *column = (SColumnInfoData *)taosArrayGetLast(res->pDataBlock);
+  ASSERT_EQ(column->info.type, TSDB_DATA_TYPE_DOUBLE);
+  for (int32_t i = 0; i < rowNum; ++i) {
+    ASSERT_EQ(colDataIsNull_s(column, i), eNull[i]);
+    if (!eNull[i]) {
+      ASSERT_EQ(*((double *)colDataGetData(column, i)), eRes[i]);
+    }
+  }
+  taosArrayDestroyEx(blockList, scltFreeDataBlock);
+  nodesDestroyNode(opNode);
+}
+
 TEST(columnTest, smallint_column_and_binary_column) {
   SNode  *pLeft = NULL, *pRight = NULL, *opNode = NULL;
   int16_t leftv[5] = {1, 2, 3, 4, 5};
@@ -1679,6 +1775,41 @@ TEST(columnTest, smallint_column_greater_double_value) {
   nodesDestroyNode(opNode);
 }
 
+TEST(columnTest, bigint_column_lower_equal_int_value_with_null) {
+  SNode       *pLeft = NULL, *pRight = NULL, *opNode = NULL;
+  int64_t      leftv[11] = {1, 9, 3, 8, 5, 7, 6, 4, 2, 10, 0};
+  int32_t      rightv = 5;
+  bool         eRes[11] = {true, false, true, false, false, false, false, true, true, false, true};
+  SSDataBlock *src = NULL;
+  int32_t      rowNum = sizeof(leftv) / sizeof(leftv[0]);
+  scltMakeColumnNode(&pLeft, &src, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), rowNum, leftv);
+  scltMakeValueNode(&pRight, TSDB_DATA_TYPE_INT, &rightv);
+  scltMakeOpNode(&opNode, OP_TYPE_LOWER_EQUAL, TSDB_DATA_TYPE_BOOL, pLeft, pRight);
+
+  SColumnInfoData *pLeftCol = (SColumnInfoData *)taosArrayGet(src->pDataBlock, ((SColumnNode *)pLeft)->slotId);
+  colDataAppendNULL(pLeftCol, 4);
+
+  SArray *blockList = taosArrayInit(1, POINTER_BYTES);
+  taosArrayPush(blockList, &src);
+  SColumnInfo colInfo = createColumnInfo(1, TSDB_DATA_TYPE_BOOL, sizeof(bool));
+  int16_t     dataBlockId = 0, slotId = 0;
+  scltAppendReservedSlot(blockList, &dataBlockId, &slotId, true, rowNum, &colInfo);
+  scltMakeTargetNode(&opNode, dataBlockId, slotId, opNode);
+
+  int32_t code = scalarCalculate(opNode, blockList, NULL);
+  ASSERT_EQ(code, 0);
+
+  SSDataBlock *res = *(SSDataBlock **)taosArrayGetLast(blockList);
+  ASSERT_EQ(res->info.rows, rowNum);
+  SColumnInfoData *column = (SColumnInfoData *)taosArrayGetLast(res->pDataBlock);
+  ASSERT_EQ(column->info.type, TSDB_DATA_TYPE_BOOL);
+  for (int32_t i = 0; i < rowNum; ++i) {
+    ASSERT_EQ(*((bool *)colDataGetData(column, i)), eRes[i]);
+  }
+  taosArrayDestroyEx(blockList, scltFreeDataBlock);
+  nodesDestroyNode(opNode);
+}
+
 TEST(columnTest, int_column_in_double_list) {
   SNode       *pLeft = NULL, *pRight = NULL, *listNode = NULL, *opNode = NULL;
   int32_t      leftv[5] = {1, 2, 3, 4, 5};
@@ -1992,6 +2123,124 @@ TEST(columnTest, greater_and_lower) {
   nodesDestroyNode(logicNode);
 }
 
+TEST(columnTest, filter_bitmap_with_null) {
+  const int32_t rowNum = 1001;  // the last bitmap byte is partly used
+  int32_t      *v1 = (int32_t *)taosMemoryMalloc(rowNum * sizeof(int32_t));
+  int64_t      *v2 = (int64_t *)taosMemoryMalloc(rowNum * sizeof(int64_t));
+  double       *v3 = (double *)taosMemoryMalloc(rowNum * sizeof(double));
+  taosSeedRand(1);
+  for (int32_t i = 0; i < rowNum; ++i) {
+    v1[i] = taosRand() % 100;
+    v2[i] = taosRand() % 200 - 100;
+    v3[i] = (taosRand() % 1000) / 1000.0;
+  }
+
+  // columns at slot 2, 3 and 4, every 7th c1, every 5th c2 and every 3rd c3 is null
+  SSDataBlock *src = NULL;
+  SNode       *pCol = NULL;
+  scltMakeColumnNode(&pCol, &src, TSDB_DATA_TYPE_INT, sizeof(int32_t), rowNum, v1);
+  nodesDestroyNode(pCol);
+  scltMakeColumnNode(&pCol, &src, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), rowNum, v2);
+  nodesDestroyNode(pCol);
+  scltMakeColumnNode(&pCol, &src, TSDB_DATA_TYPE_DOUBLE, sizeof(double), rowNum, v3);
+  nodesDestroyNode(pCol);
+  for (int32_t i = 0; i < rowNum; ++i) {
+    if (i % 7 == 0) colDataAppendNULL((SColumnInfoData *)taosArrayGet(src->pDataBlock, 2), i);
+    if (i % 5 == 0) colDataAppendNULL((SColumnInfoData *)taosArrayGet(src->pDataBlock, 3), i);
+    if (i % 3 == 0) colDataAppendNULL((SColumnInfoData *)taosArrayGet(src->pDataBlock, 4), i);
+  }
+
+  int32_t expect = 0;
+  for (int32_t i = 0; i < rowNum; ++i) {
+    bool c1 = (i % 7 != 0) && v1[i] > 30 && v1[i] <= 70;
+    bool c2 = (i % 5 == 0) || v2[i] < -50;
+    bool c3 = (i % 3 != 0) && v3[i] >= 0.25 && (i % 7 != 0) && v1[i] >= 10;
+    expect += (c1 || c2 || c3);
+  }
+
+  // (c1 > 30 and c1 <= 70) or (c2 is null) or (c2 < -50) or (c3 >= 0.25 and c1 >= 10)
+  int32_t v30 = 30, v70 = 70, v10 = 10;
+  int64_t vm50 = -50;
+  double  v025 = 0.25;
+  SNode  *list[3] = {0};
+  SNode  *group[4] = {0};
+  scltMakeCompareNode(&list[0], OP_TYPE_GREATER_THAN, src, 2, TSDB_DATA_TYPE_INT, &v30);
+  scltMakeCompareNode(&list[1], OP_TYPE_LOWER_EQUAL, src, 2, TSDB_DATA_TYPE_INT, &v70);
+  scltMakeLogicNode(&group[0], LOGIC_COND_TYPE_AND, list, 2);
+  scltMakeCompareNode(&group[1], OP_TYPE_IS_NULL, src, 3, 0, NULL);
+  scltMakeCompareNode(&group[2], OP_TYPE_LOWER_THAN, src, 3, TSDB_DATA_TYPE_BIGINT, &vm50);
+  scltMakeCompareNode(&list[0], OP_TYPE_GREATER_EQUAL, src, 4, TSDB_DATA_TYPE_DOUBLE, &v025);
+  scltMakeCompareNode(&list[1], OP_TYPE_GREATER_EQUAL, src, 2, TSDB_DATA_TYPE_INT, &v10);
+  scltMakeLogicNode(&group[3], LOGIC_COND_TYPE_AND, list, 2);
+  SNode *pNode = NULL;
+  scltMakeLogicNode(&pNode, LOGIC_COND_TYPE_OR, group, 4);
+  scltCheckFilterBitmap(pNode, src, expect);
+  nodesDestroyNode(pNode);
+
+  // c1 is not null and c2 is not null
+  expect = 0;
+  for (int32_t i = 0; i < rowNum; ++i) {
+    expect += (i % 7 != 0) && (i % 5 != 0);
+  }
+  scltMakeCompareNode(&list[0], OP_TYPE_IS_NOT_NULL, src, 2, 0, NULL);
+  scltMakeCompareNode(&list[1], OP_TYPE_IS_NOT_NULL, src, 3, 0, NULL);
+  scltMakeLogicNode(&pNode, LOGIC_COND_TYPE_AND, list, 2);
+  scltCheckFilterBitmap(pNode, src, expect);
+  nodesDestroyNode(pNode);
+
+  blockDataDestroy(src);
+  taosMemoryFree(v1);
+  taosMemoryFree(v2);
+  taosMemoryFree(v3);
+}
+
+TEST(columnTest, filter_bitmap_all_or_none) {
+  const int32_t rowNum = 130;
+  int64_t       v1[rowNum];
+  for (int32_t i = 0; i < rowNum; ++i) {
+    v1[i] = i * 3;
+  }
+
+  SSDataBlock *src = NULL;
+  SNode       *pCol = NULL;
+  scltMakeColumnNode(&pCol, &src, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), rowNum, v1);
+  nodesDestroyNode(pCol);
+
+  int64_t vLow = 0, vHigh = rowNum * 3;
+  SNode  *list[2] = {0};
+  SNode  *pNode = NULL;
+
+  // all rows qualified: c1 >= 0 and c1 < 390
+  scltMakeCompareNode(&list[0], OP_TYPE_GREATER_EQUAL, src, 2, TSDB_DATA_TYPE_BIGINT, &vLow);
+  scltMakeCompareNode(&list[1], OP_TYPE_LOWER_THAN, src, 2, TSDB_DATA_TYPE_BIGINT, &vHigh);
+  scltMakeLogicNode(&pNode, LOGIC_COND_TYPE_AND, list, 2);
+  scltCheckFilterBitmap(pNode, src, rowNum);
+  nodesDestroyNode(pNode);
+
+  // no row qualified: c1 < 0 or c1 >= 390
+  scltMakeCompareNode(&list[0], OP_TYPE_LOWER_THAN, src, 2, TSDB_DATA_TYPE_BIGINT, &vLow);
+  scltMakeCompareNode(&list[1], OP_TYPE_GREATER_EQUAL, src, 2, TSDB_DATA_TYPE_BIGINT, &vHigh);
+  scltMakeLogicNode(&pNode, LOGIC_COND_TYPE_OR, list, 2);
+  scltCheckFilterBitmap(pNode, src, 0);
+  nodesDestroyNode(pNode);
+
+  // a block of nulls only qualifies c1 is null
+  for (int32_t i = 0; i < rowNum; ++i) {
+    colDataAppendNULL((SColumnInfoData *)taosArrayGet(src->pDataBlock, 2), i);
+  }
+  scltMakeCompareNode(&list[0], OP_TYPE_GREATER_EQUAL, src, 2, TSDB_DATA_TYPE_BIGINT, &vLow);
+  scltMakeCompareNode(&list[1], OP_TYPE_LOWER_THAN, src, 2, TSDB_DATA_TYPE_BIGINT, &vHigh);
+  scltMakeLogicNode(&pNode, LOGIC_COND_TYPE_AND, list, 2);
+  scltCheckFilterBitmap(pNode, src, 0);
+  nodesDestroyNode(pNode);
+
+  scltMakeCompareNode(&pNode, OP_TYPE_IS_NULL, src, 2, 0, NULL);
+  scltCheckFilterBitmap(pNode, src, rowNum);
+  nodesDestroyNode(pNode);
+
+  blockDataDestroy(src);
+}
+
 void scltMakeDataBlock(SScalarParam **pInput, int32_t type, void *pVal, int32_t num, bool setVal) {
   SScalarParam *input = (SScalarParam *)taosMemoryCalloc(1, sizeof(SScalarParam));
   int32_t       bytes;
@@ -28,7 +28,7 @@ typedef struct {
   void*  timer;
 } SStreamGlobalEnv;
 
-static SStreamGlobalEnv streamEnv;
+extern SStreamGlobalEnv streamEnv;
 
 int32_t streamDispatch(SStreamTask* pTask);
 int32_t streamDispatchReqToData(const SStreamDispatchReq* pReq, SStreamDataBlock* pData);
@@ -46,6 +46,25 @@ int32_t streamDispatchOneRecoverFinishReq(SStreamTask* pTask, const SStreamRecov
 
 SStreamQueueItem* streamMergeQueueItem(SStreamQueueItem* dst, SStreamQueueItem* elem);
 
+// checkpoint
+typedef struct {
+  SStreamCheckpointReq req;
+  SRpcHandleInfo       info;
+} SStreamCheckpointAlign;
+
+typedef struct {
+  int64_t        checkpointId;
+  SRpcHandleInfo info;
+} SStreamCheckpointCheck;
+
+int32_t streamDoCheckpoint(SStreamTask* pTask, SStreamCheckpoint* pCheckpoint);
+int32_t streamDispatchCheckpoint(SStreamTask* pTask, SStreamCheckpoint* pCheckpoint);
+
+SStreamCheckpointStore* streamCheckpointStoreOpen(const char* statePath, int64_t* checkpointId, int64_t* ver);
+int32_t streamCheckpointStoreSave(SStreamCheckpointStore* pStore, TDB* db, int64_t checkpointId, int64_t ver);
+int32_t streamCheckpointStoreConfirm(SStreamCheckpointStore* pStore, int64_t checkpointId, int64_t* ver);
+void    streamCheckpointStoreClose(SStreamCheckpointStore* pStore);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,8 @@
 #include "streamInc.h"
 #include "ttimer.h"
 
+SStreamGlobalEnv streamEnv;
+
 int32_t streamInit() {
   int8_t old;
   while (1) {
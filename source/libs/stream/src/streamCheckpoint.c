@@ -14,6 +14,15 @@
  */
 
 #include "streamInc.h"
+#include "tchecksum.h"
+#include "ttimer.h"
+
+// the barrier is sent again to a downstream which failed to take it
+#define STREAM_CHECKPOINT_RETRY_INTERVAL 1000
+// dispatching is resumed if some downstreams do not answer the barrier in time, the checkpoint is not completed then
+#define STREAM_CHECKPOINT_RSP_TIMEOUT (60 * 1000)
+// a check of mnode is answered with an error if the barrier is not executed in time, e.g. the task was restarted
+#define STREAM_CHECKPOINT_CHECK_TIMEOUT (60 * 1000)
 
 int32_t tEncodeSStreamCheckpointSourceReq(SEncoder* pEncoder, const SStreamCheckpointSourceReq* pReq) {
   if (tStartEncode(pEncoder) < 0) return -1;
@@ -65,8 +74,8 @@ int32_t tEncodeSStreamCheckpointReq(SEncoder* pEncoder, const SStreamCheckpointR
   if (tEncodeI64(pEncoder, pReq->checkpointId) < 0) return -1;
   if (tEncodeI32(pEncoder, pReq->downstreamTaskId) < 0) return -1;
   if (tEncodeI32(pEncoder, pReq->downstreamNodeId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pReq->upstreamTaskId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pReq->upstreamNodeId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->upstreamTaskId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->upstreamNodeId) < 0) return -1;
   if (tEncodeI32(pEncoder, pReq->childId) < 0) return -1;
   if (tEncodeI64(pEncoder, pReq->expireTime) < 0) return -1;
   if (tEncodeI8(pEncoder, pReq->taskLevel) < 0) return -1;
@@ -95,8 +104,8 @@ int32_t tEncodeSStreamCheckpointRsp(SEncoder* pEncoder, const SStreamCheckpointR
   if (tEncodeI64(pEncoder, pRsp->checkpointId) < 0) return -1;
   if (tEncodeI32(pEncoder, pRsp->downstreamTaskId) < 0) return -1;
   if (tEncodeI32(pEncoder, pRsp->downstreamNodeId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pRsp->upstreamTaskId) < 0) return -1;
-  if (tEncodeI64(pEncoder, pRsp->upstreamNodeId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pRsp->upstreamTaskId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pRsp->upstreamNodeId) < 0) return -1;
   if (tEncodeI32(pEncoder, pRsp->childId) < 0) return -1;
   if (tEncodeI64(pEncoder, pRsp->expireTime) < 0) return -1;
   if (tEncodeI8(pEncoder, pRsp->taskLevel) < 0) return -1;
@@ -119,76 +128,1078 @@ int32_t tDecodeSStreamCheckpointRsp(SDecoder* pDecoder, SStreamCheckpointRsp* pR
   return 0;
 }
 
-static int32_t streamAlignCheckpoint(SStreamTask* pTask, int64_t checkpointId, int32_t childId) {
-  if (pTask->checkpointingId == 0) {
-    pTask->checkpointingId = checkpointId;
-    pTask->checkpointAlignCnt = taosArrayGetSize(pTask->childEpInfo);
+int32_t tEncodeSStreamCheckpointReportReq(SEncoder* pEncoder, const SStreamCheckpointReportReq* pReq) {
+  if (tStartEncode(pEncoder) < 0) return -1;
+  if (tEncodeI64(pEncoder, pReq->streamId) < 0) return -1;
+  if (tEncodeI64(pEncoder, pReq->checkpointId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->taskId) < 0) return -1;
+  if (tEncodeI32(pEncoder, pReq->nodeId) < 0) return -1;
+  tEndEncode(pEncoder);
+  return pEncoder->pos;
+}
+
+int32_t tDecodeSStreamCheckpointReportReq(SDecoder* pDecoder, SStreamCheckpointReportReq* pReq) {
+  if (tStartDecode(pDecoder) < 0) return -1;
+  if (tDecodeI64(pDecoder, &pReq->streamId) < 0) return -1;
+  if (tDecodeI64(pDecoder, &pReq->checkpointId) < 0) return -1;
+  if (tDecodeI32(pDecoder, &pReq->taskId) < 0) return -1;
+  if (tDecodeI32(pDecoder, &pReq->nodeId) < 0) return -1;
+  tEndDecode(pDecoder);
+  return 0;
+}
+
+// Checkpoints of a task state are kept in <state>/checkpoint:
+//   base        - page image of the state file as of the last completed checkpoint
+//   delta.<seq> - pages changed in a checkpoint since the one taken before, seq orders the checkpoints since open
+//   CURRENT     - the last completed checkpoint, and the deltas being folded into the base for it
+// A checkpoint is written once its delta is renamed in place, and completed once mnode confirms that all tasks of the
+// stream have written it. Only a completed checkpoint is recorded in CURRENT and folded into the base, so no task rolls
+// back to a state the other tasks of the stream may not roll back to. Folding is idempotent, so it is redone on open if
+// the node crashed in between.
+#define STREAM_CHECKPOINT_DIR     "checkpoint"
+#define STREAM_CHECKPOINT_BASE    "base"
+#define STREAM_CHECKPOINT_DELTA   "delta"
+#define STREAM_CHECKPOINT_CURRENT "CURRENT"
+
+// the changed pages are written to the delta through a buffer of this size
+#define STREAM_CHECKPOINT_BUF_SIZE (1024 * 1024)
+
+typedef struct {
+  int64_t checkpointId;
+  int64_t ver;
+  int64_t applySeq;  // deltas up to it are folded into the base for checkpointId, 0 if done
+  TSCKSUM cksum;
+} SStreamCheckpointCurrent;
+
+// delta file: the header, nDelta pages each as a uint32_t pgno and szPage bytes, and the checksum of the pages and the
+// header
+typedef struct {
+  int64_t  checkpointId;
+  int64_t  ver;
+  int64_t  seq;
+  int32_t  szPage;
+  uint32_t nPage;
+  int32_t  nDelta;
+  int32_t  reserved;
+} SStreamCheckpointDeltaHdr;
+
+typedef struct {
+  int64_t seq;
+  int64_t checkpointId;
+  int64_t ver;
+} SStreamCheckpointDelta;
+
+struct SStreamCheckpointStore {
+  char          path[TSDB_FILENAME_LEN];
+  TdThreadMutex mutex;
+  int64_t       checkpointId;  // last completed checkpoint
+  int64_t       ver;
+  int64_t       applySeq;  // deltas up to it are to be folded into the base
+  int64_t       seq;       // of the last checkpoint taken
+  SArray*       pDeltas;   // SStreamCheckpointDelta, written and not folded yet, in the order of seq
+  bool          full;      // changed pages are unknown, the next checkpoint takes all pages
+  bool          running;   // the thread is writing a delta or folding
+  int32_t       code;      // result of the last delta written
+  TdThread      thread;
+
+  // delta being written
+  SStreamCheckpointDeltaHdr hdr;
+  TdFilePtr                 pFile;
+  TSCKSUM                   cksum;
+  char*                     pBuf;
+  int32_t                   len;
+  int32_t                   cap;
+};
+
+static void streamCheckpointFileName(SStreamCheckpointStore* pStore, const char* name, char* fname) {
+  snprintf(fname, TSDB_FILENAME_LEN, "%s%s%s", pStore->path, TD_DIRSEP, name);
+}
+
+static void streamCheckpointDeltaName(SStreamCheckpointStore* pStore, int64_t seq, char* fname) {
+  snprintf(fname, TSDB_FILENAME_LEN, "%s%s%s.%" PRId64, pStore->path, TD_DIRSEP, STREAM_CHECKPOINT_DELTA, seq);
+}
+
+static TSCKSUM streamCheckpointCksum(TSCKSUM cksum, const char* pData, int64_t size) {
+  while (size > 0) {
+    uint32_t len = (uint32_t)TMIN(size, INT32_MAX);
+    cksum = taosCalcChecksum(cksum, (const uint8_t*)pData, len);
+    pData += len;
+    size -= len;
   }
+  return cksum;
+}
+
+// return 1 if read, 0 if there is no completed checkpoint
+static int32_t streamCheckpointReadCurrent(SStreamCheckpointStore* pStore, SStreamCheckpointCurrent* pCurrent) {
+  char fname[TSDB_FILENAME_LEN];
+  streamCheckpointFileName(pStore, STREAM_CHECKPOINT_CURRENT, fname);
 
-  ASSERT(pTask->checkpointingId == checkpointId);
+  if (!taosCheckExistFile(fname)) return 0;
 
-  return atomic_sub_fetch_32(&pTask->checkpointAlignCnt, 1);
+  TdFilePtr pFile = taosOpenFile(fname, TD_FILE_READ);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  int64_t nread = taosReadFile(pFile, pCurrent, sizeof(*pCurrent));
+  taosCloseFile(&pFile);
+
+  if (nread != sizeof(*pCurrent) ||
+      pCurrent->cksum != taosCalcChecksum(0, (const uint8_t*)pCurrent, offsetof(SStreamCheckpointCurrent, cksum))) {
+    qError("stream checkpoint file %s is corrupted", fname);
+    terrno = TSDB_CODE_FILE_CORRUPTED;
+    return -1;
+  }
+  return 1;
 }
 
-static int32_t streamDoCheckpoint(SStreamMeta* pMeta, SStreamTask* pTask, int64_t checkpointId) {
-  // commit tdb state
-  streamStateCommit(pTask->pState);
-  // commit non-tdb state
-  // copy and save new state
-  // report to mnode
-  // send checkpoint req to downstream
+static int32_t streamCheckpointWriteCurrent(SStreamCheckpointStore* pStore, SStreamCheckpointCurrent* pCurrent) {
+  char fname[TSDB_FILENAME_LEN];
+  char tname[TSDB_FILENAME_LEN];
+  streamCheckpointFileName(pStore, STREAM_CHECKPOINT_CURRENT, fname);
+  snprintf(tname, TSDB_FILENAME_LEN, "%s.t", fname);
+
+  pCurrent->cksum = taosCalcChecksum(0, (const uint8_t*)pCurrent, offsetof(SStreamCheckpointCurrent, cksum));
+
+  TdFilePtr pFile = taosOpenFile(tname, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  if (taosWriteFile(pFile, pCurrent, sizeof(*pCurrent)) != sizeof(*pCurrent) || taosFsyncFile(pFile) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    taosCloseFile(&pFile);
+    return -1;
+  }
+  taosCloseFile(&pFile);
+
+  if (taosRenameFile(tname, fname) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
   return 0;
 }
 
-static int32_t streamDoSourceCheckpoint(SStreamMeta* pMeta, SStreamTask* pTask, int64_t checkpointId) {
-  // ref wal
-  // set status checkpointing
-  // do checkpoint
+// Apply the pages of a delta to the base. The delta is checked in full before any page is applied.
+static int32_t streamCheckpointApplyDelta(SStreamCheckpointStore* pStore, TdFilePtr pBase, int64_t seq) {
+  char                      fname[TSDB_FILENAME_LEN];
+  SStreamCheckpointDeltaHdr hdr;
+  TSCKSUM                   cksum = 0;
+  TSCKSUM                   fcksum;
+  char*                     pBuf = NULL;
+  int64_t                   size;
+
+  streamCheckpointDeltaName(pStore, seq, fname);
+  TdFilePtr pFile = taosOpenFile(fname, TD_FILE_READ);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  if (taosReadFile(pFile, &hdr, sizeof(hdr)) != sizeof(hdr) || hdr.seq != seq || hdr.szPage <= 0 ||
+      hdr.nDelta < 0 || hdr.nDelta > hdr.nPage) {
+    goto _corrupted;
+  }
+  pBuf = taosMemoryMalloc(TMAX(STREAM_CHECKPOINT_BUF_SIZE, sizeof(uint32_t) + hdr.szPage));
+  if (pBuf == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    taosCloseFile(&pFile);
+    return -1;
+  }
+
+  size = (int64_t)(sizeof(uint32_t) + hdr.szPage) * hdr.nDelta;
+  for (int64_t offset = 0; offset < size;) {
+    int64_t len = TMIN(size - offset, STREAM_CHECKPOINT_BUF_SIZE);
+    if (taosReadFile(pFile, pBuf, len) != len) goto _corrupted;
+    cksum = streamCheckpointCksum(cksum, pBuf, len);
+    offset += len;
+  }
+  cksum = streamCheckpointCksum(cksum, (const char*)&hdr, sizeof(hdr));
+  if (taosReadFile(pFile, &fcksum, sizeof(fcksum)) != sizeof(fcksum) || fcksum != cksum) {
+    goto _corrupted;
+  }
+
+  for (int32_t i = 0; i < hdr.nDelta; i++) {
+    int64_t  offset = sizeof(hdr) + (int64_t)(sizeof(uint32_t) + hdr.szPage) * i;
+    uint32_t pgno;
+    if (taosPReadFile(pFile, pBuf, sizeof(uint32_t) + hdr.szPage, offset) != sizeof(uint32_t) + hdr.szPage) {
+      goto _err;
+    }
+    memcpy(&pgno, pBuf, sizeof(uint32_t));
+    if (taosPWriteFile(pBase, pBuf + sizeof(uint32_t), hdr.szPage, (int64_t)hdr.szPage * (pgno - 1)) != hdr.szPage) {
+      goto _err;
+    }
+  }
+  if (taosFtruncateFile(pBase, (int64_t)hdr.szPage * hdr.nPage) < 0) {
+    goto _err;
+  }
+
+  taosMemoryFree(pBuf);
+  taosCloseFile(&pFile);
   return 0;
+
+_err:
+  terrno = TAOS_SYSTEM_ERROR(errno);
+  taosMemoryFree(pBuf);
+  taosCloseFile(&pFile);
+  return -1;
+
+_corrupted:
+  qError("stream checkpoint file %s is corrupted", fname);
+  terrno = TSDB_CODE_FILE_CORRUPTED;
+  taosMemoryFree(pBuf);
+  taosCloseFile(&pFile);
+  return -1;
 }
-int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq) {
-  int32_t code;
-  int64_t checkpointId = pReq->checkpointId;
 
-  code = streamDoSourceCheckpoint(pMeta, pTask, checkpointId);
-  if (code < 0) {
-    // rsp error
+// fold the deltas up to applySeq into the base, in the order they were taken
+static int32_t streamCheckpointFold(SStreamCheckpointStore* pStore) {
+  char    fname[TSDB_FILENAME_LEN];
+  int32_t nFold = 0;
+
+  streamCheckpointFileName(pStore, STREAM_CHECKPOINT_BASE, fname);
+  TdFilePtr pBase = taosOpenFile(fname, TD_FILE_CREATE | TD_FILE_WRITE);
+  if (pBase == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
+  for (; nFold < taosArrayGetSize(pStore->pDeltas); nFold++) {
+    SStreamCheckpointDelta* pDelta = taosArrayGet(pStore->pDeltas, nFold);
+    if (pDelta->seq > pStore->applySeq) break;
+    if (streamCheckpointApplyDelta(pStore, pBase, pDelta->seq) < 0) {
+      taosCloseFile(&pBase);
+      return -1;
+    }
+  }
+  if (taosFsyncFile(pBase) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    taosCloseFile(&pBase);
+    return -1;
+  }
+  taosCloseFile(&pBase);
+
+  SStreamCheckpointCurrent current = {.checkpointId = pStore->checkpointId, .ver = pStore->ver, .applySeq = 0};
+  if (streamCheckpointWriteCurrent(pStore, &current) < 0) {
+    return -1;
+  }
+  pStore->applySeq = 0;
+
+  for (int32_t i = 0; i < nFold; i++) {
+    SStreamCheckpointDelta* pDelta = taosArrayGet(pStore->pDeltas, i);
+    streamCheckpointDeltaName(pStore, pDelta->seq, fname);
+    taosRemoveFile(fname);
+  }
+  taosArrayPopFrontBatch(pStore->pDeltas, nFold);
   return 0;
 }
 
-int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq) {
+// make the delta durable, the checkpoint is written once it is renamed in place
+static int32_t streamCheckpointFinishDelta(SStreamCheckpointStore* pStore) {
+  char fname[TSDB_FILENAME_LEN];
+  char tname[TSDB_FILENAME_LEN];
+  streamCheckpointDeltaName(pStore, pStore->hdr.seq, fname);
+  snprintf(tname, TSDB_FILENAME_LEN, "%s.t", fname);
+
+  int32_t code = taosFsyncFile(pStore->pFile);
+  taosCloseFile(&pStore->pFile);
+  if (code < 0 || taosRenameFile(tname, fname) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    taosRemoveFile(tname);
+    return -1;
+  }
+
+  SStreamCheckpointDelta delta = {
+      .seq = pStore->hdr.seq,
+      .checkpointId = pStore->hdr.checkpointId,
+      .ver = pStore->hdr.ver,
+  };
+  if (taosArrayPush(pStore->pDeltas, &delta) == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    taosRemoveFile(fname);
+    return -1;
+  }
+  return 0;
+}
+
+static void* streamCheckpointThreadFp(void* param) {
+  SStreamCheckpointStore* pStore = param;
+  setThreadName("stream-ckpt");
+
+  if (pStore->pFile) {
+    pStore->code = streamCheckpointFinishDelta(pStore) < 0 ? terrno : 0;
+    if (pStore->code == 0) {
+      qDebug("stream checkpoint %" PRId64 " written to %s, %d of %u pages", pStore->hdr.checkpointId, pStore->path,
+             pStore->hdr.nDelta, pStore->hdr.nPage);
+    }
+  }
+
+  // retried on the next run if failed, or on open
+  if (pStore->applySeq > 0 && streamCheckpointFold(pStore) < 0) {
+    qError("failed to fold stream checkpoint %" PRId64 " into %s since %s", pStore->checkpointId, pStore->path,
+           terrstr());
+  }
+  return NULL;
+}
+
+static void streamCheckpointRun(SStreamCheckpointStore* pStore) {
+  TdThreadAttr thAttr;
+  taosThreadAttrInit(&thAttr);
+  taosThreadAttrSetDetachState(&thAttr, PTHREAD_CREATE_JOINABLE);
+  if (taosThreadCreate(&pStore->thread, &thAttr, streamCheckpointThreadFp, pStore) == 0) {
+    pStore->running = true;
+  } else {
+    streamCheckpointThreadFp(pStore);
+  }
+  taosThreadAttrDestroy(&thAttr);
+}
+
+// called with the mutex held
+static void streamCheckpointWait(SStreamCheckpointStore* pStore) {
+  if (pStore->running) {
+    taosThreadJoin(pStore->thread, NULL);
+    pStore->running = false;
+  }
+  if (pStore->code != 0) {
+    qError("failed to write stream checkpoint %" PRId64 " to %s since %s", pStore->hdr.checkpointId, pStore->path,
+           tstrerror(pStore->code));
+    // the changed pages are lost with it
+    pStore->full = true;
+    pStore->code = 0;
+  }
+}
+
+static int32_t streamCheckpointFlushBuf(SStreamCheckpointStore* pStore) {
+  if (taosWriteFile(pStore->pFile, pStore->pBuf, pStore->len) != pStore->len) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  pStore->cksum = streamCheckpointCksum(pStore->cksum, pStore->pBuf, pStore->len);
+  pStore->len = 0;
+  return 0;
+}
+
+static int32_t streamCheckpointAddPage(void* arg, uint32_t pgno, const void* pData, int32_t szPage) {
+  SStreamCheckpointStore* pStore = arg;
+
+  if (pStore->len + sizeof(uint32_t) + szPage > pStore->cap && streamCheckpointFlushBuf(pStore) < 0) {
+    return -1;
+  }
+
+  memcpy(pStore->pBuf + pStore->len, &pgno, sizeof(uint32_t));
+  memcpy(pStore->pBuf + pStore->len + sizeof(uint32_t), pData, szPage);
+  pStore->len += sizeof(uint32_t) + szPage;
+  pStore->hdr.nDelta++;
+  return 0;
+}
+
+// write the changed pages to the delta, which the thread makes durable later
+static int32_t streamCheckpointWriteDelta(SStreamCheckpointStore* pStore, TDB* db) {
+  char tname[TSDB_FILENAME_LEN];
+  streamCheckpointDeltaName(pStore, pStore->hdr.seq, tname);
+  strcat(tname, ".t");
+
+  pStore->cap = TMAX(STREAM_CHECKPOINT_BUF_SIZE, sizeof(uint32_t) + pStore->hdr.szPage);
+  pStore->pBuf = taosMemoryMalloc(pStore->cap);
+  if (pStore->pBuf == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+  pStore->len = 0;
+  pStore->cksum = 0;
+
+  pStore->pFile = taosOpenFile(tname, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+  if (pStore->pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  // the header is rewritten once nDelta is known
+  if (taosWriteFile(pStore->pFile, &pStore->hdr, sizeof(pStore->hdr)) != sizeof(pStore->hdr)) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+  if (tdbScanChangedPages(db, pStore->full, streamCheckpointAddPage, pStore) < 0 ||
+      streamCheckpointFlushBuf(pStore) < 0) {
+    goto _err;
+  }
+
+  pStore->cksum = streamCheckpointCksum(pStore->cksum, (const char*)&pStore->hdr, sizeof(pStore->hdr));
+  if (taosWriteFile(pStore->pFile, &pStore->cksum, sizeof(pStore->cksum)) != sizeof(pStore->cksum) ||
+      taosPWriteFile(pStore->pFile, &pStore->hdr, sizeof(pStore->hdr), 0) != sizeof(pStore->hdr)) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  taosMemoryFreeClear(pStore->pBuf);
+  return 0;
+
+_err:
+  taosMemoryFreeClear(pStore->pBuf);
+  taosCloseFile(&pStore->pFile);
+  taosRemoveFile(tname);
+  return -1;
+}
+
+// roll the state file back to the checkpoint, the journals belong to the state rolled back
+static int32_t streamCheckpointRestoreState(SStreamCheckpointStore* pStore, const char* statePath) {
+  char bname[TSDB_FILENAME_LEN];
+  char fname[TSDB_FILENAME_LEN];
+  char tname[TSDB_FILENAME_LEN];
+
+  streamCheckpointFileName(pStore, STREAM_CHECKPOINT_BASE, bname);
+  snprintf(fname, TSDB_FILENAME_LEN, "%s%s%s", statePath, TD_DIRSEP, TDB_MAINDB_NAME);
+  snprintf(tname, TSDB_FILENAME_LEN, "%s.t", fname);
+
+  taosRemoveFile(tname);
+  if (taosCopyFile(bname, tname) < 0 || taosRenameFile(tname, fname) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  TdDirPtr pDir = taosOpenDir(statePath);
+  if (pDir == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  TdDirEntryPtr pEntry;
+  while ((pEntry = taosReadDir(pDir)) != NULL) {
+    char* name = taosGetDirEntryName(pEntry);
+    if (strncmp(name, TDB_MAINDB_NAME "-journal", strlen(TDB_MAINDB_NAME "-journal")) == 0) {
+      snprintf(fname, TSDB_FILENAME_LEN, "%s%s%s", statePath, TD_DIRSEP, name);
+      taosRemoveFile(fname);
+    }
+  }
+  taosCloseDir(&pDir);
+  return 0;
+}
+
+static int32_t streamCheckpointDeltaCmpr(const void* p1, const void* p2) {
+  const SStreamCheckpointDelta* pDelta1 = p1;
+  const SStreamCheckpointDelta* pDelta2 = p2;
+  if (pDelta1->seq == pDelta2->seq) return 0;
+  return pDelta1->seq < pDelta2->seq ? -1 : 1;
+}
+
+// Collect the deltas to fold for the completed checkpoint and remove the others. The deltas not completed are taken
+// since the completed checkpoint, which the state is rolled back to.
+static int32_t streamCheckpointScanDeltas(SStreamCheckpointStore* pStore) {
+  char fname[TSDB_FILENAME_LEN];
+
+  TdDirPtr pDir = taosOpenDir(pStore->path);
+  if (pDir == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  TdDirEntryPtr pEntry;
+  while ((pEntry = taosReadDir(pDir)) != NULL) {
+    char*   name = taosGetDirEntryName(pEntry);
+    int64_t seq = 0;
+    int32_t len = 0;
+    if (strncmp(name, STREAM_CHECKPOINT_DELTA ".", strlen(STREAM_CHECKPOINT_DELTA ".")) != 0) continue;
+
+    if (sscanf(name + strlen(STREAM_CHECKPOINT_DELTA "."), "%" SCNd64 "%n", &seq, &len) == 1 &&
+        name[strlen(STREAM_CHECKPOINT_DELTA ".") + len] == '\0' && seq > 0 && seq <= pStore->applySeq) {
+      SStreamCheckpointDelta delta = {.seq = seq};
+      taosArrayPush(pStore->pDeltas, &delta);
+    } else {
+      streamCheckpointFileName(pStore, name, fname);
+      taosRemoveFile(fname);
+    }
+  }
+  taosCloseDir(&pDir);
+
+  taosArraySort(pStore->pDeltas, streamCheckpointDeltaCmpr);
+  return 0;
+}
+
+SStreamCheckpointStore* streamCheckpointStoreOpen(const char* statePath, int64_t* checkpointId, int64_t* ver) {
+  SStreamCheckpointCurrent current = {0};
+  int32_t                  code;
+
+  SStreamCheckpointStore* pStore = taosMemoryCalloc(1, sizeof(SStreamCheckpointStore));
+  if (pStore == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+  snprintf(pStore->path, TSDB_FILENAME_LEN, "%s%s%s", statePath, TD_DIRSEP, STREAM_CHECKPOINT_DIR);
+  pStore->full = true;
+  taosThreadMutexInit(&pStore->mutex, NULL);
+  pStore->pDeltas = taosArrayInit(4, sizeof(SStreamCheckpointDelta));
+  if (pStore->pDeltas == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  if (taosMulMkDir(pStore->path) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  code = streamCheckpointReadCurrent(pStore, &current);
+  if (code < 0) goto _err;
+  if (code > 0) {
+    pStore->checkpointId = current.checkpointId;
+    pStore->ver = current.ver;
+    pStore->applySeq = current.applySeq;
+  }
+
+  if (streamCheckpointScanDeltas(pStore) < 0) goto _err;
+  if (pStore->applySeq > 0 && streamCheckpointFold(pStore) < 0) goto _err;
+
+  if (pStore->checkpointId > 0) {
+    if (streamCheckpointRestoreState(pStore, statePath) < 0) goto _err;
+    pStore->full = false;
+    qInfo("stream state %s restored from checkpoint %" PRId64 ", ver:%" PRId64, statePath, pStore->checkpointId,
+          pStore->ver);
+  }
+
+  *checkpointId = pStore->checkpointId;
+  *ver = pStore->ver;
+  return pStore;
+
+_err:
+  qError("failed to open stream checkpoint %s since %s", pStore->path, terrstr());
+  taosArrayDestroy(pStore->pDeltas);
+  taosThreadMutexDestroy(&pStore->mutex);
+  taosMemoryFree(pStore);
+  return NULL;
+}
+
+int32_t streamCheckpointStoreSave(SStreamCheckpointStore* pStore, TDB* db, int64_t checkpointId, int64_t ver) {
+  taosThreadMutexLock(&pStore->mutex);
+
+  // the delta is taken on the previous one
+  streamCheckpointWait(pStore);
+
+  memset(&pStore->hdr, 0, sizeof(pStore->hdr));
+  pStore->hdr.checkpointId = checkpointId;
+  pStore->hdr.ver = ver;
+  pStore->hdr.seq = ++pStore->seq;
+  tdbGetFileInfo(db, &pStore->hdr.szPage, &pStore->hdr.nPage);
+
+  if (streamCheckpointWriteDelta(pStore, db) < 0) {
+    qError("failed to take stream checkpoint %" PRId64 " of %s since %s", checkpointId, pStore->path, terrstr());
+    pStore->full = true;
+    taosThreadMutexUnlock(&pStore->mutex);
+    return -1;
+  }
+  pStore->full = false;
+
+  // synced in the background, the task goes on with the data after the barrier
+  streamCheckpointRun(pStore);
+  taosThreadMutexUnlock(&pStore->mutex);
+  return 0;
+}
+
+int32_t streamCheckpointStoreConfirm(SStreamCheckpointStore* pStore, int64_t checkpointId, int64_t* ver) {
+  taosThreadMutexLock(&pStore->mutex);
+  streamCheckpointWait(pStore);
+
+  if (pStore->checkpointId == checkpointId) {
+    *ver = pStore->ver;
+    taosThreadMutexUnlock(&pStore->mutex);
+    return 0;
+  }
+
+  SStreamCheckpointDelta* pDelta = NULL;
+  for (int32_t i = 0; i < taosArrayGetSize(pStore->pDeltas); i++) {
+    SStreamCheckpointDelta* p = taosArrayGet(pStore->pDeltas, i);
+    if (p->checkpointId == checkpointId) {
+      pDelta = p;
+      break;
+    }
+  }
+  if (pDelta == NULL) {
+    qError("failed to complete stream checkpoint %" PRId64 " of %s since it is not written", checkpointId,
+           pStore->path);
+    taosThreadMutexUnlock(&pStore->mutex);
+    terrno = TSDB_CODE_NOT_FOUND;
+    return -1;
+  }
+
+  SStreamCheckpointCurrent current = {.checkpointId = checkpointId, .ver = pDelta->ver, .applySeq = pDelta->seq};
+  if (streamCheckpointWriteCurrent(pStore, &current) < 0) {
+    qError("failed to complete stream checkpoint %" PRId64 " of %s since %s", checkpointId, pStore->path, terrstr());
+    taosThreadMutexUnlock(&pStore->mutex);
+    return -1;
+  }
+  pStore->checkpointId = current.checkpointId;
+  pStore->ver = current.ver;
+  pStore->applySeq = current.applySeq;
+  *ver = current.ver;
+
+  // the deltas are folded in the background
+  streamCheckpointRun(pStore);
+  taosThreadMutexUnlock(&pStore->mutex);
+  return 0;
+}
+
+void streamCheckpointStoreClose(SStreamCheckpointStore* pStore) {
+  if (pStore == NULL) return;
+  taosThreadMutexLock(&pStore->mutex);
+  streamCheckpointWait(pStore);
+  taosThreadMutexUnlock(&pStore->mutex);
+  taosThreadMutexDestroy(&pStore->mutex);
+  taosArrayDestroy(pStore->pDeltas);
+  taosMemoryFree(pStore);
+}
+
+// barrier
+
+int32_t streamSendCheckpointRsp(const SStreamCheckpointReq* pReq, const SRpcHandleInfo* pInfo, int32_t code) {
+  SStreamCheckpointRsp rsp = {
+      .streamId = pReq->streamId,
+      .checkpointId = pReq->checkpointId,
+      .downstreamTaskId = pReq->downstreamTaskId,
+      .downstreamNodeId = pReq->downstreamNodeId,
+      .upstreamTaskId = pReq->upstreamTaskId,
+      .upstreamNodeId = pReq->upstreamNodeId,
+      .childId = pReq->childId,
+      .expireTime = pReq->expireTime,
+      .taskLevel = pReq->taskLevel,
+  };
+
+  int32_t len;
+  int32_t ret;
+  tEncodeSize(tEncodeSStreamCheckpointRsp, &rsp, len, ret);
+  if (ret < 0) return -1;
+
+  void* buf = rpcMallocCont(sizeof(SMsgHead) + len);
+  if (buf == NULL) return -1;
+  ((SMsgHead*)buf)->vgId = htonl(pReq->upstreamNodeId);
+
+  SEncoder encoder;
+  tEncoderInit(&encoder, POINTER_SHIFT(buf, sizeof(SMsgHead)), len);
+  tEncodeSStreamCheckpointRsp(&encoder, &rsp);
+  tEncoderClear(&encoder);
+
+  SRpcMsg rspMsg = {
+      .code = code,
+      .pCont = buf,
+      .contLen = sizeof(SMsgHead) + len,
+      .info = *pInfo,
+  };
+  tmsgSendRsp(&rspMsg);
+  return 0;
+}
+
+static int32_t streamDispatchOneCheckpointReq(SStreamTask* pTask, const SStreamCheckpointReq* pReq, int32_t nodeId,
+                                              SEpSet* pEpSet) {
+  int32_t len;
   int32_t code;
-  int64_t checkpointId = pReq->checkpointId;
-  int32_t childId = pReq->childId;
+  tEncodeSize(tEncodeSStreamCheckpointReq, pReq, len, code);
+  if (code < 0) return -1;
 
-  if (taosArrayGetSize(pTask->childEpInfo) > 0) {
-    code = streamAlignCheckpoint(pTask, checkpointId, childId);
-    if (code > 0) {
-      return 0;
+  void* buf = rpcMallocCont(sizeof(SMsgHead) + len);
+  if (buf == NULL) return -1;
+  ((SMsgHead*)buf)->vgId = htonl(nodeId);
+
+  SEncoder encoder;
+  tEncoderInit(&encoder, POINTER_SHIFT(buf, sizeof(SMsgHead)), len);
+  tEncodeSStreamCheckpointReq(&encoder, pReq);
+  tEncoderClear(&encoder);
+
+  SRpcMsg msg = {
+      .msgType = TDMT_STREAM_TASK_CHECKPOINT,
+      .pCont = buf,
+      .contLen = sizeof(SMsgHead) + len,
+  };
+
+  qDebug("dispatch from task %d to task %d node %d: checkpoint %" PRId64, pTask->taskId, pReq->downstreamTaskId, nodeId,
+         pReq->checkpointId);
+  tmsgSendReq(pEpSet, &msg);
+  return 0;
+}
+
+typedef struct {
+  SStreamTask*         pTask;
+  SStreamCheckpointReq req;
+} SStreamCheckpointTmrParam;
+
+static void streamStartCheckpointTmr(SStreamTask* pTask, const SStreamCheckpointReq* pReq, TAOS_TMR_CALLBACK fp,
+                                     int32_t mseconds) {
+  SStreamCheckpointTmrParam* pParam = taosMemoryMalloc(sizeof(SStreamCheckpointTmrParam));
+  if (pParam == NULL) return;
+  pParam->pTask = pTask;
+  pParam->req = *pReq;
+
+  atomic_add_fetch_32(&pTask->refCnt, 1);
+  if (taosTmrStart(fp, mseconds, pParam, streamEnv.timer) == NULL) {
+    streamMetaReleaseTask(NULL, pTask);
+    taosMemoryFree(pParam);
+  }
+}
+
+static bool streamCheckpointRspLeft(SStreamTask* pTask, int64_t checkpointId) {
+  return atomic_load_64(&pTask->checkpointWaitingId) == checkpointId &&
+         atomic_load_32(&pTask->checkpointWaitingRsp) > 0;
+}
+
+// count a downstream as answered, return true if it was the last one
+static bool streamCheckpointRspDone(SStreamTask* pTask) {
+  while (1) {
+    int32_t left = atomic_load_32(&pTask->checkpointWaitingRsp);
+    if (left <= 0) return false;
+    if (atomic_val_compare_exchange_32(&pTask->checkpointWaitingRsp, left, left - 1) == left) {
+      return left == 1;
+    }
+  }
+}
+
+static void streamResumeDispatch(SStreamTask* pTask) {
+  int8_t old = atomic_exchange_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+  ASSERT(old == TASK_OUTPUT_STATUS__WAIT);
+  streamDispatch(pTask);
+}
+
+static void streamCheckpointRspTimeout(void* param, void* tmrId) {
+  SStreamCheckpointTmrParam* pParam = param;
+  SStreamTask*               pTask = pParam->pTask;
+
+  if (atomic_load_8(&pTask->taskStatus) != TASK_STATUS__DROPPING &&
+      atomic_load_64(&pTask->checkpointWaitingId) == pParam->req.checkpointId) {
+    int32_t left = atomic_exchange_32(&pTask->checkpointWaitingRsp, 0);
+    if (left > 0) {
+      qError("task %d checkpoint %" PRId64 " not answered by %d downstreams in time, go on dispatching", pTask->taskId,
+             pParam->req.checkpointId, left);
+      streamResumeDispatch(pTask);
     }
-    if (code < 0) {
-      ASSERT(0);
+  }
+
+  streamMetaReleaseTask(NULL, pTask);
+  taosMemoryFree(pParam);
+}
+
+static SEpSet* streamGetDownstreamEpSet(SStreamTask* pTask, int32_t taskId) {
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    return pTask->fixedEpDispatcher.taskId == taskId ? &pTask->fixedEpDispatcher.epSet : NULL;
+  }
+  SArray* vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
+  for (int32_t i = 0; i < taosArrayGetSize(vgInfo); i++) {
+    SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
+    if (pVgInfo->taskId == taskId) return &pVgInfo->epSet;
+  }
+  return NULL;
+}
+
+static void streamCheckpointRetry(void* param, void* tmrId) {
+  SStreamCheckpointTmrParam* pParam = param;
+  SStreamTask*               pTask = pParam->pTask;
+
+  // not retried once given up by the timeout
+  if (atomic_load_8(&pTask->taskStatus) != TASK_STATUS__DROPPING &&
+      streamCheckpointRspLeft(pTask, pParam->req.checkpointId)) {
+    SStreamCheckpointReq* pReq = &pParam->req;
+    SEpSet*               pEpSet = streamGetDownstreamEpSet(pTask, pReq->downstreamTaskId);
+    if (pEpSet == NULL || streamDispatchOneCheckpointReq(pTask, pReq, pReq->downstreamNodeId, pEpSet) < 0) {
+      streamStartCheckpointTmr(pTask, &pParam->req, streamCheckpointRetry, STREAM_CHECKPOINT_RETRY_INTERVAL);
+    }
+  }
+
+  streamMetaReleaseTask(NULL, pTask);
+  taosMemoryFree(pParam);
+}
+
+// Called by streamDispatch when the barrier reaches the head of the output queue, so all data before it has been
+// received by the downstreams. Dispatching stays blocked until every downstream has queued the barrier, or until the
+// rsps time out.
+int32_t streamDispatchCheckpoint(SStreamTask* pTask, SStreamCheckpoint* pCheckpoint) {
+  SStreamCheckpointReq req = {
+      .streamId = pTask->streamId,
+      .checkpointId = pCheckpoint->checkpointId,
+      .upstreamTaskId = pTask->taskId,
+      .upstreamNodeId = pTask->nodeId,
+      .childId = pTask->selfChildId,
+      .taskLevel = pTask->taskLevel,
+  };
+
+  atomic_store_64(&pTask->checkpointWaitingId, pCheckpoint->checkpointId);
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    atomic_store_32(&pTask->checkpointWaitingRsp, 1);
+    req.downstreamTaskId = pTask->fixedEpDispatcher.taskId;
+    req.downstreamNodeId = pTask->fixedEpDispatcher.nodeId;
+    if (streamDispatchOneCheckpointReq(pTask, &req, req.downstreamNodeId, &pTask->fixedEpDispatcher.epSet) < 0) {
+      atomic_store_32(&pTask->checkpointWaitingRsp, 0);
       return -1;
     }
+  } else {
+    SArray* vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
+    int32_t vgSz = taosArrayGetSize(vgInfo);
+    atomic_store_32(&pTask->checkpointWaitingRsp, vgSz);
+    for (int32_t i = 0; i < vgSz; i++) {
+      SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
+      req.downstreamTaskId = pVgInfo->taskId;
+      req.downstreamNodeId = pVgInfo->vgId;
+      if (streamDispatchOneCheckpointReq(pTask, &req, pVgInfo->vgId, &pVgInfo->epSet) < 0) {
+        // the downstreams dispatched already are not waited for
+        atomic_store_32(&pTask->checkpointWaitingRsp, 0);
+        return -1;
+      }
+    }
+  }
+
+  // a rsp lost in the network never arrives
+  streamStartCheckpointTmr(pTask, &req, streamCheckpointRspTimeout, STREAM_CHECKPOINT_RSP_TIMEOUT);
+  return 0;
+}
+
+// mnode checks
+
+typedef struct {
+  SStreamTask* pTask;
+  int64_t      checkpointId;
+} SStreamCheckpointCheckTmrParam;
+
+// take the checks held for the checkpoint out, called with checkpointLock held
+static SArray* streamTakeCheckpointChecks(SStreamTask* pTask, int64_t checkpointId) {
+  SArray* pTaken = NULL;
+  for (int32_t i = 0; i < taosArrayGetSize(pTask->checkpointChecks);) {
+    SStreamCheckpointCheck* pCheck = taosArrayGet(pTask->checkpointChecks, i);
+    if (pCheck->checkpointId != checkpointId) {
+      i++;
+      continue;
+    }
+    if (pTaken == NULL) pTaken = taosArrayInit(1, sizeof(SStreamCheckpointCheck));
+    taosArrayPush(pTaken, pCheck);
+    taosArrayRemove(pTask->checkpointChecks, i);
+  }
+  return pTaken;
+}
+
+static void streamAnswerCheckpointChecks(SStreamTask* pTask, SArray* pChecks, int32_t code) {
+  for (int32_t i = 0; i < taosArrayGetSize(pChecks); i++) {
+    SStreamCheckpointCheck* pCheck = taosArrayGet(pChecks, i);
+    qDebug("task %d answer checkpoint %" PRId64 " check, code:%s", pTask->taskId, pCheck->checkpointId,
+           tstrerror(code));
+    SRpcMsg rsp = {.code = code, .info = pCheck->info};
+    tmsgSendRsp(&rsp);
+  }
+  taosArrayDestroy(pChecks);
+}
+
+static void streamCheckpointCheckTimeout(void* param, void* tmrId) {
+  SStreamCheckpointCheckTmrParam* pParam = param;
+  SStreamTask*                    pTask = pParam->pTask;
+
+  taosWLockLatch(&pTask->checkpointLock);
+  SArray* pChecks = streamTakeCheckpointChecks(pTask, pParam->checkpointId);
+  taosWUnLockLatch(&pTask->checkpointLock);
+
+  if (pChecks != NULL) {
+    qError("task %d checkpoint %" PRId64 " not executed in time, the checkpoint is given up", pTask->taskId,
+           pParam->checkpointId);
+    streamAnswerCheckpointChecks(pTask, pChecks, TSDB_CODE_TIMEOUT_ERROR);
   }
 
-  code = streamDoCheckpoint(pMeta, pTask, checkpointId);
-  if (code < 0) {
-    // rsp error
+  streamMetaReleaseTask(NULL, pTask);
+  taosMemoryFree(pParam);
+}
+
+static void streamCheckpointWritten(SStreamTask* pTask, int64_t checkpointId, int32_t code) {
+  taosWLockLatch(&pTask->checkpointLock);
+  pTask->checkpointWrittenId = checkpointId;
+  pTask->checkpointWrittenCode = code;
+  SArray* pChecks = streamTakeCheckpointChecks(pTask, checkpointId);
+  taosWUnLockLatch(&pTask->checkpointLock);
+
+  streamAnswerCheckpointChecks(pTask, pChecks, code);
+}
+
+// Called when the task executes the barrier, after all data before it.
+int32_t streamDoCheckpoint(SStreamTask* pTask, SStreamCheckpoint* pCheckpoint) {
+  int32_t code = 0;
+
+  qDebug("task %d do checkpoint %" PRId64 ", source ver:%" PRId64, pTask->taskId, pCheckpoint->checkpointId,
+         pCheckpoint->sourceVer);
+
+  if (pTask->pState && streamStateCheckpoint(pTask->pState, pCheckpoint->checkpointId, pCheckpoint->sourceVer) < 0) {
+    // the downstreams still get the barrier, only this task misses the checkpoint
+    code = terrno;
+    qError("task %d failed to do checkpoint %" PRId64 " since %s", pTask->taskId, pCheckpoint->checkpointId,
+           terrstr());
+  }
+  streamCheckpointWritten(pTask, pCheckpoint->checkpointId, code);
+
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH || pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH) {
+    // forward the barrier behind the output of the data before it
+    taosWriteQitem(pTask->outputQueue->queue, pCheckpoint);
+    streamDispatch(pTask);
+  } else {
+    taosFreeQitem(pCheckpoint);
+  }
+  return 0;
+}
+
+static int32_t streamAddCheckpointBarrier(SStreamTask* pTask, int64_t checkpointId, int64_t ver) {
+  SStreamCheckpoint* pCheckpoint = taosAllocateQitem(sizeof(SStreamCheckpoint), DEF_QITEM, 0);
+  if (pCheckpoint == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
     return -1;
   }
+  pCheckpoint->type = STREAM_INPUT__CHECKPOINT;
+  pCheckpoint->checkpointId = checkpointId;
+  pCheckpoint->sourceVer = ver;
+
+  streamTaskInput(pTask, (SStreamQueueItem*)pCheckpoint);
+  streamSchedExec(pTask);
+  return 0;
+}
 
-  // send rsp to all children
+// Hold the upstream until the barrier has arrived from all upstreams, so no data after the barrier gets in before it.
+// Return the number of upstreams still to arrive.
+static int32_t streamAlignCheckpoint(SStreamTask* pTask, const SStreamCheckpointReq* pReq, const SRpcMsg* pRsp) {
+  SStreamCheckpointAlign align = {.req = *pReq, .info = pRsp->info};
+  int32_t                left;
 
+  taosWLockLatch(&pTask->checkpointLock);
+  if (pTask->checkpointingId == 0) {
+    pTask->checkpointingId = pReq->checkpointId;
+    pTask->checkpointAlignCnt = TMAX(taosArrayGetSize(pTask->childEpInfo), 1);
+  }
+  ASSERT(pTask->checkpointingId == pReq->checkpointId);
+
+  if (pTask->checkpointAligned == NULL) {
+    pTask->checkpointAligned = taosArrayInit(pTask->checkpointAlignCnt, sizeof(SStreamCheckpointAlign));
+  }
+  taosArrayPush(pTask->checkpointAligned, &align);
+  left = --pTask->checkpointAlignCnt;
+  if (left == 0) {
+    pTask->checkpointingId = 0;
+  }
+  taosWUnLockLatch(&pTask->checkpointLock);
+
+  return left;
+}
+
+int32_t streamProcessCheckpointSourceReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointSourceReq* pReq,
+                                         int64_t ver) {
+  ASSERT(pTask->taskLevel == TASK_LEVEL__SOURCE);
+
+  // the submits before ver were pushed to the input queue, the barrier goes behind them
+  qDebug("task %d receive checkpoint %" PRId64 " source req, ver:%" PRId64, pTask->taskId, pReq->checkpointId, ver);
+  return streamAddCheckpointBarrier(pTask, pReq->checkpointId, ver);
+}
+
+int32_t streamProcessCheckpointReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReq* pReq,
+                                   SRpcMsg* pRsp) {
+  int32_t code = 0;
+
+  qDebug("task %d receive checkpoint %" PRId64 " req from task %d, child id %d", pTask->taskId, pReq->checkpointId,
+         pReq->upstreamTaskId, pReq->childId);
+
+  if (streamAlignCheckpoint(pTask, pReq, pRsp) > 0) {
+    return 0;
+  }
+
+  if (streamAddCheckpointBarrier(pTask, pReq->checkpointId, -1) < 0) {
+    code = terrno;
+  }
+
+  // release the upstreams, the data they dispatch from now on is queued behind the barrier
+  taosWLockLatch(&pTask->checkpointLock);
+  SArray* pAligned = pTask->checkpointAligned;
+  pTask->checkpointAligned = NULL;
+  taosWUnLockLatch(&pTask->checkpointLock);
+
+  for (int32_t i = 0; i < taosArrayGetSize(pAligned); i++) {
+    SStreamCheckpointAlign* pAlign = taosArrayGet(pAligned, i);
+    streamSendCheckpointRsp(&pAlign->req, &pAlign->info, code);
+  }
+  taosArrayDestroy(pAligned);
+
+  return code == 0 ? 0 : -1;
+}
+
+int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp, int32_t code) {
+  qDebug("task %d receive checkpoint %" PRId64 " rsp from task %d, code:%s", pTask->taskId, pRsp->checkpointId,
+         pRsp->downstreamTaskId, tstrerror(code));
+
+  // a late rsp of a barrier timed out
+  if (!streamCheckpointRspLeft(pTask, pRsp->checkpointId)) {
+    return 0;
+  }
+
+  if (code != 0) {
+    qError("task %d failed to dispatch checkpoint %" PRId64 " to task %d since %s, retry later", pTask->taskId,
+           pRsp->checkpointId, pRsp->downstreamTaskId, tstrerror(code));
+    SStreamCheckpointReq req = {
+        .streamId = pRsp->streamId,
+        .checkpointId = pRsp->checkpointId,
+        .downstreamTaskId = pRsp->downstreamTaskId,
+        .downstreamNodeId = pRsp->downstreamNodeId,
+        .upstreamTaskId = pRsp->upstreamTaskId,
+        .upstreamNodeId = pRsp->upstreamNodeId,
+        .childId = pRsp->childId,
+        .expireTime = pRsp->expireTime,
+        .taskLevel = pRsp->taskLevel,
+    };
+    streamStartCheckpointTmr(pTask, &req, streamCheckpointRetry, STREAM_CHECKPOINT_RETRY_INTERVAL);
+    return 0;
+  }
+
+  if (streamCheckpointRspDone(pTask)) {
+    // continue dispatch
+    streamResumeDispatch(pTask);
+  }
   return 0;
 }
 
-int32_t streamProcessCheckpointRsp(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointRsp* pRsp) {
-  // recover step2, scan from wal
-  // unref wal
-  // set status normal
+// Mnode checks that every task of the stream has written the checkpoint before completing it. The check is answered
+// once the task executes the barrier.
+int32_t streamProcessCheckpointCheckReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReportReq* pReq,
+                                        SRpcMsg* pMsg) {
+  SStreamCheckpointCheck check = {.checkpointId = pReq->checkpointId, .info = pMsg->info};
+  bool                   written = false;
+  int32_t                code = 0;
+
+  taosWLockLatch(&pTask->checkpointLock);
+  if (pTask->checkpointWrittenId == pReq->checkpointId) {
+    written = true;
+    code = pTask->checkpointWrittenCode;
+  } else {
+    if (pTask->checkpointChecks == NULL) {
+      pTask->checkpointChecks = taosArrayInit(1, sizeof(SStreamCheckpointCheck));
+    }
+    taosArrayPush(pTask->checkpointChecks, &check);
+  }
+  taosWUnLockLatch(&pTask->checkpointLock);
+
+  if (written) {
+    SRpcMsg rsp = {.code = code, .info = pMsg->info};
+    tmsgSendRsp(&rsp);
+    return 0;
+  }
+
+  qDebug("task %d hold checkpoint %" PRId64 " check until the barrier is executed", pTask->taskId,
+         pReq->checkpointId);
+  SStreamCheckpointCheckTmrParam* pParam = taosMemoryMalloc(sizeof(SStreamCheckpointCheckTmrParam));
+  if (pParam != NULL) {
+    pParam->pTask = pTask;
+    pParam->checkpointId = pReq->checkpointId;
+    atomic_add_fetch_32(&pTask->refCnt, 1);
+    if (taosTmrStart(streamCheckpointCheckTimeout, STREAM_CHECKPOINT_CHECK_TIMEOUT, pParam, streamEnv.timer) != NULL) {
+      return 0;
+    }
+    streamMetaReleaseTask(NULL, pTask);
+    taosMemoryFree(pParam);
+  }
+
+  // not held without the timeout, mnode would wait forever if the barrier never arrives
+  taosWLockLatch(&pTask->checkpointLock);
+  SArray* pChecks = streamTakeCheckpointChecks(pTask, pReq->checkpointId);
+  taosWUnLockLatch(&pTask->checkpointLock);
+  streamAnswerCheckpointChecks(pTask, pChecks, TSDB_CODE_OUT_OF_MEMORY);
   return 0;
 }
+
+int32_t streamProcessCheckpointReportReq(SStreamMeta* pMeta, SStreamTask* pTask, SStreamCheckpointReportReq* pReq,
+                                         int64_t* ver) {
+  qDebug("task %d checkpoint %" PRId64 " completed by all tasks", pTask->taskId, pReq->checkpointId);
+
+  if (pTask->pState == NULL) {
+    *ver = -1;
+    return 0;
+  }
+  return streamStateCompleteCheckpoint(pTask->pState, pReq->checkpointId, ver);
+}
@@ -506,6 +506,17 @@ int32_t streamDispatch(SStreamTask* pTask) {
     atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
     return 0;
   }
+
+  if (pBlock->type == STREAM_INPUT__CHECKPOINT) {
+    if (streamDispatchCheckpoint(pTask, (SStreamCheckpoint*)pBlock) < 0) {
+      // kept at the head of the output queue to be dispatched again
+      streamQueueProcessFail(pTask->outputQueue);
+      atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+      return -1;
+    }
+    taosFreeQitem(pBlock);
+    return 0;
+  }
   ASSERT(pBlock->type == STREAM_INPUT__DATA_BLOCK);
 
   qDebug("stream dispatching: task %d", pTask->taskId);
@@ -234,6 +234,11 @@ int32_t streamExecForAll(SStreamTask* pTask) {
       break;
     }
 
+    if (((SStreamQueueItem*)input)->type == STREAM_INPUT__CHECKPOINT) {
+      streamDoCheckpoint(pTask, input);
+      continue;
+    }
+
     if (pTask->taskLevel == TASK_LEVEL__SINK) {
       ASSERT(((SStreamQueueItem*)input)->type == STREAM_INPUT__DATA_BLOCK);
       streamTaskOutput(pTask, input);
@@ -132,6 +132,7 @@ FAIL:
 #if 1
 int32_t streamMetaAddTask(SStreamMeta* pMeta, int64_t ver, SStreamTask* pTask) {
   void* buf = NULL;
+  pTask->pMeta = pMeta;
   if (pMeta->expandFunc(pMeta->ahandle, pTask, ver) < 0) {
     return -1;
   }
@@ -282,6 +283,7 @@ int32_t streamLoadTasks(SStreamMeta* pMeta) {
     tDecodeSStreamTask(&decoder, pTask);
     tDecoderClear(&decoder);
 
+    pTask->pMeta = pMeta;
     if (pMeta->expandFunc(pMeta->ahandle, pTask, -1) < 0) {
       tdbFree(pKey);
       tdbFree(pVal);
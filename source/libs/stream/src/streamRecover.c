@@ -20,6 +20,10 @@ int32_t streamTaskLaunchRecover(SStreamTask* pTask, int64_t version) {
   if (pTask->taskLevel == TASK_LEVEL__SOURCE) {
     atomic_store_8(&pTask->taskStatus, TASK_STATUS__RECOVER_PREPARE);
     streamSetParamForRecover(pTask);
+    // state restored from a checkpoint already covers the wal up to checkpointVer
+    if (pTask->checkpointId > 0) {
+      version = pTask->checkpointVer;
+    }
     streamSourceRecoverPrepareStep1(pTask, version);
 
     SStreamRecoverStep1Req req;
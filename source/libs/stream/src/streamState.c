@@ -17,6 +17,7 @@
 #include "streamInc.h"
 #include "tcommon.h"
 #include "tcompare.h"
+#include "tglobal.h"
 #include "ttimer.h"
 
 // todo refactor
@@ -106,6 +107,254 @@ static inline int stateKeyCmpr(const void* pKey1, int kLen1, const void* pKey2,
   return 0;
 }
 
+/*
+ * write-back cache of state.db
+ *
+ * Interval windows are read and rewritten on every update, so they are kept in memory and written to tdb only when
+ * the state is committed, a cursor is opened on state.db, or the cache is over its budget. The budget is shared by
+ * all tasks of a vnode or snode. Once it is used up, only the tasks caching more than an even share evict, and the
+ * oldest windows, which are the most likely to be closed, are evicted first.
+ */
+typedef struct SStateCacheEntry {
+  SStateKey key;
+  int32_t   vLen;
+  bool      dirty;  // changed since last written to tdb
+  char      val[];
+} SStateCacheEntry;
+
+struct SStreamStateCache {
+  SHashObj* pEntries;  // SStateKey -> SStateCacheEntry*
+  int32_t   nDirty;
+  int64_t   size;
+  int64_t*  pTotalSize;    // bytes cached by all tasks sharing the budget
+  int32_t*  pNumOfCaches;  // number of tasks sharing the budget
+  int64_t   totalSize;     // used as pTotalSize if the state is not owned by a task
+  int32_t   numOfCaches;   // used as pNumOfCaches if the state is not owned by a task
+};
+
+#define STATE_CACHE_ENTRY_SIZE(vLen) (sizeof(SStateKey) + sizeof(SStateCacheEntry) + (vLen))
+
+static int stateCacheEntryKeyCmpr(const void* p1, const void* p2) {
+  const SStateCacheEntry* pEntry1 = *(const SStateCacheEntry**)p1;
+  const SStateCacheEntry* pEntry2 = *(const SStateCacheEntry**)p2;
+  return stateKeyCmpr(&pEntry1->key, sizeof(SStateKey), &pEntry2->key, sizeof(SStateKey));
+}
+
+static int stateCacheEntryTsCmpr(const void* p1, const void* p2) {
+  const SStateCacheEntry* pEntry1 = *(const SStateCacheEntry**)p1;
+  const SStateCacheEntry* pEntry2 = *(const SStateCacheEntry**)p2;
+  if (pEntry1->key.key.ts != pEntry2->key.key.ts) {
+    return pEntry1->key.key.ts < pEntry2->key.key.ts ? -1 : 1;
+  }
+  return stateCacheEntryKeyCmpr(p1, p2);
+}
+
+static SStreamStateCache* streamStateCacheOpen(SStreamTask* pTask) {
+  if (tsStreamStateCacheSize <= 0) {
+    return NULL;
+  }
+
+  SStreamStateCache* pCache = taosMemoryCalloc(1, sizeof(SStreamStateCache));
+  if (pCache == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pCache->pEntries = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (pCache->pEntries == NULL) {
+    taosMemoryFree(pCache);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  if (pTask != NULL && pTask->pMeta != NULL) {
+    pCache->pTotalSize = &pTask->pMeta->stateCacheSize;
+    pCache->pNumOfCaches = &pTask->pMeta->numOfStateCaches;
+  } else {
+    pCache->pTotalSize = &pCache->totalSize;
+    pCache->pNumOfCaches = &pCache->numOfCaches;
+  }
+  atomic_add_fetch_32(pCache->pNumOfCaches, 1);
+
+  return pCache;
+}
+
+static void streamStateCacheClear(SStreamStateCache* pCache) {
+  void* pIter = NULL;
+  while ((pIter = taosHashIterate(pCache->pEntries, pIter)) != NULL) {
+    taosMemoryFree(*(SStateCacheEntry**)pIter);
+  }
+  taosHashClear(pCache->pEntries);
+
+  atomic_sub_fetch_64(pCache->pTotalSize, pCache->size);
+  pCache->size = 0;
+  pCache->nDirty = 0;
+}
+
+static void streamStateCacheClose(SStreamStateCache* pCache) {
+  if (pCache == NULL) {
+    return;
+  }
+
+  streamStateCacheClear(pCache);
+  atomic_sub_fetch_32(pCache->pNumOfCaches, 1);
+  taosHashCleanup(pCache->pEntries);
+  taosMemoryFree(pCache);
+}
+
+static SStateCacheEntry* streamStateCacheGet(SStreamStateCache* pCache, const SStateKey* pKey) {
+  SStateCacheEntry** ppEntry = taosHashGet(pCache->pEntries, pKey, sizeof(SStateKey));
+  return ppEntry ? *ppEntry : NULL;
+}
+
+static void streamStateCacheRemove(SStreamStateCache* pCache, SStateCacheEntry* pEntry) {
+  int64_t size = STATE_CACHE_ENTRY_SIZE(pEntry->vLen);
+
+  taosHashRemove(pCache->pEntries, &pEntry->key, sizeof(SStateKey));
+  if (pEntry->dirty) {
+    pCache->nDirty--;
+  }
+  pCache->size -= size;
+  atomic_sub_fetch_64(pCache->pTotalSize, size);
+  taosMemoryFree(pEntry);
+}
+
+static int32_t streamStateCachePut(SStreamStateCache* pCache, const SStateKey* pKey, const void* value, int32_t vLen,
+                                   bool dirty) {
+  SStateCacheEntry* pOld = streamStateCacheGet(pCache, pKey);
+  SStateCacheEntry* pEntry = pOld;
+
+  if (pOld == NULL || pOld->vLen != vLen) {
+    pEntry = taosMemoryMalloc(sizeof(SStateCacheEntry) + vLen);
+    if (pEntry == NULL) {
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
+      return -1;
+    }
+    pEntry->key = *pKey;
+    pEntry->vLen = vLen;
+    pEntry->dirty = false;
+
+    if (taosHashPut(pCache->pEntries, pKey, sizeof(SStateKey), &pEntry, POINTER_BYTES) < 0) {
+      taosMemoryFree(pEntry);
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    int64_t size = STATE_CACHE_ENTRY_SIZE(vLen);
+    if (pOld != NULL) {
+      size -= STATE_CACHE_ENTRY_SIZE(pOld->vLen);
+      pEntry->dirty = pOld->dirty;
+      taosMemoryFree(pOld);
+    }
+    pCache->size += size;
+    atomic_add_fetch_64(pCache->pTotalSize, size);
+  }
+
+  if (vLen > 0) {
+    memcpy(pEntry->val, value, vLen);
+  }
+  if (dirty && !pEntry->dirty) {
+    pCache->nDirty++;
+  }
+  pEntry->dirty = pEntry->dirty || dirty;
+
+  return 0;
+}
+
+// write entries in key order so that each page of the b-tree is visited once
+static int32_t streamStateCacheWrite(SStreamState* pState, SArray* pEntries) {
+  SStreamStateCache* pCache = pState->pTdbState->pCache;
+
+  taosArraySort(pEntries, stateCacheEntryKeyCmpr);
+  for (int32_t i = 0; i < taosArrayGetSize(pEntries); i++) {
+    SStateCacheEntry* pEntry = taosArrayGetP(pEntries, i);
+    if (!pEntry->dirty) {
+      continue;
+    }
+    if (tdbTbUpsert(pState->pTdbState->pStateDb, &pEntry->key, sizeof(SStateKey), pEntry->val, pEntry->vLen,
+                    pState->pTdbState->txn) < 0) {
+      return -1;
+    }
+    pEntry->dirty = false;
+    pCache->nDirty--;
+  }
+
+  return 0;
+}
+
+static int32_t streamStateCacheFlush(SStreamState* pState) {
+  SStreamStateCache* pCache = pState->pTdbState->pCache;
+  if (pCache == NULL || pCache->nDirty == 0) {
+    return 0;
+  }
+
+  SArray* pEntries = taosArrayInit(pCache->nDirty, POINTER_BYTES);
+  if (pEntries == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  void* pIter = NULL;
+  while ((pIter = taosHashIterate(pCache->pEntries, pIter)) != NULL) {
+    SStateCacheEntry* pEntry = *(SStateCacheEntry**)pIter;
+    if (pEntry->dirty) {
+      taosArrayPush(pEntries, &pEntry);
+    }
+  }
+
+  int32_t code = streamStateCacheWrite(pState, pEntries);
+  taosArrayDestroy(pEntries);
+  return code;
+}
+
+// evict the oldest windows of a task over its share until it is back to 3/4 of the share, a task within its share
+// keeps its windows even if the budget is used up by others, which evict on their own updates
+static void streamStateCacheEvict(SStreamState* pState) {
+  SStreamStateCache* pCache = pState->pTdbState->pCache;
+  int64_t            budget = (int64_t)tsStreamStateCacheSize * 1024 * 1024;
+  if (atomic_load_64(pCache->pTotalSize) <= budget) {
+    return;
+  }
+
+  int64_t share = budget / TMAX(atomic_load_32(pCache->pNumOfCaches), 1);
+  int64_t size = pCache->size;
+  if (size <= share) {
+    return;
+  }
+
+  SArray* pEntries = taosArrayInit(taosHashGetSize(pCache->pEntries), POINTER_BYTES);
+  if (pEntries == NULL) {
+    return;
+  }
+
+  void* pIter = NULL;
+  while ((pIter = taosHashIterate(pCache->pEntries, pIter)) != NULL) {
+    taosArrayPush(pEntries, pIter);
+  }
+  taosArraySort(pEntries, stateCacheEntryTsCmpr);
+
+  int32_t nEvict = 0;
+  int32_t nEntries = taosArrayGetSize(pEntries);
+  while (nEvict < nEntries && size > share / 4 * 3) {
+    SStateCacheEntry* pEntry = taosArrayGetP(pEntries, nEvict++);
+    size -= STATE_CACHE_ENTRY_SIZE(pEntry->vLen);
+  }
+  taosArrayPopTailBatch(pEntries, nEntries - nEvict);
+
+  // entries failed to be written stay in the cache
+  if (streamStateCacheWrite(pState, pEntries) < 0) {
+    qError("failed to write evicted stream window state since %s", terrstr());
+  }
+  for (int32_t i = 0; i < taosArrayGetSize(pEntries); i++) {
+    SStateCacheEntry* pEntry = taosArrayGetP(pEntries, i);
+    if (!pEntry->dirty) {
+      streamStateCacheRemove(pCache, pEntry);
+    }
+  }
+
+  taosArrayDestroy(pEntries);
+}
+
 SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int32_t szPage, int32_t pages) {
   szPage = szPage < 0 ? 4096 : szPage;
   pages = pages < 0 ? 256 : pages;
@@ -128,10 +377,24 @@ SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int
     memset(statePath, 0, 1024);
     tstrncpy(statePath, path, 1024);
   }
+  if (!specPath) {
+    // restore the state of the last checkpoint completed by all tasks of the stream before it is opened
+    pState->pTdbState->pCheckpoint =
+        streamCheckpointStoreOpen(statePath, &pTask->checkpointId, &pTask->checkpointVer);
+    if (pState->pTdbState->pCheckpoint == NULL) {
+      goto _err;
+    }
+  }
+
   if (tdbOpen(statePath, szPage, pages, &pState->pTdbState->db, 0) < 0) {
     goto _err;
   }
 
+  if (pState->pTdbState->pCheckpoint && pTask->checkpointId > 0) {
+    // the state file is the base of the checkpoint, later checkpoints only take the pages changed from now on
+    tdbClearChangedPages(pState->pTdbState->db);
+  }
+
   // open state storage backend
   if (tdbTbOpen("state.db", sizeof(SStateKey), -1, stateKeyCmpr, pState->pTdbState->db, &pState->pTdbState->pStateDb,
                 0) < 0) {
@@ -163,6 +426,13 @@ SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int
     goto _err;
   }
 
+  if (tsStreamStateCacheSize > 0) {
+    pState->pTdbState->pCache = streamStateCacheOpen(pTask);
+    if (pState->pTdbState->pCache == NULL) {
+      goto _err;
+    }
+  }
+
   pState->pTdbState->pOwner = pTask;
 
   return pState;
@@ -179,6 +449,7 @@ _err:
 }
 
 void streamStateClose(SStreamState* pState) {
+  streamStateCacheFlush(pState);
   tdbCommit(pState->pTdbState->db, pState->pTdbState->txn);
   tdbPostCommit(pState->pTdbState->db, pState->pTdbState->txn);
   tdbTbClose(pState->pTdbState->pStateDb);
@@ -201,6 +472,9 @@ int32_t streamStateBegin(SStreamState* pState) {
 }
 
 int32_t streamStateCommit(SStreamState* pState) {
+  if (streamStateCacheFlush(pState) < 0) {
+    return -1;
+  }
   if (tdbCommit(pState->pTdbState->db, pState->pTdbState->txn) < 0) {
     return -1;
   }
@@ -215,7 +489,30 @@ int32_t streamStateCommit(SStreamState* pState) {
   return 0;
 }
 
+int32_t streamStateCheckpoint(SStreamState* pState, int64_t checkpointId, int64_t ver) {
+  if (streamStateCommit(pState) < 0) {
+    return -1;
+  }
+  if (pState->pTdbState->pCheckpoint == NULL) {
+    return 0;
+  }
+  return streamCheckpointStoreSave(pState->pTdbState->pCheckpoint, pState->pTdbState->db, checkpointId, ver);
+}
+
+int32_t streamStateCompleteCheckpoint(SStreamState* pState, int64_t checkpointId, int64_t* ver) {
+  if (pState->pTdbState->pCheckpoint == NULL) {
+    terrno = TSDB_CODE_NOT_FOUND;
+    return -1;
+  }
+  return streamCheckpointStoreConfirm(pState->pTdbState->pCheckpoint, checkpointId, ver);
+}
+
 int32_t streamStateAbort(SStreamState* pState) {
+  // the cache may hold changes that are written to tdb and rolled back
+  if (pState->pTdbState->pCache) {
+    streamStateCacheClear(pState->pTdbState->pCache);
+  }
+
   if (tdbAbort(pState->pTdbState->db, pState->pTdbState->txn) < 0) {
     return -1;
   }
@@ -240,8 +537,14 @@ int32_t streamStateFuncDel(SStreamState* pState, const STupleKey* key) {
 
 // todo refactor
 int32_t streamStatePut(SStreamState* pState, const SWinKey* key, const void* value, int32_t vLen) {
-  SStateKey sKey = {.key = *key, .opNum = pState->number};
-  return tdbTbUpsert(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), value, vLen, pState->pTdbState->txn);
+  SStateKey          sKey = {.key = *key, .opNum = pState->number};
+  SStreamStateCache* pCache = pState->pTdbState->pCache;
+  if (pCache == NULL || streamStateCachePut(pCache, &sKey, value, vLen, true) < 0) {
+    return tdbTbUpsert(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), value, vLen, pState->pTdbState->txn);
+  }
+
+  streamStateCacheEvict(pState);
+  return 0;
 }
 
 // todo refactor
@@ -251,8 +554,41 @@ int32_t streamStateFillPut(SStreamState* pState, const SWinKey* key, const void*
 
 // todo refactor
 int32_t streamStateGet(SStreamState* pState, const SWinKey* key, void** pVal, int32_t* pVLen) {
-  SStateKey sKey = {.key = *key, .opNum = pState->number};
-  return tdbTbGet(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pVal, pVLen);
+  SStateKey          sKey = {.key = *key, .opNum = pState->number};
+  SStreamStateCache* pCache = pState->pTdbState->pCache;
+  if (pCache == NULL) {
+    return tdbTbGet(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pVal, pVLen);
+  }
+
+  SStateCacheEntry* pEntry = streamStateCacheGet(pCache, &sKey);
+  if (pEntry != NULL) {
+    if (pVal) {
+      void* p = tdbRealloc(*pVal, pEntry->vLen);
+      if (p == NULL) {
+        return -1;
+      }
+      memcpy(p, pEntry->val, pEntry->vLen);
+      *pVal = p;
+      *pVLen = pEntry->vLen;
+    }
+    return 0;
+  }
+
+  void*   pTmp = NULL;
+  void**  ppVal = pVal ? pVal : &pTmp;
+  int32_t len = 0;
+  if (tdbTbGet(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), ppVal, &len) < 0) {
+    return -1;
+  }
+  if (pVLen) {
+    *pVLen = len;
+  }
+
+  if (streamStateCachePut(pCache, &sKey, *ppVal, len, false) == 0) {
+    streamStateCacheEvict(pState);
+  }
+  tdbFree(pTmp);
+  return 0;
 }
 
 // todo refactor
@@ -262,7 +598,15 @@ int32_t streamStateFillGet(SStreamState* pState, const SWinKey* key, void** pVal
 
 // todo refactor
 int32_t streamStateDel(SStreamState* pState, const SWinKey* key) {
-  SStateKey sKey = {.key = *key, .opNum = pState->number};
+  SStateKey          sKey = {.key = *key, .opNum = pState->number};
+  SStreamStateCache* pCache = pState->pTdbState->pCache;
+  SStateCacheEntry*  pEntry = pCache ? streamStateCacheGet(pCache, &sKey) : NULL;
+  if (pEntry != NULL) {
+    // the window may have been written to tdb before
+    streamStateCacheRemove(pCache, pEntry);
+    tdbTbDelete(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pState->pTdbState->txn);
+    return 0;
+  }
   return tdbTbDelete(pState->pTdbState->pStateDb, &sKey, sizeof(SStateKey), pState->pTdbState->txn);
 }
 
@@ -311,6 +655,10 @@ int32_t streamStateReleaseBuf(SStreamState* pState, const SWinKey* key, void* pV
 }
 
 SStreamStateCur* streamStateGetCur(SStreamState* pState, const SWinKey* key) {
+  if (streamStateCacheFlush(pState) < 0) {
+    return NULL;
+  }
+
   SStreamStateCur* pCur = taosMemoryCalloc(1, sizeof(SStreamStateCur));
   if (pCur == NULL) return NULL;
   tdbTbcOpen(pState->pTdbState->pStateDb, &pCur->pCur, NULL);
@@ -417,6 +765,10 @@ int32_t streamStateSeekLast(SStreamState* pState, SStreamStateCur* pCur) {
 }
 
 SStreamStateCur* streamStateSeekKeyNext(SStreamState* pState, const SWinKey* key) {
+  if (streamStateCacheFlush(pState) < 0) {
+    return NULL;
+  }
+
   SStreamStateCur* pCur = taosMemoryCalloc(1, sizeof(SStreamStateCur));
   if (pCur == NULL) {
     return NULL;
@@ -832,6 +1184,10 @@ int32_t streamStateGetParName(SStreamState* pState, int64_t groupId, void** pVal
 }
 
 void streamStateDestroy(SStreamState* pState) {
+  if (pState->pTdbState) {
+    streamStateCacheClose(pState->pTdbState->pCache);
+    streamCheckpointStoreClose(pState->pTdbState->pCheckpoint);
+  }
   taosMemoryFreeClear(pState->pTdbState);
   taosMemoryFreeClear(pState);
 }
@@ -180,6 +180,8 @@ void tFreeSStreamTask(SStreamTask* pTask) {
   }
 
   if (pTask->pState) streamStateClose(pTask->pState);
+  taosArrayDestroy(pTask->checkpointAligned);
+  taosArrayDestroy(pTask->checkpointChecks);
 
   taosMemoryFree(pTask);
 }
@@ -21,8 +21,8 @@
 
 #define DEFAULT_FALSE_POSITIVE   0.01
 #define DEFAULT_BUCKET_SIZE      1310720
-#define DEFAULT_MAP_CAPACITY     1310720
-#define DEFAULT_MAP_SIZE         (DEFAULT_MAP_CAPACITY * 10)
+#define DEFAULT_MAP_CAPACITY     1024
+#define DEFAULT_MAP_SIZE         (DEFAULT_BUCKET_SIZE * 10)
 #define ROWS_PER_MILLISECOND     1
 #define MAX_NUM_SCALABLE_BF      100000
 #define MIN_NUM_SCALABLE_BF      10
@@ -116,16 +116,8 @@ SUpdateInfo *updateInfoInit(int64_t interval, int32_t precision, int64_t waterma
   pInfo->numSBFs = bfSize;
   windowSBfAdd(pInfo, bfSize);
 
-  pInfo->pTsBuckets = taosArrayInit(DEFAULT_BUCKET_SIZE, sizeof(TSKEY));
-  if (pInfo->pTsBuckets == NULL) {
-    updateInfoDestroy(pInfo);
-    return NULL;
-  }
-
-  TSKEY dumy = 0;
-  for (uint64_t i = 0; i < DEFAULT_BUCKET_SIZE; ++i) {
-    taosArrayPush(pInfo->pTsBuckets, &dumy);
-  }
+  // the buckets are only used once the map is full, allocated on demand
+  pInfo->pTsBuckets = NULL;
   pInfo->numBuckets = DEFAULT_BUCKET_SIZE;
   pInfo->pCloseWinSBF = NULL;
   _hash_fn_t hashFn = taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT);
@@ -162,6 +154,29 @@ static SScalableBf *getSBf(SUpdateInfo *pInfo, TSKEY ts) {
   return res;
 }
 
+static TSKEY getBucketMaxTs(SUpdateInfo *pInfo, uint64_t tableId) {
+  if (taosArrayGetSize(pInfo->pTsBuckets) == 0) {
+    return 0;
+  }
+  return *(TSKEY *)taosArrayGet(pInfo->pTsBuckets, tableId % pInfo->numBuckets);
+}
+
+static void setBucketMaxTs(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
+  if (taosArrayGetSize(pInfo->pTsBuckets) == 0) {
+    if (pInfo->pTsBuckets == NULL) {
+      pInfo->pTsBuckets = taosArrayInit(pInfo->numBuckets, sizeof(TSKEY));
+      if (pInfo->pTsBuckets == NULL) {
+        return;
+      }
+    }
+    TSKEY dumy = 0;
+    for (uint64_t i = 0; i < pInfo->numBuckets; ++i) {
+      taosArrayPush(pInfo->pTsBuckets, &dumy);
+    }
+  }
+  taosArraySet(pInfo->pTsBuckets, tableId % pInfo->numBuckets, &ts);
+}
+
 bool updateInfoIsTableInserted(SUpdateInfo *pInfo, int64_t tbUid) {
   void *pVal = taosHashGet(pInfo->pMap, &tbUid, sizeof(int64_t));
   if (pVal || taosHashGetSize(pInfo->pMap) >= DEFAULT_MAP_SIZE) return true;
@@ -175,20 +190,33 @@ TSKEY updateInfoFillBlockData(SUpdateInfo *pInfo, SSDataBlock *pBlock, int32_t p
 
   SColumnInfoData *pColDataInfo = taosArrayGet(pBlock->pDataBlock, primaryTsCol);
 
+  // rows of a block are mostly in order, so the filter of the previous row is reused while ts stays in its slot
+  SScalableBf *pSBf = NULL;
+  TSKEY        slotStart = INT64_MAX;
+  TSKEY        slotEnd = INT64_MIN;
   for (int32_t i = 0; i < pBlock->info.rows; i++) {
     TSKEY ts = ((TSKEY *)pColDataInfo->pData)[i];
     maxTs = TMAX(maxTs, ts);
-    SScalableBf *pSBf = getSBf(pInfo, ts);
+    if (ts < slotStart || ts >= slotEnd) {
+      pSBf = getSBf(pInfo, ts);
+      if (pSBf) {
+        slotStart = pInfo->minTS + (ts - pInfo->minTS) / pInfo->interval * pInfo->interval;
+        slotEnd = slotStart + pInfo->interval;
+      } else {
+        slotStart = INT64_MAX;
+        slotEnd = INT64_MIN;
+      }
+    }
     if (pSBf) {
       SUpdateKey updateKey = {
           .tbUid = tbUid,
           .ts = ts,
       };
-      tScalableBfPut(pSBf, &updateKey, sizeof(SUpdateKey));
+      tScalableBfPutNoCheck(pSBf, &updateKey, sizeof(SUpdateKey));
     }
   }
   TSKEY *pMaxTs = taosHashGet(pInfo->pMap, &tbUid, sizeof(int64_t));
-  if (pMaxTs == NULL || *pMaxTs > maxTs) {
+  if (pMaxTs == NULL || *pMaxTs < maxTs) {
     taosHashPut(pInfo->pMap, &tbUid, sizeof(int64_t), &maxTs, sizeof(TSKEY));
   }
   return maxTs;
@@ -202,9 +230,20 @@ bool updateInfoIsUpdated(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
       .ts = ts,
   };
 
-  TSKEY   *pMapMaxTs = taosHashGet(pInfo->pMap, &tableId, sizeof(uint64_t));
-  uint64_t index = ((uint64_t)tableId) % pInfo->numBuckets;
-  TSKEY    maxTs = *(TSKEY *)taosArrayGet(pInfo->pTsBuckets, index);
+  TSKEY *pMapMaxTs = taosHashGet(pInfo->pMap, &tableId, sizeof(uint64_t));
+  if (pMapMaxTs && *pMapMaxTs < ts) {
+    // in order for its table, the row can not have been seen before
+    SScalableBf *pSBf = getSBf(pInfo, ts);
+    if (pSBf) {
+      tScalableBfPutNoCheck(pSBf, &updateKey, sizeof(SUpdateKey));
+    }
+    *pMapMaxTs = ts;
+    pInfo->numInOrder++;
+    return false;
+  }
+  pInfo->numProbed++;
+
+  TSKEY maxTs = getBucketMaxTs(pInfo, tableId);
   if (ts < maxTs - pInfo->watermark) {
     // this window has been closed.
     if (pInfo->pCloseWinSBF) {
@@ -212,9 +251,11 @@ bool updateInfoIsUpdated(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
       if (res == TSDB_CODE_SUCCESS) {
         return false;
       } else {
+        pInfo->numBfHit++;
         return true;
       }
     }
+    pInfo->numNoFilter++;
     return true;
   }
 
@@ -225,22 +266,28 @@ bool updateInfoIsUpdated(SUpdateInfo *pInfo, uint64_t tableId, TSKEY ts) {
   }
 
   int32_t size = taosHashGetSize(pInfo->pMap);
-  if ((!pMapMaxTs && size < DEFAULT_MAP_SIZE) || (pMapMaxTs && *pMapMaxTs < ts)) {
+  if (!pMapMaxTs && size < DEFAULT_MAP_SIZE) {
     taosHashPut(pInfo->pMap, &tableId, sizeof(uint64_t), &ts, sizeof(TSKEY));
     return false;
   }
 
   if (!pMapMaxTs && maxTs < ts) {
-    taosArraySet(pInfo->pTsBuckets, index, &ts);
+    setBucketMaxTs(pInfo, tableId, ts);
     return false;
   }
 
   if (ts < pInfo->minTS) {
+    pInfo->numNoFilter++;
     return true;
   } else if (res == TSDB_CODE_SUCCESS) {
     return false;
   }
   // check from tsdb api
+  if (pSBf) {
+    pInfo->numBfHit++;
+  } else {
+    pInfo->numNoFilter++;
+  }
   return true;
 }
 
@@ -271,6 +318,9 @@ void updateInfoDestroy(SUpdateInfo *pInfo) {
   if (pInfo == NULL) {
     return;
   }
+  qDebug("===stream===update info, in order rows:%" PRId64 ", probed rows:%" PRId64 ", filter hits:%" PRId64
+         ", unfiltered updates:%" PRId64,
+         pInfo->numInOrder, pInfo->numProbed, pInfo->numBfHit, pInfo->numNoFilter);
   taosArrayDestroy(pInfo->pTsBuckets);
 
   uint64_t size = taosArrayGetSize(pInfo->pTsSBFs);
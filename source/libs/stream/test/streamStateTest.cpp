@@ -0,0 +1,462 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "streamInc.h"
+#include "tchecksum.h"
+#include "tglobal.h"
+
+namespace {
+
+const int32_t valLen = 1000;
+
+// the key of state.db, to check whether a window is written to tdb or only cached
+typedef struct {
+  SWinKey key;
+  int64_t opNum;
+} STestStateKey;
+
+int32_t putWin(SStreamState *pState, int64_t ts, char c) {
+  SWinKey     key = {.groupId = 1, .ts = ts};
+  std::string val(valLen, c);
+  return streamStatePut(pState, &key, val.data(), valLen);
+}
+
+// returns the char the value of the window is filled with, or 0 if not found
+char getWin(SStreamState *pState, int64_t ts) {
+  SWinKey key = {.groupId = 1, .ts = ts};
+  void   *pVal = NULL;
+  int32_t len = 0;
+  if (streamStateGet(pState, &key, &pVal, &len) < 0) {
+    return 0;
+  }
+  char c = (len == valLen) ? ((char *)pVal)[valLen - 1] : 0;
+  streamFreeVal(pVal);
+  return c;
+}
+
+bool inTdb(SStreamState *pState, int64_t ts) {
+  STestStateKey key = {.key = {.groupId = 1, .ts = ts}, .opNum = pState->number};
+  void         *pVal = NULL;
+  int32_t       len = 0;
+  if (tdbTbGet(pState->pTdbState->pStateDb, &key, sizeof(key), &pVal, &len) < 0) {
+    return false;
+  }
+  tdbFree(pVal);
+  return true;
+}
+
+SStreamState *openState(const char *name, SStreamTask *pTask) {
+  char path[PATH_MAX] = {0};
+  snprintf(path, sizeof(path), "%s%s", TD_TMP_DIR_PATH, name);
+  taosRemoveDir(path);
+  taosMulMkDir(path);
+  return streamStateOpen(path, pTask, true, -1, -1);
+}
+
+// CURRENT of the checkpoint store, to set up the store as left by a crash
+typedef struct {
+  int64_t checkpointId;
+  int64_t ver;
+  int64_t applySeq;
+  TSCKSUM cksum;
+} STestCheckpointCurrent;
+
+const int32_t numOfCheckpointWins = 2000;
+
+std::string checkpointPath(const char *name, SStreamTask *pTask, const char *file) {
+  char path[PATH_MAX] = {0};
+  snprintf(path, sizeof(path), "%s%s%s%d%scheckpoint%s%s", TD_TMP_DIR_PATH, name, TD_DIRSEP, pTask->taskId, TD_DIRSEP,
+           TD_DIRSEP, file);
+  return path;
+}
+
+int64_t fileSize(const std::string &path) {
+  int64_t size = -1;
+  if (taosStatFile(path.c_str(), &size, NULL) < 0) return -1;
+  return size;
+}
+
+void removeState(const char *name) {
+  char path[PATH_MAX] = {0};
+  snprintf(path, sizeof(path), "%s%s", TD_TMP_DIR_PATH, name);
+  taosRemoveDir(path);
+}
+
+SStreamState *reopenState(const char *name, SStreamTask *pTask) {
+  char path[PATH_MAX] = {0};
+  snprintf(path, sizeof(path), "%s%s", TD_TMP_DIR_PATH, name);
+  return streamStateOpen(path, pTask, false, -1, -1);
+}
+
+// all windows are filled with c, except those before numOfChanged filled with changed
+void checkWins(SStreamState *pState, char c, int32_t numOfChanged, char changed) {
+  for (int64_t ts = 0; ts < numOfCheckpointWins; ++ts) {
+    ASSERT_EQ(getWin(pState, ts), ts < numOfChanged ? changed : c) << "ts:" << ts;
+  }
+}
+
+// the barrier of the checkpoint as executed by the task
+int32_t executeBarrier(SStreamTask *pTask, int64_t checkpointId, int64_t ver) {
+  SStreamCheckpoint *pCheckpoint = (SStreamCheckpoint *)taosAllocateQitem(sizeof(SStreamCheckpoint), DEF_QITEM, 0);
+  pCheckpoint->type = STREAM_INPUT__CHECKPOINT;
+  pCheckpoint->checkpointId = checkpointId;
+  pCheckpoint->sourceVer = ver;
+  return streamDoCheckpoint(pTask, pCheckpoint);
+}
+
+// returns the number of checks held by the task after mnode checks the checkpoint
+int32_t checkCheckpoint(SStreamTask *pTask, int64_t checkpointId) {
+  SStreamCheckpointReportReq req = {.checkpointId = checkpointId, .taskId = pTask->taskId};
+  SRpcMsg                    msg = {0};
+  msg.info.noResp = 1;
+  streamProcessCheckpointCheckReq(pTask->pMeta, pTask, &req, &msg);
+  return taosArrayGetSize(pTask->checkpointChecks);
+}
+
+int32_t completeCheckpoint(SStreamTask *pTask, int64_t checkpointId, int64_t *ver) {
+  SStreamCheckpointReportReq req = {.checkpointId = checkpointId, .taskId = pTask->taskId};
+  return streamProcessCheckpointReportReq(pTask->pMeta, pTask, &req, ver);
+}
+
+}  // namespace
+
+TEST(streamStateTest, cachePutGetDel) {
+  int32_t cacheSize = tsStreamStateCacheSize;
+  tsStreamStateCacheSize = 1;
+
+  SStreamState *pState = openState("streamStateTestCache", NULL);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_NE(pState->pTdbState->pCache, nullptr);
+
+  // windows are cached until the state is committed
+  for (int64_t ts = 0; ts < 10; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'a'), 0);
+  }
+  ASSERT_EQ(putWin(pState, 1, 'b'), 0);
+  SWinKey key = {.groupId = 1, .ts = 2};
+  ASSERT_EQ(streamStateDel(pState, &key), 0);
+  ASSERT_EQ(getWin(pState, 1), 'b');
+  ASSERT_EQ(getWin(pState, 2), 0);
+  ASSERT_EQ(getWin(pState, 3), 'a');
+  ASSERT_FALSE(inTdb(pState, 3));
+
+  ASSERT_EQ(streamStateCommit(pState), 0);
+  ASSERT_TRUE(inTdb(pState, 1));
+  ASSERT_FALSE(inTdb(pState, 2));
+  ASSERT_EQ(getWin(pState, 1), 'b');
+
+  // a window written to tdb is deleted from tdb as well
+  key.ts = 3;
+  ASSERT_EQ(streamStateDel(pState, &key), 0);
+  ASSERT_FALSE(inTdb(pState, 3));
+  ASSERT_EQ(getWin(pState, 3), 0);
+  ASSERT_EQ(streamStateCommit(pState), 0);
+
+  // the changes after the last commit are dropped by an abort, from both the cache and tdb
+  ASSERT_EQ(putWin(pState, 1, 'c'), 0);
+  ASSERT_EQ(putWin(pState, 20, 'c'), 0);
+  key.ts = 4;
+  ASSERT_EQ(streamStateDel(pState, &key), 0);
+  ASSERT_EQ(streamStateAbort(pState), 0);
+  ASSERT_EQ(getWin(pState, 1), 'b');
+  ASSERT_EQ(getWin(pState, 20), 0);
+  ASSERT_EQ(getWin(pState, 4), 'a');
+  ASSERT_EQ(getWin(pState, 3), 0);
+
+  // a cursor sees the cached windows
+  ASSERT_EQ(putWin(pState, 30, 'd'), 0);
+  ASSERT_EQ(putWin(pState, 5, 'd'), 0);
+  ASSERT_FALSE(inTdb(pState, 30));
+  key.ts = 0;
+  SStreamStateCur *pCur = streamStateSeekKeyNext(pState, &key);
+  ASSERT_NE(pCur, nullptr);
+  std::vector<int64_t> keys;
+  while (1) {
+    SWinKey     curKey = {0};
+    const void *pVal = NULL;
+    int32_t     len = 0;
+    if (streamStateGetKVByCur(pCur, &curKey, &pVal, &len) < 0) break;
+    ASSERT_EQ(len, valLen);
+    ASSERT_EQ(((const char *)pVal)[0], curKey.ts == 1 ? 'b' : (curKey.ts < 10 && curKey.ts != 5 ? 'a' : 'd'));
+    keys.push_back(curKey.ts);
+    streamStateCurNext(pState, pCur);
+  }
+  streamStateFreeCur(pCur);
+  ASSERT_EQ(keys, std::vector<int64_t>({1, 4, 5, 6, 7, 8, 9, 30}));
+  ASSERT_TRUE(inTdb(pState, 30));
+
+  // the windows flushed for the cursor are not committed yet
+  ASSERT_EQ(streamStateAbort(pState), 0);
+  ASSERT_EQ(getWin(pState, 30), 0);
+  ASSERT_EQ(getWin(pState, 5), 'a');
+
+  streamStateClose(pState);
+  tsStreamStateCacheSize = cacheSize;
+}
+
+TEST(streamStateTest, cacheEvictShare) {
+  int32_t cacheSize = tsStreamStateCacheSize;
+  tsStreamStateCacheSize = 1;
+  const int64_t budget = 1024 * 1024;
+
+  SStreamMeta meta;
+  SStreamTask task1, task2;
+  memset(&meta, 0, sizeof(meta));
+  memset(&task1, 0, sizeof(task1));
+  memset(&task2, 0, sizeof(task2));
+  task1.pMeta = &meta;
+  task2.pMeta = &meta;
+
+  SStreamState *pState1 = openState("streamStateTestShare1", &task1);
+  SStreamState *pState2 = openState("streamStateTestShare2", &task2);
+  ASSERT_NE(pState1, nullptr);
+  ASSERT_NE(pState2, nullptr);
+  ASSERT_EQ(meta.numOfStateCaches, 2);
+
+  // task 1 takes most of the budget
+  int32_t numOfWins1 = 0;
+  while (meta.stateCacheSize + 2 * valLen < budget) {
+    ASSERT_EQ(putWin(pState1, numOfWins1++, 'a'), 0);
+  }
+  ASSERT_FALSE(inTdb(pState1, 0));
+
+  // task 2 is within its share, so its windows stay cached though the budget is used up
+  for (int64_t ts = 0; ts < 100; ++ts) {
+    ASSERT_EQ(putWin(pState2, ts, 'b'), 0);
+  }
+  ASSERT_GT(meta.stateCacheSize, budget);
+  for (int64_t ts = 0; ts < 100; ++ts) {
+    ASSERT_EQ(getWin(pState2, ts), 'b');
+    ASSERT_FALSE(inTdb(pState2, ts));
+  }
+
+  // task 1 is over its share and evicts its oldest windows on its next update
+  ASSERT_EQ(putWin(pState1, numOfWins1++, 'a'), 0);
+  ASSERT_LE(meta.stateCacheSize, budget);
+  ASSERT_TRUE(inTdb(pState1, 0));
+  ASSERT_FALSE(inTdb(pState1, numOfWins1 - 1));
+  for (int64_t ts = 0; ts < 100; ++ts) {
+    ASSERT_FALSE(inTdb(pState2, ts));
+  }
+  for (int64_t ts = 0; ts < numOfWins1; ++ts) {
+    ASSERT_EQ(getWin(pState1, ts), 'a');
+  }
+
+  streamStateClose(pState1);
+  ASSERT_EQ(meta.numOfStateCaches, 1);
+  streamStateClose(pState2);
+  ASSERT_EQ(meta.numOfStateCaches, 0);
+  ASSERT_EQ(meta.stateCacheSize, 0);
+  tsStreamStateCacheSize = cacheSize;
+}
+
+TEST(streamStateTest, checkpointSaveComplete) {
+  const char  *name = "streamStateTestCheckpoint";
+  SStreamMeta  meta;
+  SStreamTask  task;
+  int64_t      ver = -1;
+  memset(&meta, 0, sizeof(meta));
+  memset(&task, 0, sizeof(task));
+  task.taskId = 1;
+  task.pMeta = &meta;
+
+  removeState(name);
+  SStreamState *pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 0);
+  for (int64_t ts = 0; ts < numOfCheckpointWins; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'a'), 0);
+  }
+  ASSERT_EQ(streamStateCheckpoint(pState, 101, 1000), 0);
+  ASSERT_EQ(streamStateCompleteCheckpoint(pState, 101, &ver), 0);
+  ASSERT_EQ(ver, 1000);
+
+  // only the pages changed since the checkpoint before are taken
+  for (int64_t ts = 0; ts < 10; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'b'), 0);
+  }
+  ASSERT_EQ(streamStateCheckpoint(pState, 102, 2000), 0);
+  ASSERT_EQ(streamStateCompleteCheckpoint(pState, 999, &ver), -1);
+  int64_t baseSize = fileSize(checkpointPath(name, &task, "base"));
+  int64_t deltaSize = fileSize(checkpointPath(name, &task, "delta.2"));
+  ASSERT_GT(baseSize, 0);
+  ASSERT_GT(deltaSize, 0);
+  ASSERT_LT(deltaSize, baseSize / 4);
+  ASSERT_EQ(streamStateCompleteCheckpoint(pState, 102, &ver), 0);
+  ASSERT_EQ(ver, 2000);
+  ASSERT_EQ(streamStateCompleteCheckpoint(pState, 102, &ver), 0);
+
+  // a checkpoint written but not completed is not rolled back to, nor are the changes after it
+  for (int64_t ts = 0; ts < 10; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'c'), 0);
+  }
+  ASSERT_EQ(streamStateCheckpoint(pState, 103, 3000), 0);
+  ASSERT_EQ(putWin(pState, 0, 'd'), 0);
+  ASSERT_EQ(streamStateCommit(pState), 0);
+  ASSERT_EQ(putWin(pState, 1, 'd'), 0);
+  streamStateClose(pState);
+
+  pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 102);
+  ASSERT_EQ(task.checkpointVer, 2000);
+  checkWins(pState, 'a', 10, 'b');
+  ASSERT_EQ(fileSize(checkpointPath(name, &task, "delta.3")), -1);
+
+  // later checkpoints are taken on the restored state
+  for (int64_t ts = 0; ts < 5; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'e'), 0);
+  }
+  ASSERT_EQ(streamStateCheckpoint(pState, 104, 4000), 0);
+  ASSERT_EQ(streamStateCompleteCheckpoint(pState, 104, &ver), 0);
+  ASSERT_EQ(putWin(pState, 0, 'f'), 0);
+  ASSERT_EQ(streamStateCommit(pState), 0);
+  streamStateClose(pState);
+
+  pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 104);
+  ASSERT_EQ(task.checkpointVer, 4000);
+  for (int64_t ts = 0; ts < 10; ++ts) {
+    ASSERT_EQ(getWin(pState, ts), ts < 5 ? 'e' : 'b');
+  }
+  streamStateClose(pState);
+}
+
+TEST(streamStateTest, checkpointCrashBeforeFold) {
+  const char  *name = "streamStateTestCheckpointCrash";
+  SStreamMeta  meta;
+  SStreamTask  task;
+  int64_t      ver = -1;
+  memset(&meta, 0, sizeof(meta));
+  memset(&task, 0, sizeof(task));
+  task.taskId = 2;
+  task.pMeta = &meta;
+
+  removeState(name);
+  SStreamState *pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  for (int64_t ts = 0; ts < numOfCheckpointWins; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'a'), 0);
+  }
+  ASSERT_EQ(streamStateCheckpoint(pState, 201, 1000), 0);
+  ASSERT_EQ(streamStateCompleteCheckpoint(pState, 201, &ver), 0);
+  for (int64_t ts = 0; ts < 10; ++ts) {
+    ASSERT_EQ(putWin(pState, ts, 'b'), 0);
+  }
+  ASSERT_EQ(streamStateCheckpoint(pState, 202, 2000), 0);
+  ASSERT_EQ(putWin(pState, 0, 'c'), 0);
+  ASSERT_EQ(streamStateCommit(pState), 0);
+  streamStateClose(pState);
+  ASSERT_GT(fileSize(checkpointPath(name, &task, "delta.2")), 0);
+
+  // crashed after the checkpoint is completed and before its delta is folded into the base
+  STestCheckpointCurrent current = {.checkpointId = 202, .ver = 2000, .applySeq = 2};
+  current.cksum = taosCalcChecksum(0, (const uint8_t *)&current, offsetof(STestCheckpointCurrent, cksum));
+  TdFilePtr pFile = taosOpenFile(checkpointPath(name, &task, "CURRENT").c_str(), TD_FILE_WRITE | TD_FILE_TRUNC);
+  ASSERT_NE(pFile, nullptr);
+  ASSERT_EQ(taosWriteFile(pFile, &current, sizeof(current)), sizeof(current));
+  taosCloseFile(&pFile);
+
+  pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 202);
+  ASSERT_EQ(task.checkpointVer, 2000);
+  checkWins(pState, 'a', 10, 'b');
+  ASSERT_EQ(fileSize(checkpointPath(name, &task, "delta.2")), -1);
+  streamStateClose(pState);
+
+  // folding is redone on the base folded already
+  pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 202);
+  checkWins(pState, 'a', 10, 'b');
+  streamStateClose(pState);
+
+  // a corrupted delta fails the open instead of restoring a wrong state
+  pState = reopenState(name, &task);
+  ASSERT_NE(pState, nullptr);
+  ASSERT_EQ(putWin(pState, 0, 'd'), 0);
+  ASSERT_EQ(streamStateCheckpoint(pState, 203, 3000), 0);
+  streamStateClose(pState);
+  pFile = taosOpenFile(checkpointPath(name, &task, "delta.1").c_str(), TD_FILE_WRITE);
+  ASSERT_NE(pFile, nullptr);
+  ASSERT_EQ(taosPWriteFile(pFile, "x", 1, 100), 1);
+  taosCloseFile(&pFile);
+  current = {.checkpointId = 203, .ver = 3000, .applySeq = 1};
+  current.cksum = taosCalcChecksum(0, (const uint8_t *)&current, offsetof(STestCheckpointCurrent, cksum));
+  pFile = taosOpenFile(checkpointPath(name, &task, "CURRENT").c_str(), TD_FILE_WRITE | TD_FILE_TRUNC);
+  ASSERT_NE(pFile, nullptr);
+  ASSERT_EQ(taosWriteFile(pFile, &current, sizeof(current)), sizeof(current));
+  taosCloseFile(&pFile);
+  ASSERT_EQ(reopenState(name, &task), nullptr);
+}
+
+TEST(streamStateTest, checkpointConfirmRestart) {
+  const char *name = "streamStateTestCheckpointRestart";
+  SStreamMeta meta;
+  int64_t     ver = -1;
+  memset(&meta, 0, sizeof(meta));
+
+  // the timeout of a held check refers to the task after the test
+  static SStreamTask task;
+  memset(&task, 0, sizeof(task));
+  task.taskId = 3;
+  task.pMeta = &meta;
+  task.refCnt = 1;
+  task.outputType = TASK_OUTPUT__TABLE;
+  ASSERT_EQ(streamInit(), 0);
+
+  removeState(name);
+  task.pState = reopenState(name, &task);
+  ASSERT_NE(task.pState, nullptr);
+  for (int64_t ts = 0; ts < numOfCheckpointWins; ++ts) {
+    ASSERT_EQ(putWin(task.pState, ts, 'a'), 0);
+  }
+
+  // a check arriving before the barrier is answered once the task executes it
+  ASSERT_EQ(checkCheckpoint(&task, 301), 1);
+  ASSERT_EQ(executeBarrier(&task, 301, 1000), 0);
+  ASSERT_EQ(taosArrayGetSize(task.checkpointChecks), 0);
+  ASSERT_EQ(task.checkpointWrittenId, 301);
+  ASSERT_EQ(task.checkpointWrittenCode, 0);
+  ASSERT_EQ(completeCheckpoint(&task, 301, &ver), 0);
+  ASSERT_EQ(ver, 1000);
+
+  // written and checked, but never completed since another task of the stream failed the check
+  for (int64_t ts = 0; ts < 10; ++ts) {
+    ASSERT_EQ(putWin(task.pState, ts, 'b'), 0);
+  }
+  ASSERT_EQ(executeBarrier(&task, 302, 2000), 0);
+  ASSERT_EQ(checkCheckpoint(&task, 302), 0);
+  ASSERT_EQ(putWin(task.pState, 0, 'c'), 0);
+  ASSERT_EQ(streamStateCommit(task.pState), 0);
+
+  // the task is killed, the restarted one resumes from the completed checkpoint
+  streamStateClose(task.pState);
+  task.checkpointWrittenId = 0;
+  task.pState = reopenState(name, &task);
+  ASSERT_NE(task.pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 301);
+  ASSERT_EQ(task.checkpointVer, 1000);
+  checkWins(task.pState, 'a', 0, 'a');
+
+  // and goes on with the next checkpoint
+  for (int64_t ts = 0; ts < 5; ++ts) {
+    ASSERT_EQ(putWin(task.pState, ts, 'd'), 0);
+  }
+  ASSERT_EQ(executeBarrier(&task, 303, 3000), 0);
+  ASSERT_EQ(checkCheckpoint(&task, 303), 0);
+  ASSERT_EQ(completeCheckpoint(&task, 303, &ver), 0);
+  ASSERT_EQ(ver, 3000);
+  streamStateClose(task.pState);
+
+  task.pState = reopenState(name, &task);
+  ASSERT_NE(task.pState, nullptr);
+  ASSERT_EQ(task.checkpointId, 303);
+  ASSERT_EQ(task.checkpointVer, 3000);
+  checkWins(task.pState, 'a', 5, 'd');
+  streamStateClose(task.pState);
+  taosArrayDestroy(task.checkpointChecks);
+}
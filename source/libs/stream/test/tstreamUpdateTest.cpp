@@ -192,6 +192,56 @@ TEST(TD_STREAM_UPDATE_TEST, update) {
   updateInfoDestroy(pSU7);
 }
 
+TEST(TD_STREAM_UPDATE_TEST, watermark) {
+  const int64_t interval = 20 * 1000;
+  const int64_t watermark = 10 * 60 * 1000;
+  SUpdateInfo  *pSU = updateInfoInit(interval, TSDB_TIME_PRECISION_MILLI, watermark);
+  GTEST_ASSERT_EQ(taosArrayGetSize(pSU->pTsBuckets), 0);
+
+  // in order rows of each table take the fast path
+  for (int64_t ts = 1; ts <= 1000; ts++) {
+    for (uint64_t uid = 1; uid <= 10; uid++) {
+      GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, ts * 10), false);
+    }
+  }
+  GTEST_ASSERT_EQ(pSU->numInOrder, 9990);
+  GTEST_ASSERT_EQ(pSU->numProbed, 10);
+
+  // rows behind the watermark are checked against the filters
+  for (uint64_t uid = 1; uid <= 10; uid++) {
+    GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 5000), true);
+    GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 10000), true);
+    GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 5005), false);
+    GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 5005), true);
+  }
+  GTEST_ASSERT_EQ(pSU->numProbed, 50);
+  GTEST_ASSERT_EQ(pSU->numBfHit + pSU->numNoFilter, 30);
+  GTEST_ASSERT_EQ(taosArrayGetSize(pSU->pTsBuckets), 0);
+
+  // the watermark of a filled table is its max ts
+  TSKEY           tsData[] = {20005, 20001, 20003};
+  SColumnInfoData col = {0};
+  col.pData = (char *)tsData;
+  SSDataBlock block = {0};
+  block.pDataBlock = taosArrayInit(1, sizeof(SColumnInfoData));
+  taosArrayPush(block.pDataBlock, &col);
+  block.info.id.uid = 100;
+  block.info.rows = 3;
+  GTEST_ASSERT_EQ(updateInfoFillBlockData(pSU, &block, 0), 20005);
+  tsData[0] = 20009;
+  tsData[1] = 20007;
+  block.info.rows = 2;
+  GTEST_ASSERT_EQ(updateInfoFillBlockData(pSU, &block, 0), 20009);
+  uint64_t uid = 100;
+  GTEST_ASSERT_EQ(*(TSKEY *)taosHashGet(pSU->pMap, &uid, sizeof(uint64_t)), 20009);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 20005), true);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 20009), true);
+  GTEST_ASSERT_EQ(updateInfoIsUpdated(pSU, uid, 20010), false);
+  taosArrayDestroy(block.pDataBlock);
+
+  updateInfoDestroy(pSU);
+}
+
 int main(int argc, char *argv[]) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -20,6 +20,7 @@
 #include "syncIndexMgr.h"
 #include "syncInt.h"
 #include "syncRaftEntry.h"
+#include "syncRaftLog.h"
 #include "syncRaftStore.h"
 #include "syncReplication.h"
 #include "syncRespMgr.h"
@@ -396,6 +397,10 @@ int64_t syncLogBufferProceed(SSyncLogBuffer* pBuf, SSyncNode* pNode, SyncTerm* p
 
   SSyncLogStore* pLogStore = pNode->pLogStore;
   int64_t        matchIndex = pBuf->matchIndex;
+  int64_t        startIndex = matchIndex;
+
+  // entries persisted in this round share one fsync, and my match index is only advanced after that
+  walBeginGroupCommit(pNode->pWal);
 
   while (pBuf->matchIndex + 1 < pBuf->endIndex) {
     int64_t index = pBuf->matchIndex + 1;
@@ -450,10 +455,20 @@ int64_t syncLogBufferProceed(SSyncLogBuffer* pBuf, SSyncNode* pNode, SyncTerm* p
 
     // update my match index
     matchIndex = pBuf->matchIndex;
-    syncIndexMgrSetIndex(pNode->pMatchIndex, &pNode->myRaftId, pBuf->matchIndex);
   }  // end of while
 
 _out:
+  // the entries of this round are persisted only if the group commit succeeds, and those dropped by the wal on a failed
+  // write are not persisted either. they are appended again in the next round.
+  if (walEndGroupCommit(pNode->pWal) < 0) {
+    sError("vgId:%d, failed to persist sync log entries since %s. index:%" PRId64 "-%" PRId64, pNode->vgId,
+           terrstr(), startIndex + 1, matchIndex);
+    matchIndex = startIndex;
+  }
+  matchIndex = TMIN(matchIndex, pLogStore->syncLogLastIndex(pLogStore));
+  if (matchIndex > startIndex) {
+    syncIndexMgrSetIndex(pNode->pMatchIndex, &pNode->myRaftId, matchIndex);
+  }
   pBuf->matchIndex = matchIndex;
   if (pMatchTerm) {
     *pMatchTerm = pBuf->entries[(matchIndex + pBuf->size) % pBuf->size].pItem->term;
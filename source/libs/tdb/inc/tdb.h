@@ -42,6 +42,13 @@ int32_t tdbPrepareAsyncCommit(TDB *pDb, TXN *pTxn);
 int32_t tdbAbort(TDB *pDb, TXN *pTxn);
 int32_t tdbAlter(TDB *pDb, int pages);
 
+// page level snapshot of the db file, only valid between transactions
+typedef int32_t (*tdb_page_fn_t)(void *arg, uint32_t pgno, const void *pData, int32_t szPage);
+
+int32_t tdbGetFileInfo(TDB *pDb, int32_t *szPage, uint32_t *nPage);
+int32_t tdbScanChangedPages(TDB *pDb, bool all, tdb_page_fn_t fn, void *arg);
+void    tdbClearChangedPages(TDB *pDb);
+
 // TTB
 int32_t tdbTbOpen(const char *tbname, int keyLen, int valLen, tdb_cmpr_fn_t keyCmprFn, TDB *pEnv, TTB **ppTb,
                   int8_t rollback);
@@ -400,7 +400,7 @@ static int tdbBtreeOpenImpl(SBTree *pBt) {
   }
 
   // Try to create a new database
-  ret = tdbPagerAllocPage(pBt->pPager, &pgno);
+  ret = tdbPagerAllocPage(pBt->pPager, &pgno, NULL);
   if (ret < 0) {
     ASSERT(0);
     return -1;
@@ -596,11 +596,11 @@ static int tdbBtreeBalanceNonRoot(SBTree *pBt, SPage *pParent, int idx, TXN *pTx
       return -1;
     }
 
-    // drop the cells on parent page
+    // drop the cells on parent page, the overflow pages of the divider cells are kept if the cells are moved down
     for (int i = 0; i < nOlds; i++) {
       nCells = TDB_PAGE_TOTAL_CELLS(pParent);
       if (sIdx < nCells) {
-        tdbPageDropCell(pParent, sIdx, pTxn, pBt);
+        tdbPageDropCell(pParent, sIdx, pTxn, pBt, !childNotLeaf);
       } else {
         ((SIntHdr *)pParent->pData)->pgno = 0;
       }
@@ -845,8 +845,18 @@ static int tdbBtreeBalanceNonRoot(SBTree *pBt, SPage *pParent, int idx, TXN *pTx
     }
   }
 
+  // old pages not reused by the distribution are no longer referenced by the tree
+  SPgno aFreePgno[3];
+  int   nFreePgno = 0;
+  for (pageIdx = nNews; pageIdx < nOlds; ++pageIdx) {
+    aFreePgno[nFreePgno++] = TDB_PAGE_PGNO(pOlds[pageIdx]);
+  }
+
   if (TDB_BTREE_PAGE_IS_ROOT(pParent) && TDB_PAGE_TOTAL_CELLS(pParent) == 0) {
     i8 flags = TDB_BTREE_ROOT | TDB_BTREE_PAGE_IS_LEAF(pNews[0]);
+
+    // the only child is copied up into the root, free it as well
+    aFreePgno[nFreePgno++] = TDB_PAGE_PGNO(pNews[0]);
     // copy content to the parent page
     tdbBtreeInitPage(pParent, &(SBtreeInitPageArg){.flags = flags, .pBt = pBt}, 0);
     tdbPageCopy(pNews[0], pParent, 1);
@@ -869,6 +879,13 @@ static int tdbBtreeBalanceNonRoot(SBTree *pBt, SPage *pParent, int idx, TXN *pTx
     tdbPagerReturnPage(pBt->pPager, pNews[pageIdx], pTxn);
   }
 
+  for (int i = 0; i < nFreePgno; i++) {
+    ret = tdbPagerFreePage(pBt->pPager, aFreePgno[i], pTxn);
+    if (ret < 0) {
+      return -1;
+    }
+  }
+
   return 0;
 }
 
@@ -1333,7 +1350,7 @@ static int tdbBtreeDecodePayload(SPage *pPage, const SCell *pCell, int nHeader,
         ofpCell = tdbPageGetCell(ofp, 0);
 
         int lastKeyPage = 0;
-        if (nLeftKey <= maxLocal - sizeof(SPgno)) {
+        if (nLeftKey <= ofp->maxLocal - sizeof(SPgno)) {
           bytes = nLeftKey;
           lastKeyPage = 1;
           lastKeyPageSpace = ofp->maxLocal - sizeof(SPgno) - nLeftKey;
@@ -1512,6 +1529,8 @@ static int tdbBtreeCellSize(const SPage *pPage, SCell *pCell, int dropOfp, TXN *
       int    bytes;
 
       while (pgno != 0) {
+        SPgno ofpPgno = pgno;
+
         ret = tdbLoadOvflPage(&pgno, &ofp, pTxn, pBt);
         if (ret < 0) {
           return -1;
@@ -1529,6 +1548,11 @@ static int tdbBtreeCellSize(const SPage *pPage, SCell *pCell, int dropOfp, TXN *
 
         tdbPagerReturnPage(pPage->pPager, ofp, pTxn);
 
+        ret = tdbPagerFreePage(pPage->pPager, ofpPgno, pTxn);
+        if (ret < 0) {
+          return -1;
+        }
+
         nLeft -= bytes;
       }
     }
@@ -1987,7 +2011,7 @@ int tdbBtcDelete(SBTC *pBtc) {
     return -1;
   }
 
-  tdbPageDropCell(pBtc->pPage, idx, pBtc->pTxn, pBtc->pBt);
+  tdbPageDropCell(pBtc->pPage, idx, pBtc->pTxn, pBtc->pBt, 1);
 
   // update interior page or do balance
   if (idx == nCells - 1) {
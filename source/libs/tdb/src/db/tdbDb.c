@@ -70,6 +70,14 @@ int32_t tdbOpen(const char *dbname, int32_t szPage, int32_t pages, TDB **ppDb, i
   if (ret < 0) {
     return -1;
   }
+
+  // the freelist head is kept in the main db
+  for (SPager *pPager = pDb->pgrList; pPager; pPager = pPager->pNext) {
+    ret = tdbPagerLoadFreeList(pPager);
+    if (ret < 0) {
+      return -1;
+    }
+  }
 #endif
 
   *ppDb = pDb;
@@ -99,6 +107,28 @@ int tdbClose(TDB *pDb) {
 
 int32_t tdbAlter(TDB *pDb, int pages) { return tdbPCacheAlter(pDb->pCache, pages); }
 
+int32_t tdbGetFileInfo(TDB *pDb, int32_t *szPage, uint32_t *nPage) {
+  SPager *pPager = pDb->pgrList;
+
+  ASSERT(pDb->nPager == 1);
+  *szPage = pPager->pageSize;
+  *nPage = pPager->dbFileSize;
+  return 0;
+}
+
+int32_t tdbScanChangedPages(TDB *pDb, bool all, tdb_page_fn_t fn, void *arg) {
+  ASSERT(pDb->nPager == 1);
+  return tdbPagerScanChangedPages(pDb->pgrList, all, fn, arg);
+}
+
+void tdbClearChangedPages(TDB *pDb) {
+  SPager *pPager;
+
+  for (pPager = pDb->pgrList; pPager; pPager = pPager->pNext) {
+    tdbPagerClearChangedPages(pPager);
+  }
+}
+
 int32_t tdbBegin(TDB *pDb, TXN **ppTxn, void *(*xMalloc)(void *, size_t), void (*xFree)(void *, void *), void *xArg,
                  int flags) {
   SPager *pPager;
@@ -17,10 +17,14 @@
 // #include <sys/types.h>
 // #include <unistd.h>
 
-struct SPCache {
-  int         szPage;
-  int         nPages;
-  SPage     **aPage;
+// The cache is partitioned into shards by page id hash. Each shard has its own
+// lock, hash table, LRU list and free list, so fetch and release of pages in
+// different shards do not contend. A shard short of pages steals a recyclable
+// one from the other shards without blocking on their locks.
+#define TDB_PCACHE_MAX_SHARDS     16
+#define TDB_PCACHE_MIN_SHARD_SIZE 64
+
+typedef struct {
   tdb_mutex_t mutex;
   int         nFree;
   SPage      *pFree;
@@ -29,6 +33,14 @@ struct SPCache {
   SPage     **pgHash;
   int         nRecyclable;
   SPage       lru;
+} SPCacheShard;
+
+struct SPCache {
+  int           szPage;
+  int           nPages;
+  SPage       **aPage;
+  int           nShard;
+  SPCacheShard *aShard;
 };
 
 static inline uint32_t tdbPCachePageHash(const SPgid *pPgid) {
@@ -36,18 +48,33 @@ static inline uint32_t tdbPCachePageHash(const SPgid *pPgid) {
   return (uint32_t)(t[0] + t[1] + t[2] + t[3] + t[4] + t[5] + (pPgid)->pgno);
 }
 
+static inline SPCacheShard *tdbPCacheGetShard(SPCache *pCache, const SPgid *pPgid) {
+  return &pCache->aShard[tdbPCachePageHash(pPgid) % pCache->nShard];
+}
+
 static int    tdbPCacheOpenImpl(SPCache *pCache);
-static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn);
-static void   tdbPCachePinPage(SPCache *pCache, SPage *pPage);
-static void   tdbPCacheRemovePageFromHash(SPCache *pCache, SPage *pPage);
-static void   tdbPCacheAddPageToHash(SPCache *pCache, SPage *pPage);
-static void   tdbPCacheUnpinPage(SPCache *pCache, SPage *pPage);
+static SPage *tdbPCacheFetchImpl(SPCache *pCache, SPCacheShard *pShard, const SPgid *pPgid, TXN *pTxn);
+static void   tdbPCachePinPage(SPCacheShard *pShard, SPage *pPage);
+static void   tdbPCacheRemovePageFromHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage);
+static void   tdbPCacheAddPageToHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage);
+static void   tdbPCacheUnpinPage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage);
 static int    tdbPCacheCloseImpl(SPCache *pCache);
 
-static void tdbPCacheInitLock(SPCache *pCache) { tdbMutexInit(&(pCache->mutex), NULL); }
-static void tdbPCacheDestroyLock(SPCache *pCache) { tdbMutexDestroy(&(pCache->mutex)); }
-static void tdbPCacheLock(SPCache *pCache) { tdbMutexLock(&(pCache->mutex)); }
-static void tdbPCacheUnlock(SPCache *pCache) { tdbMutexUnlock(&(pCache->mutex)); }
+static void tdbPCacheLock(SPCacheShard *pShard) { tdbMutexLock(&(pShard->mutex)); }
+static void tdbPCacheUnlock(SPCacheShard *pShard) { tdbMutexUnlock(&(pShard->mutex)); }
+static int  tdbPCacheTryLock(SPCacheShard *pShard) { return tdbMutexTryLock(&(pShard->mutex)); }
+
+static void tdbPCacheLockAll(SPCache *pCache) {
+  for (int i = 0; i < pCache->nShard; i++) {
+    tdbPCacheLock(&pCache->aShard[i]);
+  }
+}
+
+static void tdbPCacheUnlockAll(SPCache *pCache) {
+  for (int i = pCache->nShard - 1; i >= 0; i--) {
+    tdbPCacheUnlock(&pCache->aShard[i]);
+  }
+}
 
 int tdbPCacheOpen(int pageSize, int cacheSize, SPCache **ppCache) {
   SPCache *pCache;
@@ -67,7 +94,22 @@ int tdbPCacheOpen(int pageSize, int cacheSize, SPCache **ppCache) {
     return -1;
   }
 
+  // small caches keep a single shard so the LRU stays meaningful
+  pCache->nShard = 1;
+  while (pCache->nShard < TDB_PCACHE_MAX_SHARDS && cacheSize / (pCache->nShard * 2) >= TDB_PCACHE_MIN_SHARD_SIZE) {
+    pCache->nShard *= 2;
+  }
+
+  pCache->aShard = (SPCacheShard *)tdbOsCalloc(pCache->nShard, sizeof(SPCacheShard));
+  if (pCache->aShard == NULL) {
+    tdbOsFree(pCache->aPage);
+    tdbOsFree(pCache);
+    return -1;
+  }
+
   if (tdbPCacheOpenImpl(pCache) < 0) {
+    tdbOsFree(pCache->aShard);
+    tdbOsFree(pCache->aPage);
     tdbOsFree(pCache);
     return -1;
   }
@@ -79,20 +121,13 @@ int tdbPCacheOpen(int pageSize, int cacheSize, SPCache **ppCache) {
 int tdbPCacheClose(SPCache *pCache) {
   if (pCache) {
     tdbPCacheCloseImpl(pCache);
+    tdbOsFree(pCache->aShard);
     tdbOsFree(pCache->aPage);
     tdbOsFree(pCache);
   }
   return 0;
 }
 
-// TODO:
-// if (pPage->id >= pCache->nPages) {
-//   free(pPage);
-//   pCache->aPage[pPage->id] = NULL;
-// } else {
-//   add to free list
-// }
-
 static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
   if (pCache->nPages == nPage) {
     return 0;
@@ -124,9 +159,11 @@ static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
 
     // add page to free list
     for (int32_t iPage = pCache->nPages; iPage < nPage; iPage++) {
-      aPage[iPage]->pFreeNext = pCache->pFree;
-      pCache->pFree = aPage[iPage];
-      pCache->nFree++;
+      SPCacheShard *pShard = &pCache->aShard[iPage % pCache->nShard];
+
+      aPage[iPage]->pFreeNext = pShard->pFree;
+      pShard->pFree = aPage[iPage];
+      pShard->nFree++;
     }
 
     for (int32_t iPage = 0; iPage < pCache->nPages; iPage++) {
@@ -136,17 +173,21 @@ static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
     tdbOsFree(pCache->aPage);
     pCache->aPage = aPage;
   } else {
-    for (SPage **ppPage = &pCache->pFree; *ppPage;) {
-      int32_t iPage = (*ppPage)->id;
-
-      if (iPage >= nPage) {
-        SPage *pPage = *ppPage;
-        *ppPage = pPage->pFreeNext;
-        pCache->aPage[pPage->id] = NULL;
-        tdbPageDestroy(pPage, tdbDefaultFree, NULL);
-        pCache->nFree--;
-      } else {
-        ppPage = &(*ppPage)->pFreeNext;
+    for (int32_t iShard = 0; iShard < pCache->nShard; iShard++) {
+      SPCacheShard *pShard = &pCache->aShard[iShard];
+
+      for (SPage **ppPage = &pShard->pFree; *ppPage;) {
+        int32_t iPage = (*ppPage)->id;
+
+        if (iPage >= nPage) {
+          SPage *pPage = *ppPage;
+          *ppPage = pPage->pFreeNext;
+          pCache->aPage[pPage->id] = NULL;
+          tdbPageDestroy(pPage, tdbDefaultFree, NULL);
+          pShard->nFree--;
+        } else {
+          ppPage = &(*ppPage)->pFreeNext;
+        }
       }
     }
   }
@@ -158,27 +199,28 @@ static int tdbPCacheAlterImpl(SPCache *pCache, int32_t nPage) {
 int tdbPCacheAlter(SPCache *pCache, int32_t nPage) {
   int ret = 0;
 
-  tdbPCacheLock(pCache);
+  tdbPCacheLockAll(pCache);
 
   ret = tdbPCacheAlterImpl(pCache, nPage);
 
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlockAll(pCache);
 
   return ret;
 }
 
 SPage *tdbPCacheFetch(SPCache *pCache, const SPgid *pPgid, TXN *pTxn) {
-  SPage *pPage;
-  i32    nRef = 0;
+  SPage        *pPage;
+  i32           nRef = 0;
+  SPCacheShard *pShard = tdbPCacheGetShard(pCache, pPgid);
 
-  tdbPCacheLock(pCache);
+  tdbPCacheLock(pShard);
 
-  pPage = tdbPCacheFetchImpl(pCache, pPgid, pTxn);
+  pPage = tdbPCacheFetchImpl(pCache, pShard, pPgid, pTxn);
   if (pPage) {
     nRef = tdbRefPage(pPage);
   }
 
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlock(pShard);
 
   // printf("thread %" PRId64 " fetch page %d pgno %d pPage %p nRef %d\n", taosGetSelfPthreadId(), pPage->id,
   //        TDB_PAGE_PGNO(pPage), pPage, nRef);
@@ -193,55 +235,67 @@ SPage *tdbPCacheFetch(SPCache *pCache, const SPgid *pPgid, TXN *pTxn) {
 }
 
 void tdbPCacheMarkFree(SPCache *pCache, SPage *pPage) {
-  tdbPCacheLock(pCache);
-  tdbPCacheRemovePageFromHash(pCache, pPage);
+  SPCacheShard *pShard = tdbPCacheGetShard(pCache, &pPage->pgid);
+
+  tdbPCacheLock(pShard);
+  tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
   pPage->isFree = 1;
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlock(pShard);
 }
 
-static void tdbPCacheFreePage(SPCache *pCache, SPage *pPage) {
+static void tdbPCacheFreePage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
   if (pPage->id < pCache->nPages) {
-    pPage->pFreeNext = pCache->pFree;
-    pCache->pFree = pPage;
+    pPage->pFreeNext = pShard->pFree;
+    pShard->pFree = pPage;
     pPage->isFree = 0;
-    ++pCache->nFree;
+    ++pShard->nFree;
     tdbTrace("pcache/free page %p/%d, pgno:%d, ", pPage, pPage->id, TDB_PAGE_PGNO(pPage));
   } else {
     tdbTrace("pcache/free2 page: %p/%d, pgno:%d, ", pPage, pPage->id, TDB_PAGE_PGNO(pPage));
 
-    tdbPCacheRemovePageFromHash(pCache, pPage);
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
     tdbPageDestroy(pPage, tdbDefaultFree, NULL);
   }
 }
 
 void tdbPCacheInvalidatePage(SPCache *pCache, SPager *pPager, SPgno pgno) {
-  SPgid        pgid;
-  const SPgid *pPgid = &pgid;
-  SPage       *pPage = NULL;
+  SPgid         pgid;
+  const SPgid  *pPgid = &pgid;
+  SPage        *pPage = NULL;
+  SPCacheShard *pShard;
 
   memcpy(&pgid, pPager->fid, TDB_FILE_ID_LEN);
   pgid.pgno = pgno;
+  pShard = tdbPCacheGetShard(pCache, pPgid);
+
+  tdbPCacheLock(pShard);
 
-  pPage = pCache->pgHash[tdbPCachePageHash(pPgid) % pCache->nHash];
+  pPage = pShard->pgHash[tdbPCachePageHash(pPgid) / pCache->nShard % pShard->nHash];
   while (pPage) {
     if (pPage->pgid.pgno == pPgid->pgno && memcmp(pPage->pgid.fileid, pPgid->fileid, TDB_FILE_ID_LEN) == 0) break;
     pPage = pPage->pHashNext;
   }
 
   if (pPage) {
-    tdbPCacheRemovePageFromHash(pCache, pPage);
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
   }
+
+  tdbPCacheUnlock(pShard);
 }
 
 void tdbPCacheRelease(SPCache *pCache, SPage *pPage, TXN *pTxn) {
-  i32 nRef;
+  i32           nRef;
+  SPCacheShard *pShard;
 
   ASSERT(pTxn);
 
   // nRef = tdbUnrefPage(pPage);
   // ASSERT(nRef >= 0);
 
-  tdbPCacheLock(pCache);
+  // the page id can not change while it is referenced
+  pShard = tdbPCacheGetShard(pCache, &pPage->pgid);
+
+  tdbPCacheLock(pShard);
   nRef = tdbUnrefPage(pPage);
   tdbTrace("pcache/release page %p/%d/%d/%d", pPage, TDB_PAGE_PGNO(pPage), pPage->id, nRef);
   if (nRef == 0) {
@@ -251,26 +305,60 @@ void tdbPCacheRelease(SPCache *pCache, SPage *pPage, TXN *pTxn) {
     // if (nRef == 0) {
     if (pPage->isLocal) {
       if (!pPage->isFree) {
-        tdbPCacheUnpinPage(pCache, pPage);
+        tdbPCacheUnpinPage(pCache, pShard, pPage);
       } else {
-        tdbPCacheFreePage(pCache, pPage);
+        tdbPCacheFreePage(pCache, pShard, pPage);
       }
     } else {
       if (TDB_TXN_IS_WRITE(pTxn)) {
         // remove from hash
-        tdbPCacheRemovePageFromHash(pCache, pPage);
+        tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
       }
 
       tdbPageDestroy(pPage, pTxn->xFree, pTxn->xArg);
     }
     // }
   }
-  tdbPCacheUnlock(pCache);
+  tdbPCacheUnlock(pShard);
 }
 
 int tdbPCacheGetPageSize(SPCache *pCache) { return pCache->szPage; }
 
-static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn) {
+// take a free or recyclable page from the shard, the shard is locked by the caller
+static SPage *tdbPCacheTakePage(SPCache *pCache, SPCacheShard *pShard) {
+  SPage *pPage = NULL;
+
+  if (pShard->pFree) {
+    pPage = pShard->pFree;
+    pShard->pFree = pPage->pFreeNext;
+    pShard->nFree--;
+    pPage->pLruNext = NULL;
+  } else if (!pShard->lru.pLruPrev->isAnchor) {
+    pPage = pShard->lru.pLruPrev;
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
+    tdbPCachePinPage(pShard, pPage);
+  }
+
+  return pPage;
+}
+
+// steal a page from the other shards, never blocks since the caller holds its own shard lock
+static SPage *tdbPCacheStealPage(SPCache *pCache, SPCacheShard *pShard) {
+  SPage *pPage = NULL;
+  int    iShard = pShard - pCache->aShard;
+
+  for (int i = 1; i < pCache->nShard && pPage == NULL; i++) {
+    SPCacheShard *pOther = &pCache->aShard[(iShard + i) % pCache->nShard];
+
+    if (tdbPCacheTryLock(pOther) != 0) continue;
+    pPage = tdbPCacheTakePage(pCache, pOther);
+    tdbPCacheUnlock(pOther);
+  }
+
+  return pPage;
+}
+
+static SPage *tdbPCacheFetchImpl(SPCache *pCache, SPCacheShard *pShard, const SPgid *pPgid, TXN *pTxn) {
   int    ret = 0;
   SPage *pPage = NULL;
   SPage *pPageH = NULL;
@@ -278,7 +366,7 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   ASSERT(pTxn);
 
   // 1. Search the hash table
-  pPage = pCache->pgHash[tdbPCachePageHash(pPgid) % pCache->nHash];
+  pPage = pShard->pgHash[tdbPCachePageHash(pPgid) / pCache->nShard % pShard->nHash];
   while (pPage) {
     if (pPage->pgid.pgno == pPgid->pgno && memcmp(pPage->pgid.fileid, pPgid->fileid, TDB_FILE_ID_LEN) == 0) break;
     pPage = pPage->pHashNext;
@@ -286,7 +374,7 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
 
   if (pPage) {
     if (pPage->isLocal || TDB_TXN_IS_WRITE(pTxn)) {
-      tdbPCachePinPage(pCache, pPage);
+      tdbPCachePinPage(pShard, pPage);
       return pPage;
     }
   }
@@ -296,19 +384,12 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   pPageH = pPage;
   pPage = NULL;
 
-  // 2. Try to allocate a new page from the free list
-  if (pCache->pFree) {
-    pPage = pCache->pFree;
-    pCache->pFree = pPage->pFreeNext;
-    pCache->nFree--;
-    pPage->pLruNext = NULL;
-  }
+  // 2. Try to allocate a new page from the free list, or recycle a page of the shard
+  pPage = tdbPCacheTakePage(pCache, pShard);
 
-  // 3. Try to Recycle a page
-  if (!pPage && !pCache->lru.pLruPrev->isAnchor) {
-    pPage = pCache->lru.pLruPrev;
-    tdbPCacheRemovePageFromHash(pCache, pPage);
-    tdbPCachePinPage(pCache, pPage);
+  // 3. Try to take a page from the other shards
+  if (!pPage) {
+    pPage = tdbPCacheStealPage(pCache, pShard);
   }
 
   // 4. Try a create new page
@@ -360,7 +441,7 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
       pPage->pPager = NULL;
 
       if (pPage->isLocal || TDB_TXN_IS_WRITE(pTxn)) {
-        tdbPCacheAddPageToHash(pCache, pPage);
+        tdbPCacheAddPageToHash(pCache, pShard, pPage);
       }
     }
   }
@@ -368,7 +449,7 @@ static SPage *tdbPCacheFetchImpl(SPCache *pCache, const SPgid *pPgid, TXN *pTxn)
   return pPage;
 }
 
-static void tdbPCachePinPage(SPCache *pCache, SPage *pPage) {
+static void tdbPCachePinPage(SPCacheShard *pShard, SPage *pPage) {
   if (pPage->pLruNext != NULL) {
     ASSERT(tdbGetPageRef(pPage) == 0);
 
@@ -376,13 +457,13 @@ static void tdbPCachePinPage(SPCache *pCache, SPage *pPage) {
     pPage->pLruNext->pLruPrev = pPage->pLruPrev;
     pPage->pLruNext = NULL;
 
-    pCache->nRecyclable--;
+    pShard->nRecyclable--;
 
     tdbTrace("pcache/pin page %p/%d, pgno:%d, ", pPage, pPage->id, TDB_PAGE_PGNO(pPage));
   }
 }
 
-static void tdbPCacheUnpinPage(SPCache *pCache, SPage *pPage) {
+static void tdbPCacheUnpinPage(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
   i32 nRef;
 
   ASSERT(pPage->isLocal);
@@ -394,46 +475,46 @@ static void tdbPCacheUnpinPage(SPCache *pCache, SPage *pPage) {
   tdbTrace("pCache:%p unpin page %p/%d, nPages:%d, pgno:%d, ", pCache, pPage, pPage->id, pCache->nPages,
            TDB_PAGE_PGNO(pPage));
   if (pPage->id < pCache->nPages) {
-    pPage->pLruPrev = &(pCache->lru);
-    pPage->pLruNext = pCache->lru.pLruNext;
-    pCache->lru.pLruNext->pLruPrev = pPage;
-    pCache->lru.pLruNext = pPage;
+    pPage->pLruPrev = &(pShard->lru);
+    pPage->pLruNext = pShard->lru.pLruNext;
+    pShard->lru.pLruNext->pLruPrev = pPage;
+    pShard->lru.pLruNext = pPage;
 
-    pCache->nRecyclable++;
+    pShard->nRecyclable++;
 
     // printf("unpin page %d pgno %d pPage %p\n", pPage->id, TDB_PAGE_PGNO(pPage), pPage);
     tdbTrace("pcache/unpin page %p/%d/%d", pPage, TDB_PAGE_PGNO(pPage), pPage->id);
   } else {
     tdbTrace("pcache destroy page: %p/%d/%d", pPage, TDB_PAGE_PGNO(pPage), pPage->id);
 
-    tdbPCacheRemovePageFromHash(pCache, pPage);
+    tdbPCacheRemovePageFromHash(pCache, pShard, pPage);
     tdbPageDestroy(pPage, tdbDefaultFree, NULL);
   }
 }
 
-static void tdbPCacheRemovePageFromHash(SPCache *pCache, SPage *pPage) {
-  uint32_t h = tdbPCachePageHash(&(pPage->pgid)) % pCache->nHash;
+static void tdbPCacheRemovePageFromHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
+  uint32_t h = tdbPCachePageHash(&(pPage->pgid)) / pCache->nShard % pShard->nHash;
 
-  SPage **ppPage = &(pCache->pgHash[h]);
+  SPage **ppPage = &(pShard->pgHash[h]);
   for (; (*ppPage) && *ppPage != pPage; ppPage = &((*ppPage)->pHashNext))
     ;
 
   if (*ppPage) {
     *ppPage = pPage->pHashNext;
-    pCache->nPage--;
+    pShard->nPage--;
     // printf("rmv page %d to hash, pgno %d, pPage %p\n", pPage->id, TDB_PAGE_PGNO(pPage), pPage);
   }
 
   tdbTrace("pcache/remove page %p/%d from hash %" PRIu32 " pgno:%d, ", pPage, pPage->id, h, TDB_PAGE_PGNO(pPage));
 }
 
-static void tdbPCacheAddPageToHash(SPCache *pCache, SPage *pPage) {
-  uint32_t h = tdbPCachePageHash(&(pPage->pgid)) % pCache->nHash;
+static void tdbPCacheAddPageToHash(SPCache *pCache, SPCacheShard *pShard, SPage *pPage) {
+  uint32_t h = tdbPCachePageHash(&(pPage->pgid)) / pCache->nShard % pShard->nHash;
 
-  pPage->pHashNext = pCache->pgHash[h];
-  pCache->pgHash[h] = pPage;
+  pPage->pHashNext = pShard->pgHash[h];
+  pShard->pgHash[h] = pPage;
 
-  pCache->nPage++;
+  pShard->nPage++;
 
   tdbTrace("pcache/add page %p/%d to hash %" PRIu32 " pgno:%d, ", pPage, pPage->id, h, TDB_PAGE_PGNO(pPage));
 }
@@ -444,12 +525,34 @@ static int tdbPCacheOpenImpl(SPCache *pCache) {
   int    tsize;
   int    ret;
 
-  tdbPCacheInitLock(pCache);
+  for (int iShard = 0; iShard < pCache->nShard; iShard++) {
+    SPCacheShard *pShard = &pCache->aShard[iShard];
 
-  // Open the free list
-  pCache->nFree = 0;
-  pCache->pFree = NULL;
+    tdbMutexInit(&(pShard->mutex), NULL);
+
+    // Open the hash table
+    pShard->nPage = 0;
+    pShard->nHash = pCache->nPages / pCache->nShard < 8 ? 8 : pCache->nPages / pCache->nShard;
+    pShard->pgHash = (SPage **)tdbOsCalloc(pShard->nHash, sizeof(SPage *));
+    if (pShard->pgHash == NULL) {
+      // TODO
+      return -1;
+    }
+
+    // Open LRU list
+    pShard->nRecyclable = 0;
+    pShard->lru.isAnchor = 1;
+    pShard->lru.pLruNext = &(pShard->lru);
+    pShard->lru.pLruPrev = &(pShard->lru);
+
+    pShard->nFree = 0;
+    pShard->pFree = NULL;
+  }
+
+  // Open the free list, pages are spread over the shards
   for (int i = 0; i < pCache->nPages; i++) {
+    SPCacheShard *pShard = &pCache->aShard[i % pCache->nShard];
+
     if (tdbPageCreate(pCache->szPage, &pPage, tdbDefaultMalloc, NULL) < 0) {
       // TODO: handle error
       return -1;
@@ -465,50 +568,42 @@ static int tdbPCacheOpenImpl(SPCache *pCache) {
     pPage->pDirtyNext = NULL;
 
     // add page to free list
-    pPage->pFreeNext = pCache->pFree;
-    pCache->pFree = pPage;
-    pCache->nFree++;
+    pPage->pFreeNext = pShard->pFree;
+    pShard->pFree = pPage;
+    pShard->nFree++;
 
     // add to local list
     pPage->id = i;
     pCache->aPage[i] = pPage;
   }
 
-  // Open the hash table
-  pCache->nPage = 0;
-  pCache->nHash = pCache->nPages < 8 ? 8 : pCache->nPages;
-  pCache->pgHash = (SPage **)tdbOsCalloc(pCache->nHash, sizeof(SPage *));
-  if (pCache->pgHash == NULL) {
-    // TODO
-    return -1;
-  }
-
-  // Open LRU list
-  pCache->nRecyclable = 0;
-  pCache->lru.isAnchor = 1;
-  pCache->lru.pLruNext = &(pCache->lru);
-  pCache->lru.pLruPrev = &(pCache->lru);
-
   return 0;
 }
 
 static int tdbPCacheCloseImpl(SPCache *pCache) {
-  // free free page
-  for (SPage *pPage = pCache->pFree; pPage;) {
-    SPage *pPageT = pPage->pFreeNext;
-    tdbPageDestroy(pPage, tdbDefaultFree, NULL);
-    pPage = pPageT;
-  }
+  for (int iShard = 0; iShard < pCache->nShard; iShard++) {
+    SPCacheShard *pShard = &pCache->aShard[iShard];
 
-  for (int32_t iBucket = 0; iBucket < pCache->nHash; iBucket++) {
-    for (SPage *pPage = pCache->pgHash[iBucket]; pPage;) {
-      SPage *pPageT = pPage->pHashNext;
+    // free free page
+    for (SPage *pPage = pShard->pFree; pPage;) {
+      SPage *pPageT = pPage->pFreeNext;
       tdbPageDestroy(pPage, tdbDefaultFree, NULL);
       pPage = pPageT;
     }
+
+    if (pShard->pgHash) {
+      for (int32_t iBucket = 0; iBucket < pShard->nHash; iBucket++) {
+        for (SPage *pPage = pShard->pgHash[iBucket]; pPage;) {
+          SPage *pPageT = pPage->pHashNext;
+          tdbPageDestroy(pPage, tdbDefaultFree, NULL);
+          pPage = pPageT;
+        }
+      }
+    }
+
+    tdbOsFree(pShard->pgHash);
+    tdbMutexDestroy(&(pShard->mutex));
   }
 
-  tdbOsFree(pCache->pgHash);
-  tdbPCacheDestroyLock(pCache);
   return 0;
 }
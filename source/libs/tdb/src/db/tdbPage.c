@@ -187,11 +187,11 @@ int tdbPageInsertCell(SPage *pPage, int idx, SCell *pCell, int szCell, u8 asOvfl
 }
 
 int tdbPageUpdateCell(SPage *pPage, int idx, SCell *pCell, int szCell, TXN *pTxn, SBTree *pBt) {
-  tdbPageDropCell(pPage, idx, pTxn, pBt);
+  tdbPageDropCell(pPage, idx, pTxn, pBt, 1);
   return tdbPageInsertCell(pPage, idx, pCell, szCell, 0);
 }
 
-int tdbPageDropCell(SPage *pPage, int idx, TXN *pTxn, SBTree *pBt) {
+int tdbPageDropCell(SPage *pPage, int idx, TXN *pTxn, SBTree *pBt, int dropOfp) {
   int    lidx;
   SCell *pCell;
   int    szCell;
@@ -222,7 +222,7 @@ int tdbPageDropCell(SPage *pPage, int idx, TXN *pTxn, SBTree *pBt) {
 
   lidx = idx - iOvfl;
   pCell = TDB_PAGE_CELL_AT(pPage, lidx);
-  szCell = (*pPage->xCellSize)(pPage, pCell, 1, pTxn, pBt);
+  szCell = (*pPage->xCellSize)(pPage, pCell, dropOfp, pTxn, pBt);
   tdbPageFree(pPage, lidx, pCell, szCell);
   TDB_PAGE_NCELLS_SET(pPage, nCells - 1);
 
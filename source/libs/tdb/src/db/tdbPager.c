@@ -27,6 +27,25 @@ typedef struct {
 
 TDB_STATIC_ASSERT(sizeof(SFileHdr) == 128, "Size of file header is not correct");
 
+// Freed pages are chained by trunk pages. Each trunk page records the next
+// trunk and an array of free leaf pages, the trunk itself is free as well.
+#pragma pack(push, 1)
+typedef struct {
+  SPgno next;
+  u32   nLeaf;
+  SPgno aLeaf[];
+} STrunkHdr;
+#pragma pack(pop)
+
+#define TDB_TRUNK_MAX_LEAF(pageSize) (((pageSize) - sizeof(STrunkHdr)) / sizeof(SPgno))
+
+// key of the freelist record in the main db, the value is encoded as a SBtInfo
+// with root as the head trunk page and nData as the number of free pages. Table
+// names are stored with the terminating '\0' only, so a key starting with '\0'
+// can never be taken by a table.
+#define TDB_FREELIST_KEY     "\0freelist"
+#define TDB_FREELIST_KEY_LEN ((int)sizeof(TDB_FREELIST_KEY))
+
 struct hashset_st {
   size_t  nbits;
   size_t  mask;
@@ -143,6 +162,7 @@ static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage
                             u8 loadPage);
 static int tdbPagerWritePageToJournal(SPager *pPager, SPage *pPage);
 static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage);
+static void tdbPagerMarkChanged(SPager *pPager, SPgno pgno);
 
 static FORCE_INLINE int32_t pageCmpFn(const SRBTreeNode *lhs, const SRBTreeNode *rhs) {
   SPage *pPageL = (SPage *)(((uint8_t *)lhs) - offsetof(SPage, node));
@@ -209,6 +229,7 @@ int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
   // pPager->dbOrigSize
   ret = tdbGetFileSize(pPager->fd, pPager->pageSize, &(pPager->dbOrigSize));
   pPager->dbFileSize = pPager->dbOrigSize;
+  pPager->chgAll = 1;
 
   tdbTrace("pager/open reset dirty tree: %p", &pPager->rbt);
   tRBTreeCreate(&pPager->rbt, pageCmpFn);
@@ -225,6 +246,7 @@ int tdbPagerClose(SPager *pPager) {
     }
     */
     tdbOsClose(pPager->fd);
+    tdbOsFree(pPager->chgBits);
     tdbOsFree(pPager);
   }
   return 0;
@@ -313,6 +335,13 @@ int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
   SPage *pPage;
   int    ret;
 
+  // give the free tail back and persist the freelist before the journal is synced
+  if (tdbPagerVacuum(pPager, pTxn) < 0 || tdbPagerSaveFreeList(pPager, pTxn) < 0) {
+    tdbError("failed to save freelist since %s. file:%s, %" PRId64, tstrerror(terrno), pPager->dbFileName,
+             pTxn->txnId);
+    return -1;
+  }
+
   // sync the journal file
   ret = tdbOsFSync(pTxn->jfd);
   if (ret < 0) {
@@ -385,6 +414,17 @@ int tdbPagerPostCommit(SPager *pPager, TXN *pTxn) {
 
   // pPager->inTran = 0;
 
+  // truncate only after the journal is removed, so a crash in between leaves the old pages in place
+  if (pPager->truncate) {
+    pPager->truncate = 0;
+    if (tdbOsFTruncate(pPager->fd, (i64)pPager->pageSize * pPager->dbFileSize) < 0) {
+      tdbError("failed to truncate file due to %s. file:%s, size:%d", strerror(errno), pPager->dbFileName,
+               pPager->dbFileSize);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+  }
+
   tdbDebug("pager/post-commit:%p, %d/%d", pPager, pPager->dbOrigSize, pPager->dbFileSize);
 
   return 0;
@@ -395,6 +435,12 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   SPgno  maxPgno = pPager->dbOrigSize;
   int    ret;
 
+  if (tdbPagerVacuum(pPager, pTxn) < 0 || tdbPagerSaveFreeList(pPager, pTxn) < 0) {
+    tdbError("failed to save freelist since %s. file:%s, %" PRId64, tstrerror(terrno), pPager->dbFileName,
+             pTxn->txnId);
+    return -1;
+  }
+
   // sync the journal file
   ret = tdbOsFSync(pTxn->jfd);
   if (ret < 0) {
@@ -422,7 +468,8 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   }
 
   tdbTrace("tdbttl commit:%p, %d/%d", pPager, pPager->dbOrigSize, pPager->dbFileSize);
-  pPager->dbOrigSize = maxPgno;
+  // pages beyond the vacuumed size are cut off in post-commit
+  pPager->dbOrigSize = TMIN(maxPgno, pPager->dbFileSize);
   //  pPager->dbOrigSize = pPager->dbFileSize;
 
   // release the page
@@ -503,6 +550,7 @@ int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
     tdbTrace("pager/abort: restore pgno:%d,", pgno);
 
     tdbPCacheInvalidatePage(pPager->pCache, pPager, pgno);
+    tdbPagerMarkChanged(pPager, pgno);
 
     ret = tdbOsRead(jfd, pageBuf, pPager->pageSize);
     if (ret < 0) {
@@ -557,6 +605,13 @@ int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
   tdbTrace("pager/abort: reset dirty tree: %p", &pPager->rbt);
   tRBTreeCreate(&pPager->rbt, pageCmpFn);
 
+  // pages allocated by the txn are dropped, and the freelist goes back to the committed one
+  pPager->dbFileSize = pPager->dbOrigSize;
+  pPager->truncate = 0;
+  if (tdbPagerLoadFreeList(pPager) < 0) {
+    return -1;
+  }
+
   // 4, remove the journal file
   if (tdbOsClose(pTxn->jfd) < 0) {
     tdbError("failed to close jfd: %s. file:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
@@ -655,7 +710,7 @@ int tdbPagerFetchPage(SPager *pPager, SPgno *ppgno, SPage **ppPage, int (*initPa
   // alloc new page
   if (pgno == 0) {
     loadPage = 0;
-    ret = tdbPagerAllocPage(pPager, &pgno);
+    ret = tdbPagerAllocPage(pPager, &pgno, pTxn);
     if (ret < 0) {
       ASSERT(0);
       return -1;
@@ -679,6 +734,13 @@ int tdbPagerFetchPage(SPager *pPager, SPgno *ppgno, SPage **ppPage, int (*initPa
       ASSERT(0);
       return -1;
     }
+  } else if (!loadPage) {
+    // a page reused from the freelist may still be cached with its old content
+    ret = (*initPage)(pPage, arg, 0);
+    if (ret < 0) {
+      ASSERT(0);
+      return -1;
+    }
   }
 
   // printf("thread %" PRId64 " pager fetch page %d pgno %d ppage %p\n", taosGetSelfPthreadId(), pPage->id,
@@ -698,8 +760,53 @@ void tdbPagerReturnPage(SPager *pPager, SPage *pPage, TXN *pTxn) {
   //        TDB_PAGE_PGNO(pPage), pPage);
 }
 
-static int tdbPagerAllocFreePage(SPager *pPager, SPgno *ppgno) {
-  // TODO: Allocate a page from the free list
+static int tdbPagerInitTrunkPage(SPage *pPage, void *arg, int init) {
+  if (!init) {
+    memset(pPage->pData, 0, pPage->pageSize);
+  }
+  return 0;
+}
+
+static int tdbPagerFetchTrunkPage(SPager *pPager, SPgno pgno, SPage **ppPage, TXN *pTxn) {
+  return tdbPagerFetchPage(pPager, &pgno, ppPage, tdbPagerInitTrunkPage, NULL, pTxn);
+}
+
+static int tdbPagerAllocFreePage(SPager *pPager, SPgno *ppgno, TXN *pTxn) {
+  SPage     *pPage;
+  STrunkHdr *pTrunk;
+  int        ret;
+
+  if (pPager->freePage == 0) {
+    return 0;
+  }
+
+  ret = tdbPagerFetchTrunkPage(pPager, pPager->freePage, &pPage, pTxn);
+  if (ret < 0) {
+    return -1;
+  }
+
+  // journal the trunk before it is changed or handed out as a new page
+  ret = tdbPagerWrite(pPager, pPage);
+  if (ret < 0) {
+    tdbError("failed to write page since %s", tstrerror(terrno));
+    tdbPagerReturnPage(pPager, pPage, pTxn);
+    return -1;
+  }
+
+  pTrunk = (STrunkHdr *)pPage->pData;
+  if (pTrunk->nLeaf > 0) {
+    *ppgno = pTrunk->aLeaf[--pTrunk->nLeaf];
+  } else {
+    *ppgno = pPager->freePage;
+    pPager->freePage = pTrunk->next;
+  }
+
+  tdbPagerReturnPage(pPager, pPage, pTxn);
+
+  pPager->nFreePages--;
+  pPager->freeDirty = 1;
+
+  tdbTrace("pager/alloc free page: %p, pgno:%d, free:%d", pPager, *ppgno, pPager->nFreePages);
   return 0;
 }
 
@@ -708,13 +815,13 @@ static int tdbPagerAllocNewPage(SPager *pPager, SPgno *ppgno) {
   return 0;
 }
 
-int tdbPagerAllocPage(SPager *pPager, SPgno *ppgno) {
+int tdbPagerAllocPage(SPager *pPager, SPgno *ppgno, TXN *pTxn) {
   int ret;
 
   *ppgno = 0;
 
   // Try to allocate from the free list of the pager
-  ret = tdbPagerAllocFreePage(pPager, ppgno);
+  ret = tdbPagerAllocFreePage(pPager, ppgno, pTxn);
   if (ret < 0) {
     return -1;
   }
@@ -732,6 +839,248 @@ int tdbPagerAllocPage(SPager *pPager, SPgno *ppgno) {
   return 0;
 }
 
+int tdbPagerFreePage(SPager *pPager, SPgno pgno, TXN *pTxn) {
+  SPage     *pPage;
+  STrunkHdr *pTrunk;
+  int        ret;
+
+  // page 1 is the root of the main db and never freed
+  ASSERT(pgno > 1 && pgno <= pPager->dbFileSize);
+
+  // append to the head trunk if it still has room
+  if (pPager->freePage) {
+    ret = tdbPagerFetchTrunkPage(pPager, pPager->freePage, &pPage, pTxn);
+    if (ret < 0) {
+      return -1;
+    }
+
+    pTrunk = (STrunkHdr *)pPage->pData;
+    if (pTrunk->nLeaf < TDB_TRUNK_MAX_LEAF(pPager->pageSize)) {
+      ret = tdbPagerWrite(pPager, pPage);
+      if (ret < 0) {
+        tdbError("failed to write page since %s", tstrerror(terrno));
+        tdbPagerReturnPage(pPager, pPage, pTxn);
+        return -1;
+      }
+
+      pTrunk->aLeaf[pTrunk->nLeaf++] = pgno;
+      tdbPagerReturnPage(pPager, pPage, pTxn);
+      goto _exit;
+    }
+
+    tdbPagerReturnPage(pPager, pPage, pTxn);
+  }
+
+  // otherwise the freed page becomes the new head trunk
+  ret = tdbPagerFetchTrunkPage(pPager, pgno, &pPage, pTxn);
+  if (ret < 0) {
+    return -1;
+  }
+
+  ret = tdbPagerWrite(pPager, pPage);
+  if (ret < 0) {
+    tdbError("failed to write page since %s", tstrerror(terrno));
+    tdbPagerReturnPage(pPager, pPage, pTxn);
+    return -1;
+  }
+
+  pTrunk = (STrunkHdr *)pPage->pData;
+  pTrunk->next = pPager->freePage;
+  pTrunk->nLeaf = 0;
+  tdbPagerReturnPage(pPager, pPage, pTxn);
+
+  pPager->freePage = pgno;
+
+_exit:
+  pPager->nFreePages++;
+  pPager->freeDirty = 1;
+  if (pgno > pPager->maxFreePgno) {
+    pPager->maxFreePgno = pgno;
+  }
+
+  tdbTrace("pager/free page: %p, pgno:%d, free:%d", pPager, pgno, pPager->nFreePages);
+  return 0;
+}
+
+int tdbPagerLoadFreeList(SPager *pPager) {
+  void *pData = NULL;
+  int   nData = 0;
+
+  pPager->freePage = 0;
+  pPager->nFreePages = 0;
+  pPager->maxFreePgno = 0;
+  pPager->freeDirty = 0;
+
+  if (pPager->pEnv == NULL || pPager->pEnv->pMainDb == NULL) {
+    return 0;
+  }
+
+  if (tdbTbGet(pPager->pEnv->pMainDb, TDB_FREELIST_KEY, TDB_FREELIST_KEY_LEN, &pData, &nData) < 0) {
+    // no page freed yet
+    return 0;
+  }
+
+  if (nData != sizeof(SBtInfo)) {
+    tdbError("invalid freelist record, size:%d. file:%s", nData, pPager->dbFileName);
+    tdbFree(pData);
+    terrno = TSDB_CODE_FILE_CORRUPTED;
+    return -1;
+  }
+
+  pPager->freePage = ((SBtInfo *)pData)->root;
+  pPager->nFreePages = ((SBtInfo *)pData)->nData;
+  tdbFree(pData);
+
+  // any free page may sit at the end of the file after reopen
+  if (pPager->nFreePages > 0) {
+    pPager->maxFreePgno = pPager->dbFileSize;
+  }
+
+  tdbDebug("pager/load freelist: %p, head:%d, free:%d, size:%d", pPager, pPager->freePage, pPager->nFreePages,
+           pPager->dbFileSize);
+  return 0;
+}
+
+int tdbPagerSaveFreeList(SPager *pPager, TXN *pTxn) {
+  SBtInfo info;
+
+  if (pPager->pEnv == NULL || pPager->pEnv->pMainDb == NULL) {
+    return 0;
+  }
+
+  // upserting the record may split a main db page, which takes a page from the
+  // freelist again, so loop until the record catches up
+  for (int nLoops = 0; pPager->freeDirty; nLoops++) {
+    if (nLoops >= 8) {
+      tdbError("freelist not stable after %d loops. file:%s", nLoops, pPager->dbFileName);
+      terrno = TSDB_CODE_FAILED;
+      return -1;
+    }
+
+    pPager->freeDirty = 0;
+    info.root = pPager->freePage;
+    info.nLevel = 0;
+    info.nData = pPager->nFreePages;
+    if (tdbTbUpsert(pPager->pEnv->pMainDb, TDB_FREELIST_KEY, TDB_FREELIST_KEY_LEN, &info, sizeof(info),
+                    pTxn) < 0) {
+      pPager->freeDirty = 1;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int tdbPgnoCmprFn(const void *p1, const void *p2) {
+  SPgno pgno1 = *(const SPgno *)p1;
+  SPgno pgno2 = *(const SPgno *)p2;
+
+  if (pgno1 < pgno2) {
+    return -1;
+  } else if (pgno1 > pgno2) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+// Online vacuum: free pages at the end of the file are dropped from the freelist
+// and the file is truncated after commit. Pages in use are never moved.
+int tdbPagerVacuum(SPager *pPager, TXN *pTxn) {
+  SPage     *pPage;
+  STrunkHdr *pTrunk;
+  SPgno     *aPgno = NULL;
+  int        nPgno = 0;
+  int        capacity = 0;
+  SPgno      pgno;
+  SPgno      size;
+  int        ret;
+
+  // nothing can be given back unless the last page of the file is free
+  if (pPager->nFreePages == 0 || pPager->maxFreePgno < pPager->dbFileSize) {
+    return 0;
+  }
+
+  // collect all free pages, the trunks are journaled as the freelist is rebuilt below
+  for (pgno = pPager->freePage; pgno != 0;) {
+    ret = tdbPagerFetchTrunkPage(pPager, pgno, &pPage, pTxn);
+    if (ret < 0) {
+      goto _err;
+    }
+
+    ret = tdbPagerWrite(pPager, pPage);
+    if (ret < 0) {
+      tdbError("failed to write page since %s", tstrerror(terrno));
+      tdbPagerReturnPage(pPager, pPage, pTxn);
+      goto _err;
+    }
+
+    pTrunk = (STrunkHdr *)pPage->pData;
+    if (nPgno + pTrunk->nLeaf + 1 > capacity) {
+      capacity = (nPgno + pTrunk->nLeaf + 1) * 2;
+      SPgno *aTmp = tdbOsRealloc(aPgno, sizeof(SPgno) * capacity);
+      if (aTmp == NULL) {
+        tdbPagerReturnPage(pPager, pPage, pTxn);
+        terrno = TSDB_CODE_OUT_OF_MEMORY;
+        goto _err;
+      }
+      aPgno = aTmp;
+    }
+
+    aPgno[nPgno++] = pgno;
+    memcpy(aPgno + nPgno, pTrunk->aLeaf, sizeof(SPgno) * pTrunk->nLeaf);
+    nPgno += pTrunk->nLeaf;
+    pgno = pTrunk->next;
+
+    tdbPagerReturnPage(pPager, pPage, pTxn);
+  }
+
+  if (nPgno != pPager->nFreePages) {
+    tdbWarn("pager/vacuum: %p, free pages mismatch, %d/%d. file:%s", pPager, nPgno, pPager->nFreePages,
+            pPager->dbFileName);
+  }
+
+  taosSort(aPgno, nPgno, sizeof(SPgno), tdbPgnoCmprFn);
+
+  // strip the free run at the end of the file
+  size = pPager->dbFileSize;
+  while (nPgno > 0 && aPgno[nPgno - 1] == size) {
+    nPgno--;
+    size--;
+  }
+
+  if (size == pPager->dbFileSize) {
+    pPager->maxFreePgno = nPgno > 0 ? aPgno[nPgno - 1] : 0;
+    tdbOsFree(aPgno);
+    return 0;
+  }
+
+  tdbDebug("pager/vacuum: %p, size:%d -> %d, free:%d -> %d", pPager, pPager->dbFileSize, size, pPager->nFreePages,
+           nPgno);
+
+  // rebuild the freelist with the pages left, in descending order so that low
+  // pages are handed out first and the tail of the file stays free
+  pPager->dbFileSize = size;
+  pPager->freePage = 0;
+  pPager->nFreePages = 0;
+  pPager->maxFreePgno = 0;
+  pPager->freeDirty = 1;
+  pPager->truncate = 1;
+  for (int i = nPgno - 1; i >= 0; i--) {
+    ret = tdbPagerFreePage(pPager, aPgno[i], pTxn);
+    if (ret < 0) {
+      goto _err;
+    }
+  }
+
+  tdbOsFree(aPgno);
+  return 0;
+
+_err:
+  tdbOsFree(aPgno);
+  return -1;
+}
+
 static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage *, void *, int), void *arg,
                             u8 loadPage) {
   int   ret;
@@ -856,9 +1205,80 @@ static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage) {
     return -1;
   }
 
+  tdbPagerMarkChanged(pPager, TDB_PAGE_PGNO(pPage));
+
   return 0;
 }
 
+static void tdbPagerMarkChanged(SPager *pPager, SPgno pgno) {
+  if (pPager->chgAll) return;
+
+  if (pgno > pPager->nChgBits) {
+    SPgno nBits = pPager->nChgBits ? pPager->nChgBits : 1024;
+    while (nBits < pgno) nBits <<= 1;
+
+    u8 *pBits = tdbOsRealloc(pPager->chgBits, nBits / 8);
+    if (pBits == NULL) {
+      // fall back to a full scan rather than losing the change
+      pPager->chgAll = 1;
+      return;
+    }
+    memset(pBits + pPager->nChgBits / 8, 0, (nBits - pPager->nChgBits) / 8);
+    pPager->chgBits = pBits;
+    pPager->nChgBits = nBits;
+  }
+
+  pPager->chgBits[(pgno - 1) >> 3] |= (u8)(1 << ((pgno - 1) & 7));
+}
+
+int tdbPagerScanChangedPages(SPager *pPager, bool all, tdb_page_fn_t fn, void *arg) {
+  u8 *pageBuf;
+  int ret = 0;
+
+  all = all || pPager->chgAll;
+
+  pageBuf = tdbOsMalloc(pPager->pageSize);
+  if (pageBuf == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (SPgno pgno = 1; pgno <= pPager->dbFileSize; ++pgno) {
+    if (!all) {
+      if (pgno > pPager->nChgBits) break;
+      if ((pPager->chgBits[(pgno - 1) >> 3] & (1 << ((pgno - 1) & 7))) == 0) continue;
+    }
+
+    if (tdbOsPRead(pPager->fd, pageBuf, pPager->pageSize, (i64)pPager->pageSize * (pgno - 1)) < pPager->pageSize) {
+      tdbError("failed to pread page %d due to %s. file:%s", pgno, strerror(errno), pPager->dbFileName);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      ret = -1;
+      break;
+    }
+
+    ret = (*fn)(arg, pgno, pageBuf, pPager->pageSize);
+    if (ret < 0) break;
+  }
+
+  tdbOsFree(pageBuf);
+
+  if (ret < 0) {
+    // the pages handed out may not have been kept, take all as changed next time
+    pPager->chgAll = 1;
+    return -1;
+  }
+
+  tdbPagerClearChangedPages(pPager);
+  return 0;
+}
+
+void tdbPagerClearChangedPages(SPager *pPager) {
+  pPager->chgAll = 0;
+  if (pPager->chgBits) {
+    memset(pPager->chgBits, 0, pPager->nChgBits / 8);
+  }
+}
+
 static int tdbPagerRestore(SPager *pPager, const char *jFileName) {
   int   ret = 0;
   SPgno journalSize = 0;
@@ -898,6 +1318,7 @@ static int tdbPagerRestore(SPager *pPager, const char *jFileName) {
     }
 
     tdbTrace("pager/restore: restore pgno:%d,", pgno);
+    tdbPagerMarkChanged(pPager, pgno);
 
     ret = tdbOsRead(jfd, pageBuf, pPager->pageSize);
     if (ret < 0) {
@@ -196,9 +196,15 @@ int  tdbPagerAbort(SPager *pPager, TXN *pTxn);
 int  tdbPagerFetchPage(SPager *pPager, SPgno *ppgno, SPage **ppPage, int (*initPage)(SPage *, void *, int), void *arg,
                        TXN *pTxn);
 void tdbPagerReturnPage(SPager *pPager, SPage *pPage, TXN *pTxn);
-int  tdbPagerAllocPage(SPager *pPager, SPgno *ppgno);
+int  tdbPagerAllocPage(SPager *pPager, SPgno *ppgno, TXN *pTxn);
+int  tdbPagerFreePage(SPager *pPager, SPgno pgno, TXN *pTxn);
+int  tdbPagerLoadFreeList(SPager *pPager);
+int  tdbPagerSaveFreeList(SPager *pPager, TXN *pTxn);
+int  tdbPagerVacuum(SPager *pPager, TXN *pTxn);
 int  tdbPagerRestoreJournals(SPager *pPager);
 int  tdbPagerRollback(SPager *pPager);
+int  tdbPagerScanChangedPages(SPager *pPager, bool all, tdb_page_fn_t fn, void *arg);
+void tdbPagerClearChangedPages(SPager *pPager);
 
 // tdbPCache.c ====================================
 #define TDB_PCACHE_PAGE    \
@@ -338,7 +344,7 @@ int  tdbPageDestroy(SPage *pPage, void (*xFree)(void *arg, void *ptr), void *arg
 void tdbPageZero(SPage *pPage, u8 szAmHdr, int (*xCellSize)(const SPage *, SCell *, int, TXN *, SBTree *pBt));
 void tdbPageInit(SPage *pPage, u8 szAmHdr, int (*xCellSize)(const SPage *, SCell *, int, TXN *, SBTree *pBt));
 int  tdbPageInsertCell(SPage *pPage, int idx, SCell *pCell, int szCell, u8 asOvfl);
-int  tdbPageDropCell(SPage *pPage, int idx, TXN *pTxn, SBTree *pBt);
+int  tdbPageDropCell(SPage *pPage, int idx, TXN *pTxn, SBTree *pBt, int dropOfp);
 int  tdbPageUpdateCell(SPage *pPage, int idx, SCell *pCell, int szCell, TXN *pTxn, SBTree *pBt);
 void tdbPageCopy(SPage *pFromPage, SPage *pToPage, int copyOvflCells);
 int  tdbPageCapacity(int pageSize, int amHdrSize);
@@ -397,6 +403,14 @@ struct SPager {
   SPCache *pCache;
   SPgno    dbFileSize;
   SPgno    dbOrigSize;
+  SPgno    freePage;     // head trunk page of the freelist, 0 if empty
+  SPgno    nFreePages;   // pages on the freelist, trunk pages included
+  SPgno    maxFreePgno;  // largest pgno freed since the last vacuum, used to skip useless vacuums
+  u8       freeDirty;    // freelist changed since it was saved to the main db
+  u8       truncate;     // file should be truncated to dbFileSize after commit
+  u8       chgAll;       // pages changed since the last scan are unknown, all pages are taken as changed
+  u8      *chgBits;      // bitmap of pages written to the file since the last scan, bit (pgno - 1)
+  SPgno    nChgBits;
   // SPage   *pDirty;
   SRBTree rbt;
   // u8        inTran;
@@ -53,6 +53,7 @@ typedef TdFilePtr tdb_fd_t;
 #define tdbOsWrite                    taosWriteFile
 #define tdbOsPWrite                   taosPWriteFile
 #define tdbOsFSync                    taosFsyncFile
+#define tdbOsFTruncate                taosFtruncateFile
 #define tdbOsLSeek                    taosLSeekFile
 #define tdbDirPtr                     TdDirPtr
 #define tdbDirEntryPtr                TdDirEntryPtr
@@ -83,6 +84,7 @@ typedef TdThreadMutex tdb_mutex_t;
 #define tdbMutexInit    taosThreadMutexInit
 #define tdbMutexDestroy taosThreadMutexDestroy
 #define tdbMutexLock    taosThreadMutexLock
+#define tdbMutexTryLock taosThreadMutexTryLock
 #define tdbMutexUnlock  taosThreadMutexUnlock
 
 #else
@@ -116,9 +118,10 @@ i64 tdbOsRead(tdb_fd_t fd, void *pData, i64 nBytes);
 i64 tdbOsPRead(tdb_fd_t fd, void *pData, i64 nBytes, i64 offset);
 i64 tdbOsWrite(tdb_fd_t fd, const void *pData, i64 nBytes);
 
-#define tdbOsFSync  fsync
-#define tdbOsLSeek  lseek
-#define tdbOsRemove remove
+#define tdbOsFSync     fsync
+#define tdbOsFTruncate ftruncate
+#define tdbOsLSeek     lseek
+#define tdbOsRemove    remove
 #define tdbOsFileSize(FD, PSIZE)
 
 /* directory */
@@ -141,6 +144,7 @@ typedef pthread_mutex_t tdb_mutex_t;
 #define tdbMutexInit    pthread_mutex_init
 #define tdbMutexDestroy pthread_mutex_destroy
 #define tdbMutexLock    pthread_mutex_lock
+#define tdbMutexTryLock pthread_mutex_trylock
 #define tdbMutexUnlock  pthread_mutex_unlock
 
 #endif
@@ -336,6 +336,200 @@ tdbBegin(pEnv, &txn);
   tdbPostCommit(pEnv, txn);
 }
 
+TEST(TdbOVFLPagesTest, TbFreePageReuseTest) {
+  int ret = 0;
+
+  taosRemoveDir("tdb");
+
+  // open Env
+  int const pageSize = 4096;
+  int const pageNum = 64;
+  TDB      *pEnv = openEnv("tdb", pageSize, pageNum);
+  GTEST_ASSERT_NE(pEnv, nullptr);
+
+  // open db
+  TTB          *pDb = NULL;
+  tdb_cmpr_fn_t compFunc = tKeyCmpr;
+  ret = tdbTbOpen("ofp_reuse.db", -1, -1, compFunc, pEnv, &pDb, 0);
+  GTEST_ASSERT_EQ(ret, 0);
+
+  SPoolMem *pPool = openPool();
+
+  char val[((4083 - 4 - 3 - 2) + 1) * 8];
+  int  valLen = sizeof(val) / sizeof(val[0]);
+  generateBigVal(val, valLen);
+
+  int64_t fileSize[3] = {0};
+  for (int round = 0; round < 3; round++) {
+    TXN *txn = NULL;
+    tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+
+    if (round % 2 == 0) {
+      ret = tdbTbInsert(pDb, "key1", strlen("key1"), val, valLen, txn);
+    } else {
+      ret = tdbTbDelete(pDb, "key1", strlen("key1"), txn);
+    }
+    GTEST_ASSERT_EQ(ret, 0);
+
+    GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+    GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+    clearPool(pPool);
+
+    ret = taosStatFile("tdb/main.tdb", &fileSize[round], NULL);
+    GTEST_ASSERT_EQ(ret, 0);
+  }
+
+  // the overflow pages freed by the delete are reused by the second insert
+  GTEST_ASSERT_LE(fileSize[2], fileSize[0]);
+
+  {  // query the data inserted on reused pages
+    void *pVal = NULL;
+    int   vLen;
+
+    ret = tdbTbGet(pDb, "key1", strlen("key1"), &pVal, &vLen);
+    GTEST_ASSERT_EQ(ret, 0);
+    GTEST_ASSERT_EQ(vLen, valLen);
+    GTEST_ASSERT_EQ(memcmp(val, pVal, vLen), 0);
+
+    tdbFree(pVal);
+  }
+
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+  closePool(pPool);
+}
+
+TEST(TdbOVFLPagesTest, TbBigKeyFreePageTest) {
+  int ret = 0;
+
+  taosRemoveDir("tdb");
+
+  // open Env
+  int const pageSize = 4096;
+  int const pageNum = 64;
+  TDB      *pEnv = openEnv("tdb", pageSize, pageNum);
+  GTEST_ASSERT_NE(pEnv, nullptr);
+
+  // open db, the keys are big enough to overflow the divider cells of interior pages as well
+  TTB *pDb = NULL;
+  ret = tdbTbOpen("ofp_bigkey.db", -1, -1, tDefaultKeyCmpr, pEnv, &pDb, 0);
+  GTEST_ASSERT_EQ(ret, 0);
+
+  SPoolMem *pPool = openPool();
+
+  int const nKeys = 200;
+  char      key[2000];
+  int const kLen = sizeof(key);
+  generateBigVal(key, kLen);
+
+  int64_t fileSize[3] = {0};
+  for (int round = 0; round < 3; round++) {
+    TXN *txn = NULL;
+
+    // insert all
+    tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+    for (int i = 0; i < nKeys; i++) {
+      snprintf(key, 16, "%08d", i);
+      ret = tdbTbInsert(pDb, key, kLen, &i, sizeof(i), txn);
+      GTEST_ASSERT_EQ(ret, 0);
+    }
+    GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+    GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+    clearPool(pPool);
+
+    ret = taosStatFile("tdb/main.tdb", &fileSize[round], NULL);
+    GTEST_ASSERT_EQ(ret, 0);
+
+    // delete all
+    tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+    for (int i = 0; i < nKeys; i++) {
+      snprintf(key, 16, "%08d", i);
+      ret = tdbTbDelete(pDb, key, kLen, txn);
+      GTEST_ASSERT_EQ(ret, 0);
+    }
+    GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+    GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+    clearPool(pPool);
+  }
+
+  // the overflow pages of dropped divider cells are freed as well, so no page is leaked by a round
+  GTEST_ASSERT_LE(fileSize[2], fileSize[0]);
+
+  // and the file shrinks back after the last delete
+  int64_t size = 0;
+  ret = taosStatFile("tdb/main.tdb", &size, NULL);
+  GTEST_ASSERT_EQ(ret, 0);
+  GTEST_ASSERT_LT(size, fileSize[0] / 4);
+
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+  closePool(pPool);
+}
+
+TEST(TdbOVFLPagesTest, TbFreeListKeyTest) {
+  int ret = 0;
+
+  taosRemoveDir("tdb");
+
+  int const pageSize = 4096;
+  int const pageNum = 64;
+  TDB      *pEnv = openEnv("tdb", pageSize, pageNum);
+  GTEST_ASSERT_NE(pEnv, nullptr);
+
+  // a table named like the freelist record of old versions
+  TTB *pDb = NULL;
+  ret = tdbTbOpen("__freelist__", -1, -1, tKeyCmpr, pEnv, &pDb, 0);
+  GTEST_ASSERT_EQ(ret, 0);
+
+  SPoolMem *pPool = openPool();
+
+  char val[((4083 - 4 - 3 - 2) + 1) * 8];
+  int  valLen = sizeof(val) / sizeof(val[0]);
+  generateBigVal(val, valLen);
+
+  // free some pages so that the freelist record is saved
+  for (int round = 0; round < 3; round++) {
+    TXN *txn = NULL;
+    tdbBegin(pEnv, &txn, poolMalloc, poolFree, pPool, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+
+    if (round % 2 == 0) {
+      ret = tdbTbInsert(pDb, "key1", strlen("key1"), val, valLen, txn);
+    } else {
+      ret = tdbTbDelete(pDb, "key1", strlen("key1"), txn);
+    }
+    GTEST_ASSERT_EQ(ret, 0);
+
+    GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+    GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+    clearPool(pPool);
+  }
+
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+
+  // reopen, the table root is not overwritten by the freelist record
+  pEnv = openEnv("tdb", pageSize, pageNum);
+  GTEST_ASSERT_NE(pEnv, nullptr);
+  ret = tdbTbOpen("__freelist__", -1, -1, tKeyCmpr, pEnv, &pDb, 0);
+  GTEST_ASSERT_EQ(ret, 0);
+
+  {
+    void *pVal = NULL;
+    int   vLen;
+
+    ret = tdbTbGet(pDb, "key1", strlen("key1"), &pVal, &vLen);
+    GTEST_ASSERT_EQ(ret, 0);
+    GTEST_ASSERT_EQ(vLen, valLen);
+    GTEST_ASSERT_EQ(memcmp(val, pVal, vLen), 0);
+
+    tdbFree(pVal);
+  }
+
+  tdbTbClose(pDb);
+  tdbClose(pEnv);
+  closePool(pPool);
+}
+
 // TEST(tdb_test, DISABLED_simple_insert1) {
 TEST(tdb_test, simple_insert1) {
   int           ret;
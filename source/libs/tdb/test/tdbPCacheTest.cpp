@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#define ALLOW_FORBID_FUNC
+#include "os.h"
+#include "tdbInt.h"
+
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 1024 pages make 16 shards of 64 pages. With a zero file id the shard of a
+// page is pgno % 16, so the multiples of 16 all land in shard 0.
+const int     szPage = 4096;
+const int     nPages = 1024;
+const int     nShard = 16;
+SPager *const pMarker = (SPager *)0x1;
+
+std::atomic<int> nMalloc(0);
+
+void *countingMalloc(void *arg, size_t size) {
+  nMalloc++;
+  return tdbDefaultMalloc(arg, size);
+}
+
+class PCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(tdbPCacheOpen(szPage, nPages, &pCache), 0);
+    memset(&txn, 0, sizeof(txn));
+    nMalloc = 0;
+  }
+
+  void TearDown() override { tdbPCacheClose(pCache); }
+
+  // fetch a page and mark it, a page still carrying the mark is a cache hit
+  SPage *fetch(SPgno pgno, bool *hit = NULL) {
+    SPgid pgid = {0};
+    pgid.pgno = pgno;
+
+    SPage *pPage = tdbPCacheFetch(pCache, &pgid, &txn);
+    if (pPage) {
+      if (hit) *hit = (pPage->pPager == pMarker);
+      pPage->pPager = pMarker;
+    }
+    return pPage;
+  }
+
+  void release(SPage *pPage) { tdbPCacheRelease(pCache, pPage, &txn); }
+
+  bool isCached(SPgno pgno) {
+    bool   hit = false;
+    SPage *pPage = fetch(pgno, &hit);
+    if (pPage) release(pPage);
+    return hit;
+  }
+
+  // pin as many local pages as the cache has, the next fetch must find nothing
+  void checkAllPagesFree(SPgno base) {
+    std::vector<SPage *> aPage;
+    std::vector<bool>    used(nPages, false);
+
+    for (int i = 0; i < nPages; i++) {
+      SPage *pPage = fetch(base + i);
+      ASSERT_NE(pPage, nullptr);
+      ASSERT_TRUE(pPage->isLocal);
+      ASSERT_FALSE(used[pPage->id]);
+      used[pPage->id] = true;
+      aPage.push_back(pPage);
+    }
+    ASSERT_EQ(fetch(base + nPages), nullptr);
+
+    for (SPage *pPage : aPage) {
+      release(pPage);
+    }
+  }
+
+  SPCache *pCache = NULL;
+  TXN      txn;
+};
+
+}  // namespace
+
+TEST_F(PCacheTest, stealAcrossShards) {
+  // shard 0 owns 64 pages, the rest of the pages are stolen from the other shards
+  std::vector<SPage *> aPage;
+  for (int k = 0; k < nPages; k++) {
+    SPage *pPage = fetch(k * nShard);
+    ASSERT_NE(pPage, nullptr);
+    ASSERT_TRUE(pPage->isLocal);
+    aPage.push_back(pPage);
+  }
+
+  // every shard is exhausted, without an allocator the fetch fails
+  ASSERT_EQ(fetch(1), nullptr);
+  ASSERT_EQ(fetch(nPages * nShard), nullptr);
+
+  // with one the page comes from the transaction and is freed on release
+  txn.xMalloc = countingMalloc;
+  txn.xFree = tdbDefaultFree;
+  SPage *pPage = fetch(1);
+  ASSERT_NE(pPage, nullptr);
+  ASSERT_FALSE(pPage->isLocal);
+  ASSERT_EQ(nMalloc, 1);
+  release(pPage);
+  txn.xMalloc = NULL;
+  txn.xFree = NULL;
+
+  for (SPage *pPage : aPage) {
+    release(pPage);
+  }
+
+  // the stolen pages stay cached in shard 0
+  for (int k = 0; k < nPages; k++) {
+    ASSERT_TRUE(isCached(k * nShard));
+  }
+}
+
+TEST_F(PCacheTest, evictAcrossShards) {
+  // a shard recycles its own pages before it steals, so pin them all first
+  std::vector<SPage *> aPage;
+  for (int k = 0; k < nPages; k++) {
+    aPage.push_back(fetch(k * nShard));
+  }
+  for (SPage *pPage : aPage) {
+    release(pPage);
+  }
+
+  // all pages sit in the LRU of shard 0, the other shards recycle its least
+  // recently used ones
+  for (SPgno pgno = 1; pgno < nShard; pgno++) {
+    bool hit = true;
+    release(fetch(pgno, &hit));
+    ASSERT_FALSE(hit);
+  }
+
+  ASSERT_TRUE(isCached((nPages - 1) * nShard));
+  ASSERT_TRUE(isCached((nShard - 1) * nShard));
+  for (SPgno pgno = 1; pgno < nShard; pgno++) {
+    ASSERT_TRUE(isCached(pgno));
+  }
+  for (int k = 0; k < nShard - 1; k++) {
+    ASSERT_FALSE(isCached(k * nShard));
+  }
+
+  checkAllPagesFree(nPages * nShard);
+}
+
+TEST_F(PCacheTest, concurrentFetchRelease) {
+  const int nThread = 8;
+  const int nHeld = 64;
+  const int nLoops = 20000;
+
+  std::atomic<int>         nError(0);
+  std::vector<std::thread> threads;
+
+  txn.xMalloc = countingMalloc;
+  txn.xFree = tdbDefaultFree;
+
+  // most fetches go to shard 0 so it keeps stealing while the others fetch too
+  for (int t = 0; t < nThread; t++) {
+    threads.emplace_back([&, t]() {
+      std::deque<SPage *> held;
+      uint32_t            seed = t + 1;
+
+      for (int i = 0; i < nLoops; i++) {
+        seed = seed * 1103515245 + 12345;
+        SPgno pgno = (seed >> 8) % (4 * nPages);
+        if (seed % 4) pgno = pgno / nShard * nShard;
+
+        SPgid pgid = {0};
+        pgid.pgno = pgno;
+        SPage *pPage = tdbPCacheFetch(pCache, &pgid, &txn);
+        if (pPage == NULL || pPage->pgid.pgno != pgno || tdbGetPageRef(pPage) <= 0) {
+          nError++;
+          continue;
+        }
+
+        held.push_back(pPage);
+        if ((int)held.size() > nHeld) {
+          tdbPCacheRelease(pCache, held.front(), &txn);
+          held.pop_front();
+        }
+      }
+
+      for (SPage *pPage : held) {
+        tdbPCacheRelease(pCache, pPage, &txn);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(nError, 0);
+
+  // no page is lost or left pinned
+  txn.xMalloc = NULL;
+  txn.xFree = NULL;
+  checkAllPagesFree(8 * nPages);
+}
@@ -42,6 +42,9 @@ typedef struct WalIdxEntry {
   int64_t offset;
 } SWalIdxEntry;
 
+// the entries buffered by a group commit are written out once they reach this size
+#define WAL_APPEND_BUF_SIZE (4 * 1024 * 1024)
+
 static inline int tSerializeWalIdxEntry(void** buf, SWalIdxEntry* pIdxEntry) {
   int tlen = 0;
   tlen += taosEncodeFixedI64(buf, pIdxEntry->ver);
@@ -165,6 +168,7 @@ int     walInitWriteFile(SWal* pWal);
 int64_t walGetSeq();
 int     walSeekWriteVer(SWal* pWal, int64_t ver);
 int32_t walRollImpl(SWal* pWal);
+int32_t walFlushAppendBuf(SWal* pWal);
 
 #ifdef __cplusplus
 }
@@ -834,6 +834,10 @@ int walSaveMeta(SWal* pWal) {
   int  n;
 
   // fsync the idx and log file at first to ensure validity of meta
+  if (walFlushAppendBuf(pWal) < 0) {
+    return -1;
+  }
+
   if (taosFsyncFile(pWal->pIdxFile) < 0) {
     wError("vgId:%d, failed to sync idx file due to %s", pWal->cfg.vgId, strerror(errno));
     terrno = TAOS_SYSTEM_ERROR(errno);
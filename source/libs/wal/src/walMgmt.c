@@ -138,6 +138,14 @@ SWal *walOpen(const char *path, SWalCfg *pCfg) {
   pWal->totSize = 0;
   pWal->lastRollSeq = -1;
 
+  // init append buffer of group commit
+  pWal->aAppendIdx = taosArrayInit(64, sizeof(SWalIdxEntry));
+  if (pWal->aAppendIdx == NULL) {
+    wError("vgId:%d, failed to init taosArray of aAppendIdx due to %s. path:%s", pWal->cfg.vgId, strerror(errno),
+           pWal->path);
+    goto _err;
+  }
+
   // init write buffer
   memset(&pWal->writeHead, 0, sizeof(SWalCkHead));
   pWal->writeHead.head.protoVer = WAL_PROTO_VER;
@@ -156,6 +164,8 @@ SWal *walOpen(const char *path, SWalCfg *pCfg) {
     goto _err;
   }
 
+  pWal->syncedVer = pWal->vers.lastVer;
+
   // add ref
   pWal->refId = taosAddRef(tsWal.refSetId, pWal);
   if (pWal->refId < 0) {
@@ -168,6 +178,7 @@ SWal *walOpen(const char *path, SWalCfg *pCfg) {
   return pWal;
 
 _err:
+  taosArrayDestroy(pWal->aAppendIdx);
   taosArrayDestroy(pWal->fileInfoSet);
   taosHashCleanup(pWal->pRefHash);
   taosThreadMutexDestroy(&pWal->mutex);
@@ -205,6 +216,11 @@ int32_t walPersist(SWal *pWal) {
 
 void walClose(SWal *pWal) {
   taosThreadMutexLock(&pWal->mutex);
+  SWalFsyncStat *pStat = &pWal->fsyncStat;
+  wDebug("vgId:%d, wal fsync stat, fsync:%" PRId64 " entries:%" PRId64 " max batch:%" PRId64 " avg latency:%" PRId64
+         "us max latency:%" PRId64 "us",
+         pWal->cfg.vgId, pStat->numOfFsync, pStat->numOfEntry, pStat->maxBatch,
+         pStat->numOfFsync > 0 ? pStat->totalUs / pStat->numOfFsync : 0, pStat->maxUs);
   (void)walSaveMeta(pWal);
   taosCloseFile(&pWal->pLogFile);
   pWal->pLogFile = NULL;
@@ -214,6 +230,9 @@ void walClose(SWal *pWal) {
   pWal->fileInfoSet = NULL;
   taosArrayDestroy(pWal->toDeleteFiles);
   pWal->toDeleteFiles = NULL;
+  taosArrayDestroy(pWal->aAppendIdx);
+  pWal->aAppendIdx = NULL;
+  taosMemoryFreeClear(pWal->pAppendBuf);
 
   void *pIter = NULL;
   while (1) {
@@ -501,6 +501,16 @@ int32_t walReadVer(SWalReader *pReader, int64_t ver) {
     return -1;
   }
 
+  // the entry may still be in the append buffer of a group commit
+  if (taosArrayGetSize(pReader->pWal->aAppendIdx) > 0) {
+    taosThreadMutexLock(&pReader->pWal->mutex);
+    code = walFlushAppendBuf(pReader->pWal);
+    taosThreadMutexUnlock(&pReader->pWal->mutex);
+    if (code < 0) {
+      return -1;
+    }
+  }
+
   taosThreadMutexLock(&pReader->mutex);
 
   if (pReader->curInvalid || pReader->curVersion != ver) {
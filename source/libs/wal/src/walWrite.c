@@ -38,6 +38,8 @@ int32_t walRestoreFromSnapshot(SWal *pWal, int64_t ver) {
 
   taosCloseFile(&pWal->pLogFile);
   taosCloseFile(&pWal->pIdxFile);
+  taosArrayClear(pWal->aAppendIdx);
+  pWal->appendBufLen = 0;
 
   if (pWal->vers.firstVer != -1) {
     int32_t fileSetSize = taosArrayGetSize(pWal->fileInfoSet);
@@ -72,6 +74,7 @@ int32_t walRestoreFromSnapshot(SWal *pWal, int64_t ver) {
   taosArrayClear(pWal->fileInfoSet);
   pWal->vers.firstVer = ver + 1;
   pWal->vers.lastVer = ver;
+  pWal->syncedVer = ver;
   pWal->vers.commitVer = ver;
   pWal->vers.snapshotVer = ver;
   pWal->vers.verInSnapshotting = -1;
@@ -111,6 +114,11 @@ int32_t walRollback(SWal *pWal, int64_t ver) {
     return -1;
   }
 
+  if (walFlushAppendBuf(pWal) < 0) {
+    taosThreadMutexUnlock(&pWal->mutex);
+    return -1;
+  }
+
   // find correct file
   if (ver < walGetLastFileFirstVer(pWal)) {
     // change current files
@@ -215,6 +223,7 @@ int32_t walRollback(SWal *pWal, int64_t ver) {
     return -1;
   }
   pWal->vers.lastVer = ver - 1;
+  pWal->syncedVer = TMIN(pWal->syncedVer, pWal->vers.lastVer);
   if (pWal->vers.lastVer < pWal->vers.firstVer) {
     ASSERT(pWal->vers.lastVer == pWal->vers.firstVer - 1);
   }
@@ -396,8 +405,110 @@ END:
   return code;
 }
 
+static int32_t walDoFsync(SWal *pWal) {
+  if (pWal->pLogFile == NULL) {
+    return 0;
+  }
+
+  int64_t st = taosGetTimestampUs();
+  wTrace("vgId:%d, fileId:%" PRId64 ".log, do fsync", pWal->cfg.vgId, walGetCurFileFirstVer(pWal));
+  if (taosFsyncFile(pWal->pLogFile) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%" PRId64 ".log, fsync failed since %s", pWal->cfg.vgId, walGetCurFileFirstVer(pWal),
+           strerror(errno));
+    return -1;
+  }
+
+  int64_t        elapsed = taosGetTimestampUs() - st;
+  int64_t        numOfEntry = TMAX(pWal->vers.lastVer - pWal->syncedVer, 0);
+  SWalFsyncStat *pStat = &pWal->fsyncStat;
+  pStat->numOfFsync++;
+  pStat->numOfEntry += numOfEntry;
+  pStat->maxBatch = TMAX(pStat->maxBatch, numOfEntry);
+  pStat->totalUs += elapsed;
+  pStat->maxUs = TMAX(pStat->maxUs, elapsed);
+  pWal->syncedVer = pWal->vers.lastVer;
+  return 0;
+}
+
+// Write the log entries buffered by a group commit to the idx and log file in one write each. If either write fails,
+// the buffered entries are dropped and the wal is reverted to the last entry written.
+int32_t walFlushAppendBuf(SWal *pWal) {
+  int32_t nEntry = taosArrayGetSize(pWal->aAppendIdx);
+  if (nEntry == 0) {
+    return 0;
+  }
+
+  SWalFileInfo *pFileInfo = walGetCurFileInfo(pWal);
+  ASSERT(pFileInfo != NULL);
+  int64_t firstVer = ((SWalIdxEntry *)taosArrayGet(pWal->aAppendIdx, 0))->ver;
+  int64_t offset = pFileInfo->fileSize - pWal->appendBufLen;
+  int64_t idxOffset = (firstVer - pFileInfo->firstVer) * sizeof(SWalIdxEntry);
+  int64_t idxSize = nEntry * sizeof(SWalIdxEntry);
+
+  if (taosWriteFile(pWal->pIdxFile, pWal->aAppendIdx->pData, idxSize) != idxSize) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, failed to write idx entries due to %s. ver:%" PRId64 "-%" PRId64, pWal->cfg.vgId,
+           strerror(errno), firstVer, pWal->vers.lastVer);
+    goto _err;
+  }
+
+  if (taosWriteFile(pWal->pLogFile, pWal->pAppendBuf, pWal->appendBufLen) != pWal->appendBufLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%" PRId64 ".log, failed to write since %s. ver:%" PRId64 "-%" PRId64, pWal->cfg.vgId,
+           walGetLastFileFirstVer(pWal), strerror(errno), firstVer, pWal->vers.lastVer);
+    goto _err;
+  }
+
+  taosArrayClear(pWal->aAppendIdx);
+  pWal->appendBufLen = 0;
+  if (pWal->appendBufCap > 2 * WAL_APPEND_BUF_SIZE) {
+    taosMemoryFreeClear(pWal->pAppendBuf);
+    pWal->appendBufCap = 0;
+  }
+  return 0;
+
+_err:
+  // recover in a reverse order
+  if (taosFtruncateFile(pWal->pLogFile, offset) < 0) {
+    wFatal("vgId:%d, failed to ftruncate logfile to offset:%" PRId64 " during recovery due to %s", pWal->cfg.vgId,
+           offset, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    ASSERT(0 && "failed to recover from error");
+  }
+
+  if (taosFtruncateFile(pWal->pIdxFile, idxOffset) < 0) {
+    wFatal("vgId:%d, failed to ftruncate idxfile to offset:%" PRId64 "during recovery due to %s", pWal->cfg.vgId,
+           idxOffset, strerror(errno));
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    ASSERT(0 && "failed to recover from error");
+  }
+
+  pWal->vers.lastVer = firstVer - 1;
+  pWal->totSize -= pWal->appendBufLen;
+  pFileInfo->lastVer = firstVer - 1;
+  pFileInfo->fileSize = offset;
+  taosArrayClear(pWal->aAppendIdx);
+  pWal->appendBufLen = 0;
+  return -1;
+}
+
 int32_t walRollImpl(SWal *pWal) {
   int32_t code = 0;
+
+  // entries of the current file must be written and durable before it is switched out
+  code = walFlushAppendBuf(pWal);
+  if (code != 0) {
+    goto END;
+  }
+  if (pWal->fsyncPending) {
+    code = walDoFsync(pWal);
+    if (code != 0) {
+      goto END;
+    }
+    pWal->fsyncPending = false;
+  }
+
   if (pWal->pIdxFile != NULL) {
     code = taosCloseFile(&pWal->pIdxFile);
     if (code != 0) {
@@ -480,6 +591,33 @@ static int32_t walWriteIndex(SWal *pWal, int64_t ver, int64_t offset) {
   return 0;
 }
 
+static int32_t walAppendToBuf(SWal *pWal, int64_t ver, int64_t offset, const void *body, int32_t bodyLen) {
+  int64_t size = sizeof(SWalCkHead) + bodyLen;
+  if (pWal->appendBufLen + size > pWal->appendBufCap) {
+    int64_t cap = TMAX(pWal->appendBufCap * 2, TMAX(pWal->appendBufLen + size, WAL_APPEND_BUF_SIZE));
+    char   *pBuf = taosMemoryRealloc(pWal->pAppendBuf, cap);
+    if (pBuf == NULL) {
+      terrno = TSDB_CODE_OUT_OF_MEMORY;
+      return -1;
+    }
+    pWal->pAppendBuf = pBuf;
+    pWal->appendBufCap = cap;
+  }
+
+  SWalIdxEntry entry = {.ver = ver, .offset = offset};
+  if (taosArrayPush(pWal->aAppendIdx, &entry) == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  memcpy(pWal->pAppendBuf + pWal->appendBufLen, &pWal->writeHead, sizeof(SWalCkHead));
+  if (bodyLen > 0) {
+    memcpy(pWal->pAppendBuf + pWal->appendBufLen + sizeof(SWalCkHead), body, bodyLen);
+  }
+  pWal->appendBufLen += size;
+  return 0;
+}
+
 static FORCE_INLINE int32_t walWriteImpl(SWal *pWal, int64_t index, tmsg_t msgType, SWalSyncInfo syncMeta,
                                          const void *body, int32_t bodyLen) {
   int64_t code = 0;
@@ -502,25 +640,27 @@ static FORCE_INLINE int32_t walWriteImpl(SWal *pWal, int64_t index, tmsg_t msgTy
   wDebug("vgId:%d, wal write log %" PRId64 ", msgType: %s, cksum head %u cksum body %u", pWal->cfg.vgId, index,
          TMSG_INFO(msgType), pWal->writeHead.cksumHead, pWal->writeHead.cksumBody);
 
-  code = walWriteIndex(pWal, index, offset);
-  if (code < 0) {
-    goto END;
-  }
-
-  if (taosWriteFile(pWal->pLogFile, &pWal->writeHead, sizeof(SWalCkHead)) != sizeof(SWalCkHead)) {
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    wError("vgId:%d, file:%" PRId64 ".log, failed to write since %s", pWal->cfg.vgId, walGetLastFileFirstVer(pWal),
-           strerror(errno));
-    code = -1;
-    goto END;
-  }
+  if (pWal->groupCommit > 0) {
+    // written out with the other entries of the group, nothing is written to the files on failure
+    if (walAppendToBuf(pWal, index, offset, body, bodyLen) < 0) {
+      wError("vgId:%d, failed to buffer log entry since %s. ver:%" PRId64, pWal->cfg.vgId, terrstr(), index);
+      return -1;
+    }
+  } else {
+    code = walWriteIndex(pWal, index, offset);
+    if (code < 0) {
+      goto END;
+    }
 
-  if (taosWriteFile(pWal->pLogFile, (char *)body, bodyLen) != bodyLen) {
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    wError("vgId:%d, file:%" PRId64 ".log, failed to write since %s", pWal->cfg.vgId, walGetLastFileFirstVer(pWal),
-           strerror(errno));
-    code = -1;
-    goto END;
+    // write head and body in one syscall
+    TdFileVec vec[2] = {{.pBuf = &pWal->writeHead, .size = sizeof(SWalCkHead)}, {.pBuf = body, .size = bodyLen}};
+    if (taosWriteVFile(pWal->pLogFile, vec, bodyLen > 0 ? 2 : 1) != sizeof(SWalCkHead) + bodyLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, file:%" PRId64 ".log, failed to write since %s", pWal->cfg.vgId, walGetLastFileFirstVer(pWal),
+             strerror(errno));
+      code = -1;
+      goto END;
+    }
   }
 
   // set status
@@ -533,6 +673,9 @@ static FORCE_INLINE int32_t walWriteImpl(SWal *pWal, int64_t index, tmsg_t msgTy
   pFileInfo->lastVer = index;
   pFileInfo->fileSize += sizeof(SWalCkHead) + bodyLen;
 
+  if (pWal->appendBufLen >= WAL_APPEND_BUF_SIZE) {
+    return walFlushAppendBuf(pWal);
+  }
   return 0;
 
 END:
@@ -634,14 +777,45 @@ int32_t walWrite(SWal *pWal, int64_t index, tmsg_t msgType, const void *body, in
   return walWriteWithSyncInfo(pWal, index, msgType, syncMeta, body, bodyLen);
 }
 
-void walFsync(SWal *pWal, bool forceFsync) {
+int32_t walFsync(SWal *pWal, bool forceFsync) {
+  int32_t code = 0;
+
   taosThreadMutexLock(&pWal->mutex);
   if (forceFsync || (pWal->cfg.level == TAOS_WAL_FSYNC && pWal->cfg.fsyncPeriod == 0)) {
-    wTrace("vgId:%d, fileId:%" PRId64 ".log, do fsync", pWal->cfg.vgId, walGetCurFileFirstVer(pWal));
-    if (taosFsyncFile(pWal->pLogFile) < 0) {
-      wError("vgId:%d, file:%" PRId64 ".log, fsync failed since %s", pWal->cfg.vgId, walGetCurFileFirstVer(pWal),
-             strerror(errno));
+    if (pWal->groupCommit > 0) {
+      pWal->fsyncPending = true;
+    } else {
+      code = walDoFsync(pWal);
+    }
+  }
+  taosThreadMutexUnlock(&pWal->mutex);
+  return code;
+}
+
+void walBeginGroupCommit(SWal *pWal) {
+  taosThreadMutexLock(&pWal->mutex);
+  pWal->groupCommit++;
+  taosThreadMutexUnlock(&pWal->mutex);
+}
+
+int32_t walEndGroupCommit(SWal *pWal) {
+  int32_t code = 0;
+
+  taosThreadMutexLock(&pWal->mutex);
+  ASSERT(pWal->groupCommit > 0);
+  if (--pWal->groupCommit == 0) {
+    code = walFlushAppendBuf(pWal);
+    if (code == 0 && pWal->fsyncPending) {
+      code = walDoFsync(pWal);
     }
+    pWal->fsyncPending = false;
   }
   taosThreadMutexUnlock(&pWal->mutex);
+  return code;
+}
+
+void walGetFsyncStat(SWal *pWal, SWalFsyncStat *pStat) {
+  taosThreadMutexLock(&pWal->mutex);
+  *pStat = pWal->fsyncStat;
+  taosThreadMutexUnlock(&pWal->mutex);
 }
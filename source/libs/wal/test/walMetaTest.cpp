@@ -234,6 +234,94 @@ TEST_F(WalCleanEnv, write) {
   ASSERT_EQ(code, 0);
 }
 
+TEST_F(WalCleanEnv, groupCommit) {
+  int           code;
+  SWalFsyncStat stat = {0};
+
+  walBeginGroupCommit(pWal);
+  for (int i = 0; i < 10; i++) {
+    code = walWrite(pWal, i, i + 1, (void*)ranStr, ranStrLen);
+    ASSERT_EQ(code, 0);
+    ASSERT_EQ(walFsync(pWal, false), 0);
+  }
+  walGetFsyncStat(pWal, &stat);
+  ASSERT_EQ(stat.numOfFsync, 0);
+  ASSERT_EQ(pWal->vers.lastVer, 9);
+
+  // the entries of the group are written out together when it ends
+  ASSERT_EQ(taosLSeekFile(pWal->pLogFile, 0, SEEK_END), 0);
+  ASSERT_EQ(taosLSeekFile(pWal->pIdxFile, 0, SEEK_END), 0);
+  ASSERT_EQ(walEndGroupCommit(pWal), 0);
+  ASSERT_EQ(taosLSeekFile(pWal->pLogFile, 0, SEEK_END), 10 * (sizeof(SWalCkHead) + ranStrLen));
+  ASSERT_EQ(taosLSeekFile(pWal->pIdxFile, 0, SEEK_END), 10 * sizeof(SWalIdxEntry));
+  walGetFsyncStat(pWal, &stat);
+  ASSERT_EQ(stat.numOfFsync, 1);
+  ASSERT_EQ(stat.numOfEntry, 10);
+  ASSERT_EQ(stat.maxBatch, 10);
+
+  code = walWrite(pWal, 10, 11, (void*)ranStr, ranStrLen);
+  ASSERT_EQ(code, 0);
+  ASSERT_EQ(walFsync(pWal, false), 0);
+  walGetFsyncStat(pWal, &stat);
+  ASSERT_EQ(stat.numOfFsync, 2);
+  ASSERT_EQ(stat.numOfEntry, 11);
+  ASSERT_EQ(pWal->vers.lastVer, 10);
+}
+
+TEST_F(WalCleanEnv, groupCommitReadRollRollback) {
+  int           code;
+  SWalFsyncStat stat = {0};
+  SWalReader*   pRead = walOpenReader(pWal, NULL);
+  ASSERT(pRead != NULL);
+
+  walBeginGroupCommit(pWal);
+  for (int i = 0; i < 5; i++) {
+    code = walWrite(pWal, i, i + 1, (void*)ranStr, ranStrLen);
+    ASSERT_EQ(code, 0);
+    ASSERT_EQ(walFsync(pWal, false), 0);
+  }
+
+  // reading an entry of the group writes out the buffered ones
+  ASSERT_EQ(walReadVer(pRead, 3), 0);
+  ASSERT_EQ(pRead->pHead->head.version, 3);
+  ASSERT_EQ(pRead->pHead->head.msgType, 4);
+  ASSERT_EQ(taosArrayGetSize(pWal->aAppendIdx), 0);
+
+  // rolling the file makes the entries of the group durable
+  for (int i = 5; i < 8; i++) {
+    code = walWrite(pWal, i, i + 1, (void*)ranStr, ranStrLen);
+    ASSERT_EQ(code, 0);
+    ASSERT_EQ(walFsync(pWal, false), 0);
+  }
+  ASSERT_EQ(walBeginSnapshot(pWal, 7), 0);
+  ASSERT_EQ(taosArrayGetSize(pWal->fileInfoSet), 2);
+  ASSERT_FALSE(pWal->fsyncPending);
+  walGetFsyncStat(pWal, &stat);
+  ASSERT_EQ(stat.numOfFsync, 1);
+  ASSERT_EQ(stat.numOfEntry, 8);
+
+  // buffered entries can be rolled back
+  for (int i = 8; i < 12; i++) {
+    code = walWrite(pWal, i, i + 1, (void*)ranStr, ranStrLen);
+    ASSERT_EQ(code, 0);
+  }
+  ASSERT_EQ(walRollback(pWal, 10), 0);
+  ASSERT_EQ(pWal->vers.lastVer, 9);
+  code = walWrite(pWal, 10, 100, (void*)ranStr, ranStrLen);
+  ASSERT_EQ(code, 0);
+  ASSERT_EQ(walFsync(pWal, false), 0);
+  ASSERT_EQ(walEndGroupCommit(pWal), 0);
+  walGetFsyncStat(pWal, &stat);
+  ASSERT_EQ(stat.numOfFsync, 2);
+  ASSERT_EQ(stat.numOfEntry, 11);
+
+  ASSERT_EQ(walReadVer(pRead, 10), 0);
+  ASSERT_EQ(pRead->pHead->head.msgType, 100);
+  ASSERT_EQ(walReadVer(pRead, 9), 0);
+  ASSERT_EQ(pRead->pHead->head.msgType, 10);
+  walCloseReader(pRead);
+}
+
 TEST_F(WalCleanEnv, rollback) {
   int code;
   for (int i = 0; i < 10; i++) {
@@ -32,6 +32,7 @@
 #include <sys/sendfile.h>
 #endif
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define LINUX_FILE_NO_TEXT_OPTION 0
 #define O_TEXT                    LINUX_FILE_NO_TEXT_OPTION
@@ -423,6 +424,26 @@ int64_t taosPReadFile(TdFilePtr pFile, void *buf, int64_t count, int64_t offset)
   return ret;
 }
 
+// Ask the kernel to read the range into the page cache asynchronously, the call returns without waiting for the IO.
+int32_t taosPrefetchFile(TdFilePtr pFile, int64_t offset, int64_t count) {
+  if (pFile == NULL || pFile->fd < 0) {
+    return 0;
+  }
+#if defined(WINDOWS)
+  return 0;
+#elif defined(_TD_DARWIN_64)
+  struct radvisory ra = {.ra_offset = offset, .ra_count = (int)TMIN(count, INT32_MAX)};
+  return fcntl(pFile->fd, F_RDADVISE, &ra) == -1 ? -1 : 0;
+#else
+  int32_t code = posix_fadvise(pFile->fd, offset, count, POSIX_FADV_WILLNEED);
+  if (code != 0) {
+    errno = code;
+    return -1;
+  }
+  return 0;
+#endif
+}
+
 int64_t taosWriteFile(TdFilePtr pFile, const void *buf, int64_t count) {
   if (pFile == NULL) {
     return 0;
@@ -459,6 +480,77 @@ int64_t taosWriteFile(TdFilePtr pFile, const void *buf, int64_t count) {
   return count;
 }
 
+// Write several buffers with as few syscalls as possible, return the total bytes written or -1 on error.
+int64_t taosWriteVFile(TdFilePtr pFile, const TdFileVec *pVec, int32_t nVec) {
+  if (pFile == NULL) {
+    return 0;
+  }
+
+  assert(nVec > 0 && nVec <= TD_FILE_MAX_VEC);
+
+#ifdef WINDOWS
+  int64_t count = 0;
+  for (int32_t i = 0; i < nVec; ++i) {
+    if (taosWriteFile(pFile, pVec[i].pBuf, pVec[i].size) != pVec[i].size) {
+      return -1;
+    }
+    count += pVec[i].size;
+  }
+  return count;
+#else
+#if FILE_WITH_LOCK
+  taosThreadRwlockWrlock(&(pFile->rwlock));
+#endif
+  if (pFile->fd < 0) {
+#if FILE_WITH_LOCK
+    taosThreadRwlockUnlock(&(pFile->rwlock));
+#endif
+    return 0;
+  }
+
+  struct iovec iov[TD_FILE_MAX_VEC];
+  int64_t      count = 0;
+  for (int32_t i = 0; i < nVec; ++i) {
+    iov[i].iov_base = (void *)pVec[i].pBuf;
+    iov[i].iov_len = pVec[i].size;
+    count += pVec[i].size;
+  }
+
+  struct iovec *pIov = iov;
+  int32_t       nIov = nVec;
+  int64_t       nleft = count;
+  while (nleft > 0) {
+    int64_t nwritten = writev(pFile->fd, pIov, nIov);
+    if (nwritten < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+#if FILE_WITH_LOCK
+      taosThreadRwlockUnlock(&(pFile->rwlock));
+#endif
+      return -1;
+    }
+
+    // partial write, skip the buffers written
+    nleft -= nwritten;
+    while (nIov > 0 && nwritten >= (int64_t)pIov->iov_len) {
+      nwritten -= pIov->iov_len;
+      pIov++;
+      nIov--;
+    }
+    if (nIov > 0) {
+      pIov->iov_base = (char *)pIov->iov_base + nwritten;
+      pIov->iov_len -= nwritten;
+    }
+  }
+
+#if FILE_WITH_LOCK
+  taosThreadRwlockUnlock(&(pFile->rwlock));
+#endif
+  return count;
+#endif
+}
+
 int64_t taosPWriteFile(TdFilePtr pFile, const void *buf, int64_t count, int64_t offset) {
   if (pFile == NULL) {
     return 0;
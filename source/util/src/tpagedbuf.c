@@ -21,7 +21,8 @@ struct SPageInfo {
   void*      pData;
   int64_t    offset;
   int32_t    pageId;
-  int32_t    length : 29;
+  int32_t    slot;        // size of the area reserved in file, which may be larger than the on disk length
+  int32_t    length : 29;  // on disk size, compressed if pBuf->comp is set
   bool       used : 1;   // set current page is in used
   bool       dirty : 1;  // set current buffer page is dirty or not
 };
@@ -67,52 +68,66 @@ static int32_t createDiskFile(SDiskbasedBuf* pBuf) {
   return TSDB_CODE_SUCCESS;
 }
 
-static char* doCompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {  // do nothing
+// the compressed page is kept in the assistant buffer, which is returned, LZ4 stores the page as it is with one more
+// byte of indicator if it can not be compressed.
+static char* doCompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {
   if (!pBuf->comp) {
     *dst = srcSize;
     return data;
   }
 
   *dst = tsCompressString(data, srcSize, 1, pBuf->assistBuf, srcSize, ONE_STAGE_COMP, NULL, 0);
-
-  memcpy(data, pBuf->assistBuf, *dst);
-  return data;
+  return pBuf->assistBuf;
 }
 
-static char* doDecompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {  // do nothing
+static char* doDecompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {
   if (!pBuf->comp) {
     *dst = srcSize;
     return data;
   }
 
-  *dst = tsDecompressString(data, srcSize, 1, pBuf->assistBuf, pBuf->pageSize, ONE_STAGE_COMP, NULL, 0);
-  if (*dst > 0) {
-    memcpy(data, pBuf->assistBuf, *dst);
-  }
+  memcpy(pBuf->assistBuf, data, srcSize);
+  *dst = tsDecompressString(pBuf->assistBuf, srcSize, 1, data, pBuf->pageSize, ONE_STAGE_COMP, NULL, 0);
   return data;
 }
 
-static uint64_t allocateNewPositionInFile(SDiskbasedBuf* pBuf, size_t size) {
-  if (pBuf->pFree == NULL) {
-    return pBuf->nextPos;
-  } else {
-    int32_t offset = -1;
+// best fit in the free areas of file, or append to the end of file
+static int64_t allocateNewPositionInFile(SDiskbasedBuf* pBuf, int32_t size) {
+  int32_t index = -1;
+  size_t  num = taosArrayGetSize(pBuf->pFree);
+  for (int32_t i = 0; i < num; ++i) {
+    SFreeListItem* pi = taosArrayGet(pBuf->pFree, i);
+    if (pi->length >= size && (index == -1 || pi->length < ((SFreeListItem*)taosArrayGet(pBuf->pFree, index))->length)) {
+      index = i;
+    }
+  }
 
-    size_t num = taosArrayGetSize(pBuf->pFree);
-    for (int32_t i = 0; i < num; ++i) {
-      SFreeListItem* pi = taosArrayGet(pBuf->pFree, i);
-      if (pi->length >= size) {
-        offset = pi->offset;
-        pi->offset += (int32_t)size;
-        pi->length -= (int32_t)size;
+  if (index == -1) {  // no available recycle space, allocate new area in file
+    int64_t offset = pBuf->nextPos;
+    pBuf->nextPos += size;
+    return offset;
+  }
 
-        return offset;
-      }
-    }
+  SFreeListItem* pi = taosArrayGet(pBuf->pFree, index);
+  int64_t        offset = pi->offset;
+  pi->offset += size;
+  pi->length -= size;
+  if (pi->length == 0) {
+    taosArrayRemove(pBuf->pFree, index);
+  }
+
+  pBuf->statis.reuseBytes += size;
+  return offset;
+}
 
-    // no available recycle space, allocate new area in file
-    return pBuf->nextPos;
+static void releasePositionInFile(SDiskbasedBuf* pBuf, int64_t offset, int32_t size) {
+  if (offset + size == pBuf->nextPos) {  // the last area in file, give it back directly
+    pBuf->nextPos = offset;
+    return;
   }
+
+  SFreeListItem item = {.offset = offset, .length = size};
+  taosArrayPush(pBuf->pFree, &item);
 }
 
 /**
@@ -148,7 +163,7 @@ static char* doFlushBufPage(SDiskbasedBuf* pBuf, SPageInfo* pg) {
   if (pg->dirty) {
     if (!HAS_DATA_IN_DISK(pg)) {
       pg->offset = allocateNewPositionInFile(pBuf, size);
-      pBuf->nextPos += size;
+      pg->slot = size;
 
       int32_t ret = taosLSeekFile(pBuf->pFile, pg->offset, SEEK_SET);
       if (ret == -1) {
@@ -168,17 +183,17 @@ static char* doFlushBufPage(SDiskbasedBuf* pBuf, SPageInfo* pg) {
       }
 
       pBuf->statis.flushBytes += size;
+      pBuf->statis.flushRawBytes += pBuf->pageSize;
       pBuf->statis.flushPages += 1;
     } else {
       // length becomes greater, current space is not enough, allocate new place, otherwise, do nothing
-      if (pg->length < size) {
+      if (pg->slot < size) {
         // 1. add current space to free list
-        SPageDiskInfo dinfo = {.length = pg->length, .offset = pg->offset};
-        taosArrayPush(pBuf->pFree, &dinfo);
+        releasePositionInFile(pBuf, pg->offset, pg->slot);
 
         // 2. allocate new position, and update the info
         pg->offset = allocateNewPositionInFile(pBuf, size);
-        pBuf->nextPos += size;
+        pg->slot = size;
       }
 
       // 3. write to disk.
@@ -199,6 +214,7 @@ static char* doFlushBufPage(SDiskbasedBuf* pBuf, SPageInfo* pg) {
       }
 
       pBuf->statis.flushBytes += size;
+      pBuf->statis.flushRawBytes += pBuf->pageSize;
       pBuf->statis.flushPages += 1;
     }
   } else {  // NOTE: the size may be -1, the this recycle page has not been flushed to disk yet.
@@ -258,6 +274,11 @@ static int32_t loadPageFromDisk(SDiskbasedBuf* pBuf, SPageInfo* pg) {
 
   int32_t fullSize = 0;
   doDecompressData(pPage, pg->length, &fullSize, pBuf);
+  if (fullSize != pBuf->pageSize) {
+    uError("failed to decompress buf page:%d, length:%d, size:%d, %s", pg->pageId, pg->length, fullSize, pBuf->id);
+    return TSDB_CODE_INVALID_PARA;
+  }
+
   return 0;
 }
 
@@ -273,6 +294,7 @@ static SPageInfo* registerNewPageInfo(SDiskbasedBuf* pBuf, int32_t pageId) {
   ppi->pageId = pageId;
   ppi->pData = NULL;
   ppi->offset = -1;
+  ppi->slot = 0;
   ppi->length = -1;
   ppi->used = true;
   ppi->pn = NULL;
@@ -351,6 +373,7 @@ int32_t createDiskbasedBuf(SDiskbasedBuf** pBuf, int32_t pagesize, int32_t inMem
   pPBuf->pFile = NULL;
   pPBuf->id = strdup(id);
   pPBuf->fileSize = 0;
+  pPBuf->comp = true;
   pPBuf->pFree = taosArrayInit(4, sizeof(SFreeListItem));
   pPBuf->freePgList = tdListNew(POINTER_BYTES);
 
@@ -372,7 +395,7 @@ int32_t createDiskbasedBuf(SDiskbasedBuf** pBuf, int32_t pagesize, int32_t inMem
     goto _error;
   }
 
-  pPBuf->assistBuf = taosMemoryMalloc(pPBuf->pageSize + 2);  // EXTRA BYTES
+  pPBuf->assistBuf = taosMemoryMalloc(getAllocPageSize(pPBuf->pageSize));  // EXTRA BYTES
   if (pPBuf->assistBuf == NULL) {
     goto _error;
   }
@@ -651,6 +674,14 @@ void dBufSetBufPageRecycled(SDiskbasedBuf* pBuf, void* pPage) {
   ppi->used = false;
   ppi->dirty = false;
 
+  // the content is not needed any more, give back the space in file
+  if (HAS_DATA_IN_DISK(ppi)) {
+    releasePositionInFile(pBuf, ppi->offset, ppi->slot);
+    ppi->offset = -1;
+    ppi->slot = 0;
+    ppi->length = -1;
+  }
+
   // add this pageinfo into the free page info list
   SListNode* pNode = tdListPopNode(pBuf->lruList, ppi->pn);
   taosMemoryFreeClear(ppi->pData);
@@ -685,6 +716,12 @@ void dBufPrintStatis(const SDiskbasedBuf* pBuf) {
         "Kb\n",
         ps->getPages, ps->releasePages, ps->flushBytes / 1024.0f, ps->flushPages, ps->loadBytes / 1024.0f,
         ps->loadPages, ps->loadBytes / (1024.0 * ps->loadPages));
+  }
+
+  if (ps->flushPages > 0) {
+    printf("flushToDisk raw:%.2f Kb, compress ratio:%.2f%%, reuse file space:%.2f Kb, file size:%.2f Kb\n",
+           ps->flushRawBytes / 1024.0, ps->flushBytes * 100.0 / ps->flushRawBytes, ps->reuseBytes / 1024.0,
+           pBuf->fileSize / 1024.0);
   } else {
     //printf("no page loaded\n");
   }
@@ -708,6 +745,8 @@ void clearDiskbasedBuf(SDiskbasedBuf* pBuf) {
 
   taosHashClear(pBuf->all);
 
+  pBuf->nextPos = 0;
+
   pBuf->numOfPages = 0;  // all pages are in buffer in the first place
   pBuf->totalBufSize = 0;
   pBuf->allocateId = -1;
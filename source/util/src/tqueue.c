@@ -21,6 +21,71 @@
 int64_t tsRpcQueueMemoryAllowed = 0;
 int64_t tsRpcQueueMemoryUsed = 0;
 
+#define QSET_MIN_SPINS 16
+#define QSET_MAX_SPINS 1024
+
+static void taosQueuePush(STaosQueue *queue, STaosQnode *pNode) {
+  pNode->next = NULL;
+  STaosQnode *prev = atomic_exchange_ptr(&queue->tail, pNode);
+  atomic_store_ptr(&prev->next, pNode);
+}
+
+// a writer may have swapped the tail but not linked it yet, wait for it
+static STaosQnode *taosQueueNext(STaosQueue *queue, STaosQnode *pNode) {
+  STaosQnode *next = atomic_load_ptr(&pNode->next);
+  while (next == NULL && pNode != atomic_load_ptr(&queue->tail)) {
+    sched_yield();
+    next = atomic_load_ptr(&pNode->next);
+  }
+  return next;
+}
+
+// should be called with queue->mutex locked, return NULL if the queue is empty
+static STaosQnode *taosQueuePop(STaosQueue *queue) {
+  STaosQnode *pNode = queue->head;
+  STaosQnode *next = taosQueueNext(queue, pNode);
+
+  if (pNode == queue->stub) {
+    if (next == NULL) return NULL;
+    queue->head = next;
+    pNode = next;
+    next = taosQueueNext(queue, pNode);
+  }
+
+  if (next == NULL) {
+    // the last node, put the stub behind it so that it can be taken out
+    taosQueuePush(queue, queue->stub);
+    next = taosQueueNext(queue, pNode);
+  }
+
+  queue->head = next;
+  return pNode;
+}
+
+// take all the nodes out and link them in order, return the number of nodes
+static int32_t taosQueuePopAll(STaosQueue *queue, STaosQnode **ppStart, int64_t *pSize) {
+  STaosQnode *pStart = NULL;
+  STaosQnode *pLast = NULL;
+  STaosQnode *pNode = NULL;
+  int32_t     numOfItems = 0;
+
+  *pSize = 0;
+  while ((pNode = taosQueuePop(queue)) != NULL) {
+    if (pLast) {
+      pLast->next = pNode;
+    } else {
+      pStart = pNode;
+    }
+    pLast = pNode;
+    *pSize += pNode->size;
+    numOfItems++;
+  }
+  if (pLast) pLast->next = NULL;
+
+  *ppStart = pStart;
+  return numOfItems;
+}
+
 STaosQueue *taosOpenQueue() {
   STaosQueue *queue = taosMemoryCalloc(1, sizeof(STaosQueue));
   if (queue == NULL) {
@@ -28,7 +93,18 @@ STaosQueue *taosOpenQueue() {
     return NULL;
   }
 
+  queue->stub = taosMemoryCalloc(1, sizeof(STaosQnode));
+  if (queue->stub == NULL) {
+    taosMemoryFree(queue);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+  queue->head = queue->stub;
+  queue->tail = queue->stub;
+
   if (taosThreadMutexInit(&queue->mutex, NULL) != 0) {
+    taosMemoryFree(queue->stub);
+    taosMemoryFree(queue);
     terrno = TSDB_CODE_OUT_OF_MEMORY;
     return NULL;
   }
@@ -46,18 +122,17 @@ void taosSetQueueFp(STaosQueue *queue, FItem itemFp, FItems itemsFp) {
 void taosCloseQueue(STaosQueue *queue) {
   if (queue == NULL) return;
   STaosQnode *pTemp;
-  STaosQset  *qset;
-
-  taosThreadMutexLock(&queue->mutex);
-  STaosQnode *pNode = queue->head;
-  queue->head = NULL;
-  qset = queue->qset;
-  taosThreadMutexUnlock(&queue->mutex);
+  STaosQnode *pNode;
+  int64_t     size;
 
   if (queue->qset) {
-    taosRemoveFromQset(qset, queue);
+    taosRemoveFromQset(queue->qset, queue);
   }
 
+  taosThreadMutexLock(&queue->mutex);
+  taosQueuePopAll(queue, &pNode, &size);
+  taosThreadMutexUnlock(&queue->mutex);
+
   while (pNode) {
     pTemp = pNode;
     pNode = pNode->next;
@@ -65,6 +140,7 @@ void taosCloseQueue(STaosQueue *queue) {
   }
 
   taosThreadMutexDestroy(&queue->mutex);
+  taosMemoryFree(queue->stub);
   taosMemoryFree(queue);
 
   uDebug("queue:%p is closed", queue);
@@ -73,41 +149,24 @@ void taosCloseQueue(STaosQueue *queue) {
 bool taosQueueEmpty(STaosQueue *queue) {
   if (queue == NULL) return true;
 
-  bool empty = false;
-  taosThreadMutexLock(&queue->mutex);
-  if (queue->head == NULL && queue->tail == NULL && queue->numOfItems == 0 && queue->memOfItems == 0) {
-    empty = true;
-  }
-  taosThreadMutexUnlock(&queue->mutex);
-
-  return empty;
+  return atomic_load_32(&queue->numOfItems) == 0 && atomic_load_64(&queue->memOfItems) == 0;
 }
 
 void taosUpdateItemSize(STaosQueue *queue, int32_t items) {
   if (queue == NULL) return;
 
-  taosThreadMutexLock(&queue->mutex);
-  queue->numOfItems -= items;
-  taosThreadMutexUnlock(&queue->mutex);
+  atomic_sub_fetch_32(&queue->numOfItems, items);
 }
 
 int32_t taosQueueItemSize(STaosQueue *queue) {
   if (queue == NULL) return 0;
 
-  taosThreadMutexLock(&queue->mutex);
-  int32_t numOfItems = queue->numOfItems;
-  taosThreadMutexUnlock(&queue->mutex);
-
-  uTrace("queue:%p, numOfItems:%d memOfItems:%" PRId64, queue, queue->numOfItems, queue->memOfItems);
+  int32_t numOfItems = atomic_load_32(&queue->numOfItems);
+  uTrace("queue:%p, numOfItems:%d memOfItems:%" PRId64, queue, numOfItems, atomic_load_64(&queue->memOfItems));
   return numOfItems;
 }
 
-int64_t taosQueueMemorySize(STaosQueue *queue) {
-  taosThreadMutexLock(&queue->mutex);
-  int64_t memOfItems = queue->memOfItems;
-  taosThreadMutexUnlock(&queue->mutex);
-  return memOfItems;
-}
+int64_t taosQueueMemorySize(STaosQueue *queue) { return atomic_load_64(&queue->memOfItems); }
 
 void *taosAllocateQitem(int32_t size, EQItype itype, int64_t dataSize) {
   STaosQnode *pNode = taosMemoryCalloc(1, sizeof(STaosQnode) + size);
@@ -155,47 +214,35 @@ void taosFreeQitem(void *pItem) {
 
 void taosWriteQitem(STaosQueue *queue, void *pItem) {
   STaosQnode *pNode = (STaosQnode *)(((char *)pItem) - sizeof(STaosQnode));
-  pNode->next = NULL;
-
-  taosThreadMutexLock(&queue->mutex);
-
-  if (queue->tail) {
-    queue->tail->next = pNode;
-    queue->tail = pNode;
-  } else {
-    queue->head = pNode;
-    queue->tail = pNode;
-  }
 
-  queue->numOfItems++;
-  queue->memOfItems += pNode->size;
-  if (queue->qset) atomic_add_fetch_32(&queue->qset->numOfItems, 1);
-  uTrace("item:%p is put into queue:%p, items:%d mem:%" PRId64, pItem, queue, queue->numOfItems, queue->memOfItems);
+  // count the item before it is visible, so that the counters never go negative. The qset is loaded after the queue
+  // counter, so an item is counted either by taosAddIntoQset or here, and never lost by both.
+  int32_t    numOfItems = atomic_add_fetch_32(&queue->numOfItems, 1);
+  int64_t    memOfItems = atomic_add_fetch_64(&queue->memOfItems, pNode->size);
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset) atomic_add_fetch_32(&qset->numOfItems, 1);
 
-  taosThreadMutexUnlock(&queue->mutex);
+  taosQueuePush(queue, pNode);
+  uTrace("item:%p is put into queue:%p, items:%d mem:%" PRId64, pItem, queue, numOfItems, memOfItems);
 
-  if (queue->qset) tsem_post(&queue->qset->sem);
+  if (qset && atomic_load_32(&qset->numOfWaits) > 0) tsem_post(&qset->sem);
 }
 
 int32_t taosReadQitem(STaosQueue *queue, void **ppItem) {
   STaosQnode *pNode = NULL;
   int32_t     code = 0;
 
+  // the counters are updated under the lock, so that taosAddIntoQset and taosRemoveFromQset see them settled
   taosThreadMutexLock(&queue->mutex);
-
-  if (queue->head) {
-    pNode = queue->head;
+  pNode = taosQueuePop(queue);
+  if (pNode) {
     *ppItem = pNode->item;
-    queue->head = pNode->next;
-    if (queue->head == NULL) queue->tail = NULL;
-    queue->numOfItems--;
-    queue->memOfItems -= pNode->size;
+    int32_t numOfItems = atomic_sub_fetch_32(&queue->numOfItems, 1);
+    int64_t memOfItems = atomic_sub_fetch_64(&queue->memOfItems, pNode->size);
     if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, 1);
     code = 1;
-    uTrace("item:%p is read out from queue:%p, items:%d mem:%" PRId64, *ppItem, queue, queue->numOfItems,
-           queue->memOfItems);
+    uTrace("item:%p is read out from queue:%p, items:%d mem:%" PRId64, *ppItem, queue, numOfItems, memOfItems);
   }
-
   taosThreadMutexUnlock(&queue->mutex);
 
   return code;
@@ -212,36 +259,27 @@ STaosQall *taosAllocateQall() {
 void taosFreeQall(STaosQall *qall) { taosMemoryFree(qall); }
 
 int32_t taosReadAllQitems(STaosQueue *queue, STaosQall *qall) {
-  int32_t numOfItems = 0;
-  bool    empty;
+  STaosQnode *pStart = NULL;
+  int64_t     size = 0;
+  int32_t     numOfItems = 0;
 
   taosThreadMutexLock(&queue->mutex);
+  numOfItems = taosQueuePopAll(queue, &pStart, &size);
 
-  empty = queue->head == NULL;
-  if (!empty) {
-    memset(qall, 0, sizeof(STaosQall));
-    qall->current = queue->head;
-    qall->start = queue->head;
-    qall->numOfItems = queue->numOfItems;
-    numOfItems = qall->numOfItems;
-
-    queue->head = NULL;
-    queue->tail = NULL;
-    queue->numOfItems = 0;
-    queue->memOfItems = 0;
-    uTrace("read %d items from queue:%p, items:%d mem:%" PRId64, numOfItems, queue, queue->numOfItems,
-           queue->memOfItems);
-    if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, qall->numOfItems);
+  // if source queue is empty, we set destination qall to empty too.
+  memset(qall, 0, sizeof(STaosQall));
+  if (numOfItems > 0) {
+    qall->current = pStart;
+    qall->start = pStart;
+    qall->numOfItems = numOfItems;
+
+    int32_t items = atomic_sub_fetch_32(&queue->numOfItems, numOfItems);
+    int64_t mem = atomic_sub_fetch_64(&queue->memOfItems, size);
+    if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, numOfItems);
+    uTrace("read %d items from queue:%p, items:%d mem:%" PRId64, numOfItems, queue, items, mem);
   }
-
   taosThreadMutexUnlock(&queue->mutex);
 
-  // if source queue is empty, we set destination qall to empty too.
-  if (empty) {
-    qall->current = NULL;
-    qall->start = NULL;
-    qall->numOfItems = 0;
-  }
   return numOfItems;
 }
 
@@ -272,6 +310,7 @@ STaosQset *taosOpenQset() {
 
   taosThreadMutexInit(&qset->mutex, NULL);
   tsem_init(&qset->sem, 0, 0);
+  qset->numOfSpins = QSET_MIN_SPINS;
 
   uDebug("qset:%p is opened", qset);
   return qset;
@@ -297,11 +336,11 @@ void taosCloseQset(STaosQset *qset) {
   uDebug("qset:%p is closed", qset);
 }
 
-// tsem_post 'qset->sem', so that reader threads waiting for it
-// resumes execution and return, should only be used to signal the
-// thread to exit.
+// let one reader thread of the qset return with no item at its next wait, even if items are left in the qset,
+// should only be used to signal the thread to exit.
 void taosQsetThreadResume(STaosQset *qset) {
   uDebug("qset:%p, it will exit", qset);
+  atomic_add_fetch_32(&qset->numOfResumes, 1);
   tsem_post(&qset->sem);
 }
 
@@ -315,9 +354,11 @@ int32_t taosAddIntoQset(STaosQset *qset, STaosQueue *queue, void *ahandle) {
   qset->head = queue;
   qset->numOfQueues++;
 
+  // readers of the queue are kept out while its items are counted, and the qset is set before the count is read,
+  // see taosWriteQitem
   taosThreadMutexLock(&queue->mutex);
-  atomic_add_fetch_32(&qset->numOfItems, queue->numOfItems);
-  queue->qset = qset;
+  atomic_store_ptr(&queue->qset, qset);
+  atomic_add_fetch_32(&qset->numOfItems, atomic_load_32(&queue->numOfItems));
   taosThreadMutexUnlock(&queue->mutex);
 
   taosThreadMutexUnlock(&qset->mutex);
@@ -355,10 +396,10 @@ void taosRemoveFromQset(STaosQset *qset, STaosQueue *queue) {
       qset->numOfQueues--;
 
       taosThreadMutexLock(&queue->mutex);
-      atomic_sub_fetch_32(&qset->numOfItems, queue->numOfItems);
-      queue->qset = NULL;
-      queue->next = NULL;
+      atomic_store_ptr(&queue->qset, NULL);
+      atomic_sub_fetch_32(&qset->numOfItems, atomic_load_32(&queue->numOfItems));
       taosThreadMutexUnlock(&queue->mutex);
+      queue->next = NULL;
     }
   }
 
@@ -367,93 +408,137 @@ void taosRemoveFromQset(STaosQset *qset, STaosQueue *queue) {
   uDebug("queue:%p is removed from qset:%p", queue, qset);
 }
 
+static bool taosQsetTakeResume(STaosQset *qset) {
+  int32_t numOfResumes = atomic_load_32(&qset->numOfResumes);
+  while (numOfResumes > 0) {
+    int32_t old = atomic_val_compare_exchange_32(&qset->numOfResumes, numOfResumes, numOfResumes - 1);
+    if (old == numOfResumes) return true;
+    numOfResumes = old;
+  }
+  return false;
+}
+
+/*
+ * Wait until there are items in the qset, return false if the reader is resumed to exit, which is checked ahead of
+ * the items so that a busy qset does not keep the reader. The reader spins for a while before parking on the
+ * semaphore, and the times to spin grow when spinning finds items and shrink otherwise.
+ */
+static bool taosQsetWait(STaosQset *qset) {
+  if (taosQsetTakeResume(qset)) return false;
+
+  int32_t numOfSpins = atomic_load_32(&qset->numOfSpins);
+  for (int32_t i = 0; i < numOfSpins; ++i) {
+    if (atomic_load_32(&qset->numOfItems) > 0) {
+      if (i > 0) atomic_store_32(&qset->numOfSpins, TMIN(numOfSpins * 2, QSET_MAX_SPINS));
+      return true;
+    }
+    if (atomic_load_32(&qset->numOfResumes) > 0) break;
+    sched_yield();
+  }
+  atomic_store_32(&qset->numOfSpins, TMAX(numOfSpins / 2, QSET_MIN_SPINS));
+
+  while (1) {
+    // writers post the semaphore only if a reader is waiting, so count the reader before checking items again
+    atomic_add_fetch_32(&qset->numOfWaits, 1);
+    if (taosQsetTakeResume(qset)) {
+      atomic_sub_fetch_32(&qset->numOfWaits, 1);
+      return false;
+    }
+    if (atomic_load_32(&qset->numOfItems) > 0) {
+      atomic_sub_fetch_32(&qset->numOfWaits, 1);
+      return true;
+    }
+
+    tsem_wait(&qset->sem);
+    atomic_sub_fetch_32(&qset->numOfWaits, 1);
+    if (taosQsetTakeResume(qset)) return false;
+    if (atomic_load_32(&qset->numOfItems) > 0) return true;
+  }
+}
+
 int32_t taosReadQitemFromQset(STaosQset *qset, void **ppItem, SQueueInfo *qinfo) {
   STaosQnode *pNode = NULL;
   int32_t     code = 0;
 
-  tsem_wait(&qset->sem);
+  while (code == 0) {
+    if (!taosQsetWait(qset)) break;
 
-  taosThreadMutexLock(&qset->mutex);
+    taosThreadMutexLock(&qset->mutex);
+
+    for (int32_t i = 0; i < qset->numOfQueues; ++i) {
+      if (qset->current == NULL) qset->current = qset->head;
+      STaosQueue *queue = qset->current;
+      if (queue) qset->current = queue->next;
+      if (queue == NULL) break;
+      if (atomic_load_32(&queue->numOfItems) == 0) continue;
+
+      taosThreadMutexLock(&queue->mutex);
+      pNode = taosQueuePop(queue);
+      taosThreadMutexUnlock(&queue->mutex);
 
-  for (int32_t i = 0; i < qset->numOfQueues; ++i) {
-    if (qset->current == NULL) qset->current = qset->head;
-    STaosQueue *queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
-
-    taosThreadMutexLock(&queue->mutex);
-
-    if (queue->head) {
-      pNode = queue->head;
-      *ppItem = pNode->item;
-      qinfo->ahandle = queue->ahandle;
-      qinfo->fp = queue->itemFp;
-      qinfo->queue = queue;
-      qinfo->timestamp = pNode->timestamp;
-
-      queue->head = pNode->next;
-      if (queue->head == NULL) queue->tail = NULL;
-      // queue->numOfItems--;
-      queue->memOfItems -= pNode->size;
-      atomic_sub_fetch_32(&qset->numOfItems, 1);
-      code = 1;
-      uTrace("item:%p is read out from queue:%p, items:%d mem:%" PRId64, *ppItem, queue, queue->numOfItems - 1,
-             queue->memOfItems);
+      if (pNode) {
+        *ppItem = pNode->item;
+        qinfo->ahandle = queue->ahandle;
+        qinfo->fp = queue->itemFp;
+        qinfo->queue = queue;
+        qinfo->timestamp = pNode->timestamp;
+
+        // queue->numOfItems is decreased by taosUpdateItemSize after the item is processed
+        int64_t memOfItems = atomic_sub_fetch_64(&queue->memOfItems, pNode->size);
+        atomic_sub_fetch_32(&qset->numOfItems, 1);
+        code = 1;
+        uTrace("item:%p is read out from queue:%p, items:%d mem:%" PRId64, *ppItem, queue,
+               atomic_load_32(&queue->numOfItems) - 1, memOfItems);
+        break;
+      }
     }
 
-    taosThreadMutexUnlock(&queue->mutex);
-    if (pNode) break;
+    taosThreadMutexUnlock(&qset->mutex);
   }
 
-  taosThreadMutexUnlock(&qset->mutex);
-
   return code;
 }
 
 int32_t taosReadAllQitemsFromQset(STaosQset *qset, STaosQall *qall, SQueueInfo *qinfo) {
-  STaosQueue *queue;
+  STaosQnode *pStart = NULL;
+  int64_t     size = 0;
   int32_t     code = 0;
 
-  tsem_wait(&qset->sem);
-  taosThreadMutexLock(&qset->mutex);
+  while (code == 0) {
+    if (!taosQsetWait(qset)) break;
+
+    taosThreadMutexLock(&qset->mutex);
+
+    for (int32_t i = 0; i < qset->numOfQueues; ++i) {
+      if (qset->current == NULL) qset->current = qset->head;
+      STaosQueue *queue = qset->current;
+      if (queue) qset->current = queue->next;
+      if (queue == NULL) break;
+      if (atomic_load_32(&queue->numOfItems) == 0) continue;
 
-  for (int32_t i = 0; i < qset->numOfQueues; ++i) {
-    if (qset->current == NULL) qset->current = qset->head;
-    queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
-
-    taosThreadMutexLock(&queue->mutex);
-
-    if (queue->head) {
-      qall->current = queue->head;
-      qall->start = queue->head;
-      qall->numOfItems = queue->numOfItems;
-      code = qall->numOfItems;
-      qinfo->ahandle = queue->ahandle;
-      qinfo->fp = queue->itemsFp;
-      qinfo->queue = queue;
-
-      queue->head = NULL;
-      queue->tail = NULL;
-      // queue->numOfItems = 0;
-      queue->memOfItems = 0;
-      uTrace("read %d items from queue:%p, items:0 mem:%" PRId64, code, queue, queue->memOfItems);
-
-      atomic_sub_fetch_32(&qset->numOfItems, qall->numOfItems);
-      for (int32_t j = 1; j < qall->numOfItems; ++j) {
-        tsem_wait(&qset->sem);
+      taosThreadMutexLock(&queue->mutex);
+      code = taosQueuePopAll(queue, &pStart, &size);
+      taosThreadMutexUnlock(&queue->mutex);
+
+      if (code > 0) {
+        qall->current = pStart;
+        qall->start = pStart;
+        qall->numOfItems = code;
+        qinfo->ahandle = queue->ahandle;
+        qinfo->fp = queue->itemsFp;
+        qinfo->queue = queue;
+
+        // queue->numOfItems is decreased by taosUpdateItemSize after the items are processed
+        int64_t memOfItems = atomic_sub_fetch_64(&queue->memOfItems, size);
+        atomic_sub_fetch_32(&qset->numOfItems, code);
+        uTrace("read %d items from queue:%p, mem:%" PRId64, code, queue, memOfItems);
+        break;
       }
     }
 
-    taosThreadMutexUnlock(&queue->mutex);
-
-    if (code != 0) break;
+    taosThreadMutexUnlock(&qset->mutex);
   }
 
-  taosThreadMutexUnlock(&qset->mutex);
   return code;
 }
 
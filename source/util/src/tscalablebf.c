@@ -49,7 +49,12 @@ int32_t tScalableBfPut(SScalableBf *pSBf, const void *keyBuf, uint32_t len) {
       return TSDB_CODE_FAILED;
     }
   }
+  return tScalableBfPutNoCheck(pSBf, keyBuf, len);
+}
 
+// put a key known to be absent, skipping the probe of the older filters
+int32_t tScalableBfPutNoCheck(SScalableBf *pSBf, const void *keyBuf, uint32_t len) {
+  int32_t       size = taosArrayGetSize(pSBf->bfArray);
   SBloomFilter *pNormalBf = taosArrayGetP(pSBf->bfArray, size - 1);
   ASSERT(pNormalBf);
   if (tBloomFilterIsFull(pNormalBf)) {
@@ -38,6 +38,8 @@ void *taosInitScheduler(int32_t queueSize, int32_t numOfThreads, const char *lab
     schedMalloced = true;
   }
 
+  // the scheduler may be initialized again after cleaned up
+  pSched->numOfThreads = 0;
   pSched->queue = (SSchedMsg *)taosMemoryCalloc(sizeof(SSchedMsg), queueSize);
   if (pSched->queue == NULL) {
     uError("%s: no enough memory for queue", label);
@@ -185,6 +187,11 @@ int taosScheduleTask(void *queueScheduler, SSchedMsg *pMsg) {
     return -1;
   }
 
+  if (pSched->queue == NULL) {
+    uError("sched is not initialized, msg:%p is dropped", pMsg);
+    return -1;
+  }
+
   if ((ret = tsem_wait(&pSched->emptySem)) != 0) {
     uFatal("wait %s emptySem failed(%s)", pSched->label, strerror(errno));
     ASSERT(0);
@@ -241,8 +248,8 @@ void taosCleanUpScheduler(void *param) {
     pSched->pTimer = NULL;
   }
 
-  if (pSched->queue) taosMemoryFree(pSched->queue);
-  if (pSched->qthread) taosMemoryFree(pSched->qthread);
+  taosMemoryFreeClear(pSched->queue);
+  taosMemoryFreeClear(pSched->qthread);
   // taosMemoryFree(pSched);
 }
 
@@ -0,0 +1,6 @@
+char version[64] = "3.0.2.4";
+char compatible_version[12] = "3.0.0.0";
+char gitinfo[48] = "d059ef86652b7139cce12f3c59e7a3729d58c168";
+char buildinfo[64] = "Built at 2026-10-18 01:40:40";
+
+void libtaos_3_0_2_4_Linux_x64_stable() {};
@@ -157,6 +157,60 @@ void recyclePageTest() {
 
   destroyDiskbasedBuf(pBuf);
 }
+
+void compressedPageTest() {
+  SDiskbasedBuf* pBuf = NULL;
+  int32_t        ret = createDiskbasedBuf(&pBuf, 1024, 4 * 1024, "1", TD_TMP_DIR_PATH);
+  ASSERT_EQ(ret, 0);
+
+  int32_t numOfPages = 20;
+  int32_t pageId = 0;
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    SFilePage* pBufPage = static_cast<SFilePage*>(getNewBufPage(pBuf, &pageId));
+    ASSERT_TRUE(pBufPage != NULL);
+    ASSERT_EQ(pageId, i);
+
+    pBufPage->num = i;
+    for (int32_t j = 0; j < 100; ++j) {
+      ((int32_t*)pBufPage->data)[j] = i * 100 + j;
+    }
+    setBufPageDirty(pBufPage, true);
+    releaseBufPage(pBuf, pBufPage);
+  }
+
+  // the evicted pages are compressed when flushed to disk
+  SDiskbasedBufStatis st = getDBufStatis(pBuf);
+  ASSERT_GT(st.flushPages, 0);
+  ASSERT_LT(st.flushBytes, st.flushRawBytes);
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    SFilePage* pBufPage = static_cast<SFilePage*>(getBufPage(pBuf, i));
+    ASSERT_TRUE(pBufPage != NULL);
+    ASSERT_EQ(pBufPage->num, i);
+    for (int32_t j = 0; j < 100; ++j) {
+      ASSERT_EQ(((int32_t*)pBufPage->data)[j], i * 100 + j);
+    }
+    releaseBufPage(pBuf, pBufPage);
+  }
+
+  // the file space of recycled pages is reused by the new pages
+  for (int32_t i = 0; i < 4; ++i) {
+    dBufSetBufPageRecycled(pBuf, getBufPage(pBuf, i));
+  }
+
+  for (int32_t i = 0; i < 8; ++i) {
+    SFilePage* pBufPage = static_cast<SFilePage*>(getNewBufPage(pBuf, &pageId));
+    ASSERT_TRUE(pBufPage != NULL);
+    memset(pBufPage->data, i, 100);
+    setBufPageDirty(pBufPage, true);
+    releaseBufPage(pBuf, pBufPage);
+  }
+
+  st = getDBufStatis(pBuf);
+  ASSERT_GT(st.reuseBytes, 0);
+
+  destroyDiskbasedBuf(pBuf);
+}
 }  // namespace
 
 TEST(testCase, resultBufferTest) {
@@ -164,6 +218,7 @@ TEST(testCase, resultBufferTest) {
   simpleTest();
   writeDownTest();
   recyclePageTest();
+  compressedPageTest();
 }
 
 #pragma GCC diagnostic pop
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "tqueue.h"
+#include "tworker.h"
+
+namespace {
+
+typedef struct {
+  int32_t producer;
+  int32_t seq;
+} SQueueTestItem;
+
+const int32_t numOfProducers = 8;
+const int32_t numOfItemsEach = 20000;
+
+void writeItems(STaosQueue *queue, int32_t producer, int32_t num, int32_t start = 0) {
+  for (int32_t i = start; i < start + num; ++i) {
+    SQueueTestItem *pItem = (SQueueTestItem *)taosAllocateQitem(sizeof(SQueueTestItem), DEF_QITEM, 0);
+    ASSERT_NE(pItem, nullptr);
+    pItem->producer = producer;
+    pItem->seq = i;
+    taosWriteQitem(queue, pItem);
+  }
+}
+
+// items of each producer come out in the order they are written
+void checkItem(SQueueTestItem *pItem, std::vector<int32_t> &next) {
+  ASSERT_GE(pItem->producer, 0);
+  ASSERT_LT(pItem->producer, numOfProducers);
+  ASSERT_EQ(pItem->seq, next[pItem->producer]);
+  next[pItem->producer]++;
+}
+
+void waitUntilParked(STaosQset *qset, int32_t numOfWaits) {
+  while (atomic_load_32(&qset->numOfWaits) < numOfWaits) {
+    taosMsleep(1);
+  }
+}
+
+}  // namespace
+
+TEST(queueTest, multiProducerRead) {
+  STaosQueue *queue = taosOpenQueue();
+  ASSERT_NE(queue, nullptr);
+
+  std::vector<std::thread> producers;
+  for (int32_t p = 0; p < numOfProducers; ++p) {
+    producers.emplace_back(writeItems, queue, p, numOfItemsEach, 0);
+  }
+
+  // read while the producers are writing
+  std::vector<int32_t> next(numOfProducers, 0);
+  int32_t              numOfRead = 0;
+  while (numOfRead < numOfProducers * numOfItemsEach) {
+    SQueueTestItem *pItem = NULL;
+    if (taosReadQitem(queue, (void **)&pItem) == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    checkItem(pItem, next);
+    taosFreeQitem(pItem);
+    numOfRead++;
+  }
+
+  for (auto &t : producers) t.join();
+  for (int32_t p = 0; p < numOfProducers; ++p) {
+    ASSERT_EQ(next[p], numOfItemsEach);
+  }
+
+  SQueueTestItem *pItem = NULL;
+  ASSERT_EQ(taosReadQitem(queue, (void **)&pItem), 0);
+  ASSERT_EQ(taosQueueItemSize(queue), 0);
+  ASSERT_EQ(taosQueueMemorySize(queue), 0);
+  ASSERT_TRUE(taosQueueEmpty(queue));
+
+  taosCloseQueue(queue);
+}
+
+TEST(queueTest, multiProducerReadAll) {
+  STaosQueue *queue = taosOpenQueue();
+  STaosQall  *qall = taosAllocateQall();
+  ASSERT_NE(queue, nullptr);
+  ASSERT_NE(qall, nullptr);
+
+  std::vector<std::thread> producers;
+  for (int32_t p = 0; p < numOfProducers; ++p) {
+    producers.emplace_back(writeItems, queue, p, numOfItemsEach, 0);
+  }
+
+  std::vector<int32_t> next(numOfProducers, 0);
+  int32_t              numOfRead = 0;
+  while (numOfRead < numOfProducers * numOfItemsEach) {
+    int32_t numOfItems = taosReadAllQitems(queue, qall);
+    ASSERT_EQ(numOfItems, taosQallItemSize(qall));
+
+    SQueueTestItem *pItem = NULL;
+    for (int32_t i = 0; i < numOfItems; ++i) {
+      ASSERT_EQ(taosGetQitem(qall, (void **)&pItem), 1);
+      checkItem(pItem, next);
+      taosFreeQitem(pItem);
+    }
+    ASSERT_EQ(taosGetQitem(qall, (void **)&pItem), 0);
+    numOfRead += numOfItems;
+  }
+
+  for (auto &t : producers) t.join();
+  ASSERT_EQ(taosReadAllQitems(queue, qall), 0);
+  ASSERT_EQ(taosQueueItemSize(queue), 0);
+  ASSERT_EQ(taosQueueMemorySize(queue), 0);
+
+  taosFreeQall(qall);
+  taosCloseQueue(queue);
+}
+
+TEST(queueTest, qsetWaitAndWake) {
+  STaosQset  *qset = taosOpenQset();
+  STaosQueue *queue1 = taosOpenQueue();
+  STaosQueue *queue2 = taosOpenQueue();
+  int32_t     handle1 = 1, handle2 = 2;
+
+  // items written before the queue is added are counted by the qset
+  writeItems(queue1, 0, 3);
+  ASSERT_EQ(taosAddIntoQset(qset, queue1, &handle1), 0);
+  ASSERT_EQ(taosAddIntoQset(qset, queue2, &handle2), 0);
+  ASSERT_EQ(taosAddIntoQset(qset, queue2, &handle2), -1);
+  ASSERT_EQ(taosGetQueueNumber(qset), 2);
+  ASSERT_EQ(atomic_load_32(&qset->numOfItems), 3);
+
+  SQueueInfo      qinfo = {0};
+  SQueueTestItem *pItem = NULL;
+  for (int32_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(taosReadQitemFromQset(qset, (void **)&pItem, &qinfo), 1);
+    ASSERT_EQ(qinfo.ahandle, &handle1);
+    ASSERT_EQ(pItem->seq, i);
+    taosFreeQitem(pItem);
+    taosUpdateItemSize((STaosQueue *)qinfo.queue, 1);
+  }
+  ASSERT_EQ(atomic_load_32(&qset->numOfItems), 0);
+
+  // a reader parked on the empty qset is woken by a writer of any queue in it
+  std::atomic<int32_t> numOfRead(0);
+  std::thread          reader([&]() {
+    SQueueInfo      info = {0};
+    SQueueTestItem *pRead = NULL;
+    while (numOfRead < numOfItemsEach) {
+      if (taosReadQitemFromQset(qset, (void **)&pRead, &info) == 0) break;
+      EXPECT_EQ(info.ahandle, &handle2);
+      EXPECT_EQ(pRead->seq, numOfRead.load());
+      taosFreeQitem(pRead);
+      taosUpdateItemSize((STaosQueue *)info.queue, 1);
+      numOfRead++;
+    }
+  });
+
+  waitUntilParked(qset, 1);
+  writeItems(queue2, 0, 1);
+  while (numOfRead < 1) taosMsleep(1);
+
+  // and keeps up with a writer after being woken
+  writeItems(queue2, 0, numOfItemsEach - 1, 1);
+  reader.join();
+  ASSERT_EQ(numOfRead, numOfItemsEach);
+  ASSERT_EQ(atomic_load_32(&qset->numOfItems), 0);
+
+  // the items of a removed queue are no longer counted by the qset
+  writeItems(queue1, 0, 5);
+  ASSERT_EQ(atomic_load_32(&qset->numOfItems), 5);
+  taosRemoveFromQset(qset, queue1);
+  ASSERT_EQ(taosGetQueueNumber(qset), 1);
+  ASSERT_EQ(atomic_load_32(&qset->numOfItems), 0);
+
+  taosCloseQueue(queue1);
+  taosCloseQueue(queue2);
+  taosCloseQset(qset);
+}
+
+TEST(queueTest, qsetResume) {
+  STaosQset  *qset = taosOpenQset();
+  STaosQueue *queue = taosOpenQueue();
+  int32_t     handle = 1;
+  ASSERT_EQ(taosAddIntoQset(qset, queue, &handle), 0);
+
+  // a parked reader returns with no item
+  int32_t     code = -1;
+  std::thread reader([&]() {
+    SQueueInfo qinfo = {0};
+    void      *pItem = NULL;
+    code = taosReadQitemFromQset(qset, &pItem, &qinfo);
+  });
+  waitUntilParked(qset, 1);
+  taosQsetThreadResume(qset);
+  reader.join();
+  ASSERT_EQ(code, 0);
+
+  // a resumed reader returns at its next wait even if items are left, and only one reader is resumed each time
+  writeItems(queue, 0, 10);
+  taosQsetThreadResume(qset);
+
+  SQueueInfo      qinfo = {0};
+  SQueueTestItem *pItem = NULL;
+  ASSERT_EQ(taosReadQitemFromQset(qset, (void **)&pItem, &qinfo), 0);
+  ASSERT_EQ(taosReadQitemFromQset(qset, (void **)&pItem, &qinfo), 1);
+  ASSERT_EQ(pItem->seq, 0);
+  taosFreeQitem(pItem);
+  taosUpdateItemSize(queue, 1);
+
+  taosCloseQueue(queue);
+  taosCloseQset(qset);
+}
+
+namespace {
+
+std::atomic<int32_t> numOfProcessed(0);
+
+void slowItemFp(SQueueInfo *pInfo, void *pItem) {
+  taosMsleep(2);
+  numOfProcessed++;
+  taosFreeQitem(pItem);
+}
+
+}  // namespace
+
+TEST(queueTest, workerCleanupStops) {
+  SQWorkerPool pool = {0};
+  pool.name = "queueTest";
+  pool.min = 2;
+  pool.max = 2;
+  ASSERT_EQ(tQWorkerInit(&pool), 0);
+
+  STaosQueue *queue = tQWorkerAllocQueue(&pool, NULL, slowItemFp);
+  ASSERT_NE(queue, nullptr);
+
+  const int32_t numOfItems = 2000;
+  writeItems(queue, 0, numOfItems);
+  while (numOfProcessed < 10) taosMsleep(1);
+
+  // the workers exit after the items in hand instead of draining the queue, which frees the rest
+  int64_t start = taosGetTimestampMs();
+  tQWorkerCleanup(&pool);
+  ASSERT_LT(taosGetTimestampMs() - start, 1000);
+  ASSERT_LT(numOfProcessed, numOfItems);
+
+  tQWorkerFreeQueue(&pool, queue);
+}
@@ -0,0 +1,397 @@
+// test taos_stmt_execute_a, the batches are pipelined and the callbacks are checked against the rows written
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "taos.h"
+#include "taoserror.h"
+
+#define PRINT_ERROR   printf("\033[31m");
+#define PRINT_SUCCESS printf("\033[32m");
+
+#define NUM_OF_TABLES  4
+#define ROWS_PER_BATCH 100
+#define START_TS       1626006833639
+
+typedef struct {
+  pthread_mutex_t lock;
+  int32_t         numOfDone;
+  int32_t         numOfFailed;
+  int32_t         lastCode;
+  int64_t         affectedRows;
+  TAOS_STMT      *closeStmt;  // closed by the callback of the closeAt-th batch
+  int32_t         closeAt;
+  int32_t         closed;
+} SAsyncCtx;
+
+void checkCode(int code, const char *api) {
+  if (code != 0) {
+    PRINT_ERROR
+    printf("failed to execute %s. code:0x%x\n", api, code);
+    exit(EXIT_FAILURE);
+  }
+}
+
+void execute_simple_sql(TAOS *taos, char *sql) {
+  TAOS_RES *result = taos_query(taos, sql);
+  if (result == NULL || taos_errno(result) != 0) {
+    PRINT_ERROR
+    printf("failed to %s, Reason: %s\n", sql, taos_errstr(result));
+    taos_free_result(result);
+    exit(EXIT_FAILURE);
+  }
+  taos_free_result(result);
+}
+
+// check count(*) and sum(c0) of a table
+void check_rows(TAOS *taos, const char *tbname, int64_t count, int64_t sum) {
+  char sql[256] = {0};
+  sprintf(sql, "select count(*), sum(c0) from %s", tbname);
+  TAOS_RES *result = taos_query(taos, sql);
+  if (result == NULL || taos_errno(result) != 0) {
+    PRINT_ERROR
+    printf("failed to %s, Reason: %s\n", sql, taos_errstr(result));
+    exit(EXIT_FAILURE);
+  }
+
+  TAOS_ROW row = taos_fetch_row(result);
+  if (row == NULL || *(int64_t *)row[0] != count || (count > 0 && *(int64_t *)row[1] != sum)) {
+    PRINT_ERROR
+    printf("%s: %" PRId64 " rows, sum %" PRId64 " expected\n", sql, count, sum);
+    exit(EXIT_FAILURE);
+  }
+  taos_free_result(result);
+  PRINT_SUCCESS
+  printf("%s: %" PRId64 " rows, sum %" PRId64 "\n", sql, count, sum);
+}
+
+void execCb(void *param, TAOS_RES *res, int code) {
+  SAsyncCtx *pCtx = (SAsyncCtx *)param;
+
+  pthread_mutex_lock(&pCtx->lock);
+  if (code != 0) {
+    pCtx->numOfFailed++;
+    pCtx->lastCode = code;
+  } else {
+    pCtx->affectedRows += taos_affected_rows(res);
+  }
+  int32_t numOfDone = ++pCtx->numOfDone;
+  pthread_mutex_unlock(&pCtx->lock);
+
+  // the stmt is released before the callback, so it can be closed here
+  if (pCtx->closeStmt && numOfDone == pCtx->closeAt) {
+    taos_stmt_close(pCtx->closeStmt);
+    __atomic_store_n(&pCtx->closed, 1, __ATOMIC_SEQ_CST);
+  }
+}
+
+void waitDone(SAsyncCtx *pCtx, int32_t numOfBatches) {
+  for (int32_t i = 0; i < 60 * 1000; ++i) {
+    pthread_mutex_lock(&pCtx->lock);
+    int32_t numOfDone = pCtx->numOfDone;
+    pthread_mutex_unlock(&pCtx->lock);
+    if (numOfDone >= numOfBatches) return;
+    usleep(1000);
+  }
+
+  PRINT_ERROR
+  printf("%d of %d batches are responded in 60s\n", pCtx->numOfDone, numOfBatches);
+  exit(EXIT_FAILURE);
+}
+
+// bind ROWS_PER_BATCH rows of the batch, the values are the row numbers of all batches
+void bindBatch(TAOS_STMT *stmt, int32_t batch) {
+  int64_t         ts[ROWS_PER_BATCH];
+  int32_t         c0[ROWS_PER_BATCH];
+  TAOS_MULTI_BIND params[2] = {0};
+
+  for (int32_t i = 0; i < ROWS_PER_BATCH; ++i) {
+    ts[i] = START_TS + batch * ROWS_PER_BATCH + i;
+    c0[i] = batch * ROWS_PER_BATCH + i;
+  }
+
+  params[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  params[0].buffer_length = sizeof(int64_t);
+  params[0].buffer = ts;
+  params[0].num = ROWS_PER_BATCH;
+  params[1].buffer_type = TSDB_DATA_TYPE_INT;
+  params[1].buffer_length = sizeof(int32_t);
+  params[1].buffer = c0;
+  params[1].num = ROWS_PER_BATCH;
+
+  checkCode(taos_stmt_bind_param_batch(stmt, params), "taos_stmt_bind_param_batch");
+  checkCode(taos_stmt_add_batch(stmt), "taos_stmt_add_batch");
+}
+
+int64_t sumOfBatches(int32_t numOfBatches, int32_t table) {
+  int64_t sum = 0;
+  for (int32_t b = table; b < numOfBatches; b += NUM_OF_TABLES) {
+    for (int32_t i = 0; i < ROWS_PER_BATCH; ++i) sum += b * ROWS_PER_BATCH + i;
+  }
+  return sum;
+}
+
+void initCtx(SAsyncCtx *pCtx) {
+  memset(pCtx, 0, sizeof(SAsyncCtx));
+  pthread_mutex_init(&pCtx->lock, NULL);
+}
+
+// batches of the child tables are pipelined, with more batches than the in-flight window
+void test_pipeline(TAOS *taos) {
+  const int32_t numOfBatches = 200;
+  SAsyncCtx     ctx;
+  initCtx(&ctx);
+
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  checkCode(taos_stmt_prepare(stmt, "insert into ? values(?,?)", 0), "taos_stmt_prepare");
+  for (int32_t b = 0; b < numOfBatches; ++b) {
+    char tbname[32];
+    sprintf(tbname, "t%d", b % NUM_OF_TABLES);
+    checkCode(taos_stmt_set_tbname(stmt, tbname), "taos_stmt_set_tbname");
+    bindBatch(stmt, b);
+    checkCode(taos_stmt_execute_a(stmt, execCb, &ctx), "taos_stmt_execute_a");
+  }
+  waitDone(&ctx, numOfBatches);
+
+  if (ctx.numOfFailed != 0 || ctx.affectedRows != numOfBatches * ROWS_PER_BATCH ||
+      taos_stmt_affected_rows(stmt) != numOfBatches * ROWS_PER_BATCH) {
+    PRINT_ERROR
+    printf("pipeline: %d batches failed, last code:0x%x, %" PRId64 " rows affected\n", ctx.numOfFailed, ctx.lastCode,
+           ctx.affectedRows);
+    exit(EXIT_FAILURE);
+  }
+  taos_stmt_close(stmt);
+
+  for (int32_t t = 0; t < NUM_OF_TABLES; ++t) {
+    char tbname[32];
+    sprintf(tbname, "t%d", t);
+    check_rows(taos, tbname, numOfBatches / NUM_OF_TABLES * ROWS_PER_BATCH, sumOfBatches(numOfBatches, t));
+  }
+  pthread_mutex_destroy(&ctx.lock);
+}
+
+// a batch creating its table is responded before the next bind, which needs the uid of the table
+void test_auto_create(TAOS *taos) {
+  const int32_t numOfBatches = 20;
+  SAsyncCtx     ctx;
+  initCtx(&ctx);
+
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  checkCode(taos_stmt_prepare(stmt, "insert into ? using st tags(?) values(?,?)", 0), "taos_stmt_prepare");
+  for (int32_t b = 0; b < numOfBatches; ++b) {
+    char            tbname[32];
+    int32_t         tag = b % NUM_OF_TABLES;
+    TAOS_MULTI_BIND tags = {0};
+    sprintf(tbname, "ct%d", tag);
+    tags.buffer_type = TSDB_DATA_TYPE_INT;
+    tags.buffer_length = sizeof(int32_t);
+    tags.buffer = &tag;
+    tags.num = 1;
+    checkCode(taos_stmt_set_tbname_tags(stmt, tbname, &tags), "taos_stmt_set_tbname_tags");
+    bindBatch(stmt, b);
+    checkCode(taos_stmt_execute_a(stmt, execCb, &ctx), "taos_stmt_execute_a");
+  }
+  waitDone(&ctx, numOfBatches);
+  taos_stmt_close(stmt);
+
+  if (ctx.numOfFailed != 0 || ctx.affectedRows != numOfBatches * ROWS_PER_BATCH) {
+    PRINT_ERROR
+    printf("auto create: %d batches failed, last code:0x%x\n", ctx.numOfFailed, ctx.lastCode);
+    exit(EXIT_FAILURE);
+  }
+  for (int32_t t = 0; t < NUM_OF_TABLES; ++t) {
+    char tbname[32];
+    sprintf(tbname, "ct%d", t);
+    check_rows(taos, tbname, numOfBatches / NUM_OF_TABLES * ROWS_PER_BATCH, sumOfBatches(numOfBatches, t));
+  }
+  pthread_mutex_destroy(&ctx.lock);
+}
+
+// the callback of the last batch closes the stmt
+void test_close_in_callback(TAOS *taos) {
+  const int32_t numOfBatches = 10;
+  SAsyncCtx     ctx;
+  initCtx(&ctx);
+
+  execute_simple_sql(taos, "create table tc using st tags(100)");
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  ctx.closeStmt = stmt;
+  ctx.closeAt = numOfBatches;
+  checkCode(taos_stmt_prepare(stmt, "insert into tc values(?,?)", 0), "taos_stmt_prepare");
+  for (int32_t b = 0; b < numOfBatches; ++b) {
+    bindBatch(stmt, b);
+    checkCode(taos_stmt_execute_a(stmt, execCb, &ctx), "taos_stmt_execute_a");
+  }
+  waitDone(&ctx, numOfBatches);
+  for (int32_t i = 0; i < 10 * 1000 && !__atomic_load_n(&ctx.closed, __ATOMIC_SEQ_CST); ++i) {
+    usleep(1000);
+  }
+  if (!__atomic_load_n(&ctx.closed, __ATOMIC_SEQ_CST) || ctx.numOfFailed != 0) {
+    PRINT_ERROR
+    printf("close in callback: closed:%d, %d batches failed\n", ctx.closed, ctx.numOfFailed);
+    exit(EXIT_FAILURE);
+  }
+  int64_t numOfRows = numOfBatches * ROWS_PER_BATCH;
+  check_rows(taos, "tc", numOfRows, numOfRows * (numOfRows - 1) / 2);
+  pthread_mutex_destroy(&ctx.lock);
+}
+
+// a batch failed for the stale meta of a recreated table is retried after the stmt is prepared again
+void test_stale_meta(TAOS *taos) {
+  SAsyncCtx ctx;
+  initCtx(&ctx);
+
+  execute_simple_sql(taos, "create table ts0 using st tags(200)");
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  checkCode(taos_stmt_prepare(stmt, "insert into ts0 values(?,?)", 0), "taos_stmt_prepare");
+  bindBatch(stmt, 0);
+  checkCode(taos_stmt_execute_a(stmt, execCb, &ctx), "taos_stmt_execute_a");
+  waitDone(&ctx, 1);
+
+  execute_simple_sql(taos, "drop table ts0");
+  execute_simple_sql(taos, "create table ts0 using st tags(201)");
+
+  bindBatch(stmt, 1);
+  checkCode(taos_stmt_execute_a(stmt, execCb, &ctx), "taos_stmt_execute_a");
+  waitDone(&ctx, 2);
+  PRINT_SUCCESS
+  printf("batch of the recreated table: %d failed, code:0x%x\n", ctx.numOfFailed, ctx.lastCode);
+  if (ctx.numOfFailed > 0 && ctx.lastCode != TSDB_CODE_NEED_RETRY) {
+    PRINT_ERROR
+    printf("stale meta: code 0x%x, 0x%x expected\n", ctx.lastCode, TSDB_CODE_NEED_RETRY);
+    exit(EXIT_FAILURE);
+  }
+
+  // the meta is refreshed by the prepare
+  int32_t numOfFailed = ctx.numOfFailed;
+  checkCode(taos_stmt_prepare(stmt, "insert into ts0 values(?,?)", 0), "taos_stmt_prepare");
+  bindBatch(stmt, 2);
+  checkCode(taos_stmt_execute_a(stmt, execCb, &ctx), "taos_stmt_execute_a");
+  waitDone(&ctx, 3);
+  taos_stmt_close(stmt);
+  if (ctx.numOfFailed != numOfFailed) {
+    PRINT_ERROR
+    printf("stale meta: retry failed, code:0x%x\n", ctx.lastCode);
+    exit(EXIT_FAILURE);
+  }
+  check_rows(taos, "ts0", (numOfFailed ? 1 : 2) * ROWS_PER_BATCH,
+             sumOfBatches(3, 2) + (numOfFailed ? 0 : sumOfBatches(2, 1)));
+  pthread_mutex_destroy(&ctx.lock);
+}
+
+typedef struct {
+  SAsyncCtx *pCtx;
+  TAOS_STMT *stmt;
+  int32_t    numOfBatches;  // batches executed by the callback
+  int32_t    busyCode;
+  int32_t    done;
+} SReentrantCtx;
+
+// the callback of the first batch executes the next ones until the in-flight window is full
+void reentrantCb(void *param, TAOS_RES *res, int code) {
+  SReentrantCtx *pRCtx = (SReentrantCtx *)param;
+  execCb(pRCtx->pCtx, res, code);
+
+  for (int32_t b = 1; b < 100; ++b) {
+    bindBatch(pRCtx->stmt, b);
+    int32_t execCode = taos_stmt_execute_a(pRCtx->stmt, execCb, pRCtx->pCtx);
+    if (execCode != 0) {
+      pRCtx->busyCode = execCode;
+      break;
+    }
+    pRCtx->numOfBatches++;
+  }
+  __atomic_store_n(&pRCtx->done, 1, __ATOMIC_SEQ_CST);
+}
+
+// a callback does not block on the full in-flight window, the batch it bound is executed later
+void test_exec_in_callback(TAOS *taos) {
+  SAsyncCtx     ctx;
+  SReentrantCtx rctx = {0};
+  initCtx(&ctx);
+
+  execute_simple_sql(taos, "create table tr using st tags(300)");
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  rctx.pCtx = &ctx;
+  rctx.stmt = stmt;
+  checkCode(taos_stmt_prepare(stmt, "insert into tr values(?,?)", 0), "taos_stmt_prepare");
+  bindBatch(stmt, 0);
+  checkCode(taos_stmt_execute_a(stmt, reentrantCb, &rctx), "taos_stmt_execute_a");
+  for (int32_t i = 0; i < 60 * 1000 && !__atomic_load_n(&rctx.done, __ATOMIC_SEQ_CST); ++i) {
+    usleep(1000);
+  }
+  if (!__atomic_load_n(&rctx.done, __ATOMIC_SEQ_CST) || rctx.busyCode != TSDB_CODE_TSC_STMT_BUSY) {
+    PRINT_ERROR
+    printf("exec in callback: done:%d, code:0x%x, 0x%x expected\n", rctx.done, rctx.busyCode, TSDB_CODE_TSC_STMT_BUSY);
+    exit(EXIT_FAILURE);
+  }
+  waitDone(&ctx, 1 + rctx.numOfBatches);
+
+  // the batch refused in the callback is still bound
+  checkCode(taos_stmt_execute(stmt), "taos_stmt_execute");
+  taos_stmt_close(stmt);
+  if (ctx.numOfFailed != 0) {
+    PRINT_ERROR
+    printf("exec in callback: %d batches failed, last code:0x%x\n", ctx.numOfFailed, ctx.lastCode);
+    exit(EXIT_FAILURE);
+  }
+  int64_t numOfRows = (rctx.numOfBatches + 2) * ROWS_PER_BATCH;
+  check_rows(taos, "tr", numOfRows, numOfRows * (numOfRows - 1) / 2);
+  pthread_mutex_destroy(&ctx.lock);
+}
+
+// queries are not executed asynchronously
+void test_query(TAOS *taos) {
+  TAOS_STMT      *stmt = taos_stmt_init(taos);
+  int32_t         v = 0;
+  TAOS_MULTI_BIND param = {0};
+  param.buffer_type = TSDB_DATA_TYPE_INT;
+  param.buffer_length = sizeof(int32_t);
+  param.buffer = &v;
+  param.num = 1;
+
+  checkCode(taos_stmt_prepare(stmt, "select * from st where c0 > ?", 0), "taos_stmt_prepare");
+  checkCode(taos_stmt_bind_param(stmt, &param), "taos_stmt_bind_param");
+  checkCode(taos_stmt_add_batch(stmt), "taos_stmt_add_batch");
+  if (taos_stmt_execute_a(stmt, execCb, NULL) == 0) {
+    PRINT_ERROR
+    printf("taos_stmt_execute_a of a query should fail\n");
+    exit(EXIT_FAILURE);
+  }
+  taos_stmt_close(stmt);
+}
+
+int main(int argc, char *argv[]) {
+  TAOS *taos = taos_connect("127.0.0.1", "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    PRINT_ERROR
+    printf("TDengine error: failed to connect\n");
+    exit(EXIT_FAILURE);
+  }
+
+  execute_simple_sql(taos, "drop database if exists stmt_async");
+  execute_simple_sql(taos, "create database stmt_async");
+  execute_simple_sql(taos, "use stmt_async");
+  execute_simple_sql(taos, "create table st (ts timestamp, c0 int) tags (t0 int)");
+  for (int32_t t = 0; t < NUM_OF_TABLES; ++t) {
+    char sql[128];
+    sprintf(sql, "create table t%d using st tags(%d)", t, t);
+    execute_simple_sql(taos, sql);
+  }
+
+  test_pipeline(taos);
+  test_auto_create(taos);
+  test_close_in_callback(taos);
+  test_stale_meta(taos);
+  test_exec_in_callback(taos);
+  test_query(taos);
+
+  taos_close(taos);
+  taos_cleanup();
+  PRINT_SUCCESS
+  printf("all stmt async tests passed\n");
+  return 0;
+}
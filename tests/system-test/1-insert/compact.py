@@ -0,0 +1,108 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    # compact a file set as soon as it has 2 stt files, so most commits below are followed by a compaction
+    updatecfgDict = {'tsdbCompactSttTrigger': 2}
+
+    def init(self, conn, logSql, replicaVar=1):
+        self.replicaVar = int(replicaVar)
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor())
+        self.dbname = 'db'
+        self.stbname = 'stb'
+        self.ntbname = 'ntb'
+        self.tbnum = 4
+        self.rowNum = 100
+        self.rounds = 6
+        self.ts = 1537146000000
+        self.rows = {}
+
+    def tables(self):
+        return [f'ct{i}' for i in range(self.tbnum)] + [self.ntbname]
+
+    def insert_round(self, r):
+        for tbname in self.tables():
+            values = ''
+            for i in range(self.rowNum):
+                ts = self.ts + r * self.rowNum + i
+                values += f'({ts},{r * 1000 + i})'
+                self.rows[tbname][ts] = r * 1000 + i
+            # update rows written by the previous rounds, so the merged rows of compaction are checked as well
+            if r > 0:
+                for i in range(10):
+                    ts = self.ts + (r - 1) * self.rowNum + i
+                    values += f'({ts},{-r * 1000 - i})'
+                    self.rows[tbname][ts] = -r * 1000 - i
+            tdSql.execute(f'insert into {self.dbname}.{tbname} values {values}')
+        tdSql.execute(f'flush database {self.dbname}')
+
+    def check_data(self):
+        total = 0
+        for tbname in self.tables():
+            rows = self.rows[tbname]
+            tdSql.query(f'select count(*), sum(c0) from {self.dbname}.{tbname}')
+            tdSql.checkData(0, 0, len(rows))
+            tdSql.checkData(0, 1, sum(rows.values()))
+            tdSql.query(f'select ts, c0 from {self.dbname}.{tbname} order by ts')
+            tdSql.checkRows(len(rows))
+            for i, ts in enumerate(sorted(rows)):
+                tdSql.checkEqual(tdSql.queryResult[i][1], rows[ts])
+            if tbname != self.ntbname:
+                total += len(rows)
+        tdSql.query(f'select count(*) from {self.dbname}.{self.stbname}')
+        tdSql.checkData(0, 0, total)
+
+    def run(self):
+        tdSql.execute(f'create database {self.dbname} vgroups 1 stt_trigger 4')
+        tdSql.execute(f'create table {self.dbname}.{self.stbname} (ts timestamp, c0 int) tags (t0 int)')
+        for i in range(self.tbnum):
+            tdSql.execute(f'create table {self.dbname}.ct{i} using {self.dbname}.{self.stbname} tags ({i})')
+        tdSql.execute(f'create table {self.dbname}.{self.ntbname} (ts timestamp, c0 int)')
+        for tbname in self.tables():
+            self.rows[tbname] = {}
+
+        for r in range(self.rounds):
+            # the rows of a dropped table are removed by the next compaction, and a new table of the same name does
+            # not see them
+            if r == self.rounds // 2:
+                tbname = f'ct{self.tbnum - 1}'
+                tdSql.execute(f'drop table {self.dbname}.{tbname}')
+                tdSql.execute(f'create table {self.dbname}.{tbname} using {self.dbname}.{self.stbname} tags (0)')
+                self.rows[tbname] = {}
+
+            # each commit after a compaction writes files of its own, and must not overwrite the compacted ones
+            self.insert_round(r)
+            self.check_data()
+
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.check_data()
+
+        # commit and compact once more after the restart
+        self.insert_round(self.rounds)
+        self.insert_round(self.rounds + 1)
+        self.check_data()
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -146,9 +146,62 @@ class TDTestCase:
                         tdSql.query(f'select percentile({k},{param}) from {self.stbname}_{i}')
                         tdSql.checkData(0,0,data_num)
         tdSql.execute(f'drop database {self.dbname}')            
+    def function_check_stb(self):
+        tdSql.execute(f'create database {self.dbname} vgroups 2')
+        tdSql.execute(f'create stable {self.stbname} (ts timestamp, c1 bigint, c2 bigint unsigned, c3 double) tags (t1 int)')
+        for i in range(self.tbnum):
+            tdSql.execute(f'create table {self.stbname}_{i} using {self.stbname} tags({i})')
+        # every round widens the value range of each table: c1 grows monotonically, c2 grows past the
+        # bigint range and c3 grows towards the negative side
+        rows = 50
+        tbData = [{'c1': [], 'c2': [], 'c3': []} for i in range(self.tbnum)]
+        for r in range(4):
+            for i in range(self.tbnum):
+                values = []
+                for j in range(rows):
+                    n = (r * self.tbnum + i) * rows + j
+                    tbData[i]['c1'].append(n * n)
+                    tbData[i]['c2'].append(float(n * 4 * 10**16))
+                    tbData[i]['c3'].append(-n * n * 1.5)
+                    values.append(f'({self.ts + r * rows + j}, {n * n}, {n * 4 * 10**16}, {-n * n * 1.5})')
+                tdSql.execute(f'insert into {self.stbname}_{i} values {" ".join(values)}')
+            tdSql.execute(f'flush database {self.dbname}')
+        for col in ['c1', 'c2', 'c3']:
+            for param in [0, 1, 33, 50, 90, 100]:
+                stbData = []
+                for i in range(self.tbnum):
+                    stbData += tbData[i][col]
+                    tdSql.query(f'select percentile({col}, {param}) from {self.stbname}_{i}')
+                    tdSql.checkData(0, 0, float(np.percentile(tbData[i][col], param)))
+                tdSql.query(f'select percentile({col}, {param}) from {self.stbname}')
+                tdSql.checkData(0, 0, float(np.percentile(stbData, param)))
+        tdSql.execute(f'drop database {self.dbname}')
+    def function_check_bound(self):
+        # the value range grows by at least its span, so the bucket ends up wider than the data
+        tdSql.execute(f'create database {self.dbname}')
+        tdSql.execute(f'create table {self.ntbname} (ts timestamp, c1 int, c2 double)')
+        intData = []
+        for batch in [list(range(100)), [150], [-30]]:
+            values = []
+            for v in batch:
+                values.append(f'({self.ts + len(intData)}, {v}, {v + 0.5})')
+                intData.append(v)
+            tdSql.execute(f'insert into {self.ntbname} values {" ".join(values)}')
+            tdSql.execute(f'flush database {self.dbname}')
+        tdSql.query(f'select percentile(c1, 0), percentile(c1, 100), percentile(c2, 0), percentile(c2, 100) from {self.ntbname}')
+        tdSql.checkData(0, 0, -30.0)
+        tdSql.checkData(0, 1, 150.0)
+        tdSql.checkData(0, 2, -29.5)
+        tdSql.checkData(0, 3, 150.5)
+        for param in [1, 50, 99]:
+            tdSql.query(f'select percentile(c1, {param}) from {self.ntbname}')
+            tdSql.checkData(0, 0, float(np.percentile(intData, param)))
+        tdSql.execute(f'drop database {self.dbname}')
     def run(self):
         self.function_check_ntb()
         self.function_check_ctb()
+        self.function_check_stb()
+        self.function_check_bound()
         
     def stop(self):
         tdSql.close()